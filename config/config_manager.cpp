@@ -250,6 +250,8 @@ bool ConfigManager::parseJSON(const std::string& json_content) {
             extractBool("show_line_numbers", display_pos, display_end, true);
         config_.display.relative_line_numbers =
             extractBool("relative_line_numbers", display_pos, display_end, false);
+        config_.display.show_git_gutter =
+            extractBool("show_git_gutter", display_pos, display_end, true);
         config_.display.highlight_current_line =
             extractBool("highlight_current_line", display_pos, display_end, true);
         config_.display.show_whitespace =
@@ -908,6 +910,8 @@ std::string ConfigManager::generateJSON() const {
         << ",\n";
     oss << "    \"relative_line_numbers\": "
         << (config_.display.relative_line_numbers ? "true" : "false") << ",\n";
+    oss << "    \"show_git_gutter\": " << (config_.display.show_git_gutter ? "true" : "false")
+        << ",\n";
     oss << "    \"highlight_current_line\": "
         << (config_.display.highlight_current_line ? "true" : "false") << ",\n";
     oss << "    \"show_whitespace\": " << (config_.display.show_whitespace ? "true" : "false")
@@ -2,6 +2,7 @@
 #define PNANA_CORE_BUFFER_FACTORY_H
 
 #include "core/buffer_backend.h"
+#include "core/edit_profiler.h"
 #include "core/gap_buffer.h"
 #include "core/piece_table.h"
 #include "core/rope.h"
@@ -90,6 +91,34 @@ class SmartBufferFactory {
         return selectBackendByExtension(filepath);
     }
 
+    // Workload-driven re-selection thresholds
+    static constexpr size_t MIN_PROFILE_SAMPLES = 64;     // edits observed before any decision
+    static constexpr double EDIT_BUDGET_US = 50.0;        // per-edit backend cost considered slow
+    static constexpr double LOCAL_EDIT_BUDGET_US = 200.0; // looser budget for clustered typing
+
+    // Re-select a backend from the observed edit workload (see EditProfiler).
+    // Returns `current` when there is not enough evidence or the current backend is cheap enough.
+    // Clustered typing tolerates a higher per-edit cost than scattered (multi-cursor, search &
+    // replace) or append/growth workloads, whose position lookups walk far through the buffer.
+    // GapBuffer, SqrtDecomposition and Rope resolve (line, col) by scanning from the start of the
+    // text, so the only backend that stays O(log n) for every workload is PieceTable, whose tree
+    // keeps per-subtree newline counts and extends the last piece on consecutive appends.
+    static BufferBackendType selectBackendForWorkload(BufferBackendType current,
+                                                      const EditWorkloadProfile& profile) {
+        if (current == BufferBackendType::PIECE_TABLE || profile.samples < MIN_PROFILE_SAMPLES ||
+            profile.timed_samples < MIN_PROFILE_SAMPLES / 2) {
+            return current;
+        }
+
+        bool local = profile.scattered_ratio < 0.25 && profile.append_ratio < 0.5 &&
+                     profile.growth < 1.5;
+        double budget = local ? LOCAL_EDIT_BUDGET_US : EDIT_BUDGET_US;
+        if (profile.avg_backend_us <= budget) {
+            return current;
+        }
+        return BufferBackendType::PIECE_TABLE;
+    }
+
     // Create smart buffer instance
     static std::unique_ptr<BufferBackend> create(const std::string& filepath,
                                                  size_t file_size = 0) {
@@ -36,6 +36,7 @@ struct LanguageIndentConfig {
 struct DisplayConfig {
     bool show_line_numbers = true;
     bool relative_line_numbers = false;
+    bool show_git_gutter = true; // 行号旁显示 git 变更标记（新增/修改/删除）
     bool highlight_current_line = true;
     bool show_whitespace = false;
     bool show_helpbar = true;
@@ -3,6 +3,12 @@
 
 #include "core/buffer_backend.h"
 #include "core/buffer_factory.h"
+#include "core/document_snapshot.h"
+#include "core/edit_profiler.h"
+#include "core/fold_index.h"
+#include "core/swap_file.h"
+#include "core/undo_journal.h"
+#include "core/wrap_index.h"
 #include "features/lsp/lsp_types.h"
 #include <chrono>
 #include <cstdint>
@@ -21,9 +27,33 @@ namespace core {
 // 行尾类型（提前定义，供 DocumentChange 使用）
 enum class LineEnding { LF, CRLF, CR };
 
+// 文本编辑：把 [start, end) 替换为 text（text 可以包含换行）
+struct TextEdit {
+    size_t start_row = 0;
+    size_t start_col = 0;
+    size_t end_row = 0;
+    size_t end_col = 0;
+    std::string text;
+};
+
+// 内容编辑日志条目：version 为该编辑生效后的文档版本，edit 的坐标基于编辑发生前的文档
+struct ContentEdit {
+    uint64_t version;
+    TextEdit edit;
+};
+
 // 文档修改记录（用于撤销/重做）
 struct DocumentChange {
-    enum class Type { INSERT, DELETE, REPLACE, NEWLINE, COMPLETION, MOVE_LINE, COMMENT_TOGGLE };
+    enum class Type {
+        INSERT,
+        DELETE,
+        REPLACE,
+        NEWLINE,
+        COMPLETION,
+        MOVE_LINE,
+        COMMENT_TOGGLE,
+        EDIT_GROUP
+    };
 
     struct MoveTag {};
     static constexpr MoveTag MOVE_TAG = MoveTag{};
@@ -39,6 +69,9 @@ struct DocumentChange {
     std::vector<std::string> restored_lines;
     LineEnding line_ending;
     size_t content_size;
+    // EDIT_GROUP：按应用顺序记录的编辑（坐标为应用当时的文档），以及每个编辑替换掉的原文
+    std::vector<TextEdit> group_edits;
+    std::vector<std::string> group_removed;
 
     DocumentChange(Type t, size_t r, size_t c, const std::string& old_c, const std::string& new_c)
         : type(t), row(r), col(c), old_content(old_c), new_content(new_c), after_cursor(""),
@@ -101,15 +134,49 @@ class Document {
     }
     void setBufferBackend(BufferBackendType type);
     void autoSelectBufferBackend(); // 根据文件类型和大小自动选择
+    // 按编辑画像自适应迁移后端：画像显示当前后端代价过高时开始迁移，每次调用（每帧）
+    // 向新后端流式复制一块行，复制期间的编辑同步到已复制的部分，完成后原子替换。
+    // 返回 true 表示迁移仍在进行，调用方应安排下一帧
+    bool stepBufferBackendMigration();
+    bool isMigratingBufferBackend() const {
+        return backend_migration_ != nullptr;
+    }
+    // 关闭后只保留加载时的静态选择
+    void setAdaptiveBufferBackend(bool enabled) {
+        adaptive_backend_ = enabled;
+        if (!enabled) {
+            backend_migration_.reset();
+        }
+    }
+    EditWorkloadProfile getEditProfile() const {
+        return edit_profiler_.profile();
+    }
+
+    // 交换文件（崩溃恢复）：有路径的文档被修改后，每次编辑追加到交换文件，保存、关闭或
+    // 撤销回保存点时删除。打开文件时发现上次崩溃留下的交换文件，由调用方选择恢复或丢弃；
+    // 交换文件正被另一个存活的进程使用时为 IN_USE，不应提供恢复
+    SwapFile::Probe probeSwap() const;
+    bool recoverFromSwap();
+    void discardSwap();
+    // 每帧调用：写入到期的检查点；文档回到未修改状态时删除交换文件
+    void tickSwapFile();
 
     // 内容访问
     size_t lineCount() const;
     const std::string& getLine(size_t row) const;
+    // 行的字节长度与行内 [start, start + length) 的字节；懒加载文档直接读文件区间，不读入整行
+    size_t getLineLength(size_t row) const;
+    std::string getLineSlice(size_t row, size_t start, size_t length) const;
     const std::vector<std::string>& getLines() const;
-    std::vector<std::string>& getLines();
 
     // 获取完整的文档内容（所有行合并）
     std::string getContent() const;
+    // 当前版本的只读文本快照，可交给后台线程读取。同一版本重复调用返回同一对象，
+    // 新版本只复制上次快照之后被编辑过的行块
+    std::shared_ptr<const DocumentSnapshot> snapshot() const;
+    // 只需要开头若干行的使用方：懒加载的大文件只读取前 max_lines 行，不读入整文件；
+    // 其他文档等同 snapshot()
+    std::shared_ptr<const DocumentSnapshot> snapshotHead(size_t max_lines) const;
 
     // 编辑操作（使用缓冲区后端）
     void insertChar(size_t row, size_t col, char ch);
@@ -119,6 +186,18 @@ class Document {
     void deleteChar(size_t row, size_t col);
     void deleteRange(size_t start_row, size_t start_col, size_t end_row, size_t end_col);
     void replaceLine(size_t row, const std::string& content);
+    // 整体替换内容，作为一次覆盖全文的编辑记入编辑日志。undoable 为 false 时内容来自
+    // 磁盘或远程（重新加载、转码），同时清空撤销历史；修改标记由调用方设置
+    void setContent(std::vector<std::string> lines, bool undoable = false);
+
+    // 批量编辑：坐标均基于编辑前的文档，互不重叠（重叠的编辑被忽略）。
+    // 所有编辑作为一个撤销组；每个编辑只做一次行缓存拼接和一次后端 replace。
+    // out_row/out_col 返回最靠前的编辑插入文本的末尾位置
+    bool applyEdits(const std::vector<TextEdit>& edits, size_t* out_row = nullptr,
+                    size_t* out_col = nullptr);
+    // 同 applyEdits，但并入上一个撤销组（同一命令内依赖前一步结果的后续编辑）
+    bool appendEdits(const std::vector<TextEdit>& edits, size_t* out_row = nullptr,
+                     size_t* out_col = nullptr);
 
     // 撤销/重做
     // undo 返回是否成功，并通过输出参数返回修改位置
@@ -151,6 +230,25 @@ class Document {
     bool isModified() const {
         return modified_;
     }
+    // 内容版本号：每次编辑 / 撤销 / 重做 / 重新加载后递增，供派生数据（git 标记等）判断是否失效
+    uint64_t getVersion() const {
+        return version_;
+    }
+    // 进程内唯一的文档实例标识：关闭后的 Document 地址可能被新文档复用，
+    // 按指针缓存的派生数据据此区分
+    uint64_t getInstanceId() const {
+        return instance_id_;
+    }
+    // 取 since_version 之后发生的编辑（按发生顺序），供语法树等派生数据增量更新。
+    // 日志已截断、期间发生过整体替换（加载、普通撤销等）时返回 false，调用方应全量重建
+    bool getEditsSince(uint64_t since_version, std::vector<ContentEdit>& out) const;
+    // 软换行索引：按显示宽度同步到当前内容后返回；懒加载（尚未 materialize）的大文件返回 nullptr。
+    // 返回的索引在下一次编辑前有效
+    const WrapIndex* getWrapIndex(size_t width, int tab_size) const;
+    // 懒加载（尚未 materialize）的大文件：调用 getLines() 会读入整文件
+    bool isLazyLoaded() const {
+        return lazy_loaded_;
+    }
     bool isReadOnly() const {
         return read_only_;
     }
@@ -194,6 +292,10 @@ class Document {
     // 折叠状态管理
     void setFolded(int start_line, bool folded);
     bool isFolded(int line) const;
+    bool isFoldStart(int line) const {
+        auto ids = foldIdsAt(line);
+        return ids.first < ids.second;
+    }
     bool isLineInFoldedRange(int line) const;
     void toggleFold(int start_line);
     void unfoldAll();
@@ -208,6 +310,9 @@ class Document {
     size_t displayLineToActualLine(size_t display_line) const;
     // 将实际行号转换为显示行号
     size_t actualLineToDisplayLine(size_t actual_line) const;
+    // 跳过折叠行：>= line 的第一个可见行 / <= line 的最后一个可见行
+    size_t nextVisibleLine(size_t line) const;
+    size_t prevVisibleLine(size_t line) const;
 
   private:
     // 缓冲区后端（支持多种实现：GapBuffer, SqrtDecomposition, Rope, PieceTable）
@@ -221,17 +326,108 @@ class Document {
     std::string encoding_;
     LineEnding line_ending_;
     bool modified_;
+    uint64_t version_ = 0;
+    uint64_t instance_id_ = 0;
     bool read_only_;
 
-    // 撤销/重做栈
+    // 撤销/重做栈：内存中只保留最近的记录，更早的溢出到磁盘日志，深度不受内存限制
     std::deque<DocumentChange> undo_stack_;
     std::deque<DocumentChange> redo_stack_;
-    static constexpr size_t MAX_UNDO_STACK = 1000;
-    static constexpr size_t MAX_UNDO_MEMORY_BYTES = 50 * 1024 * 1024; // 50MB
-    static constexpr size_t MAX_CHANGE_CONTENT_SIZE = 1024 * 1024;    // 1MB per change
+    UndoJournal undo_journal_;
+    UndoJournal redo_journal_;
+    static constexpr size_t MAX_UNDO_STACK = 1000;                   // 内存中的记录数
+    static constexpr size_t MAX_UNDO_MEMORY_BYTES = 8 * 1024 * 1024; // 内存中记录的内容总量
     size_t current_undo_memory_ = 0;
-
+    // 写盘失败时被丢弃的最早记录数；撤销深度 = 丢弃数 + 磁盘记录数 + 内存记录数
+    size_t undo_dropped_ = 0;
+    // 最近一次保存 / 加载时的撤销深度，撤销或重做回到该深度即视为未修改；
+    // 保存时的状态已不可达（其后的重做分支被新编辑丢弃）时为 NO_SAVE_POINT
+    static constexpr size_t NO_SAVE_POINT = static_cast<size_t>(-1);
+    size_t save_point_ = 0;
+
+    size_t undoDepth() const {
+        return undo_dropped_ + undo_journal_.size() + undo_stack_.size();
+    }
     void trimUndoStack();
+    // 超出内存限制时把栈底（最早）的记录溢出到 journal；返回内存中剩余记录的内容总量
+    size_t spillChangeStack(std::deque<DocumentChange>& stack, UndoJournal& journal);
+    // 内存栈为空时从 journal 取回最新的一条
+    static void refillChangeStack(std::deque<DocumentChange>& stack, UndoJournal& journal);
+    // 新编辑使重做分支失效
+    void clearRedo();
+
+    bool applyEditsImpl(const std::vector<TextEdit>& edits, bool extend_last_group,
+                        size_t* out_row, size_t* out_col);
+    // 执行单个已校正的编辑（行缓存 + 后端 + 折叠），返回被替换掉的原文
+    std::string spliceLines(const TextEdit& edit);
+    // text 插入到 (row, col) 后其末尾所在位置
+    static void insertedTextEnd(size_t row, size_t col, const std::string& text, size_t& end_row,
+                                size_t& end_col);
+    // 撤销/重做用：坐标落在行缓存内时才经 spliceLines 应用
+    bool spliceIfValid(const TextEdit& edit);
+    // 交换两行（行数不变），逐行记入编辑日志
+    void swapLines(size_t a, size_t b);
+    // 按行切分撤销记录中的文本，去掉行尾 \r
+    static std::vector<std::string> splitChangeLines(const std::string& text);
+    // DELETE 记录被删除的文本，按撤销时恢复到行缓存中的形式
+    static std::string deletedText(const DocumentChange& change);
+
+    // 内容编辑日志（有界）：早于 edit_log_base_ 的版本无法增量追赶
+    std::deque<ContentEdit> edit_log_;
+    uint64_t edit_log_base_ = 0;
+    size_t edit_log_bytes_ = 0;
+    static constexpr size_t MAX_EDIT_LOG_ENTRIES = 1024;
+    static constexpr size_t MAX_EDIT_LOG_BYTES = 4 * 1024 * 1024;
+    void logEdit(size_t start_row, size_t start_col, size_t end_row, size_t end_col,
+                 std::string text);
+    void resetEditLog();
+
+    // 交换文件：首次编辑时创建。swap_checkpoint_pending_ 表示行缓存经历了无法逐条记录的
+    // 整体修改，SWAP_CHECKPOINT_DELAY 后（连续撤销等合并为一次）写检查点，期间的编辑由检查点覆盖
+    std::unique_ptr<SwapFile> swap_file_;
+    bool swap_checkpoint_pending_ = false;
+    bool swap_unavailable_ = false; // 创建失败后不再每次编辑重试
+    std::chrono::steady_clock::time_point swap_dirty_since_;
+    static constexpr auto SWAP_CHECKPOINT_DELAY = std::chrono::seconds(1);
+    static constexpr uint64_t SWAP_CHECKPOINT_BYTES = 32 * 1024 * 1024; // 限制崩溃后的重放量
+    void recordSwapEdit(const TextEdit& edit);
+    bool ensureSwapFile(std::shared_ptr<const DocumentSnapshot> initial = nullptr);
+    void resetSwapFile();
+
+    // 编辑画像：logEdit 记录每次编辑的位置，lineColToAbsolutePos 到 logEdit 之间计为后端耗时
+    EditProfiler edit_profiler_;
+    mutable std::chrono::steady_clock::time_point backend_op_start_;
+    mutable bool backend_op_timing_ = false;
+    static constexpr uint64_t MIGRATION_CHECK_INTERVAL = 64; // 每隔多少次编辑评估一次画像
+    static constexpr size_t MIGRATION_CHUNK_BYTES = 256 * 1024;
+
+    // 进行中的后端迁移：backend 的内容恒等于 lines_[0, copied_rows) 以 '\n' 连接（无结尾换行）
+    struct BackendMigration {
+        BufferBackendType target;
+        std::unique_ptr<BufferBackend> backend;
+        size_t copied_rows = 0;
+    };
+    std::unique_ptr<BackendMigration> backend_migration_;
+    uint32_t abandoned_backends_ = 0; // 迁移离开过的后端（位集），不再迁回，避免来回切换
+    bool adaptive_backend_ = true;
+    void maybeStartBackendMigration();
+    void mirrorEditToMigration(size_t start_row, size_t start_col, size_t end_row, size_t end_col,
+                               const std::string& text);
+
+    // 软换行索引（随编辑日志逐行更新，日志重置时整体失效）
+    mutable WrapIndex wrap_index_;
+
+    // 快照行块：data 为空表示该块被编辑过，下次 snapshot() 时从 lines_ 重新复制
+    struct SnapshotChunk {
+        size_t lines;
+        DocumentSnapshot::Chunk data;
+    };
+    mutable std::vector<SnapshotChunk> snapshot_chunks_;
+    mutable bool snapshot_chunks_valid_ = false;
+    mutable std::shared_ptr<const DocumentSnapshot> last_snapshot_;
+    static constexpr size_t SNAPSHOT_CHUNK_LINES = 256;
+    // [row, row + removed) 被替换为 inserted 行
+    void spliceSnapshotChunks(size_t row, size_t removed, size_t inserted);
 
     // 剪贴板
     std::string clipboard_;
@@ -258,16 +454,30 @@ class Document {
     static constexpr size_t LINE_CACHE_MAX = 4096;
     void materialize(); // 将懒加载文档全部读入 lines_，并关闭懒加载
     std::string loadLineFromFile(size_t row) const;
+    std::string readFileRange(uint64_t offset, size_t length) const;
 
-    // 折叠范围
+    // 折叠范围（按起始行排序）；下标即范围 id，行增删时原地平移，id 保持不变
     std::vector<pnana::features::FoldingRange> folding_ranges_;
 
-    // 已折叠的行范围（存储起始行号）
-    std::set<int> folded_lines_;
-
-    // 可见行数缓存（折叠变化时失效）
-    mutable size_t visible_line_count_cache_ = 0;
-    mutable bool visible_line_count_dirty_ = true;
+    // 按范围 id 记录的折叠状态（与 folding_ranges_ 一一对应）；同一起始行的范围一起折叠/展开
+    std::vector<uint8_t> fold_state_;
+    size_t folded_count_ = 0;
+
+    // 起始行为 line 的范围 id 区间 [first, second)，O(log k)
+    std::pair<size_t, size_t> foldIdsAt(int line) const;
+
+    // 每个范围的直接外层范围 id（没有时为 NO_FOLD_PARENT）；所有范围互相嵌套时
+    // fold_nested_ 为 true，shiftFolds 只需沿父链调整包含编辑行的外层范围
+    static constexpr size_t NO_FOLD_PARENT = static_cast<size_t>(-1);
+    std::vector<size_t> fold_parent_;
+    bool fold_nested_ = true;
+    void rebuildFoldParents();
+
+    // 折叠索引（折叠状态变化时标脏，首次查询时重建；行增删时增量平移）
+    mutable FoldIndex fold_index_;
+    mutable bool fold_index_dirty_ = false;
+    const FoldIndex& foldIndex() const;
+    void shiftFolds(size_t row, int64_t delta);
 
     // 辅助方法
     void detectLineEnding(const std::string& content);
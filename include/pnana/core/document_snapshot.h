@@ -0,0 +1,65 @@
+#ifndef PNANA_CORE_DOCUMENT_SNAPSHOT_H
+#define PNANA_CORE_DOCUMENT_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pnana {
+namespace core {
+
+/**
+ * 文档某一版本的只读文本快照
+ *
+ * 由 Document::snapshot() 创建，以 std::shared_ptr<const DocumentSnapshot> 传递。
+ * 行数据按块存放，未修改的块在相邻版本的快照之间共享，创建快照只复制被编辑过的块。
+ * 快照创建后不再改变，后台线程（LSP、AI 上下文等）可以不加锁读取，UI 线程继续编辑文档。
+ * 全文与内容哈希在首次使用时计算并缓存，同一版本的多个使用方不会重复拼接或哈希。
+ */
+class DocumentSnapshot {
+  public:
+    using Chunk = std::shared_ptr<const std::vector<std::string>>;
+
+    DocumentSnapshot(uint64_t document_id, uint64_t version, std::vector<Chunk> chunks);
+
+    DocumentSnapshot(const DocumentSnapshot&) = delete;
+    DocumentSnapshot& operator=(const DocumentSnapshot&) = delete;
+
+    uint64_t documentId() const {
+        return document_id_;
+    }
+    uint64_t version() const {
+        return version_;
+    }
+    size_t lineCount() const {
+        return line_count_;
+    }
+    const std::string& line(size_t row) const;
+
+    // 以 \n 连接的全文（与 Document::getContent() 一致）
+    const std::string& text() const;
+    // 全文的 FNV-1a 哈希，逐行计算，不需要先拼接全文
+    uint64_t hash() const;
+    // [first, first + count) 行以 \n 连接；覆盖全文时直接复用 text()
+    std::string joinLines(size_t first, size_t count) const;
+
+  private:
+    uint64_t document_id_;
+    uint64_t version_;
+    std::vector<Chunk> chunks_;
+    std::vector<size_t> chunk_starts_; // 每块首行的行号
+    size_t line_count_ = 0;
+
+    mutable std::once_flag text_once_;
+    mutable std::string text_;
+    mutable std::once_flag hash_once_;
+    mutable uint64_t hash_ = 0;
+};
+
+} // namespace core
+} // namespace pnana
+
+#endif // PNANA_CORE_DOCUMENT_SNAPSHOT_H
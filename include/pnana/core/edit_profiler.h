@@ -0,0 +1,66 @@
+#ifndef PNANA_CORE_EDIT_PROFILER_H
+#define PNANA_CORE_EDIT_PROFILER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace pnana {
+namespace core {
+
+// 最近一段编辑的统计画像，供 SmartBufferFactory 按实际负载重新选择缓冲区后端
+struct EditWorkloadProfile {
+    size_t samples = 0;          // 窗口内的编辑数
+    size_t timed_samples = 0;    // 其中带后端耗时的编辑数
+    double scattered_ratio = 0;  // 与上一次编辑相距超过 LOCALITY_ROWS 行的比例（随机访问）
+    double append_ratio = 0;     // 落在文档最后一行的比例（日志式追加）
+    double growth = 1.0;         // 当前行数 / 加载（或上次迁移）时的行数
+    double avg_backend_us = 0;   // 后端定位 + 修改的平均耗时
+    size_t line_count = 0;
+};
+
+/**
+ * 编辑画像：固定窗口（最近 WINDOW 次编辑）的环形缓冲，增量维护各项计数，
+ * record() 与 profile() 都是 O(1)。
+ */
+class EditProfiler {
+  public:
+    static constexpr size_t WINDOW = 256;
+    static constexpr size_t LOCALITY_ROWS = 8;
+
+    // 重新开始统计；base_lines 作为增长率的基准，为 0 时取第一次编辑时的行数
+    void reset(size_t base_lines = 0);
+    // row 为编辑起始行，at_end 表示编辑落在文档最后一行，line_count 为当前总行数；
+    // backend_ns < 0 表示本次没有计时
+    void record(size_t row, bool at_end, size_t line_count, int64_t backend_ns);
+    EditWorkloadProfile profile() const;
+    // 自 reset() 以来的编辑总数（不受窗口限制）
+    uint64_t totalEdits() const {
+        return total_edits_;
+    }
+
+  private:
+    struct Sample {
+        bool scattered = false;
+        bool append = false;
+        int64_t backend_ns = -1;
+    };
+
+    std::array<Sample, WINDOW> ring_{};
+    size_t next_ = 0;
+    size_t count_ = 0;
+    size_t scattered_ = 0;
+    size_t appends_ = 0;
+    size_t timed_ = 0;
+    int64_t backend_ns_sum_ = 0;
+    uint64_t total_edits_ = 0;
+    bool has_last_row_ = false;
+    size_t last_row_ = 0;
+    size_t base_lines_ = 0;
+    size_t line_count_ = 0;
+};
+
+} // namespace core
+} // namespace pnana
+
+#endif // PNANA_CORE_EDIT_PROFILER_H
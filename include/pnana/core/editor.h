@@ -4,6 +4,7 @@
 #include "core/config_manager.h"
 #include "core/document.h"
 #include "core/document_manager.h"
+#include "core/long_line_view.h"
 #include "core/overlay_manager.h"
 #include "core/region_manager.h"
 #include "input/action_executor.h"
@@ -60,6 +61,7 @@
 #ifdef BUILD_TREE_SITTER_SUPPORT
 #include "features/indent/auto_indent_engine.h"
 #endif
+#include "features/syntax_tree/syntax_tree_service.h"
 #include "features/command_palette.h"
 #include "features/extract.h"
 #include "features/file_browser.h"
@@ -72,12 +74,13 @@
 #include "features/ui_refresh_scheduler.h"
 // #include "features/markdown_preview.h"  // removed during preview refactor; backup stored as .bak
 #include "features/terminal.h"
+#include "features/vgit/git_gutter.h"
 #include "ui/git_panel.h"
 #ifdef BUILD_LSP_SUPPORT
+#include "features/lsp/completion_store.h"
 #include "features/lsp/document_change_tracker.h"
 #include "features/lsp/folding_manager.h"
 #include "features/lsp/lsp_async_manager.h"
-#include "features/lsp/lsp_completion_cache.h"
 #include "features/lsp/lsp_formatter.h"
 #include "features/lsp/lsp_request_manager.h"
 #include "features/lsp/lsp_server_manager.h"
@@ -154,6 +157,20 @@ class Editor {
     // 运行编辑器
     void run();
 
+    // 无头驱动：不进入 ScreenInteractive 事件循环，直接分发事件 / 生成一帧
+    // （tests/editor_replay_benchmark 用它回放 --record-events 录下的日志）
+    void dispatchEvent(ftxui::Event event) {
+        handleInput(event);
+    }
+    ftxui::Element renderFrame() {
+        return renderUI();
+    }
+    // 无头模式下 ScreenInteractive 尚未测量终端，尺寸由调用方指定（<= 0 恢复使用 screen_）
+    void setHeadlessScreenSize(int width, int height) {
+        headless_width_ = width;
+        headless_height_ = height;
+    }
+
     // 文件操作
     bool openFile(const std::string& filepath);
     bool saveFile();
@@ -218,6 +235,9 @@ class Editor {
     void cut();
     void copy();
     void paste();
+    // 整段文本作为一次编辑插入（替换选中内容）：一个撤销组、一次 LSP 同步，
+    // 不做自动缩进与自动配对。用于粘贴与合并后的输入
+    void insertBulkText(std::string text);
 
     // 撤销/重做
     void undo();
@@ -242,6 +262,10 @@ class Editor {
     // 视图操作
     void toggleLineNumbers();
     void toggleRelativeNumbers();
+    void toggleWordWrap();
+    // 性能 HUD（状态栏帧耗时分位数）与 Chrome trace 导出
+    void togglePerfHud();
+    void exportPerfTrace();
     void zoomIn();
     void zoomOut();
     void zoomReset();
@@ -451,6 +475,18 @@ class Editor {
     pnana::ui::ExtractPathDialog extract_path_dialog_;
     pnana::ui::ExtractProgressDialog extract_progress_dialog_;
     pnana::ui::AIAssistantPanel ai_assistant_panel_;
+#ifdef BUILD_AI_CLIENT_SUPPORT
+    // 流式回复在 HTTP 引擎的 IO 线程上到达，先在这里累积，每帧合并交给 AI 面板一次
+    struct AIStreamBuffer {
+        std::mutex mutex;
+        std::string pending;       // 尚未交给面板的文本
+        bool finished = false;     // 已收到结束信号
+        bool flush_posted = false; // 已向 UI 线程投递合并任务
+        bool detached = false;     // Editor 已析构或开始了新的回复，不再投递
+        std::string response;      // 完整回复（只在 UI 线程访问）
+    };
+    std::shared_ptr<AIStreamBuffer> ai_stream_;
+#endif
     pnana::ui::ClipboardPanel clipboard_panel_;
     pnana::ui::AIConfigDialog ai_config_dialog_;
     pnana::ui::TodoPanel todo_panel_;
@@ -487,6 +523,8 @@ class Editor {
     size_t bracket_match_col_ = 0;
     size_t bracket_cache_cursor_row_ = SIZE_MAX;
     size_t bracket_cache_cursor_col_ = SIZE_MAX;
+    uint64_t bracket_cache_version_ = UINT64_MAX;
+    uint64_t bracket_cache_tree_generation_ = 0;
     std::string bracket_cache_file_path_;
     std::optional<size_t> bracket_cache_document_index_;
     void updateBracketHighlight();
@@ -496,6 +534,8 @@ class Editor {
     // SSH 图片预览临时本地缓存：remote_uri -> local_temp_file
     std::unordered_map<std::string, std::string> remote_image_temp_files_;
     features::SyntaxHighlighter syntax_highlighter_;
+    // 超长行按列切片渲染（检查点落在 syntax_highlighter_ 的 token 边界上）
+    LongLineView long_line_view_;
 #ifdef BUILD_TREE_SITTER_SUPPORT
     features::AutoIndentEngine auto_indent_engine_;
 #endif
@@ -551,6 +591,10 @@ class Editor {
     // 代码折叠管理器（按 language_id 绑定，切换不同语言文件时需替换）
     std::unique_ptr<features::FoldingManager> folding_manager_;
     std::string folding_manager_language_id_; // 当前 folding_manager_ 绑定的 language_id
+    // 当前文件没有 LSP 时改用语法树折叠：范围直接写入 Document，折叠命令操作文档自身的状态
+    bool tree_folding_active_ = false;
+    uint64_t tree_folding_document_id_ = 0;
+    uint64_t tree_folding_generation_ = 0;
 
     // 文档更新防抖（阶段1优化）
     std::chrono::steady_clock::time_point last_document_update_time_;
@@ -590,8 +634,12 @@ class Editor {
     // 文档变更跟踪器（阶段2优化）
     std::unique_ptr<features::DocumentChangeTracker> document_change_tracker_;
 
-    // 补全缓存（阶段2优化）
-    std::unique_ptr<features::LspCompletionCache> completion_cache_;
+    // 补全会话：同一标识符上继续输入时在本地缩小上一次 LSP 响应
+    features::CompletionStore completion_store_;
+    // 上次补全时的文档：据此判断其间的编辑是否只是当前行上的输入
+    std::string completion_doc_uri_;
+    uint64_t completion_doc_version_ = 0;
+    static constexpr size_t MAX_COMPLETION_POPUP_ITEMS = 50;
 
     // 符号使用频率表（用于补全排序）
     std::unordered_map<std::string, int> symbol_frequency_;
@@ -645,6 +693,11 @@ class Editor {
     size_t cursor_col_;
     size_t view_offset_row_;
     size_t view_offset_col_;
+    // 软换行时视口顶行内的起始视觉行；仅当文档与 view_offset_row_ 仍是记录时的值才有效，
+    // 其他代码直接改写 view_offset_row_ 时自动回到行首
+    uint64_t wrap_view_document_id_ = 0;
+    size_t wrap_view_row_ = 0;
+    size_t wrap_view_subrow_ = 0;
 
     // SSH连接状态
     pnana::ui::SSHConfig current_ssh_config_;
@@ -697,6 +750,9 @@ class Editor {
     // 显示选项
     bool show_line_numbers_;
     bool relative_line_numbers_;
+    bool show_git_gutter_ = true;
+    // 每个文件一个 git 行标记跟踪器（缓冲区内容 vs index，按文档版本增量刷新）
+    std::unordered_map<std::string, vgit::GitGutterTracker> git_gutters_;
     bool show_helpbar_;
     bool syntax_highlighting_;
     int zoom_level_;
@@ -765,10 +821,16 @@ class Editor {
     // FTXUI
     ftxui::ScreenInteractive screen_;
     ftxui::Component main_component_;
+    int headless_width_ = 0;
+    int headless_height_ = 0;
 
     // 后台 UI 刷新调度（用于欢迎页动画/光标闪烁等）
     features::UIRefreshScheduler ui_refresh_scheduler_;
 
+    // 文档语法树（缩进、高亮、括号匹配、无 LSP 折叠共用）；后台解析完成时经 screen_ 请求重绘，
+    // 因此声明在 screen_ 之后，先于它析构
+    features::SyntaxTreeService syntax_tree_service_;
+
     // 事件处理
     void handleInput(ftxui::Event event);
     void handleNormalMode(ftxui::Event event);
@@ -784,12 +846,14 @@ class Editor {
     ftxui::Element renderSplitEditor(); // 分屏编辑器渲染
     ftxui::Element renderEditorRegion(const features::ViewRegion& region, Document* doc,
                                       size_t region_index); // 渲染单个区域
+    // wrap_end 不为 npos 时只渲染 [wrap_start, wrap_end)：软换行的一个视觉行
     ftxui::Element renderLine(
         Document* doc, size_t line_num, bool is_current, bool use_region_word_highlight = false,
         bool region_word_highlight_active = false,
         const std::vector<features::SearchMatch>* region_word_matches = nullptr, int max_width = -1,
-        size_t view_offset_col = 0);
+        size_t view_offset_col = 0, size_t wrap_start = 0, size_t wrap_end = std::string::npos);
     ftxui::Element renderLineNumber(Document* doc, size_t line_num, bool is_current);
+    ftxui::Element renderGitGutterSign(Document* doc, size_t line_num);
     ftxui::Element renderStatusbar();
     ftxui::Element renderHelpbar();
     ftxui::Element renderInputBox();
@@ -808,6 +872,23 @@ class Editor {
     void adjustViewOffsetForUndo(size_t target_row, size_t target_col);
     void adjustViewOffsetForUndoConservative(size_t target_row, size_t target_col);
     static size_t rawColToDisplayCol(const std::string& line, size_t raw_col, int tab_size);
+
+    // 软换行（仅单视图；分屏区域仍按列横向滚动）
+    using WrapPos = std::pair<size_t, size_t>; // (实际行, 行内视觉行)
+    const WrapIndex* getActiveWrapIndex(Document* doc);
+    WrapPos getWrapViewTop(Document* doc, const WrapIndex& wrap) const;
+    void setWrapViewTop(Document* doc, WrapPos top);
+    // 从 pos 起移动 delta 个视觉行（跳过折叠隐藏的行，夹在文档首尾）
+    WrapPos stepWrapPos(Document* doc, const WrapIndex& wrap, WrapPos pos, int64_t delta) const;
+    // from 到 to 之间的视觉行数，超过 limit 时返回 limit
+    size_t wrapDistance(Document* doc, const WrapIndex& wrap, WrapPos from, WrapPos to,
+                        size_t limit) const;
+    WrapPos cursorWrapPos(Document* doc, const WrapIndex& wrap) const;
+    // 把光标放到 pos 所在视觉行中显示列 display_col 处
+    void placeCursorInWrapRow(Document* doc, const WrapIndex& wrap, WrapPos pos,
+                              size_t display_col);
+    size_t cursorWrapDisplayCol(Document* doc, const WrapIndex& wrap) const;
+    void adjustWrappedViewOffset(Document* doc, const WrapIndex& wrap, int screen_height);
     void setStatusMessage(const std::string& message);
     std::string getFileType() const;
     void executeSearch(bool move_cursor = true);
@@ -884,6 +965,8 @@ class Editor {
 
     // 获取当前文档内容（用于预览）
     std::string getCurrentDocumentContent() const;
+    // 当前文档的只读快照（可交给后台线程）；没有打开的文档时返回 nullptr
+    std::shared_ptr<const DocumentSnapshot> getCurrentDocumentSnapshot() const;
 
     // Git 面板
     void toggleGitPanel();
@@ -954,6 +1037,9 @@ class Editor {
     void handleEncodingDialogInput(ftxui::Event event);
     void convertFileEncoding(const std::string& new_encoding);
 
+    // 二进制文件的十六进制视图：当前文档是二进制文件且焦点在代码区时处理按键
+    bool handleBinaryViewInput(ftxui::Event event);
+
 #ifdef BUILD_LSP_SUPPORT
     // LSP 相关方法
     void openLspStatusPopup();
@@ -997,6 +1083,8 @@ class Editor {
     void foldAll();
     void unfoldAll();
     void toggleFoldAtCursor();
+    void applySyntaxTreeFolding(Document* doc);
+    void toggleDocumentFold(Document* doc);
 
     // 诊断相关方法
     void showDiagnosticsPopup();
@@ -1027,6 +1115,16 @@ class Editor {
     Document* getCurrentDocumentForLua() {
         return getCurrentDocument();
     }
+    // 按 Document::getInstanceId() 查找打开的文档（Lua buffer 句柄），已关闭返回 nullptr
+    Document* getDocumentByIdForLua(uint64_t instance_id) {
+        for (size_t i = 0; i < document_manager_.getDocumentCount(); ++i) {
+            Document* doc = document_manager_.getDocument(i);
+            if (doc && doc->getInstanceId() == instance_id) {
+                return doc;
+            }
+        }
+        return nullptr;
+    }
     void setStatusMessageForLua(const std::string& message) {
         setStatusMessage(message);
     }
@@ -0,0 +1,82 @@
+#ifndef PNANA_CORE_FOLD_INDEX_H
+#define PNANA_CORE_FOLD_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace pnana {
+namespace core {
+
+/**
+ * 折叠索引：显示行 ↔ 实际行的 O(log n) 映射
+ *
+ * 已折叠区间 [start, end] 中 start 行保持可见、(start, end] 隐藏；嵌套/重叠的折叠取并集。
+ * 并集被切成若干块，每块是「gap 行可见 + len 行隐藏」，两棵 Fenwick 树分别维护
+ * 各块的可见行数与总行数前缀和，查询均为 O(log 块数)。
+ * 行增删（shiftLines）只修改受影响的块，不需要重建。
+ */
+class FoldIndex {
+  public:
+    // 按已折叠区间重建，O(k log k)
+    void rebuild(std::vector<std::pair<int, int>> folded);
+    void clear();
+
+    bool empty() const {
+        return hidden_total_ == 0;
+    }
+    size_t hiddenLineCount() const {
+        return static_cast<size_t>(hidden_total_);
+    }
+
+    bool isHidden(size_t line) const;
+    // line 之前（不含 line）的可见行数
+    size_t visibleBefore(size_t line) const;
+    // 实际行 → 显示行；隐藏行映射到其所在折叠的首行
+    size_t actualToDisplay(size_t line) const;
+    // 显示行 → 实际行
+    size_t displayToActual(size_t display_line) const;
+    // >= line 的第一个可见行（隐藏行跳到折叠块之后）
+    size_t nextVisible(size_t line) const;
+    // <= line 的最后一个可见行（隐藏行回到折叠首行）
+    size_t prevVisible(size_t line) const;
+
+    // 在 row 处插入（delta > 0）或从 row 起删除（delta < 0）行
+    void shiftLines(size_t row, int64_t delta);
+
+    // 按与 shiftLines 相同的映射原地平移折叠范围 [start, end]：row 之前不动，插入时后移，
+    // 末行被删时退到删除区之前。首行被删除或区间退化为单行时返回 false（该范围应丢弃）
+    static bool shiftRange(int& start, int& end, size_t row, int64_t delta);
+
+  private:
+    class Fenwick {
+      public:
+        void build(const std::vector<int64_t>& values);
+        void add(size_t index, int64_t delta);
+        // [0, count) 的和
+        int64_t prefix(size_t count) const;
+        // 满足 prefix(i + 1) > target 的最小 i；不存在时返回 size()
+        size_t upperBound(int64_t target) const;
+        size_t size() const {
+            return tree_.empty() ? 0 : tree_.size() - 1;
+        }
+
+      private:
+        std::vector<int64_t> tree_;
+    };
+
+    // 找到包含 line 的块；块外返回 blocks 数
+    size_t locate(size_t line) const;
+
+    std::vector<int64_t> gap_; // 每块开头的可见行数
+    std::vector<int64_t> len_; // 每块末尾的隐藏行数
+    Fenwick visible_tree_;     // gap 的前缀和
+    Fenwick span_tree_;        // gap + len 的前缀和
+    int64_t hidden_total_ = 0;
+};
+
+} // namespace core
+} // namespace pnana
+
+#endif // PNANA_CORE_FOLD_INDEX_H
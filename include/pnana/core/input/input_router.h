@@ -6,6 +6,7 @@
 #include <ftxui/component/event.hpp>
 #include <map>
 #include <memory>
+#include <string>
 
 namespace pnana {
 namespace core {
@@ -25,6 +26,20 @@ class InputRouter {
     // 主路由方法（替代 Editor::handleInput 的核心逻辑）
     bool route(ftxui::Event event, Editor* editor);
 
+    // 输入合并：括号粘贴（ESC[200~ ... ESC[201~）整段收集，同一帧内连续到达的字符
+    // （未开启括号粘贴的终端粘贴、快速输入）攒到帧末。Editor::handleInput 最先调用，
+    // 返回 true 表示事件已被吸收
+    bool coalesce(const ftxui::Event& event, Editor* editor);
+    // 代码区即将插入文本时调用：本帧已有输入或正在提交粘贴时追加到缓冲并返回 true，
+    // 否则返回 false，由调用方按普通按键处理（自动配对、自动缩进等照常）
+    bool deferTextInsert(const std::string& text, bool is_newline);
+    // 渲染前调用：把缓冲作为一次批量编辑提交；返回是否有插入
+    bool flushInputBurst(Editor* editor);
+    // 正在把粘贴内容送入编辑器（这些合成事件不应再被录制）
+    bool isDispatchingPaste() const {
+        return dispatching_paste_;
+    }
+
   private:
     // 检查全局快捷键（在任何情况下都有效）
     bool handleGlobalShortcuts(ftxui::Event event, Editor* editor);
@@ -32,6 +47,11 @@ class InputRouter {
     // 检查对话框优先级（按优先级顺序）
     bool handleDialogs(ftxui::Event event, Editor* editor);
 
+#ifdef BUILD_LUA_SUPPORT
+    // 插件键映射（vim.keymap.set 注册、已编译进 KeyBindingManager 的分发表）
+    bool handlePluginKeymaps(ftxui::Event event, Editor* editor);
+#endif
+
     // 检查分屏大小调整（优先级较高）
     bool handleSplitResize(ftxui::Event event, Editor* editor);
 
@@ -58,6 +78,18 @@ class InputRouter {
 
     // 是否已初始化
     bool initialized_;
+
+    // 输入合并状态
+    bool in_bracketed_paste_ = false;
+    bool dispatching_paste_ = false;
+    bool probing_paste_ = false; // 探测粘贴目标：代码区的文本插入直接进缓冲
+    bool typed_this_frame_ = false;
+    std::string paste_text_;
+    std::string burst_;
+
+    // 粘贴结束：首个字符走完整的输入流程，若落到代码区插入则整段批量插入，
+    // 否则（对话框、搜索框、终端等）逐个事件回放，与逐键输入行为一致
+    void finishBracketedPaste(Editor* editor);
 };
 
 } // namespace input
@@ -0,0 +1,90 @@
+#ifndef PNANA_CORE_LONG_LINE_VIEW_H
+#define PNANA_CORE_LONG_LINE_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pnana {
+namespace core {
+
+class Document;
+
+/**
+ * 超长行的列切片视图
+ *
+ * 压缩过的 JS/JSON、日志等单行动辄数 MB，整行复制、展开制表符再截取视口会让每帧耗时与行长成正比。
+ * 这里为超长行按需建立检查点：每约 CHECKPOINT_BYTES 字节记录一次 (字节偏移, 显示列)，
+ * 检查点落在分词器的 token 边界上，可以作为局部重新分词的起点。
+ * 渲染 display_col 开始的 width 列时，只从最近的检查点读取并展开视口内的字节，
+ * 每帧开销与视口宽度相关，与行长无关。
+ *
+ * 显示列与非软换行渲染一致：每字节一列，制表符对齐到 tab_size。
+ */
+class LongLineView {
+  public:
+    static constexpr size_t LONG_LINE_THRESHOLD = 4096;
+    static constexpr size_t CHECKPOINT_BYTES = 4096;
+
+    // 返回 text 中不超过 limit 的最后一个可安全重新分词的位置（通常是 token 起点）
+    using TokenBoundaryFn = std::function<size_t(const std::string& text, size_t limit)>;
+
+    struct Window {
+        std::string display_text; // 制表符已展开，首列即请求的 display_col
+        size_t byte_start = 0;    // 视口覆盖的字节区间 [byte_start, byte_end)
+        size_t byte_end = 0;
+        size_t context_start = 0; // 视口之前最近的检查点，context 从这里开始
+        std::string context;      // 行内 [context_start, byte_end) 的原始字节
+        bool raw = true;          // display_text 与 context 的视口部分逐字节相同（无制表符展开）
+    };
+
+    static bool isLongLine(size_t length) {
+        return length > LONG_LINE_THRESHOLD;
+    }
+
+    void setTokenBoundary(TokenBoundaryFn boundary) {
+        boundary_ = std::move(boundary);
+        entries_.clear();
+    }
+
+    Window window(const Document& doc, size_t row, size_t display_col, size_t width, int tab_size,
+                  const std::string& file_type);
+    // 字节列 → 显示列；超长行从检查点开始累计
+    size_t displayColumn(const Document& doc, size_t row, size_t byte_col, int tab_size,
+                         const std::string& file_type);
+    void clear() {
+        entries_.clear();
+    }
+
+  private:
+    struct Checkpoint {
+        size_t byte;
+        size_t display_col;
+    };
+    struct Entry {
+        uint64_t version = 0;
+        int tab_size = 4;
+        std::string file_type;
+        size_t length = 0;
+        std::vector<Checkpoint> checkpoints;
+    };
+
+    Entry& entryFor(const Document& doc, size_t row, int tab_size, const std::string& file_type);
+    // 把检查点推进到覆盖 byte（或 display_col）为止
+    void extendToByte(const Document& doc, size_t row, Entry& entry, size_t byte);
+    void extendToColumn(const Document& doc, size_t row, Entry& entry, size_t display_col);
+    bool extendOnce(const Document& doc, size_t row, Entry& entry);
+
+    TokenBoundaryFn boundary_;
+    std::map<std::pair<uint64_t, size_t>, Entry> entries_;
+    static constexpr size_t MAX_ENTRIES = 64;
+};
+
+} // namespace core
+} // namespace pnana
+
+#endif // PNANA_CORE_LONG_LINE_VIEW_H
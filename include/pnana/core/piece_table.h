@@ -22,7 +22,7 @@ namespace core {
 class PieceTable : public BufferBackend {
   public:
     PieceTable();
-    ~PieceTable() override = default;
+    ~PieceTable() override;
 
     BufferBackendType getType() const override {
         return BufferBackendType::PIECE_TABLE;
@@ -36,14 +36,7 @@ class PieceTable : public BufferBackend {
     void remove(size_t pos, size_t length) override;
     std::string getText(size_t pos, size_t length) const override;
     std::string getFullText() const override;
-    void clear() override {
-        original_buffer_.clear();
-        append_buffer_.clear();
-        root_ = nil_;
-        total_length_ = 0;
-        line_count_ = 1;
-        lines_dirty_ = true;
-    }
+    void clear() override;
 
     // 行操作
     void insertLine(size_t line_num, const std::string& content) override;
@@ -109,11 +102,17 @@ class PieceTable : public BufferBackend {
 
     std::string original_buffer_; // 原始文件内容（只读）
     std::string append_buffer_;   // 追加内容（可写）
+    // 两个缓冲区中换行符的偏移（升序）；缓冲区只追加，索引随之追加，
+    // 片段的换行数与行首定位都是二分查找
+    std::vector<size_t> original_newlines_;
+    std::vector<size_t> append_newlines_;
     std::shared_ptr<RBNode> root_;
     std::shared_ptr<RBNode> nil_; // 哨兵节点
     mutable size_t total_length_;
     mutable size_t line_count_;
     mutable bool lines_dirty_;
+    size_t node_count_;  // 树中节点数（含空片段）
+    size_t empty_nodes_; // 被整段删除后留下的空片段数，过半时重建树
 
     // 红黑树操作
     void rotateLeft(std::shared_ptr<RBNode> node);
@@ -125,6 +124,13 @@ class PieceTable : public BufferBackend {
     std::shared_ptr<RBNode> findNodeAt(size_t pos) const;
     std::pair<std::shared_ptr<RBNode>, size_t> findNodeAndOffset(size_t pos) const;
     void updateNodeInfo(std::shared_ptr<RBNode> node) const;
+    void propagateUp(std::shared_ptr<RBNode> node) const;
+    std::shared_ptr<RBNode> makeNode(BufferType type, size_t start, size_t length) const;
+    // 把 node 挂为 anchor 的中序前驱（before=true）或后继
+    void attachNode(std::shared_ptr<RBNode> anchor, std::shared_ptr<RBNode> node, bool before);
+    // 丢弃空片段并按中序重建平衡树
+    void rebuildTree();
+    void releaseTree();
 
     // 片段操作
     void insertPiece(size_t pos, BufferType type, size_t start, size_t length);
@@ -137,7 +143,11 @@ class PieceTable : public BufferBackend {
 
   private:
     // 辅助函数
-    size_t countNewlines(const std::string& str, size_t start, size_t len) const;
+    size_t countNewlines(const Piece& piece) const;
+    static void indexNewlines(std::vector<size_t>& index, const std::string& text, size_t base);
+    const std::vector<size_t>& newlinesOf(BufferType type) const {
+        return type == BufferType::ORIGINAL ? original_newlines_ : append_newlines_;
+    }
     size_t findLineStart(size_t line_num) const;
 
     void recomputeLineCount() const;
@@ -0,0 +1,85 @@
+#ifndef PNANA_CORE_RECORD_CODEC_H
+#define PNANA_CORE_RECORD_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pnana {
+namespace core {
+
+// 撤销日志与交换文件共用的紧凑二进制编码：整数用 LEB128 varint，字符串为 长度 + 字节
+
+inline void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline void putString(std::string& out, const char* data, size_t size) {
+    putVarint(out, size);
+    out.append(data, size);
+}
+
+inline void putString(std::string& out, const std::string& value) {
+    putString(out, value.data(), value.size());
+}
+
+// 顺序读取；任何越界或格式错误都返回 false，调用方据此丢弃整条记录
+class RecordReader {
+  public:
+    RecordReader(const char* data, size_t size) : data_(data), size_(size) {}
+
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= size_) {
+                return false;
+            }
+            uint8_t byte = static_cast<uint8_t>(data_[pos_++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool size(size_t& value) {
+        uint64_t raw = 0;
+        if (!varint(raw)) {
+            return false;
+        }
+        value = static_cast<size_t>(raw);
+        return true;
+    }
+
+    bool string(std::string& value) {
+        size_t length = 0;
+        if (!size(length) || length > size_ - pos_) {
+            return false;
+        }
+        value.assign(data_ + pos_, length);
+        pos_ += length;
+        return true;
+    }
+
+    size_t position() const {
+        return pos_;
+    }
+    size_t remaining() const {
+        return size_ - pos_;
+    }
+
+  private:
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+} // namespace core
+} // namespace pnana
+
+#endif // PNANA_CORE_RECORD_CODEC_H
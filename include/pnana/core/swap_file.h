@@ -0,0 +1,99 @@
+#ifndef PNANA_CORE_SWAP_FILE_H
+#define PNANA_CORE_SWAP_FILE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pnana {
+namespace core {
+
+struct TextEdit;
+class DocumentSnapshot;
+
+/**
+ * 交换文件：未保存修改的崩溃恢复日志（~/.config/pnana/swap/<路径哈希>.swp）
+ *
+ * 文件头记录原文件的大小与修改时间，之后是按顺序追加的记录，每条为
+ * varint 长度 + 内容 + FNV-1a 校验和：
+ *   - 编辑记录：一次 logEdit 的 (start, end, text)，按键代价与编辑大小成正比
+ *   - 检查点：整份文档内容。无法逐条记录的整体修改（撤销、外部改写行缓存）之后，
+ *     或日志增长过大时写一次；检查点写入新文件后原子替换，之前的记录随之丢弃
+ *
+ * 记录先进入内存队列，由后台线程成批写入并 fdatasync，UI 线程不做磁盘 IO。
+ * 恢复时顺序重放，遇到截断或校验失败的尾部记录即停止（崩溃时最后一批可能只写了一半）。
+ * 正常关闭文档、保存或撤销回保存点时删除交换文件；只有崩溃会留下它。
+ *
+ * 所有权：文件头记录写入者的 pid 与主机名，写入者在整个会话中对交换文件持有 flock。
+ * 拿不到锁说明同一文件正被另一个存活的进程编辑，此时既不提供恢复，也不截断或删除它；
+ * 进程退出（包括崩溃）时锁自动释放，留下的文件才可恢复。
+ */
+class SwapFile {
+  public:
+    // probe 的结果：IN_USE 表示另一个存活的进程持有该交换文件
+    enum class State { NONE, RECOVERABLE, IN_USE };
+    struct Probe {
+        State state = State::NONE;
+        int64_t pid = 0;  // 写入者的进程号
+        std::string host; // 写入者的主机名
+    };
+
+    SwapFile() = default;
+    ~SwapFile(); // 停止写线程并删除交换文件（仅限本进程持有锁的文件）
+    SwapFile(const SwapFile&) = delete;
+    SwapFile& operator=(const SwapFile&) = delete;
+
+    // 为 filepath 创建（覆盖）交换文件并启动写线程；此后的记录以磁盘上的当前文件为基准。
+    // 给出 initial 时以该快照作为第一个检查点，文件由写线程创建。
+    // 交换文件被另一个存活的进程锁定时返回 false，不改动它
+    bool open(const std::string& filepath,
+              std::shared_ptr<const DocumentSnapshot> initial = nullptr);
+    void appendEdit(const TextEdit& edit);
+    // 排在其后的编辑记录之前；尚未写入的更早记录已包含在快照中，直接丢弃
+    void checkpoint(std::shared_ptr<const DocumentSnapshot> snapshot);
+    // 自上次检查点以来追加的日志字节数
+    uint64_t journalBytes() const {
+        return journal_bytes_;
+    }
+
+    static std::string pathFor(const std::string& filepath);
+    // filepath 是否有可恢复的交换文件：未被其他进程锁定、至少一条记录，
+    // 且以检查点开头或基准文件未变
+    static Probe probe(const std::string& filepath);
+    // 把交换文件重放到 lines（调用方传入磁盘上当前文件的内容）；applied 为重放的记录数
+    static bool replay(const std::string& filepath, std::vector<std::string>& lines,
+                       size_t* applied = nullptr);
+    // 删除遗留的交换文件；被其他进程锁定时保留
+    static void remove(const std::string& filepath);
+
+  private:
+    std::string path_;
+    int fd_ = -1;
+    uint64_t journal_bytes_ = 0; // UI 线程维护
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::string pending_;                                 // 已编码、待写入的记录
+    std::shared_ptr<const DocumentSnapshot> checkpoint_; // 待写入的检查点
+    std::string header_;
+    bool stop_ = false;
+    std::atomic<bool> failed_{false}; // 写盘出错后停止记录，不影响编辑
+    std::thread writer_;
+
+    static constexpr size_t FLUSH_BYTES = 1024 * 1024; // 待写数据超过此值立即唤醒写线程
+
+    void writerLoop();
+    bool writeCheckpoint(const DocumentSnapshot& snapshot);
+    void appendRecord(const std::string& payload);
+};
+
+} // namespace core
+} // namespace pnana
+
+#endif // PNANA_CORE_SWAP_FILE_H
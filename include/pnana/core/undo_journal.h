@@ -0,0 +1,72 @@
+#ifndef PNANA_CORE_UNDO_JOURNAL_H
+#define PNANA_CORE_UNDO_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pnana {
+namespace core {
+
+struct DocumentChange;
+
+/**
+ * 撤销日志的磁盘部分：内存里只保留最近的撤销/重做记录，更早的按 LIFO 溢出到这里。
+ *
+ * 记录追加写入一个匿名临时文件（创建后立即 unlink，进程退出即回收），内存中每条记录
+ * 只剩 (offset, length) 一个区间；取回时通过 mmap 读出。取回的是最新一条，其占用的
+ * 文件空间随即被后续写入复用，因此文件大小只取决于溢出深度。
+ *
+ * 编码紧凑：整数用 varint；old/new 内容只存去掉公共前后缀后的差异部分
+ * （补全、注释切换、替换等只改动一小段的记录大多如此）；能由 old_content 推出的
+ * restored_lines 不重复保存。
+ */
+class UndoJournal {
+  public:
+    UndoJournal() = default;
+    ~UndoJournal();
+    UndoJournal(const UndoJournal&) = delete;
+    UndoJournal& operator=(const UndoJournal&) = delete;
+
+    // 追加一条比日志中所有记录都新的记录；写盘失败返回 false（调用方按旧行为丢弃）
+    bool spill(const DocumentChange& change);
+    // 取回最新的一条记录；日志为空或读取失败返回 false
+    bool restore(DocumentChange& out);
+    void clear();
+
+    size_t size() const {
+        return records_.size();
+    }
+    bool empty() const {
+        return records_.empty();
+    }
+    uint64_t diskBytes() const {
+        return end_;
+    }
+
+    static void encode(const DocumentChange& change, std::string& out);
+    static bool decode(const char* data, size_t size, DocumentChange& out);
+
+  private:
+    struct Span {
+        uint64_t offset;
+        uint64_t length;
+    };
+
+    int fd_ = -1;
+    std::vector<Span> records_;
+    uint64_t end_ = 0; // 有效数据末尾（下一条记录的写入位置）
+    char* map_ = nullptr;
+    size_t map_size_ = 0;
+    std::string scratch_;
+
+    bool ensureOpen();
+    bool readSpan(const Span& span, std::string& out);
+    void unmap();
+};
+
+} // namespace core
+} // namespace pnana
+
+#endif // PNANA_CORE_UNDO_JOURNAL_H
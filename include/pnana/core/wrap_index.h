@@ -0,0 +1,97 @@
+#ifndef PNANA_CORE_WRAP_INDEX_H
+#define PNANA_CORE_WRAP_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pnana {
+namespace core {
+
+/**
+ * 软换行索引：实际行 ↔ 视觉行的 O(log n) 映射
+ *
+ * 每个实际行按显示宽度（UTF-8 解码，CJK 占 2 列，组合字符占 0 列，制表符按 tab_size 对齐）
+ * 折成若干视觉行，Fenwick 树维护各行视觉行数的前缀和。
+ * 编辑时 splice() 只把被替换的行标记为待重算，行数不变的编辑是 O(log n) 的单点更新；
+ * 宽度或制表符宽度变化时整体重建。
+ * 多于一个视觉行的行，其折行位置按需计算并缓存，供渲染与光标移动使用。
+ */
+class WrapIndex {
+  public:
+    // 按显示宽度切分一行，starts 为各视觉行的起始字节偏移（首项恒为 0，空行也有一个视觉行）
+    static void computeRowStarts(const std::string& line, size_t width, int tab_size,
+                                 std::vector<size_t>& starts);
+    static size_t countRows(const std::string& line, size_t width, int tab_size);
+
+    bool isValid() const {
+        return valid_;
+    }
+    bool matches(size_t width, int tab_size) const {
+        return valid_ && width == width_ && tab_size == tab_size_;
+    }
+    // 下次 refresh() 时全量重建（整体替换内容、撤销等无法逐行跟踪的变更）
+    void invalidate();
+    // [row, row + removed) 被替换为 inserted 行；新行在 refresh() 时重算
+    void splice(size_t row, size_t removed, size_t inserted);
+    // 重算待定行；宽度、制表符宽度或行数不一致时全量重建
+    void refresh(const std::vector<std::string>& lines, size_t width, int tab_size);
+
+    size_t lineCount() const {
+        return rows_.size();
+    }
+    size_t totalRows() const {
+        return static_cast<size_t>(tree_.prefix(rows_.size()));
+    }
+    size_t rowsOf(size_t line) const {
+        return line < rows_.size() ? rows_[line] : 1;
+    }
+    // line 之前（不含 line）的视觉行数
+    size_t rowsBefore(size_t line) const {
+        return static_cast<size_t>(tree_.prefix(line));
+    }
+    // 视觉行 → (实际行, 行内第几个视觉行)；越界时返回最后一个视觉行
+    std::pair<size_t, size_t> locate(size_t visual_row) const;
+    // line 的各视觉行起始字节偏移（text 必须是该行当前内容）。结果被缓存，
+    // 返回的引用在下一次 rowStarts()/subRowOf() 调用前有效
+    const std::vector<size_t>& rowStarts(size_t line, const std::string& text) const;
+    // 字节列 col 所在的行内视觉行
+    size_t subRowOf(size_t line, const std::string& text, size_t col) const;
+
+  private:
+    class Fenwick {
+      public:
+        void build(const std::vector<uint32_t>& values);
+        void add(size_t index, int64_t delta);
+        // [0, count) 的和
+        int64_t prefix(size_t count) const;
+        // 满足 prefix(i + 1) > target 的最小 i；不存在时返回 size()
+        size_t upperBound(int64_t target) const;
+        size_t size() const {
+            return tree_.empty() ? 0 : tree_.size() - 1;
+        }
+
+      private:
+        std::vector<int64_t> tree_;
+    };
+
+    std::vector<uint32_t> rows_; // 每个实际行的视觉行数
+    Fenwick tree_;
+    std::vector<size_t> pending_; // 待重算的行
+    bool tree_dirty_ = false;     // 行数变化后 Fenwick 树需重建
+    bool valid_ = false;
+    size_t width_ = 0;
+    int tab_size_ = 4;
+
+    // 多视觉行的折行位置缓存
+    mutable std::unordered_map<size_t, std::vector<size_t>> starts_cache_;
+    static constexpr size_t STARTS_CACHE_MAX = 256;
+};
+
+} // namespace core
+} // namespace pnana
+
+#endif // PNANA_CORE_WRAP_INDEX_H
@@ -14,6 +14,7 @@
 #include "features/SyntaxHighlighter/syntax_highlighter_tree_sitter.h"
 #else
 // 前向声明（如果 Tree-sitter 未启用）
+struct TSTree;
 namespace pnana {
 namespace features {
 class SyntaxHighlighterTreeSitter;
@@ -69,6 +70,23 @@ class SyntaxHighlighter {
     // 高亮一行代码
     ftxui::Element highlightLine(const std::string& line);
 
+    // 文档行上下文：tree 为该文档的语法树（SyntaxTreeService），raw_line 为原始行文本，
+    // column_offset 为水平滚动偏移。设置后 highlightLine(text, column) 对与原始行一致的片段
+    // 直接取树中本行的高亮（跨行注释、字符串也能正确着色），不再逐行单独解析
+    void setLineTree(const TSTree* tree, size_t row, const std::string& raw_line,
+                     size_t column_offset);
+    void clearLineTree();
+    // 超长行的局部上下文：context 为从分词检查点开始、覆盖视口的原始字节，
+    // 视口从 context 的 window_offset 处开始。设置后 highlightLine(text, column) 对与 context
+    // 一致的片段只对 context 分词一次，不再处理整行
+    void setLineContext(const std::string& context, size_t window_offset);
+    void clearLineContext();
+    // text 为当前行从 column（相对 column_offset）开始的片段；无行上下文时等同 highlightLine(text)
+    ftxui::Element highlightLine(const std::string& text, size_t column);
+
+    // text 中不超过 limit 的最后一个 token 起点（没有则返回 0），用作超长行的分词检查点
+    size_t lastTokenStart(const std::string& text, size_t limit);
+
     // 获取颜色
     ftxui::Color getColorForToken(TokenType type) const;
 
@@ -102,8 +120,22 @@ class SyntaxHighlighter {
 #ifdef BUILD_TREE_SITTER_SUPPORT
     // Tree-sitter 后端（如果可用）
     std::unique_ptr<SyntaxHighlighterTreeSitter> tree_sitter_highlighter_;
+
+    // 文档行上下文（setLineTree/clearLineTree），本行片段在首次使用时计算
+    const TSTree* line_tree_ = nullptr;
+    size_t line_tree_row_ = 0;
+    const std::string* line_tree_text_ = nullptr;
+    size_t line_tree_offset_ = 0;
+    bool line_tree_segments_ready_ = false;
+    std::vector<HighlightSegment> line_tree_segments_;
 #endif
 
+    // 超长行局部上下文（setLineContext/clearLineContext），分词结果在首次使用时计算
+    const std::string* line_context_ = nullptr;
+    size_t line_context_offset_ = 0;
+    bool line_context_tokens_ready_ = false;
+    std::vector<Token> line_context_tokens_;
+
     // 原有实现的数据成员
     std::map<std::string, std::vector<std::string>> keywords_;
     std::map<std::string, std::vector<std::string>> types_;
@@ -245,6 +277,11 @@ class SyntaxHighlighter {
     // 使用原有实现高亮
     ftxui::Element highlightLineNative(const std::string& line);
 
+    // 不改变跨行注释/字符串状态的分词（用于超长行的局部片段）
+    std::vector<Token> tokenizeDetached(const std::string& line);
+    // 用 line_context_ 的分词结果渲染 context 中 [start, start + text.size()) 的片段
+    ftxui::Element highlightFromContext(const std::string& text, size_t start);
+
 #ifdef BUILD_TREE_SITTER_SUPPORT
     // 从原生 tokenize 获取高亮片段
     void getNativeSegments(const std::string& line, std::vector<HighlightSegment>& segments);
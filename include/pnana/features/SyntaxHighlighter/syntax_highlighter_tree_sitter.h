@@ -3,7 +3,6 @@
 
 #include "ui/theme.h"
 #include <ftxui/dom/elements.hpp>
-#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -44,6 +43,11 @@ class SyntaxHighlighterTreeSitter {
     void parseAndHighlightToSegments(const std::string& code,
                                      std::vector<HighlightSegment>& segments);
 
+    // 从文档语法树（SyntaxTreeService 维护）取第 row 行的高亮片段，列为行内字节偏移；
+    // 跨行节点（块注释、多行字符串）按本行截取
+    void segmentsForRow(const TSTree* tree, uint32_t row, size_t line_length,
+                        std::vector<HighlightSegment>& segments) const;
+
     // 重置解析器状态
     void reset();
 
@@ -56,13 +60,7 @@ class SyntaxHighlighterTreeSitter {
     TSLanguage* current_language_;
     std::string current_file_type_;
 
-    // 语言映射：文件类型 -> Tree-sitter 语言
-    std::map<std::string, TSLanguage*> language_map_;
-
-    // 初始化语言映射
-    void initializeLanguages();
-
-    // 获取 Tree-sitter 语言
+    // 获取 Tree-sitter 语言（见 tree_sitter_languages.h）
     TSLanguage* getLanguageForFileType(const std::string& file_type);
 
     // 将 Tree-sitter 节点类型映射到颜色（parent_type 用于识别函数调用中的 identifier）
@@ -81,6 +79,11 @@ class SyntaxHighlighterTreeSitter {
                                 std::vector<HighlightSegment>& segments, size_t& current_pos,
                                 const std::string& parent_type) const;
 
+    // 按行遍历：只进入与 row 相交的子节点
+    void collectRowSegments(TSNode node, uint32_t row, size_t line_length,
+                            std::vector<HighlightSegment>& segments, size_t& current_pos,
+                            const std::string& parent_type) const;
+
     // 获取节点文本
     std::string getNodeText(TSNode node, const std::string& source) const;
 };
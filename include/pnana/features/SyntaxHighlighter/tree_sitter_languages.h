@@ -0,0 +1,17 @@
+#ifndef PNANA_FEATURES_SYNTAX_HIGHLIGHTER_TREE_SITTER_LANGUAGES_H
+#define PNANA_FEATURES_SYNTAX_HIGHLIGHTER_TREE_SITTER_LANGUAGES_H
+
+#include <string>
+#include <tree_sitter/api.h>
+
+namespace pnana {
+namespace features {
+
+// 文件类型 -> Tree-sitter 语言；只包含编译时链接的语言库，未知类型返回 nullptr。
+// 语法高亮器与文档语法树服务共用这一张表
+TSLanguage* treeSitterLanguageFor(const std::string& file_type);
+
+} // namespace features
+} // namespace pnana
+
+#endif // PNANA_FEATURES_SYNTAX_HIGHLIGHTER_TREE_SITTER_LANGUAGES_H
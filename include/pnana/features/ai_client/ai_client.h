@@ -2,6 +2,8 @@
 #define PNANA_FEATURES_AI_CLIENT_AI_CLIENT_H
 
 #include "features/ai_config/ai_config.h"
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <memory>
@@ -127,6 +129,8 @@ class OpenAIClient : public AIClient {
     ai_config::AIProviderConfig config_;
     std::atomic<bool> cancel_flag_;
     ToolCallCallback tool_call_callback_;
+    // 正在进行的 HttpEngine 请求（0 表示没有），cancelRequest() 据此中止
+    mutable std::atomic<uint64_t> active_request_{0};
 
     nlohmann::json buildRequestJson(const AIRequest& request) const;
     AIResponse parseResponseJson(const nlohmann::json& response) const;
@@ -0,0 +1,132 @@
+#ifndef PNANA_FEATURES_AI_CLIENT_HTTP_ENGINE_H
+#define PNANA_FEATURES_AI_CLIENT_HTTP_ENGINE_H
+
+#ifdef BUILD_AI_CLIENT_SUPPORT
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace pnana {
+namespace features {
+namespace ai_client {
+
+struct HttpRequest {
+    std::string url;
+    std::vector<std::string> headers; // "Name: value"
+    std::string body;                 // POST 请求体
+    long connect_timeout_ms = 10000;
+    long timeout_ms = 0;          // 整个请求的上限，0 表示不限（流式响应靠 idle_timeout_ms）
+    long idle_timeout_ms = 60000; // 连续这么久收不到数据即放弃
+};
+
+struct HttpResponse {
+    long status = 0;
+    std::string body; // 未设置 on_data 时的完整响应体
+    bool cancelled = false;
+    std::string error; // 传输层错误；为空表示传输完成，HTTP 错误看 status
+
+    bool ok() const {
+        return error.empty() && !cancelled && status >= 200 && status < 300;
+    }
+};
+
+// text/event-stream 的增量解析：数据可以在任意字节处被切开
+class SseParser {
+  public:
+    struct Event {
+        std::string event; // 未指定 event: 时为空
+        std::string data;  // 多行 data: 以 '\n' 连接
+    };
+
+    // 追加收到的字节，返回其中已完整的事件（以空行结束）
+    std::vector<Event> feed(const char* data, size_t size);
+
+  private:
+    std::string buffer_;
+    std::string event_;
+    std::string data_;
+    bool has_data_ = false;
+};
+
+/**
+ * AI 提供商共用的 HTTP 引擎
+ *
+ * 所有请求挂在同一个 curl_multi 句柄上，由一个 IO 线程驱动：连接保存在 multi 的连接缓存里，
+ * 同一提供商（主机）的后续请求复用已建立的 TCP/TLS 连接；服务器支持 HTTP/2 时，
+ * 并发请求在同一连接上多路复用。流式响应不再各占一个线程。
+ *
+ * 回调在 IO 线程上运行，应尽快返回：on_data 逐块交付响应体（设置后 HttpResponse::body 为空），
+ * on_done 在任何情况下（完成、失败、取消）恰好调用一次；只有引擎析构（进程退出）时
+ * 未完成的请求直接丢弃，不再回调。
+ */
+class HttpEngine {
+  public:
+    using RequestId = uint64_t;
+    using DataCallback = std::function<void(const char* data, size_t size)>;
+    using DoneCallback = std::function<void(const HttpResponse& response)>;
+
+    static HttpEngine& getInstance() {
+        static HttpEngine instance;
+        return instance;
+    }
+
+    HttpEngine(const HttpEngine&) = delete;
+    HttpEngine& operator=(const HttpEngine&) = delete;
+
+    // 返回请求 id（> 0）；on_data 可以为空
+    RequestId submit(HttpRequest request, DataCallback on_data, DoneCallback on_done);
+    // 同步等待结果；只能在后台线程调用，且不能在回调里调用。
+    // current 非空时在等待期间保存请求 id，供其他线程 cancel()
+    HttpResponse perform(HttpRequest request, std::atomic<RequestId>* current = nullptr);
+
+    // 取消请求（异步生效，on_done 收到 cancelled）；可以在回调里调用
+    void cancel(RequestId id);
+
+    size_t activeCount() const;
+    // 累计新建的连接数（复用的连接不计），用于观察连接池效果
+    long connectionsOpened() const {
+        return connections_opened_.load();
+    }
+
+  private:
+    struct Transfer;
+
+    HttpEngine();
+    ~HttpEngine();
+
+    mutable std::mutex mutex_;
+    std::deque<std::unique_ptr<Transfer>> pending_;
+    std::unordered_set<RequestId> active_ids_; // 排队中与进行中
+    std::unordered_set<RequestId> cancel_requests_;
+    RequestId next_id_ = 1;
+    bool stop_ = false;
+    std::atomic<long> connections_opened_{0};
+
+    void* multi_ = nullptr; // CURLM*；其他线程只通过它调用 curl_multi_wakeup
+
+    // 以下只在 IO 线程访问
+    std::vector<std::unique_ptr<Transfer>> running_;
+    std::thread io_thread_;
+
+    void ioLoop();
+    void startTransfer(std::unique_ptr<Transfer> transfer);
+    std::unique_ptr<Transfer> takeRunning(Transfer* transfer);
+    void finish(std::unique_ptr<Transfer> transfer, int curl_code, bool cancelled);
+};
+
+} // namespace ai_client
+} // namespace features
+} // namespace pnana
+
+#endif // BUILD_AI_CLIENT_SUPPORT
+
+#endif // PNANA_FEATURES_AI_CLIENT_HTTP_ENGINE_H
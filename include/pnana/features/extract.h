@@ -2,6 +2,7 @@
 #define PNANA_FEATURES_EXTRACT_H
 
 #include <atomic>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <string>
@@ -64,6 +65,8 @@ class ExtractManager {
     std::thread extract_thread_;
     std::atomic<bool> extracting_;
     std::atomic<bool> cancel_requested_;
+    // 正在运行的解压命令（ProcessExecutor 任务 id，0 表示没有），取消时终止该进程
+    std::atomic<uint64_t> command_job_;
 };
 
 } // namespace features
@@ -2,10 +2,13 @@
 #define PNANA_FEATURES_FILE_BROWSER_H
 
 #include "ui/theme.h"
+#include <cstdint>
 #include <deque>
 #include <filesystem>
 #include <ftxui/dom/elements.hpp>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -21,15 +24,17 @@ struct FileItem {
     std::string path;
     bool is_directory;
     bool is_hidden;
-    size_t size;
+    size_t size;                    // 远程列表提供；本地列表不 stat，保持为 0
     bool expanded;                  // 是否展开
     bool loaded;                    // 是否已加载子项
+    bool loading;                   // 子项正在后台加载
+    bool last_child;                // 是否是同级的最后一项（树形连接线用）
     int depth;                      // 深度（用于缩进）
     std::vector<FileItem> children; // 子项
 
     FileItem(const std::string& n, const std::string& p, bool is_dir, int d = 0)
         : name(n), path(p), is_directory(is_dir), is_hidden(false), size(0), expanded(false),
-          loaded(false), depth(d) {
+          loaded(false), loading(false), last_child(false), depth(d) {
         is_hidden = (!name.empty() && name[0] == '.');
     }
 };
@@ -48,6 +53,12 @@ struct DeleteOperation {
 class FileBrowser {
   public:
     explicit FileBrowser(ui::Theme& theme);
+    ~FileBrowser();
+
+    // 本地目录展开时在后台线程读取子项，读取结果经 dispatcher 回到 UI 线程并入树中。
+    // 未设置时同步读取
+    using UIDispatcher = std::function<void(std::function<void()>)>;
+    void setUIDispatcher(UIDispatcher dispatcher);
 
     // 目录操作
     bool openDirectory(const std::string& path);
@@ -161,7 +172,6 @@ class FileBrowser {
     RemoteLoader remote_loader_; // 非空时表示远程模式，loadDirectory 用其获取列表
     RemoteFileOpExecutor remote_file_op_exec_;      // SSH 文件操作执行器
     RemoteRecursiveLoader remote_recursive_loader_; // SSH 递归加载器（展开目录用）
-    std::vector<FileItem> items_;
     size_t selected_index_;
     bool visible_;
     bool show_hidden_;
@@ -177,11 +187,27 @@ class FileBrowser {
     };
     ClipboardData clipboard_data_; // 剪贴板数据
 
+    // 后台加载线程与 FileBrowser 共享：析构时清空 dispatcher，之后完成的加载直接丢弃
+    struct LoaderShared {
+        std::mutex mutex;
+        UIDispatcher dispatcher;
+    };
+    std::shared_ptr<LoaderShared> loader_shared_;
+    // loadDirectory() 重建整棵树时递增，早于重建发出的后台加载结果不再适用
+    uint64_t tree_generation_ = 0;
+
     // 辅助方法
     void loadDirectory();
     void loadDirectoryRecursive(FileItem& item); // 递归加载目录
     void flattenTree(const std::vector<FileItem>& tree, std::vector<FileItem*>& flat,
                      int depth = 0); // 展平树形结构用于显示
+    // 展开/折叠 flat_items_[index] 时只插入/删除它的可见子孙，并平移多选索引
+    void expandFlatItem(size_t index);
+    void collapseFlatItem(size_t index);
+    void startBackgroundLoad(FileItem* item);
+    void onChildrenLoaded(uint64_t generation, FileItem* item, std::vector<FileItem> children);
+    static std::vector<FileItem> readLocalChildren(const std::string& path, bool show_hidden,
+                                                   int depth);
     bool copyFileOrDirectory(const std::string& source, const std::string& target); // 复制文件/目录
 
     // 从 ssh://user@host/path 提取 /path 部分
@@ -0,0 +1,137 @@
+#ifndef PNANA_FEATURES_HEX_VIEW_HEX_BUFFER_H
+#define PNANA_FEATURES_HEX_VIEW_HEX_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pnana {
+namespace features {
+
+/**
+ * 在 haystack 中查找 needle 第一次出现的位置，未找到（或 needle 为空）时返回 size。
+ *
+ * SSE2 下每次比较 16 个候选起点的首字节与末字节，两者都命中才 memcmp 中间部分；
+ * 其余平台及尾部不足 16 个候选时用 memchr（libc 已向量化）定位首字节。
+ */
+size_t findBytes(const uint8_t* haystack, size_t size, const uint8_t* needle, size_t needle_size);
+
+/**
+ * 二进制文件的十六进制视图缓冲区。
+ *
+ * 文件以只读 mmap 映射，读取时才由内核按页调入，视图只读可见的几行，多 GB 的文件也不会整体
+ * 读入内存。修改不写入映射，而是记在按页组织的补丁层中（只复制被改动的页）；save() 只把这些页
+ * 写回原文件，不改变文件大小。
+ *
+ * 复制得到的是快照：与原对象共享同一映射，补丁页各自独立，可交给后台线程搜索。
+ */
+class HexBuffer {
+  public:
+    static constexpr uint64_t PAGE_SIZE = 4096;
+
+    HexBuffer() = default;
+
+    bool open(const std::string& filepath);
+    void close();
+
+    bool isOpen() const {
+        return static_cast<bool>(file_);
+    }
+    const std::string& getFilePath() const {
+        return filepath_;
+    }
+    uint64_t size() const;
+    const std::string& getLastError() const {
+        return last_error_;
+    }
+
+    // 读取 [offset, offset + count)（已叠加补丁），返回实际读取的字节数
+    size_t read(uint64_t offset, uint8_t* out, size_t count) const;
+    uint8_t byteAt(uint64_t offset) const;
+    // 该字节是否与磁盘上的原值不同
+    bool isModified(uint64_t offset) const;
+
+    // 补丁层：修改后与原内容一致的页会被移除
+    bool setByte(uint64_t offset, uint8_t value);
+    void revertByte(uint64_t offset);
+    bool hasPatches() const {
+        return !pages_.empty();
+    }
+    size_t dirtyPageCount() const {
+        return pages_.size();
+    }
+    void discardPatches() {
+        pages_.clear();
+    }
+
+    // 把补丁页写回原文件（pwrite，仅修改过的页），成功后清空补丁层。
+    // 文件在打开后被替换或改变了大小时拒绝写入
+    bool save(size_t* pages_written = nullptr);
+
+    /**
+     * 从 from 开始向后查找字节序列，到文件末尾后从头继续，直到回到 from。
+     * 按块扫描：不含补丁的块直接在映射上查找，含补丁的块先拷贝叠加。
+     * cancel 被置位时返回 -1；scanned 累加已扫描的字节数（用于显示进度）。
+     */
+    int64_t find(const std::string& pattern, uint64_t from,
+                 const std::atomic<bool>* cancel = nullptr,
+                 std::atomic<uint64_t>* scanned = nullptr) const;
+
+  private:
+    struct MappedFile;
+
+    int64_t findInRange(const uint8_t* pattern, size_t pattern_size, uint64_t begin,
+                        uint64_t limit, const std::atomic<bool>* cancel,
+                        std::atomic<uint64_t>* scanned) const;
+    bool overlapsPatches(uint64_t begin, uint64_t end) const;
+    const uint8_t* originalData() const;
+    std::vector<uint8_t>& patchPage(uint64_t page_index);
+
+    std::shared_ptr<const MappedFile> file_;
+    std::map<uint64_t, std::vector<uint8_t>> pages_; // 页号 -> 修改后的整页内容
+    std::string filepath_;
+    std::string last_error_;
+};
+
+/**
+ * 十六进制视图的后台搜索：同一时间只有一个搜索，开始新的搜索会先取消旧的。
+ * 析构时取消并等待线程结束。
+ */
+class HexSearchWorker {
+  public:
+    // 在工作线程上调用：offset 为匹配位置，未找到为 -1
+    using ResultCallback = std::function<void(int64_t offset, bool cancelled)>;
+
+    HexSearchWorker() = default;
+    ~HexSearchWorker();
+
+    HexSearchWorker(const HexSearchWorker&) = delete;
+    HexSearchWorker& operator=(const HexSearchWorker&) = delete;
+
+    void start(HexBuffer snapshot, std::string pattern, uint64_t from, ResultCallback callback);
+    void cancel();
+
+    bool isRunning() const {
+        return running_.load();
+    }
+    uint64_t scannedBytes() const {
+        return scanned_.load();
+    }
+
+  private:
+    std::thread thread_;
+    std::atomic<bool> cancel_{false};
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> scanned_{0};
+};
+
+} // namespace features
+} // namespace pnana
+
+#endif // PNANA_FEATURES_HEX_VIEW_HEX_BUFFER_H
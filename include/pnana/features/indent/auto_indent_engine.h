@@ -10,6 +10,8 @@
 
 #ifdef BUILD_TREE_SITTER_SUPPORT
 #include <tree_sitter/api.h>
+#else
+struct TSTree;
 #endif
 
 namespace pnana {
@@ -27,11 +29,12 @@ class AutoIndentEngine {
     void setFileType(const std::string& file_type, const core::LanguageIndentConfig& user_config);
     void setIndentConfig(const core::LanguageIndentConfig& config);
 
+    // tree: SyntaxTreeService 维护的当前文档语法树；为空时退回基于文本的缩进推断
     std::string computeIndent(const std::vector<std::string>& lines, size_t cursor_row,
-                              size_t cursor_col) const;
+                              size_t cursor_col, const TSTree* tree = nullptr) const;
 
     std::string computeIndentAfterNewline(const std::vector<std::string>& lines, size_t cursor_row,
-                                          size_t cursor_col) const;
+                                          size_t cursor_col, const TSTree* tree = nullptr) const;
 
     core::LanguageIndentConfig getDefaultConfigForLanguage(const std::string& language_id) const;
 
@@ -43,17 +46,13 @@ class AutoIndentEngine {
     core::LanguageIndentConfig indent_config_;
 
 #ifdef BUILD_TREE_SITTER_SUPPORT
-    TSParser* parser_;
     TSLanguage* current_language_;
-    std::map<std::string, TSLanguage*> language_map_;
     std::map<std::string, IndentQuery> indent_query_map_;
 
-    void initializeLanguages();
-    TSLanguage* getLanguageForFileType(const std::string& file_type);
     IndentQuery* getIndentQueryForFileType(const std::string& file_type);
 
-    int computeIndentFromTree(const std::vector<std::string>& lines, size_t cursor_row,
-                              size_t cursor_col) const;
+    int computeIndentFromTree(const TSTree* tree, const std::vector<std::string>& lines,
+                              size_t cursor_row, size_t cursor_col) const;
 #endif
 
     int computeIndentFallback(const std::vector<std::string>& lines, size_t cursor_row,
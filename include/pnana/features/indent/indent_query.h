@@ -43,7 +43,7 @@ class IndentQuery {
 
     bool loadForLanguage(const std::string& language, TSLanguage* ts_language);
     bool isLoaded() const;
-    std::vector<IndentCapture> queryAtRow(TSTree* tree, uint32_t row) const;
+    std::vector<IndentCapture> queryAtRow(const TSTree* tree, uint32_t row) const;
     int computeIndentLevel(const std::vector<IndentCapture>& captures, uint32_t target_row) const;
     static std::string getConfigDir();
 
@@ -0,0 +1,116 @@
+#ifndef PNANA_FEATURES_LSP_COMPLETION_STORE_H
+#define PNANA_FEATURES_LSP_COMPLETION_STORE_H
+
+#include "features/lsp/lsp_client.h"
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pnana {
+namespace features {
+
+/**
+ * 一次补全响应对应的会话
+ *
+ * 服务器返回的补全项只存一份；filterText（无则 label）拼接进一块连续的 arena，
+ * 同时保存预先转成小写的副本和字符集位图。查询时：
+ *   1. 位图预过滤：查询中出现的字符必须都在候选里出现
+ *   2. memchr 逐字符确认子序列匹配（glibc 的 memchr 是向量化实现）
+ *   3. 对通过的候选用 fzy 算法打分，按分数取 top-K，同分保持服务器顺序（sortText）
+ * 查询前缀逐字符变长时只在上一轮的命中集合里继续筛选；退格时回到对应长度的命中集合。
+ */
+class CompletionSession {
+  public:
+    // base_query: 请求时光标前的标识符片段，之后的查询必须以它为前缀才能复用本会话
+    CompletionSession(std::vector<CompletionItem> items, const std::string& base_query);
+
+    const std::string& baseQuery() const {
+        return base_query_;
+    }
+    size_t size() const {
+        return items_.size();
+    }
+    bool canServe(const std::string& query) const;
+
+    // 返回按相关度排序的前 limit 项
+    std::vector<CompletionItem> query(const std::string& query, size_t limit);
+
+    // fzy 打分（needle 须为小写；haystack/lower_haystack 为原文及其小写形式）
+    static double score(const std::string& needle, const char* haystack,
+                        const char* lower_haystack, size_t length);
+
+  private:
+    struct Entry {
+        uint32_t offset;
+        uint32_t length;
+        uint64_t mask;
+    };
+
+    static uint64_t charMask(const char* text, size_t length);
+    bool isSubsequence(const std::string& needle, const Entry& entry) const;
+
+    std::vector<CompletionItem> items_;
+    std::vector<Entry> entries_;
+    std::string arena_;       // 所有 filterText 原文首尾相接
+    std::string lower_arena_; // 与 arena_ 等长的小写副本
+    std::string base_query_;
+
+    // 增量缩小：narrowed_[i] 为 chain_query_ 前 i+1 个字符的命中集合
+    std::string chain_query_;
+    std::vector<std::vector<uint32_t>> narrowed_;
+};
+
+/**
+ * 补全会话存储：按 (uri, 行, 标识符起始列, 行内标识符之前的文本) 保存最近的若干个会话。
+ * 同一个标识符上继续输入时直接在本地缩小结果，不再访问 LSP 服务器。
+ * 键只覆盖当前行；其他位置的编辑由调用方 invalidate，服务器声明 isIncomplete 的结果不入库。
+ * 只在 UI 线程使用。
+ */
+class CompletionStore {
+  public:
+    struct SessionKey {
+        std::string uri;
+        int line = 0;
+        int word_start = 0;
+        std::string line_prefix; // 该行 [0, word_start) 的文本：如 "obj." 与 "ptr->" 的候选不同
+
+        bool operator==(const SessionKey& other) const {
+            return line == other.line && word_start == other.word_start && uri == other.uri &&
+                   line_prefix == other.line_prefix;
+        }
+    };
+
+    // 找到能服务 query 的会话；未命中返回 nullptr
+    std::shared_ptr<CompletionSession> find(const SessionKey& key, const std::string& query);
+
+    // 用一次服务器响应建立会话（替换同键的旧会话）
+    std::shared_ptr<CompletionSession> put(const SessionKey& key, std::vector<CompletionItem> items,
+                                           const std::string& base_query);
+
+    void invalidate(const std::string& uri);
+    void clear();
+    size_t size() const {
+        return sessions_.size();
+    }
+
+  private:
+    struct Slot {
+        SessionKey key;
+        std::shared_ptr<CompletionSession> session;
+        std::chrono::steady_clock::time_point created;
+    };
+
+    static constexpr size_t MAX_SESSIONS = 16;
+    static constexpr auto SESSION_TTL = std::chrono::minutes(5);
+
+    // 最近使用的在前；容量很小，线性查找即可
+    std::list<Slot> sessions_;
+};
+
+} // namespace features
+} // namespace pnana
+
+#endif // PNANA_FEATURES_LSP_COMPLETION_STORE_H
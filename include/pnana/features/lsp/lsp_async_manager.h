@@ -1,6 +1,7 @@
 #ifndef PNANA_FEATURES_LSP_LSP_ASYNC_MANAGER_H
 #define PNANA_FEATURES_LSP_LSP_ASYNC_MANAGER_H
 
+#include "core/document_snapshot.h"
 #include "features/lsp/lsp_client.h"
 #include <atomic>
 #include <condition_variable>
@@ -17,7 +18,9 @@ namespace features {
 
 class LspAsyncManager {
   public:
-    using CompletionCallback = std::function<void(std::vector<CompletionItem>)>;
+    // is_incomplete：服务器声明结果不完整，不能在本地继续缩小
+    using CompletionCallback =
+        std::function<void(std::vector<CompletionItem> items, bool is_incomplete)>;
     using ResolveCallback = std::function<void(CompletionItem)>;
     using ErrorCallback = std::function<void(const std::string& error)>;
 
@@ -40,11 +43,15 @@ class LspAsyncManager {
     void requestResolveAsync(LspClient* client, const CompletionItem& item,
                              ResolveCallback on_success, ErrorCallback on_error = nullptr);
 
-    // 异步发送文档打开/变更到 LSP（在 worker 中执行 didOpen/didChange，避免主线程阻塞）
+    // 异步发送文档打开/变更到 LSP（在 worker 中执行 didOpen/didChange，避免主线程阻塞）。
+    // 文本取自快照的前 max_lines 行，拼接也在 worker 中完成
     void requestDocumentOpenAsync(LspClient* client, const std::string& uri,
-                                  const std::string& language_id, const std::string& content);
+                                  const std::string& language_id,
+                                  std::shared_ptr<const core::DocumentSnapshot> snapshot,
+                                  size_t max_lines);
     void requestDocumentChangeAsync(LspClient* client, const std::string& uri,
-                                    const std::string& content, int version);
+                                    std::shared_ptr<const core::DocumentSnapshot> snapshot,
+                                    size_t max_lines, int version);
 
     // 取消所有待处理的请求
     void cancelPendingRequests();
@@ -71,7 +78,8 @@ class LspAsyncManager {
         ResolveCallback resolve_callback;
         ErrorCallback error_callback;
         // DOCUMENT_OPEN / DOCUMENT_CHANGE
-        std::string doc_content;
+        std::shared_ptr<const core::DocumentSnapshot> doc_snapshot;
+        size_t doc_max_lines = 0;
         std::string doc_language_id;
         int doc_version = 0;
     };
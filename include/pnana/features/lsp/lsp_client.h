@@ -94,8 +94,10 @@ class LspClient {
     void didSave(const std::string& uri);
 
     // 代码补全（支持 triggerCharacter 以区分手动触发 vs 字符触发，如 . : -> 等）
+    // is_incomplete 返回 CompletionList.isIncomplete：为 true 时继续输入须重新请求
     std::vector<CompletionItem> completion(const std::string& uri, const LspPosition& position,
-                                           const std::string& trigger_character = "");
+                                           const std::string& trigger_character = "",
+                                           bool* is_incomplete = nullptr);
 
     // 补全项 resolve：获取 detail/documentation（懒解析）
     CompletionItem resolveCompletionItem(const CompletionItem& item);
@@ -1,112 +0,0 @@
-#ifndef PNANA_FEATURES_LSP_LSP_COMPLETION_CACHE_H
-#define PNANA_FEATURES_LSP_LSP_COMPLETION_CACHE_H
-
-#include "features/lsp/lsp_client.h"
-#include <chrono>
-#include <list>
-#include <map>
-#include <mutex>
-#include <optional>
-#include <string>
-#include <vector>
-
-namespace pnana {
-namespace features {
-
-/**
- * 补全缓存
- * 缓存补全结果，支持前缀过滤
- */
-class LspCompletionCache {
-  public:
-    struct CacheKey {
-        std::string uri;
-        int line;
-        int character;
-        std::string prefix;            // 当前输入的前缀
-        std::string context_prefix;    // 更长的上下文前缀（最近的标识符等）
-        std::string semantic_context;  // 语义上下文（函数内、类内等）
-        std::string trigger_character; // 触发字符（., :, ::, ->等）
-
-        bool operator<(const CacheKey& other) const {
-            if (uri != other.uri)
-                return uri < other.uri;
-            if (line != other.line)
-                return line < other.line;
-            if (character != other.character)
-                return character < other.character;
-            if (prefix != other.prefix)
-                return prefix < other.prefix;
-            if (context_prefix != other.context_prefix)
-                return context_prefix < other.context_prefix;
-            if (semantic_context != other.semantic_context)
-                return semantic_context < other.semantic_context;
-            return trigger_character < other.trigger_character;
-        }
-    };
-
-    struct CacheValue {
-        std::vector<CompletionItem> items;
-        std::chrono::steady_clock::time_point timestamp;
-        bool is_complete; // 是否完整（服务器返回的所有结果）
-
-        CacheValue() : is_complete(false) {
-            timestamp = std::chrono::steady_clock::now();
-        }
-    };
-
-    LspCompletionCache();
-
-    // 获取缓存
-    std::optional<std::vector<CompletionItem>> get(const CacheKey& key);
-
-    // 设置缓存
-    void set(const CacheKey& key, const std::vector<CompletionItem>& items,
-             bool is_complete = true);
-
-    // 清除缓存（文档变更时）
-    void invalidate(const std::string& uri);
-
-    // 根据前缀过滤缓存结果
-    std::vector<CompletionItem> filterByPrefix(const CacheKey& key, const std::string& new_prefix,
-                                               const std::string& context_line = "",
-                                               int cursor_col = -1);
-
-    // 获取同一 URI/行的宽松候选项，作为过滤回退使用
-    std::vector<CompletionItem> getFallbackItems(const CacheKey& key);
-
-    // 调试：将补全缓存的过滤链路打印到日志
-    static void setDebugLoggingEnabled(bool enabled);
-
-    // 清除所有缓存
-    void clear();
-
-    // 获取缓存统计信息
-    size_t size() const;
-
-  private:
-    std::map<CacheKey, CacheValue> cache_;
-    // LRU list (most-recent at front)
-    std::list<CacheKey> lru_list_;
-    std::map<CacheKey, std::list<CacheKey>::iterator> lru_index_;
-    mutable std::mutex cache_mutex_;
-
-    static constexpr size_t MAX_CACHE_SIZE = 500; // larger default
-    static constexpr auto CACHE_TTL = std::chrono::minutes(5);
-
-    static inline bool debug_logging_enabled_ = false;
-
-    // 清理过期缓存
-    void cleanupExpired();
-
-    // 清理最旧的缓存项（当缓存满时）
-    void evictOldest();
-
-    // 更新 LRU（move key to front）
-    void touchLRU(const CacheKey& key);
-};
-
-} // namespace features
-} // namespace pnana
-
-#endif // PNANA_FEATURES_LSP_LSP_COMPLETION_CACHE_H
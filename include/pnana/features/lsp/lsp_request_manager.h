@@ -54,6 +54,9 @@ class LspRequestManager {
     void stop();
     bool isRunning() const;
 
+    // Number of queued requests that are still live (cancelled / replaced ones excluded)
+    size_t pendingCount() const;
+
   private:
     void workerLoop();
     struct QueueCompare {
@@ -65,8 +65,14 @@ class LspStdioConnector : public jsonrpccxx::IClientConnector {
     // 获取语言服务器进程 PID（如果可用），否则返回 -1
     int getServerPid() const;
 
+    // start() 解析出的可执行文件完整路径（未启动时为空）
+    const std::string& getExecutablePath() const {
+        return executable_path_;
+    }
+
   private:
     std::string server_command_;
+    std::string executable_path_;
     std::map<std::string, std::string> env_vars_;
 
 #ifdef USE_BOOST_PROCESS
@@ -1,6 +1,7 @@
 #ifndef PNANA_FEATURES_PACKAGE_MANAGER_PACKAGE_MANAGER_BASE_H
 #define PNANA_FEATURES_PACKAGE_MANAGER_PACKAGE_MANAGER_BASE_H
 
+#include "utils/process_executor.h"
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -98,6 +99,34 @@ class PackageManagerBase {
     }
 
   protected:
+    // 本地命令统一经 utils::ProcessExecutor 运行（并发受限，不为每条命令单独起线程），
+    // 代替 popen / system。命令按 sh -c 解释；无法启动时返回 -1，output 为失败原因
+    static int runLocalCommand(const std::string& command, std::string& output) {
+        utils::ProcessResult result =
+            utils::ProcessExecutor::getInstance().run(utils::ProcessRequest::shell(command));
+        output = result.spawned ? std::move(result.output) : result.error;
+        return result.spawned ? result.exit_code : -1;
+    }
+
+    // 异步版本：回调在执行服务的 IO 线程上运行，应只更新缓存等共享状态
+    using LocalCommandCallback = std::function<void(int exit_code, const std::string& output)>;
+    static void runLocalCommandAsync(const std::string& command, LocalCommandCallback on_done) {
+        utils::ProcessExecutor::getInstance().submit(
+            utils::ProcessRequest::shell(command),
+            [on_done = std::move(on_done)](const utils::ProcessResult& result) {
+                if (!result.spawned) {
+                    on_done(-1, result.error);
+                    return;
+                }
+                on_done(result.exit_code, result.output);
+            });
+    }
+
+    // 在 PATH 中查找命令（代替 system("which ...")）
+    static bool localCommandExists(const std::string& name) {
+        return utils::ProcessExecutor::findExecutable(name);
+    }
+
     RemoteExecutor remote_executor_;
     std::string remote_label_;
 };
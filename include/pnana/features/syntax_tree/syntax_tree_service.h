@@ -0,0 +1,99 @@
+#ifndef PNANA_FEATURES_SYNTAX_TREE_SYNTAX_TREE_SERVICE_H
+#define PNANA_FEATURES_SYNTAX_TREE_SYNTAX_TREE_SERVICE_H
+
+#include "core/document.h"
+#include "features/lsp/lsp_types.h"
+#include "utils/bracket_matcher.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef BUILD_TREE_SITTER_SUPPORT
+#include <tree_sitter/api.h>
+#else
+struct TSTree;
+struct TSLanguage;
+#endif
+
+namespace pnana {
+namespace features {
+
+/**
+ * 文档语法树服务：每个文档一棵 Tree-sitter 树，缩进、高亮、括号匹配和无 LSP 时的折叠共用。
+ *
+ * UI 线程在使用前调用 update()：把 Document 编辑日志中的新编辑经 ts_tree_edit 应用到当前树，
+ * 树中节点位置立即与文档一致（结构可能滞后一次解析），再把「编辑后的树 + 文本快照」交给后台
+ * 线程增量重解析。解析结果在下一次 update() 时换入，其间的新编辑会先补上。
+ * 公开接口只在 UI 线程调用。
+ */
+class SyntaxTreeService {
+  public:
+    using ParsedCallback = std::function<void()>;
+
+    SyntaxTreeService();
+    ~SyntaxTreeService();
+
+    SyntaxTreeService(const SyntaxTreeService&) = delete;
+    SyntaxTreeService& operator=(const SyntaxTreeService&) = delete;
+
+    // 后台解析完成时回调（在后台线程执行，编辑器借此 Post 一次刷新）
+    void setParsedCallback(ParsedCallback callback);
+
+    // 同步文档并返回位置与当前版本一致的树；不支持的类型、懒加载大文件或首次解析未完成时返回
+    // nullptr。返回的树在下一次 update()/forget() 之前有效
+    const TSTree* update(const core::Document& doc, const std::string& file_type);
+    // 只读取：文档版本与树一致时返回树，否则返回 nullptr
+    const TSTree* tree(const core::Document& doc) const;
+    // 已换入的解析结果数；派生数据（折叠范围等）据此判断是否需要重算
+    uint64_t generation(const core::Document& doc) const;
+
+    void forget(const core::Document* doc);
+
+    // 光标处括号的匹配位置；括号在字符串、注释内或无法配对时返回 nullopt。需要 tree() 可用
+    std::optional<utils::BracketMatchResult> findMatchingBracket(const core::Document& doc,
+                                                                 size_t row, size_t col) const;
+    // 跨行的具名节点作为折叠范围（同一起始行取最大的范围）
+    std::vector<FoldingRange> foldingRanges(const core::Document& doc) const;
+
+    static TSLanguage* languageForFileType(const std::string& file_type);
+    static bool isAvailable();
+
+  private:
+#ifdef BUILD_TREE_SITTER_SUPPORT
+    struct Entry;
+    struct Job {
+        std::shared_ptr<Entry> entry;
+        TSLanguage* language;
+        TSTree* old_tree; // 已应用全部编辑的树副本，归任务所有
+        // 只读快照（共享行块）；全文在工作线程上拼接，UI 线程不复制整个缓冲区
+        std::shared_ptr<const core::DocumentSnapshot> snapshot;
+        uint64_t version;
+    };
+
+    static void applyEdit(Entry& entry, const core::TextEdit& edit);
+    void schedule(const std::shared_ptr<Entry>& entry, const core::Document& doc);
+    void workerLoop();
+
+    std::unordered_map<const core::Document*, std::shared_ptr<Entry>> entries_;
+
+    std::mutex mutex_; // 保护 jobs_、stopping_ 以及 Entry 中的解析结果字段
+    std::condition_variable cv_;
+    std::deque<Job> jobs_;
+    bool stopping_ = false;
+    std::thread worker_;
+    ParsedCallback parsed_callback_;
+#endif
+};
+
+} // namespace features
+} // namespace pnana
+
+#endif // PNANA_FEATURES_SYNTAX_TREE_SYNTAX_TREE_SERVICE_H
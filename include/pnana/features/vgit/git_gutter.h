@@ -0,0 +1,86 @@
+#ifndef PNANA_VGIT_GIT_GUTTER_H
+#define PNANA_VGIT_GIT_GUTTER_H
+
+#include "features/vgit/git_line_diff.h"
+#include "features/vgit/git_native_repository.h"
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pnana {
+namespace core {
+class Document;
+struct ContentEdit;
+} // namespace core
+
+namespace vgit {
+
+// 编辑器行号旁的 git 变更标记：当前缓冲区内容（而非磁盘文件）与 index 版本的行级 diff。
+// 文档版本变化时按 Document 编辑日志增量更新：平移编辑之后的变更块，只对编辑触及的窗口
+// （扩展到相邻变更块的边界）重新做 diff；日志不可用或基准变化时才整文件比较。
+// 基准 blob 每秒最多检查一次（检测 stage/commit/checkout），读取 index 与解析 blob 在后台进行。
+class GitGutterTracker {
+  public:
+    enum class Mark { NONE, ADDED, MODIFIED, REMOVED_BELOW, REMOVED_ABOVE };
+
+    // 超过该行数的文档不计算（避免大文件每次编辑都做整文件比较）
+    static constexpr size_t MAX_LINES = 100000;
+
+    void update(const std::string& file_path, const core::Document& doc);
+    Mark markForLine(size_t line) const;
+    bool active() const {
+        return has_base_ && !ranges_.empty();
+    }
+    void reset();
+
+  private:
+    struct MarkRange {
+        size_t start;
+        size_t end; // 不含
+        Mark mark;
+    };
+
+    // 后台基准检查的结果；same 表示 blob 与当前基准相同，lines 未读取
+    struct BaseResult {
+        bool found = false;
+        bool same = false;
+        GitOid oid;
+        std::vector<std::string> lines;
+    };
+
+    std::string file_path_;
+    std::string rel_path_;
+    std::unique_ptr<GitNativeRepository> repo_;
+    bool repo_probed_ = false;
+
+    bool base_checked_ = false;
+    bool has_base_ = false;
+    GitOid base_oid_;
+    std::vector<std::string> base_lines_;
+    std::chrono::steady_clock::time_point last_base_check_;
+    // 声明在 repo_ 之后：析构时先等待后台检查结束
+    std::future<BaseResult> base_job_;
+
+    uint64_t version_ = UINT64_MAX;
+    bool hunks_valid_ = false;
+    std::vector<GitLineHunk> hunks_; // 基准与当前内容之间的变更块（按 new_start 有序）
+    std::vector<MarkRange> ranges_;
+
+    bool refreshBase();
+    void rebuildRanges();
+
+    // 按编辑日志更新 hunks：edits 的坐标基于各自发生前的内容，hunks 基于第一个编辑之前的内容。
+    // 窗口越界等无法增量处理的情况返回 false，调用方整文件重算
+    static bool patchHunks(std::vector<GitLineHunk>& hunks,
+                           const std::vector<std::string>& base_lines,
+                           const std::vector<std::string>& lines,
+                           const std::vector<core::ContentEdit>& edits);
+};
+
+} // namespace vgit
+} // namespace pnana
+
+#endif // PNANA_VGIT_GIT_GUTTER_H
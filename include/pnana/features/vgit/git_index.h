@@ -0,0 +1,66 @@
+#ifndef PNANA_VGIT_GIT_INDEX_H
+#define PNANA_VGIT_GIT_INDEX_H
+
+#include "features/vgit/git_object_store.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pnana {
+namespace vgit {
+
+// .git/index 中的单个条目（仅保留 stat 比较所需字段）
+struct GitIndexEntry {
+    std::string path;
+    GitOid oid;
+    uint32_t ctime_sec = 0;
+    uint32_t ctime_nsec = 0;
+    uint32_t mtime_sec = 0;
+    uint32_t mtime_nsec = 0;
+    uint32_t dev = 0;
+    uint32_t ino = 0;
+    uint32_t mode = 0;
+    uint32_t uid = 0;
+    uint32_t gid = 0;
+    uint32_t size = 0;
+    uint16_t stage = 0;
+    bool assume_valid = false;
+    bool skip_worktree = false;
+    bool intent_to_add = false;
+};
+
+// .git/index 读取器（支持 v2/v3/v4），按 index 文件 mtime/size 判断是否需要重新解析
+class GitIndex {
+  public:
+    // 若 index 未变化则直接返回 true，不重新解析
+    bool load(const std::string& index_path);
+
+    const std::vector<GitIndexEntry>& entries() const {
+        return entries_;
+    }
+    const GitIndexEntry* find(const std::string& path) const;
+
+    // racy-git：条目 mtime 不早于 index 自身 mtime 时，stat 相等也不能证明内容未变
+    bool isRacy(const GitIndexEntry& entry) const;
+
+    // 每次成功重新解析后递增，供上层缓存失效
+    uint64_t generation() const {
+        return generation_;
+    }
+
+  private:
+    std::vector<GitIndexEntry> entries_;
+    std::unordered_map<std::string, size_t> by_path_;
+    int64_t index_mtime_sec_ = 0;
+    int64_t index_mtime_nsec_ = 0;
+    int64_t index_size_ = -1;
+    uint64_t generation_ = 0;
+
+    bool parse(const std::string& data);
+};
+
+} // namespace vgit
+} // namespace pnana
+
+#endif // PNANA_VGIT_GIT_INDEX_H
@@ -0,0 +1,44 @@
+#ifndef PNANA_VGIT_GIT_LINE_DIFF_H
+#define PNANA_VGIT_GIT_LINE_DIFF_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace pnana {
+namespace vgit {
+
+// 行级变更块：old_* 为基准版本（HEAD/index）中的范围，new_* 为当前内容中的范围（0-based）
+struct GitLineHunk {
+    enum class Kind { ADDED, MODIFIED, DELETED };
+
+    Kind kind = Kind::MODIFIED;
+    size_t old_start = 0;
+    size_t old_count = 0;
+    size_t new_start = 0;
+    size_t new_count = 0;
+};
+
+class GitLineDiff {
+  public:
+    // 先裁掉公共前后缀，再对中间部分做 O(ND) Myers；编辑距离超过 max_edit_distance
+    // 时退化为一个覆盖整个中间区域的 MODIFIED 块，保证最坏情况有界
+    static std::vector<GitLineHunk> compute(const std::vector<std::string>& old_lines,
+                                            const std::vector<std::string>& new_lines,
+                                            size_t max_edit_distance = 2000);
+
+    // 生成与 `git diff` 相同格式的统一 diff 文本（按行）
+    static std::vector<std::string> toUnifiedDiff(const std::string& path,
+                                                  const std::vector<std::string>& old_lines,
+                                                  const std::vector<std::string>& new_lines,
+                                                  const std::vector<GitLineHunk>& hunks,
+                                                  size_t context = 3);
+
+    // 将 blob 内容按 '\n' 拆分为行（去掉 '\r'，末尾换行不产生空行，与 Document::load 一致）
+    static std::vector<std::string> splitLines(const std::string& content);
+};
+
+} // namespace vgit
+} // namespace pnana
+
+#endif // PNANA_VGIT_GIT_LINE_DIFF_H
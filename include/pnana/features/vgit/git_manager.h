@@ -12,6 +12,8 @@
 namespace pnana {
 namespace vgit {
 
+class GitNativeRepository;
+
 enum class GitFileStatus {
     UNMODIFIED = 0,
     MODIFIED = 1,
@@ -78,7 +80,7 @@ class GitManager {
     using RemoteExecutor = std::function<std::pair<bool, std::string>(const std::string&)>;
 
     GitManager(const std::string& repo_path = ".");
-    ~GitManager() = default;
+    ~GitManager();
 
     // SSH 远程支持
     void setRemoteExecutor(RemoteExecutor executor, const std::string& label,
@@ -116,6 +118,17 @@ class GitManager {
     std::vector<GitCommit> getRecentCommits(int count = 10);
     std::vector<GitCommit> getGraphCommits(
         int count = 50, int skip = 0); // Get commits for graph view (supports skip for pagination)
+    // Parse one `git log --graph --pretty=format:"%x1f%H|%P|%s|%an|%ad"` line
+    // (returns false for pure graph connector lines)
+    static bool parseGraphLine(const std::string& line, GitCommit& out);
+
+    // Blob content by revision spec ("HEAD:path", ":path", "<oid>")
+    bool readBlob(const std::string& spec, std::string& out);
+
+    // spec -> blob 内容；GitService 用长驻 `git cat-file --batch` 提供，
+    // 作为原生对象库读不到 blob 时的后备（nullptr 取消）
+    using BlobReader = std::function<bool(const std::string& spec, std::string& data)>;
+    void setBlobFallback(BlobReader reader);
 
     // Branch operations
     std::vector<GitBranch> getBranches();
@@ -155,6 +168,13 @@ class GitManager {
     RemoteExecutor remote_executor_;
     std::string remote_label_;
 
+    // 本地仓库的进程内读取器（status / diff / 当前分支不再派生 git 子进程）
+    // 远程模式或不支持时为空，回退到 git 命令
+    std::unique_ptr<GitNativeRepository> native_;
+    BlobReader blob_fallback_;
+    bool native_probed_ = false;
+    GitNativeRepository* nativeRepository();
+
     // Status caching for performance optimization
     std::chrono::steady_clock::time_point last_status_refresh_;
     std::chrono::milliseconds status_cache_timeout_{2000}; // 2 seconds cache
@@ -172,6 +192,7 @@ class GitManager {
     std::vector<std::string> executeGitCommandLines(const std::string& command) const;
     GitFileStatus parseStatusChar(char status_char) const;
     void parseStatusLine(const std::string& line, std::vector<GitFile>& files);
+    bool loadStatus();
     std::string escapePath(const std::string& path) const;
 };
 
@@ -0,0 +1,92 @@
+#ifndef PNANA_VGIT_GIT_NATIVE_REPOSITORY_H
+#define PNANA_VGIT_GIT_NATIVE_REPOSITORY_H
+
+#include "features/vgit/git_index.h"
+#include "features/vgit/git_manager.h"
+#include "features/vgit/git_object_store.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pnana {
+namespace vgit {
+
+// 进程内 Git 仓库读取：直接解析 .git/index 与对象库计算状态和 diff，不派生 git 子进程。
+// 仅覆盖只读查询（status / diff / 当前分支），写操作仍由 GitManager 调用 git 命令完成。
+class GitNativeRepository {
+  public:
+    // 从 path 向上查找 .git；不是仓库、使用 linked worktree 或未编译 zlib 支持时返回 nullptr
+    static std::unique_ptr<GitNativeRepository> open(const std::string& path);
+
+    const std::string& workTree() const {
+        return work_tree_;
+    }
+    const std::string& gitDir() const {
+        return git_dir_;
+    }
+
+    // 当前分支名（分离 HEAD 时为空）
+    std::string currentBranch();
+
+    // 等价于 `git status --porcelain=v2` 的结果：每个路径一条，staged 状态优先
+    bool computeStatus(std::vector<GitFile>& files, std::string& error);
+
+    // 行级 diff 的基准版本：index 中的 blob，不在 index 时退回 HEAD
+    bool baseBlob(const std::string& rel_path, GitOid& oid);
+    bool readBlobLines(const GitOid& oid, std::vector<std::string>& lines);
+
+    // 对象库解析不了的 blob（缺少 pack 索引、不支持的 pack 格式等）交给 git 读取
+    void setBlobFallback(GitManager::BlobReader fallback);
+
+    // 与 GitManager::getDiff 相同语义：先取工作区 vs index，为空时取 index vs HEAD
+    std::vector<std::string> unifiedDiff(const std::string& rel_path);
+
+    // 绝对路径 -> 仓库内相对路径；不在工作区内时返回空串
+    std::string relativePath(const std::string& path) const;
+
+  private:
+    GitNativeRepository(const std::string& work_tree, const std::string& git_dir);
+
+    struct IgnoreRule {
+        std::string base; // 规则所在目录（相对路径，以 '/' 结尾或为空）
+        std::string pattern;
+        bool negate = false;
+        bool dir_only = false;
+        bool anchored = false;
+    };
+
+    // 仅在 stat 不能证明未修改时才哈希文件内容；结果按 stat 签名缓存
+    struct HashCacheEntry {
+        int64_t mtime_sec = 0;
+        int64_t mtime_nsec = 0;
+        int64_t size = -1;
+        uint64_t ino = 0;
+        GitOid oid;
+    };
+
+    std::string work_tree_;
+    std::string git_dir_;
+    GitObjectStore store_;
+    GitIndex index_;
+    std::unordered_map<std::string, HashCacheEntry> hash_cache_;
+    std::vector<IgnoreRule> global_ignores_;
+    GitManager::BlobReader blob_fallback_;
+    std::mutex mutex_;
+
+    bool worktreeBlobLocked(const std::string& rel_path, GitOid& oid, bool& exists);
+    bool isWorktreeModifiedLocked(const GitIndexEntry& entry, bool& deleted);
+    void collectUntrackedLocked(std::vector<GitFile>& files);
+    void loadIgnoreFile(const std::string& file, const std::string& base,
+                        std::vector<IgnoreRule>& rules) const;
+    bool isIgnored(const std::vector<IgnoreRule>& rules, const std::string& rel_path,
+                   bool is_dir) const;
+    bool readWorktreeLines(const std::string& rel_path, std::vector<std::string>& lines,
+                           bool& binary);
+};
+
+} // namespace vgit
+} // namespace pnana
+
+#endif // PNANA_VGIT_GIT_NATIVE_REPOSITORY_H
@@ -0,0 +1,141 @@
+#ifndef PNANA_VGIT_GIT_OBJECT_STORE_H
+#define PNANA_VGIT_GIT_OBJECT_STORE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pnana {
+namespace vgit {
+
+// 20 字节 SHA-1 对象 ID
+struct GitOid {
+    std::array<uint8_t, 20> bytes{};
+
+    bool isNull() const;
+    std::string toHex() const;
+    static bool fromHex(const std::string& hex, GitOid& out);
+
+    bool operator==(const GitOid& other) const {
+        return bytes == other.bytes;
+    }
+    bool operator!=(const GitOid& other) const {
+        return bytes != other.bytes;
+    }
+    bool operator<(const GitOid& other) const {
+        return bytes < other.bytes;
+    }
+};
+
+struct GitOidHash {
+    size_t operator()(const GitOid& oid) const;
+};
+
+enum class GitObjectType { NONE = 0, COMMIT = 1, TREE = 2, BLOB = 3, TAG = 4 };
+
+struct GitObject {
+    GitObjectType type = GitObjectType::NONE;
+    std::string data;
+};
+
+// 最小 SHA-1 实现，仅用于计算 blob 对象 ID（与 `git hash-object` 一致）
+class GitSha1 {
+  public:
+    GitSha1();
+    void update(const void* data, size_t len);
+    GitOid finish();
+
+    static GitOid hashObject(GitObjectType type, const char* data, size_t len);
+
+  private:
+    uint32_t state_[5];
+    uint64_t total_len_ = 0;
+    uint8_t block_[64];
+    size_t block_len_ = 0;
+
+    void processBlock(const uint8_t* block);
+};
+
+// 进程内 Git 对象读取器：loose 对象 + pack（idx v2），支持 OFS/REF delta
+// 不派生任何子进程；需要 zlib（BUILD_NATIVE_GIT_SUPPORT）
+class GitObjectStore {
+  public:
+    explicit GitObjectStore(const std::string& git_dir);
+    ~GitObjectStore();
+
+    GitObjectStore(const GitObjectStore&) = delete;
+    GitObjectStore& operator=(const GitObjectStore&) = delete;
+
+    static bool isSupported();
+
+    bool readObject(const GitOid& oid, GitObject& out);
+
+    // 引用解析：HEAD / refs/heads/x / packed-refs，支持符号引用
+    bool resolveRef(const std::string& ref, GitOid& out);
+    // 返回 HEAD 指向的分支引用（"refs/heads/main"），分离 HEAD 时返回空串
+    std::string readSymbolicHead() const;
+
+    // HEAD commit 的根 tree
+    bool readHeadTree(GitOid& tree_out);
+    // 在 tree 中按路径查找 blob
+    bool findInTree(const GitOid& tree, const std::string& path, GitOid& out, uint32_t* mode_out);
+    // 将 tree 展开为 path -> blob oid（按 tree oid 缓存最近一次结果）
+    const std::map<std::string, GitOid>& flattenTree(const GitOid& tree);
+
+    // packs 目录变化（fetch/gc 后）重新扫描
+    void reloadPacks();
+
+  private:
+    struct MappedFile;
+    struct PackFile;
+
+    std::string git_dir_;
+    std::vector<std::unique_ptr<PackFile>> packs_;
+    bool packs_loaded_ = false;
+    std::mutex mutex_;
+
+    // delta base 缓存（pack 内偏移 -> 对象），避免长 delta 链重复解压
+    struct BaseCacheKey {
+        const PackFile* pack;
+        uint64_t offset;
+        bool operator==(const BaseCacheKey& o) const {
+            return pack == o.pack && offset == o.offset;
+        }
+    };
+    struct BaseCacheKeyHash {
+        size_t operator()(const BaseCacheKey& k) const {
+            return std::hash<const void*>()(k.pack) ^ std::hash<uint64_t>()(k.offset * 31);
+        }
+    };
+    std::unordered_map<BaseCacheKey, GitObject, BaseCacheKeyHash> base_cache_;
+    std::list<BaseCacheKey> base_cache_lru_;
+    static constexpr size_t BASE_CACHE_MAX = 64;
+
+    GitOid flattened_tree_oid_;
+    std::map<std::string, GitOid> flattened_tree_;
+
+    void loadPacksLocked();
+    bool readLooseLocked(const GitOid& oid, GitObject& out);
+    bool readPackedLocked(const GitOid& oid, GitObject& out);
+    bool readPackEntryLocked(PackFile& pack, uint64_t offset, GitObject& out, int depth);
+    bool findInPack(const PackFile& pack, const GitOid& oid, uint64_t& offset) const;
+    void cacheBaseLocked(const BaseCacheKey& key, const GitObject& obj);
+    // loose + 已加载的 pack，不重新扫描；delta base 查找用这个
+    bool readStoredLocked(const GitOid& oid, GitObject& out);
+    // 顶层查找：找不到时重新扫描 pack 目录再试一次（会释放所有 PackFile）
+    bool readObjectLocked(const GitOid& oid, GitObject& out);
+    void flattenTreeLocked(const GitOid& tree, const std::string& prefix,
+                           std::map<std::string, GitOid>& out, int depth);
+};
+
+} // namespace vgit
+} // namespace pnana
+
+#endif // PNANA_VGIT_GIT_OBJECT_STORE_H
@@ -0,0 +1,50 @@
+#ifndef PNANA_VGIT_GIT_PROCESS_H
+#define PNANA_VGIT_GIT_PROCESS_H
+
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace pnana {
+namespace vgit {
+
+// 长驻 git 子进程（stdin/stdout 管道），用于流式 `git log` 与 `git cat-file --batch`。
+// 与 popen 不同：可以随时终止，析构时不会等待 git 输出完整个历史。
+class GitPipeProcess {
+  public:
+    GitPipeProcess() = default;
+    ~GitPipeProcess();
+
+    GitPipeProcess(const GitPipeProcess&) = delete;
+    GitPipeProcess& operator=(const GitPipeProcess&) = delete;
+
+    // argv[0] 通过 PATH 查找；stderr 重定向到 /dev/null
+    bool start(const std::vector<std::string>& argv, bool with_stdin);
+    bool running() const {
+        return pid_ > 0;
+    }
+
+    // 读取一行（不含 '\n'）；EOF 返回 false
+    bool readLine(std::string& line);
+    // 精确读取 n 字节
+    bool readExact(size_t n, std::string& out);
+    bool writeAll(const std::string& data);
+
+    // SIGTERM 并回收子进程
+    void terminate();
+
+  private:
+    pid_t pid_ = -1;
+    int stdin_fd_ = -1;
+    int stdout_fd_ = -1;
+    std::string buffer_;
+    size_t buffer_pos_ = 0;
+    bool eof_ = false;
+
+    bool fill();
+};
+
+} // namespace vgit
+} // namespace pnana
+
+#endif // PNANA_VGIT_GIT_PROCESS_H
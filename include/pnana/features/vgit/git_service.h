@@ -0,0 +1,94 @@
+#ifndef PNANA_VGIT_GIT_SERVICE_H
+#define PNANA_VGIT_GIT_SERVICE_H
+
+#include "features/vgit/git_manager.h"
+#include "features/vgit/git_process.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pnana {
+namespace vgit {
+
+// Git 后台服务：单个常驻线程按顺序执行请求，替代每次刷新新建 std::thread / std::async。
+// - 带 coalesce key 的请求在队列中合并（重复刷新只执行一次，使用最新的回调）
+// - 图视图使用一个长驻 `git log --graph` 进程，按页读取，不再每页 --skip 重新遍历历史
+// - blob 读取复用一个长驻 `git cat-file --batch` 进程；它同时是 GitManager 原生对象库
+//   读不到 blob 时的后备
+// 回调在服务线程上执行，调用方自行加锁更新 UI 数据。
+class GitService {
+  public:
+    using Task = std::function<void(GitManager&)>;
+    using GraphPageCallback = std::function<void(std::vector<GitCommit> commits, bool eof)>;
+    using BlobCallback = std::function<void(bool ok, std::string data)>;
+
+    explicit GitService(GitManager& manager);
+    ~GitService();
+
+    GitService(const GitService&) = delete;
+    GitService& operator=(const GitService&) = delete;
+
+    // coalesce_key 为空时总是入队；否则替换队列中尚未执行的同 key 请求（保持原有位置）
+    void post(const std::string& coalesce_key, Task task);
+
+    // 读取图视图的下一页（从长驻 log 流继续读）；第一次调用时启动 git log
+    void requestGraphPage(size_t count, GraphPageCallback callback);
+    // 丢弃当前 log 流（提交 / 切换分支 / 切换仓库后），下一次请求从头开始
+    void resetGraph();
+
+    // 仓库上下文变化（本地 <-> SSH 远程）：结束所有长驻进程
+    void resetRepository();
+
+    // spec: "HEAD:path" / ":path" / "<oid>"
+    void readBlob(const std::string& spec, BlobCallback callback);
+
+    // 在服务线程空闲时同步执行（用于切换仓库上下文等必须与后台任务互斥的操作）
+    void runExclusive(const std::function<void(GitManager&)>& fn);
+
+    bool isBusy() const {
+        return busy_.load();
+    }
+    size_t pendingCount();
+
+  private:
+    struct Request {
+        std::string key;
+        Task task;
+    };
+
+    GitManager& manager_;
+    std::thread worker_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<Request> queue_;
+    bool stopping_ = false;
+    std::atomic<bool> busy_{false};
+
+    // 仅在服务线程（或持有 exec_mutex_ 时）访问
+    std::mutex exec_mutex_;
+    GitPipeProcess log_stream_;
+    bool log_stream_started_ = false;
+    bool log_stream_eof_ = false;
+    size_t log_commits_read_ = 0;
+    std::atomic<uint64_t> graph_generation_{0};
+    uint64_t log_stream_generation_ = 0;
+    // 作为后备读取时可能在调用 GitManager 的任意线程上使用
+    std::mutex cat_file_mutex_;
+    GitPipeProcess cat_file_;
+
+    void workerLoop();
+    void syncGraphGeneration();
+    bool readGraphPage(size_t count, std::vector<GitCommit>& commits);
+    bool readBlobBatch(const std::string& spec, std::string& data);
+};
+
+} // namespace vgit
+} // namespace pnana
+
+#endif // PNANA_VGIT_GIT_SERVICE_H
@@ -1,6 +1,7 @@
 #ifndef PNANA_INPUT_EVENT_PARSER_H
 #define PNANA_INPUT_EVENT_PARSER_H
 
+#include "input/key_chord.h"
 #include <ftxui/component/event.hpp>
 #include <string>
 
@@ -28,8 +29,15 @@ class EventParser {
 
     // 将事件转换为标准化的键字符串
     // 例如：Ctrl+S -> "ctrl_s", Alt+A -> "alt_a", F3 -> "f3"
+    // 结果按事件输入缓存（每线程一份，所有 EventParser 实例共享），重复按键只查一次表
     std::string eventToKey(const ftxui::Event& event) const;
 
+    // 将事件转换为紧凑的键组合编码（与 eventToKey 的结果一一对应，无法识别时为 chord::NONE）
+    KeyChord eventToChord(const ftxui::Event& event) const;
+
+    // 不经缓存的完整解析（缓存未命中时使用）
+    std::string parseKey(const ftxui::Event& event) const;
+
     // 解析修饰键
     Modifiers parseModifiers(const ftxui::Event& event) const;
 
@@ -0,0 +1,78 @@
+#ifndef PNANA_INPUT_EVENT_RECORDER_H
+#define PNANA_INPUT_EVENT_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <ftxui/component/event.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pnana {
+namespace input {
+
+// 录制日志中的一条记录
+struct RecordedEvent {
+    enum class Kind { OPEN, EVENT };
+
+    Kind kind = Kind::EVENT;
+    int64_t elapsed_us = 0; // 距录制开始的微秒数
+    std::string path;       // OPEN: 打开的文件
+    ftxui::Event event = ftxui::Event::Custom;
+};
+
+/**
+ * 事件录制：把进入编辑器的每个 FTXUI 事件写成文本日志（pnana --record-events FILE），
+ * 供 tests/editor_replay_benchmark 离屏回放。
+ *
+ * 每行一条记录，制表符分隔，字节内容一律十六进制编码：
+ *   <us>  o  <path>                                     启动时打开的文件
+ *   <us>  c  <input>                                    字符输入
+ *   <us>  s  <input>                                    特殊键（方向键、Ctrl 组合、功能键等）
+ *   <us>  m  <input> <button> <motion> <mods> <x> <y>  鼠标事件
+ * 以 # 开头的行为注释。Event::Custom 是内部重绘信号，不录制。
+ */
+class EventRecorder {
+  public:
+    static EventRecorder& getInstance() {
+        static EventRecorder instance;
+        return instance;
+    }
+
+    bool start(const std::string& path);
+    void stop();
+
+    bool isRecording() const {
+        return recording_.load(std::memory_order_relaxed);
+    }
+
+    void recordOpen(const std::string& filepath);
+    void record(const ftxui::Event& event);
+
+    // 单行序列化 / 解析；parseLine 对注释和空行返回 false
+    static std::string formatEvent(const ftxui::Event& event, int64_t elapsed_us);
+    static bool parseLine(const std::string& line, RecordedEvent& out);
+
+    // 读取整份日志；无法打开时返回 false
+    static bool load(const std::string& path, std::vector<RecordedEvent>& out, std::string& error);
+
+  private:
+    EventRecorder() = default;
+    ~EventRecorder();
+    EventRecorder(const EventRecorder&) = delete;
+    EventRecorder& operator=(const EventRecorder&) = delete;
+
+    int64_t elapsedMicros() const;
+
+    std::atomic<bool> recording_{false};
+    std::mutex mutex_;
+    std::ofstream out_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace input
+} // namespace pnana
+
+#endif // PNANA_INPUT_EVENT_RECORDER_H
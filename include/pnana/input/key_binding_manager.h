@@ -3,6 +3,7 @@
 
 #include "input/event_parser.h"
 #include "input/key_action.h"
+#include "input/key_chord.h"
 #include <ftxui/component/event.hpp>
 #include <map>
 #include <string>
@@ -13,6 +14,8 @@ namespace input {
 
 // 快捷键绑定管理器
 // 职责：管理快捷键到动作的映射，支持配置和查询
+// 绑定以键字符串登记（配置、帮助界面使用），同时编译成 KeyChord -> 动作的扁平哈希表，
+// 按键分发只做一次整数查表；插件键映射按模式各编译一张表
 class KeyBindingManager {
   public:
     KeyBindingManager();
@@ -20,6 +23,12 @@ class KeyBindingManager {
 
     // 获取事件对应的动作
     KeyAction getAction(const ftxui::Event& event) const;
+    KeyAction getAction(KeyChord chord) const;
+
+    // 事件的键组合编码（供调用方一次解析、多次查表）
+    KeyChord getChord(const ftxui::Event& event) const {
+        return parser_.eventToChord(event);
+    }
 
     // 绑定快捷键到动作
     void bindKey(const std::string& key, KeyAction action);
@@ -42,6 +51,16 @@ class KeyBindingManager {
     // 重置为默认绑定
     void resetToDefaults();
 
+    // 插件键映射（vim.keymap.set 的左侧，如 "<C-s>"、"<F2>"）。只有能表示为单个键组合的
+    // 映射进入分发表，返回 false 的（多键序列、普通字符）只能通过命令触发
+    bool bindPluginKeymap(const std::string& mode, const std::string& lhs);
+    void unbindPluginKeymap(const std::string& mode, const std::string& lhs);
+    bool hasPluginKeymaps() const {
+        return !plugin_tables_.empty();
+    }
+    // 返回命中的 lhs（交给 PluginManager::handleKeymap），未命中为 nullptr
+    const std::string* findPluginKeymap(const std::string& mode, KeyChord chord) const;
+
     // 从配置加载绑定（未来扩展）
     // void loadFromConfig(const std::string& config_path);
 
@@ -58,6 +77,18 @@ class KeyBindingManager {
     // 动作到键的映射（支持一个动作多个快捷键）
     std::map<KeyAction, std::vector<std::string>> action_to_keys_;
 
+    // key_to_action_ 的编译结果。只收录规范键字符串（eventToKey 可能产生的写法），
+    // "ctrl_arrow_up" 这类别名与原来一样不会被按键命中
+    ChordTable<KeyAction> action_table_;
+
+    // 插件键映射：mode -> lhs -> 编码，以及按模式编译的 编码 -> lhs 表
+    std::map<std::string, std::map<std::string, KeyChord>> plugin_keymaps_;
+    std::map<std::string, ChordTable<std::string>> plugin_tables_;
+
+    void compileKey(const std::string& key, KeyAction action);
+    void compileActionTable();
+    void compilePluginTable(const std::string& mode);
+
     // 初始化默认绑定
     void initializeDefaultBindings();
 
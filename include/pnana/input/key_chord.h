@@ -0,0 +1,147 @@
+#ifndef PNANA_INPUT_KEY_CHORD_H
+#define PNANA_INPUT_KEY_CHORD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pnana {
+namespace input {
+
+// 紧凑的按键组合编码：低 21 位是键（Unicode 码点或下面的命名键），高位是修饰键。
+// 与 eventToKey 产生的键字符串一一对应（"ctrl_shift_k" <-> CTRL|SHIFT|'k'），
+// 快捷键分发按整数查表，不再构造和比较字符串
+using KeyChord = uint32_t;
+
+namespace chord {
+
+constexpr KeyChord NONE = 0; // 无法识别的事件 / 空键
+constexpr KeyChord KEY_MASK = 0x1FFFFF;
+
+// 修饰键位
+constexpr KeyChord CTRL = 1u << 24;
+constexpr KeyChord ALT = 1u << 25;
+constexpr KeyChord SHIFT = 1u << 26;
+constexpr KeyChord META = 1u << 27;
+constexpr KeyChord SPACE = 1u << 28; // Space 前缀组合，如 "space_a"
+
+// 命名键：位于 Unicode 范围之外
+constexpr KeyChord KEY_F1 = 0x110000; // F1..F12 连续
+constexpr KeyChord KEY_F12 = KEY_F1 + 11;
+constexpr KeyChord KEY_HOME = 0x110020;
+constexpr KeyChord KEY_END = 0x110021;
+constexpr KeyChord KEY_PAGE_UP = 0x110022;
+constexpr KeyChord KEY_PAGE_DOWN = 0x110023;
+constexpr KeyChord KEY_UP = 0x110024;
+constexpr KeyChord KEY_DOWN = 0x110025;
+constexpr KeyChord KEY_LEFT = 0x110026;
+constexpr KeyChord KEY_RIGHT = 0x110027;
+constexpr KeyChord KEY_ESCAPE = 0x110028;
+constexpr KeyChord KEY_RETURN = 0x110029;
+constexpr KeyChord KEY_BACKSPACE = 0x11002A;
+constexpr KeyChord KEY_DELETE = 0x11002B;
+constexpr KeyChord KEY_TAB = 0x11002C;
+
+} // namespace chord
+
+// "ctrl_shift_k"、"alt_arrow_up"、"f3" 等键字符串 -> 编码；无法识别时返回 chord::NONE
+KeyChord keyToChord(const std::string& key);
+
+// 编码 -> eventToKey 使用的规范键字符串（keyToChord 的逆）
+std::string chordToKey(KeyChord chord);
+
+// 插件键映射左侧（Vim 记法，如 "<C-s>"、"<A-g>"、"<F2>"、"<S-Tab>"）-> 编码。
+// 只接受单个带修饰键或命名键的组合；多键序列和普通字符返回 chord::NONE
+KeyChord vimKeyToChord(const std::string& lhs);
+
+// 以 KeyChord 为键的扁平开放寻址哈希表（线性探测，负载因子不超过 1/2）。
+// 绑定很少变化：只支持插入/覆盖和整体清空，删除由调用方重建整张表
+template <typename T>
+class ChordTable {
+  public:
+    void assign(KeyChord key, T value) {
+        if (key == chord::NONE) {
+            return;
+        }
+        if ((size_ + 1) * 2 > slots_.size()) {
+            grow();
+        }
+        Slot& slot = probe(key);
+        if (slot.key == chord::NONE) {
+            slot.key = key;
+            ++size_;
+        }
+        slot.value = std::move(value);
+    }
+
+    const T* find(KeyChord key) const {
+        if (size_ == 0 || key == chord::NONE) {
+            return nullptr;
+        }
+        size_t mask = slots_.size() - 1;
+        for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots_[i];
+            if (slot.key == key) {
+                return &slot.value;
+            }
+            if (slot.key == chord::NONE) {
+                return nullptr;
+            }
+        }
+    }
+
+    void clear() {
+        slots_.clear();
+        size_ = 0;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+  private:
+    struct Slot {
+        KeyChord key = chord::NONE;
+        T value{};
+    };
+
+    std::vector<Slot> slots_; // 容量为 2 的幂
+    size_t size_ = 0;
+
+    static size_t hash(KeyChord key) {
+        // 修饰键在高位：先折叠到低位再混合，表的下标只取低位
+        uint32_t h = key ^ (key >> 16);
+        h *= 0x45D9F3Bu;
+        h ^= h >> 16;
+        return static_cast<size_t>(h);
+    }
+
+    Slot& probe(KeyChord key) {
+        size_t mask = slots_.size() - 1;
+        size_t i = hash(key) & mask;
+        while (slots_[i].key != chord::NONE && slots_[i].key != key) {
+            i = (i + 1) & mask;
+        }
+        return slots_[i];
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(slots_);
+        slots_.resize(old.empty() ? 16 : old.size() * 2);
+        for (auto& slot : old) {
+            if (slot.key != chord::NONE) {
+                Slot& target = probe(slot.key);
+                target.key = slot.key;
+                target.value = std::move(slot.value);
+            }
+        }
+    }
+};
+
+} // namespace input
+} // namespace pnana
+
+#endif // PNANA_INPUT_KEY_CHORD_H
@@ -0,0 +1,52 @@
+#ifndef PNANA_PLUGINS_AUTOCMD_INDEX_H
+#define PNANA_PLUGINS_AUTOCMD_INDEX_H
+
+#ifdef BUILD_LUA_SUPPORT
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pnana {
+namespace plugins {
+
+/**
+ * 同一事件下所有 autocmd 的 pattern 预编译成的索引
+ *
+ * 触发事件时不再逐个 autocmd 做字符串匹配，而是按文件扩展名查桶，只有真正的通配模式才逐个匹配：
+ *   - 空 pattern、"*"         -> 总是匹配
+ *   - "*.ext"                 -> 扩展名桶（O(1) 查找）
+ *   - 其他含 * ? [ 的模式      -> glob（含 '/' 时匹配完整路径或其结尾，否则匹配文件名）
+ *   - 不含通配符              -> 路径子串匹配（与原有行为一致）
+ * 以逗号分隔的多个模式（"*.c,*.h"）任一匹配即可。文件路径为空时所有 autocmd 都匹配
+ */
+class AutocmdPatternIndex {
+  public:
+    AutocmdPatternIndex() = default;
+    explicit AutocmdPatternIndex(const std::vector<std::string>& patterns);
+
+    // 匹配 filepath 的 autocmd 下标，按注册顺序升序
+    std::vector<size_t> match(const std::string& filepath) const;
+
+    size_t size() const {
+        return count_;
+    }
+
+  private:
+    size_t count_ = 0;
+    std::vector<size_t> always_;
+    std::unordered_map<std::string, std::vector<size_t>> by_extension_;
+    std::vector<std::pair<size_t, std::string>> substrings_;
+    std::vector<std::pair<size_t, std::string>> globs_;
+
+    void add(size_t index, const std::string& pattern);
+};
+
+} // namespace plugins
+} // namespace pnana
+
+#endif // BUILD_LUA_SUPPORT
+
+#endif // PNANA_PLUGINS_AUTOCMD_INDEX_H
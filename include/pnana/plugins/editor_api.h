@@ -3,11 +3,13 @@
 #ifndef PNANA_PLUGINS_EDITOR_API_H
 #define PNANA_PLUGINS_EDITOR_API_H
 
+#include <cstdint>
 #include <lua.hpp>
 
 namespace pnana {
 namespace core {
 class Editor;
+class Document;
 }
 namespace plugins {
 
@@ -15,7 +17,8 @@ namespace plugins {
  * @brief 编辑器操作相关的 Lua API
  * 处理文档操作、光标操作等编辑器核心功能
  *
- * 注册到 vim.api 命名空间
+ * 注册到 vim.api 命名空间。除单行接口外，vim.api.get_buf() 返回 buffer 句柄（userdata，
+ * 按文档实例 id 绑定），提供整段读写、流式行迭代和修改订阅，供格式化、lint 等处理整篇文档的插件使用
  */
 class EditorAPI {
   public:
@@ -25,6 +28,9 @@ class EditorAPI {
     // 注册所有编辑器相关的 API 函数
     void registerFunctions(lua_State* L);
 
+    // 压入绑定到 doc_id 的 buffer 句柄（修改订阅回调的第一个参数）
+    static void pushBuffer(lua_State* L, uint64_t doc_id);
+
   private:
     core::Editor* editor_;
 
@@ -37,9 +43,33 @@ class EditorAPI {
     static int lua_fn_set_line(lua_State* L);
     static int lua_fn_insert_text(lua_State* L);
     static int lua_fn_delete_line(lua_State* L);
+    static int lua_fn_get_buf(lua_State* L);
+    static int lua_fn_get_lines(lua_State* L);
+    static int lua_fn_set_lines(lua_State* L);
+
+    // buffer 句柄方法（buf:get_lines(a, b) 等）
+    static int lua_buf_id(lua_State* L);
+    static int lua_buf_is_valid(lua_State* L);
+    static int lua_buf_line_count(lua_State* L);
+    static int lua_buf_get_lines(lua_State* L);
+    static int lua_buf_set_lines(lua_State* L);
+    static int lua_buf_lines(lua_State* L);
+    static int lua_buf_on_change(lua_State* L);
+    static int lua_buf_detach(lua_State* L);
+    static int lua_buf_tostring(lua_State* L);
+
+    // buf:lines() 迭代器
+    static int lua_line_iter_next(lua_State* L);
+    static int lua_line_iter_gc(lua_State* L);
 
     // 辅助函数
     static core::Editor* getEditorFromLua(lua_State* L);
+    static void registerBufferMetatables(lua_State* L);
+    // 检查第 index 个参数是 buffer 句柄，返回其文档；文档已关闭返回 nullptr
+    static core::Document* checkBuffer(lua_State* L, int index, uint64_t* doc_id = nullptr);
+    // get_lines / set_lines 的公共实现：范围参数从 first_arg 开始
+    static int getLinesImpl(lua_State* L, core::Document* doc, int first_arg);
+    static int setLinesImpl(lua_State* L, core::Document* doc, int first_arg);
 };
 
 } // namespace plugins
@@ -3,16 +3,19 @@
 
 #ifdef BUILD_LUA_SUPPORT
 
+#include "plugins/autocmd_index.h"
 #include "plugins/editor_api.h"
 #include "plugins/event_parser_api.h"
 #include "plugins/file_api.h"
 #include "plugins/icon_api.h"
 #include "plugins/lua_engine.h"
 #include "plugins/lua_ui_runtime.h"
+#include "plugins/plugin_scheduler.h"
 #include "plugins/system_api.h"
 #include "plugins/theme_api.h"
 #include "plugins/ui_api.h"
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <string>
@@ -108,8 +111,22 @@ class LuaAPI {
     // 定时器：延迟执行一次
     int deferFunction(int callback_ref, int delay_ms);
     void cancelDeferred(int timer_id);
+    // 推进 defer 队列，并让调度器在本帧预算内继续运行挂起的插件任务
     void processDeferred();
 
+    // 是否有需要下一帧继续的插件工作：被时间片打断的任务，或已到期的 defer 回调
+    bool hasPendingTasks() const;
+
+    // buffer 修改订阅（buf:on_change）：callback_ref 的所有权交给 LuaAPI。
+    // 每帧比较文档版本，把期间的编辑合成一批 (range, text) 交给调度器
+    int attachBuffer(uint64_t doc_id, uint64_t version, int callback_ref);
+    bool detachBuffer(int subscription_id);
+
+    // 插件 worker（vim.worker.*）：on_message_ref 的所有权交给调度器
+    int startWorker(const std::string& source, int on_message_ref);
+    bool sendToWorker(int worker_id, const std::string& message);
+    bool stopWorker(int worker_id);
+
     // 获取编辑器实例
     core::Editor* getEditor() {
         return editor_;
@@ -120,6 +137,11 @@ class LuaAPI {
         return engine_;
     }
 
+    // 获取插件回调调度器
+    PluginScheduler* getScheduler() {
+        return scheduler_.get();
+    }
+
     // 获取FileAPI实例（用于设置路径验证器）
     FileAPI* getFileAPI() {
         return file_api_.get();
@@ -156,6 +178,9 @@ class LuaAPI {
     };
     std::map<std::string, std::vector<AutocmdInfo>> autocmds_;
 
+    // 每个事件的 pattern 索引，首次触发时构建；autocmd 增删时丢弃对应事件的索引
+    std::map<std::string, AutocmdPatternIndex> autocmd_indexes_;
+
     // 命令映射: name -> callback (旧API兼容)
     std::map<std::string, std::string> commands_;
 
@@ -185,10 +210,25 @@ class LuaAPI {
         int callback_ref;
         std::chrono::steady_clock::time_point due;
         bool cancelled;
+        std::string plugin_owner;
     };
     int next_timer_id_ = 1;
     std::vector<DeferredCall> deferred_calls_;
 
+    // buffer 修改订阅：version 为上次投递时的文档版本
+    struct BufferSubscription {
+        int id;
+        uint64_t doc_id;
+        uint64_t version;
+        int callback_ref;
+        std::string plugin_owner;
+    };
+    int next_subscription_id_ = 1;
+    std::vector<BufferSubscription> buffer_subscriptions_;
+
+    // 投递已订阅文档自上次以来的修改；文档已关闭的订阅随之移除
+    void processBufferChanges();
+
     // 键位映射: mode -> keys -> callback (旧API兼容)
     std::map<std::string, std::map<std::string, std::string>> keymaps_;
 
@@ -208,6 +248,9 @@ class LuaAPI {
     // 当前正在加载/执行回调的插件上下文
     std::string current_plugin_context_;
 
+    // 插件回调（autocmd、事件监听、defer_fn、worker 消息）都在调度器的协程里运行
+    std::unique_ptr<PluginScheduler> scheduler_;
+
     // 注册 API 函数
     void registerAPIFunctions();
 
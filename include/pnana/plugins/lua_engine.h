@@ -65,6 +65,19 @@ class LuaEngine {
     // 调用 Lua 函数
     bool callFunction(const std::string& funcName, int nargs = 0, int nresults = 0);
 
+    // 带执行时限的 lua_pcall：同步执行的插件代码（加载、命令、键映射）超过时限时
+    // 由指令计数钩子抛出错误，避免死循环冻结编辑器。嵌套调用共用最外层的时限
+    int protectedCall(int nargs, int nresults);
+
+    // 执行时限（毫秒），<= 0 表示不限
+    void setExecutionTimeout(int timeout_ms) {
+        execution_timeout_ms_ = timeout_ms;
+    }
+
+    int getExecutionTimeout() const {
+        return execution_timeout_ms_;
+    }
+
     // 检查错误
     bool checkError(int result);
 
@@ -76,6 +89,7 @@ class LuaEngine {
 
   private:
     lua_State* L_;
+    int execution_timeout_ms_ = 0;
 
     // 错误处理
     void handleError(const std::string& context);
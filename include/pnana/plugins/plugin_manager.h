@@ -95,9 +95,12 @@ class PluginManager {
         return lua_api_.get();
     }
 
-    // 处理 defer_fn 延迟任务
+    // 处理 defer_fn 延迟任务，并继续运行被时间片打断的插件任务
     void processDeferred();
 
+    // 是否需要再要一帧来继续插件任务
+    bool hasPendingTasks() const;
+
   private:
     core::Editor* editor_;
     std::unique_ptr<LuaEngine> lua_engine_;
@@ -0,0 +1,175 @@
+#ifndef PNANA_PLUGINS_PLUGIN_SCHEDULER_H
+#define PNANA_PLUGINS_PLUGIN_SCHEDULER_H
+
+#ifdef BUILD_LUA_SUPPORT
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <lauxlib.h>
+#include <lua.h>
+#include <lualib.h>
+}
+
+// lua_getextraspace / lua_isyieldable 自 Lua 5.3 起提供（CMake 配置时同样检查）
+#if LUA_VERSION_NUM < 503
+#error "The plugin scheduler requires Lua 5.3 or newer"
+#endif
+
+namespace pnana {
+namespace plugins {
+
+class PluginWorker;
+
+/**
+ * @brief 插件回调的协作式调度器
+ *
+ * 每个回调（autocmd、事件监听、defer_fn、worker 消息）在自己的协程（lua_newthread）里运行，
+ * 指令计数钩子定期检查时间：超过本帧时间片就在钩子里让出，留到下一帧 tick() 继续执行；
+ * 累计运行时间超过执行时限（SandboxConfig::max_execution_time_ms）则抛错终止。
+ * 一个死循环或很慢的插件只会拖慢自己，不会冻结界面
+ */
+class PluginScheduler {
+  public:
+    // 向协程压入要调用的函数和参数，返回参数个数；返回 -1 表示没有可调用的函数（任务不创建）
+    using PushCall = std::function<int(lua_State*)>;
+
+    explicit PluginScheduler(lua_State* L);
+    ~PluginScheduler();
+
+    PluginScheduler(const PluginScheduler&) = delete;
+    PluginScheduler& operator=(const PluginScheduler&) = delete;
+
+    // 创建任务并立即运行第一个时间片；没跑完的留到 tick()。返回是否创建了任务
+    bool spawn(const std::string& label, const std::string& owner, const PushCall& push);
+    // 立即运行到结束，不按时间片让出，只受执行时限约束：用于 BufWritePre 等必须在操作继续前
+    // 完成的回调。回调主动 coroutine.yield 时余下部分照常留到 tick()
+    bool runNow(const std::string& label, const std::string& owner, const PushCall& push);
+
+    // 每帧调用：收取 worker 消息，并在帧预算内继续运行挂起的任务
+    void tick();
+
+    // 是否还有挂起的任务（调用方据此请求下一帧；worker 消息通过唤醒回调通知）
+    bool hasPending() const;
+
+    // 插件卸载：丢弃它的任务，停止它的 worker
+    void cancelOwner(const std::string& owner);
+
+    // 单个任务累计运行时间上限（毫秒），<= 0 表示不限
+    void setTaskTimeout(int timeout_ms) {
+        task_timeout_ms_ = timeout_ms;
+    }
+
+    // worker 有新消息时调用（可能在 worker 线程中），用于唤醒主循环
+    void setWakeCallback(std::function<void()> wake) {
+        wake_ = std::move(wake);
+    }
+
+    // 启动独立 lua_State 的 worker 线程；source 是 worker 的 Lua 代码，
+    // on_message_ref 是主状态中收到 worker 消息时调用的函数引用（由调度器负责释放）
+    int startWorker(const std::string& owner, const std::string& source, int on_message_ref);
+    bool sendToWorker(int worker_id, const std::string& message);
+    bool stopWorker(int worker_id);
+
+  private:
+    struct Task {
+        int thread_ref;
+        lua_State* thread;
+        std::string label;
+        std::string owner;
+        std::chrono::steady_clock::duration elapsed{};
+        int nargs;
+    };
+
+    struct WorkerHandle {
+        int id;
+        std::string owner;
+        int on_message_ref;
+        std::unique_ptr<PluginWorker> worker;
+    };
+
+    lua_State* L_;
+    std::deque<Task> tasks_;
+    std::vector<WorkerHandle> workers_;
+    int next_worker_id_ = 1;
+    int task_timeout_ms_ = 0;
+    std::function<void()> wake_;
+
+    bool startTask(const std::string& label, const std::string& owner, const PushCall& push,
+                   bool preemptible);
+    // 运行任务一个时间片（preemptible 为 false 时不按时间片让出）；返回 true 表示任务结束
+    bool resume(Task& task, std::chrono::steady_clock::duration slice, bool preemptible = true);
+    void finish(Task& task);
+    void drainWorkers();
+    std::vector<WorkerHandle>::iterator findWorker(int worker_id);
+    void releaseWorker(std::vector<WorkerHandle>::iterator it);
+};
+
+/**
+ * @brief 运行在独立线程和独立 lua_State 中的插件 worker
+ *
+ * worker 状态只加载安全的标准库，没有编辑器 API；与主状态之间只通过字符串消息通信：
+ * worker 侧的 post(msg) / receive([timeout_ms]) 对应主状态的 on_message 回调与 send()
+ */
+class PluginWorker {
+  public:
+    PluginWorker(std::string source, std::function<void()> notify);
+    ~PluginWorker();
+
+    PluginWorker(const PluginWorker&) = delete;
+    PluginWorker& operator=(const PluginWorker&) = delete;
+
+    void send(const std::string& message);
+    void stop();
+
+    // 取出 worker 发出的消息（主线程调用）
+    std::vector<std::string> takeOutbox();
+
+    bool finished() const {
+        return finished_.load();
+    }
+
+    // 脚本出错时的错误信息（finished() 之后有效）
+    std::string error() const;
+
+  private:
+    std::string source_;
+    std::function<void()> notify_;
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<bool> finished_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable inbox_cv_;
+    std::deque<std::string> inbox_;
+    std::vector<std::string> outbox_;
+    std::string error_;
+    std::thread thread_;
+
+    void run();
+
+    // 等待收件箱有消息；超时返回 true（收件箱可能为空），被停止时返回 false
+    bool waitForInbox(long long timeout_ms);
+    bool popInbox(std::string& message);
+
+    static PluginWorker* fromLua(lua_State* L);
+    static int lua_post(lua_State* L);
+    static int lua_receive(lua_State* L);
+    static int lua_print(lua_State* L);
+    static void stopHook(lua_State* L, lua_Debug* ar);
+};
+
+} // namespace plugins
+} // namespace pnana
+
+#endif // BUILD_LUA_SUPPORT
+
+#endif // PNANA_PLUGINS_PLUGIN_SCHEDULER_H
@@ -42,6 +42,7 @@ class SystemAPI {
     static int lua_fn_system(lua_State* L);
     static int lua_fn_systemlist(lua_State* L);
     static int lua_fn_systemlist_async(lua_State* L); // 异步版本
+    static int lua_fn_systemlist_cancel(lua_State* L);
     static int lua_fn_notify(lua_State* L);
 
     // 命令相关 API
@@ -60,8 +61,14 @@ class SystemAPI {
     // 定时器 API
     static int lua_fn_defer_fn(lua_State* L);
     static int lua_fn_defer_cancel(lua_State* L);
+    static int lua_fn_schedule(lua_State* L);
     static int lua_fn_hrtime(lua_State* L);
 
+    // worker API（独立 lua_State 的后台线程）
+    static int lua_fn_worker_start(lua_State* L);
+    static int lua_fn_worker_send(lua_State* L);
+    static int lua_fn_worker_stop(lua_State* L);
+
     // 日志 API
     static int lua_log_info(lua_State* L);
     static int lua_log_warn(lua_State* L);
@@ -6,6 +6,7 @@
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/component_base.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/box.hpp>
 #include <functional>
 #include <iomanip>
 #include <memory>
@@ -138,8 +139,9 @@ class AIAssistantPanel {
     std::string current_input_;
     size_t cursor_pos_; // 光标位置
     int selected_message_index_;
-    int scroll_offset_;         // 顶部跳过行数（按行滚动，不再按消息条数）
-    int estimated_total_lines_; // 消息区预估总行数，用于限制滚动范围
+    int scroll_offset_;       // 顶部跳过行数（按行滚动，不再按消息条数）
+    int total_lines_;         // 消息区总行数（按折行结果精确计算），用于限制滚动范围
+    ftxui::Box messages_box_; // 上一帧消息区的位置，用于得到可见行数
     bool is_streaming_;
     std::string current_streaming_model_;
 
@@ -160,9 +162,20 @@ class AIAssistantPanel {
     std::string current_conversation_topic_;
     int conversation_turn_count_;
 
+    // 消息按宽度折好的行，与 messages_ 一一对应，跨帧复用。
+    // 已完成的消息按内容哈希与宽度判断是否失效；流式消息只追加，每次只重排最后一行
+    struct MessageLayout {
+        int width = -1;
+        size_t content_size = 0;
+        size_t content_hash = 0;
+        std::vector<std::string> lines;
+        std::vector<size_t> line_starts;
+    };
+    std::vector<MessageLayout> layouts_;
+
     // 最大显示消息数
     static constexpr size_t MAX_VISIBLE_MESSAGES = 50;
-    // 按行滚动：一页行数、消息区可见行数（用于计算最大滚动）
+    // 按行滚动：一页行数、首帧之前假定的消息区可见行数
     static constexpr int SCROLL_PAGE_LINES = 15;
     static constexpr int MESSAGE_VIEWPORT_LINES = 25;
 
@@ -177,7 +190,15 @@ class AIAssistantPanel {
     ftxui::Element renderMessages();
     ftxui::Element renderInput();
     ftxui::Element renderActionButtons();
-    ftxui::Element renderMessage(const ChatMessage& message);
+    ftxui::Element renderMessageHeader(const ChatMessage& message);
+    ftxui::Elements renderMessageStatus();
+    const MessageLayout& layoutMessage(size_t index, int width);
+    int messageRowCount(size_t index, int width);
+    // 第 index 条消息中 [first_row, last_row) 范围内的行
+    void renderMessageRows(size_t index, int width, int first_row, int last_row,
+                           ftxui::Elements& rows);
+    int viewportLines() const;
+    int maxScrollOffset() const;
 
     void scrollUp();
     void scrollDown();
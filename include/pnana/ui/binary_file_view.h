@@ -1,27 +1,104 @@
 #ifndef PNANA_UI_BINARY_FILE_VIEW_H
 #define PNANA_UI_BINARY_FILE_VIEW_H
 
+#include "features/hex_view/hex_buffer.h"
 #include "ui/theme.h"
+#include <ftxui/component/event.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 
 namespace pnana {
 namespace ui {
 
-// 二进制文件视图组件 - 显示无法打开的二进制文件提示
+/**
+ * 二进制文件视图：十六进制 / ASCII 双栏，只渲染可见的行（文件经 mmap 按页调入）。
+ *
+ * 每个文件一个会话（光标、滚动位置、补丁、搜索状态），分屏中同时显示多个二进制文件时互不干扰。
+ * 按键：方向键 / PageUp / PageDown / Home / End 移动，g 或 Ctrl+G 跳转到偏移，
+ * / 或 Ctrl+F 搜索字节序列（后台线程），n 查找下一个，p 切换补丁模式（输入十六进制数字改写
+ * 当前字节，u 还原），Ctrl+S 只写回修改过的页。无法映射时退回到原来的提示界面。
+ */
 class BinaryFileView {
   public:
+    using UIDispatcher = std::function<void(std::function<void()>)>;
+
     explicit BinaryFileView(Theme& theme);
+    ~BinaryFileView();
+
+    // 后台搜索的结果经 dispatcher 回到 UI 线程；传入空函数后不再投递
+    void setUIDispatcher(UIDispatcher dispatcher);
 
-    // 设置文件路径
+    // 设置文件路径（切换到该文件的会话，首次打开时建立映射）
     void setFilePath(const std::string& filepath);
 
     // 渲染二进制文件视图
     ftxui::Element render();
 
+    // 处理当前文件的按键，返回是否已处理
+    bool handleInput(ftxui::Event event);
+
+    // 把当前文件的补丁写回磁盘；message 为状态栏提示
+    bool save(std::string& message);
+    bool hasUnsavedPatches() const;
+
   private:
+    enum class Prompt { NONE, GOTO_OFFSET, SEARCH };
+
+    struct Session {
+        features::HexBuffer buffer;
+        uint64_t cursor = 0;
+        uint64_t top_row = 0;
+        bool patch_mode = false;
+        bool low_nibble = false; // 补丁模式下已输入当前字节的高半字节
+        std::string pattern;     // 最近一次搜索的字节序列
+        int64_t match = -1;
+        uint64_t search_generation = 0;
+        features::HexSearchWorker search;
+        Prompt prompt = Prompt::NONE;
+        std::string prompt_input;
+        std::string message;
+        ftxui::Box rows_box; // 上一帧字节区域的位置，用于计算可见行数
+        uint64_t last_used = 0;
+    };
+
+    // 搜索线程与视图共享：析构或清空 dispatcher 后完成的搜索直接丢弃
+    struct SearchShared {
+        std::mutex mutex;
+        UIDispatcher dispatcher;
+    };
+
+    static constexpr uint64_t BYTES_PER_ROW = 16;
+    static constexpr size_t MAX_IDLE_SESSIONS = 8;
+
+    ftxui::Element renderNotice(const std::string& reason);
+    ftxui::Element renderHeader(const Session& session);
+    ftxui::Element renderRows(Session& session, int rows);
+    ftxui::Element renderFooter(const Session& session);
+
+    bool handlePromptInput(Session& session, const ftxui::Event& event);
+    bool handlePatchInput(Session& session, const std::string& ch);
+    void submitPrompt(Session& session);
+    void startSearch(Session& session, uint64_t from);
+    void moveCursor(Session& session, int64_t delta);
+    void scrollToCursor(Session& session);
+    int visibleRows(const Session& session) const;
+    void dropIdleSessions();
+
+    // "0x1f00" / "1f00h" 为十六进制，其余按十进制；前缀 +/- 表示相对当前光标
+    static bool parseOffset(const std::string& input, uint64_t cursor, uint64_t& offset);
+    // 十六进制字节（可用空格分隔），或用引号括起的文本
+    static bool parsePattern(const std::string& input, std::string& bytes);
+
     Theme& theme_;
     std::string filepath_;
+    std::map<std::string, std::unique_ptr<Session>> sessions_;
+    Session* active_ = nullptr;
+    uint64_t use_counter_ = 0;
+    std::shared_ptr<SearchShared> search_shared_;
 };
 
 } // namespace ui
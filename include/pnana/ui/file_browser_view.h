@@ -39,6 +39,15 @@ class FileBrowserView {
     // SSH 远程状态栏元数据缓存：path -> "size|perm"
     mutable std::unordered_map<std::string, std::pair<std::string, std::string>> remote_stat_cache_;
 
+    // 文件图标与颜色缓存：file name -> {icon, color}。图标/颜色规则含特殊文件名
+    // （Dockerfile、package.json 等），因此按完整文件名而不是扩展名缓存
+    struct FileStyle {
+        std::string icon;
+        ftxui::Color color;
+    };
+    mutable std::unordered_map<std::string, FileStyle> file_style_cache_;
+    const FileStyle& getFileStyle(const std::string& filename) const;
+
     std::pair<std::string, std::string> getRemoteSizeAndPermission(
         const features::FileBrowser& browser, const features::FileItem& item) const;
 
@@ -53,14 +62,14 @@ class FileBrowserView {
                                   size_t visible_count) const;
     ftxui::Element renderStatusBar(const features::FileBrowser& browser) const;
     ftxui::Element renderFileInfoBar(const features::FileBrowser& browser) const;
+    // ancestors[d] 是 item 在深度 d 的祖先
     ftxui::Element renderFileItem(const features::FileItem* item, size_t index,
                                   size_t selected_index,
-                                  const std::vector<features::FileItem*>& flat_items,
+                                  const std::vector<const features::FileItem*>& ancestors,
                                   const features::FileBrowser& browser) const;
-    std::string buildTreePrefix(const features::FileItem* item, size_t index,
-                                const std::vector<features::FileItem*>& flat_items) const;
-    std::string buildExpandPrefix(const features::FileItem* item, size_t index,
-                                  const std::vector<features::FileItem*>& flat_items) const;
+    std::string buildTreePrefix(const features::FileItem* item,
+                                const std::vector<const features::FileItem*>& ancestors) const;
+    std::string buildExpandPrefix(const features::FileItem* item) const;
     std::string buildSpacePrefix(const features::FileItem* item) const; // 使用空格代替树形连接线
 };
 
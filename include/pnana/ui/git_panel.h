@@ -2,10 +2,12 @@
 #define PNANA_VGIT_GIT_PANEL_H
 
 #include "features/vgit/git_manager.h"
+#include "features/vgit/git_service.h"
 #include "ui/theme.h"
 #include "utils/file_type_icon_mapper.h"
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/component_base.hpp>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -147,6 +149,9 @@ class GitPanel {
 
     // Graph loading state
     bool graph_loading_ = false; // true when more graph commits are being fetched
+    bool graph_eof_ = false;     // true when the git log stream has been fully consumed
+    // 每次重置图视图时递增（data_mutex_ 保护）；重置前发出的分页结果据此丢弃
+    uint64_t graph_generation_ = 0;
 
     GitBranchStatus cached_branch_status_;
     std::chrono::steady_clock::time_point last_branch_status_update_;
@@ -168,6 +173,9 @@ class GitPanel {
     void performCreateBranch();
     void performSwitchBranch();
     void refreshStatusOnly();
+    void loadMoreGraphCommits();
+    // 与 git 服务线程互斥地执行同步操作（GitManager 不是线程安全的）；失败时写入 error_message_
+    bool runGitOperation(const std::function<bool(GitManager&)>& op);
     void updateCachedStats(); // Update cached statistics for performance
     void showDiffViewer(const std::string& file_path);
     void hideDiffViewer();
@@ -225,6 +233,10 @@ class GitPanel {
     GitBranchStatus getCachedBranchStatus();
     std::string getFileExtension(const std::string& filename) const;
     void ensureValidIndices();
+
+  private:
+    // 后台 git 请求队列；放在最后，析构时最先停止，保证任务不会访问已销毁的成员
+    std::unique_ptr<GitService> git_service_;
 };
 
 } // namespace vgit
@@ -92,7 +92,11 @@ class Statusbar {
                           const std::string& ssh_host = "", const std::string& ssh_user = "");
 
     // Git相关方法（公共接口）
+    // 同步执行 git status，只能在后台线程调用；UI 线程提交到 ProcessExecutor 后用 parseGitStatus
     static std::tuple<std::string, int> getGitInfo();
+    // 解析 `git status --porcelain --branch` 的输出：(当前分支, 未提交文件数)
+    static std::tuple<std::string, int> parseGitStatus(const std::string& output);
+    static constexpr int GIT_STATUS_TIMEOUT_MS = 5000;
 
   private:
     Theme& theme_;
@@ -121,10 +125,6 @@ class Statusbar {
     // 创建状态指示器
     ftxui::Element createIndicator(const std::string& icon, const std::string& label,
                                    ftxui::Color fg_color, ftxui::Color bg_color);
-
-    // Git相关方法
-    static std::string getGitBranch();
-    static int getGitUncommittedCount();
 };
 
 } // namespace ui
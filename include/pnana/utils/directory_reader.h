@@ -0,0 +1,37 @@
+#ifndef PNANA_UTILS_DIRECTORY_READER_H
+#define PNANA_UTILS_DIRECTORY_READER_H
+
+#include <string>
+#include <vector>
+
+namespace pnana {
+namespace utils {
+
+struct DirectoryEntry {
+    std::string name;
+    bool is_directory = false; // 指向目录的符号链接也算目录
+};
+
+/**
+ * 读取一个目录的直接子项（不含 "." 与 ".."）
+ *
+ * Linux 上用 getdents64 批量读取，类型取自 d_type；只有文件系统不提供类型（DT_UNKNOWN）
+ * 或条目是符号链接时才对该条目 stat。不获取大小、时间等其他属性。
+ * 可在后台线程调用。
+ *
+ * @param path 目录路径
+ * @param include_hidden 是否包含以 '.' 开头的条目
+ * @param entries 输出（清空后填充，未排序）
+ * @return 目录无法打开时返回 false
+ */
+bool readDirectory(const std::string& path, bool include_hidden,
+                   std::vector<DirectoryEntry>& entries);
+
+// 文件浏览器的顺序：目录在前，名称大小写不敏感，相同时按原名称。
+// 每个条目的小写键只计算一次
+void sortDirectoryEntries(std::vector<DirectoryEntry>& entries);
+
+} // namespace utils
+} // namespace pnana
+
+#endif // PNANA_UTILS_DIRECTORY_READER_H
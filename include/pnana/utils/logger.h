@@ -1,6 +1,7 @@
 #ifndef PNANA_UTILS_LOGGER_H
 #define PNANA_UTILS_LOGGER_H
 
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <map>
@@ -11,10 +12,13 @@
 namespace pnana {
 namespace utils {
 
+enum class LogLevel { DEBUG = 0, INFO = 1, WARNING = 2, ERROR = 3 };
+
 /**
  * 简单的日志系统
  * 将调试信息写入日志文件，避免影响界面
  * 只有在调用 initialize() 后才会写入日志文件
+ * 便捷宏先做无锁的级别检查，未启用时不会构造消息字符串
  */
 class Logger {
   public:
@@ -23,8 +27,19 @@ class Logger {
     // 初始化日志文件（可选，只有调用此方法后才会写入日志）
     void initialize(const std::string& log_file = "pnana.log");
 
-    // 检查日志是否已启用
-    bool isEnabled() const;
+    // 检查日志是否已启用（无锁，可在热路径调用）
+    bool isEnabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+    bool shouldLog(LogLevel level) const {
+        return isEnabled() &&
+               static_cast<int>(level) >= min_level_.load(std::memory_order_relaxed);
+    }
+
+    // 最低输出级别（默认 DEBUG；也可由环境变量 PNANA_LOG_LEVEL=debug|info|warn|error 设置）
+    void setMinLevel(LogLevel level) {
+        min_level_.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
 
     // 写入日志（如果未初始化，则静默忽略）
     void log(const std::string& message);
@@ -32,9 +47,7 @@ class Logger {
     void logWarning(const std::string& message);
     void logDebug(const std::string& message);
 
-    // 性能埋点功能
-    void startTiming(const std::string& label);
-    void endTiming(const std::string& label, const std::string& context = "");
+    // 性能埋点功能（区间计时见 utils/perf_monitor.h 的 PERF_ZONE）
     void recordMetric(const std::string& metric_name, long long value,
                       const std::string& context = "");
 
@@ -50,27 +63,38 @@ class Logger {
     std::ofstream log_file_;
     mutable std::mutex log_mutex_;
     bool initialized_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<int> min_level_{static_cast<int>(LogLevel::DEBUG)};
 
-    // 性能埋点相关
-    std::map<std::string, std::chrono::steady_clock::time_point> timing_points_;
-    std::mutex timing_mutex_;
+    // 时间戳的秒级部分每秒只格式化一次（持有 log_mutex_ 时访问）
+    long long cached_second_ = -1;
+    std::string cached_second_text_;
 
     void writeLog(const std::string& level, const std::string& message);
-    std::string getTimestamp();
+    void writeTimestamp();
 };
 
-// 便捷宏
-#define LOG(msg) pnana::utils::Logger::getInstance().log(msg)
-#define LOG_INFO(msg) pnana::utils::Logger::getInstance().log(msg)
-#define LOG_ERROR(msg) pnana::utils::Logger::getInstance().logError(msg)
-#define LOG_WARNING(msg) pnana::utils::Logger::getInstance().logWarning(msg)
-#define LOG_DEBUG(msg) pnana::utils::Logger::getInstance().logDebug(msg)
+// 便捷宏：级别检查通过后才对 msg 求值
+#define PNANA_LOG_AT(level, method, msg)                                                           \
+    do {                                                                                           \
+        auto& pnana_logger_ = pnana::utils::Logger::getInstance();                                 \
+        if (pnana_logger_.shouldLog(level))                                                        \
+            pnana_logger_.method(msg);                                                             \
+    } while (0)
+
+#define LOG(msg) PNANA_LOG_AT(pnana::utils::LogLevel::INFO, log, msg)
+#define LOG_INFO(msg) PNANA_LOG_AT(pnana::utils::LogLevel::INFO, log, msg)
+#define LOG_ERROR(msg) PNANA_LOG_AT(pnana::utils::LogLevel::ERROR, logError, msg)
+#define LOG_WARNING(msg) PNANA_LOG_AT(pnana::utils::LogLevel::WARNING, logWarning, msg)
+#define LOG_DEBUG(msg) PNANA_LOG_AT(pnana::utils::LogLevel::DEBUG, logDebug, msg)
 
 // 性能埋点宏
-#define LOG_TIMING_START(label) pnana::utils::Logger::getInstance().startTiming(label)
-#define LOG_TIMING_END(label, context) pnana::utils::Logger::getInstance().endTiming(label, context)
 #define LOG_METRIC(name, value, context)                                                           \
-    pnana::utils::Logger::getInstance().recordMetric(name, value, context)
+    do {                                                                                           \
+        auto& pnana_logger_ = pnana::utils::Logger::getInstance();                                 \
+        if (pnana_logger_.isEnabled())                                                             \
+            pnana_logger_.recordMetric(name, value, context);                                      \
+    } while (0)
 
 } // namespace utils
 } // namespace pnana
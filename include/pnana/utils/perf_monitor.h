@@ -0,0 +1,146 @@
+#ifndef PNANA_UTILS_PERF_MONITOR_H
+#define PNANA_UTILS_PERF_MONITOR_H
+
+#include "utils/logger.h"
+#include "utils/perf_trace.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace pnana {
+namespace utils {
+
+// 每帧计数器：在一帧内累加（或设置），endFrame() 时写入 RENDER_FRAME 事件并清零
+enum class PerfCounter : uint32_t {
+    LINES_HIGHLIGHTED = 0, // 本帧语法高亮的行段数
+    PTY_BYTES_FED,         // 本帧喂给终端模拟器的字节数
+    LSP_QUEUE_DEPTH,       // 帧末 LSP 请求队列长度（快照值）
+    COUNT
+};
+
+struct PerfFrameStats {
+    size_t frames = 0;
+    int64_t p50_us = 0;
+    int64_t p95_us = 0;
+    int64_t p99_us = 0;
+    int64_t max_us = 0;
+};
+
+// 区间表第三列：是否在普通 --log 下也计时并输出 "TIMING [name]: Nms"
+inline bool perfZoneLogged(PerfZoneId zone) {
+    constexpr bool logged[] = {
+#define PNANA_PERF_ZONE_LOG(id, name, log) log,
+        PNANA_PERF_ZONES(PNANA_PERF_ZONE_LOG)
+#undef PNANA_PERF_ZONE_LOG
+    };
+    return logged[static_cast<size_t>(zone)];
+}
+
+/**
+ * 性能监视：计时区间、每帧计数器与帧耗时分位数
+ * 仅当 trace（文件或内存采集）或状态栏 HUD 开启时才采集，否则 PERF_ZONE 只做两次原子读；
+ * 标记为 log 的区间在日志开启时也计时。
+ * endFrame / frameStats / hudText 只在 UI 线程调用。
+ */
+class PerfMonitor {
+  public:
+    static PerfMonitor& getInstance() {
+        static PerfMonitor instance;
+        return instance;
+    }
+
+    bool isActive() const {
+        return hud_enabled_.load(std::memory_order_relaxed) || PERF_TRACE_ENABLED();
+    }
+
+    // 状态栏 HUD；开启时同时启动内存采集，便于随后导出 Chrome trace
+    void setHudEnabled(bool enabled);
+    bool isHudEnabled() const {
+        return hud_enabled_.load(std::memory_order_relaxed);
+    }
+
+    void addZoneTime(PerfZoneId zone, int64_t ns) {
+        zone_ns_[static_cast<size_t>(zone)].fetch_add(ns, std::memory_order_relaxed);
+    }
+    void addCounter(PerfCounter counter, int64_t value) {
+        counters_[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+    void setCounter(PerfCounter counter, int64_t value) {
+        counters_[static_cast<size_t>(counter)].store(value, std::memory_order_relaxed);
+    }
+
+    // 一帧结束：记录帧耗时，输出计数器事件并清零本帧累计
+    void endFrame(int64_t frame_ns);
+
+    PerfFrameStats frameStats();
+    // 状态栏显示文本，例如 "frame p50 1.2ms p95 3.4ms p99 8.0ms | editor 0.9ms | hl 42"
+    std::string hudText();
+
+  private:
+    static constexpr size_t FRAME_HISTORY = 240;
+    static constexpr size_t ZONE_COUNT = static_cast<size_t>(PerfZoneId::COUNT);
+    static constexpr size_t COUNTER_COUNT = static_cast<size_t>(PerfCounter::COUNT);
+
+    PerfMonitor() = default;
+    PerfMonitor(const PerfMonitor&) = delete;
+    PerfMonitor& operator=(const PerfMonitor&) = delete;
+
+    std::atomic<bool> hud_enabled_{false};
+    std::array<std::atomic<int64_t>, ZONE_COUNT> zone_ns_{};
+    std::array<std::atomic<int64_t>, COUNTER_COUNT> counters_{};
+
+    // UI 线程专用
+    std::array<int64_t, FRAME_HISTORY> frame_us_{};
+    size_t frame_count_ = 0;
+    std::array<int64_t, ZONE_COUNT> last_zone_ns_{};
+    std::array<int64_t, COUNTER_COUNT> last_counters_{};
+    PerfFrameStats cached_stats_;
+    size_t cached_stats_frame_ = 0;
+};
+
+// 计时区间（RAII）；可提前调用 end() 结束
+class PerfZoneScope {
+  public:
+    explicit PerfZoneScope(PerfZoneId zone)
+        : zone_(zone), active_(PerfMonitor::getInstance().isActive() ||
+                               (perfZoneLogged(zone) && Logger::getInstance().isEnabled())) {
+        if (active_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~PerfZoneScope() {
+        end();
+    }
+    PerfZoneScope(const PerfZoneScope&) = delete;
+    PerfZoneScope& operator=(const PerfZoneScope&) = delete;
+
+    void end();
+
+  private:
+    PerfZoneId zone_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define PNANA_PERF_CONCAT_INNER(a, b) a##b
+#define PNANA_PERF_CONCAT(a, b) PNANA_PERF_CONCAT_INNER(a, b)
+
+// 在当前作用域计时：PERF_ZONE(RENDER_EDITOR);
+#define PERF_ZONE(zone)                                                                            \
+    pnana::utils::PerfZoneScope PNANA_PERF_CONCAT(pnana_perf_zone_, __LINE__)(                     \
+        pnana::utils::PerfZoneId::zone)
+
+#define PERF_COUNTER_ADD(counter, value)                                                           \
+    do {                                                                                           \
+        auto& pnana_perf_monitor_ = pnana::utils::PerfMonitor::getInstance();                      \
+        if (pnana_perf_monitor_.isActive())                                                        \
+            pnana_perf_monitor_.addCounter(pnana::utils::PerfCounter::counter,                     \
+                                           static_cast<int64_t>(value));                           \
+    } while (0)
+
+} // namespace utils
+} // namespace pnana
+
+#endif // PNANA_UTILS_PERF_MONITOR_H
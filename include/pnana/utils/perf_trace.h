@@ -0,0 +1,183 @@
+#ifndef PNANA_UTILS_PERF_TRACE_H
+#define PNANA_UTILS_PERF_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pnana {
+namespace utils {
+
+// 性能事件表：X(枚举名, 事件名, 参数名列表)
+// 事件名与参数名写入 trace 文件头，解码工具据此还原可读输出；新增事件只需在末尾追加一行
+#define PNANA_PERF_EVENTS(X)                                                                       \
+    X(TRACE_DROPPED, "trace.dropped", "count")                                                     \
+    X(DOC_INSERT_CHAR, "document.insert_char", "row,col,total_us,backend_us")                      \
+    X(DOC_INSERT_TEXT, "document.insert_text", "row,col,len,total_us")                             \
+    X(DOC_OPEN, "document.open", "bytes,lines,lazy,time_ms")                                       \
+    X(DOC_SAVE, "document.save", "lines,time_ms")                                                  \
+    X(RENDER_FRAME, "editor.render_frame", "time_us,lines_highlighted,pty_bytes,lsp_queue")        \
+    X(TERMINAL_FEED, "terminal.feed", "chunks,bytes,overflowed")                                   \
+    X(HIGHLIGHT_LINE, "syntax.highlight_line", "bytes,time_ns")                                    \
+    X(ZONE, "zone", "zone,dur_ns")
+
+// 计时区间表：X(枚举名, 区间名, 是否同时写文本日志)
+// PERF_ZONE(id) 的 id 在编译期确定，结束时写一条 ZONE 事件（时间戳为区间结束时刻）
+#define PNANA_PERF_ZONES(X)                                                                        \
+    X(RENDER_UI, "render.frame", false)                                                            \
+    X(RENDER_TABBAR, "render.tabbar", false)                                                       \
+    X(RENDER_EDITOR, "render.editor", false)                                                       \
+    X(RENDER_FILE_BROWSER, "render.file_browser", false)                                           \
+    X(RENDER_PREVIEW, "render.markdown_preview", false)                                            \
+    X(RENDER_TERMINAL, "render.terminal", false)                                                   \
+    X(RENDER_STATUSBAR, "render.statusbar", false)                                                 \
+    X(RENDER_DIALOGS, "render.dialogs", false)                                                     \
+    X(DOC_LOAD, "document.load", false)                                                            \
+    X(DOC_SAVE, "document.save", false)                                                            \
+    X(DOC_MATERIALIZE, "document.materialize", true)                                               \
+    X(FZF_COLLECT, "fzf.collect_files", true)                                                      \
+    X(FZF_SORT, "fzf.sort", true)                                                                  \
+    X(SFTP_INIT, "sftp.init", true)                                                                \
+    X(SFTP_OPEN, "sftp.open", true)                                                                \
+    X(SFTP_STAT, "sftp.stat", true)                                                                \
+    X(SFTP_LOCAL_OPEN, "sftp.local_open", true)
+
+enum class PerfEventId : uint32_t {
+#define PNANA_PERF_EVENT_ENUM(id, name, args) id,
+    PNANA_PERF_EVENTS(PNANA_PERF_EVENT_ENUM)
+#undef PNANA_PERF_EVENT_ENUM
+        COUNT
+};
+
+enum class PerfZoneId : uint32_t {
+#define PNANA_PERF_ZONE_ENUM(id, name, log) id,
+    PNANA_PERF_ZONES(PNANA_PERF_ZONE_ENUM)
+#undef PNANA_PERF_ZONE_ENUM
+        COUNT
+};
+
+const char* perfEventName(PerfEventId id);
+const char* perfZoneName(PerfZoneId id);
+
+// 固定大小的二进制记录（48 字节），直接按内存布局写入文件
+struct PerfRecord {
+    uint64_t timestamp_ns; // steady_clock，相对 trace 启动时刻
+    uint32_t event_id;
+    uint32_t thread_id; // 进程内顺序编号，非系统 tid
+    int64_t args[4];
+};
+static_assert(sizeof(PerfRecord) == 48, "PerfRecord layout is part of the trace file format");
+
+// trace 文件格式（小端）：
+//   "PNTRACE1" | u32 version | u32 record_size | u64 start_unix_ns | u32 event_count
+//   event_count x { u32 id | u16 name_len | name | u16 args_len | args }
+//   u32 zone_count | zone_count x { u32 id | u16 name_len | name }
+//   之后是连续的 PerfRecord
+constexpr char PERF_TRACE_MAGIC[8] = {'P', 'N', 'T', 'R', 'A', 'C', 'E', '1'};
+constexpr uint32_t PERF_TRACE_VERSION = 2;
+
+/**
+ * 二进制性能事件追踪
+ * 每个线程写自己的单生产者环形缓冲（无锁、无分配），后台线程定期批量落盘。
+ * 缓冲满时丢弃新事件并计数，由后台线程以 trace.dropped 事件写出。
+ * 除写文件外也可在内存中保留最近的事件（capture），用于导出 Chrome trace_event JSON。
+ * 未启动时 PERF_EVENT 只有一次 relaxed 原子读。
+ */
+class PerfTrace {
+  public:
+    static PerfTrace& getInstance() {
+        static PerfTrace instance;
+        return instance;
+    }
+
+    // 打开 trace 文件并启动落盘线程；重复调用无效
+    bool start(const std::string& path);
+    // 在内存中保留最近 CAPTURE_LIMIT 条事件（可与文件同时启用）
+    void startCapture();
+    bool isCapturing() const {
+        return capturing_.load(std::memory_order_relaxed);
+    }
+    // 落盘剩余事件、关闭文件并停止采集
+    void stop();
+
+    // 把内存中已采集的事件写成 Chrome trace_event JSON（chrome://tracing / Perfetto 可打开）
+    bool exportChromeTrace(const std::string& path, std::string& error);
+    static bool writeChromeTrace(const std::string& path, const std::vector<PerfRecord>& records,
+                                 std::string& error);
+
+    static constexpr size_t CAPTURE_LIMIT = 1 << 18;
+
+    bool isEnabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void emit(PerfEventId id, int64_t a0 = 0, int64_t a1 = 0, int64_t a2 = 0, int64_t a3 = 0);
+
+  private:
+    // 每线程 SPSC 环：写端只有所属线程，读端只有落盘线程
+    struct Ring {
+        static constexpr size_t CAPACITY = 4096; // 2 的幂
+        PerfRecord records[CAPACITY];
+        alignas(64) std::atomic<uint64_t> head{0}; // 写位置（生产者）
+        alignas(64) std::atomic<uint64_t> tail{0}; // 读位置（消费者）
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false}; // 所属线程已退出，读空后释放
+        uint32_t thread_id = 0;
+    };
+
+    PerfTrace() = default;
+    ~PerfTrace();
+    PerfTrace(const PerfTrace&) = delete;
+    PerfTrace& operator=(const PerfTrace&) = delete;
+
+    Ring* threadRing();
+    void startDrainThreadLocked();
+    void drainLoop();
+    void flush();
+    size_t drainAll(std::vector<PerfRecord>& scratch);
+    bool writeHeader();
+
+    std::atomic<bool> enabled_{false};
+    std::chrono::steady_clock::time_point start_time_;
+    uint64_t start_unix_ns_ = 0;
+
+    std::mutex rings_mutex_; // 仅在线程首次写事件与落盘时获取
+    std::vector<std::shared_ptr<Ring>> rings_;
+    uint32_t next_thread_id_ = 1;
+
+    std::mutex state_mutex_;
+    std::condition_variable drain_cv_;
+    bool stopping_ = false;
+    std::atomic<bool> drain_requested_{false};
+    std::thread drain_thread_;
+
+    // 输出端：flush() 持有 sink_mutex_ 时读环并写入
+    std::mutex sink_mutex_;
+    FILE* file_ = nullptr;
+    std::atomic<bool> capturing_{false};
+    std::deque<PerfRecord> capture_;
+    std::vector<PerfRecord> scratch_;
+};
+
+// 记录性能事件；参数仅在追踪启用时求值
+#define PERF_EVENT(...)                                                                            \
+    do {                                                                                           \
+        auto& pnana_perf_trace_ = pnana::utils::PerfTrace::getInstance();                          \
+        if (pnana_perf_trace_.isEnabled())                                                         \
+            pnana_perf_trace_.emit(__VA_ARGS__);                                                   \
+    } while (0)
+
+#define PERF_TRACE_ENABLED() pnana::utils::PerfTrace::getInstance().isEnabled()
+
+} // namespace utils
+} // namespace pnana
+
+#endif // PNANA_UTILS_PERF_TRACE_H
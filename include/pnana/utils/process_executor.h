@@ -0,0 +1,139 @@
+#ifndef PNANA_UTILS_PROCESS_EXECUTOR_H
+#define PNANA_UTILS_PROCESS_EXECUTOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace pnana {
+namespace utils {
+
+// 子进程请求
+struct ProcessRequest {
+    std::vector<std::string> argv; // argv[0] 通过 PATH 查找
+    std::string cwd;               // 为空时继承编辑器的工作目录
+    std::string stdout_path;       // 非空时 stdout 写入该文件（截断），不经过管道
+    int timeout_ms = 0;            // <= 0 表示不限；超时后终止整个进程组
+    size_t max_output_bytes = 16 * 1024 * 1024; // stdout / stderr 各自保留的上限，超出部分丢弃
+    bool post_to_ui = false; // 回调通过 setUIDispatcher 设置的分发函数在 UI 线程运行
+
+    // /bin/sh -c command（命令中需要管道、重定向、|| 等 shell 语法时使用）
+    static ProcessRequest shell(const std::string& command);
+};
+
+struct ProcessResult {
+    int exit_code = -1; // 被信号终止时为 128 + 信号编号
+    bool spawned = false;
+    bool timed_out = false;
+    bool cancelled = false;
+    bool truncated = false;   // 输出超过 max_output_bytes
+    std::string output;       // stdout
+    std::string error_output; // stderr
+    std::string error;        // 无法启动时的原因
+
+    bool ok() const {
+        return spawned && !timed_out && !cancelled && exit_code == 0;
+    }
+};
+
+/**
+ * 子进程执行服务：插件、包管理器、版本探测等需要运行外部命令的地方共用
+ *
+ * 所有子进程由一个 IO 线程管理：submit() 只把请求放入队列，IO 线程用 posix_spawn 启动
+ * （同时运行的数量不超过并发上限，其余排队），以非阻塞管道收集 stdout / stderr，在同一个
+ * poll 循环里处理超时与取消，进程结束后调用回调。子进程各自成为进程组组长，超时或取消时
+ * 整组 SIGKILL，sh -c 启动的管道命令不会残留。
+ *
+ * 回调默认在 IO 线程上运行，应尽快返回（更新缓存、再投递）；post_to_ui 的请求交给
+ * UI 分发函数，在 UI 线程运行。run() 同步等待结果，只能在后台线程调用，且不能在回调里调用。
+ */
+class ProcessExecutor {
+  public:
+    using JobId = uint64_t;
+    using Callback = std::function<void(const ProcessResult&)>;
+    using UIDispatcher = std::function<void(std::function<void()>)>;
+
+    static ProcessExecutor& getInstance() {
+        static ProcessExecutor instance;
+        return instance;
+    }
+
+    ProcessExecutor(const ProcessExecutor&) = delete;
+    ProcessExecutor& operator=(const ProcessExecutor&) = delete;
+
+    // 返回任务 id（> 0），可用于 cancel()；回调在任何情况下（包括无法启动、取消）恰好调用一次
+    JobId submit(ProcessRequest request, Callback on_done);
+    ProcessResult run(ProcessRequest request);
+
+    // 取消排队中或运行中的任务（异步生效，回调收到 cancelled）；任务已结束返回 false
+    bool cancel(JobId id);
+
+    // 同时运行的子进程上限（默认 8）
+    void setMaxConcurrent(size_t max_concurrent);
+    // 由编辑器在启动时设置、退出前清除（传 nullptr）
+    void setUIDispatcher(UIDispatcher dispatcher);
+
+    size_t activeCount() const;
+
+    // 在 PATH 中查找可执行文件，不启动子进程（代替 `which` / `command -v`）
+    static bool findExecutable(const std::string& name);
+    // 同上，返回找到的路径（未找到返回空串）
+    static std::string resolveExecutable(const std::string& name);
+
+  private:
+    struct Job {
+        JobId id = 0;
+        ProcessRequest request;
+        Callback on_done;
+        ProcessResult result;
+        pid_t pid = -1;
+        int out_fd = -1;
+        int err_fd = -1;
+        bool has_deadline = false;
+        std::chrono::steady_clock::time_point deadline;
+        bool killed = false; // 已发送 SIGKILL（超时或取消）
+        bool exited = false; // 已 waitpid 回收
+    };
+
+    ProcessExecutor();
+    ~ProcessExecutor();
+
+    mutable std::mutex mutex_;
+    std::deque<std::unique_ptr<Job>> queued_;
+    std::unordered_set<JobId> active_ids_;    // 排队中与运行中
+    std::unordered_set<JobId> cancel_requests_;
+    JobId next_id_ = 1;
+    size_t max_concurrent_ = 8;
+    bool stop_ = false;
+
+    std::mutex dispatcher_mutex_;
+    UIDispatcher dispatcher_;
+
+    // 以下只在 IO 线程访问
+    std::vector<std::unique_ptr<Job>> running_;
+    int wake_fds_[2] = {-1, -1}; // 自管道：submit / cancel / 析构时唤醒 poll
+    std::thread io_thread_;
+
+    void wake();
+    void ioLoop();
+    void startJob(std::unique_ptr<Job> job);
+    void readOutput(Job& job, int& fd, std::string& sink);
+    void killJob(Job& job);
+    bool reap(Job& job, bool block);
+    void finish(std::unique_ptr<Job> job);
+};
+
+} // namespace utils
+} // namespace pnana
+
+#endif // PNANA_UTILS_PROCESS_EXECUTOR_H
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace pnana {
 namespace utils {
@@ -32,5 +34,29 @@ size_t getUtf8CharBytesBefore(const std::string& str, size_t pos);
 // @return: 下一个UTF-8字符的字节数，如果位置无效或没有下一个字符则返回1
 size_t getUtf8CharBytesAfter(const std::string& str, size_t pos);
 
+// 解码一个UTF-8字符
+// @param str: 输入字符串
+// @param pos: 起始位置（字节位置）
+// @param bytes: 输出该字符占用的字节数（无效序列按单字节处理）
+// @return: Unicode码点，无效序列返回该字节的值
+uint32_t decodeUtf8At(const std::string& str, size_t pos, size_t& bytes);
+
+// 码点在终端中占用的列数
+// CJK、全角符号与常见 emoji 占 2 列，组合字符与零宽字符占 0 列，其余占 1 列
+// @param cp: Unicode码点
+// @return: 显示列数（0、1 或 2）
+int getCodepointDisplayWidth(uint32_t cp);
+
+// 按显示宽度折行
+// 在空格处与宽字符前后断开，没有断点的过长单词强制断开；'\n' 结束一行，制表符展开为 4 个空格。
+// 每行只依赖它的起始位置，因此追加内容后只需从最后一行的起始位置重新折行
+// @param text: 输入字符串
+// @param from: 开始折行的字节位置（必须是某一行的起始位置）
+// @param width: 每行最多占用的列数
+// @param lines: 追加折好的行
+// @param line_starts: 追加每行在 text 中的起始字节位置
+void wrapByDisplayWidth(const std::string& text, size_t from, int width,
+                        std::vector<std::string>& lines, std::vector<size_t>& line_starts);
+
 } // namespace utils
 } // namespace pnana
@@ -0,0 +1,59 @@
+#ifndef PNANA_UTILS_TOOL_CACHE_H
+#define PNANA_UTILS_TOOL_CACHE_H
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace pnana {
+namespace utils {
+
+/**
+ * 跨会话的外部工具信息缓存（~/.config/pnana/.cache/tool_cache.json）
+ *
+ * 保存启动外部程序才能得到的结果：工具版本、LSP 服务器的解析路径与 capabilities。
+ * 每个条目附带可执行文件的指纹（路径 + mtime + 大小），调用方用 fingerprint()
+ * 重新计算后比较：二进制被升级或替换时指纹不同，条目即作废。
+ *
+ * 第一次访问时加载；put() 的值有变化时立即写回（先写临时文件再 rename）。
+ * 线程安全，可在渲染线程、LSP 初始化线程、子进程执行服务的回调里使用。
+ */
+class ToolCache {
+  public:
+    struct Entry {
+        std::string fingerprint;
+        std::string value;
+    };
+
+    static ToolCache& getInstance() {
+        static ToolCache instance;
+        return instance;
+    }
+
+    ToolCache(const ToolCache&) = delete;
+    ToolCache& operator=(const ToolCache&) = delete;
+
+    std::optional<Entry> get(const std::string& key);
+    void put(const std::string& key, const std::string& fingerprint, const std::string& value);
+    void erase(const std::string& key);
+
+    // 可执行文件的指纹；文件不存在时返回空串
+    static std::string fingerprint(const std::string& executable_path);
+
+  private:
+    ToolCache();
+
+    void loadLocked();
+    void saveLocked();
+
+    std::mutex mutex_;
+    std::string path_;
+    bool loaded_ = false;
+    std::map<std::string, Entry> entries_;
+};
+
+} // namespace utils
+} // namespace pnana
+
+#endif // PNANA_UTILS_TOOL_CACHE_H
@@ -2,6 +2,7 @@
 #define PNANA_UTILS_VERSION_DETECTOR_H
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -32,22 +33,30 @@ class VersionDetector {
         bool is_fetching; // 是否正在获取中
     };
 
-    // 实际执行版本获取的方法
-    std::string fetchVersionForFileType(const std::string& file_type);
+    // 缓存与探测回调共享：VersionDetector 析构后才完成的探测结果直接丢弃
+    struct Cache {
+        std::unordered_map<std::string, VersionCacheEntry> entries;
+        std::mutex mutex;
+    };
+
+    // 文件类型对应的版本查询命令（经 sh -c 执行），不支持的类型返回空串
+    static std::string versionCommandForFileType(const std::string& file_type);
+
+    // 命令结果是否可以跨会话缓存（见 ToolCache）
+    static bool isPersistable(const std::string& command);
+    // 命令所用程序的指纹，程序被安装、升级或替换后改变
+    static std::string probeFingerprint(const std::string& command);
 
     // 优化后的版本号解析方法
-    std::string parseVersionString(const std::string& raw_output, const std::string& file_type);
+    static std::string parseVersionString(const std::string& raw_output,
+                                          const std::string& file_type);
 
     // 提取版本号的核心逻辑（使用正则表达式或智能解析）
-    std::string extractVersionNumber(const std::string& text);
-
-    // 执行命令并获取输出
-    std::string executeCommand(const std::string& command);
+    static std::string extractVersionNumber(const std::string& text);
 
-    // 缓存相关
-    std::unordered_map<std::string, VersionCacheEntry> version_cache_;
-    std::mutex cache_mutex_;
+    std::shared_ptr<Cache> cache_;
     static constexpr auto CACHE_DURATION = std::chrono::minutes(5); // 缓存5分钟
+    static constexpr int PROBE_TIMEOUT_MS = 3000; // 版本命令（如 kubectl）卡住时不再等待
 };
 
 } // namespace utils
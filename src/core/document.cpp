@@ -1,6 +1,7 @@
 #include "core/document.h"
 #include "core/buffer_factory.h"
 #include "utils/logger.h"
+#include "utils/perf_monitor.h"
 #include <algorithm>
 #include <atomic>
 #include <cerrno>
@@ -29,6 +30,9 @@ Document::Document()
     : buffer_backend_(nullptr), backend_type_(BufferBackendType::PIECE_TABLE), filepath_(""),
       encoding_("UTF-8"), line_ending_(LineEnding::LF), modified_(false), read_only_(false),
       is_binary_(false) {
+    static std::atomic<uint64_t> next_instance_id{1};
+    instance_id_ = next_instance_id.fetch_add(1, std::memory_order_relaxed);
+
     // 默认使用 PieceTable 后端
     buffer_backend_ = std::make_unique<PieceTable>();
     lines_.push_back("");
@@ -44,6 +48,8 @@ const char* Document::getBufferBackendName() const {
 }
 
 void Document::setBufferBackend(BufferBackendType type) {
+    // 显式指定后端时放弃进行中的自适应迁移
+    backend_migration_.reset();
     if (backend_type_ == type) {
         return; // 已经是该类型
     }
@@ -53,18 +59,100 @@ void Document::setBufferBackend(BufferBackendType type) {
     // 创建新的缓冲区后端
     auto new_backend = SmartBufferFactory::create(type);
 
-    // 复制当前内容到新后端
+    // 复制当前内容到新后端（lines_ 是权威内容，不必再从后端回读）
     std::string content = getContent();
     new_backend->insert(0, content);
 
     // 替换后端
     buffer_backend_ = std::move(new_backend);
+}
 
-    // 更新缓存
-    lines_.clear();
-    for (size_t i = 0; i < buffer_backend_->lineCount(); ++i) {
-        lines_.push_back(buffer_backend_->getLine(i));
+void Document::maybeStartBackendMigration() {
+    if (!adaptive_backend_ || backend_migration_ || lazy_loaded_ || !buffer_backend_) {
+        return;
+    }
+    EditWorkloadProfile profile = edit_profiler_.profile();
+    BufferBackendType target = SmartBufferFactory::selectBackendForWorkload(backend_type_, profile);
+    if (target == backend_type_ || (abandoned_backends_ & (1u << static_cast<uint32_t>(target)))) {
+        return;
+    }
+
+    backend_migration_ = std::make_unique<BackendMigration>();
+    backend_migration_->target = target;
+    backend_migration_->backend = SmartBufferFactory::create(target);
+    std::string from = SmartBufferFactory::getBackendName(backend_type_);
+    LOG("[perf] BACKEND_MIGRATION_START from=" + from + " to=" +
+        SmartBufferFactory::getBackendName(target) + " avg_us=" +
+        std::to_string(profile.avg_backend_us) + " scattered=" +
+        std::to_string(profile.scattered_ratio) + " append=" +
+        std::to_string(profile.append_ratio) + " growth=" + std::to_string(profile.growth) +
+        " lines=" + std::to_string(lines_.size()));
+}
+
+bool Document::stepBufferBackendMigration() {
+    if (!backend_migration_) {
+        return false;
+    }
+    BackendMigration& migration = *backend_migration_;
+
+    // 每次最多复制 MIGRATION_CHUNK_BYTES，避免在一帧内卡住
+    std::string chunk;
+    size_t row = migration.copied_rows;
+    while (row < lines_.size() && chunk.size() < MIGRATION_CHUNK_BYTES) {
+        if (row > 0) {
+            chunk += '\n';
+        }
+        chunk += lines_[row];
+        ++row;
+    }
+    if (!chunk.empty()) {
+        migration.backend->insert(migration.backend->length(), chunk);
+    }
+    migration.copied_rows = row;
+    if (row < lines_.size()) {
+        return true;
+    }
+
+    // 复制完成：行数对不上（存在未经 logEdit 的修改）时以 lines_ 为准整体重灌一次
+    if (migration.backend->lineCount() != lines_.size()) {
+        LOG_WARNING("[perf] BACKEND_MIGRATION_RESYNC lines=" +
+                    std::to_string(lines_.size()));
+        migration.backend->clear();
+        migration.backend->insert(0, getContent());
+    }
+
+    abandoned_backends_ |= 1u << static_cast<uint32_t>(backend_type_);
+    LOG("[perf] BACKEND_MIGRATION_DONE from=" +
+        std::string(SmartBufferFactory::getBackendName(backend_type_)) + " to=" +
+        SmartBufferFactory::getBackendName(migration.target) + " lines=" +
+        std::to_string(lines_.size()));
+    buffer_backend_ = std::move(migration.backend);
+    backend_type_ = migration.target;
+    backend_migration_.reset();
+    edit_profiler_.reset(lines_.size());
+    return false;
+}
+
+void Document::mirrorEditToMigration(size_t start_row, size_t start_col, size_t end_row,
+                                     size_t end_col, const std::string& text) {
+    BackendMigration& migration = *backend_migration_;
+    if (start_row >= migration.copied_rows) {
+        // 尚未复制到的部分：稍后按 lines_ 的最新内容复制
+        return;
+    }
+    BufferBackend& backend = *migration.backend;
+    if (end_row < migration.copied_rows) {
+        size_t start = backend.lineColToPosition(start_row, start_col);
+        size_t end = backend.lineColToPosition(end_row, end_col);
+        backend.replace(start, end - start, text);
+        size_t added = static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+        migration.copied_rows = migration.copied_rows + added - (end_row - start_row);
+        return;
     }
+    // 跨越已复制边界：截断到 start_row 之前，从该行起重新复制
+    size_t keep = start_row == 0 ? 0 : backend.lineColToPosition(start_row, 0) - 1;
+    backend.remove(keep, backend.length() - keep);
+    migration.copied_rows = start_row;
 }
 
 void Document::autoSelectBufferBackend() {
@@ -84,6 +172,13 @@ void Document::autoSelectBufferBackend() {
 }
 
 bool Document::load(const std::string& filepath) {
+    PERF_ZONE(DOC_LOAD);
+    ++version_;
+    resetEditLog();
+    resetSwapFile();
+    backend_migration_.reset();
+    abandoned_backends_ = 0;
+    edit_profiler_.reset();
     // 检查路径是否是目录
     try {
         if (std::filesystem::exists(filepath) && std::filesystem::is_directory(filepath)) {
@@ -106,7 +201,6 @@ bool Document::load(const std::string& filepath) {
     }
 
     // 性能埋点：文件打开开始
-    std::string perf_label = "file_open_" + filepath;
     LOG("[perf] FILE_OPEN_START path=" + filepath + " size=" + std::to_string(file_size));
     auto t_open_start = std::chrono::steady_clock::now();
 
@@ -333,6 +427,8 @@ bool Document::load(const std::string& filepath) {
             std::chrono::duration_cast<std::chrono::milliseconds>(t_end - t_open_start).count();
         LOG("[perf] FILE_OPEN_DONE path=" + filepath + " lazy=true lines=" +
             std::to_string(num_lines) + " time_ms=" + std::to_string(elapsed_ms));
+        PERF_EVENT(utils::PerfEventId::DOC_OPEN, static_cast<int64_t>(file_size),
+                   static_cast<int64_t>(num_lines), 1, elapsed_ms);
         return true;
     }
 
@@ -408,6 +504,8 @@ bool Document::load(const std::string& filepath) {
         std::chrono::duration_cast<std::chrono::milliseconds>(t_end - t_open_start).count();
     LOG("[perf] FILE_OPEN_DONE path=" + filepath + " lazy=false lines=" +
         std::to_string(lines_.size()) + " time_ms=" + std::to_string(elapsed_ms));
+    PERF_EVENT(utils::PerfEventId::DOC_OPEN, static_cast<int64_t>(file_size),
+               static_cast<int64_t>(lines_.size()), 0, elapsed_ms);
     return true;
 }
 
@@ -419,17 +517,13 @@ bool Document::save() {
 }
 
 bool Document::saveAs(const std::string& filepath) {
+    PERF_ZONE(DOC_SAVE);
     auto t_save_start = std::chrono::steady_clock::now();
     LOG("[perf] FILE_SAVE_START path=" + filepath + " lines=" + std::to_string(lines_.size()) +
         " lazy=" + std::string(lazy_loaded_ ? "true" : "false"));
 
     if (lazy_loaded_) {
-        auto t_mat_start = std::chrono::steady_clock::now();
         materialize();
-        auto t_mat_end = std::chrono::steady_clock::now();
-        auto mat_ms =
-            std::chrono::duration_cast<std::chrono::milliseconds>(t_mat_end - t_mat_start).count();
-        LOG("[perf] MATERIALIZE_DONE time_ms=" + std::to_string(mat_ms));
     }
     // nano风格的安全保存：
     // 1. 获取原文件权限
@@ -529,13 +623,16 @@ bool Document::saveAs(const std::string& filepath) {
             original_file_mtime_ = std::filesystem::file_time_type::min();
         }
     }
-    clearHistory(); // 清除撤销历史，因为已经保存了
+    // 撤销历史跨保存保留，只记录保存点
+    save_point_ = undoDepth();
+    resetSwapFile();
     last_error_.clear();
 
     auto t_save_end = std::chrono::steady_clock::now();
     auto save_ms =
         std::chrono::duration_cast<std::chrono::milliseconds>(t_save_end - t_save_start).count();
     LOG("[perf] FILE_SAVE_DONE path=" + filepath + " time_ms=" + std::to_string(save_ms));
+    PERF_EVENT(utils::PerfEventId::DOC_SAVE, static_cast<int64_t>(lines_.size()), save_ms);
 
     return true;
 }
@@ -597,13 +694,6 @@ const std::vector<std::string>& Document::getLines() const {
     return lines_;
 }
 
-std::vector<std::string>& Document::getLines() {
-    if (lazy_loaded_) {
-        materialize();
-    }
-    return lines_;
-}
-
 std::string Document::getContent() const {
     if (lazy_loaded_) {
         const_cast<Document*>(this)->materialize();
@@ -650,6 +740,7 @@ void Document::materialize() {
         }
         return;
     }
+    PERF_ZONE(DOC_MATERIALIZE);
 
     std::ifstream file(filepath_, std::ios::binary);
     if (!file.is_open()) {
@@ -726,15 +817,7 @@ std::string Document::loadLineFromFile(size_t row) const {
         if (start >= end) {
             return "";
         }
-        std::ifstream file(filepath_, std::ios::binary);
-        if (!file.is_open()) {
-            return "";
-        }
-        file.seekg(static_cast<std::streamoff>(start));
-        const size_t len = static_cast<size_t>(end - start);
-        std::string line(len, '\0');
-        file.read(&line[0], static_cast<std::streamsize>(len));
-        line.resize(static_cast<size_t>(file.gcount()));
+        std::string line = readFileRange(start, static_cast<size_t>(end - start));
         if (!line.empty() && line.back() == '\n') {
             line.pop_back();
         }
@@ -746,11 +829,61 @@ std::string Document::loadLineFromFile(size_t row) const {
     return "";
 }
 
+std::string Document::readFileRange(uint64_t offset, size_t length) const {
+    std::ifstream file(filepath_, std::ios::binary);
+    if (!file.is_open() || length == 0) {
+        return "";
+    }
+    file.seekg(static_cast<std::streamoff>(offset));
+    std::string data(length, '\0');
+    file.read(&data[0], static_cast<std::streamsize>(length));
+    data.resize(static_cast<size_t>(file.gcount()));
+    return data;
+}
+
+size_t Document::getLineLength(size_t row) const {
+    if (!lazy_loaded_) {
+        return row < lines_.size() ? lines_[row].length() : 0;
+    }
+    auto it = line_cache_.find(row);
+    if (it != line_cache_.end()) {
+        return it->second.length();
+    }
+    if (row + 1 >= line_offsets_.size() || line_offsets_[row] >= line_offsets_[row + 1]) {
+        return 0;
+    }
+    // 行偏移表包含行尾换行符：只读末尾两个字节判断 \n / \r\n
+    size_t length = static_cast<size_t>(line_offsets_[row + 1] - line_offsets_[row]);
+    const size_t tail_length = std::min<size_t>(length, 2);
+    std::string tail = readFileRange(line_offsets_[row] + length - tail_length, tail_length);
+    if (!tail.empty() && tail.back() == '\n') {
+        tail.pop_back();
+        --length;
+    }
+    if (!tail.empty() && tail.back() == '\r') {
+        --length;
+    }
+    return length;
+}
+
+std::string Document::getLineSlice(size_t row, size_t start, size_t length) const {
+    if (!lazy_loaded_ || line_cache_.count(row) > 0) {
+        const std::string& line = getLine(row);
+        return start < line.length() ? line.substr(start, length) : std::string();
+    }
+    const size_t line_length = getLineLength(row);
+    if (start >= line_length) {
+        return "";
+    }
+    return readFileRange(line_offsets_[row] + start, std::min(length, line_length - start));
+}
+
 void Document::insertChar(size_t row, size_t col, char ch) {
     auto t0 = std::chrono::steady_clock::now();
     if (lazy_loaded_) {
         materialize();
     }
+    ++version_;
     if (row >= lines_.size()) {
         return;
     }
@@ -765,22 +898,15 @@ void Document::insertChar(size_t row, size_t col, char ch) {
     auto t2 = std::chrono::steady_clock::now();
 
     lines_[row].insert(col, 1, ch);
-    auto t3 = std::chrono::steady_clock::now();
+    logEdit(row, col, row, col, std::string(1, ch));
 
     pushChange(DocumentChange(DocumentChange::Type::INSERT, row, col, "", std::string(1, ch)));
-    auto t4 = std::chrono::steady_clock::now();
+    auto t3 = std::chrono::steady_clock::now();
 
-    auto pos_us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
     auto backend_us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
-    auto lines_us = std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count();
-    auto undo_us = std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count();
-    auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(t4 - t0).count();
-    if (total_us > 1000) {
-        LOG("[perf] DOC_INSERT_CHAR row=" + std::to_string(row) + " col=" + std::to_string(col) +
-            " total_us=" + std::to_string(total_us) + " pos_us=" + std::to_string(pos_us) +
-            " backend_us=" + std::to_string(backend_us) + " lines_us=" + std::to_string(lines_us) +
-            " undo_us=" + std::to_string(undo_us));
-    }
+    auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(t3 - t0).count();
+    PERF_EVENT(utils::PerfEventId::DOC_INSERT_CHAR, static_cast<int64_t>(row),
+               static_cast<int64_t>(col), total_us, backend_us);
 }
 
 void Document::insertText(size_t row, size_t col, const std::string& text) {
@@ -788,6 +914,7 @@ void Document::insertText(size_t row, size_t col, const std::string& text) {
     if (lazy_loaded_) {
         materialize();
     }
+    ++version_;
     if (row >= lines_.size() || text.empty()) {
         return;
     }
@@ -797,46 +924,45 @@ void Document::insertText(size_t row, size_t col, const std::string& text) {
     }
 
     size_t abs_pos = lineColToAbsolutePos(row, col);
-    auto t1 = std::chrono::steady_clock::now();
     buffer_backend_->insert(abs_pos, text);
-    auto t2 = std::chrono::steady_clock::now();
-
     lines_[row].insert(col, text);
-    auto t3 = std::chrono::steady_clock::now();
+    logEdit(row, col, row, col, text);
 
     pushChange(DocumentChange(DocumentChange::Type::INSERT, row, col, "", text));
-    auto t4 = std::chrono::steady_clock::now();
+    auto t1 = std::chrono::steady_clock::now();
 
-    auto pos_us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
-    auto backend_us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
-    auto lines_us = std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count();
-    auto undo_us = std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count();
-    auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(t4 - t0).count();
-    if (total_us > 5000) {
-        LOG("[perf] DOC_INSERT_TEXT row=" + std::to_string(row) + " col=" + std::to_string(col) +
-            " text_len=" + std::to_string(text.length()) + " total_us=" + std::to_string(total_us) +
-            " pos_us=" + std::to_string(pos_us) + " backend_us=" + std::to_string(backend_us) +
-            " lines_us=" + std::to_string(lines_us) + " undo_us=" + std::to_string(undo_us));
-    }
+    auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    PERF_EVENT(utils::PerfEventId::DOC_INSERT_TEXT, static_cast<int64_t>(row),
+               static_cast<int64_t>(col), static_cast<int64_t>(text.length()), total_us);
 }
 
 void Document::insertLine(size_t row) {
     if (lazy_loaded_) {
         materialize();
     }
+    ++version_;
     if (row > lines_.size()) {
         row = lines_.size();
     }
 
     buffer_backend_->insertLine(row, "");
 
+    if (row < lines_.size()) {
+        logEdit(row, 0, row, 0, "\n");
+    } else if (row > 0) {
+        logEdit(row - 1, lines_[row - 1].length(), row - 1, lines_[row - 1].length(), "\n");
+    } else {
+        resetEditLog();
+    }
     lines_.insert(lines_.begin() + row, "");
+    shiftFolds(row, 1);
 }
 
 void Document::deleteLine(size_t row) {
     if (lazy_loaded_) {
         materialize();
     }
+    ++version_;
     if (row >= lines_.size()) {
         return;
     }
@@ -847,6 +973,7 @@ void Document::deleteLine(size_t row) {
     buffer_backend_->removeLine(row);
 
     if (old_size == 1) {
+        logEdit(0, 0, 0, deleted.length(), "");
         lines_[0] = "";
         pushChange(DocumentChange(DocumentChange::Type::REPLACE, row, 0, deleted, ""));
         return;
@@ -855,19 +982,23 @@ void Document::deleteLine(size_t row) {
     if (row == old_size - 1) {
         size_t prev_row = row - 1;
         size_t prev_col = lines_[prev_row].length();
+        logEdit(prev_row, prev_col, row, deleted.length(), "");
         lines_.erase(lines_.begin() + row);
         pushChange(
             DocumentChange(DocumentChange::Type::DELETE, prev_row, prev_col, "\n" + deleted, ""));
     } else {
+        logEdit(row, 0, row + 1, 0, "");
         lines_.erase(lines_.begin() + row);
         pushChange(DocumentChange(DocumentChange::Type::DELETE, row, 0, deleted + "\n", ""));
     }
+    shiftFolds(row, -1);
 }
 
 void Document::deleteChar(size_t row, size_t col) {
     if (lazy_loaded_) {
         materialize();
     }
+    ++version_;
     if (row >= lines_.size()) {
         return;
     }
@@ -877,6 +1008,7 @@ void Document::deleteChar(size_t row, size_t col) {
         size_t abs_pos = lineColToAbsolutePos(row, col);
         buffer_backend_->removeChar(abs_pos);
         lines_[row].erase(col, 1);
+        logEdit(row, col, row, col + 1, "");
 
         pushChange(
             DocumentChange(DocumentChange::Type::DELETE, row, col, std::string(1, deleted), ""));
@@ -885,8 +1017,10 @@ void Document::deleteChar(size_t row, size_t col) {
         std::string old_line = lines_[row];
         size_t abs_pos = lineColToAbsolutePos(row, col);
         buffer_backend_->removeChar(abs_pos);
+        logEdit(row, old_line.length(), row + 1, 0, "");
         lines_[row] += next_line;
         lines_.erase(lines_.begin() + row + 1);
+        shiftFolds(row + 1, -1);
         pushChange(DocumentChange(DocumentChange::Type::REPLACE, row, old_line.length(),
                                   old_line + "\n" + next_line, old_line + next_line));
     }
@@ -896,6 +1030,7 @@ void Document::deleteRange(size_t start_row, size_t start_col, size_t end_row, s
     if (lazy_loaded_) {
         materialize();
     }
+    ++version_;
     if (start_row >= lines_.size() || end_row >= lines_.size() || start_row > end_row) {
         return;
     }
@@ -919,6 +1054,7 @@ void Document::deleteRange(size_t start_row, size_t start_col, size_t end_row, s
         size_t abs_pos = lineColToAbsolutePos(start_row, sc);
         buffer_backend_->remove(abs_pos, ec - sc);
         lines_[start_row].erase(sc, ec - sc);
+        logEdit(start_row, sc, start_row, ec, "");
         pushChange(DocumentChange(DocumentChange::Type::DELETE, start_row, sc, old_content, ""));
         return;
     }
@@ -945,9 +1081,11 @@ void Document::deleteRange(size_t start_row, size_t start_col, size_t end_row, s
     buffer_backend_->remove(abs_start, old_content.length());
 
     std::string new_first = lines_[start_row].substr(0, sc) + lines_[end_row].substr(ec);
+    logEdit(start_row, sc, end_row, ec, "");
 
     lines_.erase(lines_.begin() + start_row, lines_.begin() + end_row + 1);
     lines_.insert(lines_.begin() + start_row, new_first);
+    shiftFolds(start_row + 1, -static_cast<int64_t>(end_row - start_row));
 
     DocumentChange change(DocumentChange::Type::DELETE, start_row, sc, old_content, "");
     change.restored_lines.clear();
@@ -977,6 +1115,7 @@ void Document::replaceLine(size_t row, const std::string& content) {
     if (lazy_loaded_) {
         materialize();
     }
+    ++version_;
     if (row >= lines_.size()) {
         return;
     }
@@ -986,16 +1125,307 @@ void Document::replaceLine(size_t row, const std::string& content) {
     size_t abs_start = lineColToAbsolutePos(row, 0);
     buffer_backend_->replace(abs_start, old_content.length(), content);
 
+    logEdit(row, 0, row, old_content.length(), content);
     lines_[row] = content;
 
     pushChange(DocumentChange(DocumentChange::Type::REPLACE, row, 0, old_content, content));
 }
 
+void Document::setContent(std::vector<std::string> lines, bool undoable) {
+    if (lazy_loaded_) {
+        materialize();
+    }
+    if (lines.empty()) {
+        lines.push_back("");
+    }
+    size_t total = lines.size() - 1;
+    for (const auto& line : lines) {
+        total += line.size();
+    }
+    TextEdit edit;
+    edit.end_row = lines_.size() - 1;
+    edit.end_col = lines_[edit.end_row].length();
+    edit.text.reserve(total);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (i > 0) {
+            edit.text += '\n';
+        }
+        edit.text += lines[i];
+    }
+    lines.clear();
+
+    if (undoable) {
+        applyEdits({std::move(edit)});
+        return;
+    }
+    ++version_;
+    spliceLines(edit);
+    clearHistory();
+}
+
+bool Document::applyEdits(const std::vector<TextEdit>& edits, size_t* out_row, size_t* out_col) {
+    return applyEditsImpl(edits, false, out_row, out_col);
+}
+
+bool Document::appendEdits(const std::vector<TextEdit>& edits, size_t* out_row, size_t* out_col) {
+    return applyEditsImpl(edits, true, out_row, out_col);
+}
+
+bool Document::applyEditsImpl(const std::vector<TextEdit>& edits, bool extend_last_group,
+                              size_t* out_row, size_t* out_col) {
+    if (lazy_loaded_) {
+        materialize();
+    }
+    ++version_;
+    if (edits.empty()) {
+        return false;
+    }
+
+    // 校正坐标，再按起点从后往前应用：后面的编辑不会改变前面编辑的坐标。
+    // 同一起点的多个编辑按输入的逆序应用，使结果保持输入顺序
+    std::vector<TextEdit> ordered;
+    ordered.reserve(edits.size());
+    for (const auto& edit : edits) {
+        TextEdit clamped = edit;
+        clamped.start_row = std::min(clamped.start_row, lines_.size() - 1);
+        clamped.end_row = std::min(clamped.end_row, lines_.size() - 1);
+        if (clamped.end_row < clamped.start_row ||
+            (clamped.end_row == clamped.start_row && clamped.end_col < clamped.start_col)) {
+            std::swap(clamped.start_row, clamped.end_row);
+            std::swap(clamped.start_col, clamped.end_col);
+        }
+        clamped.start_col = std::min(clamped.start_col, lines_[clamped.start_row].length());
+        clamped.end_col = std::min(clamped.end_col, lines_[clamped.end_row].length());
+        ordered.push_back(std::move(clamped));
+    }
+    std::vector<size_t> order(ordered.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const TextEdit& ea = ordered[a];
+        const TextEdit& eb = ordered[b];
+        if (ea.start_row != eb.start_row) {
+            return ea.start_row > eb.start_row;
+        }
+        if (ea.start_col != eb.start_col) {
+            return ea.start_col > eb.start_col;
+        }
+        return a > b;
+    });
+
+    DocumentChange group(DocumentChange::Type::EDIT_GROUP, 0, 0, "", "");
+    group.content_size = 0;
+    bool have_bound = false;
+    size_t bound_row = 0;
+    size_t bound_col = 0;
+    for (size_t index : order) {
+        TextEdit& edit = ordered[index];
+        if (have_bound && (edit.end_row > bound_row ||
+                           (edit.end_row == bound_row && edit.end_col > bound_col))) {
+            LOG_WARNING("[APPLY_EDITS] overlapping edit ignored at row=" +
+                        std::to_string(edit.start_row));
+            continue;
+        }
+        if (edit.start_row == edit.end_row && edit.start_col == edit.end_col &&
+            edit.text.empty()) {
+            continue;
+        }
+        have_bound = true;
+        bound_row = edit.start_row;
+        bound_col = edit.start_col;
+
+        std::string removed = spliceLines(edit);
+        group.content_size += removed.size() + edit.text.size();
+        group.group_removed.push_back(std::move(removed));
+        group.group_edits.push_back(std::move(edit));
+    }
+    if (group.group_edits.empty()) {
+        return false;
+    }
+
+    const TextEdit& front = group.group_edits.back();
+    insertedTextEnd(front.start_row, front.start_col, front.text, bound_row, bound_col);
+    if (out_row)
+        *out_row = bound_row;
+    if (out_col)
+        *out_col = bound_col;
+
+    if (extend_last_group && !undo_stack_.empty() && undoDepth() != save_point_ &&
+        undo_stack_.back().type == DocumentChange::Type::EDIT_GROUP) {
+        DocumentChange& last = undo_stack_.back();
+        for (size_t i = 0; i < group.group_edits.size(); ++i) {
+            last.group_edits.push_back(std::move(group.group_edits[i]));
+            last.group_removed.push_back(std::move(group.group_removed[i]));
+        }
+        last.content_size += group.content_size;
+        modified_ = true;
+        return true;
+    }
+
+    // 撤销时光标回到最靠前的编辑（最后应用）所替换原文的末尾；group_edits.front() 是文档中
+    // 最靠后的编辑。最靠前编辑的坐标不受其余编辑影响，撤销后仍然有效；插入类编辑即编辑前的光标
+    group.row = front.end_row;
+    group.col = front.end_col;
+    pushChange(group);
+    modified_ = true;
+    return true;
+}
+
+std::string Document::spliceLines(const TextEdit& edit) {
+    const size_t sr = edit.start_row;
+    const size_t sc = edit.start_col;
+    const size_t er = edit.end_row;
+    const size_t ec = edit.end_col;
+
+    std::string removed;
+    if (sr == er) {
+        removed = lines_[sr].substr(sc, ec - sc);
+    } else {
+        size_t total_len = lines_[sr].length() - sc + 1 + ec;
+        for (size_t r = sr + 1; r < er; ++r) {
+            total_len += lines_[r].length() + 1;
+        }
+        removed.reserve(total_len);
+        removed.append(lines_[sr], sc, std::string::npos);
+        removed += '\n';
+        for (size_t r = sr + 1; r < er; ++r) {
+            removed += lines_[r];
+            removed += '\n';
+        }
+        removed.append(lines_[er], 0, ec);
+    }
+
+    size_t abs_start = lineColToAbsolutePos(sr, sc);
+    buffer_backend_->replace(abs_start, removed.length(), edit.text);
+    logEdit(sr, sc, er, ec, edit.text);
+
+    std::string tail = lines_[er].substr(ec);
+    lines_[sr].erase(sc);
+    const size_t old_extra = er - sr; // 被替换的后续行数
+
+    size_t newline = edit.text.find('\n');
+    if (newline == std::string::npos) {
+        lines_[sr] += edit.text;
+        lines_[sr] += tail;
+        if (old_extra > 0) {
+            lines_.erase(lines_.begin() + sr + 1, lines_.begin() + er + 1);
+            shiftFolds(sr + 1, -static_cast<int64_t>(old_extra));
+        }
+        return removed;
+    }
+
+    // 多行文本：先切好新行，再对 lines_ 做一次区间替换，整体 O(行数 + 新行数)
+    lines_[sr].append(edit.text, 0, newline);
+    std::vector<std::string> inserted;
+    inserted.reserve(static_cast<size_t>(
+        std::count(edit.text.begin() + static_cast<std::ptrdiff_t>(newline), edit.text.end(),
+                   '\n')));
+    size_t pos = newline + 1;
+    while (true) {
+        size_t next = edit.text.find('\n', pos);
+        if (next == std::string::npos) {
+            inserted.emplace_back(edit.text, pos, std::string::npos);
+            break;
+        }
+        inserted.emplace_back(edit.text, pos, next - pos);
+        pos = next + 1;
+    }
+    inserted.back() += tail;
+
+    size_t reused = std::min(old_extra, inserted.size());
+    for (size_t i = 0; i < reused; ++i) {
+        lines_[sr + 1 + i] = std::move(inserted[i]);
+    }
+    if (inserted.size() > reused) {
+        lines_.insert(lines_.begin() + sr + 1 + reused,
+                      std::make_move_iterator(inserted.begin() + reused),
+                      std::make_move_iterator(inserted.end()));
+    } else if (old_extra > reused) {
+        lines_.erase(lines_.begin() + sr + 1 + reused, lines_.begin() + er + 1);
+    }
+    shiftFolds(sr + 1,
+               static_cast<int64_t>(inserted.size()) - static_cast<int64_t>(old_extra));
+    return removed;
+}
+
+void Document::insertedTextEnd(size_t row, size_t col, const std::string& text, size_t& end_row,
+                               size_t& end_col) {
+    size_t last_newline = text.rfind('\n');
+    if (last_newline == std::string::npos) {
+        end_row = row;
+        end_col = col + text.length();
+        return;
+    }
+    end_row = row + static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+    end_col = text.length() - last_newline - 1;
+}
+
+bool Document::spliceIfValid(const TextEdit& edit) {
+    if (edit.start_row > edit.end_row || edit.end_row >= lines_.size() ||
+        edit.start_col > lines_[edit.start_row].length() ||
+        edit.end_col > lines_[edit.end_row].length() ||
+        (edit.start_row == edit.end_row && edit.start_col > edit.end_col)) {
+        return false;
+    }
+    spliceLines(edit);
+    return true;
+}
+
+void Document::swapLines(size_t a, size_t b) {
+    if (a == b) {
+        return;
+    }
+    const size_t a_len = lines_[a].length();
+    const size_t b_len = lines_[b].length();
+    buffer_backend_->swapLine(a, b);
+    std::swap(lines_[a], lines_[b]);
+    // 行数不变，两次整行替换的坐标互不影响
+    logEdit(a, 0, a, a_len, lines_[a]);
+    logEdit(b, 0, b, b_len, lines_[b]);
+}
+
+std::vector<std::string> Document::splitChangeLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream iss(text);
+    std::string line;
+    while (std::getline(iss, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+std::string Document::deletedText(const DocumentChange& change) {
+    if (change.old_content.find('\n') == std::string::npos) {
+        return change.old_content;
+    }
+    std::vector<std::string> restored = change.restored_lines;
+    if (restored.empty()) {
+        restored = splitChangeLines(change.old_content);
+        if (change.old_content.back() == '\n' || change.old_content.back() == '\r') {
+            restored.push_back("");
+        }
+    }
+    std::string text;
+    for (size_t i = 0; i < restored.size(); ++i) {
+        if (i > 0) {
+            text += '\n';
+        }
+        text += restored[i];
+    }
+    return text;
+}
+
 bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_type) {
+    refillChangeStack(undo_stack_, undo_journal_);
     if (undo_stack_.empty()) {
         LOG_DEBUG("[UNDO] undo_stack is empty, cannot undo");
         return false;
     }
+    ++version_;
 
     size_t lines_before = lines_.size();
     size_t undo_stack_size_before = undo_stack_.size();
@@ -1011,12 +1441,13 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
               " new_content_len=" + std::to_string(change.new_content.length()));
 
     // VSCode 风格的撤销逻辑：原子性操作，直接应用反向操作
-    // 每个撤销点都是完整的、不可分割的操作
+    // 每个撤销点都是完整的、不可分割的操作。反向操作统一经 spliceLines 应用，
+    // 逐条记入编辑日志并平移折叠，派生数据无需全量重建
     bool success = false;
     switch (change.type) {
         case DocumentChange::Type::INSERT: {
             if (change.row < lines_.size()) {
-                std::string& current_line = lines_[change.row];
+                const std::string& current_line = lines_[change.row];
                 size_t line_len = current_line.length();
 
                 LOG_DEBUG("[UNDO-INSERT] START: row=" + std::to_string(change.row) + " col=" +
@@ -1043,39 +1474,36 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
                 if (is_whole_line_insert) {
                     LOG_DEBUG("[UNDO-INSERT] whole_line_insert_removed row=" +
                               std::to_string(change.row));
-                    buffer_backend_->removeLine(change.row);
-                    lines_.erase(lines_.begin() + change.row);
-                    if (lines_.empty()) {
-                        lines_.push_back("");
+                    // 连同一个换行符删除整行；唯一的一行只清空内容
+                    TextEdit removal{change.row, 0, change.row, line_len, ""};
+                    if (change.row + 1 < lines_.size()) {
+                        removal.end_row = change.row + 1;
+                        removal.end_col = 0;
+                    } else if (change.row > 0) {
+                        removal.start_row = change.row - 1;
+                        removal.start_col = lines_[change.row - 1].length();
                     }
-                    success = true;
-                } else {
-                    if (change.col <= line_len) {
-                        size_t insert_len = change.new_content.length();
-                        size_t max_erase = line_len - change.col;
-                        size_t erase_len = std::min(insert_len, max_erase);
-
-                        LOG_DEBUG(
-                            "[UNDO-INSERT] inline_text_remove: col=" + std::to_string(change.col) +
-                            " insert_len=" + std::to_string(insert_len) +
-                            " erase_len=" + std::to_string(erase_len));
-
-                        if (erase_len > 0) {
-                            if (current_line.substr(change.col, erase_len) ==
-                                change.new_content.substr(0, erase_len)) {
-                                size_t abs_pos = lineColToAbsolutePos(change.row, change.col);
-                                buffer_backend_->remove(abs_pos, erase_len);
-                                current_line.erase(change.col, erase_len);
-                                success = true;
-                            }
-                        } else {
-                            success = true;
-                        }
+                    success = spliceIfValid(removal);
+                } else if (change.col <= line_len) {
+                    size_t insert_len = change.new_content.length();
+                    size_t max_erase = line_len - change.col;
+                    size_t erase_len = std::min(insert_len, max_erase);
+
+                    LOG_DEBUG("[UNDO-INSERT] inline_text_remove: col=" +
+                              std::to_string(change.col) +
+                              " insert_len=" + std::to_string(insert_len) +
+                              " erase_len=" + std::to_string(erase_len));
+
+                    if (erase_len == 0) {
+                        success = true;
+                    } else if (current_line.compare(change.col, erase_len, change.new_content, 0,
+                                                    erase_len) == 0) {
+                        success = spliceIfValid(TextEdit{change.row, change.col, change.row,
+                                                         change.col + erase_len, ""});
                     }
                 }
 
-                LOG_DEBUG("[UNDO-INSERT] END: success=" + std::to_string(success) +
-                          " line_after=[" + lines_[change.row] + "]");
+                LOG_DEBUG("[UNDO-INSERT] END: success=" + std::to_string(success));
             }
 
             if (out_row)
@@ -1086,62 +1514,9 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
         }
 
         case DocumentChange::Type::DELETE: {
-            if (change.row >= lines_.size()) {
-                break;
-            }
-
-            std::string& current_line = lines_[change.row];
-            size_t line_len = current_line.length();
-
-            if (change.col > line_len) {
-                break;
-            }
-
-            if (change.old_content.find('\n') != std::string::npos) {
-                std::vector<std::string> restored_lines;
-                if (!change.restored_lines.empty()) {
-                    restored_lines = change.restored_lines;
-                } else {
-                    std::istringstream iss(change.old_content);
-                    std::string line;
-                    while (std::getline(iss, line)) {
-                        if (!line.empty() && line.back() == '\r') {
-                            line.pop_back();
-                        }
-                        restored_lines.push_back(line);
-                    }
-                    if (!change.old_content.empty() &&
-                        (change.old_content.back() == '\n' || change.old_content.back() == '\r')) {
-                        restored_lines.push_back("");
-                    }
-                }
-
-                if (!restored_lines.empty()) {
-                    size_t abs_pos = lineColToAbsolutePos(change.row, change.col);
-                    buffer_backend_->insert(abs_pos, change.old_content);
-
-                    std::string remaining_part = current_line.substr(change.col);
-                    current_line = current_line.substr(0, change.col) + restored_lines[0];
-
-                    if (restored_lines.size() > 1) {
-                        for (size_t i = 1; i < restored_lines.size() - 1; ++i) {
-                            lines_.insert(lines_.begin() + change.row + i, restored_lines[i]);
-                        }
-
-                        std::string last_line = restored_lines.back() + remaining_part;
-                        lines_.insert(lines_.begin() + change.row + restored_lines.size() - 1,
-                                      last_line);
-                    } else {
-                        current_line += remaining_part;
-                    }
-
-                    success = true;
-                }
-            } else {
-                size_t abs_pos = lineColToAbsolutePos(change.row, change.col);
-                buffer_backend_->insert(abs_pos, change.old_content);
-                current_line.insert(change.col, change.old_content);
-                success = true;
+            if (change.row < lines_.size()) {
+                success = spliceIfValid(
+                    TextEdit{change.row, change.col, change.row, change.col, deletedText(change)});
             }
 
             if (out_row)
@@ -1153,14 +1528,9 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
         }
 
         case DocumentChange::Type::REPLACE: {
-            if (change.row < lines_.size()) {
-                if (lines_[change.row] == change.new_content) {
-                    size_t abs_start = lineColToAbsolutePos(change.row, 0);
-                    buffer_backend_->replace(abs_start, change.new_content.length(),
-                                             change.old_content);
-                    lines_[change.row] = change.old_content;
-                    success = true;
-                }
+            if (change.row < lines_.size() && lines_[change.row] == change.new_content) {
+                success = spliceIfValid(TextEdit{change.row, 0, change.row,
+                                                 change.new_content.length(), change.old_content});
             }
 
             if (out_row)
@@ -1176,24 +1546,11 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
                       " old_content_len=" + std::to_string(change.old_content.length()) +
                       " old_content=[" + change.old_content + "]");
 
-            if (change.row < lines_.size() && change.row + 1 < lines_.size()) {
-                std::string line_before = lines_[change.row];
-                std::string line_after = lines_[change.row + 1];
-
-                LOG_DEBUG("[UNDO-NEWLINE] Before merge: line[" + std::to_string(change.row) +
-                          "]=[" + line_before + "] line[" + std::to_string(change.row + 1) + "]=[" +
-                          line_after + "]");
-
-                size_t abs_start = lineColToAbsolutePos(change.row, 0);
-                buffer_backend_->replace(abs_start, line_before.length() + 1 + line_after.length(),
-                                         change.old_content);
-
-                lines_[change.row] = change.old_content;
-                lines_.erase(lines_.begin() + change.row + 1);
-                success = true;
-
-                LOG_DEBUG("[UNDO-NEWLINE] After merge: line[" + std::to_string(change.row) + "]=[" +
-                          lines_[change.row] + "] lines_size=" + std::to_string(lines_.size()));
+            // 把拆开的两行合并回原来的一行
+            if (change.row + 1 < lines_.size()) {
+                success = spliceIfValid(TextEdit{change.row, 0, change.row + 1,
+                                                 lines_[change.row + 1].length(),
+                                                 change.old_content});
             } else {
                 LOG_DEBUG("[UNDO-NEWLINE] FAILED: row=" + std::to_string(change.row) +
                           " lines_size=" + std::to_string(lines_.size()));
@@ -1208,31 +1565,19 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
 
         case DocumentChange::Type::COMPLETION: {
             if (change.row < lines_.size()) {
-                std::string& current_line = lines_[change.row];
+                const std::string& current_line = lines_[change.row];
+                const std::string& completion_text = change.new_content;
                 size_t replace_start = change.col;
 
                 if (replace_start <= current_line.length()) {
-                    const std::string& completion_text = change.new_content;
-
-                    if (replace_start + completion_text.length() <= current_line.length() &&
-                        current_line.substr(replace_start, completion_text.length()) ==
-                            completion_text) {
-                        size_t abs_pos = lineColToAbsolutePos(change.row, replace_start);
-                        buffer_backend_->replace(abs_pos, completion_text.length(),
-                                                 change.old_content);
-                        current_line.replace(replace_start, completion_text.length(),
-                                             change.old_content);
-                        success = true;
-                    } else {
-                        size_t found_pos = current_line.find(completion_text, replace_start);
-                        if (found_pos != std::string::npos) {
-                            size_t abs_pos = lineColToAbsolutePos(change.row, found_pos);
-                            buffer_backend_->replace(abs_pos, completion_text.length(),
-                                                     change.old_content);
-                            current_line.replace(found_pos, completion_text.length(),
-                                                 change.old_content);
-                            success = true;
-                        }
+                    if (current_line.compare(replace_start, completion_text.length(),
+                                             completion_text) != 0) {
+                        replace_start = current_line.find(completion_text, replace_start);
+                    }
+                    if (replace_start != std::string::npos) {
+                        success = spliceIfValid(
+                            TextEdit{change.row, replace_start, change.row,
+                                     replace_start + completion_text.length(), change.old_content});
                     }
                 }
             }
@@ -1247,8 +1592,7 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
         case DocumentChange::Type::MOVE_LINE: {
             size_t target = change.target_row;
             if (change.row < lines_.size() && target < lines_.size()) {
-                buffer_backend_->swapLine(change.row, target);
-                std::swap(lines_[change.row], lines_[target]);
+                swapLines(change.row, target);
                 success = true;
             }
             if (out_row)
@@ -1259,26 +1603,13 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
         }
 
         case DocumentChange::Type::COMMENT_TOGGLE: {
-            if (!change.restored_lines.empty()) {
-                for (size_t i = 0;
-                     i < change.restored_lines.size() && (change.row + i) < lines_.size(); ++i) {
-                    size_t abs_start = lineColToAbsolutePos(change.row + i, 0);
-                    buffer_backend_->replace(abs_start, lines_[change.row + i].length(),
-                                             change.restored_lines[i]);
-                    lines_[change.row + i] = change.restored_lines[i];
-                }
-            } else {
-                std::istringstream old_stream(change.old_content);
-                std::string old_line;
-                size_t r = change.row;
-                while (std::getline(old_stream, old_line) && r < lines_.size()) {
-                    if (!old_line.empty() && old_line.back() == '\r')
-                        old_line.pop_back();
-                    size_t abs_start = lineColToAbsolutePos(r, 0);
-                    buffer_backend_->replace(abs_start, lines_[r].length(), old_line);
-                    lines_[r] = old_line;
-                    r++;
-                }
+            std::vector<std::string> restored = change.restored_lines;
+            if (restored.empty()) {
+                restored = splitChangeLines(change.old_content);
+            }
+            for (size_t i = 0; i < restored.size() && (change.row + i) < lines_.size(); ++i) {
+                const size_t r = change.row + i;
+                spliceLines(TextEdit{r, 0, r, lines_[r].length(), restored[i]});
             }
             success = true;
             if (out_row)
@@ -1287,6 +1618,31 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
                 *out_col = 0;
             break;
         }
+        case DocumentChange::Type::EDIT_GROUP: {
+            // 逆序把每个编辑插入的文本换回原文
+            success = change.group_edits.size() == change.group_removed.size();
+            for (size_t i = change.group_edits.size(); success && i > 0; --i) {
+                const TextEdit& edit = change.group_edits[i - 1];
+                TextEdit inverse;
+                inverse.start_row = edit.start_row;
+                inverse.start_col = edit.start_col;
+                insertedTextEnd(edit.start_row, edit.start_col, edit.text, inverse.end_row,
+                                inverse.end_col);
+                if (inverse.end_row >= lines_.size() ||
+                    inverse.start_col > lines_[inverse.start_row].length() ||
+                    inverse.end_col > lines_[inverse.end_row].length()) {
+                    success = false;
+                    break;
+                }
+                inverse.text = change.group_removed[i - 1];
+                spliceLines(inverse);
+            }
+            if (out_row)
+                *out_row = change.row;
+            if (out_col)
+                *out_col = change.col;
+            break;
+        }
     }
 
     // 确保文档至少有一行（边界情况处理）
@@ -1294,16 +1650,10 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
         lines_.push_back("");
     }
 
+    // 折叠已在 spliceLines 中逐个平移
     size_t lines_after = lines_.size();
-    bool is_same;
-    if (!modified_) {
-        is_same = true;
-    } else if (undo_stack_.empty()) {
-        is_same = true;
-        modified_ = false;
-    } else {
-        is_same = false;
-    }
+    // 撤销历史跨保存保留：回到保存点的深度即与磁盘内容一致
+    bool is_same = undoDepth() == save_point_;
 
     LOG_DEBUG("[UNDO] END: success=" + std::to_string(success) +
               " lines_after=" + std::to_string(lines_after) + " lines_diff=" +
@@ -1313,23 +1663,24 @@ bool Document::undo(size_t* out_row, size_t* out_col, DocumentChange::Type* out_
 
     // 将操作移到重做栈（用于重做功能）
     redo_stack_.push_back(change);
+    spillChangeStack(redo_stack_, redo_journal_);
 
     if (out_type) {
         *out_type = change.type;
     }
 
-    // 修复：仅通过 isContentSameAsOriginal() 自然判定 modified_ 状态
-    // 移除强制还原 original_lines_ 的危险逻辑
     modified_ = !is_same;
 
     return success;
 }
 
 bool Document::redo(size_t* out_row, size_t* out_col) {
+    refillChangeStack(redo_stack_, redo_journal_);
     if (redo_stack_.empty()) {
         LOG_DEBUG("[REDO] redo_stack is empty, cannot redo");
         return false;
     }
+    ++version_;
 
     size_t lines_before = lines_.size();
     size_t redo_stack_size_before = redo_stack_.size();
@@ -1347,18 +1698,21 @@ bool Document::redo(size_t* out_row, size_t* out_col) {
     switch (change.type) {
         case DocumentChange::Type::INSERT:
             if (change.old_content.empty() && change.col == 0) {
-                if (change.row <= lines_.size()) {
-                    buffer_backend_->insertLine(change.row, change.new_content);
-                    lines_.insert(lines_.begin() + change.row, change.new_content);
-                    success = true;
+                // 整行插入：插在 row 之前；row 为行数时接在末行之后
+                if (change.row < lines_.size()) {
+                    success = spliceIfValid(
+                        TextEdit{change.row, 0, change.row, 0, change.new_content + "\n"});
+                } else if (change.row == lines_.size()) {
+                    const size_t last = change.row - 1;
+                    const size_t last_len = lines_[last].length();
+                    success = spliceIfValid(
+                        TextEdit{last, last_len, last, last_len, "\n" + change.new_content});
                 }
             } else {
                 if (change.row < lines_.size()) {
                     size_t col = std::min(change.col, lines_[change.row].length());
-                    size_t abs_pos = lineColToAbsolutePos(change.row, col);
-                    buffer_backend_->insert(abs_pos, change.new_content);
-                    lines_[change.row].insert(col, change.new_content);
-                    success = true;
+                    success = spliceIfValid(
+                        TextEdit{change.row, col, change.row, col, change.new_content});
                 }
             }
             if (out_row)
@@ -1370,13 +1724,14 @@ bool Document::redo(size_t* out_row, size_t* out_col) {
         case DocumentChange::Type::DELETE:
             if (change.row < lines_.size()) {
                 size_t col = std::min(change.col, lines_[change.row].length());
-                size_t len =
-                    std::min(change.old_content.length(), lines_[change.row].length() - col);
-                if (len > 0) {
-                    size_t abs_pos = lineColToAbsolutePos(change.row, col);
-                    buffer_backend_->remove(abs_pos, len);
-                    lines_[change.row].erase(col, len);
-                    success = true;
+                size_t end_row = change.row;
+                size_t end_col = col;
+                insertedTextEnd(change.row, col, deletedText(change), end_row, end_col);
+                if (end_row == change.row) {
+                    end_col = std::min(end_col, lines_[change.row].length());
+                }
+                if (end_row > change.row || end_col > col) {
+                    success = spliceIfValid(TextEdit{change.row, col, end_row, end_col, ""});
                 }
             }
             if (out_row)
@@ -1387,11 +1742,14 @@ bool Document::redo(size_t* out_row, size_t* out_col) {
 
         case DocumentChange::Type::REPLACE:
             if (change.row < lines_.size()) {
-                size_t abs_start = lineColToAbsolutePos(change.row, 0);
-                buffer_backend_->replace(abs_start, lines_[change.row].length(),
-                                         change.new_content);
-                lines_[change.row] = change.new_content;
-                success = true;
+                // 原文跨行时（行尾删除合并了下一行）整段换回
+                size_t end_row = change.row;
+                size_t end_col = lines_[change.row].length();
+                if (change.old_content.find('\n') != std::string::npos) {
+                    insertedTextEnd(change.row, 0, change.old_content, end_row, end_col);
+                }
+                success = spliceIfValid(
+                    TextEdit{change.row, 0, end_row, end_col, change.new_content});
             }
             if (out_row)
                 *out_row = change.row;
@@ -1402,14 +1760,9 @@ bool Document::redo(size_t* out_row, size_t* out_col) {
 
         case DocumentChange::Type::NEWLINE:
             if (change.row < lines_.size()) {
-                size_t abs_pos = lineColToAbsolutePos(change.row, change.col);
-                buffer_backend_->replace(abs_pos, change.old_content.length(),
-                                         change.new_content + "\n" + change.after_cursor);
-                lines_[change.row] = change.new_content;
-                if (change.row + 1 <= lines_.size()) {
-                    lines_.insert(lines_.begin() + change.row + 1, change.after_cursor);
-                }
-                success = true;
+                success = spliceIfValid(
+                    TextEdit{change.row, 0, change.row, lines_[change.row].length(),
+                             change.new_content + "\n" + change.after_cursor});
             }
             if (out_row)
                 *out_row = change.row + 1;
@@ -1419,28 +1772,17 @@ bool Document::redo(size_t* out_row, size_t* out_col) {
 
         case DocumentChange::Type::COMPLETION:
             if (change.row < lines_.size()) {
-                std::string& current_line = lines_[change.row];
+                const std::string& current_line = lines_[change.row];
                 size_t replace_start = std::min(change.col, current_line.length());
 
-                if (replace_start + change.old_content.length() <= current_line.length() &&
-                    current_line.substr(replace_start, change.old_content.length()) ==
-                        change.old_content) {
-                    size_t abs_pos = lineColToAbsolutePos(change.row, replace_start);
-                    buffer_backend_->replace(abs_pos, change.old_content.length(),
-                                             change.new_content);
-                    current_line.replace(replace_start, change.old_content.length(),
-                                         change.new_content);
-                    success = true;
-                } else {
-                    size_t found = current_line.find(change.old_content, replace_start);
-                    if (found != std::string::npos) {
-                        size_t abs_pos = lineColToAbsolutePos(change.row, found);
-                        buffer_backend_->replace(abs_pos, change.old_content.length(),
-                                                 change.new_content);
-                        current_line.replace(found, change.old_content.length(),
-                                             change.new_content);
-                        success = true;
-                    }
+                if (current_line.compare(replace_start, change.old_content.length(),
+                                         change.old_content) != 0) {
+                    replace_start = current_line.find(change.old_content, replace_start);
+                }
+                if (replace_start != std::string::npos) {
+                    success = spliceIfValid(
+                        TextEdit{change.row, replace_start, change.row,
+                                 replace_start + change.old_content.length(), change.new_content});
                 }
             }
             if (out_row)
@@ -1452,8 +1794,7 @@ bool Document::redo(size_t* out_row, size_t* out_col) {
         case DocumentChange::Type::MOVE_LINE: {
             size_t target = change.target_row;
             if (change.row < lines_.size() && target < lines_.size()) {
-                buffer_backend_->swapLine(change.row, target);
-                std::swap(lines_[change.row], lines_[target]);
+                swapLines(change.row, target);
                 success = true;
             }
             if (out_row)
@@ -1464,43 +1805,56 @@ bool Document::redo(size_t* out_row, size_t* out_col) {
         }
 
         case DocumentChange::Type::COMMENT_TOGGLE: {
-            if (!change.restored_lines.empty()) {
-                for (size_t i = 0;
-                     i < change.restored_lines.size() && (change.row + i) < lines_.size(); ++i) {
-                    size_t abs_start = lineColToAbsolutePos(change.row + i, 0);
-                    buffer_backend_->replace(abs_start, lines_[change.row + i].length(),
-                                             change.restored_lines[i]);
-                    lines_[change.row + i] = change.restored_lines[i];
-                }
-                success = true;
-            } else {
-                std::istringstream new_stream(change.new_content);
-                std::string new_line;
-                size_t r = change.row;
-                while (std::getline(new_stream, new_line) && r < lines_.size()) {
-                    if (!new_line.empty() && new_line.back() == '\r')
-                        new_line.pop_back();
-                    size_t abs_start = lineColToAbsolutePos(r, 0);
-                    buffer_backend_->replace(abs_start, lines_[r].length(), new_line);
-                    lines_[r] = new_line;
-                    r++;
-                }
-                success = true;
+            std::vector<std::string> toggled = splitChangeLines(change.new_content);
+            for (size_t i = 0; i < toggled.size() && (change.row + i) < lines_.size(); ++i) {
+                const size_t r = change.row + i;
+                spliceLines(TextEdit{r, 0, r, lines_[r].length(), toggled[i]});
             }
+            success = true;
             if (out_row)
                 *out_row = change.row;
             if (out_col)
                 *out_col = 0;
             break;
         }
+        case DocumentChange::Type::EDIT_GROUP: {
+            success = true;
+            for (const auto& edit : change.group_edits) {
+                if (edit.end_row >= lines_.size() ||
+                    edit.start_col > lines_[edit.start_row].length() ||
+                    edit.end_col > lines_[edit.end_row].length()) {
+                    success = false;
+                    break;
+                }
+                spliceLines(edit);
+            }
+            if (success && !change.group_edits.empty()) {
+                const TextEdit& last = change.group_edits.back();
+                size_t end_row = last.start_row;
+                size_t end_col = last.start_col;
+                insertedTextEnd(last.start_row, last.start_col, last.text, end_row, end_col);
+                if (out_row)
+                    *out_row = end_row;
+                if (out_col)
+                    *out_col = end_col;
+            }
+            break;
+        }
     }
 
     if (lines_.empty()) {
         lines_.push_back("");
     }
 
+    // 折叠已在 spliceLines 中逐个平移
     size_t lines_after = lines_.size();
-    bool is_same = !modified_;
+    if (success) {
+        undo_stack_.push_back(change);
+        trimUndoStack();
+    } else {
+        redo_stack_.push_back(change);
+    }
+    bool is_same = undoDepth() == save_point_;
 
     LOG_DEBUG("[REDO] END: success=" + std::to_string(success) +
               " lines_after=" + std::to_string(lines_after) + " lines_diff=" +
@@ -1508,12 +1862,6 @@ bool Document::redo(size_t* out_row, size_t* out_col) {
               " is_same_as_original=" + std::to_string(is_same) +
               " modified=" + std::to_string(!is_same));
 
-    if (success) {
-        undo_stack_.push_back(change);
-    } else {
-        redo_stack_.push_back(change);
-    }
-
     modified_ = !is_same;
 
     return success;
@@ -1527,42 +1875,29 @@ void Document::pushChange(const DocumentChange& change) {
 
     can_undo_ = true;
 
-    if (change.content_size > MAX_CHANGE_CONTENT_SIZE) {
-        DocumentChange safe_change = change;
-        if (safe_change.old_content.size() > MAX_CHANGE_CONTENT_SIZE) {
-            safe_change.old_content = safe_change.old_content.substr(0, MAX_CHANGE_CONTENT_SIZE);
-            safe_change.old_content += "\n...[truncated]";
-        }
-        if (safe_change.new_content.size() > MAX_CHANGE_CONTENT_SIZE) {
-            safe_change.new_content = safe_change.new_content.substr(0, MAX_CHANGE_CONTENT_SIZE);
-            safe_change.new_content += "\n...[truncated]";
-        }
-        safe_change.content_size = safe_change.old_content.size() + safe_change.new_content.size();
-        pushChangeInternal(safe_change);
-        return;
-    }
-
+    // 大记录不截断：内存超限时由 trimUndoStack 溢出到磁盘日志
     pushChangeInternal(change);
 }
 
 void Document::pushChangeInternal(const DocumentChange& change) {
     constexpr auto MERGE_THRESHOLD = std::chrono::milliseconds(300);
 
+    clearRedo();
+
     if (change.type == DocumentChange::Type::COMPLETION ||
         change.type == DocumentChange::Type::REPLACE ||
-        change.type == DocumentChange::Type::NEWLINE) {
+        change.type == DocumentChange::Type::NEWLINE ||
+        change.type == DocumentChange::Type::EDIT_GROUP) {
         undo_stack_.push_back(change);
         trimUndoStack();
-        if (!undo_stack_.empty()) {
-            redo_stack_.clear();
-        }
         if (!modified_) {
             modified_ = true;
         }
         return;
     }
 
-    if (!undo_stack_.empty()) {
+    // 栈顶正是保存时的状态时不能再并入新的输入，否则撤销无法回到保存点
+    if (!undo_stack_.empty() && undoDepth() != save_point_) {
         DocumentChange& last_change = undo_stack_.back();
         auto time_diff = change.timestamp - last_change.timestamp;
 
@@ -1588,14 +1923,17 @@ void Document::pushChangeInternal(const DocumentChange& change) {
 
             else if (change.type == DocumentChange::Type::DELETE &&
                      last_change.type == DocumentChange::Type::DELETE) {
+                // 合并后 restored_lines 不再对应 old_content，撤销时改为从 old_content 重新切分
                 if (change.col == last_change.col) {
                     last_change.old_content += change.old_content;
+                    last_change.restored_lines.clear();
                     last_change.timestamp = change.timestamp;
                     last_change.content_size =
                         last_change.old_content.size() + last_change.new_content.size();
                     return;
                 } else if (change.col + change.old_content.length() == last_change.col) {
                     last_change.old_content = change.old_content + last_change.old_content;
+                    last_change.restored_lines.clear();
                     last_change.col = change.col;
                     last_change.timestamp = change.timestamp;
                     last_change.content_size =
@@ -1608,9 +1946,6 @@ void Document::pushChangeInternal(const DocumentChange& change) {
 
     undo_stack_.push_back(change);
     trimUndoStack();
-    if (!undo_stack_.empty()) {
-        redo_stack_.clear();
-    }
     if (!modified_) {
         modified_ = true;
     }
@@ -1619,30 +1954,318 @@ void Document::pushChangeInternal(const DocumentChange& change) {
 void Document::clearHistory() {
     undo_stack_.clear();
     redo_stack_.clear();
+    undo_journal_.clear();
+    redo_journal_.clear();
     current_undo_memory_ = 0;
+    undo_dropped_ = 0;
+    save_point_ = modified_ ? NO_SAVE_POINT : 0;
 }
 
-void Document::trimUndoStack() {
-    while (undo_stack_.size() > MAX_UNDO_STACK) {
-        const auto& front = undo_stack_.front();
-        current_undo_memory_ -= (front.old_content.size() + front.new_content.size());
-        undo_stack_.pop_front();
+void Document::clearRedo() {
+    if (save_point_ != NO_SAVE_POINT && save_point_ > undoDepth()) {
+        save_point_ = NO_SAVE_POINT;
     }
+    redo_stack_.clear();
+    redo_journal_.clear();
+}
+
+void Document::trimUndoStack() {
+    current_undo_memory_ = spillChangeStack(undo_stack_, undo_journal_);
+}
 
+size_t Document::spillChangeStack(std::deque<DocumentChange>& stack, UndoJournal& journal) {
+    // content_size 覆盖 old/new_content 以及编辑组的内容
     size_t total_memory = 0;
-    for (const auto& change : undo_stack_) {
-        total_memory += change.old_content.size() + change.new_content.size();
+    for (const auto& change : stack) {
+        total_memory += change.content_size;
+    }
+
+    // 至少保留最新的一条在内存中
+    while (stack.size() > 1 &&
+           (stack.size() > MAX_UNDO_STACK || total_memory > MAX_UNDO_MEMORY_BYTES)) {
+        const auto& front = stack.front();
+        if (!journal.spill(front)) {
+            // 写盘失败：退回到丢弃最早记录的旧行为
+            LOG_WARNING("[UNDO] journal spill failed, dropping oldest change");
+            if (&stack == &undo_stack_) {
+                ++undo_dropped_;
+            }
+        }
+        total_memory -= front.content_size;
+        stack.pop_front();
+    }
+    return total_memory;
+}
+
+void Document::refillChangeStack(std::deque<DocumentChange>& stack, UndoJournal& journal) {
+    if (!stack.empty() || journal.empty()) {
+        return;
+    }
+    DocumentChange change(DocumentChange::Type::INSERT, 0, 0, "", "");
+    if (journal.restore(change)) {
+        stack.push_back(std::move(change));
+    } else {
+        LOG_WARNING("[UNDO] failed to restore change from journal");
+    }
+}
+
+void Document::logEdit(size_t start_row, size_t start_col, size_t end_row, size_t end_col,
+                       std::string text) {
+    const size_t inserted_lines =
+        static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 1;
+    wrap_index_.splice(start_row, end_row - start_row + 1, inserted_lines);
+    spliceSnapshotChunks(start_row, end_row - start_row + 1, inserted_lines);
+
+    // 编辑画像：调用方先经 lineColToAbsolutePos 定位再修改后端，随后记日志
+    int64_t backend_ns = -1;
+    if (backend_op_timing_) {
+        backend_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - backend_op_start_)
+                         .count();
+        backend_op_timing_ = false;
+    }
+    // 调用方可能已修改 lines_，按编辑后的行号判断是否落在末行
+    const bool at_end = start_row + inserted_lines >= lines_.size();
+    edit_profiler_.record(start_row, at_end, lines_.size(), backend_ns);
+    if (backend_migration_) {
+        mirrorEditToMigration(start_row, start_col, end_row, end_col, text);
+    } else if (edit_profiler_.totalEdits() % MIGRATION_CHECK_INTERVAL == 0) {
+        maybeStartBackendMigration();
+    }
+
+    edit_log_bytes_ += text.size();
+    edit_log_.push_back(
+        {version_, TextEdit{start_row, start_col, end_row, end_col, std::move(text)}});
+    recordSwapEdit(edit_log_.back().edit);
+    while (!edit_log_.empty() &&
+           (edit_log_.size() > MAX_EDIT_LOG_ENTRIES || edit_log_bytes_ > MAX_EDIT_LOG_BYTES)) {
+        edit_log_base_ = std::max(edit_log_base_, edit_log_.front().version);
+        edit_log_bytes_ -= edit_log_.front().edit.text.size();
+        edit_log_.pop_front();
+    }
+}
+
+void Document::resetEditLog() {
+    wrap_index_.invalidate();
+    snapshot_chunks_valid_ = false;
+    backend_op_timing_ = false;
+    if (backend_migration_) {
+        // 无法逐行跟踪的整体修改：已复制的部分作废，从头重新复制
+        backend_migration_->backend->clear();
+        backend_migration_->copied_rows = 0;
+    }
+    edit_log_.clear();
+    edit_log_bytes_ = 0;
+    edit_log_base_ = version_;
+    swap_checkpoint_pending_ = true;
+    swap_dirty_since_ = std::chrono::steady_clock::now();
+}
+
+void Document::recordSwapEdit(const TextEdit& edit) {
+    // 待写的检查点会包含这次编辑
+    if (swap_checkpoint_pending_ || !ensureSwapFile()) {
+        return;
+    }
+    swap_file_->appendEdit(edit);
+}
+
+bool Document::ensureSwapFile(std::shared_ptr<const DocumentSnapshot> initial) {
+    if (swap_file_) {
+        return true;
+    }
+    if (filepath_.empty() || swap_unavailable_ || lazy_loaded_) {
+        return false;
+    }
+    swap_file_ = std::make_unique<SwapFile>();
+    if (!swap_file_->open(filepath_, std::move(initial))) {
+        swap_file_.reset();
+        swap_unavailable_ = true;
+        return false;
+    }
+    return true;
+}
+
+void Document::resetSwapFile() {
+    swap_file_.reset();
+    swap_checkpoint_pending_ = false;
+    swap_unavailable_ = false;
+}
+
+void Document::tickSwapFile() {
+    if (!modified_) {
+        // 与磁盘内容一致（刚保存或撤销回保存点），无需恢复
+        if (swap_file_ || swap_checkpoint_pending_) {
+            resetSwapFile();
+        }
+        return;
+    }
+    bool due = swap_checkpoint_pending_ &&
+               std::chrono::steady_clock::now() - swap_dirty_since_ >= SWAP_CHECKPOINT_DELAY;
+    bool oversized = swap_file_ && swap_file_->journalBytes() > SWAP_CHECKPOINT_BYTES;
+    if (!due && !oversized) {
+        return;
+    }
+    if (swap_file_) {
+        swap_file_->checkpoint(snapshot());
+        swap_checkpoint_pending_ = false;
+    } else if (ensureSwapFile(snapshot())) {
+        swap_checkpoint_pending_ = false;
+    }
+}
+
+SwapFile::Probe Document::probeSwap() const {
+    if (filepath_.empty() || swap_file_) {
+        return SwapFile::Probe{};
+    }
+    return SwapFile::probe(filepath_);
+}
+
+bool Document::recoverFromSwap() {
+    if (lazy_loaded_) {
+        materialize();
+    }
+    std::vector<std::string> lines = lines_;
+    size_t applied = 0;
+    if (!SwapFile::replay(filepath_, lines, &applied)) {
+        last_error_ = "Swap file is missing or does not match " + filepath_;
+        return false;
+    }
+    lines_ = std::move(lines);
+    ++version_;
+    resetEditLog();
+    syncToBufferBackend();
+    modified_ = true;
+    clearHistory();
+    // 旧交换文件保留到下一帧写入新的检查点，期间再次崩溃仍可恢复
+    swap_dirty_since_ = std::chrono::steady_clock::time_point();
+    LOG("[SWAP] recovered " + filepath_ + " records=" + std::to_string(applied));
+    return true;
+}
+
+void Document::discardSwap() {
+    resetSwapFile();
+    if (!filepath_.empty()) {
+        SwapFile::remove(filepath_);
+    }
+}
+
+void Document::spliceSnapshotChunks(size_t row, size_t removed, size_t inserted) {
+    if (!snapshot_chunks_valid_) {
+        return;
+    }
+    // 找到覆盖 [row, row + removed) 的块，合并为一个待重建的块
+    size_t first = 0;
+    size_t first_start = 0;
+    while (first < snapshot_chunks_.size() &&
+           first_start + snapshot_chunks_[first].lines <= row) {
+        first_start += snapshot_chunks_[first].lines;
+        ++first;
+    }
+    if (first == snapshot_chunks_.size()) {
+        snapshot_chunks_valid_ = false;
+        return;
+    }
+    size_t last = first;
+    size_t end = first_start + snapshot_chunks_[first].lines;
+    while (end < row + removed && last + 1 < snapshot_chunks_.size()) {
+        ++last;
+        end += snapshot_chunks_[last].lines;
+    }
+    if (end < row + removed) {
+        snapshot_chunks_valid_ = false;
+        return;
+    }
+    snapshot_chunks_[first] = SnapshotChunk{end - first_start - removed + inserted, nullptr};
+    snapshot_chunks_.erase(snapshot_chunks_.begin() + static_cast<std::ptrdiff_t>(first + 1),
+                           snapshot_chunks_.begin() + static_cast<std::ptrdiff_t>(last + 1));
+}
+
+std::shared_ptr<const DocumentSnapshot> Document::snapshot() const {
+    if (lazy_loaded_) {
+        const_cast<Document*>(this)->materialize();
+    }
+    if (last_snapshot_ && last_snapshot_->version() == version_ &&
+        last_snapshot_->lineCount() == lines_.size()) {
+        return last_snapshot_;
     }
-    current_undo_memory_ = total_memory;
 
-    while (current_undo_memory_ > MAX_UNDO_MEMORY_BYTES && undo_stack_.size() > 10) {
-        const auto& front = undo_stack_.front();
-        current_undo_memory_ -= (front.old_content.size() + front.new_content.size());
-        undo_stack_.pop_front();
+    size_t tracked = 0;
+    for (const auto& chunk : snapshot_chunks_) {
+        tracked += chunk.lines;
+    }
+    if (!snapshot_chunks_valid_ || tracked != lines_.size()) {
+        snapshot_chunks_.assign(1, SnapshotChunk{lines_.size(), nullptr});
     }
+
+    // 待重建的块按 SNAPSHOT_CHUNK_LINES 切分后从 lines_ 复制，其余块直接共享
+    std::vector<SnapshotChunk> chunks;
+    std::vector<DocumentSnapshot::Chunk> data;
+    chunks.reserve(snapshot_chunks_.size());
+    size_t row = 0;
+    for (const auto& chunk : snapshot_chunks_) {
+        if (chunk.data) {
+            chunks.push_back(chunk);
+            data.push_back(chunk.data);
+            row += chunk.lines;
+            continue;
+        }
+        const size_t chunk_end = row + chunk.lines;
+        while (row < chunk_end) {
+            const size_t count = std::min(SNAPSHOT_CHUNK_LINES, chunk_end - row);
+            auto piece = std::make_shared<const std::vector<std::string>>(
+                lines_.begin() + static_cast<std::ptrdiff_t>(row),
+                lines_.begin() + static_cast<std::ptrdiff_t>(row + count));
+            chunks.push_back(SnapshotChunk{count, piece});
+            data.push_back(std::move(piece));
+            row += count;
+        }
+    }
+    snapshot_chunks_ = std::move(chunks);
+    snapshot_chunks_valid_ = true;
+    last_snapshot_ =
+        std::make_shared<const DocumentSnapshot>(instance_id_, version_, std::move(data));
+    return last_snapshot_;
+}
+
+std::shared_ptr<const DocumentSnapshot> Document::snapshotHead(size_t max_lines) const {
+    if (!lazy_loaded_) {
+        return snapshot();
+    }
+    const size_t count = std::min(max_lines, lineCount());
+    auto head = std::make_shared<std::vector<std::string>>();
+    head->reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        head->push_back(getLine(i));
+    }
+    return std::make_shared<const DocumentSnapshot>(
+        instance_id_, version_, std::vector<DocumentSnapshot::Chunk>{std::move(head)});
+}
+
+const WrapIndex* Document::getWrapIndex(size_t width, int tab_size) const {
+    if (lazy_loaded_) {
+        return nullptr;
+    }
+    wrap_index_.refresh(lines_, width, tab_size);
+    return &wrap_index_;
+}
+
+bool Document::getEditsSince(uint64_t since_version, std::vector<ContentEdit>& out) const {
+    out.clear();
+    if (since_version < edit_log_base_ || since_version > version_) {
+        return false;
+    }
+    auto it = std::upper_bound(
+        edit_log_.begin(), edit_log_.end(), since_version,
+        [](uint64_t version, const ContentEdit& entry) { return version < entry.version; });
+    out.assign(it, edit_log_.end());
+    return true;
 }
 
 size_t Document::lineColToAbsolutePos(size_t row, size_t col) const {
+    if (!backend_op_timing_) {
+        backend_op_start_ = std::chrono::steady_clock::now();
+        backend_op_timing_ = true;
+    }
     if (buffer_backend_) {
         return buffer_backend_->lineColToPosition(row, col);
     }
@@ -1778,50 +2401,107 @@ bool Document::isContentSameAsOriginal() const {
 
 // 折叠范围管理
 void Document::setFoldingRanges(const std::vector<pnana::features::FoldingRange>& ranges) {
+    // 折叠状态按起始行迁移到新的范围 id：调用方随后只需 setFolded 调整变化的部分
+    std::vector<int> folded_starts;
+    folded_starts.reserve(folded_count_);
+    for (size_t id = 0; id < folding_ranges_.size(); ++id) {
+        if (fold_state_[id]) {
+            folded_starts.push_back(folding_ranges_[id].startLine);
+        }
+    }
+
     folding_ranges_ = ranges;
-    // 注意：不要在这里清理folded_lines_，因为setFolded方法会单独调用来设置折叠状态
+    std::stable_sort(folding_ranges_.begin(), folding_ranges_.end(),
+                     [](const pnana::features::FoldingRange& a,
+                        const pnana::features::FoldingRange& b) {
+                         // 同一起始行时外层（末行更大）在前，保证父范围排在子范围之前
+                         if (a.startLine != b.startLine) {
+                             return a.startLine < b.startLine;
+                         }
+                         return a.endLine > b.endLine;
+                     });
+    rebuildFoldParents();
+    fold_state_.assign(folding_ranges_.size(), 0);
+    folded_count_ = 0;
+    for (size_t id = 0; id < folding_ranges_.size(); ++id) {
+        if (std::binary_search(folded_starts.begin(), folded_starts.end(),
+                               folding_ranges_[id].startLine)) {
+            fold_state_[id] = 1;
+            ++folded_count_;
+        }
+    }
+    fold_index_dirty_ = true;
 }
 
 void Document::clearFoldingRanges() {
     folding_ranges_.clear();
-    folded_lines_.clear();
-    visible_line_count_dirty_ = true;
+    fold_state_.clear();
+    fold_parent_.clear();
+    folded_count_ = 0;
+    fold_index_dirty_ = true;
+}
+
+std::pair<size_t, size_t> Document::foldIdsAt(int line) const {
+    auto first = std::lower_bound(
+        folding_ranges_.begin(), folding_ranges_.end(), line,
+        [](const pnana::features::FoldingRange& range, int l) { return range.startLine < l; });
+    auto last = first;
+    while (last != folding_ranges_.end() && last->startLine == line) {
+        ++last;
+    }
+    return {static_cast<size_t>(first - folding_ranges_.begin()),
+            static_cast<size_t>(last - folding_ranges_.begin())};
 }
 
 void Document::setFolded(int start_line, bool folded) {
-    (void)start_line;
-    (void)folded;
-    if (folded) {
-        // 检查是否有对应的折叠范围
-        for (const auto& range : folding_ranges_) {
-            if (range.startLine == start_line) {
-                folded_lines_.insert(start_line);
-                visible_line_count_dirty_ = true;
-                return;
-            }
+    // 同一起始行的所有范围一起折叠/展开；没有对应范围时忽略
+    auto ids = foldIdsAt(start_line);
+    const uint8_t state = folded ? 1 : 0;
+    for (size_t id = ids.first; id < ids.second; ++id) {
+        if (fold_state_[id] != state) {
+            fold_state_[id] = state;
+            folded_count_ = folded ? folded_count_ + 1 : folded_count_ - 1;
+            fold_index_dirty_ = true;
         }
-        // no-op for debug
-    } else {
-        folded_lines_.erase(start_line);
-        visible_line_count_dirty_ = true;
-        // no-op for debug
     }
 }
 
 bool Document::isFolded(int line) const {
-    return folded_lines_.count(line) > 0;
-}
-
-bool Document::isLineInFoldedRange(int line) const {
-    for (const auto& range : folding_ranges_) {
-        if (folded_lines_.count(range.startLine) && range.containsLine(line) &&
-            line != range.startLine) {
+    if (folded_count_ == 0) {
+        return false;
+    }
+    auto ids = foldIdsAt(line);
+    for (size_t id = ids.first; id < ids.second; ++id) {
+        if (fold_state_[id]) {
             return true;
         }
     }
     return false;
 }
 
+const FoldIndex& Document::foldIndex() const {
+    if (fold_index_dirty_) {
+        // LSP 同步时会连续 setFolded 多次，统一在首次查询时重建一次
+        std::vector<std::pair<int, int>> folded;
+        folded.reserve(folded_count_);
+        for (size_t id = 0; id < folding_ranges_.size(); ++id) {
+            if (fold_state_[id]) {
+                folded.emplace_back(folding_ranges_[id].startLine, folding_ranges_[id].endLine);
+            }
+        }
+        fold_index_.rebuild(std::move(folded));
+        fold_index_dirty_ = false;
+    }
+    return fold_index_;
+}
+
+bool Document::isLineInFoldedRange(int line) const {
+    if (line < 0 || folded_count_ == 0) {
+        return false;
+    }
+    return foldIndex().isHidden(static_cast<size_t>(line));
+}
+
 void Document::toggleFold(int start_line) {
     if (isFolded(start_line)) {
         setFolded(start_line, false);
@@ -1831,62 +2511,130 @@ void Document::toggleFold(int start_line) {
 }
 
 void Document::unfoldAll() {
-    folded_lines_.clear();
-    visible_line_count_dirty_ = true;
+    std::fill(fold_state_.begin(), fold_state_.end(), 0);
+    folded_count_ = 0;
+    fold_index_dirty_ = true;
 }
 
 void Document::foldAll() {
-    folded_lines_.clear();
-    for (const auto& range : folding_ranges_) {
-        folded_lines_.insert(range.startLine);
+    std::fill(fold_state_.begin(), fold_state_.end(), 1);
+    folded_count_ = fold_state_.size();
+    fold_index_dirty_ = true;
+}
+
+void Document::rebuildFoldParents() {
+    // 单调栈：栈中是尚未结束的范围；弹出在当前起始行之前结束的范围后，栈顶即直接外层范围。
+    // 栈顶末行小于当前末行说明两个范围交叉（不是嵌套），此时 shiftFolds 退回全量扫描
+    fold_parent_.assign(folding_ranges_.size(), NO_FOLD_PARENT);
+    fold_nested_ = true;
+    std::vector<size_t> open;
+    for (size_t id = 0; id < folding_ranges_.size(); ++id) {
+        const auto& range = folding_ranges_[id];
+        while (!open.empty() && folding_ranges_[open.back()].endLine < range.startLine) {
+            open.pop_back();
+        }
+        if (!open.empty()) {
+            fold_parent_[id] = open.back();
+            fold_nested_ = fold_nested_ && folding_ranges_[open.back()].endLine >= range.endLine;
+        }
+        open.push_back(id);
+    }
+}
+
+void Document::shiftFolds(size_t row, int64_t delta) {
+    if (delta == 0 || folding_ranges_.empty()) {
+        return;
+    }
+
+    // 范围原地平移，折叠状态跟随范围 id，不需要重建集合；平移保持起始行有序与嵌套关系。
+    // 只有首行被删或区间退化的范围才被移除（此时 id 整体压缩一次）
+    bool removed = false;
+    bool lost_fold = false;
+    auto shift = [&](size_t id) {
+        auto& range = folding_ranges_[id];
+        if (!FoldIndex::shiftRange(range.startLine, range.endLine, row, delta)) {
+            range.endLine = range.startLine - 1; // 标记为待移除
+            removed = true;
+            lost_fold = lost_fold || fold_state_[id] != 0;
+        }
+    };
+
+    // 起始行 >= row 的范围是有序数组的一段后缀，二分定位后逐个平移
+    const size_t first = foldIdsAt(static_cast<int>(row)).first;
+    for (size_t id = first; id < folding_ranges_.size(); ++id) {
+        shift(id);
+    }
+    // 起始行在 row 之前的范围只有包含 row 的需要调整末行：范围嵌套时它们都是
+    // first - 1 的祖先，沿父链走 O(深度)；存在交叉范围时退回逐个检查
+    if (fold_nested_) {
+        for (size_t id = first == 0 ? NO_FOLD_PARENT : first - 1; id != NO_FOLD_PARENT;
+             id = fold_parent_[id]) {
+            if (folding_ranges_[id].endLine >= static_cast<int>(row)) {
+                shift(id);
+            }
+        }
+    } else {
+        for (size_t id = 0; id < first; ++id) {
+            shift(id);
+        }
+    }
+
+    if (removed) {
+        size_t kept = 0;
+        for (size_t id = 0; id < folding_ranges_.size(); ++id) {
+            if (folding_ranges_[id].endLine < folding_ranges_[id].startLine) {
+                folded_count_ -= fold_state_[id];
+                continue;
+            }
+            folding_ranges_[kept] = folding_ranges_[id];
+            fold_state_[kept] = fold_state_[id];
+            ++kept;
+        }
+        folding_ranges_.resize(kept);
+        fold_state_.resize(kept);
+        rebuildFoldParents();
+    }
+
+    // 折叠集合不变时只平移索引（O(log n)）；有折叠失效时下次查询再重建
+    fold_index_dirty_ = fold_index_dirty_ || lost_fold;
+    if (!fold_index_dirty_) {
+        fold_index_.shiftLines(row, delta);
     }
-    visible_line_count_dirty_ = true;
 }
 
 std::vector<size_t> Document::getVisibleLines(size_t start_line, size_t end_line) const {
     std::vector<size_t> visible_lines;
+    if (lineCount() == 0) {
+        return visible_lines;
+    }
     size_t max_line = std::min(end_line, lineCount() - 1);
 
-    for (size_t line = start_line; line <= max_line; ++line) {
-        if (!isLineInFoldedRange(static_cast<int>(line))) {
-            visible_lines.push_back(line);
-        }
+    for (size_t line = nextVisibleLine(start_line); line <= max_line;
+         line = nextVisibleLine(line + 1)) {
+        visible_lines.push_back(line);
     }
 
     return visible_lines;
 }
 
 size_t Document::getVisibleLineCount() const {
-    if (!visible_line_count_dirty_) {
-        return visible_line_count_cache_;
-    }
-    size_t count = 0;
     size_t total = lineCount();
-    for (size_t line = 0; line < total; ++line) {
-        if (!isLineInFoldedRange(static_cast<int>(line))) {
-            ++count;
-        }
+    if (folded_count_ == 0) {
+        return total;
     }
-    visible_line_count_cache_ = count;
-    visible_line_count_dirty_ = false;
-    return count;
+    return foldIndex().visibleBefore(total);
 }
 
 size_t Document::getActualLineForDisplayLine(size_t display_line) const {
-    if (folded_lines_.empty()) {
+    size_t total = lineCount();
+    if (folded_count_ == 0) {
         return display_line;
     }
-    size_t visible_count = 0;
-    size_t total = lineCount();
-    for (size_t line = 0; line < total; ++line) {
-        if (!isLineInFoldedRange(static_cast<int>(line))) {
-            if (visible_count == display_line) {
-                return line;
-            }
-            ++visible_count;
-        }
+    size_t line = foldIndex().displayToActual(display_line);
+    if (line >= total) {
+        return total > 0 ? total - 1 : 0;
     }
-    return total > 0 ? total - 1 : 0;
+    return line;
 }
 
 size_t Document::displayLineToActualLine(size_t display_line) const {
@@ -1894,16 +2642,28 @@ size_t Document::displayLineToActualLine(size_t display_line) const {
 }
 
 size_t Document::actualLineToDisplayLine(size_t actual_line) const {
-    if (folded_lines_.empty()) {
+    if (folded_count_ == 0) {
         return actual_line;
     }
-    size_t visible_count = 0;
-    for (size_t line = 0; line <= actual_line && line < lineCount(); ++line) {
-        if (!isLineInFoldedRange(static_cast<int>(line))) {
-            ++visible_count;
-        }
+    size_t total = lineCount();
+    if (total == 0) {
+        return 0;
+    }
+    return foldIndex().actualToDisplay(std::min(actual_line, total - 1));
+}
+
+size_t Document::nextVisibleLine(size_t line) const {
+    if (folded_count_ == 0) {
+        return line;
+    }
+    return foldIndex().nextVisible(line);
+}
+
+size_t Document::prevVisibleLine(size_t line) const {
+    if (folded_count_ == 0) {
+        return line;
     }
-    return visible_count > 0 ? visible_count - 1 : 0;
+    return foldIndex().prevVisible(line);
 }
 
 } // namespace core
@@ -0,0 +1,90 @@
+#include "core/document_snapshot.h"
+#include <algorithm>
+
+namespace pnana {
+namespace core {
+
+DocumentSnapshot::DocumentSnapshot(uint64_t document_id, uint64_t version,
+                                   std::vector<Chunk> chunks)
+    : document_id_(document_id), version_(version), chunks_(std::move(chunks)) {
+    chunk_starts_.reserve(chunks_.size());
+    for (const auto& chunk : chunks_) {
+        chunk_starts_.push_back(line_count_);
+        line_count_ += chunk->size();
+    }
+}
+
+const std::string& DocumentSnapshot::line(size_t row) const {
+    static const std::string empty;
+    if (row >= line_count_) {
+        return empty;
+    }
+    auto it = std::upper_bound(chunk_starts_.begin(), chunk_starts_.end(), row);
+    size_t index = static_cast<size_t>(it - chunk_starts_.begin()) - 1;
+    return (*chunks_[index])[row - chunk_starts_[index]];
+}
+
+const std::string& DocumentSnapshot::text() const {
+    std::call_once(text_once_, [this]() {
+        size_t total = line_count_ > 0 ? line_count_ - 1 : 0;
+        for (const auto& chunk : chunks_) {
+            for (const auto& line : *chunk) {
+                total += line.size();
+            }
+        }
+        text_.reserve(total);
+        bool first = true;
+        for (const auto& chunk : chunks_) {
+            for (const auto& line : *chunk) {
+                if (!first) {
+                    text_ += '\n';
+                }
+                text_ += line;
+                first = false;
+            }
+        }
+    });
+    return text_;
+}
+
+uint64_t DocumentSnapshot::hash() const {
+    std::call_once(hash_once_, [this]() {
+        const uint64_t prime = 1099511628211ULL;
+        uint64_t h = 14695981039346656037ULL;
+        bool first = true;
+        for (const auto& chunk : chunks_) {
+            for (const auto& line : *chunk) {
+                if (!first) {
+                    h = (h ^ static_cast<unsigned char>('\n')) * prime;
+                }
+                for (unsigned char c : line) {
+                    h = (h ^ c) * prime;
+                }
+                first = false;
+            }
+        }
+        hash_ = h;
+    });
+    return hash_;
+}
+
+std::string DocumentSnapshot::joinLines(size_t first, size_t count) const {
+    if (first >= line_count_) {
+        return "";
+    }
+    count = std::min(count, line_count_ - first);
+    if (first == 0 && count == line_count_) {
+        return text();
+    }
+    std::string result;
+    for (size_t row = first; row < first + count; ++row) {
+        if (row > first) {
+            result += '\n';
+        }
+        result += line(row);
+    }
+    return result;
+}
+
+} // namespace core
+} // namespace pnana
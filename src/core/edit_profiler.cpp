@@ -0,0 +1,83 @@
+#include "core/edit_profiler.h"
+#include <algorithm>
+
+namespace pnana {
+namespace core {
+
+void EditProfiler::reset(size_t base_lines) {
+    ring_ = {};
+    next_ = 0;
+    count_ = 0;
+    scattered_ = 0;
+    appends_ = 0;
+    timed_ = 0;
+    backend_ns_sum_ = 0;
+    total_edits_ = 0;
+    has_last_row_ = false;
+    last_row_ = 0;
+    base_lines_ = base_lines;
+    line_count_ = base_lines;
+}
+
+void EditProfiler::record(size_t row, bool at_end, size_t line_count, int64_t backend_ns) {
+    if (base_lines_ == 0) {
+        base_lines_ = std::max<size_t>(line_count, 1);
+    }
+
+    Sample sample;
+    if (has_last_row_) {
+        size_t distance = row > last_row_ ? row - last_row_ : last_row_ - row;
+        sample.scattered = distance > LOCALITY_ROWS;
+    }
+    sample.append = at_end;
+    sample.backend_ns = backend_ns;
+
+    // 窗口已满时先扣掉被覆盖的旧样本
+    if (count_ == WINDOW) {
+        const Sample& old = ring_[next_];
+        scattered_ -= old.scattered ? 1 : 0;
+        appends_ -= old.append ? 1 : 0;
+        if (old.backend_ns >= 0) {
+            --timed_;
+            backend_ns_sum_ -= old.backend_ns;
+        }
+    } else {
+        ++count_;
+    }
+    ring_[next_] = sample;
+    next_ = (next_ + 1) % WINDOW;
+
+    scattered_ += sample.scattered ? 1 : 0;
+    appends_ += sample.append ? 1 : 0;
+    if (sample.backend_ns >= 0) {
+        ++timed_;
+        backend_ns_sum_ += sample.backend_ns;
+    }
+
+    ++total_edits_;
+    has_last_row_ = true;
+    last_row_ = row;
+    line_count_ = line_count;
+}
+
+EditWorkloadProfile EditProfiler::profile() const {
+    EditWorkloadProfile profile;
+    profile.samples = count_;
+    profile.timed_samples = timed_;
+    profile.line_count = line_count_;
+    if (base_lines_ > 0) {
+        profile.growth = static_cast<double>(line_count_) / static_cast<double>(base_lines_);
+    }
+    if (count_ > 0) {
+        profile.scattered_ratio = static_cast<double>(scattered_) / static_cast<double>(count_);
+        profile.append_ratio = static_cast<double>(appends_) / static_cast<double>(count_);
+    }
+    if (timed_ > 0) {
+        profile.avg_backend_us =
+            static_cast<double>(backend_ns_sum_) / static_cast<double>(timed_) / 1000.0;
+    }
+    return profile;
+}
+
+} // namespace core
+} // namespace pnana
@@ -19,6 +19,8 @@
 #include "ui/toast.h"
 #include "utils/file_type_detector.h"
 #include "utils/logger.h"
+#include "utils/perf_monitor.h"
+#include "utils/process_executor.h"
 #ifdef BUILD_LUA_SUPPORT
 #include "plugins/plugin_manager.h"
 #endif
@@ -31,6 +33,7 @@
 #include "features/md_render/markdown_renderer.h"
 #include <algorithm>
 #include <cctype>
+#include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <ftxui/component/component.hpp>
@@ -131,6 +134,11 @@ Editor::Editor()
     // 包管理器注册表延迟加载：在首次打开包管理面板时才初始化
     // 避免启动时创建 11 个包管理器实例造成的延迟
 
+    // 超长行的切片检查点取在分词器的 token 起点上，从检查点开始局部分词不会切断 token
+    long_line_view_.setTokenBoundary([this](const std::string& text, size_t limit) {
+        return syntax_highlighter_.lastTokenStart(text, limit);
+    });
+
     // 初始化命令面板
     initializeCommandPalette();
 
@@ -180,6 +188,13 @@ Editor::Editor()
             screen_.PostEvent(Event::Custom);
         });
     });
+    // 后台语法树解析完成：重绘一次，让高亮、括号匹配与折叠用上新树
+    syntax_tree_service_.setParsedCallback([this]() {
+        screen_.Post([this]() {
+            force_ui_update_ = true;
+            screen_.PostEvent(Event::Custom);
+        });
+    });
     fzf_popup_.setOnRemoteLoad([this](const std::string& ssh_uri) {
         onFzfRemoteLoad(ssh_uri);
     });
@@ -231,7 +246,8 @@ Editor::Editor()
             return;
         }
 
-        doc->getLines() = lines;
+        // 回滚是一次普通编辑，可以撤销
+        doc->setContent(std::move(lines), true);
         doc->setModified(true);
         cursor_row_ = 0;
         cursor_col_ = 0;
@@ -364,6 +380,22 @@ Editor::Editor()
     // （包括命令面板中的插件命令）
     initializePlugins();
 #endif
+    // 子进程执行服务：post_to_ui 的回调经 screen_.Post 回到 UI 线程，随后重绘一帧显示结果
+    utils::ProcessExecutor::getInstance().setUIDispatcher([this](std::function<void()> task) {
+        screen_.Post(std::move(task));
+        screen_.PostEvent(ftxui::Event::Custom);
+    });
+    // 文件浏览器展开本地目录时在后台读取，读完同样回到 UI 线程并入树中
+    file_browser_.setUIDispatcher([this](std::function<void()> task) {
+        screen_.Post(std::move(task));
+        screen_.PostEvent(ftxui::Event::Custom);
+    });
+    // 十六进制视图的字节搜索在后台线程进行，结果回到 UI 线程后跳转到匹配位置
+    binary_file_view_.setUIDispatcher([this](std::function<void()> task) {
+        screen_.Post(std::move(task));
+        screen_.PostEvent(ftxui::Event::Custom);
+    });
+
     // 启动后台动画/闪烁刷新调度：
     // - 光标闪烁开启时持续触发重绘
     // - 欢迎页显示时持续触发重绘（保证 logo 动画无需用户输入也能播放）
@@ -433,6 +465,20 @@ Editor::Editor(const std::vector<std::string>& filepaths) : Editor() {
 
 Editor::~Editor() {
     config_manager_.stopWatching();
+    // 之后完成的子进程不再向即将析构的 screen_ 投递回调
+    utils::ProcessExecutor::getInstance().setUIDispatcher(nullptr);
+    file_browser_.setUIDispatcher(nullptr);
+    binary_file_view_.setUIDispatcher(nullptr);
+#ifdef BUILD_AI_CLIENT_SUPPORT
+    // 进行中的 AI 回复同样不再投递，并中止对应的 HTTP 请求
+    if (ai_stream_) {
+        {
+            std::lock_guard<std::mutex> lock(ai_stream_->mutex);
+            ai_stream_->detached = true;
+        }
+        pnana::features::ai_client::AIClientManager::getInstance().cancelRequest();
+    }
+#endif
 
     // 先取消解压操作，避免析构时线程仍在运行并访问已销毁的成员
     if (extract_manager_.isExtracting()) {
@@ -445,17 +491,22 @@ Editor::~Editor() {
         lsp_manager_->shutdownAll();
     }
 #endif
+#ifdef BUILD_LUA_SUPPORT
+    // 插件 worker 线程通过 screen_ 唤醒主循环，须在 screen_ 析构前卸载插件并停止 worker
+    plugin_manager_.reset();
+#endif
 }
 
 void Editor::run() {
-    // 强制隐藏宿主终端光标，避免与编辑器内部光标叠加闪烁。
-    // 使用 RAII 确保无论正常退出或异常路径都恢复可见性。
+    // 强制隐藏宿主终端光标，避免与编辑器内部光标叠加闪烁；同时开启括号粘贴模式，
+    // 粘贴内容以 ESC[200~ ... ESC[201~ 包裹到达，由 InputRouter 整段插入。
+    // 使用 RAII 确保无论正常退出或异常路径都恢复终端状态。
     struct TerminalCursorGuard {
         TerminalCursorGuard() {
-            std::cout << "\x1b[?25l" << std::flush;
+            std::cout << "\x1b[?25l\x1b[?2004h" << std::flush;
         }
         ~TerminalCursorGuard() {
-            std::cout << "\x1b[?25h" << std::flush;
+            std::cout << "\x1b[?2004l\x1b[?25h" << std::flush;
         }
     };
 
@@ -503,6 +554,43 @@ void Editor::toggleRelativeNumbers() {
     setStatusMessage(relative_line_numbers_ ? "Relative line numbers" : "Absolute line numbers");
 }
 
+void Editor::toggleWordWrap() {
+    auto& editor_cfg = config_manager_.getConfig().editor;
+    editor_cfg.word_wrap = !editor_cfg.word_wrap;
+    view_offset_col_ = 0;
+    adjustViewOffset();
+    setStatusMessage(editor_cfg.word_wrap ? "Word wrap on" : "Word wrap off");
+}
+
+void Editor::togglePerfHud() {
+    auto& monitor = utils::PerfMonitor::getInstance();
+    monitor.setHudEnabled(!monitor.isHudEnabled());
+    setStatusMessage(monitor.isHudEnabled() ? "Performance HUD on (capturing trace)"
+                                            : "Performance HUD off");
+    force_ui_update_ = true;
+}
+
+void Editor::exportPerfTrace() {
+    auto& trace = utils::PerfTrace::getInstance();
+    if (!trace.isCapturing()) {
+        // 还没有采集数据：先开始采集，复现问题后再导出
+        trace.startCapture();
+        setStatusMessage("Performance capture started; run Export Performance Trace again to save");
+        return;
+    }
+
+    std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+    std::string path = "pnana-trace-" + std::string(stamp) + ".json";
+    std::string error;
+    if (trace.exportChromeTrace(path, error)) {
+        setStatusMessage("Chrome trace written to " + path + " (open in chrome://tracing)");
+    } else {
+        setStatusMessage("Trace export failed: " + error);
+    }
+}
+
 void Editor::zoomIn() {
     zoom_level_++;
     setStatusMessage("Zoom: +" + std::to_string(zoom_level_));
@@ -631,6 +719,10 @@ void Editor::applyLoadedConfig() {
     // 应用 display 配置
     show_line_numbers_ = config.display.show_line_numbers;
     relative_line_numbers_ = config.display.relative_line_numbers;
+    show_git_gutter_ = config.display.show_git_gutter;
+    if (!show_git_gutter_) {
+        git_gutters_.clear();
+    }
     show_helpbar_ = config.display.show_helpbar;
 
     // 应用状态栏样式（持久化）
@@ -1031,6 +1123,7 @@ bool Editor::isMarkdownPreviewActive() const {
 }
 
 ftxui::Element Editor::renderMarkdownPreview() {
+    PERF_ZONE(RENDER_PREVIEW);
     // Render preview using MarkdownRenderer directly (lightweight)
     pnana::features::MarkdownRenderConfig cfg;
     int half_width = std::max(10, getScreenWidth() / 2 - 4);
@@ -1038,9 +1131,11 @@ ftxui::Element Editor::renderMarkdownPreview() {
     cfg.use_color = true;
     cfg.theme = theme_.getCurrentThemeName();
     pnana::features::MarkdownRenderer renderer(cfg);
-    std::string content = getCurrentDocumentContent();
-    if (content.empty())
+    // 预览每帧都会渲染：快照在文档未修改时直接复用已拼接的全文
+    auto snapshot = getCurrentDocumentSnapshot();
+    if (!snapshot || snapshot->text().empty())
         return ftxui::text("");
+    const std::string& content = snapshot->text();
 
     auto elem = renderer.render(content);
 
@@ -1076,11 +1171,16 @@ ftxui::Element Editor::renderMarkdownPreview() {
 }
 
 std::string Editor::getCurrentDocumentContent() const {
+    auto snapshot = getCurrentDocumentSnapshot();
+    return snapshot ? snapshot->text() : "";
+}
+
+std::shared_ptr<const DocumentSnapshot> Editor::getCurrentDocumentSnapshot() const {
     const Document* doc = getCurrentDocument();
     if (!doc) {
-        return "";
+        return nullptr;
     }
-    return doc->getContent();
+    return doc->snapshot();
 }
 
 // Git 面板
@@ -1128,7 +1228,7 @@ void Editor::toggleTerminal() {
 
         // 如果终端高度未设置，使用默认值
         if (terminal_height_ <= 0) {
-            terminal_height_ = screen_.dimy() / 3;
+            terminal_height_ = getScreenHeight() / 3;
         }
         setStatusMessage("Terminal opened | Region: " + region_manager_.getRegionName() +
                          " | Use +/- to adjust height, ←→ to switch panels");
@@ -1382,7 +1482,7 @@ void Editor::initializeAIAssistant() {
 
     ai_assistant_panel_.setOnGetCurrentFile([this]() -> std::string {
         Document* doc = getCurrentDocument();
-        return doc ? doc->getContent() : "";
+        return doc ? doc->snapshot()->text() : "";
     });
 }
 
@@ -1622,18 +1722,51 @@ void Editor::handleAIMessage(const std::string& message) {
 
     ai_assistant_panel_.startStreamingResponse(current_config.model);
 
-    std::string accumulated_response;
-    manager.sendStreamingRequest(request, [this, &accumulated_response, message](
-                                              const std::string& chunk, bool is_finished) {
-        if (!chunk.empty()) {
-            ai_assistant_panel_.appendStreamingContent(chunk);
-            accumulated_response += chunk;
+    if (ai_stream_) {
+        std::lock_guard<std::mutex> lock(ai_stream_->mutex);
+        ai_stream_->detached = true;
+    }
+    auto stream = std::make_shared<AIStreamBuffer>();
+    ai_stream_ = stream;
+
+    // 在 UI 线程上把累积的文本一次交给面板；同一帧内到达的多个 chunk 只触发一次重绘
+    auto flush = [this, stream, message]() {
+        std::string text;
+        bool finished;
+        {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            if (stream->detached) {
+                return;
+            }
+            text.swap(stream->pending);
+            finished = stream->finished;
+            stream->flush_posted = false;
+        }
+        if (!text.empty()) {
+            ai_assistant_panel_.appendStreamingContent(text);
+            stream->response += text;
         }
-        if (is_finished) {
+        if (finished) {
             ai_assistant_panel_.finishStreamingResponse();
-            ai_assistant_panel_.addToConversationHistory(message, accumulated_response);
+            ai_assistant_panel_.addToConversationHistory(message, stream->response);
         }
-    });
+    };
+
+    manager.sendStreamingRequest(
+        request, [this, stream, flush](const std::string& chunk, bool is_finished) {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            if (stream->detached) {
+                return;
+            }
+            stream->pending += chunk;
+            stream->finished = stream->finished || is_finished;
+            if (stream->flush_posted) {
+                return;
+            }
+            stream->flush_posted = true;
+            screen_.Post(flush);
+            screen_.PostEvent(ftxui::Event::Custom);
+        });
 }
 #endif // BUILD_AI_CLIENT_SUPPORT
 void Editor::insertCodeAtCursor(const std::string& code) {
@@ -1696,7 +1829,8 @@ std::string Editor::getSelectedText() const {
     size_t end_col = (end_row == selection_start_row_) ? selection_start_col_ : cursor_col_;
 
     std::string result;
-    const auto& lines = doc->getLines();
+    const Document& const_doc = *doc;
+    const auto& lines = const_doc.getLines();
 
     for (size_t row = start_row; row <= end_row && row < lines.size(); ++row) {
         const std::string& line = lines[row];
@@ -1758,14 +1892,12 @@ void Editor::buildEnhancedContext(pnana::features::ai_client::AIRequest& request
         add("Detected file type: " +
             utils::FileTypeDetector::detectFileType(doc->getFileName(), doc->getFileExtension()));
 
-        if (!doc->getContent().empty()) {
-            std::string content = doc->getContent();
+        // 快照按版本缓存全文，重复构建上下文时不再重新拼接；压缩时直接按行读取
+        auto snapshot = doc->snapshot();
+        const std::string& content = snapshot->text();
+        if (!content.empty()) {
             if (content.size() > kCurrentFileMaxChars) {
-                std::vector<std::string> lines;
-                std::istringstream iss(content);
-                for (std::string line; std::getline(iss, line);)
-                    lines.push_back(line);
-                const int total_lines = static_cast<int>(lines.size());
+                const int total_lines = static_cast<int>(snapshot->lineCount());
                 int cur = static_cast<int>(cursor_row_);
                 int start_near = std::max(0, cur - kLinesNearCursor / 2);
                 int end_near = std::min(total_lines, start_near + kLinesNearCursor);
@@ -1773,19 +1905,19 @@ void Editor::buildEnhancedContext(pnana::features::ai_client::AIRequest& request
                 for (int i = 0; i < std::min(kHeadLines, total_lines); ++i) {
                     if (i)
                         compressed += "\n";
-                    compressed += lines[i];
+                    compressed += snapshot->line(static_cast<size_t>(i));
                 }
                 if (total_lines > kHeadLines) {
                     int omitted1 = std::max(0, start_near - kHeadLines);
                     compressed += "\n... [omitted " + std::to_string(omitted1) + " lines] ...\n";
                     for (int i = start_near; i < end_near && i < total_lines; ++i)
-                        compressed += lines[i] + "\n";
+                        compressed += snapshot->line(static_cast<size_t>(i)) + "\n";
                     int tail_start = std::max(0, total_lines - kTailLines);
                     if (end_near < tail_start) {
                         int omitted2 = std::max(0, tail_start - end_near);
                         compressed += "... [omitted " + std::to_string(omitted2) + " lines] ...\n";
                         for (int i = tail_start; i < total_lines; ++i)
-                            compressed += lines[i] + "\n";
+                            compressed += snapshot->line(static_cast<size_t>(i)) + "\n";
                     }
                 }
                 add("Current file content:\n" + compressed);
@@ -2055,7 +2187,7 @@ void Editor::convertFileEncoding(const std::string& new_encoding) {
             }
 
             // 更新文档行
-            doc->getLines() = new_lines;
+            doc->setContent(std::move(new_lines));
             doc->setModified(false);
         } else {
             // 如果文件为空，重新加载
@@ -2681,7 +2813,7 @@ bool Editor::resizeActiveSplitRegion(int delta) {
     if (active_region->x < 0 || active_region->y < 0 || active_region->width <= 0 ||
         active_region->height <= 0) {
         // 重新计算分屏线位置
-        split_view_manager_.updateRegionSizes(screen_.dimx(), screen_.dimy());
+        split_view_manager_.updateRegionSizes(getScreenWidth(), getScreenHeight());
         // 重新获取区域信息
         const auto* fixed_region = split_view_manager_.getActiveRegion();
         if (fixed_region && fixed_region->x >= 0 && fixed_region->y >= 0) {
@@ -2724,7 +2856,8 @@ bool Editor::resizeActiveSplitRegion(int delta) {
 
         if (should_adjust) {
             // 调整分屏线位置
-            split_view_manager_.adjustSplitLinePosition(i, delta, screen_.dimx(), screen_.dimy());
+            split_view_manager_.adjustSplitLinePosition(i, delta, getScreenWidth(),
+                                                        getScreenHeight());
             return true;
         }
     }
@@ -2755,8 +2888,8 @@ void Editor::splitView(features::SplitDirection direction) {
         split_view_manager_.setCurrentDocumentIndex(current_doc_index);
     }
 
-    int screen_width = screen_.dimx();
-    int screen_height = screen_.dimy();
+    int screen_width = getScreenWidth();
+    int screen_height = getScreenHeight();
 
     // 如果文件浏览器打开，需要减去文件浏览器的宽度
     if (file_browser_.isVisible()) {
@@ -3015,11 +3148,11 @@ bool Editor::isGitPanelVisible() const {
 }
 
 int Editor::getScreenHeight() const {
-    return screen_.dimy();
+    return headless_height_ > 0 ? headless_height_ : screen_.dimy();
 }
 
 int Editor::getScreenWidth() const {
-    return screen_.dimx();
+    return headless_width_ > 0 ? headless_width_ : screen_.dimx();
 }
 
 // 渲染批处理控制实现（方案1）
@@ -20,17 +20,21 @@ void Editor::updateBracketHighlight() {
         bracket_cache_cursor_col_ = cursor_col_;
         bracket_cache_file_path_.clear();
         bracket_cache_document_index_.reset();
+        bracket_cache_version_ = UINT64_MAX;
         return;
     }
 
     const size_t current_doc_index = getDocumentIndexForActiveRegion();
     const std::string file_path = doc->getFilePath();
+    const uint64_t version = doc->getVersion();
+    const uint64_t tree_generation = syntax_tree_service_.generation(*doc);
 
-    // 光标与文档都没变时不重复计算，避免频繁渲染时重复扫描
+    // 光标、文档内容与语法树都没变时不重复计算，避免频繁渲染时重复扫描
     if (bracket_cache_cursor_row_ == cursor_row_ && bracket_cache_cursor_col_ == cursor_col_ &&
         bracket_cache_document_index_.has_value() &&
         bracket_cache_document_index_.value() == current_doc_index &&
-        bracket_cache_file_path_ == file_path) {
+        bracket_cache_file_path_ == file_path && bracket_cache_version_ == version &&
+        bracket_cache_tree_generation_ == tree_generation) {
         return;
     }
 
@@ -38,14 +42,21 @@ void Editor::updateBracketHighlight() {
     bracket_cache_cursor_col_ = cursor_col_;
     bracket_cache_document_index_ = current_doc_index;
     bracket_cache_file_path_ = file_path;
+    bracket_cache_version_ = version;
+    bracket_cache_tree_generation_ = tree_generation;
 
     if (cursor_row_ >= doc->lineCount()) {
         clearBracketHighlight();
         return;
     }
 
-    const auto result =
-        pnana::utils::findMatchingBracket(doc->getLines(), cursor_row_, cursor_col_);
+    // 有语法树时按树匹配：字符串、注释里的括号不参与配对；否则退回文本扫描
+    const Document& const_doc = *doc;
+    const auto result = syntax_tree_service_.tree(const_doc)
+                            ? syntax_tree_service_.findMatchingBracket(const_doc, cursor_row_,
+                                                                       cursor_col_)
+                            : pnana::utils::findMatchingBracket(const_doc.getLines(), cursor_row_,
+                                                                cursor_col_);
     if (!result.has_value()) {
         clearBracketHighlight();
         return;
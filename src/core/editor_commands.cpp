@@ -176,6 +176,26 @@ void Editor::initializeCommandPalette() {
                                                  toggleLineNumbers();
                                              }));
 
+    command_palette_.registerCommand(Command("view.word_wrap", "Toggle Word Wrap",
+                                             "Soft-wrap long lines to the window width",
+                                             {"wrap", "word", "soft", "view", "toggle"}, [this]() {
+                                                 toggleWordWrap();
+                                             }));
+
+    command_palette_.registerCommand(Command("view.perf_hud", "Toggle Performance HUD",
+                                             "Show frame time percentiles in the statusbar",
+                                             {"perf", "performance", "hud", "fps", "frame"},
+                                             [this]() {
+                                                 togglePerfHud();
+                                             }));
+
+    command_palette_.registerCommand(Command("perf.export_trace", "Export Performance Trace",
+                                             "Write captured events as Chrome trace_event JSON",
+                                             {"perf", "trace", "profile", "chrome", "export"},
+                                             [this]() {
+                                                 exportPerfTrace();
+                                             }));
+
     // 注册标签页操作命令
     command_palette_.registerCommand(
         Command("tab.next", "Next Tab", "Switch to next tab", {"tab", "next", "switch"}, [this]() {
@@ -11,7 +11,7 @@ void Editor::toggleComment() {
     if (!doc)
         return;
 
-    auto& lines = doc->getLines();
+    const auto& lines = doc->getLines();
     if (lines.empty())
         return;
 
@@ -31,33 +31,19 @@ void Editor::toggleComment() {
             return;
     }
 
-    std::string old_lines_content;
-    for (size_t r = start_row; r <= end_row; ++r) {
-        old_lines_content += lines[r];
-        if (r < end_row)
-            old_lines_content += "\n";
-    }
-
+    // 每行一个整行替换，经 applyEdits 作为一个撤销组提交并记入编辑日志
     int total_col_offset = 0;
-
+    std::vector<TextEdit> edits;
     for (size_t r = start_row; r <= end_row; ++r) {
-        std::string& line = lines[r];
-        auto [new_line, col_offset] = utils::toggleCommentForLine(line, file_type);
-        line = new_line;
+        auto [new_line, col_offset] = utils::toggleCommentForLine(lines[r], file_type);
         if (start_row == end_row) {
             total_col_offset = col_offset;
         }
+        if (new_line != lines[r]) {
+            edits.push_back(TextEdit{r, 0, r, lines[r].length(), std::move(new_line)});
+        }
     }
-
-    std::string new_lines_content;
-    for (size_t r = start_row; r <= end_row; ++r) {
-        new_lines_content += lines[r];
-        if (r < end_row)
-            new_lines_content += "\n";
-    }
-
-    doc->pushChange(DocumentChange(DocumentChange::Type::COMMENT_TOGGLE, start_row, end_row,
-                                   old_lines_content, new_lines_content, DocumentChange::MOVE_TAG));
+    doc->applyEdits(edits);
 
     if (start_row == end_row) {
         int new_col = static_cast<int>(cursor_col_) + total_col_offset;
@@ -66,7 +52,6 @@ void Editor::toggleComment() {
         selection_active_ = false;
     }
 
-    doc->setModified(true);
     setStatusMessage("Comment toggled");
 }
 
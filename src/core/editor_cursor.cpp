@@ -60,11 +60,59 @@ bool isChineseChar(const std::string& ch) {
 
 #include "core/editor.h"
 #include "utils/logger.h"
+#include "utils/text_utils.h"
 #include <algorithm>
 
 namespace pnana {
 namespace core {
 
+namespace {
+
+size_t codepointColumns(const std::string& line, size_t pos, size_t col, int tab_size,
+                        size_t& bytes) {
+    bytes = 1;
+    unsigned char c = static_cast<unsigned char>(line[pos]);
+    if (c == '\t') {
+        return static_cast<size_t>(tab_size) - col % static_cast<size_t>(tab_size);
+    }
+    if (c < 0x80) {
+        return 1;
+    }
+    return static_cast<size_t>(
+        utils::getCodepointDisplayWidth(utils::decodeUtf8At(line, pos, bytes)));
+}
+
+// 软换行视觉行内 from 到 pos 的显示列（制表符按视觉行起点对齐，与 WrapIndex 的折行一致）
+size_t wrapRowDisplayCol(const std::string& line, size_t from, size_t pos, int tab_size) {
+    size_t col = 0;
+    size_t i = from;
+    while (i < pos && i < line.size()) {
+        size_t bytes = 1;
+        col += codepointColumns(line, i, col, tab_size, bytes);
+        i += bytes;
+    }
+    return col;
+}
+
+// 视觉行 [from, to) 中显示列 display_col 所在字符的字节列，超出时返回 to
+size_t wrapRowByteAt(const std::string& line, size_t from, size_t to, size_t display_col,
+                     int tab_size) {
+    size_t col = 0;
+    size_t i = from;
+    while (i < to && i < line.size()) {
+        size_t bytes = 1;
+        size_t w = codepointColumns(line, i, col, tab_size, bytes);
+        if (col + w > display_col) {
+            break;
+        }
+        col += w;
+        i += bytes;
+    }
+    return i;
+}
+
+} // namespace
+
 size_t Editor::rawColToDisplayCol(const std::string& line, size_t raw_col, int tab_size) {
     if (tab_size <= 0)
         tab_size = 4;
@@ -80,6 +128,163 @@ size_t Editor::rawColToDisplayCol(const std::string& line, size_t raw_col, int t
     return display_col;
 }
 
+const WrapIndex* Editor::getActiveWrapIndex(Document* doc) {
+    const auto& editor_cfg = config_manager_.getConfig().editor;
+    if (!doc || !editor_cfg.word_wrap || split_view_manager_.hasSplits()) {
+        return nullptr;
+    }
+    // 与 renderLine 的内容区宽度一致
+    int width = getScreenWidth() - getLineNumberWidth(doc) - 4;
+    if (width < 20) {
+        width = 20;
+    }
+    int tab_size = std::max(1, std::min(8, editor_cfg.tab_size));
+    return doc->getWrapIndex(static_cast<size_t>(width), tab_size);
+}
+
+Editor::WrapPos Editor::getWrapViewTop(Document* doc, const WrapIndex& wrap) const {
+    size_t line = doc->getActualLineForDisplayLine(view_offset_row_);
+    if (line >= doc->lineCount()) {
+        line = doc->lineCount() > 0 ? doc->lineCount() - 1 : 0;
+    }
+    size_t subrow = 0;
+    if (wrap_view_document_id_ == doc->getInstanceId() && wrap_view_row_ == view_offset_row_) {
+        subrow = std::min(wrap_view_subrow_, wrap.rowsOf(line) - 1);
+    }
+    return {line, subrow};
+}
+
+void Editor::setWrapViewTop(Document* doc, WrapPos top) {
+    view_offset_row_ = doc->actualLineToDisplayLine(top.first);
+    wrap_view_document_id_ = doc->getInstanceId();
+    wrap_view_row_ = view_offset_row_;
+    wrap_view_subrow_ = top.second;
+}
+
+Editor::WrapPos Editor::stepWrapPos(Document* doc, const WrapIndex& wrap, WrapPos pos,
+                                    int64_t delta) const {
+    const size_t line_count = doc->lineCount();
+    if (doc->getVisibleLineCount() == line_count) {
+        // 无折叠：视觉行前缀和直接定位，与跨越的行数无关
+        int64_t row = static_cast<int64_t>(wrap.rowsBefore(pos.first) + pos.second) + delta;
+        int64_t last = static_cast<int64_t>(wrap.totalRows()) - 1;
+        return wrap.locate(static_cast<size_t>(std::max<int64_t>(0, std::min(row, last))));
+    }
+
+    while (delta > 0) {
+        size_t remaining = wrap.rowsOf(pos.first) - 1 - pos.second;
+        if (static_cast<uint64_t>(delta) <= remaining) {
+            pos.second += static_cast<size_t>(delta);
+            return pos;
+        }
+        size_t next = doc->nextVisibleLine(pos.first + 1);
+        if (next >= line_count) {
+            pos.second = wrap.rowsOf(pos.first) - 1;
+            return pos;
+        }
+        delta -= static_cast<int64_t>(remaining + 1);
+        pos = {next, 0};
+    }
+    while (delta < 0) {
+        if (static_cast<uint64_t>(-delta) <= pos.second) {
+            pos.second -= static_cast<size_t>(-delta);
+            return pos;
+        }
+        if (pos.first == 0) {
+            pos.second = 0;
+            return pos;
+        }
+        delta += static_cast<int64_t>(pos.second + 1);
+        size_t prev = doc->prevVisibleLine(pos.first - 1);
+        pos = {prev, wrap.rowsOf(prev) - 1};
+    }
+    return pos;
+}
+
+size_t Editor::wrapDistance(Document* doc, const WrapIndex& wrap, WrapPos from, WrapPos to,
+                            size_t limit) const {
+    if (to < from) {
+        return 0;
+    }
+    if (doc->getVisibleLineCount() == doc->lineCount()) {
+        size_t distance = (wrap.rowsBefore(to.first) + to.second) -
+                          (wrap.rowsBefore(from.first) + from.second);
+        return std::min(distance, limit);
+    }
+
+    size_t distance = 0;
+    while (from.first < to.first) {
+        distance += wrap.rowsOf(from.first) - from.second;
+        if (distance >= limit) {
+            return limit;
+        }
+        from = {doc->nextVisibleLine(from.first + 1), 0};
+    }
+    if (from.first == to.first && to.second > from.second) {
+        distance += to.second - from.second;
+    }
+    return std::min(distance, limit);
+}
+
+Editor::WrapPos Editor::cursorWrapPos(Document* doc, const WrapIndex& wrap) const {
+    return {cursor_row_, wrap.subRowOf(cursor_row_, doc->getLine(cursor_row_), cursor_col_)};
+}
+
+size_t Editor::cursorWrapDisplayCol(Document* doc, const WrapIndex& wrap) const {
+    const std::string& line = doc->getLine(cursor_row_);
+    const auto& starts = wrap.rowStarts(cursor_row_, line);
+    size_t subrow = wrap.subRowOf(cursor_row_, line, cursor_col_);
+    int tab_size = std::max(1, std::min(8, config_manager_.getConfig().editor.tab_size));
+    return wrapRowDisplayCol(line, starts[subrow], cursor_col_, tab_size);
+}
+
+void Editor::placeCursorInWrapRow(Document* doc, const WrapIndex& wrap, WrapPos pos,
+                                  size_t display_col) {
+    const std::string& line = doc->getLine(pos.first);
+    const auto& starts = wrap.rowStarts(pos.first, line);
+    size_t subrow = std::min(pos.second, starts.size() - 1);
+    bool last_row = subrow + 1 >= starts.size();
+    size_t from = starts[subrow];
+    size_t to = last_row ? line.size() : starts[subrow + 1];
+    int tab_size = std::max(1, std::min(8, config_manager_.getConfig().editor.tab_size));
+
+    size_t col = wrapRowByteAt(line, from, to, display_col, tab_size);
+    if (!last_row && col >= to) {
+        // 非末尾视觉行的行尾属于下一视觉行，停在本行最后一个字符上
+        col = to - utils::getUtf8CharBytesBefore(line, to);
+    }
+    cursor_row_ = pos.first;
+    cursor_col_ = col;
+}
+
+void Editor::adjustWrappedViewOffset(Document* doc, const WrapIndex& wrap, int screen_height) {
+    view_offset_col_ = 0;
+    const size_t height = static_cast<size_t>(std::max(1, screen_height));
+    const size_t scrolloff = std::min<size_t>(3, (height - 1) / 2);
+
+    WrapPos top = getWrapViewTop(doc, wrap);
+    WrapPos cursor = cursorWrapPos(doc, wrap);
+    if (cursor < top) {
+        top = stepWrapPos(doc, wrap, cursor, -static_cast<int64_t>(scrolloff));
+    } else {
+        size_t distance = wrapDistance(doc, wrap, top, cursor, height);
+        if (distance < scrolloff) {
+            top = stepWrapPos(doc, wrap, cursor, -static_cast<int64_t>(scrolloff));
+        } else if (distance + scrolloff >= height) {
+            top = stepWrapPos(doc, wrap, cursor, -static_cast<int64_t>(height - 1 - scrolloff));
+        }
+    }
+
+    // 与非换行模式一致：最后一个视觉行到达屏幕底部后不再继续下滚
+    size_t last_line = doc->prevVisibleLine(doc->lineCount() - 1);
+    WrapPos end = {last_line, wrap.rowsOf(last_line) - 1};
+    WrapPos max_top = stepWrapPos(doc, wrap, end, -static_cast<int64_t>(height - 1));
+    if (max_top < top) {
+        top = max_top;
+    }
+    setWrapViewTop(doc, top);
+}
+
 // 光标移动
 void Editor::moveCursorUp() {
     // 如果当前有选中状态，且不是通过 Shift 键移动，取消选中
@@ -88,13 +293,26 @@ void Editor::moveCursorUp() {
     }
 
     auto doc = getCurrentDocument();
-    if (!doc || cursor_row_ == 0)
+    if (!doc)
         return;
 
-    size_t prev = cursor_row_ - 1;
-    while (prev > 0 && doc->isLineInFoldedRange(static_cast<int>(prev))) {
-        --prev;
+    // 软换行：按视觉行移动，保持显示列
+    if (const WrapIndex* wrap = getActiveWrapIndex(doc)) {
+        WrapPos pos = cursorWrapPos(doc, *wrap);
+        WrapPos target = stepWrapPos(doc, *wrap, pos, -1);
+        if (target != pos) {
+            placeCursorInWrapRow(doc, *wrap, target, cursorWrapDisplayCol(doc, *wrap));
+            adjustViewOffset();
+        }
+        clearSearchHighlight();
+        updateBracketHighlight();
+        return;
     }
+
+    if (cursor_row_ == 0)
+        return;
+
+    size_t prev = doc->prevVisibleLine(cursor_row_ - 1);
     if (!doc->isLineInFoldedRange(static_cast<int>(prev))) {
         cursor_row_ = prev;
         adjustCursor();
@@ -118,14 +336,23 @@ void Editor::moveCursorDown() {
     if (!doc)
         return;
 
+    if (const WrapIndex* wrap = getActiveWrapIndex(doc)) {
+        WrapPos pos = cursorWrapPos(doc, *wrap);
+        WrapPos target = stepWrapPos(doc, *wrap, pos, 1);
+        if (target != pos) {
+            placeCursorInWrapRow(doc, *wrap, target, cursorWrapDisplayCol(doc, *wrap));
+            adjustViewOffset();
+        }
+        clearSearchHighlight();
+        updateWordHighlight();
+        return;
+    }
+
     size_t total = doc->lineCount();
     if (cursor_row_ + 1 >= total)
         return;
 
-    size_t next = cursor_row_ + 1;
-    while (next + 1 < total && doc->isLineInFoldedRange(static_cast<int>(next))) {
-        ++next;
-    }
+    size_t next = doc->nextVisibleLine(cursor_row_ + 1);
     if (next < total && !doc->isLineInFoldedRange(static_cast<int>(next))) {
         cursor_row_ = next;
         adjustCursor();
@@ -227,7 +454,7 @@ void Editor::moveCursorPageUp() {
 
     // 统一计算屏幕高度：减去标签栏(1) + 分隔符(1) + 状态栏(1) + 输入框(1) + 帮助栏(1) + 分隔符(1) =
     // 6行，再减去边框(2) = 8行
-    int screen_height = screen_.dimy() - 7;
+    int screen_height = getScreenHeight() - 7;
     if (screen_height <= 0) {
         screen_height = 1; // 防止除零错误
     }
@@ -236,6 +463,17 @@ void Editor::moveCursorPageUp() {
     if (total_lines == 0)
         return;
 
+    // 软换行：视图与光标同时移动一屏视觉行
+    if (const WrapIndex* wrap = getActiveWrapIndex(doc)) {
+        const int64_t page = -static_cast<int64_t>(screen_height);
+        size_t display_col = cursorWrapDisplayCol(doc, *wrap);
+        setWrapViewTop(doc, stepWrapPos(doc, *wrap, getWrapViewTop(doc, *wrap), page));
+        placeCursorInWrapRow(doc, *wrap, stepWrapPos(doc, *wrap, cursorWrapPos(doc, *wrap), page),
+                             display_col);
+        adjustViewOffset();
+        return;
+    }
+
     // 计算当前光标在可见区域中的位置
     size_t cursor_visible_row =
         (cursor_row_ >= view_offset_row_) ? (cursor_row_ - view_offset_row_) : 0;
@@ -285,7 +523,7 @@ void Editor::moveCursorPageDown() {
 
     // 统一计算屏幕高度：减去标签栏(1) + 分隔符(1) + 状态栏(1) + 输入框(1) + 帮助栏(1) + 分隔符(1) =
     // 6行，再减去边框(2) = 8行
-    int screen_height = screen_.dimy() - 7;
+    int screen_height = getScreenHeight() - 7;
     if (screen_height <= 0) {
         screen_height = 1; // 防止除零错误
     }
@@ -294,6 +532,16 @@ void Editor::moveCursorPageDown() {
     if (total_lines == 0)
         return;
 
+    if (const WrapIndex* wrap = getActiveWrapIndex(doc)) {
+        const int64_t page = static_cast<int64_t>(screen_height);
+        size_t display_col = cursorWrapDisplayCol(doc, *wrap);
+        setWrapViewTop(doc, stepWrapPos(doc, *wrap, getWrapViewTop(doc, *wrap), page));
+        placeCursorInWrapRow(doc, *wrap, stepWrapPos(doc, *wrap, cursorWrapPos(doc, *wrap), page),
+                             display_col);
+        adjustViewOffset();
+        return;
+    }
+
     // 计算当前光标在可见区域中的位置
     size_t cursor_visible_row =
         (cursor_row_ >= view_offset_row_) ? (cursor_row_ - view_offset_row_) : 0;
@@ -519,7 +767,7 @@ void Editor::adjustCursor() {
 void Editor::adjustViewOffset() {
     // 统一计算屏幕高度：减去标签栏(1) + 分隔符(1) + 状态栏(1) + 输入框(1) + 帮助栏(1) + 分隔符(1) =
     // 6行，再减去边框(2) = 8行
-    int screen_height = screen_.dimy() - 7;
+    int screen_height = getScreenHeight() - 7;
     if (screen_height <= 0) {
         screen_height = 1; // 防止除零错误
     }
@@ -535,6 +783,16 @@ void Editor::adjustViewOffset() {
         return;
     }
 
+    // 软换行：按视觉行保持 scrolloff，不做水平滚动
+    if (const WrapIndex* wrap = getActiveWrapIndex(doc)) {
+        if (cursor_row_ >= total_lines) {
+            cursor_row_ = total_lines - 1;
+        }
+        cursor_col_ = std::min(cursor_col_, doc->getLine(cursor_row_).length());
+        adjustWrappedViewOffset(doc, *wrap, screen_height);
+        return;
+    }
+
     // 类似 neovim 的 scrolloff 功能：保持光标上下各保留一定行数可见
     // 这样可以避免光标紧贴屏幕边缘，提供更好的视觉体验
     const int scrolloff = 3; // 光标上下各保留3行可见
@@ -597,7 +855,7 @@ void Editor::adjustViewOffset() {
     }
 
     // 确保光标列位置有效
-    size_t line_len = doc->getLine(cursor_row_).length();
+    size_t line_len = doc->getLineLength(cursor_row_);
     if (cursor_col_ > line_len) {
         cursor_col_ = line_len;
     }
@@ -611,7 +869,7 @@ void Editor::adjustViewOffset() {
             digits++;
         line_num_width = digits < 2 ? 2 : digits;
     }
-    int screen_width = screen_.dimx();
+    int screen_width = getScreenWidth();
     if (split_view_manager_.hasSplits()) {
         const auto* active_region = split_view_manager_.getActiveRegion();
         if (active_region && active_region->width > 0) {
@@ -622,9 +880,10 @@ void Editor::adjustViewOffset() {
     if (visible_width < 20)
         visible_width = 20;
 
-    std::string cursor_line = doc->getLine(cursor_row_);
+    // 超长行从最近的检查点累计显示列，不复制整行
     int tab_size = std::max(1, std::min(8, config_manager_.getConfig().editor.tab_size));
-    size_t display_cursor_col = rawColToDisplayCol(cursor_line, cursor_col_, tab_size);
+    size_t display_cursor_col = long_line_view_.displayColumn(
+        *doc, cursor_row_, cursor_col_, tab_size, syntax_highlighter_.getFileType());
 
     const int h_scrolloff = 5;
 
@@ -648,7 +907,7 @@ void Editor::adjustViewOffsetForUndo(size_t target_row, size_t /*target_col*/) {
     // 撤销操作应该尽量保持用户的视觉上下文，避免剧烈跳跃
     // 使用更小的scrolloff值，让调整更平滑
 
-    int screen_height = screen_.dimy() - 7; // 减去6行UI元素 + 2行边框
+    int screen_height = getScreenHeight() - 7; // 减去6行UI元素 + 2行边框
     if (screen_height <= 0) {
         screen_height = 1;
     }
@@ -695,7 +954,7 @@ void Editor::adjustViewOffsetForUndoConservative(size_t target_row, size_t /*tar
     // 2. 只有当光标完全超出可见区域时才调整，且调整幅度最小
     // 3. 完全避免使用scrolloff机制，因为撤销应该保持用户的视觉上下文
 
-    int screen_height = screen_.dimy() - 7; // 减去6行UI元素 + 2行边框
+    int screen_height = getScreenHeight() - 7; // 减去6行UI元素 + 2行边框
     if (screen_height <= 0) {
         screen_height = 1;
     }
@@ -772,7 +1031,7 @@ void Editor::adjustCursorAndViewConservative() {
     // 2. 只有当光标完全超出可见区域时才调整，且调整幅度最小
     // 3. 完全避免使用scrolloff机制，因为撤销应该保持用户的视觉上下文
 
-    int screen_height = screen_.dimy() - 7; // 减去6行UI元素 + 2行边框
+    int screen_height = getScreenHeight() - 7; // 减去6行UI元素 + 2行边框
     if (screen_height <= 0) {
         screen_height = 1;
     }
@@ -825,7 +1084,7 @@ void Editor::adjustCursorAndViewForRedo() {
     }
 
     // 2. 重做操作的视图调整（可以更激进，因为重做通常是用户主动操作）
-    int screen_height = screen_.dimy() - 7; // 减去6行UI元素 + 2行边框
+    int screen_height = getScreenHeight() - 7; // 减去6行UI元素 + 2行边框
     if (screen_height > 0) {
         // 计算光标在屏幕上的位置
         int cursor_screen_pos = static_cast<int>(cursor_row_) - static_cast<int>(view_offset_row_);
@@ -860,7 +1119,7 @@ void Editor::prepareForStaticUndo(size_t change_row, size_t change_col) {
         return;
     }
 
-    int screen_height = screen_.dimy() - 7; // 减去6行UI元素 + 2行边框
+    int screen_height = getScreenHeight() - 7; // 减去6行UI元素 + 2行边框
     if (screen_height <= 0) {
         screen_height = 1;
     }
@@ -997,7 +1256,7 @@ void Editor::prepareForStaticRedo(size_t change_row, size_t /*change_col*/) {
         return;
     }
 
-    int screen_height = screen_.dimy() - 7; // 减去6行UI元素 + 2行边框
+    int screen_height = getScreenHeight() - 7; // 减去6行UI元素 + 2行边框
     if (screen_height <= 0) {
         screen_height = 1;
     }
@@ -6,7 +6,6 @@
 #include "utils/logger.h"
 #include "utils/text_utils.h"
 #include <iostream>
-#include <sstream>
 
 namespace pnana {
 namespace core {
@@ -184,27 +183,9 @@ void Editor::insertNewline() {
 
     auto t_newline_start = std::chrono::steady_clock::now();
 
-    std::string current_line = doc->getLine(cursor_row_);
-    std::string before_cursor = current_line.substr(0, cursor_col_);
-    std::string after_cursor = current_line.substr(cursor_col_);
-
-    size_t abs_pos = 0;
-    for (size_t i = 0; i < cursor_row_; ++i) {
-        abs_pos += doc->getLine(i).length() + 1;
-    }
-    abs_pos += cursor_col_;
-
-    doc->getBufferBackend()->replace(abs_pos, current_line.length() - cursor_col_,
-                                     "\n" + after_cursor);
-
-    doc->getLines()[cursor_row_] = before_cursor;
-    doc->getLines().insert(doc->getLines().begin() + cursor_row_ + 1, after_cursor);
-
-    doc->pushChange(DocumentChange(DocumentChange::Type::NEWLINE, cursor_row_, cursor_col_,
-                                   current_line, before_cursor, after_cursor));
-
-    cursor_row_++;
-    cursor_col_ = 0;
+    // 换行与随后的自动缩进属于同一个撤销组
+    doc->applyEdits({TextEdit{cursor_row_, cursor_col_, cursor_row_, cursor_col_, "\n"}},
+                    &cursor_row_, &cursor_col_);
 
     // 粘贴时禁用自动缩进，避免双重缩进
     if (is_pasting_) {
@@ -242,11 +223,14 @@ void Editor::insertNewline() {
                     }
                 }
                 auto_indent_engine_.setFileType(file_type, indent_cfg);
+                // 树已同步到刚插入的换行（位置一致，结构可能滞后一次后台解析）
+                const Document& const_doc = *doc;
                 std::string indent = auto_indent_engine_.computeIndentAfterNewline(
-                    doc->getLines(), cursor_row_, cursor_col_);
+                    const_doc.getLines(), cursor_row_, cursor_col_,
+                    syntax_tree_service_.update(const_doc, file_type));
                 if (!indent.empty()) {
-                    doc->getLines()[cursor_row_] = indent + after_cursor;
-                    cursor_col_ = indent.size();
+                    doc->appendEdits({TextEdit{cursor_row_, 0, cursor_row_, 0, indent}}, nullptr,
+                                     &cursor_col_);
                 }
             } else {
                 std::string file_type = getFileType();
@@ -276,11 +260,12 @@ void Editor::insertNewline() {
                 if (default_cfg.smart_indent) {
                     auto_indent_engine_.setIndentConfig(default_cfg);
                     auto_indent_engine_.setFileType(file_type);
-                    std::string indent =
-                        computeAutoIndent(doc->getLines(), cursor_row_, cursor_col_, default_cfg);
+                    const Document& const_doc = *doc;
+                    std::string indent = computeAutoIndent(const_doc.getLines(), cursor_row_,
+                                                           cursor_col_, default_cfg);
                     if (!indent.empty()) {
-                        doc->getLines()[cursor_row_] = indent + after_cursor;
-                        cursor_col_ = indent.size();
+                        doc->appendEdits({TextEdit{cursor_row_, 0, cursor_row_, 0, indent}},
+                                         nullptr, &cursor_col_);
                     }
                 }
             }
@@ -396,20 +381,11 @@ void Editor::deleteChar() {
             bytes_to_delete = line.length() - cursor_col_;
         }
 
-        // 删除完整的UTF-8字符
-        std::string& mutable_line = doc->getLines()[cursor_row_];
-        std::string deleted_char = line.substr(cursor_col_, bytes_to_delete);
-        mutable_line.erase(cursor_col_, bytes_to_delete);
-
-        // 记录删除操作到撤销栈
-        doc->pushChange(DocumentChange(DocumentChange::Type::DELETE, cursor_row_, cursor_col_,
-                                       deleted_char, ""));
-        doc->setModified(true);
+        // 删除完整的UTF-8字符（deleteRange 同步后端并记录撤销）
+        doc->deleteRange(cursor_row_, cursor_col_, cursor_row_, cursor_col_ + bytes_to_delete);
     } else if (cursor_row_ < doc->lineCount() - 1) {
         // 光标在行尾，合并下一行
-        std::string next_line = doc->getLine(cursor_row_ + 1);
-        doc->getLines()[cursor_row_] += next_line;
-        doc->deleteLine(cursor_row_ + 1);
+        doc->deleteRange(cursor_row_, cursor_col_, cursor_row_ + 1, 0);
     }
 
     // 更新markdown预览（延迟更新以提升性能）
@@ -474,34 +450,8 @@ void Editor::backspace() {
             std::swap(start_col, end_col);
         }
 
-        // 获取要删除的内容（用于撤销）
-        std::string deleted_content = doc->getSelection(start_row, start_col, end_row, end_col);
-
         // 删除选中内容
-        if (start_row == end_row) {
-            // 同一行内的选择
-            std::string& line = doc->getLines()[start_row];
-            if (start_col < line.length()) {
-                size_t len = (end_col <= line.length()) ? (end_col - start_col)
-                                                        : (line.length() - start_col);
-                line.erase(start_col, len);
-            }
-        } else {
-            // 跨行选择
-            std::string& start_line = doc->getLines()[start_row];
-            std::string& end_line = doc->getLines()[end_row];
-
-            // 合并第一行和最后一行
-            start_line = start_line.substr(0, start_col) + end_line.substr(end_col);
-
-            // 删除中间的行和最后一行
-            doc->getLines().erase(doc->getLines().begin() + start_row + 1,
-                                  doc->getLines().begin() + end_row + 1);
-        }
-
-        // 记录删除操作到撤销栈
-        doc->pushChange(DocumentChange(DocumentChange::Type::DELETE, start_row, start_col,
-                                       deleted_content, ""));
+        doc->deleteRange(start_row, start_col, end_row, end_col);
 
         // 移动光标到选择开始位置
         cursor_row_ = start_row;
@@ -510,15 +460,6 @@ void Editor::backspace() {
         // 清除选择状态
         endSelection();
 
-        // 确保文档至少有一行
-        if (doc->lineCount() == 0) {
-            doc->getLines().push_back("");
-            cursor_row_ = 0;
-            cursor_col_ = 0;
-        }
-
-        doc->setModified(true);
-
 #ifdef BUILD_LSP_SUPPORT
         // 选择删除通常跨范围，按结构变化处理
         syncLspAfterEdit(true);
@@ -552,21 +493,12 @@ void Editor::backspace() {
         }
 
         // 删除完整的UTF-8字符
-        std::string& mutable_line = doc->getLines()[cursor_row_];
-        std::string deleted_char = line.substr(cursor_col_ - bytes_to_delete, bytes_to_delete);
-
-        mutable_line.erase(cursor_col_ - bytes_to_delete, bytes_to_delete);
+        doc->deleteRange(cursor_row_, cursor_col_ - bytes_to_delete, cursor_row_, cursor_col_);
         cursor_col_ -= bytes_to_delete;
-
-        // 记录删除操作到撤销栈
-        doc->pushChange(DocumentChange(DocumentChange::Type::DELETE, cursor_row_, cursor_col_,
-                                       deleted_char, ""));
-        doc->setModified(true);
     } else if (cursor_row_ > 0) {
         size_t prev_len = doc->getLine(cursor_row_ - 1).length();
         // 合并行
-        doc->getLines()[cursor_row_ - 1] += doc->getLine(cursor_row_);
-        doc->deleteLine(cursor_row_);
+        doc->deleteRange(cursor_row_ - 1, prev_len, cursor_row_, 0);
         cursor_row_--;
         cursor_col_ = prev_len;
     }
@@ -636,6 +568,8 @@ void Editor::deleteLine() {
 
 void Editor::deleteWord() {
     Document* doc = getCurrentDocument();
+    if (!doc)
+        return;
     const std::string& line = doc->getLine(cursor_row_);
     size_t start = cursor_col_;
     size_t end = start;
@@ -648,13 +582,7 @@ void Editor::deleteWord() {
         return;
     }
 
-    std::string deleted = line.substr(start, end - start);
-    std::string& mutable_line = doc->getLines()[cursor_row_];
-    mutable_line.erase(start, end - start);
-
-    doc->pushChange(DocumentChange(DocumentChange::Type::DELETE, cursor_row_, start, deleted, ""));
-
-    doc->setModified(true);
+    doc->deleteRange(cursor_row_, start, cursor_row_, end);
 
 #ifdef BUILD_LSP_SUPPORT
     syncLspAfterEdit(false);
@@ -672,14 +600,10 @@ void Editor::duplicateLine() {
     if (!doc)
         return;
 
-    std::string line = doc->getLine(cursor_row_);
-
-    doc->insertLine(cursor_row_ + 1);
-    doc->getLines()[cursor_row_ + 1] = line;
-
-    doc->pushChange(DocumentChange(DocumentChange::Type::INSERT, cursor_row_ + 1, 0, "", line));
+    const std::string& line = doc->getLine(cursor_row_);
+    size_t line_len = line.length();
+    doc->applyEdits({TextEdit{cursor_row_, line_len, cursor_row_, line_len, "\n" + line}});
 
-    doc->setModified(true);
     cursor_row_++;
     cursor_col_ = 0;
     setStatusMessage("Line duplicated");
@@ -811,18 +735,10 @@ void Editor::cut() {
             return;
         }
 
-        // 记录删除行的撤销操作
-        Document* doc = getCurrentDocument();
-        doc->pushChange(
-            DocumentChange(DocumentChange::Type::DELETE, cursor_row_, 0, content + "\n", ""));
-
+        // Document::deleteLine 自带撤销记录
         deleteLine();
     } else {
         // 剪切选中内容
-        content = getCurrentDocument()->getSelection(selection_start_row_, selection_start_col_,
-                                                     cursor_row_, cursor_col_);
-
-        // 删除选中内容
         size_t start_row = selection_start_row_;
         size_t start_col = selection_start_col_;
         size_t end_row = cursor_row_;
@@ -835,37 +751,13 @@ void Editor::cut() {
         }
 
         Document* doc = getCurrentDocument();
-
-        // 记录删除操作到撤销栈
-        doc->pushChange(
-            DocumentChange(DocumentChange::Type::DELETE, start_row, start_col, content, ""));
-
-        if (start_row == end_row) {
-            // 同一行内的选择
-            std::string& line = doc->getLines()[start_row];
-            if (start_col < line.length()) {
-                size_t len = (end_col <= line.length()) ? (end_col - start_col)
-                                                        : (line.length() - start_col);
-                line.erase(start_col, len);
-            }
-        } else {
-            // 跨行选择
-            std::string& start_line = doc->getLines()[start_row];
-            std::string& end_line = doc->getLines()[end_row];
-
-            // 合并第一行和最后一行
-            start_line = start_line.substr(0, start_col) + end_line.substr(end_col);
-
-            // 删除中间的行和最后一行
-            doc->getLines().erase(doc->getLines().begin() + start_row + 1,
-                                  doc->getLines().begin() + end_row + 1);
-        }
+        content = doc->getSelection(start_row, start_col, end_row, end_col);
+        doc->deleteRange(start_row, start_col, end_row, end_col);
 
         // 移动光标到选择开始位置
         cursor_row_ = start_row;
         cursor_col_ = start_col;
         endSelection();
-        doc->setModified(true);
     }
 
     // 复制到系统剪贴板
@@ -960,118 +852,60 @@ void Editor::paste() {
         return;
     }
 
-    // 如果有选中内容，先删除选中内容再粘贴
-    if (selection_active_) {
-        // 删除选中内容
-        size_t start_row = selection_start_row_;
-        size_t start_col = selection_start_col_;
-        size_t end_row = cursor_row_;
-        size_t end_col = cursor_col_;
-
-        // 确保开始位置在结束位置之前
-        if (start_row > end_row || (start_row == end_row && start_col > end_col)) {
-            std::swap(start_row, end_row);
-            std::swap(start_col, end_col);
-        }
-
-        Document* doc = getCurrentDocument();
-        if (start_row == end_row) {
-            // 同一行内的选择
-            std::string& line = doc->getLines()[start_row];
-            if (start_col < line.length()) {
-                size_t len = (end_col <= line.length()) ? (end_col - start_col)
-                                                        : (line.length() - start_col);
-                line.erase(start_col, len);
-            }
-        } else {
-            // 跨行选择
-            std::string& start_line = doc->getLines()[start_row];
-            std::string& end_line = doc->getLines()[end_row];
-
-            // 合并第一行和最后一行
-            start_line = start_line.substr(0, start_col) + end_line.substr(end_col);
+    insertBulkText(clipboard);
+    setStatusMessage("Pasted from clipboard");
 
-            // 删除中间的行和最后一行
-            doc->getLines().erase(doc->getLines().begin() + start_row + 1,
-                                  doc->getLines().begin() + end_row + 1);
-        }
+    // 计算粘贴的行数和字符数
+    size_t line_count = std::count(clipboard.begin(), clipboard.end(), '\n') + 1;
+    size_t char_count = clipboard.length();
 
-        // 移动光标到选择开始位置
-        cursor_row_ = start_row;
-        cursor_col_ = start_col;
-        endSelection();
+    // 显示 Toast 通知
+    if (line_count == 1) {
+        toast_.showSuccess("Pasted " + std::to_string(char_count) + " characters");
+    } else {
+        toast_.showSuccess("Pasted " + std::to_string(line_count) + " lines (" +
+                           std::to_string(char_count) + " characters)");
     }
+}
 
-    // 处理多行文本粘贴
+void Editor::insertBulkText(std::string text) {
     Document* doc = getCurrentDocument();
-    size_t paste_start_row = cursor_row_;
-    size_t paste_start_col = cursor_col_;
-
-    // 如果文本包含换行符，需要特殊处理
-    if (clipboard.find('\n') != std::string::npos) {
-        // 多行文本：需要分割并插入
-        std::istringstream stream(clipboard);
-        std::string line;
-        size_t current_row = cursor_row_;
-        size_t current_col = cursor_col_;
-        bool first_line = true;
-
-        while (std::getline(stream, line)) {
-            if (first_line) {
-                // 第一行：在当前行插入
-                std::string& current_line = doc->getLines()[current_row];
-                current_line.insert(current_col, line);
-                current_col += line.length();
-                first_line = false;
-            } else {
-                // 后续行：插入新行
-                doc->getLines().insert(doc->getLines().begin() + current_row + 1, line);
-                current_row++;
-                current_col = line.length();
-            }
-        }
+    if (!doc || text.empty()) {
+        return;
+    }
 
-        // 如果原始文本以换行符结尾，添加一个空行
-        if (!clipboard.empty() && clipboard.back() == '\n') {
-            doc->getLines().insert(doc->getLines().begin() + current_row + 1, "");
-            current_row++;
-            current_col = 0;
+    // 统一换行符，保证行缓存与缓冲区后端按同样的 '\n' 切行
+    if (text.find('\r') != std::string::npos) {
+        std::string normalized;
+        normalized.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] != '\r') {
+                normalized += text[i];
+            } else if (i + 1 >= text.size() || text[i + 1] != '\n') {
+                normalized += '\n';
+            }
         }
-
-        // 更新光标位置
-        cursor_row_ = current_row;
-        cursor_col_ = current_col;
-    } else {
-        // 单行文本：直接插入
-        doc->insertText(cursor_row_, cursor_col_, clipboard);
-        cursor_col_ += clipboard.length();
+        text.swap(normalized);
     }
 
-    doc->pushChange(DocumentChange(DocumentChange::Type::INSERT, paste_start_row, paste_start_col,
-                                   "", clipboard));
+    // 选中内容与插入文本合成一个编辑：一次拼接、一个撤销组，多行文本不再逐行插入
+    std::vector<TextEdit> edits(1);
+    edits[0].start_row = selection_active_ ? selection_start_row_ : cursor_row_;
+    edits[0].start_col = selection_active_ ? selection_start_col_ : cursor_col_;
+    edits[0].end_row = cursor_row_;
+    edits[0].end_col = cursor_col_;
+    edits[0].text = std::move(text);
+    endSelection();
+    doc->applyEdits(edits, &cursor_row_, &cursor_col_);
 
     adjustCursor();
     adjustViewOffset();
-    doc->setModified(true);
-    setStatusMessage("Pasted from clipboard");
 
 #ifdef BUILD_LSP_SUPPORT
-    // 粘贴是否结构变化取决于是否多行
-    bool structure_changed = (clipboard.find('\n') != std::string::npos);
+    // 是否结构变化取决于是否多行
+    bool structure_changed = (edits[0].text.find('\n') != std::string::npos);
     syncLspAfterEdit(structure_changed);
 #endif
-
-    // 计算粘贴的行数和字符数
-    size_t line_count = std::count(clipboard.begin(), clipboard.end(), '\n') + 1;
-    size_t char_count = clipboard.length();
-
-    // 显示 Toast 通知
-    if (line_count == 1) {
-        toast_.showSuccess("Pasted " + std::to_string(char_count) + " characters");
-    } else {
-        toast_.showSuccess("Pasted " + std::to_string(line_count) + " lines (" +
-                           std::to_string(char_count) + " characters)");
-    }
 }
 
 // 撤销/重做
@@ -1170,19 +1004,14 @@ void Editor::moveLineUp() {
         return;
 
     Document* doc = getCurrentDocument();
-    auto& lines = doc->getLines();
     size_t target = cursor_row_ - 1;
 
-    std::string moved_line = lines[cursor_row_];
-    std::string swapped_line = lines[target];
-
-    doc->pushChange(DocumentChange(DocumentChange::Type::MOVE_LINE, cursor_row_, target,
-                                   moved_line + "\n" + swapped_line,
-                                   swapped_line + "\n" + moved_line, DocumentChange::MOVE_TAG));
+    // 两行互换作为一个区间替换：行缓存与后端各一次拼接
+    const std::string& moved_line = doc->getLine(cursor_row_);
+    std::string swapped_text = moved_line + "\n" + doc->getLine(target);
+    doc->applyEdits({TextEdit{target, 0, cursor_row_, moved_line.length(), swapped_text}});
 
-    std::swap(lines[cursor_row_], lines[target]);
     cursor_row_ = target;
-    doc->setModified(true);
     setStatusMessage("Line moved up");
 
 #ifdef BUILD_LSP_SUPPORT
@@ -1192,22 +1021,16 @@ void Editor::moveLineUp() {
 
 void Editor::moveLineDown() {
     Document* doc = getCurrentDocument();
-    auto& lines = doc->getLines();
-    if (cursor_row_ >= lines.size() - 1)
+    if (cursor_row_ + 1 >= doc->lineCount())
         return;
 
     size_t target = cursor_row_ + 1;
 
-    std::string moved_line = lines[cursor_row_];
-    std::string swapped_line = lines[target];
-
-    doc->pushChange(DocumentChange(DocumentChange::Type::MOVE_LINE, cursor_row_, target,
-                                   moved_line + "\n" + swapped_line,
-                                   swapped_line + "\n" + moved_line, DocumentChange::MOVE_TAG));
+    const std::string& swapped_line = doc->getLine(target);
+    std::string swapped_text = swapped_line + "\n" + doc->getLine(cursor_row_);
+    doc->applyEdits({TextEdit{cursor_row_, 0, target, swapped_line.length(), swapped_text}});
 
-    std::swap(lines[cursor_row_], lines[target]);
     cursor_row_ = target;
-    doc->setModified(true);
     setStatusMessage("Line moved down");
 
 #ifdef BUILD_LSP_SUPPORT
@@ -1221,8 +1044,7 @@ void Editor::indentLine() {
         return;
     }
 
-    auto& lines = doc->getLines();
-    if (cursor_row_ >= lines.size()) {
+    if (cursor_row_ >= doc->lineCount()) {
         return;
     }
 
@@ -1254,7 +1076,7 @@ indent_done:
 
     tab_size = std::max(1, std::min(8, tab_size));
 
-    std::string& line = lines[cursor_row_];
+    const std::string& line = doc->getLine(cursor_row_);
 
     size_t first_non_space = line.find_first_not_of(" \t");
     bool at_line_start = (cursor_col_ == 0) ||
@@ -1275,11 +1097,6 @@ indent_done:
             inserted_text);
     }
 #endif
-
-    doc->pushChange(
-        DocumentChange(DocumentChange::Type::INSERT, cursor_row_, insert_col, "", inserted_text));
-
-    doc->setModified(true);
 }
 
 void Editor::unindentLine() {
@@ -1288,11 +1105,10 @@ void Editor::unindentLine() {
         return;
     }
 
-    auto& lines = doc->getLines();
-    if (cursor_row_ >= lines.size())
+    if (cursor_row_ >= doc->lineCount())
         return;
 
-    std::string& line = lines[cursor_row_];
+    const std::string& line = doc->getLine(cursor_row_);
     // 移除前导空格（最多4个）
     size_t spaces_to_remove = 0;
     while (spaces_to_remove < 4 && spaces_to_remove < line.length() &&
@@ -1301,10 +1117,8 @@ void Editor::unindentLine() {
     }
 
     if (spaces_to_remove > 0) {
-        // 使用deleteChar方法逐个删除，这样会自动记录到撤销系统
-        for (size_t i = 0; i < spaces_to_remove; ++i) {
-            doc->deleteChar(cursor_row_, 0);
-        }
+        // 一次删除全部前导空格，记录为一个撤销点
+        doc->deleteRange(cursor_row_, 0, cursor_row_, spaces_to_remove);
 
         if (cursor_col_ >= spaces_to_remove) {
             cursor_col_ -= spaces_to_remove;
@@ -1319,8 +1133,6 @@ void Editor::unindentLine() {
                                                    static_cast<int>(spaces_to_remove));
         }
 #endif
-
-        doc->setModified(true);
     }
 }
 
@@ -1,5 +1,6 @@
 // 文件操作相关实现
 #include "core/editor.h"
+#include "core/document_snapshot.h"
 #include "features/ssh/ssh_client.h"
 #include "ui/icons.h"
 #include "utils/logger.h"
@@ -74,7 +75,7 @@ bool Editor::openFile(const std::string& filepath) {
             lines.push_back(line);
         if (lines.empty())
             lines.push_back("");
-        doc->getLines() = lines;
+        doc->setContent(std::move(lines));
         doc->setModified(false);
         document_ssh_configs_[doc_index] = config;
         document_manager_.switchToDocument(doc_index);
@@ -233,6 +234,39 @@ bool Editor::openFileInternal(const std::string& filepath) {
 
         recent_files_manager_.addFile(filepath);
 
+        // 上次崩溃留下的交换文件：询问是否恢复未保存的修改；
+        // 正被另一个进程编辑时只提示，不恢复也不覆盖它的交换文件
+        SwapFile::Probe swap = doc->probeSwap();
+        if (swap.state == SwapFile::State::IN_USE) {
+            std::string owner;
+            if (swap.pid > 0) {
+                owner = " (pid " + std::to_string(swap.pid);
+                if (!swap.host.empty()) {
+                    owner += " on " + swap.host;
+                }
+                owner += ")";
+            }
+            setStatusMessage(std::string(pnana::ui::icons::WARNING) + " " + doc->getFileName() +
+                             " is being edited by another process" + owner);
+        } else if (swap.state == SwapFile::State::RECOVERABLE) {
+            dialog_.showConfirm(
+                "Recover Unsaved Changes",
+                "A swap file with unsaved changes to " + doc->getFileName() +
+                    " was left by a previous session. Recover it?",
+                [this, doc]() {
+                    if (doc->recoverFromSwap()) {
+                        setStatusMessage(std::string(pnana::ui::icons::SUCCESS) +
+                                         " Recovered unsaved changes: " + doc->getFileName());
+                    } else {
+                        setStatusMessage(std::string(pnana::ui::icons::ERROR) +
+                                         " Recovery failed: " + doc->getLastError());
+                    }
+                },
+                [doc]() {
+                    doc->discardSwap();
+                });
+        }
+
         if (split_view_manager_.hasSplits()) {
             size_t new_doc_index = document_manager_.getCurrentIndex();
             size_t active_region_index = split_view_manager_.getActiveRegionIndex();
@@ -313,6 +347,25 @@ bool Editor::saveFile() {
         }
     }
 
+    // 二进制文件：文档里没有内容，只把十六进制视图的补丁页写回原文件
+    if (doc->isBinary() && !features::ImagePreview::isImageFile(filepath)) {
+        std::string message;
+        binary_file_view_.setFilePath(filepath);
+        bool saved = binary_file_view_.save(message);
+        setStatusMessage(std::string(saved ? pnana::ui::icons::SAVED : pnana::ui::icons::ERROR) +
+                         " " + message);
+        return saved;
+    }
+
+#ifdef BUILD_LUA_SUPPORT
+    // 写入前的事件同步运行完（插件可在此格式化缓冲区）；回调可能切换或关闭文档，重新获取
+    triggerPluginEvent("BufWritePre", {filepath});
+    doc = getCurrentDocument();
+    if (!doc || doc->getFilePath() != filepath) {
+        return false;
+    }
+#endif
+
     // 普通文件保存
     size_t line_count = doc->lineCount();
     size_t byte_count = 0;
@@ -331,8 +384,14 @@ bool Editor::saveFile() {
         const std::uintmax_t history_threshold = 50ull * 1024 * 1024; // 50 MB
         if (byte_count <= history_threshold) {
             std::string saved_path = doc->getFilePath();
-            std::vector<std::string> saved_lines = doc->getLines();
-            std::thread([this, saved_path, saved_lines]() {
+            // 快照共享行块，在后台线程再展开成行，UI 线程不拷贝整份内容
+            std::shared_ptr<const DocumentSnapshot> saved = doc->snapshot();
+            std::thread([this, saved_path, saved]() {
+                std::vector<std::string> saved_lines;
+                saved_lines.reserve(saved->lineCount());
+                for (size_t i = 0; i < saved->lineCount(); ++i) {
+                    saved_lines.push_back(saved->line(i));
+                }
                 bool ok = file_history_manager_.recordVersion(saved_path, saved_lines);
                 LOG(std::string("[history] recordVersion (save) ") + (ok ? "ok" : "failed") +
                     " path=" + saved_path);
@@ -417,8 +476,14 @@ bool Editor::saveFileAs(const std::string& filepath) {
         const std::uintmax_t history_threshold = 50ull * 1024 * 1024; // 50 MB
         if (byte_count <= history_threshold) {
             std::string saved_path = filepath;
-            std::vector<std::string> saved_lines = doc->getLines();
-            std::thread([this, saved_path, saved_lines]() {
+            // 快照共享行块，在后台线程再展开成行，UI 线程不拷贝整份内容
+            std::shared_ptr<const DocumentSnapshot> saved = doc->snapshot();
+            std::thread([this, saved_path, saved]() {
+                std::vector<std::string> saved_lines;
+                saved_lines.reserve(saved->lineCount());
+                for (size_t i = 0; i < saved->lineCount(); ++i) {
+                    saved_lines.push_back(saved->line(i));
+                }
                 bool ok = file_history_manager_.recordVersion(saved_path, saved_lines);
                 LOG(std::string("[history] recordVersion (saveAs) ") + (ok ? "ok" : "failed") +
                     " path=" + saved_path);
@@ -666,6 +731,13 @@ void Editor::quit() {
         setStatusMessage("File modified. Save first (Ctrl+S) or force quit");
         return;
     }
+    if (doc && doc->isBinary() && !features::ImagePreview::isImageFile(doc->getFilePath())) {
+        binary_file_view_.setFilePath(doc->getFilePath());
+        if (binary_file_view_.hasUnsavedPatches()) {
+            setStatusMessage("Binary patches not written. Save first (Ctrl+S) or force quit");
+            return;
+        }
+    }
     should_quit_ = true;
     // 立即退出循环，不需要等待下一个事件
     screen_.ExitLoopClosure()();
@@ -681,7 +753,17 @@ void Editor::closeCurrentTab() {
         return;
     }
 
+    const Document* closing = getCurrentDocument();
+#ifdef BUILD_LSP_SUPPORT
+    std::string closing_uri =
+        closing && !closing->getFilePath().empty() ? filepathToUri(closing->getFilePath()) : "";
+#endif
     if (document_manager_.closeCurrentDocument()) {
+        // 只作为键使用，不再解引用
+        syntax_tree_service_.forget(closing);
+#ifdef BUILD_LSP_SUPPORT
+        completion_store_.invalidate(closing_uri);
+#endif
         setStatusMessage(std::string(pnana::ui::icons::CLOSE) + " Tab closed");
         cursor_row_ = 0;
         cursor_col_ = 0;
@@ -2,6 +2,7 @@
 #include "core/editor.h"
 #include "core/input/input_router.h"
 #include "input/event_parser.h"
+#include "input/event_recorder.h"
 #include "input/key_action.h"
 #include "ui/icons.h"
 #include "utils/logger.h"
@@ -23,6 +24,12 @@ namespace core {
 
 // 事件处理
 void Editor::handleInput(Event event) {
+    // --record-events：所有事件都从这里进入，录下即可离屏回放（粘贴展开的合成事件除外）
+    if (input::EventRecorder::getInstance().isRecording() &&
+        !(input_router_ && input_router_->isDispatchingPaste())) {
+        input::EventRecorder::getInstance().record(event);
+    }
+
 #ifdef BUILD_LUA_SUPPORT
     // 每次事件循环都推进一次 defer 队列，避免仅依赖 Custom 事件导致定时器不触发
     if (plugin_manager_initialized_ && plugin_manager_) {
@@ -37,6 +44,11 @@ void Editor::handleInput(Event event) {
         return;
     }
 
+    // 括号粘贴与同帧连续输入的合并
+    if (input_router_ && input_router_->coalesce(event, this)) {
+        return;
+    }
+
     // F5 + 已连接 SSH：仅当传输面板未打开时打开面板；若已打开则交给面板处理（用于“开始传输”）
     if (event == Event::F5 && !current_ssh_config_.host.empty() &&
         !ssh_transfer_dialog_.isVisible()) {
@@ -211,6 +223,11 @@ void Editor::handleInput(Event event) {
     bool should_skip_shortcuts =
         in_search_mode && (event != Event::Escape && event != Event::Return);
 
+    // 十六进制视图的导航、跳转、搜索与补丁按键先于全局快捷键（Ctrl+F、Ctrl+G 等）处理
+    if (!in_dialog && !should_skip_shortcuts && handleBinaryViewInput(event)) {
+        return;
+    }
+
     if (in_dialog) {
         // 对话框内的输入处理在下面
         // 但文件选择器仍然可以打开
@@ -473,8 +490,8 @@ void Editor::handleInput(Event event) {
 
     // 处理鼠标事件（用于拖动分屏线）
     if (event.is_mouse() && split_view_manager_.hasSplits()) {
-        int screen_width = screen_.dimx();
-        int screen_height = screen_.dimy();
+        int screen_width = getScreenWidth();
+        int screen_height = getScreenHeight();
 
         // 计算编辑器区域的偏移（考虑文件浏览器、标签栏等）
         int editor_x_offset = 0;
@@ -903,7 +920,7 @@ void Editor::handleNormalMode(Event event) {
                 Document* doc = getCurrentDocument();
                 if (doc) {
                     size_t total_lines = doc->lineCount();
-                    int screen_height = screen_.dimy() - 7; // 减去6行UI元素 + 2行边框
+                    int screen_height = getScreenHeight() - 7; // 减去6行UI元素 + 2行边框
                     size_t last_visible_row = view_offset_row_ + screen_height - 1;
 
                     if (cursor_row_ >= total_lines - 1 || cursor_row_ >= last_visible_row) {
@@ -940,7 +957,7 @@ void Editor::handleNormalMode(Event event) {
                 Document* doc = getCurrentDocument();
                 if (doc && terminal_.isVisible()) {
                     size_t total_lines = doc->lineCount();
-                    int screen_height = screen_.dimy() - 7; // 减去6行UI元素 + 2行边框
+                    int screen_height = getScreenHeight() - 7; // 减去6行UI元素 + 2行边框
                     size_t last_visible_row = view_offset_row_ + screen_height - 1;
                     if (cursor_row_ >= total_lines - 1 && cursor_row_ >= last_visible_row) {
                         if (region_manager_.navigateDown()) {
@@ -1308,6 +1325,10 @@ void Editor::handleNormalMode(Event event) {
             }
         }
         last_char_input_time_ = now;
+        // 粘贴中的换行并入同一次批量插入
+        if (input_router_ && input_router_->deferTextInsert("\n", true)) {
+            return;
+        }
         insertNewline();
     }
     // 可打印字符 - 直接插入（支持UTF-8多字节字符，如中文）
@@ -1317,6 +1338,9 @@ void Editor::handleNormalMode(Event event) {
         if (!ch.empty()) {
             // 处理 \r 作为换行符（Windows Terminal 粘贴时使用 \r\n，需要统一处理）
             if (ch == "\r") {
+                if (input_router_ && input_router_->deferTextInsert("\n", true)) {
+                    return;
+                }
                 insertNewline();
                 return;
             }
@@ -1357,6 +1381,10 @@ void Editor::handleNormalMode(Event event) {
                     }
                 }
                 last_char_input_time_ = now;
+                // 同一帧内的后续字符（终端粘贴、快速输入）攒到帧末一次插入
+                if (input_router_ && input_router_->deferTextInsert(ch, false)) {
+                    return;
+                }
                 // 使用 insertText 支持多字节字符
                 insertText(ch);
             }
@@ -1592,6 +1620,25 @@ void Editor::handleReplaceMode(Event event) {
     force_ui_update_ = true;
 }
 
+bool Editor::handleBinaryViewInput(Event event) {
+    if (mode_ != EditorMode::NORMAL ||
+        region_manager_.getCurrentRegion() != EditorRegion::CODE_AREA) {
+        return false;
+    }
+    if (isDialogVisible() || file_picker_.isVisible() || show_extract_dialog_ ||
+        show_extract_path_dialog_ || encoding_dialog_.isVisible() || format_dialog_.isOpen() ||
+        ai_config_dialog_.isVisible() || clipboard_panel_.isVisible() ||
+        ssh_transfer_dialog_.isVisible()) {
+        return false;
+    }
+    Document* doc = getCurrentDocument();
+    if (!doc || !doc->isBinary() || features::ImagePreview::isImageFile(doc->getFilePath())) {
+        return false;
+    }
+    binary_file_view_.setFilePath(doc->getFilePath());
+    return binary_file_view_.handleInput(event);
+}
+
 void Editor::handleFileBrowserInput(Event event) {
     // 确保当前区域是文件浏览器
     if (region_manager_.getCurrentRegion() != EditorRegion::FILE_BROWSER) {
@@ -2076,7 +2123,8 @@ void Editor::performSearch(const std::string& pattern, const features::SearchOpt
         return;
     }
 
-    const auto& lines = doc->getLines();
+    const Document& const_doc = *doc;
+    const auto& lines = const_doc.getLines();
     search_engine_.search(pattern, lines, options);
 
     if (search_engine_.hasMatches()) {
@@ -2142,7 +2190,8 @@ void Editor::performReplace(const std::string& replacement) {
 
     // 重新搜索以更新匹配
     const auto& pattern = search_engine_.getPattern();
-    const auto& lines = doc->getLines();
+    const Document& const_doc = *doc;
+    const auto& lines = const_doc.getLines();
     search_engine_.search(pattern, lines, current_search_options_);
 
     // 更新搜索结果显示
@@ -2358,7 +2407,8 @@ void Editor::executeSearch(bool move_cursor) {
     }
 
     features::SearchOptions options;
-    search_engine_.search(input_buffer_, getCurrentDocument()->getLines(), options);
+    const Document& const_doc = *getCurrentDocument();
+    search_engine_.search(input_buffer_, const_doc.getLines(), options);
 
     if (search_engine_.hasMatches()) {
         const auto* match = search_engine_.getCurrentMatch();
@@ -673,10 +673,15 @@ void Editor::updateCurrentFileFolding() {
         if (folding_manager_) {
             folding_manager_->clear();
         }
+        // 退回语法树折叠：范围在后台解析完成后由 applySyntaxTreeFolding 写入
+        tree_folding_active_ = true;
+        tree_folding_document_id_ = 0;
+        applySyntaxTreeFolding(doc);
         needs_render_ = true;
         last_render_source_ = "folding_clear_no_lsp";
         return;
     }
+    tree_folding_active_ = false;
 
     // 首先尝试从缓存恢复折叠状态（更积极的策略）
     bool cache_restored = false;
@@ -832,11 +837,6 @@ void Editor::updateLspDocument(bool force_sync_for_completion) {
             document_change_tracker_ = std::make_unique<features::DocumentChangeTracker>();
         }
 
-        // 初始化补全缓存
-        if (!completion_cache_) {
-            completion_cache_ = std::make_unique<features::LspCompletionCache>();
-        }
-
         if (!is_connected) {
             // LOG_DEBUG("[LSP_FMT_DBG] updateLspDocument client not connected, trigger async
             // init");
@@ -863,19 +863,11 @@ void Editor::updateLspDocument(bool force_sync_for_completion) {
             return;
         }
 
-        // 获取文档内容
-        std::string content;
-        size_t line_count = doc->lineCount();
-
-        // 限制读取的行数，避免大文件卡住（最多读取前1000行）
-        size_t max_lines = std::min(line_count, static_cast<size_t>(1000));
+        // 限制发送的行数，避免大文件卡住（最多发送前1000行）
+        const size_t max_lines = 1000;
 
-        for (size_t i = 0; i < max_lines; ++i) {
-            content += doc->getLine(i);
-            if (i < max_lines - 1) {
-                content += "\n";
-            }
-        }
+        // 文档快照：未修改的行块与上次共享，文本拼接在 LSP worker 中进行
+        auto snapshot = doc->snapshotHead(max_lines);
 
         // 检查是否已经打开过
         if (file_language_map_.find(uri) == file_language_map_.end()) {
@@ -885,7 +877,8 @@ void Editor::updateLspDocument(bool force_sync_for_completion) {
                 lsp_async_manager_ = std::make_unique<features::LspAsyncManager>();
             }
             try {
-                lsp_async_manager_->requestDocumentOpenAsync(client, uri, language_id, content);
+                lsp_async_manager_->requestDocumentOpenAsync(client, uri, language_id, snapshot,
+                                                             max_lines);
             } catch (...) {
             }
 
@@ -1013,7 +1006,8 @@ void Editor::updateLspDocument(bool force_sync_for_completion) {
                 if (!lsp_async_manager_) {
                     lsp_async_manager_ = std::make_unique<features::LspAsyncManager>();
                 }
-                lsp_async_manager_->requestDocumentChangeAsync(client, uri, content, version);
+                lsp_async_manager_->requestDocumentChangeAsync(client, uri, snapshot, max_lines,
+                                                               version);
             } catch (...) {
             }
             // Schedule folding ranges refresh for this document (debounced by request manager).
@@ -1061,19 +1055,6 @@ void Editor::triggerCompletion() {
         return;
     }
 
-    // 补全项评分结构体
-    struct ScoredItem {
-        features::CompletionItem item;
-        int score;
-
-        bool operator<(const ScoredItem& other) const {
-            if (score != other.score) {
-                return score > other.score; // 分数高的在前
-            }
-            return item.label < other.item.label; // 相同分数按字母顺序
-        }
-    };
-
     if (!lsp_enabled_ || !lsp_manager_) {
         return;
     }
@@ -1085,21 +1066,6 @@ void Editor::triggerCompletion() {
 
     std::string filepath = doc->getFilePath();
 
-    // 防抖：避免快速连续输入时频繁调用 updateLspDocument + LSP 请求导致主线程卡顿
-    // 50ms 过短，LSP didChange/补全请求易堆积并阻塞；改为 200ms 减少调用频率
-    auto now = std::chrono::steady_clock::now();
-    {
-        std::lock_guard<std::mutex> lock(completion_debounce_mutex_);
-        auto time_since_last_trigger = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - last_completion_trigger_time_);
-
-        if (time_since_last_trigger < std::chrono::milliseconds(200)) {
-            return;
-        }
-
-        last_completion_trigger_time_ = now;
-    }
-
     if (filepath.empty()) {
         // 如果文件未保存，使用临时路径
         filepath = "/tmp/pnana_unsaved_" + std::to_string(reinterpret_cast<uintptr_t>(doc));
@@ -1127,8 +1093,8 @@ void Editor::triggerCompletion() {
         }
     }
 
-    int screen_width = screen_.dimx();
-    int screen_height = screen_.dimy();
+    int screen_width = getScreenWidth();
+    int screen_height = getScreenHeight();
     int editor_left_offset = 0;
     if (file_browser_.isVisible()) {
         editor_left_offset += file_browser_width_ + 1;
@@ -1142,6 +1108,66 @@ void Editor::triggerCompletion() {
         cursor_screen_col = std::max(0, screen_width - 10);
     }
 
+    // 光标前的标识符片段：会话的查询串，其起始列和行、uri 一起标识一个会话
+    size_t word_end = std::min(static_cast<size_t>(cursor_col_), line.length());
+    size_t word_start = word_end;
+    while (word_start > 0 && (std::isalnum(static_cast<unsigned char>(line[word_start - 1])) ||
+                              line[word_start - 1] == '_')) {
+        word_start--;
+    }
+    std::string word = line.substr(word_start, word_end - word_start);
+    std::string uri = filepathToUri(filepath);
+    features::CompletionStore::SessionKey session_key{uri, static_cast<int>(cursor_row_),
+                                                      static_cast<int>(word_start),
+                                                      line.substr(0, word_start)};
+
+    // 键只描述当前行：自上次补全以来有跨行或其他行上的编辑（粘贴、删行、撤销等）时，
+    // 服务器的候选可能已经不同，丢弃该文件的全部会话
+    if (completion_store_.size() > 0) {
+        std::vector<core::ContentEdit> edits;
+        bool typing = completion_doc_uri_ == uri &&
+                      doc->getEditsSince(completion_doc_version_, edits);
+        for (const auto& entry : edits) {
+            const core::TextEdit& edit = entry.edit;
+            if (edit.start_row != cursor_row_ || edit.end_row != cursor_row_ ||
+                edit.text.find('\n') != std::string::npos) {
+                typing = false;
+                break;
+            }
+        }
+        if (!typing) {
+            completion_store_.invalidate(uri);
+        }
+    }
+    completion_doc_uri_ = uri;
+    completion_doc_version_ = doc->getVersion();
+
+    // 同一标识符上继续输入：直接在上一次响应里缩小并重排，不经过防抖也不请求服务器
+    if (auto session = completion_store_.find(session_key, word)) {
+        std::vector<features::CompletionItem> ranked =
+            session->query(word, MAX_COMPLETION_POPUP_ITEMS);
+        if (!ranked.empty()) {
+            showCompletionPopupIfChanged(ranked, static_cast<int>(cursor_row_), cursor_screen_col,
+                                         screen_width, screen_height, prefix);
+            return;
+        }
+    }
+
+    // 防抖：避免快速连续输入时频繁调用 updateLspDocument + LSP 请求导致主线程卡顿
+    // 50ms 过短，LSP didChange/补全请求易堆积并阻塞；改为 200ms 减少调用频率
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(completion_debounce_mutex_);
+        auto time_since_last_trigger = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - last_completion_trigger_time_);
+
+        if (time_since_last_trigger < std::chrono::milliseconds(200)) {
+            return;
+        }
+
+        last_completion_trigger_time_ = now;
+    }
+
     features::LspClient* client = lsp_manager_ ? lsp_manager_->getClientForFile(filepath) : nullptr;
     if (!client || !client->isConnected()) {
         if (client) {
@@ -1220,67 +1246,8 @@ void Editor::triggerCompletion() {
 
     // 补全前强制同步文档，确保 rust-analyzer 等收到最新内容
     updateLspDocument(/* force_sync_for_completion */ true);
-    std::string uri = filepathToUri(filepath);
     features::LspPosition pos(static_cast<int>(cursor_row_), static_cast<int>(cursor_col_));
-
-    // 初始化补全缓存
-    if (!completion_cache_) {
-        completion_cache_ = std::make_unique<features::LspCompletionCache>();
-    }
-
-    // 精确的缓存策略 - 基于位置、前缀和触发字符，避免错误复用
-    features::LspCompletionCache::CacheKey cache_key;
-    cache_key.uri = uri;
-
-    // 获取当前行内容和前缀
-    std::string line_content = doc->getLine(cursor_row_);
-    std::string current_prefix = line_content.substr(0, cursor_col_);
-
-    // 找到最近的单词边界作为上下文前缀
-    size_t last_space = current_prefix.find_last_of(" \t.()[]{};:,");
-    if (last_space != std::string::npos && last_space < current_prefix.size() - 1) {
-        cache_key.context_prefix = current_prefix.substr(last_space + 1);
-    } else {
-        cache_key.context_prefix = current_prefix;
-    }
-
-    // 获取语言ID和语义上下文
     std::string language_id = detectLanguageId(filepath);
-    std::string semantic_ctx = getSemanticContext(line_content, cursor_col_);
-    cache_key.semantic_context = language_id + ":" + semantic_ctx;
-
-    // 使用精确的位置和前缀信息作为缓存 key
-    cache_key.line = static_cast<int>(cursor_row_);
-    cache_key.character = static_cast<int>(cursor_col_);
-    cache_key.prefix = prefix;
-    cache_key.trigger_character = last_completion_trigger_;
-
-    auto cached = completion_cache_->get(cache_key);
-
-    if (cached.has_value() && !cached->empty()) {
-        std::vector<features::CompletionItem> limited_items = *cached;
-        if (limited_items.size() > 50) {
-            limited_items.resize(50);
-        }
-        showCompletionPopupIfChanged(limited_items, static_cast<int>(cursor_row_),
-                                     cursor_screen_col, screen_width, screen_height, prefix);
-        return;
-    }
-
-    // 缓存未命中时，尝试用 filterByPrefix 从同文件缓存中过滤（前缀变化时复用）
-    // 前缀为 1-2 字符时跳过 filterByPrefix，直接请求 LSP，否则短名称（如 a、x、pi）可能被漏掉
-    std::vector<features::CompletionItem> filtered;
-    if (prefix.length() >= 3) {
-        filtered = completion_cache_->filterByPrefix(cache_key, prefix, line_content, cursor_col_);
-    }
-    if (!filtered.empty()) {
-        if (filtered.size() > 50) {
-            filtered.resize(50);
-        }
-        showCompletionPopupIfChanged(filtered, static_cast<int>(cursor_row_), cursor_screen_col,
-                                     screen_width, screen_height, prefix);
-        return;
-    }
 
     if (!lsp_async_manager_) {
         lsp_async_manager_ = std::make_unique<features::LspAsyncManager>();
@@ -1291,24 +1258,30 @@ void Editor::triggerCompletion() {
 
     int req_row = static_cast<int>(cursor_row_);
     int req_col = cursor_screen_col;
-    int req_screen_w = screen_.dimx();
-    int req_screen_h = screen_.dimy();
+    int req_screen_w = getScreenWidth();
+    int req_screen_h = getScreenHeight();
 
     // 非 C/C++ LSP 响应较慢，放宽超时以减少误超时
     int completion_timeout_ms = (language_id == "cpp" || language_id == "c") ? 500 : 800;
 
     lsp_async_manager_->requestCompletionAsync(
         client, uri, pos,
-        [this, cache_key, req_row, req_col, req_screen_w, req_screen_h, prefix, filepath,
-         line_content](const std::vector<features::CompletionItem>& items) {
-            screen_.Post([this, items, cache_key, req_row, req_col, req_screen_w, req_screen_h,
-                          prefix, filepath, line_content]() {
-                if (completion_cache_ && !items.empty()) {
-                    completion_cache_->set(cache_key, items);
-                }
-
+        [this, session_key, word, req_row, req_col, req_screen_w, req_screen_h, prefix,
+         filepath](const std::vector<features::CompletionItem>& items, bool is_incomplete) {
+            screen_.Post([this, items, is_incomplete, session_key, word, req_row, req_col,
+                          req_screen_w, req_screen_h, prefix, filepath]() {
                 if (!items.empty()) {
-                    std::vector<features::CompletionItem> all_items = items;
+                    // 服务器顺序（sortText）作为同分时的次序，按模糊匹配分数取前若干项。
+                    // 不完整的结果只用于这一次显示，继续输入时重新请求
+                    std::shared_ptr<features::CompletionSession> session;
+                    if (is_incomplete) {
+                        completion_store_.invalidate(session_key.uri);
+                        session = std::make_shared<features::CompletionSession>(items, word);
+                    } else {
+                        session = completion_store_.put(session_key, items, word);
+                    }
+                    std::vector<features::CompletionItem> limited =
+                        session->query(word, MAX_COMPLETION_POPUP_ITEMS);
 
                     // 添加代码片段到补全列表
                     if (snippet_manager_) {
@@ -1316,6 +1289,9 @@ void Editor::triggerCompletion() {
                         auto snippets = snippet_manager_->findMatchingSnippets(prefix, language_id);
 
                         for (const auto& snippet : snippets) {
+                            if (limited.size() >= MAX_COMPLETION_POPUP_ITEMS) {
+                                break;
+                            }
                             features::CompletionItem snippet_item;
                             snippet_item.label = snippet.prefix;
                             snippet_item.kind = "snippet";
@@ -1325,122 +1301,10 @@ void Editor::triggerCompletion() {
                             snippet_item.snippet_body = snippet.body;
                             snippet_item.snippet_placeholders = snippet.placeholders;
 
-                            all_items.push_back(snippet_item);
+                            limited.push_back(snippet_item);
                         }
                     }
 
-                    std::vector<features::CompletionItem> sorted_items = all_items;
-
-                    // 排序：参考 VS Code 四类（标准库/当前文档/项目/智能补全）
-                    // 1. 有 sortText 时优先按 sortText（服务器通常按 当前文档>项目>标准库）
-                    // 2. 前缀匹配 + 类型优先级 + 使用频率 + 上下文相关性
-                    std::string lower_line_for_sort = line_content;
-                    std::transform(lower_line_for_sort.begin(), lower_line_for_sort.end(),
-                                   lower_line_for_sort.begin(), ::tolower);
-                    int sort_cursor_col = cursor_col_;
-
-                    std::sort(
-                        sorted_items.begin(), sorted_items.end(),
-                        [this, prefix, lower_line_for_sort, sort_cursor_col](
-                            const features::CompletionItem& a, const features::CompletionItem& b) {
-                            auto matchesCamelCase = [](const std::string& pattern,
-                                                       const std::string& label) -> bool {
-                                if (pattern.empty() || label.empty())
-                                    return false;
-                                size_t pi = 0, li = 0;
-                                while (pi < pattern.length() && li < label.length()) {
-                                    if (pattern[pi] == label[li]) {
-                                        pi++;
-                                        li++;
-                                    } else if (std::isupper(
-                                                   static_cast<unsigned char>(label[li]))) {
-                                        li++;
-                                    } else {
-                                        return false;
-                                    }
-                                }
-                                return pi == pattern.length();
-                            };
-
-                            auto getTypePriority = [](const std::string& kind) -> int {
-                                if (kind == "2" || kind == "3" || kind == "method" ||
-                                    kind == "function")
-                                    return 10;
-                                if (kind == "7" || kind == "8" || kind == "class" ||
-                                    kind == "interface")
-                                    return 8;
-                                if (kind == "5" || kind == "6" || kind == "variable" ||
-                                    kind == "property")
-                                    return 6;
-                                if (kind == "21")
-                                    return 5;
-                                if (kind == "14")
-                                    return 4;
-                                return 3;
-                            };
-
-                            auto computeScore = [this, &prefix, &matchesCamelCase, &getTypePriority,
-                                                 &lower_line_for_sort, sort_cursor_col](
-                                                    const features::CompletionItem& item) -> int {
-                                const std::string& text =
-                                    !item.filterText.empty() ? item.filterText : item.label;
-                                int score = 0;
-                                if (!prefix.empty()) {
-                                    if (text == prefix) {
-                                        score += 200;
-                                    } else if (text.find(prefix) == 0) {
-                                        score += 100;
-                                    } else if (matchesCamelCase(prefix, text)) {
-                                        score += 85;
-                                    } else if (text.find(prefix) != std::string::npos) {
-                                        score += 50;
-                                    }
-                                }
-                                score += getTypePriority(item.kind) * 10;
-                                int freq = getSymbolFrequency(item.label);
-                                score += std::min(freq * 10, 100);
-                                if (!lower_line_for_sort.empty()) {
-                                    std::string lower_symbol = item.label;
-                                    std::transform(lower_symbol.begin(), lower_symbol.end(),
-                                                   lower_symbol.begin(), ::tolower);
-                                    size_t pos = 0;
-                                    int occurrences = 0;
-                                    while ((pos = lower_line_for_sort.find(lower_symbol, pos)) !=
-                                           std::string::npos) {
-                                        occurrences++;
-                                        pos += lower_symbol.length();
-                                    }
-                                    score += occurrences * 15;
-                                    if (sort_cursor_col > 0) {
-                                        size_t before_cursor = std::min(
-                                            sort_cursor_col,
-                                            static_cast<int>(lower_line_for_sort.length()));
-                                        std::string before =
-                                            lower_line_for_sort.substr(0, before_cursor);
-                                        if (before.find(lower_symbol) != std::string::npos) {
-                                            score += 30;
-                                        }
-                                    }
-                                }
-                                return score;
-                            };
-                            if (!a.sortText.empty() && !b.sortText.empty()) {
-                                if (a.sortText != b.sortText)
-                                    return a.sortText < b.sortText;
-                            } else if (!a.sortText.empty())
-                                return true;
-                            else if (!b.sortText.empty())
-                                return false;
-                            int sa = computeScore(a), sb = computeScore(b);
-                            if (sa != sb)
-                                return sa > sb;
-                            return a.label < b.label;
-                        });
-                    std::vector<features::CompletionItem> limited = sorted_items;
-                    if (limited.size() > 50) {
-                        limited.resize(50);
-                    }
-
                     showCompletionPopupIfChanged(limited, req_row, req_col, req_screen_w,
                                                  req_screen_h, prefix);
                 } else {
@@ -1779,7 +1643,7 @@ ftxui::Element Editor::renderCompletionPopup() {
         }
     }
 
-    completion_popup_.updateCursorPosition(anchor_y, anchor_x, screen_.dimx(), screen_.dimy());
+    completion_popup_.updateCursorPosition(anchor_y, anchor_x, getScreenWidth(), getScreenHeight());
 
     return completion_popup_.render(theme_, origin_x, origin_y);
 }
@@ -1921,17 +1785,8 @@ void Editor::showSymbolNavigation() {
     bool needs_did_open = (file_language_map_.find(uri) == file_language_map_.end());
     if (needs_did_open) {
         try {
-            // 获取文档内容
-            std::string content;
-            size_t line_count = doc->lineCount();
-            size_t max_lines = std::min(line_count, static_cast<size_t>(1000));
-            for (size_t i = 0; i < max_lines; ++i) {
-                content += doc->getLine(i);
-                if (i < max_lines - 1) {
-                    content += "\n";
-                }
-            }
-            lsp_client->didOpen(uri, language_id, content);
+            // 获取文档内容（最多前1000行）
+            lsp_client->didOpen(uri, language_id, doc->snapshotHead(1000)->joinLines(0, 1000));
             file_language_map_[uri] = language_id;
         } catch (const std::exception& e) {
             setStatusMessage("Failed to prepare document for symbol navigation.");
@@ -2155,10 +2010,93 @@ Element Editor::renderSymbolNavigationPopup() {
 #endif
 
 // 代码折叠方法实现（Neovim-like 行为）
+void Editor::applySyntaxTreeFolding(Document* doc) {
+    if (!doc || !tree_folding_active_ || doc != getCurrentDocument()) {
+        return;
+    }
+    if (!syntax_tree_service_.tree(*doc)) {
+        return; // 树尚未就绪或与文档版本未同步，保留现有范围
+    }
+    // 只在换入新的解析结果（或切换文档）时重算
+    const uint64_t generation = syntax_tree_service_.generation(*doc);
+    if (doc->getInstanceId() == tree_folding_document_id_ &&
+        generation == tree_folding_generation_) {
+        return;
+    }
+    tree_folding_document_id_ = doc->getInstanceId();
+    tree_folding_generation_ = generation;
+
+    std::vector<features::FoldingRange> ranges = syntax_tree_service_.foldingRanges(*doc);
+    // 起始行已不再可折叠的折叠状态一并取消
+    std::vector<int> stale;
+    for (const auto& range : doc->getFoldingRanges()) {
+        if (doc->isFolded(range.startLine)) {
+            stale.push_back(range.startLine);
+        }
+    }
+    doc->setFoldingRanges(ranges);
+    for (int line : stale) {
+        if (!doc->isFoldStart(line)) {
+            doc->setFolded(line, false);
+        }
+    }
+    needs_render_ = true;
+    last_render_source_ = "folding_syntax_tree";
+}
+
+void Editor::toggleDocumentFold(Document* doc) {
+    const auto& ranges = doc->getFoldingRanges();
+    const int cursor_line = static_cast<int>(cursor_row_);
+
+    // 与 LSP 折叠一致：优先光标所在的最内层范围，其次光标上方最近的可折叠行
+    int start = -1;
+    int min_range_size = INT_MAX;
+    for (const auto& range : ranges) {
+        if (range.containsLine(cursor_line) && range.endLine - range.startLine < min_range_size) {
+            min_range_size = range.endLine - range.startLine;
+            start = range.startLine;
+        }
+    }
+    if (start < 0) {
+        int best_dist = INT_MAX;
+        for (const auto& range : ranges) {
+            if (range.startLine <= cursor_line && cursor_line - range.startLine < best_dist) {
+                best_dist = cursor_line - range.startLine;
+                start = range.startLine;
+            }
+        }
+    }
+    if (start < 0) {
+        setStatusMessage("No foldable region at cursor");
+        return;
+    }
+
+    bool was_modified = doc->isModified();
+    doc->toggleFold(start);
+    bool now_folded = doc->isFolded(start);
+    if (now_folded) {
+        cursor_row_ = static_cast<size_t>(start);
+    }
+    adjustCursor();
+    adjustViewOffset();
+
+    setStatusMessage(now_folded ? "Folded" : "Unfolded");
+    doc->setModified(was_modified);
+    force_ui_update_ = true;
+    last_render_time_ = std::chrono::steady_clock::now() - std::chrono::milliseconds(200);
+}
+
 void Editor::toggleFold() {
     // (Debounce removed) Allow each toggle request to be handled. Key-repeat should
     // be handled at input layer; excessive suppression here caused fold to not trigger.
 
+    if (tree_folding_active_) {
+        if (Document* doc = getCurrentDocument()) {
+            toggleDocumentFold(doc);
+        }
+        return;
+    }
+
     if (!folding_manager_) {
         setStatusMessage("Folding manager not initialized");
         return;
@@ -2282,6 +2220,12 @@ void Editor::toggleFold() {
 }
 
 void Editor::toggleFoldAtCursor() {
+    if (tree_folding_active_) {
+        if (Document* doc = getCurrentDocument()) {
+            toggleDocumentFold(doc);
+        }
+        return;
+    }
     if (!folding_manager_)
         return;
 
@@ -2294,7 +2238,7 @@ void Editor::toggleFoldAtCursor() {
 }
 
 void Editor::foldAll() {
-    if (!folding_manager_)
+    if (!folding_manager_ && !tree_folding_active_)
         return;
 
     auto doc = getCurrentDocument();
@@ -2304,7 +2248,11 @@ void Editor::foldAll() {
     // 保存当前的修改状态
     bool was_modified = doc->isModified();
 
-    folding_manager_->foldAll();
+    if (tree_folding_active_) {
+        doc->foldAll();
+    } else {
+        folding_manager_->foldAll();
+    }
     setStatusMessage("Folded all regions");
 
     // 恢复修改状态（折叠不应该改变文件的修改状态）
@@ -2316,7 +2264,7 @@ void Editor::foldAll() {
 }
 
 void Editor::unfoldAll() {
-    if (!folding_manager_)
+    if (!folding_manager_ && !tree_folding_active_)
         return;
 
     auto doc = getCurrentDocument();
@@ -2326,7 +2274,11 @@ void Editor::unfoldAll() {
     // 保存当前的修改状态
     bool was_modified = doc->isModified();
 
-    folding_manager_->unfoldAll();
+    if (tree_folding_active_) {
+        doc->unfoldAll();
+    } else {
+        folding_manager_->unfoldAll();
+    }
     setStatusMessage("Unfolded all regions");
 
     // 恢复修改状态（折叠不应该改变文件的修改状态）
@@ -333,7 +333,7 @@ void Editor::handleSSHConnect(const pnana::ui::SSHConfig& config) {
             lines.push_back(line);
         if (lines.empty())
             lines.push_back("");
-        doc->getLines() = lines;
+        doc->setContent(std::move(lines));
         doc->setModified(true);
         document_manager_.switchToDocument(document_manager_.getDocumentCount() - 1);
         cursor_row_ = 0;
@@ -21,6 +21,8 @@
 #include "utils/bracket_matcher.h"
 #include "utils/file_type_detector.h"
 #include "utils/logger.h"
+#include "utils/perf_monitor.h"
+#include "utils/process_executor.h"
 #include "utils/text_utils.h"
 
 using namespace pnana::ui::icons;
@@ -47,23 +49,29 @@ static void updateGitInfoAsync() {
     // 标记开始更新
     git_update_in_progress.store(true);
 
-    // 在后台线程中执行git命令
-    std::thread([]() {
-        try {
-            auto [branch, count] = pnana::ui::Statusbar::getGitInfo();
+    // 交给子进程执行服务，回调在其 IO 线程上更新缓存；一次 git status --branch 同时得到分支与改动数
+    pnana::utils::ProcessRequest request;
+    request.argv = {"git", "status", "--porcelain", "--branch"};
+    request.timeout_ms = pnana::ui::Statusbar::GIT_STATUS_TIMEOUT_MS;
+    pnana::utils::ProcessExecutor::getInstance().submit(
+        std::move(request), [](const pnana::utils::ProcessResult& result) {
+            std::string branch;
+            int count = 0;
+            if (result.ok()) {
+                std::tie(branch, count) = pnana::ui::Statusbar::parseGitStatus(result.output);
+            }
 
             // 使用互斥锁保护共享数据
-            std::lock_guard<std::mutex> lock(git_cache_mutex);
-            cached_git_branch = branch;
-            cached_git_uncommitted_count = count;
-            last_git_check = std::chrono::steady_clock::now();
-        } catch (...) {
-            // 静默处理错误
-        }
+            {
+                std::lock_guard<std::mutex> lock(git_cache_mutex);
+                cached_git_branch = branch;
+                cached_git_uncommitted_count = count;
+                last_git_check = std::chrono::steady_clock::now();
+            }
 
-        // 标记更新完成
-        git_update_in_progress.store(false);
-    }).detach(); // 分离线程，让它在后台运行
+            // 标记更新完成
+            git_update_in_progress.store(false);
+        });
 }
 
 static void updateGitInfo() {
@@ -111,6 +119,9 @@ namespace core {
 // 与 editor_input 中一致：超过此行数视为大文件，搜索高亮用按行即时计算
 constexpr size_t LARGE_FILE_SEARCH_HIGHLIGHT_THRESHOLD = 50000;
 
+// 超过此长度的行不取语法树高亮（与 highlightLineNative 的截断长度一致）
+constexpr size_t MAX_TREE_HIGHLIGHT_LINE_LENGTH = 10000;
+
 // 在单行内找出所有匹配（用于大文件搜索时的按行高亮），与 SearchEngine 的选项一致
 static void findMatchesInLine(const std::string& line, size_t line_num, const std::string& pattern,
                               const features::SearchOptions& options,
@@ -181,7 +192,7 @@ int Editor::getContentOriginY() const {
 }
 
 int Editor::getContentBottomY() const {
-    int screen_height = screen_.dimy();
+    int screen_height = getScreenHeight();
     int reserved_height = 0;
     reserved_height += 1; // tabbar
     reserved_height += 1; // separator
@@ -231,6 +242,18 @@ Element Editor::renderUI() {
         needs_render_ = true;
     }
 
+    // 提交本帧合并的输入（粘贴、同帧连续字符），之后按新内容渲染
+    if (input_router_ && input_router_->flushInputBurst(this)) {
+        force_ui_update_ = true;
+    }
+
+#ifdef BUILD_LUA_SUPPORT
+    // 插件任务被时间片打断或有 vim.schedule 回调：再要一帧，由 handleInput 推进调度器
+    if (plugin_manager_initialized_ && plugin_manager_ && plugin_manager_->hasPendingTasks()) {
+        screen_.PostEvent(Event::Custom);
+    }
+#endif
+
     // 检查是否暂停渲染
     if (rendering_paused_) {
         needs_render_ = true;
@@ -247,6 +270,13 @@ Element Editor::renderUI() {
         last_markdown_preview_update_time_ = current_time;
     }
 
+    // 交换文件：写入到期的检查点（包括后台标签页的文档）
+    for (size_t i = 0; i < document_manager_.getDocumentCount(); ++i) {
+        if (Document* swap_doc = document_manager_.getDocument(i)) {
+            swap_doc->tickSwapFile();
+        }
+    }
+
     // 增量渲染优化：抑制快速的光标移动渲染
     auto time_since_last_render = current_time - last_render_time_;
 
@@ -304,18 +334,31 @@ Element Editor::renderUI() {
         last_rendered_element_ = renderUILegacy();
     }
 
-    // 性能埋点：每 60 帧记录一次渲染耗时
+    // 性能埋点：监视开启（trace / HUD）时逐帧记录；文本日志每 60 帧记录一次
     ++render_frame_counter;
-    if (render_frame_counter % 60 == 0) {
+    auto& perf_monitor = utils::PerfMonitor::getInstance();
+    bool log_frame =
+        render_frame_counter % 60 == 0 && pnana::utils::Logger::getInstance().isEnabled();
+    if (perf_monitor.isActive() || log_frame) {
         auto t_frame_end = std::chrono::steady_clock::now();
-        auto frame_us =
-            std::chrono::duration_cast<std::chrono::microseconds>(t_frame_end - t_frame_start)
+        auto frame_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(t_frame_end - t_frame_start)
                 .count();
-        Document* doc = getCurrentDocument();
-        std::string doc_path = doc ? doc->getFilePath() : "(none)";
-        size_t doc_lines = doc ? doc->lineCount() : 0;
-        LOG("[perf] RENDER_FRAME_60 path=" + doc_path + " lines=" + std::to_string(doc_lines) +
-            " time_us=" + std::to_string(frame_us) + " avg_us=" + std::to_string(frame_us / 60));
+        if (perf_monitor.isActive()) {
+#ifdef BUILD_LSP_SUPPORT
+            if (lsp_request_manager_) {
+                perf_monitor.setCounter(utils::PerfCounter::LSP_QUEUE_DEPTH,
+                                        static_cast<int64_t>(lsp_request_manager_->pendingCount()));
+            }
+#endif
+            perf_monitor.endFrame(frame_ns);
+        }
+        if (log_frame) {
+            Document* doc = getCurrentDocument();
+            LOG("[perf] RENDER_FRAME_60 path=" + (doc ? doc->getFilePath() : "(none)") +
+                " lines=" + std::to_string(doc ? doc->lineCount() : 0) +
+                " time_us=" + std::to_string(frame_ns / 1000));
+        }
     }
 
     return last_rendered_element_;
@@ -343,7 +386,7 @@ Element Editor::renderUILegacy() {
 
     // 如果终端打开，使用上下分栏布局，位置可通过配置切换
     Element main_content;
-    int screen_height = screen_.dimy();
+    int screen_height = getScreenHeight();
     int reserved_height = 0;
     reserved_height += 1; // tabbar
     reserved_height += 1; // separator
@@ -403,6 +446,7 @@ Element Editor::renderUILegacy() {
 
 // 叠加对话框
 Element Editor::overlayDialogs(Element main_ui) {
+    PERF_ZONE(RENDER_DIALOGS);
     if (!overlay_manager_) {
         return main_ui;
     }
@@ -669,7 +713,7 @@ Element Editor::overlayDialogs(Element main_ui) {
 
     // 叠加插件 PopupManager（内核弹窗）
     if (popup_manager_) {
-        overlayed = popup_manager_->render(overlayed, screen_.dimx(), screen_.dimy());
+        overlayed = popup_manager_->render(overlayed, getScreenWidth(), getScreenHeight());
     }
 
     // 更新并渲染 Toast 通知（右下角，叠加效果）
@@ -686,6 +730,7 @@ Element Editor::overlayDialogs(Element main_ui) {
 }
 
 Element Editor::renderTabbar() {
+    PERF_ZONE(RENDER_TABBAR);
     auto tabs = document_manager_.getAllTabs();
 
     // 如果没有文档，显示"Welcome"标签
@@ -736,6 +781,7 @@ Element Editor::renderTabbar() {
 }
 
 Element Editor::renderEditor() {
+    PERF_ZONE(RENDER_EDITOR);
     // 如果启用了分屏（区域数量 > 1），使用分屏渲染
     if (split_view_manager_.hasSplits()) {
         return renderSplitEditor();
@@ -785,8 +831,8 @@ Element Editor::renderEditor() {
         }
 
         // 计算代码区的实际可用尺寸
-        int code_area_width = screen_.dimx();
-        int code_area_height = screen_.dimy() - 7; // 减去标签栏、状态栏等6行 + 边框1行
+        int code_area_width = getScreenWidth();
+        int code_area_height = getScreenHeight() - 7; // 减去标签栏、状态栏等6行 + 边框1行
 
         // 如果文件浏览器打开，减去文件浏览器的宽度
         if (file_browser_.isVisible()) {
@@ -841,6 +887,16 @@ Element Editor::renderEditor() {
         return new_file_prompt_.render();
     }
 
+    // 语法树：同步新编辑并按需提交后台重解析；括号匹配与逐行高亮随后使用
+    syntax_tree_service_.update(*doc, getFileType());
+    // 自适应后端迁移：每帧复制一块，未完成时再要一帧
+    if (doc->stepBufferBackendMigration()) {
+        screen_.PostEvent(Event::Custom);
+    }
+#ifdef BUILD_LSP_SUPPORT
+    applySyntaxTreeFolding(doc);
+#endif
+
     // 括号匹配高亮：渲染前按需更新（有缓存，不会每帧重复扫描）
     updateBracketHighlight();
 
@@ -848,7 +904,44 @@ Element Editor::renderEditor() {
 
     // 统一计算屏幕高度：减去标签栏(1) + 分隔符(1) + 状态栏(1) + 输入框(1) + 帮助栏(1) + 分隔符(1) =
     // 6行，再减去边框(2) = 8行
-    int screen_height = screen_.dimy() - 7;
+    int screen_height = getScreenHeight() - 7;
+
+    // 行号区域宽度（根据文档总行数动态计算）
+    const size_t line_num_width = getLineNumberWidthForLineCount(doc->lineCount());
+    const std::string empty_line_placeholder =
+        show_line_numbers_ ? (std::string(line_num_width + 1, ' ') + "~") : "~";
+
+    // 软换行：按视觉行填满屏幕，超长行也只渲染落在视口内的几段
+    if (const WrapIndex* wrap = getActiveWrapIndex(doc)) {
+        WrapPos top = getWrapViewTop(doc, *wrap);
+        size_t line_index = top.first;
+        size_t subrow = top.second;
+        const size_t doc_line_count = doc->lineCount();
+        const size_t max_rows = static_cast<size_t>(std::max(0, screen_height));
+        while (lines.size() < max_rows && line_index < doc_line_count) {
+            const std::string& line_content = doc->getLine(line_index);
+            const auto& starts = wrap->rowStarts(line_index, line_content);
+            const bool is_current = line_index == cursor_row_;
+            for (; subrow < starts.size() && lines.size() < max_rows; ++subrow) {
+                size_t row_end =
+                    subrow + 1 < starts.size() ? starts[subrow + 1] : line_content.size();
+                try {
+                    lines.push_back(renderLine(doc, line_index, is_current, false, false, nullptr,
+                                               -1, 0, starts[subrow], row_end));
+                } catch (...) {
+                    lines.push_back(hbox({text(empty_line_placeholder) |
+                                          color(theme_.getColors().comment)}));
+                }
+            }
+            subrow = 0;
+            line_index = doc->nextVisibleLine(line_index + 1);
+        }
+        for (size_t i = lines.size(); i < max_rows; ++i) {
+            lines.push_back(
+                hbox({text(empty_line_placeholder) | color(theme_.getColors().comment)}));
+        }
+        return vbox(lines);
+    }
 
     // 获取可见行（考虑折叠状态）
     size_t total_visible_lines = doc->getVisibleLineCount();
@@ -864,11 +957,6 @@ Element Editor::renderEditor() {
     // 计算实际显示的行数范围
     size_t max_lines = std::min(view_offset_row_ + screen_height, total_visible_lines);
 
-    // 行号区域宽度（根据文档总行数动态计算）
-    const size_t line_num_width = getLineNumberWidthForLineCount(doc->lineCount());
-    const std::string empty_line_placeholder =
-        show_line_numbers_ ? (std::string(line_num_width + 1, ' ') + "~") : "~";
-
     // 渲染可见行
     // 限制渲染的行数，避免大文件卡住
     const size_t MAX_RENDER_LINES = 200; // 最多渲染200行
@@ -881,23 +969,9 @@ Element Editor::renderEditor() {
     try {
         for (size_t i = 0; i < render_count && actual_line_index < doc_line_count; ++i) {
             try {
-                // 性能优化：对于超长行，跳过语法高亮
-                std::string line_content = doc->getLine(actual_line_index);
-                if (line_content.length() > 5000) {
-                    // 超长行，使用简单渲染
-                    Elements simple_line;
-                    if (show_line_numbers_) {
-                        simple_line.push_back(renderLineNumber(doc, actual_line_index,
-                                                               actual_line_index == cursor_row_));
-                    }
-                    simple_line.push_back(text(line_content.substr(0, 5000) + "...") |
-                                          color(theme_.getColors().foreground));
-                    lines.push_back(hbox(simple_line));
-                } else {
-                    lines.push_back(renderLine(doc, actual_line_index,
-                                               actual_line_index == cursor_row_, false, false,
-                                               nullptr));
-                }
+                // 超长行由 renderLine 按列切片渲染，不在此处读入整行
+                lines.push_back(renderLine(doc, actual_line_index, actual_line_index == cursor_row_,
+                                           false, false, nullptr));
             } catch (const std::exception& e) {
                 // 如果渲染某一行失败，使用空行替代
                 Elements error_line;
@@ -920,12 +994,8 @@ Element Editor::renderEditor() {
                 lines.push_back(hbox(error_line));
             }
 
-            // 前进到下一个可见行（跳过折叠行）
-            ++actual_line_index;
-            while (actual_line_index < doc_line_count &&
-                   doc->isLineInFoldedRange(static_cast<int>(actual_line_index))) {
-                ++actual_line_index;
-            }
+            // 前进到下一个可见行（整块跳过折叠行）
+            actual_line_index = doc->nextVisibleLine(actual_line_index + 1);
         }
     } catch (const std::exception& e) {
         // 如果整个渲染循环失败，返回错误信息
@@ -948,8 +1018,8 @@ Element Editor::renderEditor() {
 }
 
 Element Editor::renderSplitEditor() {
-    int screen_width = screen_.dimx();
-    int screen_height = screen_.dimy() - 7; // 减去标签栏、状态栏等6行 + 边框2行
+    int screen_width = getScreenWidth();
+    int screen_height = getScreenHeight() - 7; // 减去标签栏、状态栏等6行 + 边框2行
 
     // 检查是否有分屏，如果没有则回退到单视图
     if (!split_view_manager_.hasSplits()) {
@@ -1011,12 +1081,10 @@ Element Editor::renderEditorRegion(const features::ViewRegion& region, Document*
     }
 
     // 根据当前渲染的文档设置语法高亮文件类型（分屏模式下各区域独立）
-    {
-        std::string file_type =
-            utils::FileTypeDetector::detectFileType(doc->getFileName(), doc->getFileExtension());
-        if (syntax_highlighter_.getFileType() != file_type) {
-            syntax_highlighter_.setFileType(file_type);
-        }
+    const std::string region_file_type =
+        utils::FileTypeDetector::detectFileType(doc->getFileName(), doc->getFileExtension());
+    if (syntax_highlighter_.getFileType() != region_file_type) {
+        syntax_highlighter_.setFileType(region_file_type);
     }
 
     // 如果是图片文件，先尝试显示图片预览（双后端模式）
@@ -1092,6 +1160,16 @@ Element Editor::renderEditorRegion(const features::ViewRegion& region, Document*
         }
     }
 
+    // 语法树：同步新编辑并按需提交后台重解析；括号匹配与逐行高亮随后使用
+    syntax_tree_service_.update(*doc, region_file_type);
+    // 自适应后端迁移：每帧复制一块，未完成时再要一帧
+    if (doc->stepBufferBackendMigration()) {
+        screen_.PostEvent(Event::Custom);
+    }
+#ifdef BUILD_LSP_SUPPORT
+    applySyntaxTreeFolding(doc);
+#endif
+
     // 括号匹配高亮：渲染前按需更新（有缓存，不会每帧重复扫描）
     updateBracketHighlight();
 
@@ -1140,11 +1218,7 @@ Element Editor::renderEditorRegion(const features::ViewRegion& region, Document*
         lines.push_back(renderLine(doc, actual_line_index, is_current, true,
                                    region_word_highlight_active, region_word_matches, region.width,
                                    region_view_offset_col));
-        ++actual_line_index;
-        while (actual_line_index < doc_line_count &&
-               doc->isLineInFoldedRange(static_cast<int>(actual_line_index))) {
-            ++actual_line_index;
-        }
+        actual_line_index = doc->nextVisibleLine(actual_line_index + 1);
     }
 
     // 填充空行（行号宽度与文档总行数一致）
@@ -1168,8 +1242,12 @@ Element Editor::renderEditorRegion(const features::ViewRegion& region, Document*
 Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
                            bool use_region_word_highlight, bool region_word_highlight_active,
                            const std::vector<features::SearchMatch>* region_word_matches,
-                           int max_width, size_t view_offset_col) {
+                           int max_width, size_t view_offset_col, size_t wrap_start,
+                           size_t wrap_end) {
     Elements line_elements;
+    // 软换行的后续视觉行：行号与折叠指示留空
+    const bool wrapped_row = wrap_end != std::string::npos;
+    const bool continuation_row = wrapped_row && wrap_start > 0;
 
     // 创建光标渲染器并配置
     pnana::ui::CursorRenderer cursor_renderer;
@@ -1233,8 +1311,13 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
             can_fold = true;
             fold_indicator = "▶"; // 显示为折叠状态
         }
+        // 文档自身的折叠范围（无 LSP 时由语法树提供）
+        if (!can_fold && doc->isFoldStart(static_cast<int>(line_num))) {
+            can_fold = true;
+            fold_indicator = is_folded_in_doc ? "▶" : "▼";
+        }
 
-        if (can_fold) {
+        if (can_fold && !continuation_row) {
             line_elements.push_back(text(fold_indicator) | color(theme_.getColors().keyword));
         } else {
             line_elements.push_back(text(" "));
@@ -1244,10 +1327,15 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
     }
 #endif
 
-    // 行号
+    // 行号（行号后的分隔列同时用于显示 git 变更标记，不改变列宽）
     if (show_line_numbers_) {
-        line_elements.push_back(renderLineNumber(doc, line_num, is_current));
-        line_elements.push_back(text(" "));
+        if (continuation_row) {
+            line_elements.push_back(
+                text(std::string(getLineNumberWidthForLineCount(doc ? doc->lineCount() : 1), ' ')));
+        } else {
+            line_elements.push_back(renderLineNumber(doc, line_num, is_current));
+        }
+        line_elements.push_back(renderGitGutterSign(doc, line_num));
     }
     if (!doc) {
         return hbox({text("~") | color(theme_.getColors().comment)});
@@ -1257,23 +1345,79 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
         return hbox({text("~") | color(theme_.getColors().comment)});
     }
 
-    std::string content;
+    // 软换行不用于懒加载文档，行引用在本函数内稳定；超长行每个视觉行都复制整行代价过高。
+    // 未换行的超长行不读入整行，只按列切片读取视口内的字节
+    const size_t line_length = doc->getLineLength(line_num);
+    const bool long_line = !wrapped_row && LongLineView::isLongLine(line_length);
+    std::string line_copy;
+    const std::string* line_text = &line_copy;
     try {
-        content = doc->getLine(line_num);
+        if (wrapped_row) {
+            line_text = &doc->getLine(line_num);
+        } else if (!long_line) {
+            line_copy = doc->getLine(line_num);
+        }
     } catch (const std::exception& e) {
-        content = "";
+        line_copy.clear();
+        line_text = &line_copy;
     } catch (...) {
-        content = "";
+        line_copy.clear();
+        line_text = &line_copy;
     }
 
-    std::string original_content = content;
+    const std::string& original_content = *line_text;
+    std::string content = (wrapped_row || long_line) ? std::string() : original_content;
     size_t visible_cursor_col = cursor_col_;
+    bool draw_cursor = is_current;
     int tab_size = std::max(1, std::min(8, config_manager_.getConfig().editor.tab_size));
 
     bool is_split_mode = (max_width > 0);
     size_t effective_view_offset_col = is_split_mode ? view_offset_col : view_offset_col_;
 
-    if (effective_view_offset_col > 0) {
+    size_t line_count = doc->lineCount();
+    size_t ln_width = 2;
+    if (line_count > 0) {
+        size_t digits = 0;
+        for (size_t n = line_count; n > 0; n /= 10)
+            digits++;
+        ln_width = digits < 2 ? 2 : digits;
+    }
+    int effective_screen_width = is_split_mode ? max_width : getScreenWidth();
+    int max_content_width = effective_screen_width - static_cast<int>(ln_width) - 4;
+    if (max_content_width < 20)
+        max_content_width = 20;
+
+    // 软换行的视觉行与超长行的视口都只显示行内 [slice_start, slice_end) 的字节
+    const bool sliced = wrapped_row || long_line;
+    size_t slice_start = 0;
+    size_t slice_end = line_length;
+    LongLineView::Window long_window;
+
+    if (wrapped_row) {
+        // 只取本视觉行的字节区间；行尾位置归最后一个视觉行
+        slice_start = std::min(wrap_start, original_content.length());
+        slice_end = std::min(std::max(wrap_end, slice_start), original_content.length());
+        content = original_content.substr(slice_start, slice_end - slice_start);
+        draw_cursor = is_current && cursor_col_ >= slice_start &&
+                      (cursor_col_ < slice_end ||
+                       (slice_end == original_content.length() && cursor_col_ == slice_end));
+        visible_cursor_col = draw_cursor ? cursor_col_ - slice_start : 0;
+    } else if (long_line) {
+        const std::string& file_type = syntax_highlighter_.getFileType();
+        long_window =
+            long_line_view_.window(*doc, line_num, effective_view_offset_col,
+                                   static_cast<size_t>(max_content_width), tab_size, file_type);
+        content = long_window.display_text;
+        slice_start = long_window.byte_start;
+        slice_end = long_window.byte_end;
+        if (is_current) {
+            size_t display_cursor =
+                long_line_view_.displayColumn(*doc, line_num, cursor_col_, tab_size, file_type);
+            draw_cursor = display_cursor >= effective_view_offset_col &&
+                          display_cursor - effective_view_offset_col <= content.length();
+            visible_cursor_col = draw_cursor ? display_cursor - effective_view_offset_col : 0;
+        }
+    } else if (effective_view_offset_col > 0) {
         std::string display_content = expandTabsForDisplay(content, tab_size);
         if (effective_view_offset_col < display_content.length()) {
             content = display_content.substr(effective_view_offset_col);
@@ -1290,19 +1434,7 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
         }
     }
 
-    size_t line_count = doc->lineCount();
-    size_t ln_width = 2;
-    if (line_count > 0) {
-        size_t digits = 0;
-        for (size_t n = line_count; n > 0; n /= 10)
-            digits++;
-        ln_width = digits < 2 ? 2 : digits;
-    }
-    int effective_screen_width = is_split_mode ? max_width : screen_.dimx();
-    int max_content_width = effective_screen_width - static_cast<int>(ln_width) - 4;
-    if (max_content_width < 20)
-        max_content_width = 20;
-    if (content.length() > static_cast<size_t>(max_content_width)) {
+    if (!sliced && content.length() > static_cast<size_t>(max_content_width)) {
         content = content.substr(0, static_cast<size_t>(max_content_width));
         if (is_current && visible_cursor_col >= static_cast<size_t>(max_content_width)) {
             visible_cursor_col = static_cast<size_t>(max_content_width) - 1;
@@ -1356,6 +1488,29 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
         }
     }
 
+    // 切片显示：整行坐标的匹配裁剪到显示的字节区间并换算为段内列
+    auto clip_to_row = [slice_start, slice_end](std::vector<features::SearchMatch>& matches) {
+        size_t kept = 0;
+        for (auto& match : matches) {
+            size_t match_begin = std::max(match.column, slice_start);
+            size_t match_end = std::min(match.column + match.length, slice_end);
+            if (match_begin >= match_end) {
+                continue;
+            }
+            match.column = match_begin - slice_start;
+            match.length = match_end - match_begin;
+            matches[kept++] = match;
+        }
+        matches.resize(kept);
+    };
+    if (sliced) {
+        if (search_highlight_active_) {
+            clip_to_row(line_matches);
+        }
+        clip_to_row(word_line_matches);
+        clip_to_row(bracket_line_matches);
+    }
+
     Element content_elem;
 
     // 检查当前行是否在选中范围内
@@ -1385,7 +1540,7 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
             } else if (line_num == start_row) {
                 // 选中开始行
                 selection_start_col = start_col;
-                selection_end_col = content.length();
+                selection_end_col = sliced ? line_length : content.length();
             } else if (line_num == end_row) {
                 // 选中结束行
                 selection_start_col = 0;
@@ -1393,7 +1548,14 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
             } else {
                 // 中间行，整行都被选中
                 selection_start_col = 0;
-                selection_end_col = content.length();
+                selection_end_col = sliced ? line_length : content.length();
+            }
+            if (sliced) {
+                selection_start_col =
+                    std::min(std::max(selection_start_col, slice_start), slice_end) - slice_start;
+                selection_end_col =
+                    std::min(std::max(selection_end_col, slice_start), slice_end) - slice_start;
+                line_in_selection = selection_start_col < selection_end_col;
             }
         }
     }
@@ -1420,7 +1582,7 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
         bool line_too_long = line_content.length() > MAX_HIGHLIGHT_LENGTH;
 
         // 辅助函数：渲染文本段，应用选中高亮（段内 \t 按 tab_size 展开以对齐缩进）
-        auto renderSegment = [&, tab_size](const std::string& segment_text, size_t /* start_pos */,
+        auto renderSegment = [&, tab_size](const std::string& segment_text, size_t start_pos,
                                            bool is_selected) -> Element {
             if (segment_text.empty()) {
                 return ftxui::text("");
@@ -1430,7 +1592,18 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
             Element elem;
             if (syntax_highlighting_ && !line_too_long) {
                 try {
-                    elem = syntax_highlighter_.highlightLine(display_text);
+                    if (PERF_TRACE_ENABLED()) {
+                        auto t_hl_start = std::chrono::steady_clock::now();
+                        elem = syntax_highlighter_.highlightLine(display_text, start_pos);
+                        PERF_EVENT(utils::PerfEventId::HIGHLIGHT_LINE,
+                                   static_cast<int64_t>(display_text.size()),
+                                   std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - t_hl_start)
+                                       .count());
+                    } else {
+                        elem = syntax_highlighter_.highlightLine(display_text, start_pos);
+                    }
+                    PERF_COUNTER_ADD(LINES_HIGHLIGHTED, 1);
                 } catch (...) {
                     elem = ftxui::text(display_text) | color(colors.foreground);
                 }
@@ -1843,8 +2016,21 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
         return hbox(parts);
     };
 
+    // 行内没有制表符时显示列与字节列一致，片段可直接取文档语法树的高亮
+    // 超长行收集整行的树节点代价过高（软换行时每个视觉行都会触发），改用片段内的原生高亮
+    // 未换行的超长行只对最近检查点到视口末尾的字节分词
+    if (long_line && long_window.raw) {
+        syntax_highlighter_.setLineContext(long_window.context,
+                                           long_window.byte_start - long_window.context_start);
+    } else if (!long_line && original_content.length() <= MAX_TREE_HIGHLIGHT_LINE_LENGTH &&
+               original_content.find('\t') == std::string::npos) {
+        if (const auto* tree = syntax_tree_service_.tree(*doc)) {
+            syntax_highlighter_.setLineTree(tree, line_num, original_content,
+                                            wrapped_row ? slice_start : effective_view_offset_col);
+        }
+    }
     try {
-        content_elem = renderLineWithHighlights(content, visible_cursor_col, is_current);
+        content_elem = renderLineWithHighlights(content, visible_cursor_col, draw_cursor);
     } catch (const std::exception& e) {
         // 如果高亮失败，使用简单文本
         content_elem = text(content) | color(theme_.getColors().foreground);
@@ -1852,6 +2038,8 @@ Element Editor::renderLine(Document* doc, size_t line_num, bool is_current,
         // 如果高亮失败，使用简单文本
         content_elem = text(content) | color(theme_.getColors().foreground);
     }
+    syntax_highlighter_.clearLineTree();
+    syntax_highlighter_.clearLineContext();
 
     line_elements.push_back(content_elem);
 
@@ -1985,7 +2173,38 @@ Element Editor::renderLineNumber(Document* doc, size_t line_num, bool is_current
     return line_number_element;
 }
 
+Element Editor::renderGitGutterSign(Document* doc, size_t line_num) {
+    if (!show_git_gutter_ || !doc || doc->isLazyLoaded() ||
+        doc->lineCount() > vgit::GitGutterTracker::MAX_LINES) {
+        return text(" ");
+    }
+    const std::string file_path = doc->getFilePath();
+    if (file_path.empty() || file_path.rfind("ssh://", 0) == 0) {
+        return text(" ");
+    }
+
+    // 版本未变化时 update 为 O(1)；每帧每行调用的开销只有一次哈希表查找，
+    // 版本变化时只对编辑触及的窗口重新 diff
+    vgit::GitGutterTracker& tracker = git_gutters_[file_path];
+    tracker.update(file_path, *doc);
+
+    const auto& colors = theme_.getColors();
+    switch (tracker.markForLine(line_num)) {
+        case vgit::GitGutterTracker::Mark::ADDED:
+            return text("▎") | color(colors.success);
+        case vgit::GitGutterTracker::Mark::MODIFIED:
+            return text("▎") | color(colors.warning);
+        case vgit::GitGutterTracker::Mark::REMOVED_BELOW:
+            return text("▁") | color(colors.error);
+        case vgit::GitGutterTracker::Mark::REMOVED_ABOVE:
+            return text("▔") | color(colors.error);
+        default:
+            return text(" ");
+    }
+}
+
 Element Editor::renderStatusbar() {
+    PERF_ZONE(RENDER_STATUSBAR);
     // 异步更新git信息（非阻塞）
     updateGitInfo();
 
@@ -2049,6 +2268,12 @@ Element Editor::renderStatusbar() {
             display_message = ssh_info;
         }
     }
+    // 性能 HUD：帧耗时分位数与上一帧计数器
+    auto& perf_monitor = utils::PerfMonitor::getInstance();
+    if (perf_monitor.isHudEnabled()) {
+        std::string hud = perf_monitor.hudText();
+        display_message = display_message.empty() ? hud : display_message + " | " + hud;
+    }
 
     // 使用 getDocumentForActiveRegion：分屏时若当前激活区域无文档（welcome），应显示 Welcome
     // 而非 getCurrentDocument() 可能返回的其他区域的文档
@@ -2262,13 +2487,14 @@ Element Editor::renderReplaceInputBox() {
 }
 
 Element Editor::renderFileBrowser() {
-    int height = screen_.dimy() - 4; // 减去状态栏等高度
+    PERF_ZONE(RENDER_FILE_BROWSER);
+    int height = getScreenHeight() - 4; // 减去状态栏等高度
     return file_browser_.render(height);
 }
 
 Element Editor::renderHelp() {
-    int width = screen_.dimx();
-    int height = screen_.dimy();
+    int width = getScreenWidth();
+    int height = getScreenHeight();
     return help_.render(width, height);
 }
 
@@ -2277,9 +2503,10 @@ Element Editor::renderCommandPalette() {
 }
 
 Element Editor::renderTerminal() {
+    PERF_ZONE(RENDER_TERMINAL);
     int height = terminal_height_;
     if (height <= 0) {
-        height = screen_.dimy() / 3;
+        height = getScreenHeight() / 3;
     }
     pnana::ui::TerminalCursorOptions cursor_opts;
     cursor_opts.config.style = static_cast<pnana::ui::CursorStyle>(getCursorStyle());
@@ -140,7 +140,9 @@ void Editor::updateWordHighlight() {
 
     // 搜索文件中所有相同的单词（大小写敏感，整词匹配）
     std::vector<features::SearchMatch> matches;
-    const auto& lines = doc->getLines();
+    // 只读访问，不触发任何修改记录
+    const Document& const_doc = *doc;
+    const auto& lines = const_doc.getLines();
 
     for (size_t line_idx = 0; line_idx < lines.size(); ++line_idx) {
         const std::string& current_line = lines[line_idx];
@@ -0,0 +1,239 @@
+#include "core/fold_index.h"
+#include <algorithm>
+
+namespace pnana {
+namespace core {
+
+void FoldIndex::Fenwick::build(const std::vector<int64_t>& values) {
+    tree_.assign(values.size() + 1, 0);
+    for (size_t i = 0; i < values.size(); ++i) {
+        tree_[i + 1] += values[i];
+        size_t parent = (i + 1) + ((i + 1) & (~(i + 1) + 1));
+        if (parent < tree_.size()) {
+            tree_[parent] += tree_[i + 1];
+        }
+    }
+}
+
+void FoldIndex::Fenwick::add(size_t index, int64_t delta) {
+    for (size_t i = index + 1; i < tree_.size(); i += i & (~i + 1)) {
+        tree_[i] += delta;
+    }
+}
+
+int64_t FoldIndex::Fenwick::prefix(size_t count) const {
+    int64_t sum = 0;
+    for (size_t i = std::min(count, size()); i > 0; i -= i & (~i + 1)) {
+        sum += tree_[i];
+    }
+    return sum;
+}
+
+size_t FoldIndex::Fenwick::upperBound(int64_t target) const {
+    size_t n = size();
+    size_t pos = 0;
+    size_t step = 1;
+    while (step * 2 <= n) {
+        step *= 2;
+    }
+    for (; step > 0; step /= 2) {
+        if (pos + step <= n && tree_[pos + step] <= target) {
+            pos += step;
+            target -= tree_[pos];
+        }
+    }
+    return pos;
+}
+
+void FoldIndex::clear() {
+    gap_.clear();
+    len_.clear();
+    visible_tree_.build(gap_);
+    span_tree_.build(gap_);
+    hidden_total_ = 0;
+}
+
+void FoldIndex::rebuild(std::vector<std::pair<int, int>> folded) {
+    gap_.clear();
+    len_.clear();
+    hidden_total_ = 0;
+
+    std::sort(folded.begin(), folded.end());
+    // 合并隐藏区间 (start, end]，相邻或重叠的合成一块
+    int64_t cursor = 0; // 上一块结束后的第一行
+    int64_t run_first = -1;
+    int64_t run_last = -1;
+    auto flush = [&]() {
+        if (run_first < 0) {
+            return;
+        }
+        gap_.push_back(run_first - cursor);
+        len_.push_back(run_last - run_first + 1);
+        hidden_total_ += run_last - run_first + 1;
+        cursor = run_last + 1;
+    };
+    for (const auto& range : folded) {
+        int64_t first = static_cast<int64_t>(range.first) + 1;
+        int64_t last = range.second;
+        if (range.first < 0 || last < first) {
+            continue;
+        }
+        if (run_first >= 0 && first <= run_last + 1) {
+            run_last = std::max(run_last, last);
+            continue;
+        }
+        flush();
+        run_first = first;
+        run_last = last;
+    }
+    flush();
+
+    std::vector<int64_t> span(gap_.size());
+    for (size_t i = 0; i < gap_.size(); ++i) {
+        span[i] = gap_[i] + len_[i];
+    }
+    visible_tree_.build(gap_);
+    span_tree_.build(span);
+}
+
+size_t FoldIndex::locate(size_t line) const {
+    return span_tree_.upperBound(static_cast<int64_t>(line));
+}
+
+bool FoldIndex::isHidden(size_t line) const {
+    if (hidden_total_ == 0) {
+        return false;
+    }
+    size_t block = locate(line);
+    if (block >= gap_.size()) {
+        return false;
+    }
+    int64_t offset = static_cast<int64_t>(line) - span_tree_.prefix(block);
+    return offset >= gap_[block];
+}
+
+size_t FoldIndex::visibleBefore(size_t line) const {
+    if (hidden_total_ == 0) {
+        return line;
+    }
+    size_t block = locate(line);
+    if (block >= gap_.size()) {
+        return line - static_cast<size_t>(hidden_total_);
+    }
+    int64_t offset = static_cast<int64_t>(line) - span_tree_.prefix(block);
+    return static_cast<size_t>(visible_tree_.prefix(block) + std::min(offset, gap_[block]));
+}
+
+size_t FoldIndex::actualToDisplay(size_t line) const {
+    return visibleBefore(prevVisible(line));
+}
+
+size_t FoldIndex::displayToActual(size_t display_line) const {
+    if (hidden_total_ == 0) {
+        return display_line;
+    }
+    size_t block = visible_tree_.upperBound(static_cast<int64_t>(display_line));
+    if (block >= gap_.size()) {
+        return display_line + static_cast<size_t>(hidden_total_);
+    }
+    int64_t offset = static_cast<int64_t>(display_line) - visible_tree_.prefix(block);
+    return static_cast<size_t>(span_tree_.prefix(block) + offset);
+}
+
+size_t FoldIndex::nextVisible(size_t line) const {
+    if (hidden_total_ == 0) {
+        return line;
+    }
+    size_t block = locate(line);
+    if (block >= gap_.size()) {
+        return line;
+    }
+    int64_t offset = static_cast<int64_t>(line) - span_tree_.prefix(block);
+    if (offset < gap_[block]) {
+        return line;
+    }
+    return static_cast<size_t>(span_tree_.prefix(block + 1));
+}
+
+size_t FoldIndex::prevVisible(size_t line) const {
+    if (hidden_total_ == 0) {
+        return line;
+    }
+    size_t block = locate(line);
+    if (block >= gap_.size()) {
+        return line;
+    }
+    int64_t start = span_tree_.prefix(block);
+    int64_t offset = static_cast<int64_t>(line) - start;
+    if (offset < gap_[block]) {
+        return line;
+    }
+    // 隐藏块前一行就是折叠首行；首行被删掉的退化情况下退到 0
+    return static_cast<size_t>(std::max<int64_t>(0, start + gap_[block] - 1));
+}
+
+void FoldIndex::shiftLines(size_t row, int64_t delta) {
+    if (delta == 0 || gap_.empty()) {
+        return;
+    }
+    size_t block = locate(row);
+    if (block >= gap_.size()) {
+        return; // 所有折叠都在 row 之前
+    }
+
+    if (delta > 0) {
+        int64_t offset = static_cast<int64_t>(row) - span_tree_.prefix(block);
+        if (offset < gap_[block]) {
+            gap_[block] += delta;
+            visible_tree_.add(block, delta);
+        } else {
+            // 插在折叠内部：新行同样隐藏
+            len_[block] += delta;
+            hidden_total_ += delta;
+        }
+        span_tree_.add(block, delta);
+        return;
+    }
+
+    // 删除 [row, row + remaining)：row 之后的行依次上移，逐块扣减
+    int64_t remaining = -delta;
+    for (; block < gap_.size() && remaining > 0; ++block) {
+        int64_t offset = static_cast<int64_t>(row) - span_tree_.prefix(block);
+        if (offset < gap_[block]) {
+            int64_t take = std::min(remaining, gap_[block] - offset);
+            gap_[block] -= take;
+            visible_tree_.add(block, -take);
+            span_tree_.add(block, -take);
+            remaining -= take;
+            offset = gap_[block];
+        }
+        if (remaining > 0) {
+            int64_t hidden_offset = offset - gap_[block];
+            int64_t take = std::min(remaining, len_[block] - hidden_offset);
+            if (take > 0) {
+                len_[block] -= take;
+                hidden_total_ -= take;
+                span_tree_.add(block, -take);
+                remaining -= take;
+            }
+        }
+    }
+}
+
+bool FoldIndex::shiftRange(int& start, int& end, size_t row, int64_t delta) {
+    const int64_t r = static_cast<int64_t>(row);
+    if (delta < 0 && start >= r && start < r - delta) {
+        return false;
+    }
+    if (end >= r) {
+        // 末行落在删除区内时退到删除区之前的最后一行，与 shiftLines 对隐藏块的扣减一致
+        end = static_cast<int>(delta > 0 ? end + delta : std::max(r - 1, end + delta));
+    }
+    if (start >= r) {
+        start = static_cast<int>(start + delta);
+    }
+    return end > start;
+}
+
+} // namespace core
+} // namespace pnana
@@ -5,6 +5,10 @@
 #include "core/input/region_handlers/terminal_handler.h"
 #include "input/action_executor.h"
 #include "input/key_binding_manager.h"
+#ifdef BUILD_LUA_SUPPORT
+#include "plugins/plugin_manager.h"
+#endif
+#include <algorithm>
 #include <ftxui/component/event.hpp>
 
 namespace pnana {
@@ -48,6 +52,13 @@ bool InputRouter::route(ftxui::Event event, Editor* editor) {
         return true;
     }
 
+#ifdef BUILD_LUA_SUPPORT
+    // 3b. 插件键映射：对话框打开时不触发，命中后优先于各区域自己的按键处理
+    if (handlePluginKeymaps(event, editor)) {
+        return true;
+    }
+#endif
+
     // 4. 检查分屏导航（在分屏模式下优先级较高）
     if (handleSplitNavigation(event, editor)) {
         return true;
@@ -57,6 +68,124 @@ bool InputRouter::route(ftxui::Event event, Editor* editor) {
     return routeByRegion(event, editor);
 }
 
+namespace {
+
+constexpr char BRACKETED_PASTE_BEGIN[] = "\x1b[200~";
+constexpr char BRACKETED_PASTE_END[] = "\x1b[201~";
+
+// text 中 pos 处的一个输入单元：换行或一个 UTF-8 字符
+size_t inputUnitLength(const std::string& text, size_t pos) {
+    unsigned char lead = static_cast<unsigned char>(text[pos]);
+    size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+    return std::min(length, text.size() - pos);
+}
+
+ftxui::Event unitToEvent(const std::string& unit) {
+    if (unit == "\n") {
+        return ftxui::Event::Return;
+    }
+    if (unit == "\t") {
+        return ftxui::Event::Tab;
+    }
+    return ftxui::Event::Character(unit);
+}
+
+} // namespace
+
+bool InputRouter::coalesce(const ftxui::Event& event, Editor* editor) {
+    if (!event.is_mouse() && event.input() == BRACKETED_PASTE_BEGIN) {
+        in_bracketed_paste_ = true;
+        paste_text_.clear();
+        return true;
+    }
+    if (in_bracketed_paste_) {
+        if (event.input() == BRACKETED_PASTE_END) {
+            in_bracketed_paste_ = false;
+            finishBracketedPaste(editor);
+        } else if (!event.is_mouse()) {
+            // 粘贴内容里的回车、Tab 等以原始字节到达
+            paste_text_ += event.input();
+        }
+        return true;
+    }
+    // 其他按键按原顺序处理：先提交之前攒下的字符
+    if (!event.is_character() && event != ftxui::Event::Return) {
+        flushInputBurst(editor);
+    }
+    return false;
+}
+
+bool InputRouter::deferTextInsert(const std::string& text, bool is_newline) {
+    if (probing_paste_ || typed_this_frame_) {
+        burst_ += text;
+        return true;
+    }
+    // 本帧第一个字符按普通按键处理；单独的回车不开启合并（保留自动缩进）
+    if (!is_newline) {
+        typed_this_frame_ = true;
+    }
+    return false;
+}
+
+bool InputRouter::flushInputBurst(Editor* editor) {
+    typed_this_frame_ = false;
+    if (burst_.empty()) {
+        return false;
+    }
+    std::string text;
+    text.swap(burst_);
+    editor->insertBulkText(std::move(text));
+    return true;
+}
+
+void InputRouter::finishBracketedPaste(Editor* editor) {
+    std::string text;
+    text.swap(paste_text_);
+    // 统一换行：终端在粘贴中用 \r 表示换行
+    std::string normalized;
+    normalized.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\r') {
+            normalized += text[i];
+        } else if (i + 1 >= text.size() || text[i + 1] != '\n') {
+            normalized += '\n';
+        }
+    }
+    if (normalized.empty()) {
+        return;
+    }
+
+    flushInputBurst(editor);
+    // 探测单元跳过开头的 Tab：代码区里 Tab 是缩进命令，不会走到文本插入
+    size_t probe = normalized.find_first_not_of('\t');
+    if (probe == std::string::npos) {
+        probe = 0;
+    }
+    size_t probe_length = inputUnitLength(normalized, probe);
+    dispatching_paste_ = true;
+    probing_paste_ = true;
+    editor->handleInput(unitToEvent(normalized.substr(probe, probe_length)));
+    probing_paste_ = false;
+
+    if (!burst_.empty()) {
+        // 落在代码区：探测单元只进了缓冲，整段替换为完整内容一次插入
+        burst_.swap(normalized);
+        size_t line_count = std::count(burst_.begin(), burst_.end(), '\n') + 1;
+        flushInputBurst(editor);
+        dispatching_paste_ = false;
+        editor->setStatusMessage("Pasted " + std::to_string(line_count) + " lines");
+        return;
+    }
+    for (size_t pos = 0; pos < normalized.size();) {
+        size_t length = inputUnitLength(normalized, pos);
+        if (pos != probe) {
+            editor->handleInput(unitToEvent(normalized.substr(pos, length)));
+        }
+        pos += length;
+    }
+    dispatching_paste_ = false;
+}
+
 bool InputRouter::handleGlobalShortcuts(ftxui::Event event, Editor* editor) {
     // 使用现有的 KeyBindingManager 解析事件
     pnana::input::KeyAction action = editor->getKeyBindingManager().getAction(event);
@@ -100,6 +229,37 @@ bool InputRouter::handleGlobalShortcuts(ftxui::Event event, Editor* editor) {
     return false;
 }
 
+#ifdef BUILD_LUA_SUPPORT
+bool InputRouter::handlePluginKeymaps(ftxui::Event event, Editor* editor) {
+    const pnana::input::KeyBindingManager& bindings = editor->getKeyBindingManager();
+    if (!bindings.hasPluginKeymaps() || editor->getMode() != EditorMode::NORMAL) {
+        return false;
+    }
+    // 终端区域的按键原样交给 shell
+    if (editor->getRegionManager().getCurrentRegion() == EditorRegion::TERMINAL) {
+        return false;
+    }
+    pnana::input::KeyChord chord = bindings.getChord(event);
+    if (chord == pnana::input::chord::NONE) {
+        return false;
+    }
+
+    // pnana 没有独立的插入模式：编辑状态同时对应 Vim 的 normal 与 insert，有选区时先查 visual
+    static const std::string MODES[] = {"v", "x", "n", "i", ""};
+    size_t first = editor->selection_active_ ? 0 : 2;
+    for (size_t i = first; i < sizeof(MODES) / sizeof(MODES[0]); ++i) {
+        const std::string* lhs = bindings.findPluginKeymap(MODES[i], chord);
+        if (lhs) {
+            // 回调可能增删键映射并重建分发表，先复制 lhs
+            std::string keys = *lhs;
+            plugins::PluginManager* plugin_manager = editor->getPluginManager();
+            return plugin_manager && plugin_manager->handleKeymap(MODES[i], keys);
+        }
+    }
+    return false;
+}
+#endif
+
 bool InputRouter::handleDialogs(ftxui::Event event, Editor* editor) {
     // 对话框优先级：通用对话框（如大文件确认）> 命令面板 > 最近文件弹窗 > TUI配置弹窗
 
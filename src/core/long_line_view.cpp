@@ -0,0 +1,180 @@
+#include "core/long_line_view.h"
+#include "core/document.h"
+#include <algorithm>
+
+namespace pnana {
+namespace core {
+
+namespace {
+
+bool isContinuationByte(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+size_t charColumns(char c, size_t col, size_t tab) {
+    return c == '\t' ? tab - col % tab : 1;
+}
+
+size_t normalizedTab(int tab_size) {
+    return tab_size > 0 ? static_cast<size_t>(tab_size) : 4;
+}
+
+} // namespace
+
+LongLineView::Entry& LongLineView::entryFor(const Document& doc, size_t row, int tab_size,
+                                            const std::string& file_type) {
+    const auto key = std::make_pair(doc.getInstanceId(), row);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        if (entries_.size() >= MAX_ENTRIES) {
+            entries_.clear();
+        }
+        it = entries_.emplace(key, Entry()).first;
+    }
+    Entry& entry = it->second;
+    const size_t length = doc.getLineLength(row);
+    if (entry.checkpoints.empty() || entry.version != doc.getVersion() ||
+        entry.tab_size != tab_size || entry.file_type != file_type || entry.length != length) {
+        entry.version = doc.getVersion();
+        entry.tab_size = tab_size;
+        entry.file_type = file_type;
+        entry.length = length;
+        entry.checkpoints.assign(1, Checkpoint{0, 0});
+    }
+    return entry;
+}
+
+bool LongLineView::extendOnce(const Document& doc, size_t row, Entry& entry) {
+    const Checkpoint last = entry.checkpoints.back();
+    if (last.byte >= entry.length) {
+        return false;
+    }
+    // 多读一个区间，让分词器看到检查点之后的完整 token
+    std::string chunk = doc.getLineSlice(row, last.byte, CHECKPOINT_BYTES * 2);
+    if (chunk.empty()) {
+        entry.length = last.byte;
+        return false;
+    }
+    size_t step = chunk.size();
+    if (chunk.size() > CHECKPOINT_BYTES) {
+        step = boundary_ ? boundary_(chunk, CHECKPOINT_BYTES) : CHECKPOINT_BYTES;
+        // 整段是一个 token（如超长字符串）时退回固定步长
+        if (step == 0 || step > CHECKPOINT_BYTES) {
+            step = CHECKPOINT_BYTES;
+        }
+        while (step < chunk.size() && isContinuationByte(chunk[step])) {
+            ++step;
+        }
+    }
+
+    const size_t tab = normalizedTab(entry.tab_size);
+    size_t col = last.display_col;
+    for (size_t i = 0; i < step; ++i) {
+        col += charColumns(chunk[i], col, tab);
+    }
+    entry.checkpoints.push_back(Checkpoint{last.byte + step, col});
+    return true;
+}
+
+void LongLineView::extendToByte(const Document& doc, size_t row, Entry& entry, size_t byte) {
+    while (entry.checkpoints.back().byte < byte && extendOnce(doc, row, entry)) {
+    }
+}
+
+void LongLineView::extendToColumn(const Document& doc, size_t row, Entry& entry,
+                                  size_t display_col) {
+    while (entry.checkpoints.back().display_col < display_col && extendOnce(doc, row, entry)) {
+    }
+}
+
+size_t LongLineView::displayColumn(const Document& doc, size_t row, size_t byte_col, int tab_size,
+                                   const std::string& file_type) {
+    const size_t tab = normalizedTab(tab_size);
+    if (!isLongLine(doc.getLineLength(row))) {
+        const std::string& line = doc.getLine(row);
+        size_t col = 0;
+        for (size_t i = 0; i < byte_col && i < line.length(); ++i) {
+            col += charColumns(line[i], col, tab);
+        }
+        return col;
+    }
+
+    Entry& entry = entryFor(doc, row, tab_size, file_type);
+    byte_col = std::min(byte_col, entry.length);
+    extendToByte(doc, row, entry, byte_col);
+    auto it = std::upper_bound(entry.checkpoints.begin(), entry.checkpoints.end(), byte_col,
+                               [](size_t byte, const Checkpoint& cp) {
+                                   return byte < cp.byte;
+                               });
+    const Checkpoint& cp = *(it - 1);
+    std::string chunk = doc.getLineSlice(row, cp.byte, byte_col - cp.byte);
+    size_t col = cp.display_col;
+    for (char c : chunk) {
+        col += charColumns(c, col, tab);
+    }
+    return col;
+}
+
+LongLineView::Window LongLineView::window(const Document& doc, size_t row, size_t display_col,
+                                          size_t width, int tab_size,
+                                          const std::string& file_type) {
+    Window result;
+    Entry& entry = entryFor(doc, row, tab_size, file_type);
+    extendToColumn(doc, row, entry, display_col);
+    auto it = std::upper_bound(entry.checkpoints.begin(), entry.checkpoints.end(), display_col,
+                               [](size_t col, const Checkpoint& cp) {
+                                   return col < cp.display_col;
+                               });
+    const Checkpoint cp = *(it - 1);
+
+    // 每字节至少占一列，读 (display_col - cp.display_col) + width 字节足以覆盖视口；
+    // 额外几个字节用于补全视口末尾被截断的 UTF-8 字符
+    std::string chunk = doc.getLineSlice(row, cp.byte, display_col - cp.display_col + width + 4);
+    const size_t tab = normalizedTab(tab_size);
+    const size_t end_col = display_col + width;
+    size_t col = cp.display_col;
+    size_t i = 0;
+
+    // 跳到视口起点；被视口左边界截断的制表符只显示剩余部分
+    while (i < chunk.size() && col < display_col) {
+        size_t w = charColumns(chunk[i], col, tab);
+        if (col + w > display_col) {
+            result.display_text.append(std::min(col + w, end_col) - display_col, ' ');
+            result.raw = false;
+        }
+        col += w;
+        ++i;
+    }
+    // 不从 UTF-8 字符中间开始
+    while (i < chunk.size() && isContinuationByte(chunk[i])) {
+        ++i;
+        ++col;
+    }
+    result.byte_start = cp.byte + i;
+
+    while (i < chunk.size() && col < end_col) {
+        const char c = chunk[i];
+        if (c == '\t') {
+            size_t w = charColumns(c, col, tab);
+            result.display_text.append(std::min(w, end_col - col), ' ');
+            result.raw = false;
+            col += w;
+        } else {
+            result.display_text.push_back(c);
+            ++col;
+        }
+        ++i;
+    }
+    while (i < chunk.size() && isContinuationByte(chunk[i])) {
+        result.display_text.push_back(chunk[i]);
+        ++i;
+    }
+    result.byte_end = cp.byte + i;
+    result.context_start = cp.byte;
+    chunk.resize(i);
+    result.context = std::move(chunk);
+    return result;
+}
+
+} // namespace core
+} // namespace pnana
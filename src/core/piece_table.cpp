@@ -5,23 +5,44 @@
 namespace pnana {
 namespace core {
 
-PieceTable::PieceTable() : total_length_(0), line_count_(1), lines_dirty_(true) {
+PieceTable::PieceTable()
+    : total_length_(0), line_count_(1), lines_dirty_(true), node_count_(0), empty_nodes_(0) {
     nil_ = std::make_shared<RBNode>();
     nil_->color = 1; // black
     root_ = nil_;
 }
 
-size_t PieceTable::countNewlines(const std::string& str, size_t start, size_t len) const {
-    if (start >= str.size())
-        return 0;
-    len = std::min(len, str.size() - start);
+PieceTable::~PieceTable() {
+    releaseTree();
+}
 
-    size_t count = 0;
-    for (size_t i = start; i < start + len && i < str.size(); ++i) {
-        if (str[i] == '\n')
-            count++;
+void PieceTable::clear() {
+    releaseTree();
+    original_buffer_.clear();
+    append_buffer_.clear();
+    original_newlines_.clear();
+    append_newlines_.clear();
+    total_length_ = 0;
+    line_count_ = 1;
+    lines_dirty_ = true;
+    node_count_ = 0;
+    empty_nodes_ = 0;
+}
+
+void PieceTable::indexNewlines(std::vector<size_t>& index, const std::string& text,
+                               size_t base) {
+    size_t pos = text.find('\n');
+    while (pos != std::string::npos) {
+        index.push_back(base + pos);
+        pos = text.find('\n', pos + 1);
     }
-    return count;
+}
+
+size_t PieceTable::countNewlines(const Piece& piece) const {
+    const std::vector<size_t>& index = newlinesOf(piece.buffer_type);
+    auto first = std::lower_bound(index.begin(), index.end(), piece.start);
+    auto last = std::lower_bound(first, index.end(), piece.start + piece.length);
+    return static_cast<size_t>(last - first);
 }
 
 void PieceTable::updateNodeInfo(std::shared_ptr<RBNode> node) const {
@@ -29,9 +50,7 @@ void PieceTable::updateNodeInfo(std::shared_ptr<RBNode> node) const {
         return;
 
     node->subtree_length = node->piece.length;
-    node->subtree_newlines = countNewlines(
-        node->piece.buffer_type == BufferType::ORIGINAL ? original_buffer_ : append_buffer_,
-        node->piece.start, node->piece.length);
+    node->subtree_newlines = countNewlines(node->piece);
 
     if (node->left && node->left != nil_) {
         node->subtree_length += node->left->subtree_length;
@@ -177,77 +196,101 @@ void PieceTable::traverseInOrder(std::shared_ptr<RBNode> node,
     traverseInOrder(node->right, callback);
 }
 
+std::shared_ptr<PieceTable::RBNode> PieceTable::makeNode(BufferType type, size_t start,
+                                                         size_t length) const {
+    auto node = std::make_shared<RBNode>(Piece(type, start, length));
+    node->left = nil_;
+    node->right = nil_;
+    node->parent = nullptr;
+    node->color = 0;
+    updateNodeInfo(node);
+    return node;
+}
+
+void PieceTable::propagateUp(std::shared_ptr<RBNode> node) const {
+    while (node && node != nil_) {
+        updateNodeInfo(node);
+        node = node->parent;
+    }
+}
+
+void PieceTable::attachNode(std::shared_ptr<RBNode> anchor, std::shared_ptr<RBNode> node,
+                            bool before) {
+    // 作为 anchor 的中序前驱（before）或后继挂到叶子位置，再自底向上修正子树统计并做红黑修复
+    std::shared_ptr<RBNode> parent = anchor;
+    if (before) {
+        if (anchor->left == nil_) {
+            anchor->left = node;
+        } else {
+            parent = anchor->left;
+            while (parent->right != nil_) {
+                parent = parent->right;
+            }
+            parent->right = node;
+        }
+    } else {
+        if (anchor->right == nil_) {
+            anchor->right = node;
+        } else {
+            parent = anchor->right;
+            while (parent->left != nil_) {
+                parent = parent->left;
+            }
+            parent->left = node;
+        }
+    }
+    node->parent = parent;
+    ++node_count_;
+
+    propagateUp(parent);
+    insertFixup(node);
+}
+
 void PieceTable::insertPiece(size_t pos, BufferType type, size_t start, size_t length) {
     if (length == 0)
         return;
 
-    Piece new_piece(type, start, length);
-    auto new_node = std::make_shared<RBNode>(new_piece);
-    new_node->left = nil_;
-    new_node->right = nil_;
-    new_node->parent = nullptr;
-    new_node->subtree_length = length;
-    new_node->subtree_newlines = countNewlines(
-        type == BufferType::ORIGINAL ? original_buffer_ : append_buffer_, start, length);
-    new_node->color = 0;
-
     if (!root_ || root_ == nil_) {
-        root_ = new_node;
+        root_ = makeNode(type, start, length);
         root_->color = 1;
-        root_->parent = nullptr;
+        node_count_ = 1;
+        empty_nodes_ = 0;
+    } else if (pos >= total_length_) {
+        std::shared_ptr<RBNode> last = root_;
+        while (last->right != nil_) {
+            last = last->right;
+        }
+        if (last->piece.buffer_type == type && last->piece.start + last->piece.length == start) {
+            // 连续追加：直接延长末尾片段
+            last->piece.length += length;
+            propagateUp(last);
+        } else {
+            attachNode(last, makeNode(type, start, length), false);
+        }
     } else {
         auto [node, offset] = findNodeAndOffset(pos);
-
-        if (!node || node == nil_) {
-            std::shared_ptr<RBNode> current = root_;
-            while (current->right != nil_) {
-                current = current->right;
-            }
-            current->right = new_node;
-            new_node->parent = current;
-        } else if (offset == 0 && pos == 0) {
-            std::shared_ptr<RBNode> current = root_;
-            while (current->left != nil_) {
-                current = current->left;
+        if (!node)
+            return;
+
+        if (offset == 0) {
+            // 连续输入：前一个片段恰好结束于追加缓冲区末尾时直接延长，不新增节点
+            std::shared_ptr<RBNode> prev = pos > 0 ? findNodeAndOffset(pos - 1).first : nullptr;
+            if (prev && prev->piece.buffer_type == type &&
+                prev->piece.start + prev->piece.length == start) {
+                prev->piece.length += length;
+                propagateUp(prev);
+            } else {
+                attachNode(node, makeNode(type, start, length), true);
             }
-            new_node->right = current;
-            new_node->left = nil_;
-            current->parent = new_node;
-            root_ = new_node;
-            root_->color = 1;
         } else {
+            // 片段内部插入：拆成 [左半][新片段][右半]
             Piece& piece = node->piece;
-
-            if (offset > 0 && offset < piece.length) {
-                Piece right_piece(piece.buffer_type, piece.start + offset, piece.length - offset);
-                piece.length = offset;
-
-                auto right_node = std::make_shared<RBNode>(right_piece);
-                right_node->left = nil_;
-                right_node->right = node->right;
-                right_node->parent = node;
-
-                if (node->right != nil_) {
-                    node->right->parent = right_node;
-                }
-                node->right = right_node;
-            }
-
-            new_node->parent = node;
-            new_node->left = node->right;
-            if (node->right != nil_) {
-                node->right->parent = new_node;
-            }
-            node->right = new_node;
+            auto right_node =
+                makeNode(piece.buffer_type, piece.start + offset, piece.length - offset);
+            piece.length = offset;
+            attachNode(node, right_node, false);
+            attachNode(right_node, makeNode(type, start, length), true);
         }
-
-        insertFixup(new_node);
-    }
-
-    std::shared_ptr<RBNode> current = new_node;
-    while (current && current->parent) {
-        updateNodeInfo(current->parent);
-        current = current->parent;
     }
 
     total_length_ += length;
@@ -262,6 +305,7 @@ void PieceTable::insert(size_t pos, const std::string& text) {
 
     size_t start = append_buffer_.size();
     append_buffer_ += text;
+    indexNewlines(append_newlines_, text, start);
 
     insertPiece(pos, BufferType::APPEND, start, text.size());
 }
@@ -272,83 +316,51 @@ void PieceTable::remove(size_t pos, size_t length) {
 
     length = std::min(length, total_length_ - pos);
 
-    std::vector<std::shared_ptr<RBNode>> nodes_to_modify;
-    std::vector<std::pair<std::shared_ptr<RBNode>, Piece>> new_pieces;
-
-    auto [start_node, start_offset] = findNodeAndOffset(pos);
-    if (!start_node)
+    auto [current, current_offset] = findNodeAndOffset(pos);
+    if (!current)
         return;
 
-    auto leftMost = [this](std::shared_ptr<RBNode> current) {
-        while (current && current != nil_ && current->left && current->left != nil_) {
-            current = current->left;
-        }
-        return current;
-    };
-
-    auto nextInOrder = [this, &leftMost](std::shared_ptr<RBNode> current) {
-        if (!current || current == nil_) {
-            return std::shared_ptr<RBNode>(nullptr);
-        }
-
-        if (current->right && current->right != nil_) {
-            return leftMost(current->right);
+    auto nextInOrder = [this](std::shared_ptr<RBNode> node) {
+        if (node->right != nil_) {
+            node = node->right;
+            while (node->left != nil_) {
+                node = node->left;
+            }
+            return node;
         }
-
-        auto child = current;
-        auto parent = current->parent;
-        while (parent && parent != nil_ && child == parent->right) {
-            child = parent;
+        auto parent = node->parent;
+        while (parent && node == parent->right) {
+            node = parent;
             parent = parent->parent;
         }
-
-        if (!parent || parent == nil_) {
-            return std::shared_ptr<RBNode>(nullptr);
-        }
         return parent;
     };
 
+    // 整段删掉的片段只置为空片段（不改变树形），空片段过多时整体重建；
+    // 部分删除就地裁剪片段，区间落在片段中间时拆出右半片段
     size_t remaining = length;
-    size_t current_offset = start_offset;
-    std::shared_ptr<RBNode> current = start_node;
-
-    while (current && current != nil_ && remaining > 0) {
-        size_t node_remaining = current->piece.length - current_offset;
-        size_t to_remove = std::min(remaining, node_remaining);
-
-        if (current_offset == 0 && to_remove == current->piece.length) {
-            nodes_to_modify.push_back(current);
+    while (current && remaining > 0) {
+        Piece& piece = current->piece;
+        size_t to_remove = std::min(remaining, piece.length - current_offset);
+
+        if (to_remove == 0) {
+            // 已清空的片段
+        } else if (current_offset == 0 && to_remove == piece.length) {
+            piece.length = 0;
+            ++empty_nodes_;
+            propagateUp(current);
         } else if (current_offset == 0) {
-            Piece modified = current->piece;
-            modified.start += to_remove;
-            modified.length -= to_remove;
-            new_pieces.push_back({current, modified});
-        } else if (to_remove == node_remaining) {
-            Piece modified = current->piece;
-            modified.length = current_offset;
-            new_pieces.push_back({current, modified});
+            piece.start += to_remove;
+            piece.length -= to_remove;
+            propagateUp(current);
+        } else if (current_offset + to_remove == piece.length) {
+            piece.length = current_offset;
+            propagateUp(current);
         } else {
-            Piece left_part(current->piece.buffer_type, current->piece.start, current_offset);
-            Piece right_part(current->piece.buffer_type,
-                             current->piece.start + current_offset + to_remove,
-                             current->piece.length - current_offset - to_remove);
-            new_pieces.push_back({current, left_part});
-            if (right_part.length > 0) {
-                auto right_node = std::make_shared<RBNode>(right_part);
-                right_node->left = nil_;
-                right_node->right = current->right;
-                right_node->parent = current;
-                if (current->right != nil_) {
-                    current->right->parent = right_node;
-                }
-                current->right = right_node;
-                current->piece = left_part;
-                updateNodeInfo(right_node);
-            } else {
-                Piece modified = current->piece;
-                modified.length = current_offset;
-                new_pieces.push_back({current, modified});
-            }
+            auto right_node = makeNode(piece.buffer_type, piece.start + current_offset + to_remove,
+                                       piece.length - current_offset - to_remove);
+            piece.length = current_offset;
+            attachNode(current, right_node, false);
         }
 
         remaining -= to_remove;
@@ -358,66 +370,76 @@ void PieceTable::remove(size_t pos, size_t length) {
         }
     }
 
-    for (auto& node : nodes_to_modify) {
-        if (node->parent) {
-            std::shared_ptr<RBNode> replacement = nil_;
-            if (node->left != nil_ && node->right != nil_) {
-                std::shared_ptr<RBNode> successor = leftMost(node->right);
-                if (successor->parent != node) {
-                    successor->parent->left = successor->right;
-                    if (successor->right != nil_) {
-                        successor->right->parent = successor->parent;
-                    }
-                    successor->right = node->right;
-                    successor->right->parent = successor;
-                }
-                successor->left = node->left;
-                successor->left->parent = successor;
-                successor->parent = node->parent;
-                successor->color = node->color;
-                replacement = successor;
-            } else if (node->left != nil_) {
-                replacement = node->left;
-                replacement->parent = node->parent;
-                replacement->color = node->color;
-            } else if (node->right != nil_) {
-                replacement = node->right;
-                replacement->parent = node->parent;
-                replacement->color = node->color;
-            } else {
-                replacement = nil_;
-            }
+    total_length_ -= length;
+    lines_dirty_ = true;
 
-            if (!node->parent) {
-                root_ = replacement;
-            } else if (node == node->parent->left) {
-                node->parent->left = replacement;
-            } else {
-                node->parent->right = replacement;
-            }
+    if (empty_nodes_ > 64 && empty_nodes_ * 2 > node_count_) {
+        rebuildTree();
+    }
+}
 
-            if (replacement != nil_) {
-                updateNodeInfo(replacement);
-                std::shared_ptr<RBNode> ancestor = replacement->parent;
-                while (ancestor) {
-                    updateNodeInfo(ancestor);
-                    ancestor = ancestor->parent;
-                }
-            }
+void PieceTable::releaseTree() {
+    // 节点间以 shared_ptr 双向引用，丢弃整棵树前先断开 parent 以免环引用泄漏
+    if (!root_ || root_ == nil_)
+        return;
+
+    std::vector<std::shared_ptr<RBNode>> stack{root_};
+    while (!stack.empty()) {
+        auto node = stack.back();
+        stack.pop_back();
+        node->parent.reset();
+        if (node->left && node->left != nil_) {
+            stack.push_back(node->left);
+        }
+        if (node->right && node->right != nil_) {
+            stack.push_back(node->right);
         }
     }
+    root_ = nil_;
+}
 
-    for (auto& [node, piece] : new_pieces) {
-        node->piece = piece;
-        std::shared_ptr<RBNode> current = node;
-        while (current) {
-            updateNodeInfo(current);
-            current = current->parent;
+void PieceTable::rebuildTree() {
+    std::vector<Piece> pieces;
+    pieces.reserve(node_count_ - empty_nodes_);
+    traverseInOrder(root_, [&pieces](const Piece& piece) {
+        if (piece.length > 0) {
+            pieces.push_back(piece);
         }
+    });
+    releaseTree();
+
+    // 按中点递归建成满二叉形态：前 full_depth 层全黑，最后一层（不满）为红，黑高一致
+    size_t full_depth = 0;
+    while ((size_t(1) << (full_depth + 1)) - 1 <= pieces.size()) {
+        ++full_depth;
     }
+    std::function<std::shared_ptr<RBNode>(size_t, size_t, size_t)> build =
+        [&](size_t lo, size_t hi, size_t depth) {
+            if (lo >= hi) {
+                return nil_;
+            }
+            size_t mid = lo + (hi - lo) / 2;
+            auto node = std::make_shared<RBNode>(pieces[mid]);
+            node->color = depth >= full_depth ? 0 : 1;
+            node->left = build(lo, mid, depth + 1);
+            node->right = build(mid + 1, hi, depth + 1);
+            if (node->left != nil_) {
+                node->left->parent = node;
+            }
+            if (node->right != nil_) {
+                node->right->parent = node;
+            }
+            updateNodeInfo(node);
+            return node;
+        };
 
-    total_length_ -= length;
-    lines_dirty_ = true;
+    root_ = build(0, pieces.size(), 0);
+    if (root_ != nil_) {
+        root_->parent = nullptr;
+        root_->color = 1;
+    }
+    node_count_ = pieces.size();
+    empty_nodes_ = 0;
 }
 
 std::string PieceTable::getText(size_t pos, size_t length) const {
@@ -528,13 +550,11 @@ std::string PieceTable::getLine(size_t line_num) const {
         return "";
 
     size_t start = findLineStart(line_num);
-    size_t end = findLineStart(line_num + 1);
-
-    if (end > start && end <= total_length_) {
-        return getText(start, end - start - 1);
+    if (line_num + 1 >= lineCount()) {
+        return getText(start, total_length_ - start);
     }
-
-    return getText(start, total_length_ - start);
+    size_t end = findLineStart(line_num + 1);
+    return getText(start, end - start - 1);
 }
 
 size_t PieceTable::lineCount() const {
@@ -545,17 +565,11 @@ size_t PieceTable::lineCount() const {
 }
 
 void PieceTable::recomputeLineCount() const {
+    // 根节点的子树换行数即全文换行数，无需遍历片段
     line_count_ = 1;
-
-    traverseInOrder(root_, [this](const Piece& piece) {
-        const std::string& buffer =
-            piece.buffer_type == BufferType::ORIGINAL ? original_buffer_ : append_buffer_;
-        for (size_t i = 0; i < piece.length && piece.start + i < buffer.size(); ++i) {
-            if (buffer[piece.start + i] == '\n') {
-                line_count_++;
-            }
-        }
-    });
+    if (root_ && root_ != nil_) {
+        line_count_ += root_->subtree_newlines;
+    }
 
     lines_dirty_ = false;
 }
@@ -577,21 +591,15 @@ size_t PieceTable::findLineStart(size_t line_num) const {
             current_line += left_newlines;
             pos += (current->left != nil_) ? current->left->subtree_length : 0;
 
-            const std::string& buffer = (current->piece.buffer_type == BufferType::ORIGINAL)
-                                            ? original_buffer_
-                                            : append_buffer_;
-
-            size_t piece_pos = 0;
-            for (size_t i = 0; i < current->piece.length && current_line < line_num; ++i) {
-                if (current->piece.start + i < buffer.size() &&
-                    buffer[current->piece.start + i] == '\n') {
-                    current_line++;
-                    if (current_line == line_num) {
-                        return pos + piece_pos + 1;
-                    }
-                }
-                piece_pos++;
+            // 目标行首落在本片段内时，直接从缓冲区换行索引取第 k 个换行
+            size_t piece_newlines = countNewlines(current->piece);
+            if (current_line + piece_newlines >= line_num) {
+                const std::vector<size_t>& index = newlinesOf(current->piece.buffer_type);
+                auto first = std::lower_bound(index.begin(), index.end(), current->piece.start);
+                size_t newline = first[static_cast<std::ptrdiff_t>(line_num - current_line - 1)];
+                return pos + (newline - current->piece.start) + 1;
             }
+            current_line += piece_newlines;
             pos += current->piece.length;
             current = current->right;
         }
@@ -652,20 +660,17 @@ size_t PieceTable::lineLength(size_t line_num) const {
         return 0;
 
     size_t start = findLineStart(line_num);
-    size_t end = findLineStart(line_num + 1);
-
-    if (end > start && end <= total_length_) {
-        return end - start - 1;
+    if (line_num + 1 >= lineCount()) {
+        return total_length_ - start;
     }
-
-    return total_length_ - start;
+    return findLineStart(line_num + 1) - start - 1;
 }
 
 size_t PieceTable::positionToLineCol(size_t pos) const {
     if (pos > total_length_)
         pos = total_length_;
 
-    size_t line = 0, col = 0;
+    size_t line = 0;
     size_t current_pos = 0;
     std::shared_ptr<RBNode> current = root_;
 
@@ -678,24 +683,18 @@ size_t PieceTable::positionToLineCol(size_t pos) const {
             line += (current->left != nil_) ? current->left->subtree_newlines : 0;
             current_pos += left_len;
 
-            const std::string& buffer = (current->piece.buffer_type == BufferType::ORIGINAL)
-                                            ? original_buffer_
-                                            : append_buffer_;
-
             size_t take = std::min(pos - current_pos, current->piece.length);
-            for (size_t i = 0; i < take && current->piece.start + i < buffer.size(); ++i) {
-                if (buffer[current->piece.start + i] == '\n') {
-                    line++;
-                    col = 0;
-                } else {
-                    col++;
-                }
-            }
+            const std::vector<size_t>& index = newlinesOf(current->piece.buffer_type);
+            auto first = std::lower_bound(index.begin(), index.end(), current->piece.start);
+            auto last = std::lower_bound(first, index.end(), current->piece.start + take);
+            line += static_cast<size_t>(last - first);
             current_pos += take;
             current = current->right;
         }
     }
 
+    // 列号相对行首计算，左子树里的换行也会被正确计入
+    size_t col = pos - findLineStart(line);
     return encodeLineCol(line, col);
 }
 
@@ -703,57 +702,13 @@ size_t PieceTable::lineColToPosition(size_t line, size_t col) const {
     if (!root_ || root_ == nil_)
         return 0;
 
-    size_t current_line = 0;
-    size_t pos = 0;
-    std::shared_ptr<RBNode> current = root_;
-
-    while (current && current != nil_ && current_line < line) {
-        size_t left_newlines = (current->left != nil_) ? current->left->subtree_newlines : 0;
-
-        if (current_line + left_newlines >= line) {
-            current = current->left;
-        } else {
-            current_line += left_newlines;
-            pos += (current->left != nil_) ? current->left->subtree_length : 0;
-
-            const std::string& buffer = (current->piece.buffer_type == BufferType::ORIGINAL)
-                                            ? original_buffer_
-                                            : append_buffer_;
-
-            size_t piece_pos = 0;
-            for (size_t i = 0;
-                 i < current->piece.length && current->piece.start + i < buffer.size(); ++i) {
-                if (buffer[current->piece.start + i] == '\n') {
-                    current_line++;
-                    if (current_line >= line) {
-                        break;
-                    }
-                }
-                piece_pos++;
-            }
-            pos += piece_pos;
-            current = current->right;
-        }
-    }
-
-    // 现在 current_line == line，向前移动 col 个字符
-    while (current && current != nil_ && col > 0) {
-        const std::string& buffer = (current->piece.buffer_type == BufferType::ORIGINAL)
-                                        ? original_buffer_
-                                        : append_buffer_;
-
-        for (size_t i = 0;
-             i < current->piece.length && current->piece.start + i < buffer.size() && col > 0;
-             ++i) {
-            if (buffer[current->piece.start + i] == '\n') {
-                break;
-            }
-            pos++;
-            col--;
-        }
-        current = current->right;
+    // 行首由 findLineStart 沿子树换行计数下降得到；行内按中序读取，不越过换行符
+    size_t pos = findLineStart(line);
+    if (col > 0) {
+        std::string rest = getText(pos, col);
+        size_t newline = rest.find('\n');
+        pos += (newline == std::string::npos) ? rest.size() : newline;
     }
-
     return pos;
 }
 
@@ -765,16 +720,14 @@ bool PieceTable::loadFromFile(const std::string& filepath) {
     std::streamsize size = file.tellg();
     file.seekg(0, std::ios::beg);
 
+    clear();
     if (size <= 0) {
-        original_buffer_.clear();
-        append_buffer_.clear();
-        root_ = nil_;
-        total_length_ = 0;
         return true;
     }
 
     original_buffer_.resize(size);
     file.read(&original_buffer_[0], size);
+    indexNewlines(original_newlines_, original_buffer_, 0);
 
     // 创建初始片段
     Piece initial_piece(BufferType::ORIGINAL, 0, size);
@@ -782,6 +735,7 @@ bool PieceTable::loadFromFile(const std::string& filepath) {
     root_->left = nil_;
     root_->right = nil_;
     root_->color = 1;
+    node_count_ = 1;
 
     total_length_ = size;
     lines_dirty_ = true;
@@ -809,8 +763,10 @@ size_t PieceTable::getMemoryUsage() const {
 }
 
 void PieceTable::optimize() {
-    // 合并相邻的片段（如果它们来自同一个缓冲区且连续）
-    // 这是一个简化的实现
+    // 清理空片段并重新平衡；连续输入在插入时已合并到同一片段
+    if (empty_nodes_ > 0) {
+        rebuildTree();
+    }
 }
 
 } // namespace core
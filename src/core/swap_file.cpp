@@ -0,0 +1,563 @@
+#include "core/swap_file.h"
+#include "core/document.h"
+#include "core/document_snapshot.h"
+#include "core/record_codec.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace pnana {
+namespace core {
+
+namespace {
+
+// v2 在文件头末尾追加写入者的 pid 与主机名；v1 文件仍可恢复
+constexpr char MAGIC_V1[] = "PNANASW1";
+constexpr char MAGIC[] = "PNANASW2";
+constexpr size_t MAGIC_SIZE = sizeof(MAGIC) - 1;
+constexpr size_t HEADER_PROBE_SIZE = 4096;
+constexpr char RECORD_EDIT = 'E';
+constexpr char RECORD_CHECKPOINT = 'C';
+constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(500);
+constexpr size_t CHECKPOINT_WRITE_CHUNK = 1024 * 1024;
+
+// 原文件的身份：大小 + 修改时间；文件不存在时 size 为 0、exists 为 false
+struct FileStamp {
+    bool exists = false;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+
+    bool operator==(const FileStamp& other) const {
+        return exists == other.exists && size == other.size && mtime == other.mtime;
+    }
+};
+
+FileStamp stampOf(const std::string& filepath) {
+    FileStamp stamp;
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(filepath, ec);
+    if (ec) {
+        return stamp;
+    }
+    auto mtime = std::filesystem::last_write_time(filepath, ec);
+    if (ec) {
+        return stamp;
+    }
+    stamp.exists = true;
+    stamp.size = size;
+    stamp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return stamp;
+}
+
+uint32_t fnv1a(uint32_t hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+constexpr uint32_t FNV_OFFSET = 2166136261u;
+
+void putChecksum(std::string& out, uint32_t checksum) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((checksum >> (8 * i)) & 0xFF));
+    }
+}
+
+uint32_t readChecksum(const char* data) {
+    uint32_t checksum = 0;
+    for (int i = 0; i < 4; ++i) {
+        checksum |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    return checksum;
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string hostName() {
+    char name[256] = {};
+    if (::gethostname(name, sizeof(name) - 1) != 0) {
+        return "";
+    }
+    return name;
+}
+
+// 解析文件头，end 为第一条记录的偏移；owner 取得写入者（v1 文件为空）
+bool parseHeader(const std::string& data, FileStamp& stamp, SwapFile::Probe& owner,
+                 size_t& end) {
+    if (data.size() < MAGIC_SIZE) {
+        return false;
+    }
+    const bool v2 = data.compare(0, MAGIC_SIZE, MAGIC) == 0;
+    if (!v2 && data.compare(0, MAGIC_SIZE, MAGIC_V1) != 0) {
+        return false;
+    }
+    RecordReader reader(data.data() + MAGIC_SIZE, data.size() - MAGIC_SIZE);
+    uint64_t exists = 0;
+    uint64_t mtime = 0;
+    std::string path;
+    if (!reader.varint(exists) || !reader.varint(stamp.size) || !reader.varint(mtime) ||
+        !reader.string(path)) {
+        return false;
+    }
+    uint64_t pid = 0;
+    if (v2 && (!reader.varint(pid) || !reader.string(owner.host))) {
+        return false;
+    }
+    owner.pid = static_cast<int64_t>(pid);
+    stamp.exists = exists != 0;
+    stamp.mtime = static_cast<int64_t>(mtime);
+    end = MAGIC_SIZE + reader.position();
+    return true;
+}
+
+// 读取文件开头：头部 + 第一条记录的开头足以判断所有权与可恢复性
+std::string readHead(int fd) {
+    std::string data(HEADER_PROBE_SIZE, '\0');
+    ssize_t n = ::pread(fd, &data[0], data.size(), 0);
+    data.resize(n > 0 ? static_cast<size_t>(n) : 0);
+    return data;
+}
+
+// 对交换文件加锁（LOCK_SH / LOCK_EX，非阻塞）；被其他进程持有时返回 false。
+// 文件系统不支持 flock 时退回检查文件头记录的写入者在本机是否仍存活
+bool tryLock(int fd, int operation) {
+    if (::flock(fd, operation | LOCK_NB) == 0) {
+        return true;
+    }
+    if (errno == EWOULDBLOCK) {
+        return false;
+    }
+    FileStamp stamp;
+    SwapFile::Probe owner;
+    size_t end = 0;
+    if (!parseHeader(readHead(fd), stamp, owner, end) || owner.pid <= 0 ||
+        owner.host != hostName()) {
+        return true;
+    }
+    return ::kill(static_cast<pid_t>(owner.pid), 0) != 0 && errno == ESRCH;
+}
+
+// 取出 pos 处完整且校验通过的记录并前移 pos；截断或损坏时返回 false
+bool nextRecord(const std::string& data, size_t& pos, std::string& payload) {
+    RecordReader reader(data.data() + pos, data.size() - pos);
+    size_t length = 0;
+    if (!reader.size(length) || length == 0 || reader.remaining() < length ||
+        reader.remaining() - length < 4) {
+        return false;
+    }
+    const char* record = data.data() + pos + reader.position();
+    if (fnv1a(FNV_OFFSET, record, length) != readChecksum(record + length)) {
+        return false;
+    }
+    payload.assign(record, length);
+    pos += reader.position() + length + 4;
+    return true;
+}
+
+// 与 Document::logEdit 的语义一致：[start, end) 替换为 text（text 中的 \n 分行）
+void applyEdit(std::vector<std::string>& lines, size_t start_row, size_t start_col,
+               size_t end_row, size_t end_col, const std::string& text) {
+    if (lines.empty()) {
+        lines.push_back("");
+    }
+    start_row = std::min(start_row, lines.size() - 1);
+    end_row = std::min(std::max(end_row, start_row), lines.size() - 1);
+    start_col = std::min(start_col, lines[start_row].size());
+    end_col = std::min(end_col, lines[end_row].size());
+    if (start_row == end_row) {
+        end_col = std::max(end_col, start_col);
+    }
+
+    std::vector<std::string> parts;
+    size_t begin = 0;
+    while (true) {
+        size_t newline = text.find('\n', begin);
+        if (newline == std::string::npos) {
+            parts.push_back(text.substr(begin));
+            break;
+        }
+        parts.push_back(text.substr(begin, newline - begin));
+        begin = newline + 1;
+    }
+    parts.front().insert(0, lines[start_row], 0, start_col);
+    parts.back().append(lines[end_row], end_col, std::string::npos);
+
+    lines.erase(lines.begin() + start_row, lines.begin() + end_row + 1);
+    lines.insert(lines.begin() + start_row, std::make_move_iterator(parts.begin()),
+                 std::make_move_iterator(parts.end()));
+}
+
+bool applyRecord(const std::string& payload, std::vector<std::string>& lines) {
+    RecordReader reader(payload.data() + 1, payload.size() - 1);
+    if (payload[0] == RECORD_EDIT) {
+        size_t start_row = 0;
+        size_t start_col = 0;
+        size_t end_row = 0;
+        size_t end_col = 0;
+        std::string text;
+        if (!reader.size(start_row) || !reader.size(start_col) || !reader.size(end_row) ||
+            !reader.size(end_col) || !reader.string(text)) {
+            return false;
+        }
+        applyEdit(lines, start_row, start_col, end_row, end_col, text);
+        return true;
+    }
+    if (payload[0] == RECORD_CHECKPOINT) {
+        size_t count = 0;
+        if (!reader.size(count) || count > reader.remaining()) {
+            return false;
+        }
+        std::vector<std::string> restored(count);
+        for (auto& line : restored) {
+            if (!reader.string(line)) {
+                return false;
+            }
+        }
+        if (restored.empty()) {
+            restored.push_back("");
+        }
+        lines = std::move(restored);
+        return true;
+    }
+    return false;
+}
+
+bool readFile(const std::string& path, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+} // namespace
+
+SwapFile::~SwapFile() {
+    if (writer_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        writer_.join();
+    }
+    // path_ 只在持有锁时非空；先删除再关闭，避免其他进程在两者之间拿到锁
+    if (!path_.empty()) {
+        std::remove(path_.c_str());
+        std::remove((path_ + ".tmp").c_str());
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+std::string SwapFile::pathFor(const std::string& filepath) {
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(filepath, ec);
+    std::string key = ec ? filepath : absolute.lexically_normal().string();
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (char ch : key) {
+        hash ^= static_cast<uint8_t>(ch);
+        hash *= 1099511628211ULL;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+
+    const char* home = std::getenv("HOME");
+    std::filesystem::path dir =
+        std::filesystem::path(home ? home : ".") / ".config" / "pnana" / "swap";
+    return (dir / (std::filesystem::path(key).filename().string() + "." + hex + ".swp")).string();
+}
+
+bool SwapFile::open(const std::string& filepath, std::shared_ptr<const DocumentSnapshot> initial) {
+    path_ = pathFor(filepath);
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path_).parent_path(), ec);
+
+    FileStamp stamp = stampOf(filepath);
+    header_.assign(MAGIC, MAGIC_SIZE);
+    putVarint(header_, stamp.exists ? 1 : 0);
+    putVarint(header_, stamp.size);
+    putVarint(header_, static_cast<uint64_t>(stamp.mtime));
+    putString(header_, filepath);
+    putVarint(header_, static_cast<uint64_t>(::getpid()));
+    putString(header_, hostName());
+
+    // 先锁住已有的（或新建的空）交换文件，拿到锁之前不截断、不替换
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd_ < 0) {
+        LOG_WARNING("[SWAP] cannot create swap file " + path_);
+        path_.clear();
+        return false;
+    }
+    if (!tryLock(fd_, LOCK_EX)) {
+        LOG_WARNING("[SWAP] " + path_ + " is in use by another process, crash recovery disabled");
+        ::close(fd_);
+        fd_ = -1;
+        path_.clear();
+        return false;
+    }
+
+    if (initial) {
+        // 由写线程的第一个检查点原子替换，遗留的交换文件在此之前保持可恢复
+        checkpoint_ = std::move(initial);
+    } else if (::ftruncate(fd_, 0) != 0 || !writeAll(fd_, header_.data(), header_.size())) {
+        LOG_WARNING("[SWAP] cannot create swap file " + path_);
+        std::remove(path_.c_str());
+        ::close(fd_);
+        fd_ = -1;
+        path_.clear();
+        return false;
+    }
+    writer_ = std::thread([this]() {
+        writerLoop();
+    });
+    return true;
+}
+
+void SwapFile::appendRecord(const std::string& payload) {
+    std::string record;
+    putVarint(record, payload.size());
+    record += payload;
+    putChecksum(record, fnv1a(FNV_OFFSET, payload.data(), payload.size()));
+    journal_bytes_ += record.size();
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ += record;
+        wake = pending_.size() >= FLUSH_BYTES;
+    }
+    if (wake) {
+        cv_.notify_one();
+    }
+}
+
+void SwapFile::appendEdit(const TextEdit& edit) {
+    if (failed_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::string payload(1, RECORD_EDIT);
+    putVarint(payload, edit.start_row);
+    putVarint(payload, edit.start_col);
+    putVarint(payload, edit.end_row);
+    putVarint(payload, edit.end_col);
+    putString(payload, edit.text);
+    appendRecord(payload);
+}
+
+void SwapFile::checkpoint(std::shared_ptr<const DocumentSnapshot> snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        checkpoint_ = std::move(snapshot);
+    }
+    journal_bytes_ = 0;
+    cv_.notify_one();
+}
+
+void SwapFile::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait_for(lock, FLUSH_INTERVAL, [this]() {
+            return stop_ || checkpoint_ || pending_.size() >= FLUSH_BYTES;
+        });
+        // 关闭即删除文件，未写入的数据不再落盘
+        if (stop_) {
+            return;
+        }
+        std::shared_ptr<const DocumentSnapshot> snapshot = std::move(checkpoint_);
+        checkpoint_.reset();
+        std::string batch;
+        batch.swap(pending_);
+        lock.unlock();
+
+        if (!failed_.load(std::memory_order_relaxed)) {
+            bool ok = true;
+            if (snapshot) {
+                ok = writeCheckpoint(*snapshot);
+            }
+            if (ok && !batch.empty()) {
+                ok = writeAll(fd_, batch.data(), batch.size()) && ::fdatasync(fd_) == 0;
+            }
+            if (!ok) {
+                LOG_WARNING("[SWAP] write failed, crash recovery disabled for " + path_);
+                failed_.store(true, std::memory_order_relaxed);
+            }
+        }
+        lock.lock();
+    }
+}
+
+bool SwapFile::writeCheckpoint(const DocumentSnapshot& snapshot) {
+    // 写入临时文件后原子替换：任何时刻磁盘上都有一份完整可恢复的交换文件
+    std::string tmp_path = path_ + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    // 替换前锁住新文件，rename 之后交换文件始终处于本进程的锁下
+    if (!tryLock(fd, LOCK_EX)) {
+        ::close(fd);
+        return false;
+    }
+
+    std::string prefix;
+    putVarint(prefix, snapshot.lineCount());
+    size_t payload_size = 1 + prefix.size();
+    for (size_t i = 0; i < snapshot.lineCount(); ++i) {
+        const std::string& line = snapshot.line(i);
+        std::string length;
+        putVarint(length, line.size());
+        payload_size += length.size() + line.size();
+    }
+
+    std::string buffer = header_;
+    putVarint(buffer, payload_size);
+    size_t payload_start = buffer.size();
+    buffer.push_back(RECORD_CHECKPOINT);
+    buffer += prefix;
+
+    // 逐行流式写出，校验和随写随算，不拼接整份文档
+    uint32_t checksum = FNV_OFFSET;
+    bool ok = true;
+    auto flush = [&](size_t from) {
+        checksum = fnv1a(checksum, buffer.data() + from, buffer.size() - from);
+        ok = ok && writeAll(fd, buffer.data(), buffer.size());
+        buffer.clear();
+    };
+    size_t from = payload_start;
+    for (size_t i = 0; i < snapshot.lineCount() && ok; ++i) {
+        putString(buffer, snapshot.line(i));
+        if (buffer.size() >= CHECKPOINT_WRITE_CHUNK) {
+            flush(from);
+            from = 0;
+        }
+    }
+    flush(from);
+    putChecksum(buffer, checksum);
+    ok = ok && writeAll(fd, buffer.data(), buffer.size()) && ::fdatasync(fd) == 0;
+
+    if (!ok || std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+        ::close(fd);
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = fd;
+    return true;
+}
+
+SwapFile::Probe SwapFile::probe(const std::string& filepath) {
+    Probe result;
+    int fd = ::open(pathFor(filepath).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return result;
+    }
+    std::string data = readHead(fd);
+    FileStamp stamp;
+    size_t pos = 0;
+    bool parsed = parseHeader(data, stamp, result, pos);
+    // 共享锁只为探测写入者是否存活，关闭即释放
+    bool in_use = parsed && !tryLock(fd, LOCK_SH);
+    ::close(fd);
+    if (!parsed) {
+        return Probe{};
+    }
+    if (in_use) {
+        result.state = State::IN_USE;
+        return result;
+    }
+
+    RecordReader reader(data.data() + pos, data.size() - pos);
+    size_t length = 0;
+    if (!reader.size(length) || length == 0 || reader.remaining() == 0) {
+        return result;
+    }
+    char type = data[pos + reader.position()];
+    if (type == RECORD_CHECKPOINT || (type == RECORD_EDIT && stamp == stampOf(filepath))) {
+        result.state = State::RECOVERABLE;
+    }
+    return result;
+}
+
+bool SwapFile::replay(const std::string& filepath, std::vector<std::string>& lines,
+                      size_t* applied) {
+    std::string data;
+    FileStamp stamp;
+    Probe owner;
+    size_t pos = 0;
+    if (!readFile(pathFor(filepath), data) || !parseHeader(data, stamp, owner, pos)) {
+        return false;
+    }
+
+    std::string payload;
+    size_t count = 0;
+    std::vector<std::string> result;
+    while (nextRecord(data, pos, payload)) {
+        if (count == 0) {
+            // 第一条不是检查点时，编辑记录只对写入时的原文件有效
+            if (payload[0] != RECORD_CHECKPOINT && !(stamp == stampOf(filepath))) {
+                LOG_WARNING("[SWAP] " + filepath + " changed on disk, swap file ignored");
+                return false;
+            }
+            result = lines;
+        }
+        if (!applyRecord(payload, result)) {
+            break;
+        }
+        ++count;
+    }
+    if (applied) {
+        *applied = count;
+    }
+    if (count == 0) {
+        return false;
+    }
+    lines = std::move(result);
+    return true;
+}
+
+void SwapFile::remove(const std::string& filepath) {
+    std::string path = pathFor(filepath);
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    if (tryLock(fd, LOCK_EX)) {
+        std::remove(path.c_str());
+        std::remove((path + ".tmp").c_str());
+    } else {
+        LOG_WARNING("[SWAP] " + path + " is in use by another process, not removed");
+    }
+    ::close(fd);
+}
+
+} // namespace core
+} // namespace pnana
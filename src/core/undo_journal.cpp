@@ -0,0 +1,244 @@
+#include "core/undo_journal.h"
+#include "core/document.h"
+#include "core/record_codec.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace pnana {
+namespace core {
+
+namespace {
+
+// old/new 的差异编码：公共前缀、公共后缀各存一次，中间部分分别存
+void putDelta(std::string& out, const std::string& old_content, const std::string& new_content) {
+    size_t limit = std::min(old_content.size(), new_content.size());
+    size_t prefix = 0;
+    while (prefix < limit && old_content[prefix] == new_content[prefix]) {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < limit - prefix &&
+           old_content[old_content.size() - 1 - suffix] ==
+               new_content[new_content.size() - 1 - suffix]) {
+        ++suffix;
+    }
+    putString(out, old_content.data(), prefix);
+    putString(out, old_content.data() + old_content.size() - suffix, suffix);
+    putString(out, old_content.data() + prefix, old_content.size() - prefix - suffix);
+    putString(out, new_content.data() + prefix, new_content.size() - prefix - suffix);
+}
+
+bool readDelta(RecordReader& reader, std::string& old_content, std::string& new_content) {
+    std::string prefix;
+    std::string suffix;
+    std::string old_mid;
+    std::string new_mid;
+    if (!reader.string(prefix) || !reader.string(suffix) || !reader.string(old_mid) ||
+        !reader.string(new_mid)) {
+        return false;
+    }
+    old_content = prefix + old_mid + suffix;
+    new_content = prefix + new_mid + suffix;
+    return true;
+}
+
+} // namespace
+
+UndoJournal::~UndoJournal() {
+    unmap();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool UndoJournal::ensureOpen() {
+    if (fd_ >= 0) {
+        return true;
+    }
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+    if (ec) {
+        dir = "/tmp";
+    }
+    std::string path = (dir / "pnana-undo-XXXXXX").string();
+    fd_ = ::mkstemp(&path[0]);
+    if (fd_ < 0) {
+        return false;
+    }
+    // 立即 unlink：文件只通过 fd 访问，进程退出（包括崩溃）后由系统回收
+    ::unlink(path.c_str());
+    return true;
+}
+
+void UndoJournal::unmap() {
+#ifdef __linux__
+    if (map_) {
+        ::munmap(map_, map_size_);
+    }
+#endif
+    map_ = nullptr;
+    map_size_ = 0;
+}
+
+bool UndoJournal::spill(const DocumentChange& change) {
+    if (!ensureOpen()) {
+        return false;
+    }
+    scratch_.clear();
+    encode(change, scratch_);
+
+    size_t written = 0;
+    while (written < scratch_.size()) {
+        ssize_t n = ::pwrite(fd_, scratch_.data() + written, scratch_.size() - written,
+                             static_cast<off_t>(end_ + written));
+        if (n <= 0) {
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    records_.push_back({end_, scratch_.size()});
+    end_ += scratch_.size();
+    return true;
+}
+
+bool UndoJournal::readSpan(const Span& span, std::string& out) {
+#ifdef __linux__
+    // 映射覆盖到当前有效末尾；pwrite 写入同一页缓存，已映射的部分直接可见
+    if (span.offset + span.length > map_size_) {
+        unmap();
+        size_t length = static_cast<size_t>(std::max(end_, span.offset + span.length));
+        void* addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd_, 0);
+        if (addr != MAP_FAILED) {
+            map_ = static_cast<char*>(addr);
+            map_size_ = length;
+        }
+    }
+    if (map_ && span.offset + span.length <= map_size_) {
+        out.assign(map_ + span.offset, static_cast<size_t>(span.length));
+        return true;
+    }
+#endif
+    out.resize(static_cast<size_t>(span.length));
+    size_t done = 0;
+    while (done < out.size()) {
+        ssize_t n = ::pread(fd_, &out[done], out.size() - done,
+                            static_cast<off_t>(span.offset + done));
+        if (n <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool UndoJournal::restore(DocumentChange& out) {
+    if (records_.empty() || fd_ < 0) {
+        return false;
+    }
+    Span span = records_.back();
+    records_.pop_back();
+    // 该记录之后的空间由下一次 spill 复用
+    end_ = span.offset;
+    if (!readSpan(span, scratch_)) {
+        return false;
+    }
+    return decode(scratch_.data(), scratch_.size(), out);
+}
+
+void UndoJournal::clear() {
+    records_.clear();
+    end_ = 0;
+    unmap();
+    if (fd_ >= 0) {
+        // 截断释放磁盘空间；fd 保留以便下次复用
+        if (::ftruncate(fd_, 0) != 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+}
+
+void UndoJournal::encode(const DocumentChange& change, std::string& out) {
+    out.push_back(static_cast<char>(change.type));
+    out.push_back(static_cast<char>(change.line_ending));
+    putVarint(out, change.row);
+    putVarint(out, change.col);
+    putVarint(out, change.target_row);
+    putVarint(out, change.content_size);
+    putDelta(out, change.old_content, change.new_content);
+    putString(out, change.after_cursor);
+
+    // DELETE 的 restored_lines 只是 old_content 按行切分的结果，撤销时可重新切分，不落盘
+    if (change.type == DocumentChange::Type::DELETE) {
+        putVarint(out, 0);
+    } else {
+        putVarint(out, change.restored_lines.size());
+        for (const auto& line : change.restored_lines) {
+            putString(out, line);
+        }
+    }
+
+    putVarint(out, change.group_edits.size());
+    for (size_t i = 0; i < change.group_edits.size(); ++i) {
+        const TextEdit& edit = change.group_edits[i];
+        putVarint(out, edit.start_row);
+        putVarint(out, edit.start_col);
+        putVarint(out, edit.end_row);
+        putVarint(out, edit.end_col);
+        const std::string& removed =
+            i < change.group_removed.size() ? change.group_removed[i] : std::string();
+        putDelta(out, removed, edit.text);
+    }
+}
+
+bool UndoJournal::decode(const char* data, size_t size, DocumentChange& out) {
+    if (size < 2) {
+        return false;
+    }
+    out.type = static_cast<DocumentChange::Type>(static_cast<uint8_t>(data[0]));
+    out.line_ending = static_cast<LineEnding>(static_cast<uint8_t>(data[1]));
+    // 取回的记录不再参与连续输入合并
+    out.timestamp = std::chrono::steady_clock::time_point{};
+
+    RecordReader reader(data + 2, size - 2);
+    size_t count = 0;
+    if (!reader.size(out.row) || !reader.size(out.col) || !reader.size(out.target_row) ||
+        !reader.size(out.content_size) ||
+        !readDelta(reader, out.old_content, out.new_content) ||
+        !reader.string(out.after_cursor) || !reader.size(count)) {
+        return false;
+    }
+
+    out.restored_lines.assign(count, std::string());
+    for (auto& line : out.restored_lines) {
+        if (!reader.string(line)) {
+            return false;
+        }
+    }
+
+    if (!reader.size(count)) {
+        return false;
+    }
+    out.group_edits.assign(count, TextEdit{});
+    out.group_removed.assign(count, std::string());
+    for (size_t i = 0; i < count; ++i) {
+        TextEdit& edit = out.group_edits[i];
+        if (!reader.size(edit.start_row) || !reader.size(edit.start_col) ||
+            !reader.size(edit.end_row) || !reader.size(edit.end_col) ||
+            !readDelta(reader, out.group_removed[i], edit.text)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace core
+} // namespace pnana
@@ -0,0 +1,243 @@
+#include "core/wrap_index.h"
+#include "utils/text_utils.h"
+#include <algorithm>
+
+namespace pnana {
+namespace core {
+
+namespace {
+
+// 逐字符累计显示列，超出 width 时在该字符前折行；on_break(byte_offset) 接收每个新视觉行的起点
+template <typename OnBreak>
+void scanBreaks(const std::string& line, size_t width, int tab_size, OnBreak on_break) {
+    const size_t tab = tab_size > 0 ? static_cast<size_t>(tab_size) : 4;
+    if (width == 0) {
+        width = 1;
+    }
+    size_t col = 0;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        unsigned char c = static_cast<unsigned char>(line[pos]);
+        if (c != '\t' && c < 0x80) {
+            // ASCII 连续段每字节一列，整段推进（压缩过的 JS/JSON 长行几乎全是这种）
+            size_t run_end = pos + 1;
+            while (run_end < line.size()) {
+                unsigned char d = static_cast<unsigned char>(line[run_end]);
+                if (d == '\t' || d >= 0x80) {
+                    break;
+                }
+                ++run_end;
+            }
+            while (pos < run_end) {
+                if (col >= width) {
+                    on_break(pos);
+                    col = 0;
+                }
+                size_t take = std::min(run_end - pos, width - col);
+                col += take;
+                pos += take;
+            }
+            continue;
+        }
+        size_t bytes = 1;
+        size_t w = 0;
+        if (c == '\t') {
+            w = tab - col % tab;
+        } else {
+            w = static_cast<size_t>(
+                utils::getCodepointDisplayWidth(utils::decodeUtf8At(line, pos, bytes)));
+        }
+        if (col > 0 && w > 0 && col + w > width) {
+            on_break(pos);
+            col = 0;
+            if (c == '\t') {
+                w = tab;
+            }
+        }
+        col += w;
+        pos += bytes;
+    }
+}
+
+} // namespace
+
+void WrapIndex::Fenwick::build(const std::vector<uint32_t>& values) {
+    tree_.assign(values.size() + 1, 0);
+    for (size_t i = 0; i < values.size(); ++i) {
+        tree_[i + 1] += values[i];
+        size_t parent = (i + 1) + ((i + 1) & (~(i + 1) + 1));
+        if (parent < tree_.size()) {
+            tree_[parent] += tree_[i + 1];
+        }
+    }
+}
+
+void WrapIndex::Fenwick::add(size_t index, int64_t delta) {
+    for (size_t i = index + 1; i < tree_.size(); i += i & (~i + 1)) {
+        tree_[i] += delta;
+    }
+}
+
+int64_t WrapIndex::Fenwick::prefix(size_t count) const {
+    int64_t sum = 0;
+    for (size_t i = std::min(count, size()); i > 0; i -= i & (~i + 1)) {
+        sum += tree_[i];
+    }
+    return sum;
+}
+
+size_t WrapIndex::Fenwick::upperBound(int64_t target) const {
+    size_t n = size();
+    size_t pos = 0;
+    size_t step = 1;
+    while (step * 2 <= n) {
+        step *= 2;
+    }
+    for (; step > 0; step /= 2) {
+        if (pos + step <= n && tree_[pos + step] <= target) {
+            pos += step;
+            target -= tree_[pos];
+        }
+    }
+    return pos;
+}
+
+void WrapIndex::computeRowStarts(const std::string& line, size_t width, int tab_size,
+                                 std::vector<size_t>& starts) {
+    starts.clear();
+    starts.push_back(0);
+    scanBreaks(line, width, tab_size, [&starts](size_t pos) {
+        starts.push_back(pos);
+    });
+}
+
+size_t WrapIndex::countRows(const std::string& line, size_t width, int tab_size) {
+    // 字节数不小于显示列数（宽字符至少占 3 字节），无制表符且不超宽的行必然只有一个视觉行
+    if (line.size() <= width && line.find('\t') == std::string::npos) {
+        return 1;
+    }
+    size_t rows = 1;
+    scanBreaks(line, width, tab_size, [&rows](size_t) {
+        ++rows;
+    });
+    return rows;
+}
+
+void WrapIndex::invalidate() {
+    valid_ = false;
+    pending_.clear();
+    starts_cache_.clear();
+}
+
+void WrapIndex::splice(size_t row, size_t removed, size_t inserted) {
+    if (!valid_) {
+        return;
+    }
+    if (row > rows_.size()) {
+        invalidate();
+        return;
+    }
+    removed = std::min(removed, rows_.size() - row);
+    // 大段粘贴等：逐行排队不比整体重建便宜
+    if (inserted > rows_.size() / 2 + 1024) {
+        invalidate();
+        return;
+    }
+
+    // 平移尚未重算的行号；落在被替换区间内的由新行重新排队
+    size_t kept = 0;
+    for (size_t line : pending_) {
+        if (line < row) {
+            pending_[kept++] = line;
+        } else if (line >= row + removed) {
+            pending_[kept++] = line - removed + inserted;
+        }
+    }
+    pending_.resize(kept);
+
+    if (removed == inserted) {
+        for (size_t i = row; i < row + inserted; ++i) {
+            starts_cache_.erase(i);
+        }
+    } else {
+        rows_.erase(rows_.begin() + static_cast<std::ptrdiff_t>(row),
+                    rows_.begin() + static_cast<std::ptrdiff_t>(row + removed));
+        rows_.insert(rows_.begin() + static_cast<std::ptrdiff_t>(row), inserted, 1);
+        tree_dirty_ = true;
+        starts_cache_.clear();
+    }
+    for (size_t i = row; i < row + inserted; ++i) {
+        pending_.push_back(i);
+    }
+}
+
+void WrapIndex::refresh(const std::vector<std::string>& lines, size_t width, int tab_size) {
+    if (!matches(width, tab_size) || rows_.size() != lines.size()) {
+        width_ = width;
+        tab_size_ = tab_size;
+        rows_.resize(lines.size());
+        for (size_t i = 0; i < lines.size(); ++i) {
+            rows_[i] = static_cast<uint32_t>(countRows(lines[i], width, tab_size));
+        }
+        tree_.build(rows_);
+        pending_.clear();
+        starts_cache_.clear();
+        tree_dirty_ = false;
+        valid_ = true;
+        return;
+    }
+
+    for (size_t line : pending_) {
+        if (line >= rows_.size()) {
+            continue;
+        }
+        uint32_t rows = static_cast<uint32_t>(countRows(lines[line], width_, tab_size_));
+        if (!tree_dirty_ && rows != rows_[line]) {
+            tree_.add(line, static_cast<int64_t>(rows) - static_cast<int64_t>(rows_[line]));
+        }
+        rows_[line] = rows;
+    }
+    pending_.clear();
+    if (tree_dirty_) {
+        tree_.build(rows_);
+        tree_dirty_ = false;
+    }
+}
+
+std::pair<size_t, size_t> WrapIndex::locate(size_t visual_row) const {
+    if (rows_.empty()) {
+        return {0, 0};
+    }
+    size_t total = totalRows();
+    if (visual_row >= total) {
+        return {rows_.size() - 1, rows_.back() - 1};
+    }
+    size_t line = tree_.upperBound(static_cast<int64_t>(visual_row));
+    return {line, visual_row - rowsBefore(line)};
+}
+
+const std::vector<size_t>& WrapIndex::rowStarts(size_t line, const std::string& text) const {
+    static const std::vector<size_t> single_row{0};
+    if (rowsOf(line) <= 1) {
+        return single_row;
+    }
+    auto it = starts_cache_.find(line);
+    if (it != starts_cache_.end()) {
+        return it->second;
+    }
+    if (starts_cache_.size() >= STARTS_CACHE_MAX) {
+        starts_cache_.clear();
+    }
+    auto& starts = starts_cache_[line];
+    computeRowStarts(text, width_, tab_size_, starts);
+    return starts;
+}
+
+size_t WrapIndex::subRowOf(size_t line, const std::string& text, size_t col) const {
+    const auto& starts = rowStarts(line, text);
+    auto it = std::upper_bound(starts.begin(), starts.end(), col);
+    return static_cast<size_t>(it - starts.begin()) - 1;
+}
+
+} // namespace core
+} // namespace pnana
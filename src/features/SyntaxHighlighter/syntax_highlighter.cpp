@@ -1372,6 +1372,147 @@ ftxui::Element SyntaxHighlighter::highlightLine(const std::string& line) {
     return highlightLineNative(line);
 }
 
+void SyntaxHighlighter::setLineTree(const TSTree* tree, size_t row, const std::string& raw_line,
+                                    size_t column_offset) {
+#ifdef BUILD_TREE_SITTER_SUPPORT
+    line_tree_ = tree;
+    line_tree_row_ = row;
+    line_tree_text_ = &raw_line;
+    line_tree_offset_ = column_offset;
+    line_tree_segments_ready_ = false;
+#else
+    (void)tree;
+    (void)row;
+    (void)raw_line;
+    (void)column_offset;
+#endif
+}
+
+void SyntaxHighlighter::clearLineTree() {
+#ifdef BUILD_TREE_SITTER_SUPPORT
+    line_tree_ = nullptr;
+    line_tree_text_ = nullptr;
+    line_tree_segments_ready_ = false;
+#endif
+}
+
+ftxui::Element SyntaxHighlighter::highlightLine(const std::string& text_segment, size_t column) {
+#ifdef BUILD_TREE_SITTER_SUPPORT
+    if (line_tree_ && !text_segment.empty() && backend_ == SyntaxHighlightBackend::TREE_SITTER &&
+        tree_sitter_highlighter_) {
+        const size_t start = line_tree_offset_ + column;
+        const size_t end = start + text_segment.size();
+        // 片段必须与原始行逐字节一致（制表符展开、截断后的显示文本无法对应到树的列）
+        if (end <= line_tree_text_->size() &&
+            line_tree_text_->compare(start, text_segment.size(), text_segment) == 0) {
+            try {
+                if (!line_tree_segments_ready_) {
+                    tree_sitter_highlighter_->segmentsForRow(
+                        line_tree_, static_cast<uint32_t>(line_tree_row_), line_tree_text_->size(),
+                        line_tree_segments_);
+                    line_tree_segments_ready_ = true;
+                }
+                std::vector<HighlightSegment> ts_segments;
+                for (const auto& segment : line_tree_segments_) {
+                    size_t a = std::max(segment.start, start);
+                    size_t b = std::min(segment.end, end);
+                    if (a < b) {
+                        ts_segments.push_back({a - start, b - start, segment.color});
+                    }
+                }
+                std::vector<HighlightSegment> native_segments;
+                getNativeSegments(text_segment, native_segments);
+                return mergeAndHighlight(text_segment, ts_segments, native_segments);
+            } catch (...) {
+                return highlightLineNative(text_segment);
+            }
+        }
+    }
+#endif
+    if (line_context_ && !text_segment.empty()) {
+        const size_t start = line_context_offset_ + column;
+        if (start + text_segment.size() <= line_context_->size() &&
+            line_context_->compare(start, text_segment.size(), text_segment) == 0) {
+            try {
+                return highlightFromContext(text_segment, start);
+            } catch (...) {
+                return text(text_segment) | color(theme_.getColors().foreground);
+            }
+        }
+    }
+    return highlightLine(text_segment);
+}
+
+void SyntaxHighlighter::setLineContext(const std::string& context, size_t window_offset) {
+    line_context_ = &context;
+    line_context_offset_ = window_offset;
+    line_context_tokens_ready_ = false;
+}
+
+void SyntaxHighlighter::clearLineContext() {
+    line_context_ = nullptr;
+    line_context_tokens_ready_ = false;
+    line_context_tokens_.clear();
+}
+
+std::vector<Token> SyntaxHighlighter::tokenizeDetached(const std::string& line) {
+    const bool saved_comment = in_multiline_comment_;
+    const bool saved_string = in_multiline_string_;
+    in_multiline_comment_ = false;
+    in_multiline_string_ = false;
+    std::vector<Token> tokens;
+    try {
+        tokens = tokenize(line);
+    } catch (...) {
+        tokens.clear();
+    }
+    in_multiline_comment_ = saved_comment;
+    in_multiline_string_ = saved_string;
+    return tokens;
+}
+
+size_t SyntaxHighlighter::lastTokenStart(const std::string& text, size_t limit) {
+    size_t best = 0;
+    for (const auto& token : tokenizeDetached(text)) {
+        if (token.start <= limit && token.start > best) {
+            best = token.start;
+        }
+    }
+    return best;
+}
+
+ftxui::Element SyntaxHighlighter::highlightFromContext(const std::string& text_segment,
+                                                       size_t start) {
+    if (!line_context_tokens_ready_) {
+        line_context_tokens_ = tokenizeDetached(*line_context_);
+        line_context_tokens_ready_ = true;
+    }
+    const size_t end = start + text_segment.size();
+    const Color fg = theme_.getColors().foreground;
+    Elements elements;
+    size_t pos = start;
+    for (const auto& token : line_context_tokens_) {
+        size_t a = std::max(token.start, pos);
+        size_t b = std::min(token.end, end);
+        if (a >= b) {
+            continue;
+        }
+        if (a > pos) {
+            elements.push_back(text(text_segment.substr(pos - start, a - pos)) | color(fg));
+        }
+        elements.push_back(text(text_segment.substr(a - start, b - a)) |
+                           color(getColorForToken(token.type)));
+        pos = b;
+        if (pos >= end) {
+            break;
+        }
+    }
+    if (pos < end) {
+        elements.push_back(text(text_segment.substr(pos - start)) | color(fg));
+    }
+    return hbox(elements);
+}
+
 ftxui::Element SyntaxHighlighter::highlightLineNative(const std::string& line) {
     if (line.empty()) {
         return text("");
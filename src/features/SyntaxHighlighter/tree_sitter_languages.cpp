@@ -0,0 +1,666 @@
+#include "features/SyntaxHighlighter/tree_sitter_languages.h"
+#include <map>
+
+// Tree-sitter 语言定义（需要链接对应的语言库）
+// 注意：这些函数从对应的语言库中获取
+// 如果语言库未链接，需要在 CMakeLists.txt 中链接对应的库
+extern "C" {
+// C/C++
+#ifdef BUILD_TREE_SITTER_CPP
+TSLanguage* tree_sitter_cpp();
+#endif
+#ifdef BUILD_TREE_SITTER_C
+TSLanguage* tree_sitter_c();
+#endif
+
+// Python
+#ifdef BUILD_TREE_SITTER_PYTHON
+TSLanguage* tree_sitter_python();
+#endif
+
+// JavaScript/TypeScript
+#ifdef BUILD_TREE_SITTER_JAVASCRIPT
+TSLanguage* tree_sitter_javascript();
+#endif
+#ifdef BUILD_TREE_SITTER_TYPESCRIPT
+TSLanguage* tree_sitter_typescript();
+#endif
+
+// 数据格式
+#ifdef BUILD_TREE_SITTER_JSON
+TSLanguage* tree_sitter_json();
+#endif
+#ifdef BUILD_TREE_SITTER_MARKDOWN
+TSLanguage* tree_sitter_markdown();
+#endif
+
+// Shell
+#ifdef BUILD_TREE_SITTER_BASH
+TSLanguage* tree_sitter_bash();
+#endif
+
+// 其他语言
+#ifdef BUILD_TREE_SITTER_RUST
+TSLanguage* tree_sitter_rust();
+#endif
+#ifdef BUILD_TREE_SITTER_GO
+TSLanguage* tree_sitter_go();
+#endif
+#ifdef BUILD_TREE_SITTER_JAVA
+TSLanguage* tree_sitter_java();
+#endif
+
+// CMake
+#ifdef BUILD_TREE_SITTER_CMAKE
+TSLanguage* tree_sitter_cmake();
+#endif
+
+// TCL
+#ifdef BUILD_TREE_SITTER_TCL
+TSLanguage* tree_sitter_tcl();
+#endif
+
+// Fortran
+#ifdef BUILD_TREE_SITTER_FORTRAN
+TSLanguage* tree_sitter_fortran();
+#endif
+
+// Haskell
+#ifdef BUILD_TREE_SITTER_HASKELL
+TSLanguage* tree_sitter_haskell();
+#endif
+
+// Lua
+#ifdef BUILD_TREE_SITTER_LUA
+TSLanguage* tree_sitter_lua();
+#endif
+
+// 新增语言支持
+// YAML
+#ifdef BUILD_TREE_SITTER_YAML
+TSLanguage* tree_sitter_yaml();
+#endif
+
+// XML
+#ifdef BUILD_TREE_SITTER_XML
+TSLanguage* tree_sitter_xml();
+#endif
+
+// CSS
+#ifdef BUILD_TREE_SITTER_CSS
+TSLanguage* tree_sitter_css();
+#endif
+
+// SQL
+#ifdef BUILD_TREE_SITTER_SQL
+TSLanguage* tree_sitter_sql();
+#endif
+
+// Ruby
+#ifdef BUILD_TREE_SITTER_RUBY
+TSLanguage* tree_sitter_ruby();
+#endif
+
+// PHP
+#ifdef BUILD_TREE_SITTER_PHP
+TSLanguage* tree_sitter_php();
+#endif
+
+// Swift
+#ifdef BUILD_TREE_SITTER_SWIFT
+TSLanguage* tree_sitter_swift();
+#endif
+
+// Kotlin
+#ifdef BUILD_TREE_SITTER_KOTLIN
+TSLanguage* tree_sitter_kotlin();
+#endif
+
+// C#
+#ifdef BUILD_TREE_SITTER_CSHARP
+TSLanguage* tree_sitter_c_sharp();
+#endif
+
+// Scala
+#ifdef BUILD_TREE_SITTER_SCALA
+TSLanguage* tree_sitter_scala();
+#endif
+
+// R
+#ifdef BUILD_TREE_SITTER_R
+TSLanguage* tree_sitter_r();
+#endif
+
+// Perl
+#ifdef BUILD_TREE_SITTER_PERL
+TSLanguage* tree_sitter_perl();
+#endif
+
+// Dockerfile
+#ifdef BUILD_TREE_SITTER_DOCKERFILE
+TSLanguage* tree_sitter_dockerfile();
+#endif
+
+// Vim
+#ifdef BUILD_TREE_SITTER_VIM
+TSLanguage* tree_sitter_vim();
+#endif
+
+// PowerShell
+#ifdef BUILD_TREE_SITTER_POWERSHELL
+TSLanguage* tree_sitter_powershell();
+#endif
+
+// Meson
+#ifdef BUILD_TREE_SITTER_MESON
+TSLanguage* tree_sitter_meson();
+#endif
+
+// TOML
+#ifdef BUILD_TREE_SITTER_TOML
+TSLanguage* tree_sitter_toml();
+#endif
+
+// Nim
+#ifdef BUILD_TREE_SITTER_NIM
+TSLanguage* tree_sitter_nim();
+#endif
+
+// Zig
+#ifdef BUILD_TREE_SITTER_ZIG
+TSLanguage* tree_sitter_zig();
+#endif
+
+// C3
+#ifdef BUILD_TREE_SITTER_C3
+TSLanguage* tree_sitter_c3();
+#endif
+
+// 函数式编程和编译器相关语言
+// Lisp
+#ifdef BUILD_TREE_SITTER_LISP
+TSLanguage* tree_sitter_commonlisp();
+#endif
+
+// SML
+#ifdef BUILD_TREE_SITTER_SML
+TSLanguage* tree_sitter_sml();
+#endif
+
+// LLVM IR
+#ifdef BUILD_TREE_SITTER_LLVM
+TSLanguage* tree_sitter_llvm();
+#endif
+
+// Assembly (for RISC-V/MIPS)
+#ifdef BUILD_TREE_SITTER_ASM
+TSLanguage* tree_sitter_asm();
+#endif
+}
+
+namespace pnana {
+namespace features {
+
+namespace {
+
+// 注意：这些语言库需要在编译时链接（在 CMakeLists.txt 中）
+// 如果语言库未链接，对应的语言将使用原生语法高亮器（自动回退）
+std::map<std::string, TSLanguage*> buildLanguageMap() {
+    std::map<std::string, TSLanguage*> languages;
+
+// C/C++
+#ifdef BUILD_TREE_SITTER_CPP
+    TSLanguage* cpp_lang = tree_sitter_cpp();
+    if (cpp_lang) {
+        languages["cpp"] = cpp_lang;
+        languages["cxx"] = cpp_lang;
+        languages["cc"] = cpp_lang;
+        languages["c++"] = cpp_lang;
+        languages["hpp"] = cpp_lang;
+        languages["hxx"] = cpp_lang;
+        languages["hh"] = cpp_lang;
+    }
+#endif
+
+#ifdef BUILD_TREE_SITTER_C
+    TSLanguage* c_lang = tree_sitter_c();
+    if (c_lang) {
+        languages["c"] = c_lang;
+        languages["h"] = c_lang;
+    }
+#endif
+
+// Python
+#ifdef BUILD_TREE_SITTER_PYTHON
+    TSLanguage* python_lang = tree_sitter_python();
+    if (python_lang) {
+        languages["py"] = python_lang;
+        languages["python"] = python_lang;
+        languages["pyw"] = python_lang;
+        languages["pyi"] = python_lang;
+    }
+#endif
+
+// JavaScript
+#ifdef BUILD_TREE_SITTER_JAVASCRIPT
+    TSLanguage* js_lang = tree_sitter_javascript();
+    if (js_lang) {
+        languages["js"] = js_lang;
+        languages["javascript"] = js_lang;
+        languages["jsx"] = js_lang;
+        languages["mjs"] = js_lang;
+    }
+#endif
+
+// TypeScript
+#ifdef BUILD_TREE_SITTER_TYPESCRIPT
+    TSLanguage* ts_lang = tree_sitter_typescript();
+    if (ts_lang) {
+        languages["ts"] = ts_lang;
+        languages["typescript"] = ts_lang;
+        languages["tsx"] = ts_lang;
+    }
+#endif
+
+// JSON
+#ifdef BUILD_TREE_SITTER_JSON
+    TSLanguage* json_lang = tree_sitter_json();
+    if (json_lang) {
+        languages["json"] = json_lang;
+        languages["jsonc"] = json_lang;
+    }
+#endif
+
+// Markdown
+#ifdef BUILD_TREE_SITTER_MARKDOWN
+    TSLanguage* md_lang = tree_sitter_markdown();
+    if (md_lang) {
+        languages["md"] = md_lang;
+        languages["markdown"] = md_lang;
+    }
+#endif
+
+// Shell/Bash
+#ifdef BUILD_TREE_SITTER_BASH
+    TSLanguage* bash_lang = tree_sitter_bash();
+    if (bash_lang) {
+        languages["sh"] = bash_lang;
+        languages["bash"] = bash_lang;
+        languages["shell"] = bash_lang;
+        languages["zsh"] = bash_lang;
+        // Shell 配置文件（点文件）
+        languages[".zshrc"] = bash_lang;
+        languages[".zprofile"] = bash_lang;
+        languages[".zshenv"] = bash_lang;
+        languages[".zlogin"] = bash_lang;
+        languages[".zlogout"] = bash_lang;
+        languages[".bashrc"] = bash_lang;
+        languages[".bash_profile"] = bash_lang;
+        languages[".bash_login"] = bash_lang;
+        languages[".profile"] = bash_lang;
+        languages[".bash_aliases"] = bash_lang;
+        languages[".bash_functions"] = bash_lang;
+        languages[".bash_completion"] = bash_lang;
+        languages[".inputrc"] = bash_lang;
+        languages[".tcshrc"] = bash_lang;
+        languages[".cshrc"] = bash_lang;
+        languages[".kshrc"] = bash_lang;
+        languages[".fish"] = bash_lang;
+    }
+#endif
+
+// Rust
+#ifdef BUILD_TREE_SITTER_RUST
+    TSLanguage* rust_lang = tree_sitter_rust();
+    if (rust_lang) {
+        languages["rs"] = rust_lang;
+        languages["rust"] = rust_lang;
+    }
+#endif
+
+// Go
+#ifdef BUILD_TREE_SITTER_GO
+    TSLanguage* go_lang = tree_sitter_go();
+    if (go_lang) {
+        languages["go"] = go_lang;
+    }
+#endif
+
+// Java
+#ifdef BUILD_TREE_SITTER_JAVA
+    TSLanguage* java_lang = tree_sitter_java();
+    if (java_lang) {
+        languages["java"] = java_lang;
+    }
+#endif
+
+// CMake
+#ifdef BUILD_TREE_SITTER_CMAKE
+    TSLanguage* cmake_lang = tree_sitter_cmake();
+    if (cmake_lang) {
+        languages["cmake"] = cmake_lang;
+        languages["cmake.in"] = cmake_lang;
+        languages["cmake.in.in"] = cmake_lang;
+    }
+#endif
+
+// TCL
+#ifdef BUILD_TREE_SITTER_TCL
+    TSLanguage* tcl_lang = tree_sitter_tcl();
+    if (tcl_lang) {
+        languages["tcl"] = tcl_lang;
+        languages["tk"] = tcl_lang;
+        languages["portfile"] = tcl_lang; // MacPorts portfiles
+    }
+#endif
+
+// Fortran
+#ifdef BUILD_TREE_SITTER_FORTRAN
+    TSLanguage* fortran_lang = tree_sitter_fortran();
+    if (fortran_lang) {
+        languages["f90"] = fortran_lang;
+        languages["f95"] = fortran_lang;
+        languages["f03"] = fortran_lang;
+        languages["f08"] = fortran_lang;
+        languages["f"] = fortran_lang;
+        languages["for"] = fortran_lang;
+        languages["ftn"] = fortran_lang;
+        languages["fpp"] = fortran_lang;
+        languages["fortran"] = fortran_lang;
+    }
+#endif
+
+// Haskell
+#ifdef BUILD_TREE_SITTER_HASKELL
+    TSLanguage* haskell_lang = tree_sitter_haskell();
+    if (haskell_lang) {
+        languages["hs"] = haskell_lang;
+        languages["haskell"] = haskell_lang;
+        languages["lhs"] = haskell_lang; // Literate Haskell
+    }
+#endif
+
+// Lua
+#ifdef BUILD_TREE_SITTER_LUA
+    TSLanguage* lua_lang = tree_sitter_lua();
+    if (lua_lang) {
+        languages["lua"] = lua_lang;
+        languages["lua5.1"] = lua_lang;
+        languages["lua5.2"] = lua_lang;
+        languages["lua5.3"] = lua_lang;
+        languages["lua5.4"] = lua_lang;
+    }
+#endif
+
+// 新增语言支持
+// YAML
+#ifdef BUILD_TREE_SITTER_YAML
+    TSLanguage* yaml_lang = tree_sitter_yaml();
+    if (yaml_lang) {
+        languages["yaml"] = yaml_lang;
+        languages["yml"] = yaml_lang;
+    }
+#endif
+
+// XML
+#ifdef BUILD_TREE_SITTER_XML
+    TSLanguage* xml_lang = tree_sitter_xml();
+    if (xml_lang) {
+        languages["xml"] = xml_lang;
+        languages["html"] = xml_lang;
+        languages["htm"] = xml_lang;
+        languages["xhtml"] = xml_lang;
+        languages["svg"] = xml_lang;
+    }
+#endif
+
+// CSS
+#ifdef BUILD_TREE_SITTER_CSS
+    TSLanguage* css_lang = tree_sitter_css();
+    if (css_lang) {
+        languages["css"] = css_lang;
+        languages["scss"] = css_lang;
+        languages["sass"] = css_lang;
+        languages["less"] = css_lang;
+    }
+#endif
+
+// SQL
+#ifdef BUILD_TREE_SITTER_SQL
+    TSLanguage* sql_lang = tree_sitter_sql();
+    if (sql_lang) {
+        languages["sql"] = sql_lang;
+        languages["mysql"] = sql_lang;
+        languages["postgresql"] = sql_lang;
+        languages["sqlite"] = sql_lang;
+        languages["oracle"] = sql_lang;
+        languages["mssql"] = sql_lang;
+    }
+#endif
+
+// Ruby
+#ifdef BUILD_TREE_SITTER_RUBY
+    TSLanguage* ruby_lang = tree_sitter_ruby();
+    if (ruby_lang) {
+        languages["rb"] = ruby_lang;
+        languages["ruby"] = ruby_lang;
+        languages["rake"] = ruby_lang;
+        languages["gemspec"] = ruby_lang;
+    }
+#endif
+
+// PHP
+#ifdef BUILD_TREE_SITTER_PHP
+    TSLanguage* php_lang = tree_sitter_php();
+    if (php_lang) {
+        languages["php"] = php_lang;
+        languages["phtml"] = php_lang;
+        languages["php3"] = php_lang;
+        languages["php4"] = php_lang;
+        languages["php5"] = php_lang;
+        languages["php7"] = php_lang;
+    }
+#endif
+
+// Swift
+#ifdef BUILD_TREE_SITTER_SWIFT
+    TSLanguage* swift_lang = tree_sitter_swift();
+    if (swift_lang) {
+        languages["swift"] = swift_lang;
+    }
+#endif
+
+// Kotlin
+#ifdef BUILD_TREE_SITTER_KOTLIN
+    TSLanguage* kotlin_lang = tree_sitter_kotlin();
+    if (kotlin_lang) {
+        languages["kt"] = kotlin_lang;
+        languages["kotlin"] = kotlin_lang;
+        languages["kts"] = kotlin_lang;
+    }
+#endif
+
+// C#
+#ifdef BUILD_TREE_SITTER_CSHARP
+    TSLanguage* csharp_lang = tree_sitter_c_sharp();
+    if (csharp_lang) {
+        languages["cs"] = csharp_lang;
+        languages["csharp"] = csharp_lang;
+        languages["csx"] = csharp_lang;
+    }
+#endif
+
+// Scala
+#ifdef BUILD_TREE_SITTER_SCALA
+    TSLanguage* scala_lang = tree_sitter_scala();
+    if (scala_lang) {
+        languages["scala"] = scala_lang;
+        languages["sc"] = scala_lang;
+    }
+#endif
+
+// R
+#ifdef BUILD_TREE_SITTER_R
+    TSLanguage* r_lang = tree_sitter_r();
+    if (r_lang) {
+        languages["r"] = r_lang;
+        languages["R"] = r_lang;
+        languages["rmd"] = r_lang;
+        languages["rscript"] = r_lang;
+    }
+#endif
+
+// Perl
+#ifdef BUILD_TREE_SITTER_PERL
+    TSLanguage* perl_lang = tree_sitter_perl();
+    if (perl_lang) {
+        languages["pl"] = perl_lang;
+        languages["pm"] = perl_lang;
+        languages["perl"] = perl_lang;
+        languages["pod"] = perl_lang;
+    }
+#endif
+
+// Dockerfile
+#ifdef BUILD_TREE_SITTER_DOCKERFILE
+    TSLanguage* dockerfile_lang = tree_sitter_dockerfile();
+    if (dockerfile_lang) {
+        languages["dockerfile"] = dockerfile_lang;
+        languages["Dockerfile"] = dockerfile_lang;
+        languages["containerfile"] = dockerfile_lang;
+    }
+#endif
+
+// Vim
+#ifdef BUILD_TREE_SITTER_VIM
+    TSLanguage* vim_lang = tree_sitter_vim();
+    if (vim_lang) {
+        languages["vim"] = vim_lang;
+        languages["vimrc"] = vim_lang;
+        languages["nvim"] = vim_lang;
+        languages["vimscript"] = vim_lang;
+        // Vim 配置文件（点文件）
+        languages[".vimrc"] = vim_lang;
+        languages[".gvimrc"] = vim_lang;
+        languages[".nvimrc"] = vim_lang;
+        languages[".exrc"] = vim_lang;
+    }
+#endif
+
+// PowerShell
+#ifdef BUILD_TREE_SITTER_POWERSHELL
+    TSLanguage* powershell_lang = tree_sitter_powershell();
+    if (powershell_lang) {
+        languages["ps1"] = powershell_lang;
+        languages["powershell"] = powershell_lang;
+        languages["psm1"] = powershell_lang;
+        languages["psd1"] = powershell_lang;
+    }
+#endif
+
+// Meson
+#ifdef BUILD_TREE_SITTER_MESON
+    TSLanguage* meson_lang = tree_sitter_meson();
+    if (meson_lang) {
+        languages["meson"] = meson_lang;
+        languages["meson.build"] = meson_lang;
+        languages["meson_options.txt"] = meson_lang;
+    }
+#endif
+
+// TOML
+#ifdef BUILD_TREE_SITTER_TOML
+    TSLanguage* toml_lang = tree_sitter_toml();
+    if (toml_lang) {
+        languages["toml"] = toml_lang;
+        languages["Cargo.lock"] = toml_lang;   // Rust Cargo.lock files
+        languages["Pipfile.lock"] = toml_lang; // Python Pipfile.lock
+        languages["poetry.lock"] = toml_lang;  // Python Poetry lock files
+    }
+#endif
+
+// Nim
+#ifdef BUILD_TREE_SITTER_NIM
+    TSLanguage* nim_lang = tree_sitter_nim();
+    if (nim_lang) {
+        languages["nim"] = nim_lang;
+        languages["nims"] = nim_lang;   // Nim script files
+        languages["nimble"] = nim_lang; // Nimble package files
+    }
+#endif
+
+// Zig
+#ifdef BUILD_TREE_SITTER_ZIG
+    TSLanguage* zig_lang = tree_sitter_zig();
+    if (zig_lang) {
+        languages["zig"] = zig_lang;
+    }
+#endif
+
+// C3
+#ifdef BUILD_TREE_SITTER_C3
+    TSLanguage* c3_lang = tree_sitter_c3();
+    if (c3_lang) {
+        languages["c3"] = c3_lang;
+    }
+#endif
+
+// 函数式编程和编译器相关语言
+// Lisp
+#ifdef BUILD_TREE_SITTER_LISP
+    TSLanguage* lisp_lang = tree_sitter_commonlisp();
+    if (lisp_lang) {
+        languages["lisp"] = lisp_lang;
+        languages["lsp"] = lisp_lang;
+        languages["cl"] = lisp_lang;
+        languages["commonlisp"] = lisp_lang;
+        languages["scheme"] = lisp_lang;
+        languages["scm"] = lisp_lang;
+    }
+#endif
+
+// SML
+#ifdef BUILD_TREE_SITTER_SML
+    TSLanguage* sml_lang = tree_sitter_sml();
+    if (sml_lang) {
+        languages["sml"] = sml_lang;
+        languages["ml"] = sml_lang;
+        languages["sig"] = sml_lang;
+        languages["fun"] = sml_lang;
+    }
+#endif
+
+// LLVM IR
+#ifdef BUILD_TREE_SITTER_LLVM
+    TSLanguage* llvm_lang = tree_sitter_llvm();
+    if (llvm_lang) {
+        languages["ll"] = llvm_lang;
+        languages["llvm"] = llvm_lang;
+        languages["llvm-ir"] = llvm_lang;
+    }
+#endif
+
+// Assembly (for RISC-V/MIPS)
+#ifdef BUILD_TREE_SITTER_ASM
+    TSLanguage* asm_lang = tree_sitter_asm();
+    if (asm_lang) {
+        languages["asm"] = asm_lang;
+        languages["s"] = asm_lang;
+        languages["S"] = asm_lang;
+        languages["riscv"] = asm_lang;
+        languages["mips"] = asm_lang;
+    }
+#endif
+    return languages;
+}
+
+} // namespace
+
+TSLanguage* treeSitterLanguageFor(const std::string& file_type) {
+    static const std::map<std::string, TSLanguage*> languages = buildLanguageMap();
+    auto it = languages.find(file_type);
+    return it != languages.end() ? it->second : nullptr;
+}
+
+} // namespace features
+} // namespace pnana
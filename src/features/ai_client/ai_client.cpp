@@ -1,11 +1,11 @@
 #include "features/ai_client/ai_client.h"
 
 #ifdef BUILD_AI_CLIENT_SUPPORT
+#include "features/ai_client/http_engine.h"
+#include <algorithm>
 #include <chrono>
-#include <curl/curl.h>
 #include <iostream>
 #include <sstream>
-#include <thread>
 
 namespace pnana {
 namespace features {
@@ -18,25 +18,40 @@ void AIClient::setToolCallCallback(ToolCallCallback /*callback*/) {
     // 基类默认实现，子类可以覆盖
 }
 
-// HTTP响应回调
-size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* response) {
-    size_t total_size = size * nmemb;
-    response->append(static_cast<char*>(contents), total_size);
-    return total_size;
-}
-
-// 流式响应回调
-size_t StreamingWriteCallback(void* contents, size_t size, size_t nmemb, void* user_data) {
-    size_t total_size = size * nmemb;
-    auto callback_data = static_cast<std::pair<StreamingCallback, std::atomic<bool>*>*>(user_data);
+namespace {
+// HTTP 错误时保留的响应体上限（只用于提取错误信息）
+constexpr size_t MAX_ERROR_BODY_BYTES = 16 * 1024;
 
-    if (callback_data && callback_data->second && !callback_data->second->load()) {
-        std::string chunk(static_cast<char*>(contents), total_size);
-        callback_data->first(chunk, false);
+// 流式响应中一个 chunk 的增量文本（choices[0].delta.content）
+std::string streamingDeltaText(const nlohmann::json& chunk) {
+    if (chunk.contains("error") && chunk["error"].is_object()) {
+        return "\n[Error] " + chunk["error"].value("message", std::string("unknown error"));
+    }
+    if (!chunk.contains("choices") || !chunk["choices"].is_array() || chunk["choices"].empty()) {
+        return "";
+    }
+    const auto& choice = chunk["choices"][0];
+    if (!choice.contains("delta") || !choice["delta"].is_object()) {
+        return "";
     }
+    const auto& content = choice["delta"].value("content", nlohmann::json());
+    return content.is_string() ? content.get<std::string>() : "";
+}
 
-    return total_size;
+// 请求失败时给面板看的错误说明：优先用 API 返回的 error.message
+std::string describeHttpError(const HttpResponse& response, const std::string& body) {
+    if (!response.error.empty()) {
+        return "\n[Error] " + response.error;
+    }
+    nlohmann::json json = nlohmann::json::parse(body, nullptr, false);
+    if (!json.is_discarded() && json.contains("error") && json["error"].is_object() &&
+        json["error"].contains("message") && json["error"]["message"].is_string()) {
+        return "\n[Error] HTTP " + std::to_string(response.status) + ": " +
+               json["error"]["message"].get<std::string>();
+    }
+    return "\n[Error] HTTP " + std::to_string(response.status);
 }
+} // namespace
 
 // AI客户端管理器实现
 AIClientManager::AIClientManager() {
@@ -146,9 +161,7 @@ std::vector<std::string> AIClientManager::getAvailableProviders() const {
 
 // OpenAI客户端实现
 OpenAIClient::OpenAIClient(const ai_config::AIProviderConfig& config)
-    : config_(config), cancel_flag_(false) {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-}
+    : config_(config), cancel_flag_(false) {}
 
 void OpenAIClient::setToolCallCallback(ToolCallCallback callback) {
     tool_call_callback_ = callback;
@@ -206,54 +219,61 @@ std::future<AIResponse> OpenAIClient::sendRequest(const AIRequest& request) {
 }
 
 void OpenAIClient::sendStreamingRequest(const AIRequest& request, StreamingCallback callback) {
-    std::thread([this, request, callback]() {
-        cancel_flag_ = false;
-
-        try {
-            CURL* curl = curl_easy_init();
-            if (!curl) {
-                callback("", true);
-                return;
+    cancel_flag_ = false;
+
+    nlohmann::json request_json = buildRequestJson(request);
+    request_json["stream"] = true;
+
+    HttpRequest http_request;
+    http_request.url = config_.base_url + "/chat/completions";
+    http_request.headers = {"Content-Type: application/json", "Accept: text/event-stream",
+                            "Authorization: Bearer " + config_.api_key};
+    http_request.body = request_json.dump();
+
+    // SSE 解析状态只在 HTTP 引擎的 IO 线程上访问；callback 同样在 IO 线程上调用
+    struct StreamState {
+        SseParser parser;
+        bool saw_event = false;
+        std::string error_body; // 非 SSE 的错误响应（如 401 的 JSON）
+    };
+    auto state = std::make_shared<StreamState>();
+
+    auto on_data = [state, callback](const char* data, size_t size) {
+        if (!state->saw_event && state->error_body.size() < MAX_ERROR_BODY_BYTES) {
+            size_t room = MAX_ERROR_BODY_BYTES - state->error_body.size();
+            state->error_body.append(data, std::min(size, room));
+        }
+        for (const auto& event : state->parser.feed(data, size)) {
+            state->saw_event = true;
+            if (event.data == "[DONE]") {
+                continue;
+            }
+            nlohmann::json chunk = nlohmann::json::parse(event.data, nullptr, false);
+            if (chunk.is_discarded()) {
+                continue;
+            }
+            std::string text = streamingDeltaText(chunk);
+            if (!text.empty()) {
+                callback(text, false);
             }
-
-            std::string url = config_.base_url + "/chat/completions";
-            nlohmann::json request_json = buildRequestJson(request);
-            request_json["stream"] = true;
-            std::string body = request_json.dump();
-
-            std::string response_buffer;
-            auto callback_data = std::make_pair(callback, &cancel_flag_);
-
-            struct curl_slist* headers = nullptr;
-            headers = curl_slist_append(headers, "Content-Type: application/json");
-            headers =
-                curl_slist_append(headers, ("Authorization: Bearer " + config_.api_key).c_str());
-
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_POST, 1L);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, StreamingWriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &callback_data);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L); // 5分钟超时
-
-            CURLcode res = curl_easy_perform(curl);
-            (void)res; // 避免未使用变量警告
-
-            curl_slist_free_all(headers);
-            curl_easy_cleanup(curl);
-
-            // 发送结束信号
-            callback("", true);
-
-        } catch (const std::exception& e) {
-            callback("", true);
         }
-    }).detach();
+    };
+    auto on_done = [state, callback](const HttpResponse& response) {
+        if (!response.cancelled && !response.ok()) {
+            callback(describeHttpError(response, state->error_body), false);
+        }
+        callback("", true);
+    };
+
+    active_request_ = HttpEngine::getInstance().submit(std::move(http_request), on_data, on_done);
 }
 
 void OpenAIClient::cancelRequest() {
     cancel_flag_ = true;
+    HttpEngine::RequestId id = active_request_.load();
+    if (id != 0) {
+        HttpEngine::getInstance().cancel(id);
+    }
 }
 
 nlohmann::json OpenAIClient::buildRequestJson(const AIRequest& request) const {
@@ -368,42 +388,26 @@ std::string OpenAIClient::makeHttpRequest(const std::string& url, const std::str
                                           const std::string& body,
                                           const std::string& content_type) const {
     (void)method; // 当前实现中未使用method参数
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        return "";
-    }
-
-    std::string response;
-    struct curl_slist* headers = nullptr;
-
-    headers = curl_slist_append(headers, ("Content-Type: " + content_type).c_str());
-    headers = curl_slist_append(headers, ("Authorization: Bearer " + config_.api_key).c_str());
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L); // 5分钟超时
-
-    CURLcode res = curl_easy_perform(curl);
-
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if (res != CURLE_OK) {
+    HttpRequest http_request;
+    http_request.url = url;
+    http_request.headers = {"Content-Type: " + content_type,
+                            "Authorization: Bearer " + config_.api_key};
+    http_request.body = body;
+    http_request.timeout_ms = 300000; // 5分钟超时
+
+    // 经共享的 HTTP 引擎发出，复用到同一提供商的已有连接；cancelRequest() 可中止等待
+    HttpResponse response =
+        HttpEngine::getInstance().perform(std::move(http_request), &active_request_);
+    if (!response.error.empty() || response.cancelled) {
         return "";
     }
 
-    return response;
+    return response.body;
 }
 
 // Claude客户端实现（简化版）
 ClaudeClient::ClaudeClient(const ai_config::AIProviderConfig& config)
-    : config_(config), cancel_flag_(false) {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-}
+    : config_(config), cancel_flag_(false) {}
 
 void ClaudeClient::setToolCallCallback(ToolCallCallback callback) {
     tool_call_callback_ = callback;
@@ -0,0 +1,347 @@
+#include "features/ai_client/http_engine.h"
+
+#ifdef BUILD_AI_CLIENT_SUPPORT
+#include "utils/logger.h"
+#include <algorithm>
+#include <curl/curl.h>
+#include <future>
+
+namespace pnana {
+namespace features {
+namespace ai_client {
+
+namespace {
+// 连接缓存：同一主机最多并行的连接数（HTTP/2 下通常只需一条），以及缓存保留的空闲连接总数
+constexpr long MAX_HOST_CONNECTIONS = 4;
+constexpr long MAX_CACHED_CONNECTIONS = 16;
+} // namespace
+
+std::vector<SseParser::Event> SseParser::feed(const char* data, size_t size) {
+    std::vector<Event> events;
+    buffer_.append(data, size);
+
+    size_t start = 0;
+    while (true) {
+        size_t end = buffer_.find('\n', start);
+        if (end == std::string::npos) {
+            break;
+        }
+        std::string line = buffer_.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        // 空行：事件结束
+        if (line.empty()) {
+            if (has_data_) {
+                events.push_back(Event{event_, data_});
+            }
+            event_.clear();
+            data_.clear();
+            has_data_ = false;
+            continue;
+        }
+        // 注释行（常用作心跳）
+        if (line[0] == ':') {
+            continue;
+        }
+
+        size_t colon = line.find(':');
+        std::string field = line.substr(0, colon);
+        std::string value;
+        if (colon != std::string::npos) {
+            value = line.substr(colon + 1);
+            if (!value.empty() && value[0] == ' ') {
+                value.erase(0, 1);
+            }
+        }
+        if (field == "data") {
+            if (has_data_) {
+                data_ += '\n';
+            }
+            data_ += value;
+            has_data_ = true;
+        } else if (field == "event") {
+            event_ = value;
+        }
+    }
+    buffer_.erase(0, start);
+    return events;
+}
+
+struct HttpEngine::Transfer {
+    RequestId id = 0;
+    HttpRequest request;
+    DataCallback on_data;
+    DoneCallback on_done;
+    HttpResponse response;
+    CURL* easy = nullptr;
+    curl_slist* headers = nullptr;
+};
+
+HttpEngine::HttpEngine() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    CURLM* multi = curl_multi_init();
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, MAX_HOST_CONNECTIONS);
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, MAX_CACHED_CONNECTIONS);
+    multi_ = multi;
+    io_thread_ = std::thread([this]() {
+        ioLoop();
+    });
+}
+
+HttpEngine::~HttpEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    curl_multi_wakeup(static_cast<CURLM*>(multi_));
+    if (io_thread_.joinable()) {
+        io_thread_.join();
+    }
+
+    // 进程退出：回调引用的对象可能已析构，未完成的请求直接丢弃
+    CURLM* multi = static_cast<CURLM*>(multi_);
+    for (auto& transfer : running_) {
+        curl_multi_remove_handle(multi, transfer->easy);
+        curl_easy_cleanup(transfer->easy);
+        curl_slist_free_all(transfer->headers);
+    }
+    running_.clear();
+    pending_.clear();
+    curl_multi_cleanup(multi);
+}
+
+HttpEngine::RequestId HttpEngine::submit(HttpRequest request, DataCallback on_data,
+                                         DoneCallback on_done) {
+    auto transfer = std::make_unique<Transfer>();
+    transfer->request = std::move(request);
+    transfer->on_data = std::move(on_data);
+    transfer->on_done = std::move(on_done);
+
+    RequestId id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = next_id_++;
+        transfer->id = id;
+        active_ids_.insert(id);
+        pending_.push_back(std::move(transfer));
+    }
+    curl_multi_wakeup(static_cast<CURLM*>(multi_));
+    return id;
+}
+
+HttpResponse HttpEngine::perform(HttpRequest request, std::atomic<RequestId>* current) {
+    auto promise = std::make_shared<std::promise<HttpResponse>>();
+    std::future<HttpResponse> future = promise->get_future();
+    RequestId id = submit(std::move(request), nullptr, [promise](const HttpResponse& response) {
+        promise->set_value(response);
+    });
+    if (current) {
+        current->store(id);
+    }
+    HttpResponse response = future.get();
+    if (current) {
+        RequestId expected = id;
+        current->compare_exchange_strong(expected, 0);
+    }
+    return response;
+}
+
+void HttpEngine::cancel(RequestId id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (active_ids_.find(id) == active_ids_.end()) {
+            return;
+        }
+        cancel_requests_.insert(id);
+    }
+    curl_multi_wakeup(static_cast<CURLM*>(multi_));
+}
+
+size_t HttpEngine::activeCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_ids_.size();
+}
+
+void HttpEngine::ioLoop() {
+    CURLM* multi = static_cast<CURLM*>(multi_);
+
+    while (true) {
+        std::deque<std::unique_ptr<Transfer>> starting;
+        std::unordered_set<RequestId> cancels;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) {
+                return;
+            }
+            starting.swap(pending_);
+            cancels.swap(cancel_requests_);
+        }
+
+        for (auto& transfer : starting) {
+            if (cancels.count(transfer->id) > 0) {
+                finish(std::move(transfer), CURLE_OK, true);
+            } else {
+                startTransfer(std::move(transfer));
+            }
+        }
+        if (!cancels.empty()) {
+            std::vector<Transfer*> cancelled;
+            for (auto& transfer : running_) {
+                if (cancels.count(transfer->id) > 0) {
+                    cancelled.push_back(transfer.get());
+                }
+            }
+            for (Transfer* transfer : cancelled) {
+                finish(takeRunning(transfer), CURLE_OK, true);
+            }
+        }
+
+        int still_running = 0;
+        curl_multi_perform(multi, &still_running);
+
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+            CURLcode code = msg->data.result;
+            char* private_data = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &private_data);
+            std::unique_ptr<Transfer> transfer =
+                takeRunning(reinterpret_cast<Transfer*>(private_data));
+            if (transfer) {
+                finish(std::move(transfer), code, false);
+            }
+        }
+
+        // 等待套接字事件、curl 内部超时或 submit / cancel 的 wakeup
+        curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+    }
+}
+
+void HttpEngine::startTransfer(std::unique_ptr<Transfer> transfer) {
+    CURL* easy = curl_easy_init();
+    if (!easy) {
+        transfer->response.error = "curl_easy_init failed";
+        finish(std::move(transfer), CURLE_OK, false);
+        return;
+    }
+    transfer->easy = easy;
+    const HttpRequest& request = transfer->request;
+
+    for (const auto& header : request.headers) {
+        transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+    }
+
+    curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+    if (!request.body.empty()) {
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE,
+                         static_cast<curl_off_t>(request.body.size()));
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request.body.c_str());
+    }
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer.get());
+    curl_easy_setopt(
+        easy, CURLOPT_WRITEFUNCTION,
+        +[](char* data, size_t size, size_t nmemb, void* user_data) -> size_t {
+            auto* target = static_cast<Transfer*>(user_data);
+            size_t total = size * nmemb;
+            if (target->on_data) {
+                try {
+                    target->on_data(data, total);
+                } catch (const std::exception& e) {
+                    LOG_ERROR("HttpEngine: data callback threw: " + std::string(e.what()));
+                } catch (...) {
+                    LOG_ERROR("HttpEngine: data callback threw");
+                }
+            } else {
+                target->response.body.append(data, total);
+            }
+            return total;
+        });
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer.get());
+
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, request.connect_timeout_ms);
+    if (request.timeout_ms > 0) {
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, request.timeout_ms);
+    }
+    if (request.idle_timeout_ms > 0) {
+        // 平均速度低于 1 字节/秒持续 LOW_SPEED_TIME 秒即中止
+        curl_easy_setopt(easy, CURLOPT_LOW_SPEED_LIMIT, 1L);
+        curl_easy_setopt(easy, CURLOPT_LOW_SPEED_TIME,
+                         std::max(1L, (request.idle_timeout_ms + 999) / 1000));
+    }
+    // HTTPS 上协商 HTTP/2；新请求优先等待在已有连接上多路复用，而不是另开连接
+    curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    CURLMcode code = curl_multi_add_handle(static_cast<CURLM*>(multi_), easy);
+    if (code != CURLM_OK) {
+        transfer->response.error = curl_multi_strerror(code);
+        curl_easy_cleanup(easy);
+        transfer->easy = nullptr;
+        finish(std::move(transfer), CURLE_OK, false);
+        return;
+    }
+    running_.push_back(std::move(transfer));
+}
+
+std::unique_ptr<HttpEngine::Transfer> HttpEngine::takeRunning(Transfer* transfer) {
+    auto it = std::find_if(running_.begin(), running_.end(), [transfer](const auto& item) {
+        return item.get() == transfer;
+    });
+    if (it == running_.end()) {
+        return nullptr;
+    }
+    std::unique_ptr<Transfer> owned = std::move(*it);
+    running_.erase(it);
+    return owned;
+}
+
+void HttpEngine::finish(std::unique_ptr<Transfer> transfer, int curl_code, bool cancelled) {
+    HttpResponse& response = transfer->response;
+    response.cancelled = cancelled;
+    if (transfer->easy) {
+        long status = 0;
+        curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &status);
+        response.status = status;
+        long new_connections = 0;
+        curl_easy_getinfo(transfer->easy, CURLINFO_NUM_CONNECTS, &new_connections);
+        connections_opened_ += new_connections;
+        if (!cancelled && curl_code != CURLE_OK) {
+            response.error = curl_easy_strerror(static_cast<CURLcode>(curl_code));
+        }
+        curl_multi_remove_handle(static_cast<CURLM*>(multi_), transfer->easy);
+        curl_easy_cleanup(transfer->easy);
+        transfer->easy = nullptr;
+    }
+    curl_slist_free_all(transfer->headers);
+    transfer->headers = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ids_.erase(transfer->id);
+        cancel_requests_.erase(transfer->id);
+    }
+    if (transfer->on_done) {
+        try {
+            transfer->on_done(response);
+        } catch (const std::exception& e) {
+            LOG_ERROR("HttpEngine: done callback threw: " + std::string(e.what()));
+        } catch (...) {
+            LOG_ERROR("HttpEngine: done callback threw");
+        }
+    }
+}
+
+} // namespace ai_client
+} // namespace features
+} // namespace pnana
+
+#endif // BUILD_AI_CLIENT_SUPPORT
@@ -1,6 +1,7 @@
 #include "features/extract.h"
 #include "utils/archive_validator.h"
 #include "utils/logger.h"
+#include "utils/process_executor.h"
 #include <algorithm>
 #include <chrono>
 #include <cstdlib>
@@ -186,7 +187,8 @@ static void scanArchiveFilesParallel(const std::string& directory,
     }
 }
 
-ExtractManager::ExtractManager() : extracting_(false), cancel_requested_(false) {}
+ExtractManager::ExtractManager()
+    : extracting_(false), cancel_requested_(false), command_job_(0) {}
 
 ExtractManager::~ExtractManager() {
     if (extract_thread_.joinable()) {
@@ -318,13 +320,13 @@ bool ExtractManager::extractWithCommand(const std::string& archive_path,
         return false;
     }
 
-    std::ostringstream cmd;
-
+    // 参数直接作为 argv 传给解压工具，路径中的引号、空格等无需转义
+    utils::ProcessRequest request;
     if (type == "zip") {
         if (!commandExists("unzip")) {
             return false;
         }
-        cmd << "unzip -q -o \"" << archive_path << "\" -d \"" << extract_path << "\"";
+        request.argv = {"unzip", "-q", "-o", archive_path, "-d", extract_path};
     } else if (type == "tar" || type == "tar.gz" || type == "tar.bz2" || type == "tar.xz") {
         if (!commandExists("tar")) {
             return false;
@@ -337,50 +339,64 @@ bool ExtractManager::extractWithCommand(const std::string& archive_path,
         } else if (type == "tar.xz" || type == "txz") {
             tar_flags = "J";
         }
-        cmd << "tar -x" << tar_flags << "f \"" << archive_path << "\" -C \"" << extract_path
-            << "\"";
+        request.argv = {"tar", "-x" + tar_flags + "f", archive_path, "-C", extract_path};
     } else if (type == "gz") {
         if (!commandExists("gunzip")) {
             return false;
         }
-        cmd << "gunzip -c \"" << archive_path << "\" > \""
-            << (fs::path(extract_path) / fs::path(archive_path).stem()).string() << "\"";
+        request.argv = {"gunzip", "-c", archive_path};
+        request.stdout_path = (fs::path(extract_path) / fs::path(archive_path).stem()).string();
     } else if (type == "bz2") {
         if (!commandExists("bunzip2")) {
             return false;
         }
-        cmd << "bunzip2 -c \"" << archive_path << "\" > \""
-            << (fs::path(extract_path) / fs::path(archive_path).stem()).string() << "\"";
+        request.argv = {"bunzip2", "-c", archive_path};
+        request.stdout_path = (fs::path(extract_path) / fs::path(archive_path).stem()).string();
     } else if (type == "xz") {
         if (!commandExists("unxz")) {
             return false;
         }
-        cmd << "unxz -c \"" << archive_path << "\" > \""
-            << (fs::path(extract_path) / fs::path(archive_path).stem()).string() << "\"";
+        request.argv = {"unxz", "-c", archive_path};
+        request.stdout_path = (fs::path(extract_path) / fs::path(archive_path).stem()).string();
     } else if (type == "7z") {
         if (!commandExists("7z")) {
             return false;
         }
-        cmd << "7z x \"" << archive_path << "\" -o\"" << extract_path << "\" -y";
+        request.argv = {"7z", "x", archive_path, "-o" + extract_path, "-y"};
     } else if (type == "rar") {
         if (!commandExists("unrar")) {
             return false;
         }
-        cmd << "unrar x \"" << archive_path << "\" \"" << extract_path << "\" -y";
+        request.argv = {"unrar", "x", archive_path, extract_path, "-y"};
     } else {
         return false;
     }
 
-    // 执行命令
-    int result = std::system(cmd.str().c_str());
-    return (result == 0);
+    // 经子进程执行服务运行并等待结果；记下任务 id，cancelExtraction() 据此终止解压进程
+    request.max_output_bytes = 64 * 1024; // 解压工具的输出只用于错误日志
+    auto promise = std::make_shared<std::promise<utils::ProcessResult>>();
+    std::future<utils::ProcessResult> future = promise->get_future();
+    auto& executor = utils::ProcessExecutor::getInstance();
+    uint64_t job_id =
+        executor.submit(std::move(request), [promise](const utils::ProcessResult& result) {
+            promise->set_value(result);
+        });
+    command_job_.store(job_id);
+    if (cancel_requested_.load()) {
+        executor.cancel(job_id);
+    }
+    utils::ProcessResult result = future.get();
+    command_job_.store(0);
+
+    if (!result.ok() && !result.cancelled) {
+        LOG_WARNING("Extract command failed (exit " + std::to_string(result.exit_code) +
+                    "): " + (result.error.empty() ? result.error_output : result.error));
+    }
+    return result.ok();
 }
 
 bool ExtractManager::commandExists(const std::string& command) {
-    std::ostringstream cmd;
-    cmd << "command -v " << command << " > /dev/null 2>&1";
-    int result = std::system(cmd.str().c_str());
-    return (result == 0);
+    return utils::ProcessExecutor::findExecutable(command);
 }
 
 void ExtractManager::extractArchiveAsync(
@@ -471,6 +487,10 @@ void ExtractManager::extractArchiveAsync(
 
 void ExtractManager::cancelExtraction() {
     cancel_requested_.store(true);
+    uint64_t job_id = command_job_.load();
+    if (job_id != 0) {
+        utils::ProcessExecutor::getInstance().cancel(job_id);
+    }
 }
 
 } // namespace features
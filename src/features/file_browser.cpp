@@ -1,5 +1,6 @@
 #include "features/file_browser.h"
 #include "ui/file_browser_view.h"
+#include "utils/directory_reader.h"
 #include "utils/file_info_utils.h"
 #include <algorithm>
 #include <cctype>
@@ -7,13 +8,23 @@
 #include <fstream>
 #include <functional>
 #include <sstream>
+#include <thread>
 
 namespace pnana {
 namespace features {
 
+namespace {
+void markLastChild(std::vector<FileItem>& items) {
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i].last_child = (i + 1 == items.size());
+    }
+}
+} // namespace
+
 FileBrowser::FileBrowser(ui::Theme& theme)
     : theme_(theme), selected_index_(0), visible_(false), show_hidden_(false),
-      directory_loaded_(false), clipboard_data_{} {
+      directory_loaded_(false), clipboard_data_{},
+      loader_shared_(std::make_shared<LoaderShared>()) {
     // 初始化当前目录为绝对路径
     try {
         current_directory_ = fs::current_path().string();
@@ -50,6 +61,16 @@ bool FileBrowser::openDirectory(const std::string& path) {
     }
 }
 
+FileBrowser::~FileBrowser() {
+    std::lock_guard<std::mutex> lock(loader_shared_->mutex);
+    loader_shared_->dispatcher = nullptr;
+}
+
+void FileBrowser::setUIDispatcher(UIDispatcher dispatcher) {
+    std::lock_guard<std::mutex> lock(loader_shared_->mutex);
+    loader_shared_->dispatcher = std::move(dispatcher);
+}
+
 void FileBrowser::setRemoteLoader(RemoteLoader fn) {
     remote_loader_ = std::move(fn);
 }
@@ -112,7 +133,7 @@ void FileBrowser::setVisible(bool visible) {
 void FileBrowser::loadDirectory() {
     tree_items_.clear();
     flat_items_.clear();
-    items_.clear();
+    ++tree_generation_;
 
     if (remote_loader_) {
         std::vector<FileItem> loaded = remote_loader_(current_directory_);
@@ -141,11 +162,9 @@ void FileBrowser::loadDirectory() {
         std::sort(rfiles.begin(), rfiles.end(), ciLessRemote);
         tree_items_.insert(tree_items_.end(), rdirs.begin(), rdirs.end());
         tree_items_.insert(tree_items_.end(), rfiles.begin(), rfiles.end());
+        markLastChild(tree_items_);
 
         flattenTree(tree_items_, flat_items_);
-        for (auto* item : flat_items_) {
-            items_.push_back(*item);
-        }
         if (selected_index_ >= flat_items_.size() && !flat_items_.empty()) {
             selected_index_ = flat_items_.size() - 1;
         }
@@ -158,60 +177,11 @@ void FileBrowser::loadDirectory() {
         return;
     }
 
-    try {
-        // 读取目录内容
-        std::vector<FileItem> dirs;
-        std::vector<FileItem> files;
-
-        for (const auto& entry : fs::directory_iterator(current_directory_)) {
-            std::string name = entry.path().filename().string();
-
-            // 跳过隐藏文件（如果设置不显示）
-            if (!show_hidden_ && !name.empty() && name[0] == '.') {
-                continue;
-            }
-
-            FileItem item(name, entry.path().string(), entry.is_directory(), 0);
-
-            // 优化：延迟文件大小获取，只在需要显示时才获取
-            // 文件大小在渲染时按需获取，避免启动时的大量系统调用
-            // 这里只设置基本属性，size 保持为 0
-            // 如果需要显示文件大小，可以在 render() 或 getItemSize() 中按需获取
-
-            if (entry.is_directory()) {
-                dirs.push_back(item);
-            } else {
-                files.push_back(item);
-            }
-        }
-
-        // 排序：目录在前，文件在后，大小写不敏感
-        auto ciLess = [](const FileItem& a, const FileItem& b) {
-            std::string al = a.name, bl = b.name;
-            std::transform(al.begin(), al.end(), al.begin(), ::tolower);
-            std::transform(bl.begin(), bl.end(), bl.begin(), ::tolower);
-            if (al != bl)
-                return al < bl;
-            return a.name < b.name;
-        };
-        std::sort(dirs.begin(), dirs.end(), ciLess);
-        std::sort(files.begin(), files.end(), ciLess);
-
-        // 构建树形结构
-        tree_items_.insert(tree_items_.end(), dirs.begin(), dirs.end());
-        tree_items_.insert(tree_items_.end(), files.begin(), files.end());
+    // 读取失败时保持空列表
+    tree_items_ = readLocalChildren(current_directory_, show_hidden_, 0);
 
-        // 展平树形结构用于显示和导航
-        flattenTree(tree_items_, flat_items_);
-
-        // 为了兼容性，也填充 items_
-        for (auto* item : flat_items_) {
-            items_.push_back(*item);
-        }
-
-    } catch (const std::exception&) {
-        // 读取失败，保持空列表
-    }
+    // 展平树形结构用于显示和导航
+    flattenTree(tree_items_, flat_items_);
 
     // 确保选中索引有效
     if (selected_index_ >= flat_items_.size() && !flat_items_.empty()) {
@@ -262,60 +232,37 @@ void FileBrowser::loadDirectoryRecursive(FileItem& item) {
 
         item.children.insert(item.children.end(), rdirs.begin(), rdirs.end());
         item.children.insert(item.children.end(), rfiles.begin(), rfiles.end());
+        markLastChild(item.children);
         item.loaded = true;
         return;
     }
 
     // 本地模式：使用本地文件系统
-    try {
-        item.children.clear();
-        std::vector<FileItem> dirs;
-        std::vector<FileItem> files;
-
-        for (const auto& entry : fs::directory_iterator(item.path)) {
-            std::string name = entry.path().filename().string();
-
-            // 跳过隐藏文件（如果设置不显示）
-            if (!show_hidden_ && !name.empty() && name[0] == '.') {
-                continue;
-            }
-
-            FileItem child(name, entry.path().string(), entry.is_directory(), item.depth + 1);
-
-            if (!entry.is_directory() && fs::is_regular_file(entry)) {
-                try {
-                    child.size = fs::file_size(entry);
-                } catch (...) {
-                    child.size = 0;
-                }
-            }
-
-            if (entry.is_directory()) {
-                dirs.push_back(child);
-            } else {
-                files.push_back(child);
-            }
-        }
-
-        // 排序（大小写不敏感）
-        auto ciLessItem = [](const FileItem& a, const FileItem& b) {
-            std::string al = a.name, bl = b.name;
-            std::transform(al.begin(), al.end(), al.begin(), ::tolower);
-            std::transform(bl.begin(), bl.end(), bl.begin(), ::tolower);
-            if (al != bl)
-                return al < bl;
-            return a.name < b.name;
-        };
-        std::sort(dirs.begin(), dirs.end(), ciLessItem);
-        std::sort(files.begin(), files.end(), ciLessItem);
+    item.children = readLocalChildren(item.path, show_hidden_, item.depth + 1);
+    item.loaded = true;
+}
 
-        item.children.insert(item.children.end(), dirs.begin(), dirs.end());
-        item.children.insert(item.children.end(), files.begin(), files.end());
-        item.loaded = true;
+std::vector<FileItem> FileBrowser::readLocalChildren(const std::string& path, bool show_hidden,
+                                                     int depth) {
+    std::vector<FileItem> children;
+    std::vector<utils::DirectoryEntry> entries;
+    if (!utils::readDirectory(path, show_hidden, entries)) {
+        return children;
+    }
+    // 目录在前，大小写不敏感
+    utils::sortDirectoryEntries(entries);
 
-    } catch (const std::exception&) {
-        // 读取失败
+    // 只需要名称与类型：不 stat，大小在信息栏按需获取
+    std::string prefix = path;
+    if (prefix.empty() || prefix.back() != '/') {
+        prefix += '/';
     }
+    children.reserve(entries.size());
+    for (auto& entry : entries) {
+        children.emplace_back(entry.name, prefix + entry.name, entry.is_directory, depth);
+    }
+    markLastChild(children);
+    return children;
 }
 
 void FileBrowser::flattenTree(const std::vector<FileItem>& tree, std::vector<FileItem*>& flat,
@@ -326,7 +273,7 @@ void FileBrowser::flattenTree(const std::vector<FileItem>& tree, std::vector<Fil
 
         // 如果展开且是目录，递归添加子项
         if (item.is_directory && item.expanded) {
-            if (!item.loaded) {
+            if (!item.loaded && !item.loading) {
                 loadDirectoryRecursive(item);
             }
             flattenTree(item.children, flat, depth + 1);
@@ -334,6 +281,99 @@ void FileBrowser::flattenTree(const std::vector<FileItem>& tree, std::vector<Fil
     }
 }
 
+void FileBrowser::expandFlatItem(size_t index) {
+    FileItem* item = flat_items_[index];
+    if (item->loading) {
+        return;
+    }
+    std::vector<FileItem*> subtree;
+    flattenTree(item->children, subtree, item->depth + 1);
+    if (subtree.empty()) {
+        return;
+    }
+    flat_items_.insert(flat_items_.begin() + static_cast<std::ptrdiff_t>(index + 1),
+                       subtree.begin(), subtree.end());
+
+    size_t inserted = subtree.size();
+    if (selected_index_ > index) {
+        selected_index_ += inserted;
+    }
+    std::set<size_t> updated_selections;
+    for (size_t selected : selected_indices_) {
+        updated_selections.insert(selected > index ? selected + inserted : selected);
+    }
+    selected_indices_ = std::move(updated_selections);
+}
+
+void FileBrowser::collapseFlatItem(size_t index) {
+    int depth = flat_items_[index]->depth;
+    size_t end = index + 1;
+    while (end < flat_items_.size() && flat_items_[end]->depth > depth) {
+        ++end;
+    }
+    size_t removed = end - index - 1;
+    if (removed == 0) {
+        return;
+    }
+    flat_items_.erase(flat_items_.begin() + static_cast<std::ptrdiff_t>(index + 1),
+                      flat_items_.begin() + static_cast<std::ptrdiff_t>(end));
+
+    if (selected_index_ >= end) {
+        selected_index_ -= removed;
+    } else if (selected_index_ > index) {
+        selected_index_ = index;
+    }
+    std::set<size_t> updated_selections;
+    for (size_t selected : selected_indices_) {
+        if (selected <= index) {
+            updated_selections.insert(selected);
+        } else if (selected >= end) {
+            updated_selections.insert(selected - removed);
+        }
+    }
+    selected_indices_ = std::move(updated_selections);
+}
+
+void FileBrowser::startBackgroundLoad(FileItem* item) {
+    item->loading = true;
+    std::shared_ptr<LoaderShared> shared = loader_shared_;
+    uint64_t generation = tree_generation_;
+    std::string path = item->path;
+    bool show_hidden = show_hidden_;
+    int depth = item->depth + 1;
+
+    std::thread([this, shared, generation, item, path, show_hidden, depth]() {
+        std::vector<FileItem> children = readLocalChildren(path, show_hidden, depth);
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        if (!shared->dispatcher) {
+            return; // FileBrowser 已析构
+        }
+        auto payload = std::make_shared<std::vector<FileItem>>(std::move(children));
+        shared->dispatcher([this, generation, item, payload]() {
+            onChildrenLoaded(generation, item, std::move(*payload));
+        });
+    }).detach();
+}
+
+void FileBrowser::onChildrenLoaded(uint64_t generation, FileItem* item,
+                                   std::vector<FileItem> children) {
+    // 期间整棵树已重建（刷新、切换目录、文件操作），item 已失效
+    if (generation != tree_generation_) {
+        return;
+    }
+    item->children = std::move(children);
+    item->loaded = true;
+    item->loading = false;
+    if (!item->expanded) {
+        return;
+    }
+    // 折叠的祖先下面的目录不在 flat_items_ 中，展开祖先时 flattenTree 会带上它的子项
+    auto it = std::find(flat_items_.begin(), flat_items_.end(), item);
+    if (it != flat_items_.end()) {
+        expandFlatItem(static_cast<size_t>(it - flat_items_.begin()));
+    }
+}
+
 void FileBrowser::selectNext() {
     if (!flat_items_.empty() && selected_index_ < flat_items_.size() - 1) {
         selected_index_++;
@@ -401,42 +441,27 @@ bool FileBrowser::toggleSelected() {
             goUp();
             return false;
         }
-        // 切换展开/折叠状态
-        item->expanded = !item->expanded;
-
-        // 如果展开，加载子目录
-        if (item->expanded && !item->loaded) {
-            loadDirectoryRecursive(*item);
-        }
-
-        // 重新展平树形结构
-        flat_items_.clear();
-        items_.clear();
-        flattenTree(tree_items_, flat_items_);
-
-        // 为了兼容性，也填充 items_
-        for (auto* it : flat_items_) {
-            items_.push_back(*it);
-        }
-
-        // 保持选中当前项
-        for (size_t i = 0; i < flat_items_.size(); ++i) {
-            if (flat_items_[i] == item) {
-                selected_index_ = i;
-                // 更新多选索引
-                std::set<size_t> updated_selections;
-                for (size_t old_idx : selected_indices_) {
-                    // 找到对应的新索引（如果有）
-                    for (size_t j = 0; j < flat_items_.size(); ++j) {
-                        if (flat_items_[j]->path == flat_items_[old_idx]->path) {
-                            updated_selections.insert(j);
-                            break;
-                        }
-                    }
+        // 切换展开/折叠状态：只增删该目录的可见子孙，选中项保持不变
+        if (item->expanded) {
+            item->expanded = false;
+            collapseFlatItem(selected_index_);
+        } else {
+            item->expanded = true;
+            if (!item->loaded && !item->loading) {
+                bool background;
+                {
+                    std::lock_guard<std::mutex> lock(loader_shared_->mutex);
+                    background = loader_shared_->dispatcher && !remote_loader_ &&
+                                 !remote_recursive_loader_;
                 }
-                selected_indices_ = updated_selections;
-                break;
+                if (background) {
+                    // 子项到达后由 onChildrenLoaded() 插入
+                    startBackgroundLoad(item);
+                    return false;
+                }
+                loadDirectoryRecursive(*item);
             }
+            expandFlatItem(selected_index_);
         }
 
         return false; // 不是文件，不打开
@@ -0,0 +1,362 @@
+#include "features/hex_view/hex_buffer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace pnana {
+namespace features {
+
+namespace {
+
+// 搜索时每次扫描的字节数：块之间检查取消，并提前让内核预读下一块
+constexpr uint64_t SEARCH_CHUNK = 16ull * 1024 * 1024;
+
+bool writeAll(int fd, const uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+size_t findBytes(const uint8_t* haystack, size_t size, const uint8_t* needle, size_t needle_size) {
+    if (needle_size == 0 || needle_size > size) {
+        return size;
+    }
+    if (needle_size == 1) {
+        const void* found = std::memchr(haystack, needle[0], size);
+        return found ? static_cast<size_t>(static_cast<const uint8_t*>(found) - haystack) : size;
+    }
+
+    const size_t last = size - needle_size; // 最后一个可能的起点
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0]));
+    const __m128i tail = _mm_set1_epi8(static_cast<char>(needle[needle_size - 1]));
+    for (; i + 16 <= last + 1; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+        __m128i b =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + needle_size - 1));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, tail))));
+        while (mask != 0) {
+            size_t candidate = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (std::memcmp(haystack + candidate + 1, needle + 1, needle_size - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    while (i <= last) {
+        const void* found = std::memchr(haystack + i, needle[0], last - i + 1);
+        if (!found) {
+            break;
+        }
+        i = static_cast<size_t>(static_cast<const uint8_t*>(found) - haystack);
+        if (std::memcmp(haystack + i + 1, needle + 1, needle_size - 1) == 0) {
+            return i;
+        }
+        ++i;
+    }
+    return size;
+}
+
+struct HexBuffer::MappedFile {
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+    dev_t device = 0;
+    ino_t inode = 0;
+
+    ~MappedFile() {
+        if (data) {
+            munmap(const_cast<uint8_t*>(data), static_cast<size_t>(size));
+        }
+    }
+
+    // 提示内核预读 [offset, offset + length)（映射整体是 MADV_RANDOM）
+    void prefetch(uint64_t offset, uint64_t length) const {
+        if (!data || offset >= size) {
+            return;
+        }
+        static const uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        uint64_t begin = offset - offset % page_size;
+        uint64_t end = std::min(size, offset + length);
+        madvise(const_cast<uint8_t*>(data) + begin, static_cast<size_t>(end - begin),
+                MADV_WILLNEED);
+    }
+};
+
+bool HexBuffer::open(const std::string& filepath) {
+    close();
+    filepath_ = filepath;
+    last_error_.clear();
+
+    int fd = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        last_error_ = std::string("Cannot open file: ") + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        last_error_ = "Not a regular file";
+        ::close(fd);
+        return false;
+    }
+
+    auto file = std::make_shared<MappedFile>();
+    file->size = static_cast<uint64_t>(st.st_size);
+    file->device = st.st_dev;
+    file->inode = st.st_ino;
+    if (file->size > static_cast<uint64_t>(SIZE_MAX)) {
+        last_error_ = "File too large to map on this platform";
+        ::close(fd);
+        return false;
+    }
+    if (file->size > 0) {
+        void* addr = mmap(nullptr, static_cast<size_t>(file->size), PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            last_error_ = std::string("mmap failed: ") + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        // 视图会跳到任意偏移，关闭预读，只调入实际访问的页
+        madvise(addr, static_cast<size_t>(file->size), MADV_RANDOM);
+        file->data = static_cast<const uint8_t*>(addr);
+    }
+    ::close(fd); // 映射本身持有文件引用
+    file_ = std::move(file);
+    return true;
+}
+
+void HexBuffer::close() {
+    file_.reset();
+    pages_.clear();
+}
+
+uint64_t HexBuffer::size() const {
+    return file_ ? file_->size : 0;
+}
+
+const uint8_t* HexBuffer::originalData() const {
+    return file_ ? file_->data : nullptr;
+}
+
+size_t HexBuffer::read(uint64_t offset, uint8_t* out, size_t count) const {
+    const uint64_t total = size();
+    if (offset >= total) {
+        return 0;
+    }
+    count = static_cast<size_t>(std::min<uint64_t>(count, total - offset));
+    size_t done = 0;
+    while (done < count) {
+        uint64_t pos = offset + done;
+        size_t in_page = static_cast<size_t>(pos % PAGE_SIZE);
+        size_t length = std::min<size_t>(count - done, PAGE_SIZE - in_page);
+        auto it = pages_.find(pos / PAGE_SIZE);
+        const uint8_t* source =
+            it != pages_.end() ? it->second.data() + in_page : originalData() + pos;
+        std::memcpy(out + done, source, length);
+        done += length;
+    }
+    return count;
+}
+
+uint8_t HexBuffer::byteAt(uint64_t offset) const {
+    uint8_t value = 0;
+    read(offset, &value, 1);
+    return value;
+}
+
+bool HexBuffer::isModified(uint64_t offset) const {
+    auto it = pages_.find(offset / PAGE_SIZE);
+    return it != pages_.end() && it->second[offset % PAGE_SIZE] != originalData()[offset];
+}
+
+std::vector<uint8_t>& HexBuffer::patchPage(uint64_t page_index) {
+    auto it = pages_.find(page_index);
+    if (it != pages_.end()) {
+        return it->second;
+    }
+    const uint64_t begin = page_index * PAGE_SIZE;
+    const uint64_t end = std::min(size(), begin + PAGE_SIZE);
+    std::vector<uint8_t> page(originalData() + begin, originalData() + end);
+    return pages_.emplace(page_index, std::move(page)).first->second;
+}
+
+bool HexBuffer::setByte(uint64_t offset, uint8_t value) {
+    if (offset >= size()) {
+        return false;
+    }
+    if (byteAt(offset) == value) {
+        return true;
+    }
+    const uint64_t page_index = offset / PAGE_SIZE;
+    std::vector<uint8_t>& page = patchPage(page_index);
+    page[offset % PAGE_SIZE] = value;
+    if (std::memcmp(page.data(), originalData() + page_index * PAGE_SIZE, page.size()) == 0) {
+        pages_.erase(page_index);
+    }
+    return true;
+}
+
+void HexBuffer::revertByte(uint64_t offset) {
+    if (offset >= size()) {
+        return;
+    }
+    setByte(offset, originalData()[offset]);
+}
+
+bool HexBuffer::save(size_t* pages_written) {
+    if (pages_written) {
+        *pages_written = 0;
+    }
+    if (!file_) {
+        last_error_ = "No file is open";
+        return false;
+    }
+    if (pages_.empty()) {
+        return true;
+    }
+
+    int fd = ::open(filepath_.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        last_error_ = std::string("Cannot open file for writing: ") + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_dev != file_->device || st.st_ino != file_->inode ||
+        static_cast<uint64_t>(st.st_size) != file_->size) {
+        last_error_ = "File changed on disk since it was opened";
+        ::close(fd);
+        return false;
+    }
+
+    size_t written = 0;
+    for (const auto& [page_index, bytes] : pages_) {
+        if (!writeAll(fd, bytes.data(), bytes.size(), page_index * PAGE_SIZE)) {
+            last_error_ = std::string("Write failed: ") + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        ++written;
+    }
+    if (fsync(fd) != 0) {
+        last_error_ = std::string("fsync failed: ") + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    ::close(fd);
+
+    // 共享映射与页缓存一致，写回后映射里就是新内容
+    pages_.clear();
+    if (pages_written) {
+        *pages_written = written;
+    }
+    return true;
+}
+
+bool HexBuffer::overlapsPatches(uint64_t begin, uint64_t end) const {
+    auto it = pages_.lower_bound(begin / PAGE_SIZE);
+    return it != pages_.end() && it->first * PAGE_SIZE < end;
+}
+
+int64_t HexBuffer::findInRange(const uint8_t* pattern, size_t pattern_size, uint64_t begin,
+                               uint64_t limit, const std::atomic<bool>* cancel,
+                               std::atomic<uint64_t>* scanned) const {
+    std::vector<uint8_t> scratch;
+    for (uint64_t pos = begin; pos + pattern_size <= limit; pos += SEARCH_CHUNK) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            return -1;
+        }
+        // 每块多带 pattern_size - 1 字节，跨块的匹配不会漏掉
+        const uint64_t chunk_end = std::min(limit, pos + SEARCH_CHUNK + pattern_size - 1);
+        const size_t length = static_cast<size_t>(chunk_end - pos);
+        file_->prefetch(chunk_end, SEARCH_CHUNK);
+
+        const uint8_t* base = originalData() + pos;
+        if (overlapsPatches(pos, chunk_end)) {
+            scratch.resize(length);
+            read(pos, scratch.data(), length);
+            base = scratch.data();
+        }
+        size_t hit = findBytes(base, length, pattern, pattern_size);
+        if (hit != length) {
+            return static_cast<int64_t>(pos + hit);
+        }
+        if (scanned) {
+            scanned->fetch_add(std::min(SEARCH_CHUNK, limit - pos), std::memory_order_relaxed);
+        }
+    }
+    return -1;
+}
+
+int64_t HexBuffer::find(const std::string& pattern, uint64_t from,
+                        const std::atomic<bool>* cancel, std::atomic<uint64_t>* scanned) const {
+    const uint64_t total = size();
+    const size_t pattern_size = pattern.size();
+    if (pattern_size == 0 || pattern_size > total) {
+        return -1;
+    }
+    from = std::min(from, total);
+    const auto* bytes = reinterpret_cast<const uint8_t*>(pattern.data());
+    file_->prefetch(from, SEARCH_CHUNK);
+
+    int64_t hit = findInRange(bytes, pattern_size, from, total, cancel, scanned);
+    if (hit >= 0 || (cancel && cancel->load())) {
+        return hit;
+    }
+    // 回绕：起点在 from 之前的匹配
+    return findInRange(bytes, pattern_size, 0, std::min(total, from + pattern_size - 1), cancel,
+                       scanned);
+}
+
+HexSearchWorker::~HexSearchWorker() {
+    cancel();
+}
+
+void HexSearchWorker::start(HexBuffer snapshot, std::string pattern, uint64_t from,
+                            ResultCallback callback) {
+    cancel();
+    scanned_.store(0);
+    running_.store(true);
+    thread_ = std::thread([this, snapshot = std::move(snapshot), pattern = std::move(pattern),
+                           from, callback = std::move(callback)]() {
+        int64_t offset = snapshot.find(pattern, from, &cancel_, &scanned_);
+        bool cancelled = cancel_.load();
+        running_.store(false);
+        if (callback) {
+            callback(offset, cancelled);
+        }
+    });
+}
+
+void HexSearchWorker::cancel() {
+    cancel_.store(true);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    cancel_.store(false);
+    running_.store(false);
+}
+
+} // namespace features
+} // namespace pnana
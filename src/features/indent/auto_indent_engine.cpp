@@ -1,80 +1,10 @@
 #include "features/indent/auto_indent_engine.h"
+#include "features/syntax_tree/syntax_tree_service.h"
 #include "utils/logger.h"
 #include <algorithm>
 #include <cctype>
 #include <cstring>
 
-#ifdef BUILD_TREE_SITTER_SUPPORT
-extern "C" {
-#ifdef BUILD_TREE_SITTER_CPP
-TSLanguage* tree_sitter_cpp();
-#endif
-#ifdef BUILD_TREE_SITTER_C
-TSLanguage* tree_sitter_c();
-#endif
-#ifdef BUILD_TREE_SITTER_PYTHON
-TSLanguage* tree_sitter_python();
-#endif
-#ifdef BUILD_TREE_SITTER_JAVASCRIPT
-TSLanguage* tree_sitter_javascript();
-#endif
-#ifdef BUILD_TREE_SITTER_TYPESCRIPT
-TSLanguage* tree_sitter_typescript();
-#endif
-#ifdef BUILD_TREE_SITTER_JSON
-TSLanguage* tree_sitter_json();
-#endif
-#ifdef BUILD_TREE_SITTER_BASH
-TSLanguage* tree_sitter_bash();
-#endif
-#ifdef BUILD_TREE_SITTER_RUST
-TSLanguage* tree_sitter_rust();
-#endif
-#ifdef BUILD_TREE_SITTER_GO
-TSLanguage* tree_sitter_go();
-#endif
-#ifdef BUILD_TREE_SITTER_JAVA
-TSLanguage* tree_sitter_java();
-#endif
-#ifdef BUILD_TREE_SITTER_RUBY
-TSLanguage* tree_sitter_ruby();
-#endif
-#ifdef BUILD_TREE_SITTER_KOTLIN
-TSLanguage* tree_sitter_kotlin();
-#endif
-#ifdef BUILD_TREE_SITTER_SWIFT
-TSLanguage* tree_sitter_swift();
-#endif
-#ifdef BUILD_TREE_SITTER_CSHARP
-TSLanguage* tree_sitter_c_sharp();
-#endif
-#ifdef BUILD_TREE_SITTER_PHP
-TSLanguage* tree_sitter_php();
-#endif
-#ifdef BUILD_TREE_SITTER_LUA
-TSLanguage* tree_sitter_lua();
-#endif
-#ifdef BUILD_TREE_SITTER_ZIG
-TSLanguage* tree_sitter_zig();
-#endif
-#ifdef BUILD_TREE_SITTER_YAML
-TSLanguage* tree_sitter_yaml();
-#endif
-#ifdef BUILD_TREE_SITTER_SQL
-TSLanguage* tree_sitter_sql();
-#endif
-#ifdef BUILD_TREE_SITTER_CSS
-TSLanguage* tree_sitter_css();
-#endif
-#ifdef BUILD_TREE_SITTER_XML
-TSLanguage* tree_sitter_xml();
-#endif
-#ifdef BUILD_TREE_SITTER_HTML
-TSLanguage* tree_sitter_html();
-#endif
-}
-#endif
-
 namespace pnana {
 namespace features {
 
@@ -82,24 +12,12 @@ AutoIndentEngine::AutoIndentEngine(const core::ConfigManager& config_manager)
     : config_manager_(config_manager), file_type_("text"), indent_config_{4, true, true, {}}
 #ifdef BUILD_TREE_SITTER_SUPPORT
       ,
-      parser_(nullptr), current_language_(nullptr)
+      current_language_(nullptr)
 #endif
 {
-#ifdef BUILD_TREE_SITTER_SUPPORT
-    parser_ = ts_parser_new();
-    if (parser_) {
-        initializeLanguages();
-    }
-#endif
 }
 
-AutoIndentEngine::~AutoIndentEngine() {
-#ifdef BUILD_TREE_SITTER_SUPPORT
-    if (parser_) {
-        ts_parser_delete(parser_);
-    }
-#endif
-}
+AutoIndentEngine::~AutoIndentEngine() = default;
 
 void AutoIndentEngine::setFileType(const std::string& file_type) {
     if (file_type_ == file_type) {
@@ -108,10 +26,9 @@ void AutoIndentEngine::setFileType(const std::string& file_type) {
     file_type_ = file_type;
 
 #ifdef BUILD_TREE_SITTER_SUPPORT
-    TSLanguage* lang = getLanguageForFileType(file_type);
+    TSLanguage* lang = SyntaxTreeService::languageForFileType(file_type);
 
-    if (lang && parser_) {
-        ts_parser_set_language(parser_, lang);
+    if (lang) {
         current_language_ = lang;
 
         IndentQuery& query = indent_query_map_[file_type];
@@ -136,10 +53,9 @@ void AutoIndentEngine::setFileType(const std::string& file_type,
     file_type_ = file_type;
 
 #ifdef BUILD_TREE_SITTER_SUPPORT
-    TSLanguage* lang = getLanguageForFileType(file_type);
+    TSLanguage* lang = SyntaxTreeService::languageForFileType(file_type);
 
-    if (lang && parser_) {
-        ts_parser_set_language(parser_, lang);
+    if (lang) {
         current_language_ = lang;
 
         IndentQuery& query = indent_query_map_[file_type];
@@ -157,20 +73,22 @@ void AutoIndentEngine::setIndentConfig(const core::LanguageIndentConfig& config)
 }
 
 std::string AutoIndentEngine::computeIndent(const std::vector<std::string>& lines,
-                                            size_t cursor_row, size_t cursor_col) const {
+                                            size_t cursor_row, size_t cursor_col,
+                                            const TSTree* tree) const {
     if (lines.empty() || cursor_row >= lines.size()) {
         return "";
     }
 
 #ifdef BUILD_TREE_SITTER_SUPPORT
-    if (current_language_ && indent_config_.smart_indent) {
-        int level = computeIndentFromTree(lines, cursor_row, cursor_col);
+    if (tree && current_language_ && indent_config_.smart_indent) {
+        int level = computeIndentFromTree(tree, lines, cursor_row, cursor_col);
         if (level >= 0) {
             return indentToString(level);
         }
     }
 #else
     (void)cursor_col;
+    (void)tree;
 #endif
 
     int level = computeIndentFallback(lines, cursor_row, cursor_col);
@@ -178,8 +96,8 @@ std::string AutoIndentEngine::computeIndent(const std::vector<std::string>& line
 }
 
 std::string AutoIndentEngine::computeIndentAfterNewline(const std::vector<std::string>& lines,
-                                                        size_t cursor_row,
-                                                        size_t cursor_col) const {
+                                                        size_t cursor_row, size_t cursor_col,
+                                                        const TSTree* tree) const {
     if (lines.empty() || cursor_row == 0) {
         return "";
     }
@@ -196,14 +114,15 @@ std::string AutoIndentEngine::computeIndentAfterNewline(const std::vector<std::s
     }
 
 #ifdef BUILD_TREE_SITTER_SUPPORT
-    if (current_language_ && indent_config_.smart_indent) {
-        int level = computeIndentFromTree(lines, cursor_row, cursor_col);
+    if (tree && current_language_ && indent_config_.smart_indent) {
+        int level = computeIndentFromTree(tree, lines, cursor_row, cursor_col);
         if (level >= 0) {
             return indentToString(level);
         }
     }
 #else
     (void)cursor_col;
+    (void)tree;
 #endif
 
     int level = computeIndentFallback(lines, cursor_row, cursor_col);
@@ -223,202 +142,13 @@ core::LanguageIndentConfig AutoIndentEngine::getDefaultConfigForLanguage(
 
 bool AutoIndentEngine::isTreeSitterEnabled() const {
 #ifdef BUILD_TREE_SITTER_SUPPORT
-    return parser_ != nullptr && current_language_ != nullptr;
+    return current_language_ != nullptr;
 #else
     return false;
 #endif
 }
 
 #ifdef BUILD_TREE_SITTER_SUPPORT
-void AutoIndentEngine::initializeLanguages() {
-#ifdef BUILD_TREE_SITTER_CPP
-    TSLanguage* cpp_lang = tree_sitter_cpp();
-    if (cpp_lang) {
-        language_map_["cpp"] = cpp_lang;
-        language_map_["cxx"] = cpp_lang;
-        language_map_["cc"] = cpp_lang;
-        language_map_["c++"] = cpp_lang;
-        language_map_["hpp"] = cpp_lang;
-        language_map_["hxx"] = cpp_lang;
-        language_map_["hh"] = cpp_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_C
-    TSLanguage* c_lang = tree_sitter_c();
-    if (c_lang) {
-        language_map_["c"] = c_lang;
-        language_map_["h"] = c_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_PYTHON
-    TSLanguage* python_lang = tree_sitter_python();
-    if (python_lang) {
-        language_map_["py"] = python_lang;
-        language_map_["python"] = python_lang;
-        language_map_["pyw"] = python_lang;
-        language_map_["pyi"] = python_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_JAVASCRIPT
-    TSLanguage* js_lang = tree_sitter_javascript();
-    if (js_lang) {
-        language_map_["js"] = js_lang;
-        language_map_["javascript"] = js_lang;
-        language_map_["jsx"] = js_lang;
-        language_map_["mjs"] = js_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_TYPESCRIPT
-    TSLanguage* ts_lang = tree_sitter_typescript();
-    if (ts_lang) {
-        language_map_["ts"] = ts_lang;
-        language_map_["typescript"] = ts_lang;
-        language_map_["tsx"] = ts_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_JSON
-    TSLanguage* json_lang = tree_sitter_json();
-    if (json_lang) {
-        language_map_["json"] = json_lang;
-        language_map_["jsonc"] = json_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_BASH
-    TSLanguage* bash_lang = tree_sitter_bash();
-    if (bash_lang) {
-        language_map_["sh"] = bash_lang;
-        language_map_["bash"] = bash_lang;
-        language_map_["shell"] = bash_lang;
-        language_map_["zsh"] = bash_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_RUST
-    TSLanguage* rust_lang = tree_sitter_rust();
-    if (rust_lang) {
-        language_map_["rs"] = rust_lang;
-        language_map_["rust"] = rust_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_GO
-    TSLanguage* go_lang = tree_sitter_go();
-    if (go_lang) {
-        language_map_["go"] = go_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_JAVA
-    TSLanguage* java_lang = tree_sitter_java();
-    if (java_lang) {
-        language_map_["java"] = java_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_RUBY
-    TSLanguage* ruby_lang = tree_sitter_ruby();
-    if (ruby_lang) {
-        language_map_["rb"] = ruby_lang;
-        language_map_["ruby"] = ruby_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_KOTLIN
-    TSLanguage* kotlin_lang = tree_sitter_kotlin();
-    if (kotlin_lang) {
-        language_map_["kt"] = kotlin_lang;
-        language_map_["kotlin"] = kotlin_lang;
-        language_map_["kts"] = kotlin_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_SWIFT
-    TSLanguage* swift_lang = tree_sitter_swift();
-    if (swift_lang) {
-        language_map_["swift"] = swift_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_CSHARP
-    TSLanguage* csharp_lang = tree_sitter_c_sharp();
-    if (csharp_lang) {
-        language_map_["cs"] = csharp_lang;
-        language_map_["csharp"] = csharp_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_PHP
-    TSLanguage* php_lang = tree_sitter_php();
-    if (php_lang) {
-        language_map_["php"] = php_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_LUA
-    TSLanguage* lua_lang = tree_sitter_lua();
-    if (lua_lang) {
-        language_map_["lua"] = lua_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_ZIG
-    TSLanguage* zig_lang = tree_sitter_zig();
-    if (zig_lang) {
-        language_map_["zig"] = zig_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_YAML
-    TSLanguage* yaml_lang = tree_sitter_yaml();
-    if (yaml_lang) {
-        language_map_["yaml"] = yaml_lang;
-        language_map_["yml"] = yaml_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_SQL
-    TSLanguage* sql_lang = tree_sitter_sql();
-    if (sql_lang) {
-        language_map_["sql"] = sql_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_CSS
-    TSLanguage* css_lang = tree_sitter_css();
-    if (css_lang) {
-        language_map_["css"] = css_lang;
-        language_map_["scss"] = css_lang;
-        language_map_["sass"] = css_lang;
-        language_map_["less"] = css_lang;
-    }
-#endif
-
-#ifdef BUILD_TREE_SITTER_XML
-    TSLanguage* xml_lang = tree_sitter_xml();
-    if (xml_lang) {
-        language_map_["xml"] = xml_lang;
-        language_map_["html"] = xml_lang;
-        language_map_["htm"] = xml_lang;
-        language_map_["xhtml"] = xml_lang;
-        language_map_["svg"] = xml_lang;
-    }
-#endif
-}
-
-TSLanguage* AutoIndentEngine::getLanguageForFileType(const std::string& file_type) {
-    auto it = language_map_.find(file_type);
-    if (it != language_map_.end()) {
-        return it->second;
-    }
-    return nullptr;
-}
-
 IndentQuery* AutoIndentEngine::getIndentQueryForFileType(const std::string& file_type) {
     auto it = indent_query_map_.find(file_type);
     if (it != indent_query_map_.end()) {
@@ -429,7 +159,8 @@ IndentQuery* AutoIndentEngine::getIndentQueryForFileType(const std::string& file
     return nullptr;
 }
 
-int AutoIndentEngine::computeIndentFromTree(const std::vector<std::string>& lines,
+int AutoIndentEngine::computeIndentFromTree(const TSTree* tree,
+                                            const std::vector<std::string>& lines,
                                             size_t cursor_row, size_t cursor_col) const {
     (void)cursor_col;
 
@@ -437,18 +168,6 @@ int AutoIndentEngine::computeIndentFromTree(const std::vector<std::string>& line
         return -1;
     }
 
-    std::string code;
-    std::vector<size_t> line_starts;
-    for (size_t i = 0; i < lines.size(); i++) {
-        line_starts.push_back(code.size());
-        code += lines[i] + "\n";
-    }
-
-    TSTree* tree = ts_parser_parse_string(parser_, nullptr, code.c_str(), code.length());
-    if (!tree) {
-        return -1;
-    }
-
     TSNode root = ts_tree_root_node(tree);
 
     uint32_t query_row, query_col;
@@ -475,7 +194,6 @@ int AutoIndentEngine::computeIndentFromTree(const std::vector<std::string>& line
 
     TSNode node = ts_node_named_descendant_for_point_range(root, start_point, end_point);
     if (ts_node_is_null(node)) {
-        ts_tree_delete(tree);
         return -1;
     }
 
@@ -509,9 +227,7 @@ int AutoIndentEngine::computeIndentFromTree(const std::vector<std::string>& line
     if (query && query->isLoaded()) {
         auto captures = query->queryAtRow(tree, query_row);
         if (!captures.empty()) {
-            int level = query->computeIndentLevel(captures, query_row);
-            ts_tree_delete(tree);
-            return level;
+            return query->computeIndentLevel(captures, query_row);
         }
     }
 
@@ -641,8 +357,6 @@ int AutoIndentEngine::computeIndentFromTree(const std::vector<std::string>& line
         indent_level = 0;
     }
 
-    ts_tree_delete(tree);
-
     return indent_level;
 }
 #endif
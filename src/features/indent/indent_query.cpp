@@ -104,7 +104,7 @@ bool IndentQuery::isLoaded() const {
     return loaded_;
 }
 
-std::vector<IndentCapture> IndentQuery::queryAtRow(TSTree* tree, uint32_t row) const {
+std::vector<IndentCapture> IndentQuery::queryAtRow(const TSTree* tree, uint32_t row) const {
     std::vector<IndentCapture> captures;
 
     if (!query_ || !tree || !loaded_) {
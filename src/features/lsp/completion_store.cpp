@@ -0,0 +1,277 @@
+#include "features/lsp/completion_store.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+
+namespace pnana {
+namespace features {
+
+namespace {
+
+// fzy 打分常量（https://github.com/jhawthorn/fzy）
+constexpr double SCORE_MIN = -std::numeric_limits<double>::infinity();
+constexpr double SCORE_EXACT = 1e9;
+constexpr double SCORE_GAP_LEADING = -0.005;
+constexpr double SCORE_GAP_TRAILING = -0.005;
+constexpr double SCORE_GAP_INNER = -0.01;
+constexpr double SCORE_MATCH_CONSECUTIVE = 1.0;
+constexpr double SCORE_MATCH_SLASH = 0.9;
+constexpr double SCORE_MATCH_WORD = 0.8;
+constexpr double SCORE_MATCH_CAPITAL = 0.7;
+constexpr double SCORE_MATCH_DOT = 0.6;
+constexpr size_t MATCH_MAX_LEN = 1024;
+
+double matchBonus(char prev, char current) {
+    if (prev == '/' || prev == ':') {
+        return SCORE_MATCH_SLASH;
+    }
+    if (prev == '_' || prev == '-' || prev == ' ') {
+        return SCORE_MATCH_WORD;
+    }
+    if (prev == '.') {
+        return SCORE_MATCH_DOT;
+    }
+    if (std::islower(static_cast<unsigned char>(prev)) &&
+        std::isupper(static_cast<unsigned char>(current))) {
+        return SCORE_MATCH_CAPITAL;
+    }
+    return 0.0;
+}
+
+std::string toLower(const std::string& text) {
+    std::string lower = text;
+    for (char& c : lower) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lower;
+}
+
+} // namespace
+
+CompletionSession::CompletionSession(std::vector<CompletionItem> items,
+                                     const std::string& base_query)
+    : items_(std::move(items)), base_query_(base_query) {
+    size_t total = 0;
+    for (const auto& item : items_) {
+        total += (item.filterText.empty() ? item.label : item.filterText).size();
+    }
+    arena_.reserve(total);
+    entries_.reserve(items_.size());
+    for (const auto& item : items_) {
+        const std::string& text = item.filterText.empty() ? item.label : item.filterText;
+        size_t length = std::min(text.size(), MATCH_MAX_LEN);
+        Entry entry;
+        entry.offset = static_cast<uint32_t>(arena_.size());
+        entry.length = static_cast<uint32_t>(length);
+        arena_.append(text, 0, length);
+        entries_.push_back(entry);
+    }
+    lower_arena_ = toLower(arena_);
+    for (auto& entry : entries_) {
+        entry.mask = charMask(lower_arena_.data() + entry.offset, entry.length);
+    }
+}
+
+uint64_t CompletionSession::charMask(const char* text, size_t length) {
+    // a-z → 0..25，0-9 → 26..35，其余字节按值散列到 36..63
+    uint64_t mask = 0;
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 'a' && c <= 'z') {
+            mask |= uint64_t(1) << (c - 'a');
+        } else if (c >= '0' && c <= '9') {
+            mask |= uint64_t(1) << (26 + c - '0');
+        } else {
+            mask |= uint64_t(1) << (36 + c % 28);
+        }
+    }
+    return mask;
+}
+
+bool CompletionSession::isSubsequence(const std::string& needle, const Entry& entry) const {
+    const char* p = lower_arena_.data() + entry.offset;
+    const char* end = p + entry.length;
+    for (char c : needle) {
+        const void* found = std::memchr(p, c, static_cast<size_t>(end - p));
+        if (!found) {
+            return false;
+        }
+        p = static_cast<const char*>(found) + 1;
+    }
+    return true;
+}
+
+bool CompletionSession::canServe(const std::string& query) const {
+    return query.size() >= base_query_.size() &&
+           query.compare(0, base_query_.size(), base_query_) == 0;
+}
+
+double CompletionSession::score(const std::string& needle, const char* haystack,
+                                const char* lower_haystack, size_t length) {
+    const size_t n = needle.size();
+    const size_t m = length;
+    if (n == 0) {
+        return 0.0;
+    }
+    if (n == m) {
+        // 子序列且等长即完全匹配
+        return SCORE_EXACT;
+    }
+    if (m > MATCH_MAX_LEN || n > m) {
+        return SCORE_MIN;
+    }
+
+    // 两行滚动的 D（以 needle[i] 结尾于 j 的最好分数）和 M（前缀 i 在 j 之前的最好分数）
+    std::vector<double> bonus(m);
+    char prev = '/';
+    for (size_t j = 0; j < m; ++j) {
+        bonus[j] = matchBonus(prev, haystack[j]);
+        prev = haystack[j];
+    }
+
+    std::vector<double> d_prev(m, SCORE_MIN), m_prev(m, SCORE_MIN);
+    std::vector<double> d_cur(m), m_cur(m);
+    for (size_t i = 0; i < n; ++i) {
+        double prev_score = SCORE_MIN;
+        double gap_score = (i == n - 1) ? SCORE_GAP_TRAILING : SCORE_GAP_INNER;
+        for (size_t j = 0; j < m; ++j) {
+            if (needle[i] == lower_haystack[j]) {
+                double current = SCORE_MIN;
+                if (i == 0) {
+                    current = static_cast<double>(j) * SCORE_GAP_LEADING + bonus[j];
+                } else if (j > 0) {
+                    current = std::max(m_prev[j - 1] + bonus[j],
+                                       d_prev[j - 1] + SCORE_MATCH_CONSECUTIVE);
+                }
+                d_cur[j] = current;
+                prev_score = std::max(current, prev_score + gap_score);
+            } else {
+                d_cur[j] = SCORE_MIN;
+                prev_score = prev_score + gap_score;
+            }
+            m_cur[j] = prev_score;
+        }
+        d_prev.swap(d_cur);
+        m_prev.swap(m_cur);
+    }
+    return m_prev[m - 1];
+}
+
+std::vector<CompletionItem> CompletionSession::query(const std::string& query, size_t limit) {
+    std::string needle = toLower(query);
+
+    // 与上一轮查询的公共前缀对应的命中集合可以直接复用
+    size_t common = 0;
+    while (common < needle.size() && common < chain_query_.size() &&
+           needle[common] == chain_query_[common]) {
+        ++common;
+    }
+    narrowed_.resize(std::min(narrowed_.size(), common));
+    chain_query_ = needle;
+
+    for (size_t level = narrowed_.size(); level < needle.size(); ++level) {
+        std::string partial = needle.substr(0, level + 1);
+        uint64_t mask = charMask(partial.data(), partial.size());
+        std::vector<uint32_t> next;
+        auto consider = [&](uint32_t index) {
+            const Entry& entry = entries_[index];
+            if ((mask & ~entry.mask) == 0 && isSubsequence(partial, entry)) {
+                next.push_back(index);
+            }
+        };
+        if (level == 0) {
+            next.reserve(entries_.size());
+            for (uint32_t i = 0; i < entries_.size(); ++i) {
+                consider(i);
+            }
+        } else {
+            for (uint32_t index : narrowed_.back()) {
+                consider(index);
+            }
+        }
+        narrowed_.push_back(std::move(next));
+    }
+
+    struct Scored {
+        double score;
+        uint32_t index;
+    };
+    std::vector<Scored> scored;
+    if (needle.empty()) {
+        // 空查询：保持服务器顺序
+        size_t count = std::min(limit, entries_.size());
+        scored.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            scored.push_back({0.0, i});
+        }
+    } else {
+        const auto& candidates = narrowed_.back();
+        scored.reserve(candidates.size());
+        for (uint32_t index : candidates) {
+            const Entry& entry = entries_[index];
+            scored.push_back({score(needle, arena_.data() + entry.offset,
+                                    lower_arena_.data() + entry.offset, entry.length),
+                              index});
+        }
+        auto better = [](const Scored& a, const Scored& b) {
+            if (a.score != b.score) {
+                return a.score > b.score;
+            }
+            return a.index < b.index;
+        };
+        if (scored.size() > limit) {
+            std::nth_element(scored.begin(), scored.begin() + static_cast<std::ptrdiff_t>(limit),
+                             scored.end(), better);
+            scored.resize(limit);
+        }
+        std::sort(scored.begin(), scored.end(), better);
+    }
+
+    std::vector<CompletionItem> result;
+    result.reserve(scored.size());
+    for (const auto& entry : scored) {
+        result.push_back(items_[entry.index]);
+    }
+    return result;
+}
+
+std::shared_ptr<CompletionSession> CompletionStore::find(const SessionKey& key,
+                                                         const std::string& query) {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = sessions_.begin(); it != sessions_.end(); ++it) {
+        if (!(it->key == key)) {
+            continue;
+        }
+        if (now - it->created > SESSION_TTL || !it->session->canServe(query)) {
+            sessions_.erase(it);
+            return nullptr;
+        }
+        sessions_.splice(sessions_.begin(), sessions_, it);
+        return sessions_.front().session;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<CompletionSession> CompletionStore::put(const SessionKey& key,
+                                                        std::vector<CompletionItem> items,
+                                                        const std::string& base_query) {
+    sessions_.remove_if([&key](const Slot& slot) { return slot.key == key; });
+    auto session = std::make_shared<CompletionSession>(std::move(items), base_query);
+    sessions_.push_front({key, session, std::chrono::steady_clock::now()});
+    while (sessions_.size() > MAX_SESSIONS) {
+        sessions_.pop_back();
+    }
+    return session;
+}
+
+void CompletionStore::invalidate(const std::string& uri) {
+    sessions_.remove_if([&uri](const Slot& slot) { return slot.key.uri == uri; });
+}
+
+void CompletionStore::clear() {
+    sessions_.clear();
+}
+
+} // namespace features
+} // namespace pnana
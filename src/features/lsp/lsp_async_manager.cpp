@@ -55,17 +55,18 @@ void LspAsyncManager::requestCompletionAsync(LspClient* client, const std::strin
     queue_cv_.notify_all();
 }
 
-void LspAsyncManager::requestDocumentOpenAsync(LspClient* client, const std::string& uri,
-                                               const std::string& language_id,
-                                               const std::string& content) {
-    if (!client || !running_)
+void LspAsyncManager::requestDocumentOpenAsync(
+    LspClient* client, const std::string& uri, const std::string& language_id,
+    std::shared_ptr<const core::DocumentSnapshot> snapshot, size_t max_lines) {
+    if (!client || !running_ || !snapshot)
         return;
     RequestTask task;
     task.type = RequestTask::DOCUMENT_OPEN;
     task.client = client;
     task.uri = uri;
     task.doc_language_id = language_id;
-    task.doc_content = content;
+    task.doc_snapshot = std::move(snapshot);
+    task.doc_max_lines = max_lines;
     {
         std::lock_guard<std::mutex> lock(queue_mutex_);
         request_queue_.push(task);
@@ -73,15 +74,17 @@ void LspAsyncManager::requestDocumentOpenAsync(LspClient* client, const std::str
     queue_cv_.notify_all();
 }
 
-void LspAsyncManager::requestDocumentChangeAsync(LspClient* client, const std::string& uri,
-                                                 const std::string& content, int version) {
-    if (!client || !running_)
+void LspAsyncManager::requestDocumentChangeAsync(
+    LspClient* client, const std::string& uri,
+    std::shared_ptr<const core::DocumentSnapshot> snapshot, size_t max_lines, int version) {
+    if (!client || !running_ || !snapshot)
         return;
     RequestTask task;
     task.type = RequestTask::DOCUMENT_CHANGE;
     task.client = client;
     task.uri = uri;
-    task.doc_content = content;
+    task.doc_snapshot = std::move(snapshot);
+    task.doc_max_lines = max_lines;
     task.doc_version = version;
     {
         std::lock_guard<std::mutex> lock(queue_mutex_);
@@ -133,9 +136,10 @@ void LspAsyncManager::workerThread() {
                 if (task.type == RequestTask::COMPLETION) {
                     if (task.client && task.client->isConnected()) {
                         // 使用带超时的异步调用，避免长时间阻塞
+                        bool is_incomplete = false;
                         auto completion_future = std::async(std::launch::async, [&]() {
                             return task.client->completion(task.uri, task.position,
-                                                           task.trigger_character);
+                                                           task.trigger_character, &is_incomplete);
                         });
 
                         // 超时避免 UI 卡顿，cpp/c 用 500ms，其他语言放宽至 800ms
@@ -149,7 +153,7 @@ void LspAsyncManager::workerThread() {
                         } else {
                             auto items = completion_future.get();
                             if (task.completion_callback) {
-                                task.completion_callback(items);
+                                task.completion_callback(items, is_incomplete);
                             }
                         }
                     } else {
@@ -181,14 +185,18 @@ void LspAsyncManager::workerThread() {
                 } else if (task.type == RequestTask::DOCUMENT_OPEN) {
                     if (task.client && task.client->isConnected()) {
                         try {
-                            task.client->didOpen(task.uri, task.doc_language_id, task.doc_content);
+                            task.client->didOpen(
+                                task.uri, task.doc_language_id,
+                                task.doc_snapshot->joinLines(0, task.doc_max_lines));
                         } catch (...) {
                         }
                     }
                 } else if (task.type == RequestTask::DOCUMENT_CHANGE) {
                     if (task.client && task.client->isConnected()) {
                         try {
-                            task.client->didChange(task.uri, task.doc_content, task.doc_version);
+                            task.client->didChange(
+                                task.uri, task.doc_snapshot->joinLines(0, task.doc_max_lines),
+                                task.doc_version);
                         } catch (...) {
                         }
                     }
@@ -1,5 +1,6 @@
 #include "features/lsp/lsp_client.h"
 #include "utils/logger.h"
+#include "utils/tool_cache.h"
 #include <algorithm>
 #include <cctype>
 #include <future>
@@ -41,8 +42,26 @@ bool LspClient::initialize(const std::string& root_path, const nlohmann::json* i
         return false;
     }
 
-    // 等待一小段时间，确保服务器已准备好
-    usleep(50000); // 50ms
+    // 同一服务器二进制在上次会话协商出的 capabilities（见 utils::ToolCache）：
+    // 握手完成前即可回答能力查询；已知能正常启动的服务器也不再等待启动
+    const std::string& executable_path = connector_->getExecutablePath();
+    std::string caps_key = "lsp-caps:" + executable_path;
+    std::string caps_fingerprint = utils::ToolCache::fingerprint(executable_path);
+    bool known_server = false;
+    if (auto cached = utils::ToolCache::getInstance().get(caps_key)) {
+        if (!caps_fingerprint.empty() && cached->fingerprint == caps_fingerprint) {
+            jsonrpccxx::json caps = jsonrpccxx::json::parse(cached->value, nullptr, false);
+            if (!caps.is_discarded()) {
+                server_capabilities_ = std::move(caps);
+                known_server = true;
+            }
+        }
+    }
+
+    if (!known_server) {
+        // 等待一小段时间，确保服务器已准备好
+        usleep(50000); // 50ms
+    }
 
     try {
         // 发送 initialize 请求
@@ -80,6 +99,10 @@ bool LspClient::initialize(const std::string& root_path, const nlohmann::json* i
         // 保存服务器能力
         if (result.contains("capabilities")) {
             server_capabilities_ = result["capabilities"];
+            if (!caps_fingerprint.empty()) {
+                utils::ToolCache::getInstance().put(caps_key, caps_fingerprint,
+                                                    server_capabilities_.dump());
+            }
         } else {
             LOG_WARNING("Initialize response missing capabilities");
         }
@@ -290,8 +313,12 @@ void LspClient::didSave(const std::string& uri) {
 
 std::vector<CompletionItem> LspClient::completion(const std::string& uri,
                                                   const LspPosition& position,
-                                                  const std::string& trigger_character) {
+                                                  const std::string& trigger_character,
+                                                  bool* is_incomplete) {
     std::vector<CompletionItem> items;
+    if (is_incomplete) {
+        *is_incomplete = false;
+    }
     if (!isConnected()) {
         return items;
     }
@@ -322,6 +349,10 @@ std::vector<CompletionItem> LspClient::completion(const std::string& uri,
             for (const auto& item : result["items"]) {
                 items.push_back(jsonToCompletionItem(item));
             }
+            if (is_incomplete && result.contains("isIncomplete") &&
+                result["isIncomplete"].is_boolean()) {
+                *is_incomplete = result["isIncomplete"].get<bool>();
+            }
         } else if (result.is_array()) {
             for (const auto& item : result) {
                 items.push_back(jsonToCompletionItem(item));
@@ -133,6 +133,11 @@ bool LspRequestManager::isRunning() const {
     return running_.load();
 }
 
+size_t LspRequestManager::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_map_.size();
+}
+
 void LspRequestManager::workerLoop() {
     while (running_) {
         Request req;
@@ -1,6 +1,7 @@
 #include "features/lsp/lsp_stdio_connector.h"
 #include "jsonrpccxx/common.hpp"
 #include "utils/logger.h"
+#include "utils/tool_cache.h"
 #include <algorithm>
 #include <chrono>
 #include <cstdio>
@@ -90,6 +91,33 @@ static std::string resolveCommandPath(const std::string& command) {
     return "";
 }
 
+// 带跨会话缓存的 resolveCommandPath：缓存的路径仍是同一个可执行文件且 PATH 未变时，
+// 不再遍历 PATH 与回退目录
+static std::string resolveCommandPathCached(const std::string& command) {
+    std::string executable = getExecutableName(command);
+    if (executable.empty() || executable.find('/') != std::string::npos) {
+        return resolveCommandPath(command);
+    }
+
+    const char* path_env = getenv("PATH");
+    std::string search_path = path_env ? path_env : "";
+    auto& cache = utils::ToolCache::getInstance();
+    std::string key = "lsp-path:" + executable;
+    if (auto cached = cache.get(key)) {
+        std::string fingerprint = utils::ToolCache::fingerprint(cached->value);
+        if (!fingerprint.empty() && cached->fingerprint == fingerprint + "|" + search_path &&
+            isExecutable(cached->value)) {
+            return cached->value;
+        }
+    }
+
+    std::string resolved = resolveCommandPath(command);
+    if (!resolved.empty()) {
+        cache.put(key, utils::ToolCache::fingerprint(resolved) + "|" + search_path, resolved);
+    }
+    return resolved;
+}
+
 LspStdioConnector::LspStdioConnector(const std::string& server_command)
     : server_command_(server_command), env_vars_({})
 #ifdef USE_BOOST_PROCESS
@@ -127,12 +155,13 @@ bool LspStdioConnector::start() {
     }
 
     // 解析命令路径（PATH + ~/.cargo/bin 等），确保 rust-analyzer 等可被找到
-    std::string executable_path = resolveCommandPath(server_command_);
+    std::string executable_path = resolveCommandPathCached(server_command_);
     if (executable_path.empty()) {
         LOG_WARNING("LSP server command not found: " + server_command_ +
                     ", skipping LSP initialization");
         return false;
     }
+    executable_path_ = executable_path;
 
     // 构建用于执行的命令：用解析出的完整路径替换可执行文件名
     std::string exec_command = server_command_;
@@ -74,7 +74,7 @@ bool AptManager::isAvailable() const {
         auto [ok, out] = remote_executor_("which dpkg 2>/dev/null");
         return ok && !out.empty();
     }
-    return system("which dpkg > /dev/null 2>&1") == 0;
+    return localCommandExists("dpkg");
 }
 
 std::vector<Package> AptManager::fetchPackagesFromSystem() {
@@ -85,14 +85,9 @@ std::vector<Package> AptManager::fetchPackagesFromSystem() {
             throw std::runtime_error("dpkg command failed on remote: " + out);
         output = out;
     } else {
-        FILE* pipe = popen("dpkg -l 2>&1", "r");
-        if (!pipe)
+        int exit_code = runLocalCommand("dpkg -l 2>&1", output);
+        if (exit_code < 0)
             throw std::runtime_error("Failed to execute dpkg command");
-        char buffer[4096];
-        output.reserve(4 * 1024 * 1024);
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
         if (exit_code != 0)
             throw std::runtime_error("dpkg command failed with exit code " +
                                      std::to_string(exit_code));
@@ -206,18 +201,7 @@ bool AptManager::updatePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute apt-get command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -228,7 +212,7 @@ bool AptManager::updatePackage(const std::string& package_name) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -248,18 +232,7 @@ bool AptManager::updateAllDependencies(const std::string& /*package_name*/) {
         }).detach();
         return true;
     }
-    std::thread([this, command]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute apt-get command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -269,7 +242,7 @@ bool AptManager::updateAllDependencies(const std::string& /*package_name*/) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -292,18 +265,7 @@ bool AptManager::removePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute apt-get command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -314,7 +276,7 @@ bool AptManager::removePackage(const std::string& package_name) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -337,18 +299,7 @@ bool AptManager::installPackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute apt-get command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -359,7 +310,7 @@ bool AptManager::installPackage(const std::string& package_name) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
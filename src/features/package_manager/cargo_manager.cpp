@@ -62,7 +62,7 @@ bool CargoManager::isAvailable() const {
         auto [ok, out] = remote_executor_("which cargo 2>/dev/null");
         return ok && !out.empty();
     }
-    return system("which cargo > /dev/null 2>&1") == 0;
+    return localCommandExists("cargo");
 }
 
 std::vector<Package> CargoManager::fetchPackagesFromSystem() {
@@ -73,14 +73,9 @@ std::vector<Package> CargoManager::fetchPackagesFromSystem() {
             return {};
         output = out;
     } else {
-        FILE* pipe = popen("cargo tree --depth 0 2>&1", "r");
-        if (!pipe)
+        int exit_code = runLocalCommand("cargo tree --depth 0 2>&1", output);
+        if (exit_code < 0)
             throw std::runtime_error("Failed to execute cargo command");
-        char buffer[4096];
-        output.reserve(512 * 1024);
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
         if (exit_code != 0 &&
             output.find("error: could not find `Cargo.toml`") != std::string::npos)
             return {};
@@ -169,18 +164,7 @@ bool CargoManager::updatePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute cargo command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -191,7 +175,7 @@ bool CargoManager::updatePackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -211,18 +195,7 @@ bool CargoManager::updateAllDependencies(const std::string& /*package_name*/) {
         }).detach();
         return true;
     }
-    std::thread([this, command]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute cargo command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -233,7 +206,7 @@ bool CargoManager::updateAllDependencies(const std::string& /*package_name*/) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -256,18 +229,7 @@ bool CargoManager::removePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute cargo command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -278,7 +240,7 @@ bool CargoManager::removePackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -301,18 +263,7 @@ bool CargoManager::installPackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute cargo command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -323,7 +274,7 @@ bool CargoManager::installPackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
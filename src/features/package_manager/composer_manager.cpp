@@ -71,15 +71,7 @@ bool ComposerManager::isAvailable() const {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            pclose(pipe);
-            success = true;
-        }
+        success = runLocalCommand(command, output) >= 0;
     }
 
     return success && !output.empty();
@@ -98,15 +90,7 @@ std::vector<Package> ComposerManager::fetchPackagesFromSystem() {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            pclose(pipe);
-            success = true;
-        }
+        success = runLocalCommand(command, output) >= 0;
     }
 
     if (!success || output.empty()) {
@@ -186,15 +170,7 @@ bool ComposerManager::updatePackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -214,15 +190,7 @@ bool ComposerManager::updateAllDependencies(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -242,15 +210,7 @@ bool ComposerManager::removePackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -270,15 +230,7 @@ bool ComposerManager::installPackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -60,7 +60,7 @@ bool CondaManager::isAvailable() const {
         auto [ok, out] = remote_executor_("which conda 2>/dev/null");
         return ok && !out.empty();
     }
-    return system("which conda > /dev/null 2>&1") == 0;
+    return localCommandExists("conda");
 }
 
 std::vector<Package> CondaManager::fetchPackagesFromSystem() {
@@ -71,14 +71,9 @@ std::vector<Package> CondaManager::fetchPackagesFromSystem() {
             throw std::runtime_error("conda command failed on remote: " + out);
         output = out;
     } else {
-        FILE* pipe = popen("conda list 2>&1", "r");
-        if (!pipe)
+        int exit_code = runLocalCommand("conda list 2>&1", output);
+        if (exit_code < 0)
             throw std::runtime_error("Failed to execute conda command");
-        char buffer[4096];
-        output.reserve(1024 * 1024);
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
         if (exit_code != 0)
             throw std::runtime_error("conda command failed with exit code " +
                                      std::to_string(exit_code));
@@ -130,18 +125,7 @@ bool CondaManager::updatePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute conda command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -151,7 +135,7 @@ bool CondaManager::updatePackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -171,18 +155,7 @@ bool CondaManager::updateAllDependencies(const std::string& /*package_name*/) {
         }).detach();
         return true;
     }
-    std::thread([this, command]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute conda command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -192,7 +165,7 @@ bool CondaManager::updateAllDependencies(const std::string& /*package_name*/) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -215,18 +188,7 @@ bool CondaManager::removePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute conda command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -236,7 +198,7 @@ bool CondaManager::removePackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -259,18 +221,7 @@ bool CondaManager::installPackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute conda command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -280,7 +231,7 @@ bool CondaManager::installPackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
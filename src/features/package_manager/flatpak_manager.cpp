@@ -95,7 +95,7 @@ bool FlatpakManager::isAvailable() const {
         auto [ok, out] = remote_executor_("which flatpak 2>/dev/null");
         return ok && !out.empty();
     }
-    return system("which flatpak > /dev/null 2>&1") == 0;
+    return localCommandExists("flatpak");
 }
 
 std::vector<Package> FlatpakManager::fetchPackagesFromSystem() {
@@ -107,14 +107,10 @@ std::vector<Package> FlatpakManager::fetchPackagesFromSystem() {
             throw std::runtime_error("flatpak command failed on remote: " + out);
         output = out;
     } else {
-        FILE* pipe = popen("flatpak list --columns=name,version,application,description 2>&1", "r");
-        if (!pipe)
+        int exit_code = runLocalCommand(
+            "flatpak list --columns=name,version,application,description 2>&1", output);
+        if (exit_code < 0)
             throw std::runtime_error("Failed to execute flatpak command");
-        char buffer[4096];
-        output.reserve(4 * 1024 * 1024);
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
         if (exit_code != 0)
             throw std::runtime_error("flatpak command failed with exit code " +
                                      std::to_string(exit_code));
@@ -194,18 +190,7 @@ bool FlatpakManager::updatePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute flatpak command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -215,7 +200,7 @@ bool FlatpakManager::updatePackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -235,18 +220,7 @@ bool FlatpakManager::updateAllDependencies(const std::string& /*package_name*/)
         }).detach();
         return true;
     }
-    std::thread([this, command]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute flatpak command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -256,7 +230,7 @@ bool FlatpakManager::updateAllDependencies(const std::string& /*package_name*/)
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -279,18 +253,7 @@ bool FlatpakManager::removePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute flatpak command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -300,7 +263,7 @@ bool FlatpakManager::removePackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -323,18 +286,7 @@ bool FlatpakManager::installPackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute flatpak command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -344,7 +296,7 @@ bool FlatpakManager::installPackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
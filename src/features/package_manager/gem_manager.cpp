@@ -71,15 +71,7 @@ bool GemManager::isAvailable() const {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            pclose(pipe);
-            success = true;
-        }
+        success = runLocalCommand(command, output) >= 0;
     }
 
     return success && !output.empty();
@@ -98,15 +90,7 @@ std::vector<Package> GemManager::fetchPackagesFromSystem() {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            pclose(pipe);
-            success = true;
-        }
+        success = runLocalCommand(command, output) >= 0;
     }
 
     if (!success || output.empty()) {
@@ -168,15 +152,7 @@ bool GemManager::updatePackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -196,15 +172,7 @@ bool GemManager::updateAllDependencies(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -224,15 +192,7 @@ bool GemManager::removePackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -252,15 +212,7 @@ bool GemManager::installPackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -71,15 +71,7 @@ bool GoModManager::isAvailable() const {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            pclose(pipe);
-            success = true;
-        }
+        success = runLocalCommand(command, output) >= 0;
     }
 
     return success && !output.empty();
@@ -98,15 +90,7 @@ std::vector<Package> GoModManager::fetchPackagesFromSystem() {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            pclose(pipe);
-            success = true;
-        }
+        success = runLocalCommand(command, output) >= 0;
     }
 
     if (!success || output.empty()) {
@@ -159,15 +143,7 @@ bool GoModManager::updatePackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -187,15 +163,7 @@ bool GoModManager::updateAllDependencies(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -215,15 +183,7 @@ bool GoModManager::removePackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -243,15 +203,7 @@ bool GoModManager::installPackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
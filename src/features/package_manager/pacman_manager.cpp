@@ -68,7 +68,7 @@ bool PacmanManager::isAvailable() const {
         auto [ok, out] = remote_executor_("which pacman 2>/dev/null");
         return ok && !out.empty();
     }
-    return system("which pacman > /dev/null 2>&1") == 0;
+    return localCommandExists("pacman");
 }
 
 std::vector<Package> PacmanManager::fetchPackagesFromSystem() {
@@ -79,14 +79,9 @@ std::vector<Package> PacmanManager::fetchPackagesFromSystem() {
             throw std::runtime_error("pacman command failed on remote: " + out);
         output = out;
     } else {
-        FILE* pipe = popen("pacman -Q 2>&1", "r");
-        if (!pipe)
+        int exit_code = runLocalCommand("pacman -Q 2>&1", output);
+        if (exit_code < 0)
             throw std::runtime_error("Failed to execute pacman command");
-        char buffer[4096];
-        output.reserve(2 * 1024 * 1024);
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
         if (exit_code != 0)
             throw std::runtime_error("pacman command failed with exit code " +
                                      std::to_string(exit_code));
@@ -148,18 +143,7 @@ bool PacmanManager::updatePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute pacman command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -170,7 +154,7 @@ bool PacmanManager::updatePackage(const std::string& package_name) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -190,18 +174,7 @@ bool PacmanManager::updateAllDependencies(const std::string& /*package_name*/) {
         }).detach();
         return true;
     }
-    std::thread([this, command]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute pacman command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -211,7 +184,7 @@ bool PacmanManager::updateAllDependencies(const std::string& /*package_name*/) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -234,18 +207,7 @@ bool PacmanManager::removePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute pacman command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -256,7 +218,7 @@ bool PacmanManager::removePackage(const std::string& package_name) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -279,18 +241,7 @@ bool PacmanManager::installPackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute pacman command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -301,7 +252,7 @@ bool PacmanManager::installPackage(const std::string& package_name) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -76,8 +76,7 @@ bool PipManager::isAvailable() const {
     }
     const char* pip_commands[] = {"pip3", "pip"};
     for (const char* pip_cmd : pip_commands) {
-        std::string command = std::string("which ") + pip_cmd + " > /dev/null 2>&1";
-        if (system(command.c_str()) == 0)
+        if (localCommandExists(pip_cmd))
             return true;
     }
     return false;
@@ -97,15 +96,7 @@ std::vector<Package> PipManager::fetchPackagesFromSystem() {
         const char* pip_commands[] = {"pip3", "pip"};
         for (const char* pip_cmd : pip_commands) {
             std::string command = std::string(pip_cmd) + " list --format=columns 2>&1";
-            FILE* pipe = popen(command.c_str(), "r");
-            if (!pipe)
-                continue;
-            char buffer[4096];
-            output.clear();
-            output.reserve(1024 * 1024);
-            while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-                output += buffer;
-            int exit_code = pclose(pipe);
+            int exit_code = runLocalCommand(command, output);
             if (exit_code == 0) {
                 success = true;
                 break;
@@ -181,7 +172,7 @@ bool PipManager::updatePackage(const std::string& package_name) {
     if (!remote_executor_) {
         const char* cmds[] = {"pip3", "pip"};
         for (const char* c : cmds) {
-            if (system((std::string("which ") + c + " > /dev/null 2>&1").c_str()) == 0) {
+            if (localCommandExists(c)) {
                 pip_cmd = c;
                 break;
             }
@@ -208,18 +199,7 @@ bool PipManager::updatePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute pip command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -229,7 +209,7 @@ bool PipManager::updatePackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output.substr(0, 200);
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -240,7 +220,7 @@ bool PipManager::updateAllDependencies(const std::string& package_name) {
     if (!remote_executor_) {
         const char* cmds[] = {"pip3", "pip"};
         for (const char* c : cmds) {
-            if (system((std::string("which ") + c + " > /dev/null 2>&1").c_str()) == 0) {
+            if (localCommandExists(c)) {
                 pip_cmd = c;
                 break;
             }
@@ -269,18 +249,7 @@ bool PipManager::updateAllDependencies(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute pip command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -291,7 +260,7 @@ bool PipManager::updateAllDependencies(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output.substr(0, 200);
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -302,7 +271,7 @@ bool PipManager::removePackage(const std::string& package_name) {
     if (!remote_executor_) {
         const char* cmds[] = {"pip3", "pip"};
         for (const char* c : cmds) {
-            if (system((std::string("which ") + c + " > /dev/null 2>&1").c_str()) == 0) {
+            if (localCommandExists(c)) {
                 pip_cmd = c;
                 break;
             }
@@ -329,18 +298,7 @@ bool PipManager::removePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute pip command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -350,7 +308,7 @@ bool PipManager::removePackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output.substr(0, 200);
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -361,7 +319,7 @@ bool PipManager::installPackage(const std::string& package_name) {
     if (!remote_executor_) {
         const char* cmds[] = {"pip3", "pip"};
         for (const char* c : cmds) {
-            if (system((std::string("which ") + c + " > /dev/null 2>&1").c_str()) == 0) {
+            if (localCommandExists(c)) {
                 pip_cmd = c;
                 break;
             }
@@ -388,18 +346,7 @@ bool PipManager::installPackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute pip command";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -409,7 +356,7 @@ bool PipManager::installPackage(const std::string& package_name) {
             if (!output.empty())
                 this->cache_entry_.error_message += " - " + output.substr(0, 200);
         }
-    }).detach();
+    });
     return true;
 }
 
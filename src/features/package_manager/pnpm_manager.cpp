@@ -71,15 +71,7 @@ bool PnpmManager::isAvailable() const {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            pclose(pipe);
-            success = true;
-        }
+        success = runLocalCommand(command, output) >= 0;
     }
 
     return success && !output.empty();
@@ -98,15 +90,7 @@ std::vector<Package> PnpmManager::fetchPackagesFromSystem() {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            pclose(pipe);
-            success = true;
-        }
+        success = runLocalCommand(command, output) >= 0;
     }
 
     if (!success || output.empty()) {
@@ -176,15 +160,7 @@ bool PnpmManager::updatePackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -204,15 +180,7 @@ bool PnpmManager::updateAllDependencies(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -232,15 +200,7 @@ bool PnpmManager::removePackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -260,15 +220,7 @@ bool PnpmManager::installPackage(const std::string& package_name) {
         success = result.first;
         output = result.second;
     } else {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (pipe) {
-            char buffer[128];
-            while (fgets(buffer, sizeof(buffer), pipe)) {
-                output += buffer;
-            }
-            int status = pclose(pipe);
-            success = (status == 0);
-        }
+        success = runLocalCommand(command, output) == 0;
     }
 
     if (success) {
@@ -60,7 +60,7 @@ bool YumManager::isAvailable() const {
         auto [ok, out] = remote_executor_("which rpm 2>/dev/null");
         return ok && !out.empty();
     }
-    return system("which rpm > /dev/null 2>&1") == 0;
+    return localCommandExists("rpm");
 }
 
 std::vector<Package> YumManager::fetchPackagesFromSystem() {
@@ -71,14 +71,9 @@ std::vector<Package> YumManager::fetchPackagesFromSystem() {
             throw std::runtime_error("rpm command failed on remote: " + out);
         output = out;
     } else {
-        FILE* pipe = popen("rpm -qa 2>&1", "r");
-        if (!pipe)
+        int exit_code = runLocalCommand("rpm -qa 2>&1", output);
+        if (exit_code < 0)
             throw std::runtime_error("Failed to execute rpm command");
-        char buffer[4096];
-        output.reserve(4 * 1024 * 1024);
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
         if (exit_code != 0)
             throw std::runtime_error("rpm command failed with exit code " +
                                      std::to_string(exit_code));
@@ -139,18 +134,7 @@ bool YumManager::updatePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute yum command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -161,7 +145,7 @@ bool YumManager::updatePackage(const std::string& package_name) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -181,18 +165,7 @@ bool YumManager::updateAllDependencies(const std::string& /*package_name*/) {
         }).detach();
         return true;
     }
-    std::thread([this, command]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute yum command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -202,7 +175,7 @@ bool YumManager::updateAllDependencies(const std::string& /*package_name*/) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -225,18 +198,7 @@ bool YumManager::removePackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute yum command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -247,7 +209,7 @@ bool YumManager::removePackage(const std::string& package_name) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
@@ -270,18 +232,7 @@ bool YumManager::installPackage(const std::string& package_name) {
         }).detach();
         return true;
     }
-    std::thread([this, command, package_name]() {
-        FILE* pipe = popen(command.c_str(), "r");
-        if (!pipe) {
-            std::lock_guard<std::mutex> lock(this->cache_mutex_);
-            this->cache_entry_.error_message = "Failed to execute yum command (may need sudo)";
-            return;
-        }
-        char buffer[4096];
-        std::string output;
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-            output += buffer;
-        int exit_code = pclose(pipe);
+    runLocalCommandAsync(command, [this, package_name](int exit_code, const std::string& output) {
         std::lock_guard<std::mutex> lock(this->cache_mutex_);
         if (exit_code == 0) {
             this->cache_entry_.timestamp = std::chrono::steady_clock::now() - CACHE_TIMEOUT_;
@@ -292,7 +243,7 @@ bool YumManager::installPackage(const std::string& package_name) {
             if (!output.empty() && output.find("Permission denied") == std::string::npos)
                 this->cache_entry_.error_message += " - " + output;
         }
-    }).detach();
+    });
     return true;
 }
 
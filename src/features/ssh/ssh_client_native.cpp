@@ -1,5 +1,6 @@
 #include "features/ssh/ssh_client_native.h"
 #include "utils/logger.h"
+#include "utils/perf_monitor.h"
 #include <algorithm>
 #include <chrono>
 #include <cstring>
@@ -516,19 +517,19 @@ SSHResult SSHClientNative::sftpReadFile(LIBSSH2_SESSION* session, const std::str
                                         std::string& content) {
     auto start_time = std::chrono::steady_clock::now();
 
-    utils::Logger::getInstance().startTiming("sftp_init_" + remote_path);
+    utils::PerfZoneScope init_zone(utils::PerfZoneId::SFTP_INIT);
     LIBSSH2_SFTP* sftp_session = libssh2_sftp_init(session);
-    utils::Logger::getInstance().endTiming("sftp_init_" + remote_path, "SFTP initialization");
+    init_zone.end();
 
     if (!sftp_session) {
         utils::Logger::getInstance().logError("SFTP initialization failed: " + remote_path);
         return SSHResult::fail("Failed to initialize SFTP session");
     }
 
-    utils::Logger::getInstance().startTiming("sftp_open_" + remote_path);
+    utils::PerfZoneScope open_zone(utils::PerfZoneId::SFTP_OPEN);
     LIBSSH2_SFTP_HANDLE* file =
         libssh2_sftp_open(sftp_session, remote_path.c_str(), LIBSSH2_FXF_READ, 0);
-    utils::Logger::getInstance().endTiming("sftp_open_" + remote_path, "Open remote file");
+    open_zone.end();
 
     if (!file) {
         libssh2_sftp_shutdown(sftp_session);
@@ -573,23 +574,21 @@ SSHResult SSHClientNative::sftpWriteFile(LIBSSH2_SESSION* session, const std::st
                                          const std::string& content) {
     auto start_time = std::chrono::steady_clock::now();
 
-    utils::Logger::getInstance().startTiming("sftp_init_write_" + remote_path);
+    utils::PerfZoneScope init_zone(utils::PerfZoneId::SFTP_INIT);
     LIBSSH2_SFTP* sftp_session = libssh2_sftp_init(session);
-    utils::Logger::getInstance().endTiming("sftp_init_write_" + remote_path,
-                                           "SFTP initialization (write)");
+    init_zone.end();
 
     if (!sftp_session) {
         utils::Logger::getInstance().logError("SFTP initialization failed (write): " + remote_path);
         return SSHResult::fail("Failed to initialize SFTP session");
     }
 
-    utils::Logger::getInstance().startTiming("sftp_open_write_" + remote_path);
+    utils::PerfZoneScope open_zone(utils::PerfZoneId::SFTP_OPEN);
     LIBSSH2_SFTP_HANDLE* file = libssh2_sftp_open(
         sftp_session, remote_path.c_str(),
         LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT | LIBSSH2_FXF_TRUNC,
         LIBSSH2_SFTP_S_IRUSR | LIBSSH2_SFTP_S_IWUSR | LIBSSH2_SFTP_S_IRGRP | LIBSSH2_SFTP_S_IROTH);
-    utils::Logger::getInstance().endTiming("sftp_open_write_" + remote_path,
-                                           "Open remote file (write)");
+    open_zone.end();
 
     if (!file) {
         libssh2_sftp_shutdown(sftp_session);
@@ -661,28 +660,27 @@ SSHResult SSHClientNative::sftpUploadFile(LIBSSH2_SESSION* session, const std::s
     utils::Logger::getInstance().log("Starting file upload: " + local_path + " -> " + remote_path);
 
     // Open local file
-    utils::Logger::getInstance().startTiming("upload_local_open_" + local_path);
+    utils::PerfZoneScope local_open_zone(utils::PerfZoneId::SFTP_LOCAL_OPEN);
     std::ifstream local_file(local_path, std::ios::binary);
     if (!local_file) {
         utils::Logger::getInstance().logError("Failed to open local file: " + local_path);
         return SSHResult::fail("Failed to open local file: " + local_path);
     }
-    utils::Logger::getInstance().endTiming("upload_local_open_" + local_path, "Open local file");
+    local_open_zone.end();
 
     // Get local file size
-    utils::Logger::getInstance().startTiming("upload_get_size_" + local_path);
+    utils::PerfZoneScope stat_zone(utils::PerfZoneId::SFTP_STAT);
     local_file.seekg(0, std::ios::end);
     size_t file_size = local_file.tellg();
     local_file.seekg(0, std::ios::beg);
-    utils::Logger::getInstance().endTiming("upload_get_size_" + local_path, "Get file size");
+    stat_zone.end();
 
     utils::Logger::getInstance().log("Local file size: " + std::to_string(file_size) + " bytes");
 
     // Initialize SFTP
-    utils::Logger::getInstance().startTiming("upload_sftp_init_" + remote_path);
+    utils::PerfZoneScope init_zone(utils::PerfZoneId::SFTP_INIT);
     LIBSSH2_SFTP* sftp_session = libssh2_sftp_init(session);
-    utils::Logger::getInstance().endTiming("upload_sftp_init_" + remote_path,
-                                           "SFTP initialization (upload)");
+    init_zone.end();
 
     if (!sftp_session) {
         utils::Logger::getInstance().logError("SFTP initialization failed (upload): " +
@@ -691,13 +689,12 @@ SSHResult SSHClientNative::sftpUploadFile(LIBSSH2_SESSION* session, const std::s
     }
 
     // Open remote file
-    utils::Logger::getInstance().startTiming("upload_sftp_open_" + remote_path);
+    utils::PerfZoneScope open_zone(utils::PerfZoneId::SFTP_OPEN);
     LIBSSH2_SFTP_HANDLE* file = libssh2_sftp_open(
         sftp_session, remote_path.c_str(),
         LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT | LIBSSH2_FXF_TRUNC,
         LIBSSH2_SFTP_S_IRUSR | LIBSSH2_SFTP_S_IWUSR | LIBSSH2_SFTP_S_IRGRP | LIBSSH2_SFTP_S_IROTH);
-    utils::Logger::getInstance().endTiming("upload_sftp_open_" + remote_path,
-                                           "Open remote file (upload)");
+    open_zone.end();
 
     if (!file) {
         libssh2_sftp_shutdown(sftp_session);
@@ -774,10 +771,9 @@ SSHResult SSHClientNative::sftpDownloadFile(LIBSSH2_SESSION* session,
                                      local_path);
 
     // Initialize SFTP
-    utils::Logger::getInstance().startTiming("download_sftp_init_" + remote_path);
+    utils::PerfZoneScope init_zone(utils::PerfZoneId::SFTP_INIT);
     LIBSSH2_SFTP* sftp_session = libssh2_sftp_init(session);
-    utils::Logger::getInstance().endTiming("download_sftp_init_" + remote_path,
-                                           "SFTP initialization (download)");
+    init_zone.end();
 
     if (!sftp_session) {
         utils::Logger::getInstance().logError("SFTP initialization failed (download): " +
@@ -786,11 +782,10 @@ SSHResult SSHClientNative::sftpDownloadFile(LIBSSH2_SESSION* session,
     }
 
     // Open remote file
-    utils::Logger::getInstance().startTiming("download_sftp_open_" + remote_path);
+    utils::PerfZoneScope open_zone(utils::PerfZoneId::SFTP_OPEN);
     LIBSSH2_SFTP_HANDLE* file =
         libssh2_sftp_open(sftp_session, remote_path.c_str(), LIBSSH2_FXF_READ, 0);
-    utils::Logger::getInstance().endTiming("download_sftp_open_" + remote_path,
-                                           "Open remote file (download)");
+    open_zone.end();
 
     if (!file) {
         libssh2_sftp_close(file);
@@ -801,18 +796,18 @@ SSHResult SSHClientNative::sftpDownloadFile(LIBSSH2_SESSION* session,
     }
 
     // Get file size
-    utils::Logger::getInstance().startTiming("download_get_size_" + remote_path);
+    utils::PerfZoneScope stat_zone(utils::PerfZoneId::SFTP_STAT);
     LIBSSH2_SFTP_ATTRIBUTES attrs;
     size_t file_size = 0;
     if (libssh2_sftp_fstat(file, &attrs) == 0 && (attrs.flags & LIBSSH2_SFTP_ATTR_SIZE)) {
         file_size = attrs.filesize;
     }
-    utils::Logger::getInstance().endTiming("download_get_size_" + remote_path, "Get file size");
+    stat_zone.end();
 
     utils::Logger::getInstance().log("Remote file size: " + std::to_string(file_size) + " bytes");
 
     // Open local file
-    utils::Logger::getInstance().startTiming("download_local_open_" + local_path);
+    utils::PerfZoneScope local_open_zone(utils::PerfZoneId::SFTP_LOCAL_OPEN);
     std::ofstream local_file(local_path, std::ios::binary);
     if (!local_file) {
         libssh2_sftp_close(file);
@@ -821,7 +816,7 @@ SSHResult SSHClientNative::sftpDownloadFile(LIBSSH2_SESSION* session,
                                               local_path);
         return SSHResult::fail("Failed to open local file for writing: " + local_path);
     }
-    utils::Logger::getInstance().endTiming("download_local_open_" + local_path, "Open local file");
+    local_open_zone.end();
 
     // Download file with optimized buffer
     char buffer[SFTP_BUFFER_SIZE];
@@ -0,0 +1,465 @@
+#include "features/syntax_tree/syntax_tree_service.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <map>
+
+#ifdef BUILD_TREE_SITTER_SUPPORT
+#include "features/SyntaxHighlighter/tree_sitter_languages.h"
+#endif
+
+namespace pnana {
+namespace features {
+
+#ifdef BUILD_TREE_SITTER_SUPPORT
+
+namespace {
+
+// 超过此行数的文档不建树（整文件快照与首次解析的代价过高）
+constexpr size_t MAX_TREE_LINES = 1000000;
+
+bool isBracket(char c) {
+    return c == '(' || c == ')' || c == '[' || c == ']' || c == '{' || c == '}';
+}
+
+char matchingBracket(char c) {
+    switch (c) {
+        case '(':
+            return ')';
+        case '[':
+            return ']';
+        case '{':
+            return '}';
+        case ')':
+            return '(';
+        case ']':
+            return '[';
+        case '}':
+            return '{';
+        default:
+            return '\0';
+    }
+}
+
+bool isToken(TSNode node, char c) {
+    const char* type = ts_node_type(node);
+    return type && type[0] == c && type[1] == '\0' && !ts_node_is_missing(node);
+}
+
+} // namespace
+
+struct SyntaxTreeService::Entry {
+    // 以下字段只由 UI 线程访问
+    uint64_t document_id = 0; // Document::getInstanceId()
+    TSLanguage* language = nullptr;
+    TSTree* tree = nullptr;             // 最近换入的解析结果 + 之后的编辑
+    uint64_t version = 0;               // tree 对应的文档版本
+    uint64_t generation = 0;            // 换入解析结果的次数
+    uint64_t scheduled_version = UINT64_MAX; // 最近一次提交解析的文档版本
+    std::vector<uint32_t> line_starts;  // 与 tree 一致的行首字节偏移
+
+    // 以下字段受 SyntaxTreeService::mutex_ 保护
+    bool parsing = false;
+    TSTree* result = nullptr;
+    uint64_t result_version = 0;
+    std::vector<uint32_t> result_line_starts;
+
+    ~Entry() {
+        if (tree) {
+            ts_tree_delete(tree);
+        }
+        if (result) {
+            ts_tree_delete(result);
+        }
+    }
+};
+
+SyntaxTreeService::SyntaxTreeService() {
+    worker_ = std::thread([this]() { workerLoop(); });
+}
+
+SyntaxTreeService::~SyntaxTreeService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        for (auto& job : jobs_) {
+            if (job.old_tree) {
+                ts_tree_delete(job.old_tree);
+            }
+        }
+        jobs_.clear();
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void SyntaxTreeService::setParsedCallback(ParsedCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    parsed_callback_ = std::move(callback);
+}
+
+TSLanguage* SyntaxTreeService::languageForFileType(const std::string& file_type) {
+    return treeSitterLanguageFor(file_type);
+}
+
+bool SyntaxTreeService::isAvailable() {
+    return true;
+}
+
+void SyntaxTreeService::applyEdit(Entry& entry, const core::TextEdit& edit) {
+    std::vector<uint32_t>& starts = entry.line_starts;
+    if (edit.start_row >= starts.size() || edit.end_row >= starts.size()) {
+        return;
+    }
+    const uint32_t start_byte = starts[edit.start_row] + static_cast<uint32_t>(edit.start_col);
+    const uint32_t old_end_byte = starts[edit.end_row] + static_cast<uint32_t>(edit.end_col);
+    const uint32_t new_end_byte = start_byte + static_cast<uint32_t>(edit.text.size());
+
+    TSInputEdit input;
+    input.start_byte = start_byte;
+    input.old_end_byte = old_end_byte;
+    input.new_end_byte = new_end_byte;
+    input.start_point = {static_cast<uint32_t>(edit.start_row),
+                         static_cast<uint32_t>(edit.start_col)};
+    input.old_end_point = {static_cast<uint32_t>(edit.end_row),
+                           static_cast<uint32_t>(edit.end_col)};
+
+    // 插入文本中每个换行产生一个新的行首
+    std::vector<uint32_t> inserted;
+    for (size_t pos = edit.text.find('\n'); pos != std::string::npos;
+         pos = edit.text.find('\n', pos + 1)) {
+        inserted.push_back(start_byte + static_cast<uint32_t>(pos) + 1);
+    }
+    if (inserted.empty()) {
+        input.new_end_point = {static_cast<uint32_t>(edit.start_row),
+                               static_cast<uint32_t>(edit.start_col + edit.text.size())};
+    } else {
+        input.new_end_point = {static_cast<uint32_t>(edit.start_row + inserted.size()),
+                               new_end_byte - inserted.back()};
+    }
+    ts_tree_edit(entry.tree, &input);
+
+    const int64_t delta = static_cast<int64_t>(new_end_byte) - static_cast<int64_t>(old_end_byte);
+    auto first = starts.begin() + static_cast<std::ptrdiff_t>(edit.start_row) + 1;
+    auto last = starts.begin() + static_cast<std::ptrdiff_t>(edit.end_row) + 1;
+    size_t tail_index = edit.start_row + 1 + inserted.size();
+    starts.erase(first, last);
+    starts.insert(starts.begin() + static_cast<std::ptrdiff_t>(edit.start_row) + 1,
+                  inserted.begin(), inserted.end());
+    for (size_t i = tail_index; i < starts.size(); ++i) {
+        starts[i] = static_cast<uint32_t>(static_cast<int64_t>(starts[i]) + delta);
+    }
+}
+
+const TSTree* SyntaxTreeService::update(const core::Document& doc, const std::string& file_type) {
+    TSLanguage* language = languageForFileType(file_type);
+    if (!language || doc.isLazyLoaded() || doc.lineCount() > MAX_TREE_LINES) {
+        forget(&doc);
+        return nullptr;
+    }
+
+    std::shared_ptr<Entry>& slot = entries_[&doc];
+    if (!slot || slot->language != language || slot->document_id != doc.getInstanceId()) {
+        // 新文档或语言变化：旧条目交给可能仍在解析它的后台任务去释放
+        slot = std::make_shared<Entry>();
+        slot->document_id = doc.getInstanceId();
+        slot->language = language;
+    }
+    std::shared_ptr<Entry> entry = slot;
+
+    bool parsing = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entry->result) {
+            if (entry->tree) {
+                ts_tree_delete(entry->tree);
+            }
+            entry->tree = entry->result;
+            entry->version = entry->result_version;
+            entry->line_starts = std::move(entry->result_line_starts);
+            entry->result = nullptr;
+            entry->generation++;
+        }
+        parsing = entry->parsing;
+    }
+
+    const uint64_t version = doc.getVersion();
+    if (entry->tree && entry->version != version) {
+        std::vector<core::ContentEdit> edits;
+        if (doc.getEditsSince(entry->version, edits)) {
+            for (const auto& edit : edits) {
+                applyEdit(*entry, edit.edit);
+            }
+            entry->version = version;
+        } else {
+            // 日志无法追赶（重新加载、整体替换等）：丢弃旧树，等待全量解析
+            ts_tree_delete(entry->tree);
+            entry->tree = nullptr;
+            entry->line_starts.clear();
+        }
+    }
+
+    // 同一版本只提交一次；解析失败时等下一次编辑再试
+    if (!parsing && entry->scheduled_version != version) {
+        schedule(entry, doc);
+    }
+    return entry->tree;
+}
+
+void SyntaxTreeService::schedule(const std::shared_ptr<Entry>& entry, const core::Document& doc) {
+    Job job;
+    job.entry = entry;
+    job.language = entry->language;
+    job.old_tree = entry->tree ? ts_tree_copy(entry->tree) : nullptr;
+    job.snapshot = doc.snapshot();
+    job.version = doc.getVersion();
+
+    entry->scheduled_version = job.version;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry->parsing = true;
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+}
+
+void SyntaxTreeService::workerLoop() {
+    TSParser* parser = ts_parser_new();
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                break;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        // 快照的全文只拼接一次并缓存在快照内，与保存等其他读者共享
+        const std::string& text = job.snapshot->text();
+        TSTree* tree = nullptr;
+        if (parser && ts_parser_set_language(parser, job.language)) {
+            tree = ts_parser_parse_string(parser, job.old_tree, text.data(),
+                                          static_cast<uint32_t>(text.size()));
+        }
+        if (job.old_tree) {
+            ts_tree_delete(job.old_tree);
+        }
+
+        std::vector<uint32_t> line_starts;
+        line_starts.push_back(0);
+        for (size_t pos = text.find('\n'); pos != std::string::npos;
+             pos = text.find('\n', pos + 1)) {
+            line_starts.push_back(static_cast<uint32_t>(pos + 1));
+        }
+
+        ParsedCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job.entry->parsing = false;
+            if (tree) {
+                if (job.entry->result) {
+                    ts_tree_delete(job.entry->result);
+                }
+                job.entry->result = tree;
+                job.entry->result_version = job.version;
+                job.entry->result_line_starts = std::move(line_starts);
+                callback = parsed_callback_;
+            } else {
+                LOG_WARNING("SyntaxTreeService: parse failed");
+            }
+        }
+        // 条目可能已被 forget()；由任务持有的最后一个引用在锁外释放
+        job.entry.reset();
+        if (callback) {
+            callback();
+        }
+    }
+    if (parser) {
+        ts_parser_delete(parser);
+    }
+}
+
+const TSTree* SyntaxTreeService::tree(const core::Document& doc) const {
+    auto it = entries_.find(&doc);
+    if (it == entries_.end() || !it->second->tree ||
+        it->second->document_id != doc.getInstanceId() ||
+        it->second->version != doc.getVersion()) {
+        return nullptr;
+    }
+    return it->second->tree;
+}
+
+uint64_t SyntaxTreeService::generation(const core::Document& doc) const {
+    auto it = entries_.find(&doc);
+    if (it == entries_.end() || it->second->document_id != doc.getInstanceId()) {
+        return 0;
+    }
+    return it->second->generation;
+}
+
+void SyntaxTreeService::forget(const core::Document* doc) {
+    entries_.erase(doc);
+}
+
+std::optional<utils::BracketMatchResult>
+SyntaxTreeService::findMatchingBracket(const core::Document& doc, size_t row, size_t col) const {
+    const TSTree* current = tree(doc);
+    if (!current || row >= doc.lineCount()) {
+        return std::nullopt;
+    }
+    const std::string& line = doc.getLine(row);
+    if (col >= line.size() || !isBracket(line[col])) {
+        return std::nullopt;
+    }
+    const char open = line[col];
+    const char target = matchingBracket(open);
+
+    // 括号必须恰好是一个匿名记号；在字符串、注释里时取到的是外层的字符串/注释节点
+    TSPoint start = {static_cast<uint32_t>(row), static_cast<uint32_t>(col)};
+    TSPoint end = {static_cast<uint32_t>(row), static_cast<uint32_t>(col + 1)};
+    TSNode node = ts_node_descendant_for_point_range(ts_tree_root_node(current), start, end);
+    if (ts_node_is_null(node) || !isToken(node, open)) {
+        return std::nullopt;
+    }
+
+    // 成对的括号是同一父节点下的兄弟记号
+    const bool forward = open == '(' || open == '[' || open == '{';
+    int depth = 0;
+    for (TSNode sibling = forward ? ts_node_next_sibling(node) : ts_node_prev_sibling(node);
+         !ts_node_is_null(sibling);
+         sibling = forward ? ts_node_next_sibling(sibling) : ts_node_prev_sibling(sibling)) {
+        if (isToken(sibling, open)) {
+            depth++;
+        } else if (isToken(sibling, target)) {
+            if (depth == 0) {
+                TSPoint matched = ts_node_start_point(sibling);
+                utils::BracketMatchResult result;
+                result.current = {row, col};
+                result.matched = {matched.row, matched.column};
+                return result;
+            }
+            depth--;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<FoldingRange> SyntaxTreeService::foldingRanges(const core::Document& doc) const {
+    std::vector<FoldingRange> ranges;
+    const TSTree* current = tree(doc);
+    if (!current) {
+        return ranges;
+    }
+
+    // 起始行 → 范围；只下探跨行的节点（单行节点的子孙不可能跨行）
+    std::map<uint32_t, FoldingRange> by_start;
+    TSNode root = ts_tree_root_node(current);
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    bool descend = true;
+    while (true) {
+        TSNode node = ts_tree_cursor_current_node(&cursor);
+        TSPoint start = ts_node_start_point(node);
+        TSPoint end = ts_node_end_point(node);
+        // 结束于下一行行首的节点（如带换行的注释）不包含那一行
+        uint32_t end_row = (end.column == 0 && end.row > start.row) ? end.row - 1 : end.row;
+        bool multi_line = end_row > start.row;
+
+        if (multi_line && ts_node_is_named(node) && !ts_node_eq(node, root)) {
+            std::string type = ts_node_type(node);
+            FoldingRangeKind kind = type.find("comment") != std::string::npos
+                                        ? FoldingRangeKind::Comment
+                                        : FoldingRangeKind::Unknown;
+            auto it = by_start.find(start.row);
+            if (it == by_start.end() || static_cast<uint32_t>(it->second.endLine) < end_row) {
+                by_start[start.row] =
+                    FoldingRange(static_cast<int>(start.row), static_cast<int>(start.column),
+                                 static_cast<int>(end_row), 0, kind);
+            }
+        }
+
+        if (descend && multi_line && ts_tree_cursor_goto_first_child(&cursor)) {
+            continue;
+        }
+        descend = true;
+        if (ts_tree_cursor_goto_next_sibling(&cursor)) {
+            continue;
+        }
+        bool done = true;
+        while (ts_tree_cursor_goto_parent(&cursor)) {
+            if (ts_tree_cursor_goto_next_sibling(&cursor)) {
+                done = false;
+                break;
+            }
+        }
+        if (done) {
+            break;
+        }
+    }
+    ts_tree_cursor_delete(&cursor);
+
+    ranges.reserve(by_start.size());
+    for (auto& entry : by_start) {
+        ranges.push_back(entry.second);
+    }
+    return ranges;
+}
+
+#else
+
+SyntaxTreeService::SyntaxTreeService() = default;
+SyntaxTreeService::~SyntaxTreeService() = default;
+
+void SyntaxTreeService::setParsedCallback(ParsedCallback callback) {
+    (void)callback;
+}
+
+TSLanguage* SyntaxTreeService::languageForFileType(const std::string& file_type) {
+    (void)file_type;
+    return nullptr;
+}
+
+bool SyntaxTreeService::isAvailable() {
+    return false;
+}
+
+const TSTree* SyntaxTreeService::update(const core::Document& doc, const std::string& file_type) {
+    (void)doc;
+    (void)file_type;
+    return nullptr;
+}
+
+const TSTree* SyntaxTreeService::tree(const core::Document& doc) const {
+    (void)doc;
+    return nullptr;
+}
+
+uint64_t SyntaxTreeService::generation(const core::Document& doc) const {
+    (void)doc;
+    return 0;
+}
+
+void SyntaxTreeService::forget(const core::Document* doc) {
+    (void)doc;
+}
+
+std::optional<utils::BracketMatchResult>
+SyntaxTreeService::findMatchingBracket(const core::Document& doc, size_t row, size_t col) const {
+    (void)doc;
+    (void)row;
+    (void)col;
+    return std::nullopt;
+}
+
+std::vector<FoldingRange> SyntaxTreeService::foldingRanges(const core::Document& doc) const {
+    (void)doc;
+    return {};
+}
+
+#endif
+
+} // namespace features
+} // namespace pnana
@@ -2,6 +2,7 @@
 #include "features/terminal/terminal_pty.h"
 #include "features/terminal/terminal_pty_backend.h"
 #include "utils/logger.h"
+#include "utils/perf_monitor.h"
 #include <algorithm>
 #include <csignal>
 #include <sstream>
@@ -412,20 +413,22 @@ void TerminalSession::feedPending() {
         pending_chunks_.clear();
         pending_bytes_ = 0;
         pending_overflowed_ = false;
-        LOG("[TerminalSession] feedPending skipped: vterm_ready=" +
+        LOG_DEBUG("[TerminalSession] feedPending skipped: vterm_ready=" +
             std::to_string(vterm_ && vterm_->isReady()));
         return;
     }
     fixVTermCallbackUser();
-    LOG("[TerminalSession] feedPending start chunks=" + std::to_string(pending_chunks_.size()) +
-        " bytes=" + std::to_string(pending_bytes_) +
-        " overflowed=" + std::to_string(pending_overflowed_));
     std::deque<std::string> batch;
+    size_t batch_bytes = 0;
     {
         std::lock_guard<std::mutex> lock(pending_feed_mutex_);
         batch.swap(pending_chunks_);
+        batch_bytes = pending_bytes_;
         pending_bytes_ = 0;
     }
+    PERF_EVENT(utils::PerfEventId::TERMINAL_FEED, static_cast<int64_t>(batch.size()),
+               static_cast<int64_t>(batch_bytes), pending_overflowed_ ? 1 : 0);
+    PERF_COUNTER_ADD(PTY_BYTES_FED, batch_bytes);
     VTermStreamFilter filter(*this);
     while (!batch.empty()) {
         const std::string& s = batch.front();
@@ -0,0 +1,248 @@
+#include "features/vgit/git_gutter.h"
+#include "core/document.h"
+#include <algorithm>
+
+namespace pnana {
+namespace vgit {
+
+void GitGutterTracker::reset() {
+    // 先等待后台检查结束，它使用的是 repo_
+    if (base_job_.valid()) {
+        base_job_.wait();
+    }
+    base_job_ = std::future<BaseResult>();
+    file_path_.clear();
+    rel_path_.clear();
+    repo_.reset();
+    repo_probed_ = false;
+    base_checked_ = false;
+    has_base_ = false;
+    base_oid_ = GitOid();
+    base_lines_.clear();
+    version_ = UINT64_MAX;
+    hunks_valid_ = false;
+    hunks_.clear();
+    ranges_.clear();
+}
+
+bool GitGutterTracker::refreshBase() {
+    // 取回已完成的后台检查；进行中时沿用当前基准
+    if (base_job_.valid()) {
+        if (base_job_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+        BaseResult result = base_job_.get();
+        if (!result.found) {
+            bool changed = has_base_;
+            has_base_ = false;
+            base_lines_.clear();
+            return changed;
+        }
+        if (result.same)
+            return false;
+        has_base_ = true;
+        base_oid_ = result.oid;
+        base_lines_ = std::move(result.lines);
+        return true;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (base_checked_ && now - last_base_check_ < std::chrono::seconds(1))
+        return false;
+    base_checked_ = true;
+    last_base_check_ = now;
+
+    if (rel_path_.empty()) {
+        bool changed = has_base_;
+        has_base_ = false;
+        base_lines_.clear();
+        return changed;
+    }
+
+    // stat/解析 .git/index 与读取 blob 放到后台；任务运行期间只有它使用 repo_
+    GitNativeRepository* repo = repo_.get();
+    std::string rel_path = rel_path_;
+    bool known = has_base_;
+    GitOid known_oid = base_oid_;
+    base_job_ = std::async(std::launch::async, [repo, rel_path, known, known_oid]() {
+        BaseResult result;
+        result.found = repo->baseBlob(rel_path, result.oid);
+        if (!result.found)
+            return result;
+        if (known && result.oid == known_oid) {
+            result.same = true;
+            return result;
+        }
+        result.found = repo->readBlobLines(result.oid, result.lines);
+        return result;
+    });
+    return false;
+}
+
+void GitGutterTracker::update(const std::string& file_path, const core::Document& doc) {
+    if (file_path != file_path_) {
+        reset();
+        file_path_ = file_path;
+    }
+    if (file_path_.empty())
+        return;
+
+    if (!repo_probed_) {
+        repo_probed_ = true;
+        repo_ = GitNativeRepository::open(file_path_);
+        if (repo_)
+            rel_path_ = repo_->relativePath(file_path_);
+    }
+    if (!repo_)
+        return;
+
+    bool base_changed = refreshBase();
+    const uint64_t version = doc.getVersion();
+    if (!base_changed && version == version_)
+        return;
+
+    const std::vector<std::string>& lines = doc.getLines();
+    if (!has_base_ || lines.size() > MAX_LINES) {
+        version_ = version;
+        hunks_valid_ = false;
+        hunks_.clear();
+        ranges_.clear();
+        return;
+    }
+
+    std::vector<core::ContentEdit> edits;
+    bool patched = !base_changed && hunks_valid_ && doc.getEditsSince(version_, edits) &&
+                   patchHunks(hunks_, base_lines_, lines, edits);
+    if (!patched) {
+        // compute 先裁掉公共前后缀，剩余部分才进入 Myers
+        hunks_ = GitLineDiff::compute(base_lines_, lines, 500);
+        hunks_valid_ = true;
+    }
+    version_ = version;
+    rebuildRanges();
+}
+
+bool GitGutterTracker::patchHunks(std::vector<GitLineHunk>& hunks,
+                                  const std::vector<std::string>& base_lines,
+                                  const std::vector<std::string>& lines,
+                                  const std::vector<core::ContentEdit>& edits) {
+    if (edits.empty())
+        return true;
+
+    // 脏窗口：编辑前的 [lo, old_hi) 变为当前的 [lo, new_hi)。
+    // lo 之前的行不变，old_hi 之后的行整体平移 new_hi - old_hi
+    size_t lo = 0;
+    size_t old_hi = 0;
+    size_t new_hi = 0;
+    bool dirty = false;
+    for (const auto& entry : edits) {
+        const core::TextEdit& edit = entry.edit;
+        const size_t inserted =
+            static_cast<size_t>(std::count(edit.text.begin(), edit.text.end(), '\n'));
+        const size_t edit_end = edit.end_row + 1;                 // 编辑前，不含
+        const size_t after_end = edit.start_row + inserted + 1;   // 编辑后，不含
+        if (!dirty) {
+            lo = edit.start_row;
+            old_hi = edit_end;
+            new_hi = after_end;
+            dirty = true;
+            continue;
+        }
+        lo = std::min(lo, edit.start_row);
+        if (edit_end > new_hi) {
+            // 编辑延伸到窗口之后：窗口连同中间未改动的行一起扩大
+            old_hi += edit_end - new_hi;
+            new_hi = edit_end;
+        }
+        new_hi = new_hi - edit_end + after_end;
+    }
+    // 与窗口相交或相邻的变更块一并重算；base_shift 为窗口之前的 基准行号 - 文档行号
+    int64_t base_shift = 0;
+    size_t first = 0;
+    while (first < hunks.size() && hunks[first].new_start + hunks[first].new_count < lo) {
+        base_shift += static_cast<int64_t>(hunks[first].old_count) -
+                      static_cast<int64_t>(hunks[first].new_count);
+        ++first;
+    }
+    int64_t window_shift = base_shift;
+    size_t last = first;
+    while (last < hunks.size() && hunks[last].new_start <= old_hi) {
+        const GitLineHunk& hunk = hunks[last];
+        lo = std::min(lo, hunk.new_start);
+        const size_t hunk_end = hunk.new_start + hunk.new_count;
+        if (hunk_end > old_hi) {
+            new_hi += hunk_end - old_hi;
+            old_hi = hunk_end;
+        }
+        window_shift +=
+            static_cast<int64_t>(hunk.old_count) - static_cast<int64_t>(hunk.new_count);
+        ++last;
+    }
+
+    const int64_t base_lo = static_cast<int64_t>(lo) + base_shift;
+    const int64_t base_hi = static_cast<int64_t>(old_hi) + window_shift;
+    if (base_lo < 0 || base_hi < base_lo || static_cast<size_t>(base_hi) > base_lines.size() ||
+        new_hi > lines.size()) {
+        return false;
+    }
+
+    std::vector<std::string> base_window(base_lines.begin() + base_lo,
+                                         base_lines.begin() + base_hi);
+    std::vector<std::string> new_window(lines.begin() + static_cast<std::ptrdiff_t>(lo),
+                                        lines.begin() + static_cast<std::ptrdiff_t>(new_hi));
+    std::vector<GitLineHunk> window_hunks = GitLineDiff::compute(base_window, new_window, 500);
+
+    const int64_t delta = static_cast<int64_t>(new_hi) - static_cast<int64_t>(old_hi);
+    std::vector<GitLineHunk> merged;
+    merged.reserve(first + window_hunks.size() + (hunks.size() - last));
+    merged.insert(merged.end(), hunks.begin(), hunks.begin() + first);
+    for (GitLineHunk hunk : window_hunks) {
+        hunk.old_start += static_cast<size_t>(base_lo);
+        hunk.new_start += lo;
+        merged.push_back(hunk);
+    }
+    for (size_t i = last; i < hunks.size(); ++i) {
+        GitLineHunk hunk = hunks[i];
+        hunk.new_start = static_cast<size_t>(static_cast<int64_t>(hunk.new_start) + delta);
+        merged.push_back(hunk);
+    }
+    hunks.swap(merged);
+    return true;
+}
+
+void GitGutterTracker::rebuildRanges() {
+    ranges_.clear();
+    ranges_.reserve(hunks_.size());
+    for (const auto& hunk : hunks_) {
+        switch (hunk.kind) {
+            case GitLineHunk::Kind::ADDED:
+                ranges_.push_back({hunk.new_start, hunk.new_start + hunk.new_count, Mark::ADDED});
+                break;
+            case GitLineHunk::Kind::MODIFIED:
+                ranges_.push_back(
+                    {hunk.new_start, hunk.new_start + hunk.new_count, Mark::MODIFIED});
+                break;
+            case GitLineHunk::Kind::DELETED:
+                if (hunk.new_start == 0) {
+                    ranges_.push_back({0, 1, Mark::REMOVED_ABOVE});
+                } else {
+                    ranges_.push_back({hunk.new_start - 1, hunk.new_start, Mark::REMOVED_BELOW});
+                }
+                break;
+        }
+    }
+    // 删除标记可能落在前一个块的最后一行上，保持按 start 有序以便二分
+    std::stable_sort(ranges_.begin(), ranges_.end(),
+                     [](const MarkRange& a, const MarkRange& b) { return a.start < b.start; });
+}
+
+GitGutterTracker::Mark GitGutterTracker::markForLine(size_t line) const {
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), line,
+                               [](size_t l, const MarkRange& r) { return l < r.start; });
+    if (it == ranges_.begin())
+        return Mark::NONE;
+    --it;
+    return line < it->end ? it->mark : Mark::NONE;
+}
+
+} // namespace vgit
+} // namespace pnana
@@ -0,0 +1,156 @@
+#include "features/vgit/git_index.h"
+#include "utils/logger.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace pnana {
+namespace vgit {
+
+static inline uint32_t readBE32(const char* p) {
+    const uint8_t* u = reinterpret_cast<const uint8_t*>(p);
+    return (static_cast<uint32_t>(u[0]) << 24) | (static_cast<uint32_t>(u[1]) << 16) |
+           (static_cast<uint32_t>(u[2]) << 8) | static_cast<uint32_t>(u[3]);
+}
+
+static inline uint16_t readBE16(const char* p) {
+    const uint8_t* u = reinterpret_cast<const uint8_t*>(p);
+    return static_cast<uint16_t>((u[0] << 8) | u[1]);
+}
+
+bool GitIndex::load(const std::string& index_path) {
+    struct stat st;
+    if (stat(index_path.c_str(), &st) != 0) {
+        // 空仓库（尚无 index）视为没有任何条目
+        if (index_size_ != 0) {
+            entries_.clear();
+            by_path_.clear();
+            index_size_ = 0;
+            ++generation_;
+        }
+        return true;
+    }
+
+    if (st.st_size == index_size_ && st.st_mtim.tv_sec == index_mtime_sec_ &&
+        st.st_mtim.tv_nsec == index_mtime_nsec_) {
+        return true;
+    }
+
+    std::ifstream in(index_path, std::ios::binary);
+    if (!in.is_open())
+        return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    if (!parse(ss.str())) {
+        LOG_WARNING("GitIndex: failed to parse " + index_path);
+        return false;
+    }
+
+    index_size_ = st.st_size;
+    index_mtime_sec_ = st.st_mtim.tv_sec;
+    index_mtime_nsec_ = st.st_mtim.tv_nsec;
+    ++generation_;
+    return true;
+}
+
+bool GitIndex::parse(const std::string& data) {
+    if (data.size() < 12 || data.compare(0, 4, "DIRC") != 0)
+        return false;
+    uint32_t version = readBE32(data.data() + 4);
+    if (version < 2 || version > 4)
+        return false;
+    uint32_t count = readBE32(data.data() + 8);
+
+    std::vector<GitIndexEntry> entries;
+    entries.reserve(count);
+    size_t pos = 12;
+    std::string prev_path;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const size_t entry_start = pos;
+        if (pos + 62 > data.size())
+            return false;
+        const char* p = data.data() + pos;
+
+        GitIndexEntry e;
+        e.ctime_sec = readBE32(p);
+        e.ctime_nsec = readBE32(p + 4);
+        e.mtime_sec = readBE32(p + 8);
+        e.mtime_nsec = readBE32(p + 12);
+        e.dev = readBE32(p + 16);
+        e.ino = readBE32(p + 20);
+        e.mode = readBE32(p + 24);
+        e.uid = readBE32(p + 28);
+        e.gid = readBE32(p + 32);
+        e.size = readBE32(p + 36);
+        std::memcpy(e.oid.bytes.data(), p + 40, 20);
+        uint16_t flags = readBE16(p + 60);
+        e.assume_valid = (flags & 0x8000) != 0;
+        e.stage = static_cast<uint16_t>((flags >> 12) & 0x3);
+        pos += 62;
+
+        if ((flags & 0x4000) && version >= 3) {
+            if (pos + 2 > data.size())
+                return false;
+            uint16_t ext = readBE16(data.data() + pos);
+            e.skip_worktree = (ext & 0x4000) != 0;
+            e.intent_to_add = (ext & 0x2000) != 0;
+            pos += 2;
+        }
+
+        if (version == 4) {
+            // v4：路径前缀压缩 — varint(去掉前一路径末尾字节数) + NUL 结尾后缀
+            size_t strip = 0;
+            uint8_t c = 0;
+            int guard = 0;
+            do {
+                if (pos >= data.size() || ++guard > 10)
+                    return false;
+                c = static_cast<uint8_t>(data[pos++]);
+                strip = (strip << 7) | (c & 0x7f);
+                if (c & 0x80)
+                    strip += 1;
+            } while (c & 0x80);
+            size_t nul = data.find('\0', pos);
+            if (nul == std::string::npos || strip > prev_path.size())
+                return false;
+            e.path = prev_path.substr(0, prev_path.size() - strip) + data.substr(pos, nul - pos);
+            pos = nul + 1;
+        } else {
+            size_t nul = data.find('\0', pos);
+            if (nul == std::string::npos)
+                return false;
+            e.path = data.substr(pos, nul - pos);
+            // v2/v3：条目以 1-8 个 NUL 填充到 8 字节对齐
+            size_t entry_len = nul - entry_start;
+            pos = entry_start + ((entry_len + 8) & ~static_cast<size_t>(7));
+        }
+
+        prev_path = e.path;
+        entries.push_back(std::move(e));
+    }
+
+    entries_ = std::move(entries);
+    by_path_.clear();
+    by_path_.reserve(entries_.size());
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        // 冲突条目存在多个 stage，保留第一个出现的
+        by_path_.emplace(entries_[i].path, i);
+    }
+    return true;
+}
+
+const GitIndexEntry* GitIndex::find(const std::string& path) const {
+    auto it = by_path_.find(path);
+    return it == by_path_.end() ? nullptr : &entries_[it->second];
+}
+
+bool GitIndex::isRacy(const GitIndexEntry& entry) const {
+    if (static_cast<int64_t>(entry.mtime_sec) != index_mtime_sec_)
+        return static_cast<int64_t>(entry.mtime_sec) > index_mtime_sec_;
+    return static_cast<int64_t>(entry.mtime_nsec) >= index_mtime_nsec_;
+}
+
+} // namespace vgit
+} // namespace pnana
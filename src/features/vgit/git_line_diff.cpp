@@ -0,0 +1,231 @@
+#include "features/vgit/git_line_diff.h"
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+namespace pnana {
+namespace vgit {
+
+namespace {
+
+// 经典 Myers O(ND) 前向搜索，trace 只保存 [-d, d] 区间，内存 O(D^2)
+// 返回匹配行对 (old_index, new_index)；超过 max_d 返回 false
+bool myersMatches(const std::vector<int>& a, const std::vector<int>& b, size_t max_d,
+                  std::vector<std::pair<size_t, size_t>>& matches) {
+    const int n = static_cast<int>(a.size());
+    const int m = static_cast<int>(b.size());
+    const int limit = static_cast<int>(std::min<size_t>(max_d, static_cast<size_t>(n + m)));
+    const int offset = limit + 1;
+    std::vector<int> v(static_cast<size_t>(2 * limit + 3), 0);
+    std::vector<std::vector<int>> trace;
+
+    int found_d = -1;
+    for (int d = 0; d <= limit && found_d < 0; ++d) {
+        for (int k = -d; k <= d; k += 2) {
+            int x;
+            if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) {
+                x = v[offset + k + 1];
+            } else {
+                x = v[offset + k - 1] + 1;
+            }
+            int y = x - k;
+            while (x < n && y < m && a[x] == b[y]) {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x >= n && y >= m) {
+                found_d = d;
+                break;
+            }
+        }
+        trace.emplace_back(v.begin() + (offset - d), v.begin() + (offset + d + 1));
+    }
+    if (found_d < 0)
+        return false;
+
+    std::vector<std::pair<size_t, size_t>> reversed;
+    int x = n;
+    int y = m;
+    for (int d = found_d; d > 0; --d) {
+        const std::vector<int>& prev = trace[static_cast<size_t>(d - 1)];
+        auto prevAt = [&](int k) { return prev[static_cast<size_t>(k + d - 1)]; };
+        int k = x - y;
+        int prev_k = (k == -d || (k != d && prevAt(k - 1) < prevAt(k + 1))) ? k + 1 : k - 1;
+        int prev_x = prevAt(prev_k);
+        int prev_y = prev_x - prev_k;
+        while (x > prev_x && y > prev_y) {
+            --x;
+            --y;
+            reversed.emplace_back(static_cast<size_t>(x), static_cast<size_t>(y));
+        }
+        x = prev_x;
+        y = prev_y;
+    }
+    while (x > 0 && y > 0) {
+        --x;
+        --y;
+        reversed.emplace_back(static_cast<size_t>(x), static_cast<size_t>(y));
+    }
+    matches.assign(reversed.rbegin(), reversed.rend());
+    return true;
+}
+
+void pushHunk(std::vector<GitLineHunk>& hunks, size_t old_start, size_t old_count,
+              size_t new_start, size_t new_count) {
+    if (old_count == 0 && new_count == 0)
+        return;
+    GitLineHunk h;
+    h.old_start = old_start;
+    h.old_count = old_count;
+    h.new_start = new_start;
+    h.new_count = new_count;
+    if (old_count == 0) {
+        h.kind = GitLineHunk::Kind::ADDED;
+    } else if (new_count == 0) {
+        h.kind = GitLineHunk::Kind::DELETED;
+    } else {
+        h.kind = GitLineHunk::Kind::MODIFIED;
+    }
+    hunks.push_back(h);
+}
+
+// git 的 @@ 范围格式：长度为 1 时省略 ",1"，长度为 0 时起始行为前一行
+std::string rangeSpec(size_t begin, size_t len) {
+    if (len == 1)
+        return std::to_string(begin + 1);
+    return std::to_string(len == 0 ? begin : begin + 1) + "," + std::to_string(len);
+}
+
+} // namespace
+
+std::vector<GitLineHunk> GitLineDiff::compute(const std::vector<std::string>& old_lines,
+                                              const std::vector<std::string>& new_lines,
+                                              size_t max_edit_distance) {
+    std::vector<GitLineHunk> hunks;
+    const size_t n = old_lines.size();
+    const size_t m = new_lines.size();
+
+    size_t prefix = 0;
+    while (prefix < n && prefix < m && old_lines[prefix] == new_lines[prefix]) {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < n - prefix && suffix < m - prefix &&
+           old_lines[n - 1 - suffix] == new_lines[m - 1 - suffix]) {
+        ++suffix;
+    }
+
+    const size_t old_mid = n - prefix - suffix;
+    const size_t new_mid = m - prefix - suffix;
+    if (old_mid == 0 || new_mid == 0) {
+        pushHunk(hunks, prefix, old_mid, prefix, new_mid);
+        return hunks;
+    }
+
+    // 行内容驻留为整数 ID，Myers 内层循环只比较 int
+    std::unordered_map<std::string_view, int> ids;
+    ids.reserve(old_mid + new_mid);
+    auto intern = [&](const std::string& s) {
+        auto it = ids.emplace(std::string_view(s), static_cast<int>(ids.size())).first;
+        return it->second;
+    };
+    std::vector<int> a(old_mid);
+    std::vector<int> b(new_mid);
+    for (size_t i = 0; i < old_mid; ++i)
+        a[i] = intern(old_lines[prefix + i]);
+    for (size_t i = 0; i < new_mid; ++i)
+        b[i] = intern(new_lines[prefix + i]);
+
+    std::vector<std::pair<size_t, size_t>> matches;
+    if (!myersMatches(a, b, max_edit_distance, matches)) {
+        pushHunk(hunks, prefix, old_mid, prefix, new_mid);
+        return hunks;
+    }
+
+    size_t i = 0;
+    size_t j = 0;
+    for (const auto& match : matches) {
+        if (match.first > i || match.second > j) {
+            pushHunk(hunks, prefix + i, match.first - i, prefix + j, match.second - j);
+        }
+        i = match.first + 1;
+        j = match.second + 1;
+    }
+    pushHunk(hunks, prefix + i, old_mid - i, prefix + j, new_mid - j);
+    return hunks;
+}
+
+std::vector<std::string> GitLineDiff::toUnifiedDiff(const std::string& path,
+                                                    const std::vector<std::string>& old_lines,
+                                                    const std::vector<std::string>& new_lines,
+                                                    const std::vector<GitLineHunk>& hunks,
+                                                    size_t context) {
+    std::vector<std::string> out;
+    if (hunks.empty())
+        return out;
+
+    out.push_back("diff --git a/" + path + " b/" + path);
+    out.push_back("--- a/" + path);
+    out.push_back("+++ b/" + path);
+
+    size_t g = 0;
+    while (g < hunks.size()) {
+        // 相邻块间距不超过 2*context 时合并到同一个 @@ 段
+        size_t last = g;
+        while (last + 1 < hunks.size() &&
+               hunks[last + 1].old_start - (hunks[last].old_start + hunks[last].old_count) <=
+                   2 * context) {
+            ++last;
+        }
+
+        const GitLineHunk& first_h = hunks[g];
+        const GitLineHunk& last_h = hunks[last];
+        size_t old_begin = first_h.old_start > context ? first_h.old_start - context : 0;
+        size_t new_begin = first_h.new_start - (first_h.old_start - old_begin);
+        size_t old_tail = last_h.old_start + last_h.old_count;
+        size_t old_end = std::min(old_lines.size(), old_tail + context);
+        size_t new_end = last_h.new_start + last_h.new_count + (old_end - old_tail);
+        size_t old_len = old_end - old_begin;
+        size_t new_len = new_end - new_begin;
+
+        out.push_back("@@ -" + rangeSpec(old_begin, old_len) + " +" +
+                      rangeSpec(new_begin, new_len) + " @@");
+
+        size_t oi = old_begin;
+        for (size_t h = g; h <= last; ++h) {
+            for (; oi < hunks[h].old_start; ++oi)
+                out.push_back(" " + old_lines[oi]);
+            for (size_t k = 0; k < hunks[h].old_count; ++k)
+                out.push_back("-" + old_lines[hunks[h].old_start + k]);
+            for (size_t k = 0; k < hunks[h].new_count; ++k)
+                out.push_back("+" + new_lines[hunks[h].new_start + k]);
+            oi = hunks[h].old_start + hunks[h].old_count;
+        }
+        for (; oi < old_end; ++oi)
+            out.push_back(" " + old_lines[oi]);
+
+        g = last + 1;
+    }
+    return out;
+}
+
+std::vector<std::string> GitLineDiff::splitLines(const std::string& content) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (start < content.size()) {
+        size_t nl = content.find('\n', start);
+        size_t end = nl == std::string::npos ? content.size() : nl;
+        size_t len = end - start;
+        if (len > 0 && content[start + len - 1] == '\r')
+            --len;
+        lines.emplace_back(content, start, len);
+        if (nl == std::string::npos)
+            break;
+        start = nl + 1;
+    }
+    return lines;
+}
+
+} // namespace vgit
+} // namespace pnana
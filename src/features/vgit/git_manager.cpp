@@ -1,4 +1,5 @@
 #include "features/vgit/git_manager.h"
+#include "features/vgit/git_native_repository.h"
 #include "utils/logger.h"
 #include <algorithm>
 #include <array>
@@ -24,10 +25,32 @@ GitManager::GitManager(const std::string& repo_path) : repo_path_(repo_path) {
     last_status_refresh_ = std::chrono::steady_clock::now() - status_cache_timeout_;
 }
 
+GitManager::~GitManager() = default;
+
+GitNativeRepository* GitManager::nativeRepository() {
+    if (remote_executor_)
+        return nullptr;
+    if (!native_probed_) {
+        native_probed_ = true;
+        native_ = GitNativeRepository::open(repo_path_);
+        if (native_)
+            native_->setBlobFallback(blob_fallback_);
+    }
+    return native_.get();
+}
+
+void GitManager::setBlobFallback(BlobReader reader) {
+    blob_fallback_ = std::move(reader);
+    if (native_)
+        native_->setBlobFallback(blob_fallback_);
+}
+
 void GitManager::setRemoteExecutor(RemoteExecutor executor, const std::string& label,
                                    const std::string& remote_path) {
     remote_executor_ = std::move(executor);
     remote_label_ = label;
+    native_.reset();
+    native_probed_ = false;
     repo_path_ = remote_path;
     repo_root_ = remote_path; // 先假设 remote_path 就是 repo 根；isGitRepository 会重新确认
     // 全量清除缓存，让下次调用重新检测远程 git
@@ -40,6 +63,8 @@ void GitManager::setRemoteExecutor(RemoteExecutor executor, const std::string& l
 void GitManager::clearRemoteContext(const std::string& local_path) {
     remote_executor_ = nullptr;
     remote_label_.clear();
+    native_.reset();
+    native_probed_ = false;
     repo_path_ = local_path;
     repo_root_ = local_path;
     invalidateRepoStatusCache();
@@ -252,23 +277,7 @@ bool GitManager::refreshStatus() {
     }
 
     clearError();
-
-    // Get porcelain status output - using v2 for better performance
-    std::string cmd = "git -C \"" + repo_root_ + "\" status --porcelain=v2";
-    auto lines = executeGitCommandLines(cmd);
-
-    current_status_.clear();
-
-    for (const auto& line : lines) {
-        if (line.length() >= 3) {
-            parseStatusLine(line, current_status_);
-        }
-    }
-
-    // Update cache timestamp
-    last_status_refresh_ = std::chrono::steady_clock::now();
-
-    return true;
+    return loadStatus();
 }
 
 bool GitManager::refreshStatusForced() {
@@ -278,8 +287,23 @@ bool GitManager::refreshStatusForced() {
     }
 
     clearError();
+    return loadStatus();
+}
 
-    // Get porcelain status output - forced refresh, no cache
+bool GitManager::loadStatus() {
+    // 本地仓库：直接读 .git/index + 对象库，stat 未变化的文件不读内容
+    if (GitNativeRepository* native = nativeRepository()) {
+        std::vector<GitFile> files;
+        std::string error;
+        if (native->computeStatus(files, error)) {
+            current_status_ = std::move(files);
+            last_status_refresh_ = std::chrono::steady_clock::now();
+            return true;
+        }
+        LOG_WARNING("Native git status failed, falling back to git command: " + error);
+    }
+
+    // Get porcelain status output - using v2 for better performance
     std::string cmd = "git -C \"" + repo_root_ + "\" status --porcelain=v2";
     auto lines = executeGitCommandLines(cmd);
 
@@ -509,77 +533,111 @@ std::vector<GitCommit> GitManager::getGraphCommits(int count, int skip) {
     std::vector<GitCommit> commits;
 
     for (const auto& line : lines) {
-        // Skip empty lines
-        if (line.empty()) {
-            continue;
+        GitCommit commit;
+        if (parseGraphLine(line, commit)) {
+            commits.push_back(std::move(commit));
         }
+    }
 
-        // line is: <graph-chars><marker><hash>|<parents>|<msg>|<author>|<date>
-        const std::string marker = std::string(1, static_cast<char>(0x1f));
-        size_t mpos = line.find(marker);
-        std::string graph_prefix;
-        std::string fields;
-        if (mpos != std::string::npos) {
-            graph_prefix = line.substr(0, mpos);
-            // sanitize graph_prefix: remove control characters except the ASCII graph chars
-            std::string clean;
-            for (char c : graph_prefix) {
-                unsigned char uc = static_cast<unsigned char>(c);
-                if (uc >= 32) {
-                    clean.push_back(c);
-                } else {
-                    // allow unit separator only as marker (already removed), replace others with
-                    // space
-                    clean.push_back(' ');
-                }
-            }
-            // replace tabs with spaces
-            for (auto& ch : clean)
-                if (ch == '\t')
-                    ch = ' ';
-            graph_prefix = clean;
-            fields = line.substr(mpos + marker.size());
-        } else {
-            // fallback: no marker — treat whole line as fields
-            fields = line;
-        }
+    return commits;
+}
 
-        // Parse fields: hash|parents|message|author|date
-        size_t pos1 = fields.find('|');
-        if (pos1 == std::string::npos)
-            continue;
-        size_t pos2 = fields.find('|', pos1 + 1);
-        if (pos2 == std::string::npos)
-            continue;
-        size_t pos3 = fields.find('|', pos2 + 1);
-        if (pos3 == std::string::npos)
-            continue;
-        size_t pos4 = fields.find('|', pos3 + 1);
-        if (pos4 == std::string::npos)
-            continue;
+bool GitManager::readBlob(const std::string& spec, std::string& out) {
+    if (!isGitRepository()) {
+        last_error_ = "Not a git repository";
+        return false;
+    }
+
+    std::string cmd = "git -C \"" + repo_root_ + "\" cat-file blob \"" + escapePath(spec) +
+                      "\" 2>/dev/null";
+    if (remote_executor_) {
+        auto [ok, result] = remote_executor_(cmd);
+        out = std::move(result);
+        return ok;
+    }
+
+    std::unique_ptr<FILE, int (*)(FILE*)> pipe(popen(cmd.c_str(), "r"), pclose);
+    if (!pipe) {
+        last_error_ = "Failed to execute git command";
+        return false;
+    }
+    out.clear();
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe.get())) > 0) {
+        out.append(buffer, n);
+    }
+    return pclose(pipe.release()) == 0;
+}
 
-        std::string hash = fields.substr(0, pos1);
-        std::string parents_str = fields.substr(pos1 + 1, pos2 - pos1 - 1);
-        std::string message = fields.substr(pos2 + 1, pos3 - pos2 - 1);
-        std::string author = fields.substr(pos3 + 1, pos4 - pos3 - 1);
-        std::string date = fields.substr(pos4 + 1);
-
-        std::vector<std::string> parents;
-        if (!parents_str.empty()) {
-            std::istringstream pis(parents_str);
-            std::string p;
-            while (pis >> p) {
-                parents.push_back(p);
+bool GitManager::parseGraphLine(const std::string& line, GitCommit& out) {
+    // Skip empty lines and pure graph connector lines (no marker / fields)
+    if (line.empty()) {
+        return false;
+    }
+
+    // line is: <graph-chars><marker><hash>|<parents>|<msg>|<author>|<date>
+    const std::string marker = std::string(1, static_cast<char>(0x1f));
+    size_t mpos = line.find(marker);
+    std::string graph_prefix;
+    std::string fields;
+    if (mpos != std::string::npos) {
+        graph_prefix = line.substr(0, mpos);
+        // sanitize graph_prefix: remove control characters except the ASCII graph chars
+        std::string clean;
+        for (char c : graph_prefix) {
+            unsigned char uc = static_cast<unsigned char>(c);
+            if (uc >= 32) {
+                clean.push_back(c);
+            } else {
+                // allow unit separator only as marker (already removed), replace others with
+                // space
+                clean.push_back(' ');
             }
         }
+        // replace tabs with spaces
+        for (auto& ch : clean)
+            if (ch == '\t')
+                ch = ' ';
+        graph_prefix = clean;
+        fields = line.substr(mpos + marker.size());
+    } else {
+        // fallback: no marker — treat whole line as fields
+        fields = line;
+    }
 
-        commits.emplace_back(hash, parents, message, author, date);
-        if (!graph_prefix.empty()) {
-            commits.back().graph_prefix = graph_prefix;
+    // Parse fields: hash|parents|message|author|date
+    size_t pos1 = fields.find('|');
+    if (pos1 == std::string::npos)
+        return false;
+    size_t pos2 = fields.find('|', pos1 + 1);
+    if (pos2 == std::string::npos)
+        return false;
+    size_t pos3 = fields.find('|', pos2 + 1);
+    if (pos3 == std::string::npos)
+        return false;
+    size_t pos4 = fields.find('|', pos3 + 1);
+    if (pos4 == std::string::npos)
+        return false;
+
+    std::string hash = fields.substr(0, pos1);
+    std::string parents_str = fields.substr(pos1 + 1, pos2 - pos1 - 1);
+    std::string message = fields.substr(pos2 + 1, pos3 - pos2 - 1);
+    std::string author = fields.substr(pos3 + 1, pos4 - pos3 - 1);
+    std::string date = fields.substr(pos4 + 1);
+
+    std::vector<std::string> parents;
+    if (!parents_str.empty()) {
+        std::istringstream pis(parents_str);
+        std::string p;
+        while (pis >> p) {
+            parents.push_back(p);
         }
     }
 
-    return commits;
+    out = GitCommit(hash, parents, message, author, date);
+    out.graph_prefix = graph_prefix;
+    return true;
 }
 
 std::vector<GitBranch> GitManager::getBranches() {
@@ -677,6 +735,10 @@ std::string GitManager::getCurrentBranch() {
         return "";
     }
 
+    if (GitNativeRepository* native = nativeRepository()) {
+        return native->currentBranch();
+    }
+
     std::string cmd = "git -C \"" + repo_root_ + "\" branch --show-current";
     std::string result = executeGitCommand(cmd);
 
@@ -789,6 +851,18 @@ std::vector<std::string> GitManager::getDiff(const std::string& path) {
 
     clearError();
 
+    if (GitNativeRepository* native = nativeRepository()) {
+        std::string rel_path = native->relativePath(
+            fs::path(path).is_absolute() ? path : (fs::path(repo_root_) / path).string());
+        if (!rel_path.empty()) {
+            auto lines = native->unifiedDiff(rel_path);
+            if (lines.empty()) {
+                last_error_ = "File not found in git status";
+            }
+            return lines;
+        }
+    }
+
     std::string escaped_path = escapePath(path);
 
     // Try unstaged changes first
@@ -0,0 +1,678 @@
+#include "features/vgit/git_native_repository.h"
+#include "features/vgit/git_line_diff.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <functional>
+#include <limits.h>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_set>
+
+namespace pnana {
+namespace vgit {
+
+namespace {
+
+bool readWholeFile(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+        return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+bool looksBinary(const std::string& data) {
+    // 与 git 相同的启发式：前 8000 字节中出现 NUL 即视为二进制
+    size_t n = std::min<size_t>(data.size(), 8000);
+    return std::memchr(data.data(), '\0', n) != nullptr;
+}
+
+// 支持 *, ?, [...], ** 的 gitignore 通配匹配；'*' 不跨越 '/'
+bool globMatch(const char* p, const char* s) {
+    while (*p) {
+        if (p[0] == '*' && p[1] == '*') {
+            const char* rest = p + 2;
+            while (*rest == '*')
+                ++rest;
+            if (*rest == '/') {
+                ++rest;
+                if (globMatch(rest, s))
+                    return true;
+                for (const char* t = s; *t; ++t) {
+                    if (*t == '/' && globMatch(rest, t + 1))
+                        return true;
+                }
+                return false;
+            }
+            for (const char* t = s;; ++t) {
+                if (globMatch(rest, t))
+                    return true;
+                if (!*t)
+                    return false;
+            }
+        }
+        if (*p == '*') {
+            for (const char* t = s;; ++t) {
+                if (globMatch(p + 1, t))
+                    return true;
+                if (!*t || *t == '/')
+                    return false;
+            }
+        }
+        if (!*s)
+            return false;
+        if (*p == '?') {
+            if (*s == '/')
+                return false;
+        } else if (*p == '[') {
+            const char* q = p + 1;
+            bool negate = (*q == '!' || *q == '^');
+            if (negate)
+                ++q;
+            bool matched = false;
+            bool first = true;
+            while (*q && (first || *q != ']')) {
+                first = false;
+                if (q[1] == '-' && q[2] && q[2] != ']') {
+                    if (*s >= q[0] && *s <= q[2])
+                        matched = true;
+                    q += 3;
+                } else {
+                    if (*s == *q)
+                        matched = true;
+                    ++q;
+                }
+            }
+            if (*q != ']') {
+                // 不闭合的 '[' 按字面量处理
+                if (*s != '[')
+                    return false;
+            } else {
+                if (matched == negate || *s == '/')
+                    return false;
+                p = q;
+            }
+        } else {
+            if (*p == '\\' && p[1])
+                ++p;
+            if (*p != *s)
+                return false;
+        }
+        ++p;
+        ++s;
+    }
+    return *s == '\0';
+}
+
+std::string parentDir(const std::string& rel_path) {
+    size_t slash = rel_path.rfind('/');
+    return slash == std::string::npos ? std::string() : rel_path.substr(0, slash);
+}
+
+} // namespace
+
+std::unique_ptr<GitNativeRepository> GitNativeRepository::open(const std::string& path) {
+    if (!GitObjectStore::isSupported())
+        return nullptr;
+
+    char resolved[PATH_MAX];
+    if (!realpath(path.c_str(), resolved))
+        return nullptr;
+    std::string dir = resolved;
+
+    struct stat st;
+    if (stat(dir.c_str(), &st) == 0 && !S_ISDIR(st.st_mode))
+        dir = parentDir(dir).empty() ? "/" : parentDir(dir);
+
+    while (true) {
+        std::string dot_git = (dir == "/" ? "" : dir) + "/.git";
+        if (lstat(dot_git.c_str(), &st) == 0) {
+            std::string git_dir;
+            if (S_ISDIR(st.st_mode)) {
+                git_dir = dot_git;
+            } else {
+                // submodule / worktree: ".git" 文件内容为 "gitdir: <path>"
+                std::string content;
+                if (!readWholeFile(dot_git, content) || content.compare(0, 8, "gitdir: ") != 0)
+                    return nullptr;
+                git_dir = content.substr(8);
+                while (!git_dir.empty() && (git_dir.back() == '\n' || git_dir.back() == '\r'))
+                    git_dir.pop_back();
+                if (!git_dir.empty() && git_dir[0] != '/')
+                    git_dir = dir + "/" + git_dir;
+            }
+            // linked worktree 的对象库在 commondir 中，交给 git 命令处理
+            if (access((git_dir + "/commondir").c_str(), F_OK) == 0)
+                return nullptr;
+            if (access((git_dir + "/HEAD").c_str(), F_OK) != 0)
+                return nullptr;
+            return std::unique_ptr<GitNativeRepository>(new GitNativeRepository(dir, git_dir));
+        }
+        if (dir == "/" || dir.empty())
+            return nullptr;
+        dir = parentDir(dir);
+        if (dir.empty())
+            dir = "/";
+    }
+}
+
+GitNativeRepository::GitNativeRepository(const std::string& work_tree, const std::string& git_dir)
+    : work_tree_(work_tree), git_dir_(git_dir), store_(git_dir) {
+    loadIgnoreFile(git_dir_ + "/info/exclude", "", global_ignores_);
+    const char* xdg = std::getenv("XDG_CONFIG_HOME");
+    const char* home = std::getenv("HOME");
+    if (xdg && *xdg) {
+        loadIgnoreFile(std::string(xdg) + "/git/ignore", "", global_ignores_);
+    } else if (home && *home) {
+        loadIgnoreFile(std::string(home) + "/.config/git/ignore", "", global_ignores_);
+    }
+}
+
+std::string GitNativeRepository::currentBranch() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string ref = store_.readSymbolicHead();
+    const std::string prefix = "refs/heads/";
+    if (ref.compare(0, prefix.size(), prefix) == 0)
+        return ref.substr(prefix.size());
+    return ref;
+}
+
+std::string GitNativeRepository::relativePath(const std::string& path) const {
+    std::string abs = path;
+    char resolved[PATH_MAX];
+    if (realpath(path.c_str(), resolved)) {
+        abs = resolved;
+    } else if (!path.empty() && path[0] != '/') {
+        return path;
+    }
+    if (abs.size() <= work_tree_.size() || abs.compare(0, work_tree_.size(), work_tree_) != 0)
+        return "";
+    if (work_tree_ != "/" && abs[work_tree_.size()] != '/')
+        return "";
+    return abs.substr(work_tree_ == "/" ? 1 : work_tree_.size() + 1);
+}
+
+// ---------------------------------------------------------------------------
+// ignore 规则
+// ---------------------------------------------------------------------------
+
+void GitNativeRepository::loadIgnoreFile(const std::string& file, const std::string& base,
+                                         std::vector<IgnoreRule>& rules) const {
+    std::ifstream in(file);
+    if (!in.is_open())
+        return;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        // 去掉未转义的行尾空白
+        while (!line.empty() && line.back() == ' ' &&
+               (line.size() < 2 || line[line.size() - 2] != '\\'))
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        IgnoreRule rule;
+        rule.base = base;
+        if (line[0] == '!') {
+            rule.negate = true;
+            line.erase(0, 1);
+        } else if (line[0] == '\\') {
+            line.erase(0, 1);
+        }
+        if (!line.empty() && line.back() == '/') {
+            rule.dir_only = true;
+            line.pop_back();
+        }
+        if (line.empty())
+            continue;
+        // 含 '/'（末尾除外）的模式相对于 .gitignore 所在目录锚定
+        if (line.find('/') != std::string::npos) {
+            rule.anchored = true;
+            if (line[0] == '/')
+                line.erase(0, 1);
+        }
+        rule.pattern = line;
+        rules.push_back(std::move(rule));
+    }
+}
+
+bool GitNativeRepository::isIgnored(const std::vector<IgnoreRule>& rules,
+                                    const std::string& rel_path, bool is_dir) const {
+    // 后出现的规则优先，逆序找到第一个命中即可
+    for (auto it = rules.rbegin(); it != rules.rend(); ++it) {
+        const IgnoreRule& rule = *it;
+        if (rule.dir_only && !is_dir)
+            continue;
+        if (!rule.base.empty() && rel_path.compare(0, rule.base.size(), rule.base) != 0)
+            continue;
+        std::string sub = rel_path.substr(rule.base.size());
+        bool hit;
+        if (rule.anchored) {
+            hit = globMatch(rule.pattern.c_str(), sub.c_str());
+        } else {
+            size_t slash = sub.rfind('/');
+            const char* name = sub.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+            hit = globMatch(rule.pattern.c_str(), name);
+        }
+        if (hit)
+            return !rule.negate;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// status
+// ---------------------------------------------------------------------------
+
+bool GitNativeRepository::worktreeBlobLocked(const std::string& rel_path, GitOid& oid,
+                                             bool& exists) {
+    std::string abs = work_tree_ + "/" + rel_path;
+    struct stat st;
+    exists = lstat(abs.c_str(), &st) == 0;
+    if (!exists)
+        return false;
+
+    auto cached = hash_cache_.find(rel_path);
+    if (cached != hash_cache_.end() && cached->second.mtime_sec == st.st_mtim.tv_sec &&
+        cached->second.mtime_nsec == st.st_mtim.tv_nsec && cached->second.size == st.st_size &&
+        cached->second.ino == static_cast<uint64_t>(st.st_ino)) {
+        oid = cached->second.oid;
+        return true;
+    }
+
+    std::string content;
+    if (S_ISLNK(st.st_mode)) {
+        char target[PATH_MAX];
+        ssize_t n = readlink(abs.c_str(), target, sizeof(target));
+        if (n < 0)
+            return false;
+        content.assign(target, static_cast<size_t>(n));
+    } else if (!readWholeFile(abs, content)) {
+        return false;
+    }
+    oid = GitSha1::hashObject(GitObjectType::BLOB, content.data(), content.size());
+
+    // 仍在当前秒内被修改的文件可能继续被写入，不缓存（同 racy-git 的保守处理）
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    int64_t now_sec = std::chrono::duration_cast<std::chrono::seconds>(now).count();
+    if (st.st_mtim.tv_sec < now_sec - 1) {
+        HashCacheEntry entry;
+        entry.mtime_sec = st.st_mtim.tv_sec;
+        entry.mtime_nsec = st.st_mtim.tv_nsec;
+        entry.size = st.st_size;
+        entry.ino = static_cast<uint64_t>(st.st_ino);
+        entry.oid = oid;
+        hash_cache_[rel_path] = entry;
+    }
+    return true;
+}
+
+bool GitNativeRepository::isWorktreeModifiedLocked(const GitIndexEntry& entry, bool& deleted) {
+    deleted = false;
+    std::string abs = work_tree_ + "/" + entry.path;
+    struct stat st;
+    if (lstat(abs.c_str(), &st) != 0) {
+        deleted = true;
+        return true;
+    }
+
+    const bool is_link = (entry.mode & 0170000) == 0120000;
+    if (is_link != S_ISLNK(st.st_mode))
+        return true;
+
+    // stat 快速路径：与 git 的 ie_match_stat 一致（mtime / size / inode 使用 index 中的 32 位值）
+    bool stat_match = static_cast<uint32_t>(st.st_mtim.tv_sec) == entry.mtime_sec &&
+                      static_cast<uint32_t>(st.st_mtim.tv_nsec) == entry.mtime_nsec &&
+                      static_cast<uint32_t>(st.st_size) == entry.size &&
+                      static_cast<uint32_t>(st.st_ino) == entry.ino;
+    if (!is_link) {
+        bool exec_index = (entry.mode & 0111) != 0;
+        bool exec_file = (st.st_mode & S_IXUSR) != 0;
+        if (exec_index != exec_file)
+            return true;
+    }
+    if (stat_match && !index_.isRacy(entry))
+        return false;
+    // CRLF 归一化只会缩短内容：工作区文件比 index 记录更小时必然已修改
+    if (!is_link && st.st_size < static_cast<off_t>(entry.size))
+        return true;
+
+    GitOid oid;
+    bool exists = false;
+    if (!worktreeBlobLocked(entry.path, oid, exists)) {
+        deleted = !exists;
+        return true;
+    }
+    if (oid == entry.oid)
+        return false;
+
+    // core.autocrlf 仓库中工作区为 CRLF，index 为 LF
+    if (!is_link) {
+        std::string content;
+        if (readWholeFile(abs, content) && content.find("\r\n") != std::string::npos) {
+            std::string normalized;
+            normalized.reserve(content.size());
+            for (size_t i = 0; i < content.size(); ++i) {
+                if (content[i] == '\r' && i + 1 < content.size() && content[i + 1] == '\n')
+                    continue;
+                normalized.push_back(content[i]);
+            }
+            if (GitSha1::hashObject(GitObjectType::BLOB, normalized.data(), normalized.size()) ==
+                entry.oid)
+                return false;
+        }
+    }
+    return true;
+}
+
+bool GitNativeRepository::computeStatus(std::vector<GitFile>& files, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    files.clear();
+
+    if (!index_.load(git_dir_ + "/index")) {
+        error = "Failed to read git index";
+        return false;
+    }
+
+    static const std::map<std::string, GitOid> empty_tree;
+    const std::map<std::string, GitOid>* head = &empty_tree;
+    GitOid head_tree;
+    if (store_.readHeadTree(head_tree)) {
+        head = &store_.flattenTree(head_tree);
+    }
+
+    std::set<std::string> conflicted;
+    std::unordered_set<std::string> in_index;
+    for (const auto& entry : index_.entries()) {
+        in_index.insert(entry.path);
+        if (entry.stage != 0)
+            conflicted.insert(entry.path);
+    }
+
+    std::vector<GitFile> tracked;
+    for (const auto& entry : index_.entries()) {
+        if (entry.stage != 0) {
+            if (entry.path == (tracked.empty() ? std::string() : tracked.back().path))
+                continue;
+            tracked.emplace_back(entry.path, GitFileStatus::UPDATED_BUT_UNMERGED, true);
+            continue;
+        }
+
+        GitFileStatus staged_status = GitFileStatus::UNMODIFIED;
+        if (!entry.intent_to_add) {
+            auto it = head->find(entry.path);
+            if (it == head->end()) {
+                staged_status = GitFileStatus::ADDED;
+            } else if (it->second != entry.oid) {
+                staged_status = GitFileStatus::MODIFIED;
+            }
+        }
+
+        GitFileStatus worktree_status = GitFileStatus::UNMODIFIED;
+        const bool gitlink = (entry.mode & 0170000) == 0160000;
+        if (entry.intent_to_add) {
+            worktree_status = GitFileStatus::ADDED;
+        } else if (!gitlink && !entry.assume_valid && !entry.skip_worktree) {
+            bool deleted = false;
+            if (isWorktreeModifiedLocked(entry, deleted)) {
+                worktree_status = deleted ? GitFileStatus::DELETED : GitFileStatus::MODIFIED;
+            }
+        }
+
+        if (staged_status != GitFileStatus::UNMODIFIED) {
+            tracked.emplace_back(entry.path, staged_status, true);
+        } else if (worktree_status != GitFileStatus::UNMODIFIED) {
+            tracked.emplace_back(entry.path, worktree_status, false);
+        }
+    }
+
+    for (const auto& [path, oid] : *head) {
+        (void)oid;
+        if (in_index.count(path) == 0 && conflicted.count(path) == 0) {
+            tracked.emplace_back(path, GitFileStatus::DELETED, true);
+        }
+    }
+
+    std::sort(tracked.begin(), tracked.end(),
+              [](const GitFile& a, const GitFile& b) { return a.path < b.path; });
+    files = std::move(tracked);
+    collectUntrackedLocked(files);
+    return true;
+}
+
+void GitNativeRepository::collectUntrackedLocked(std::vector<GitFile>& files) {
+    // 所有包含被跟踪文件的目录；其余目录整体作为 "dir/" 报告
+    std::unordered_set<std::string> tracked_dirs;
+    for (const auto& entry : index_.entries()) {
+        std::string dir = parentDir(entry.path);
+        while (!dir.empty() && tracked_dirs.insert(dir).second) {
+            dir = parentDir(dir);
+        }
+    }
+
+    std::vector<GitFile> untracked;
+    std::vector<IgnoreRule> rules = global_ignores_;
+
+    // 返回目录中是否存在任何未被忽略的文件（用于未跟踪目录，命中即停止）
+    std::function<bool(const std::string&)> hasContent = [&](const std::string& rel_dir) {
+        DIR* d = opendir((work_tree_ + "/" + rel_dir).c_str());
+        if (!d)
+            return false;
+        size_t rules_mark = rules.size();
+        loadIgnoreFile(work_tree_ + "/" + rel_dir + "/.gitignore", rel_dir + "/", rules);
+        bool found = false;
+        std::vector<std::string> subdirs;
+        while (struct dirent* de = readdir(d)) {
+            const char* name = de->d_name;
+            if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0)
+                continue;
+            if (std::strcmp(name, ".git") == 0) {
+                found = true; // 嵌套仓库
+                break;
+            }
+            std::string rel = rel_dir + "/" + name;
+            bool is_dir = de->d_type == DT_DIR;
+            if (de->d_type == DT_UNKNOWN) {
+                struct stat st;
+                is_dir = lstat((work_tree_ + "/" + rel).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+            }
+            if (isIgnored(rules, rel, is_dir))
+                continue;
+            if (!is_dir) {
+                found = true;
+                break;
+            }
+            subdirs.push_back(rel);
+        }
+        closedir(d);
+        for (size_t i = 0; !found && i < subdirs.size(); ++i) {
+            found = hasContent(subdirs[i]);
+        }
+        rules.resize(rules_mark);
+        return found;
+    };
+
+    std::function<void(const std::string&)> walk = [&](const std::string& rel_dir) {
+        std::string abs_dir = rel_dir.empty() ? work_tree_ : work_tree_ + "/" + rel_dir;
+        DIR* d = opendir(abs_dir.c_str());
+        if (!d)
+            return;
+        size_t rules_mark = rules.size();
+        loadIgnoreFile(abs_dir + "/.gitignore", rel_dir.empty() ? "" : rel_dir + "/", rules);
+
+        std::vector<std::pair<std::string, bool>> children;
+        while (struct dirent* de = readdir(d)) {
+            const char* name = de->d_name;
+            if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0 ||
+                std::strcmp(name, ".git") == 0)
+                continue;
+            bool is_dir = de->d_type == DT_DIR;
+            if (de->d_type == DT_UNKNOWN) {
+                struct stat st;
+                is_dir = lstat((abs_dir + "/" + name).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+            }
+            children.emplace_back(rel_dir.empty() ? name : rel_dir + "/" + name, is_dir);
+        }
+        closedir(d);
+        std::sort(children.begin(), children.end());
+
+        for (const auto& [rel, is_dir] : children) {
+            if (index_.find(rel))
+                continue; // 已跟踪文件或 submodule
+            if (isIgnored(rules, rel, is_dir))
+                continue;
+            if (!is_dir) {
+                untracked.emplace_back(rel, GitFileStatus::UNTRACKED, false);
+            } else if (tracked_dirs.count(rel)) {
+                walk(rel);
+            } else if (hasContent(rel)) {
+                untracked.emplace_back(rel + "/", GitFileStatus::UNTRACKED, false);
+            }
+        }
+        rules.resize(rules_mark);
+    };
+
+    walk("");
+    std::sort(untracked.begin(), untracked.end(),
+              [](const GitFile& a, const GitFile& b) { return a.path < b.path; });
+    for (auto& file : untracked) {
+        files.push_back(std::move(file));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// diff
+// ---------------------------------------------------------------------------
+
+bool GitNativeRepository::baseBlob(const std::string& rel_path, GitOid& oid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_.load(git_dir_ + "/index")) {
+        const GitIndexEntry* entry = index_.find(rel_path);
+        if (entry && entry->stage == 0 && !entry->intent_to_add) {
+            oid = entry->oid;
+            return true;
+        }
+        if (entry)
+            return false;
+    }
+    GitOid tree;
+    return store_.readHeadTree(tree) && store_.findInTree(tree, rel_path, oid, nullptr);
+}
+
+void GitNativeRepository::setBlobFallback(GitManager::BlobReader fallback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blob_fallback_ = std::move(fallback);
+}
+
+bool GitNativeRepository::readBlobLines(const GitOid& oid, std::vector<std::string>& lines) {
+    GitObject obj;
+    GitManager::BlobReader fallback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (store_.readObject(oid, obj)) {
+            if (obj.type != GitObjectType::BLOB)
+                return false;
+        } else {
+            fallback = blob_fallback_;
+        }
+    }
+    // 后备读取在锁外进行：git 子进程可能较慢，不阻塞状态计算
+    if (fallback && !fallback(oid.toHex(), obj.data))
+        return false;
+    if (looksBinary(obj.data))
+        return false;
+    lines = GitLineDiff::splitLines(obj.data);
+    return true;
+}
+
+bool GitNativeRepository::readWorktreeLines(const std::string& rel_path,
+                                            std::vector<std::string>& lines, bool& binary) {
+    std::string content;
+    if (!readWholeFile(work_tree_ + "/" + rel_path, content))
+        return false;
+    binary = looksBinary(content);
+    if (!binary)
+        lines = GitLineDiff::splitLines(content);
+    return true;
+}
+
+std::vector<std::string> GitNativeRepository::unifiedDiff(const std::string& rel_path) {
+    GitOid index_oid;
+    GitOid head_oid;
+    bool in_index = false;
+    bool in_head = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        index_.load(git_dir_ + "/index");
+        if (const GitIndexEntry* entry = index_.find(rel_path)) {
+            if (entry->stage == 0 && !entry->intent_to_add) {
+                index_oid = entry->oid;
+                in_index = true;
+            }
+        }
+        GitOid tree;
+        in_head = store_.readHeadTree(tree) && store_.findInTree(tree, rel_path, head_oid, nullptr);
+    }
+
+    auto binaryDiff = [&]() {
+        return std::vector<std::string>{"diff --git a/" + rel_path + " b/" + rel_path,
+                                        "Binary files a/" + rel_path + " and b/" + rel_path +
+                                            " differ"};
+    };
+
+    // 工作区 vs index（未暂存的修改）
+    if (in_index) {
+        std::vector<std::string> base;
+        std::vector<std::string> current;
+        bool binary = false;
+        bool exists = readWorktreeLines(rel_path, current, binary);
+        if (exists && binary)
+            return binaryDiff();
+        if (!readBlobLines(index_oid, base)) {
+            GitObject obj;
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (store_.readObject(index_oid, obj) && looksBinary(obj.data))
+                return binaryDiff();
+        }
+        auto hunks = GitLineDiff::compute(base, current);
+        if (!hunks.empty()) {
+            auto out = GitLineDiff::toUnifiedDiff(rel_path, base, current, hunks);
+            if (!exists && out.size() >= 3)
+                out[2] = "+++ /dev/null";
+            return out;
+        }
+    }
+
+    // index vs HEAD（已暂存的修改）
+    if (in_index || in_head) {
+        std::vector<std::string> base;
+        std::vector<std::string> staged;
+        if (in_head && !readBlobLines(head_oid, base))
+            return in_index && head_oid == index_oid ? std::vector<std::string>{} : binaryDiff();
+        if (in_index && !readBlobLines(index_oid, staged))
+            return binaryDiff();
+        auto hunks = GitLineDiff::compute(base, staged);
+        auto out = GitLineDiff::toUnifiedDiff(rel_path, base, staged, hunks);
+        if (out.size() >= 3) {
+            if (!in_head)
+                out[1] = "--- /dev/null";
+            if (!in_index)
+                out[2] = "+++ /dev/null";
+        }
+        return out;
+    }
+    return {};
+}
+
+} // namespace vgit
+} // namespace pnana
@@ -0,0 +1,744 @@
+#include "features/vgit/git_object_store.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef BUILD_NATIVE_GIT_SUPPORT
+#include <zlib.h>
+#endif
+
+namespace pnana {
+namespace vgit {
+
+// ---------------------------------------------------------------------------
+// GitOid
+// ---------------------------------------------------------------------------
+
+bool GitOid::isNull() const {
+    for (uint8_t b : bytes) {
+        if (b != 0)
+            return false;
+    }
+    return true;
+}
+
+std::string GitOid::toHex() const {
+    static const char* digits = "0123456789abcdef";
+    std::string out(40, '0');
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        out[i * 2] = digits[bytes[i] >> 4];
+        out[i * 2 + 1] = digits[bytes[i] & 0x0f];
+    }
+    return out;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+bool GitOid::fromHex(const std::string& hex, GitOid& out) {
+    if (hex.size() < 40)
+        return false;
+    for (size_t i = 0; i < 20; ++i) {
+        int hi = hexValue(hex[i * 2]);
+        int lo = hexValue(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        out.bytes[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+size_t GitOidHash::operator()(const GitOid& oid) const {
+    // SHA-1 本身分布均匀，直接取前 8 字节
+    size_t h = 0;
+    std::memcpy(&h, oid.bytes.data(), sizeof(h));
+    return h;
+}
+
+// ---------------------------------------------------------------------------
+// GitSha1
+// ---------------------------------------------------------------------------
+
+static inline uint32_t rol32(uint32_t v, int bits) {
+    return (v << bits) | (v >> (32 - bits));
+}
+
+GitSha1::GitSha1() {
+    state_[0] = 0x67452301;
+    state_[1] = 0xEFCDAB89;
+    state_[2] = 0x98BADCFE;
+    state_[3] = 0x10325476;
+    state_[4] = 0xC3D2E1F0;
+}
+
+void GitSha1::processBlock(const uint8_t* block) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) |
+               (static_cast<uint32_t>(block[i * 4 + 1]) << 16) |
+               (static_cast<uint32_t>(block[i * 4 + 2]) << 8) |
+               static_cast<uint32_t>(block[i * 4 + 3]);
+    }
+    for (int i = 16; i < 80; ++i) {
+        w[i] = rol32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3], e = state_[4];
+    for (int i = 0; i < 80; ++i) {
+        uint32_t f, k;
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        uint32_t tmp = rol32(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rol32(b, 30);
+        b = a;
+        a = tmp;
+    }
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+}
+
+void GitSha1::update(const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    total_len_ += len;
+    if (block_len_ > 0) {
+        size_t take = std::min(len, sizeof(block_) - block_len_);
+        std::memcpy(block_ + block_len_, p, take);
+        block_len_ += take;
+        p += take;
+        len -= take;
+        if (block_len_ == sizeof(block_)) {
+            processBlock(block_);
+            block_len_ = 0;
+        }
+    }
+    while (len >= sizeof(block_)) {
+        processBlock(p);
+        p += sizeof(block_);
+        len -= sizeof(block_);
+    }
+    if (len > 0) {
+        std::memcpy(block_, p, len);
+        block_len_ = len;
+    }
+}
+
+GitOid GitSha1::finish() {
+    uint64_t bit_len = total_len_ * 8;
+    uint8_t pad = 0x80;
+    update(&pad, 1);
+    uint8_t zero = 0;
+    while (block_len_ != 56) {
+        update(&zero, 1);
+    }
+    uint8_t len_be[8];
+    for (int i = 0; i < 8; ++i) {
+        len_be[i] = static_cast<uint8_t>(bit_len >> (56 - i * 8));
+    }
+    update(len_be, 8);
+
+    GitOid oid;
+    for (int i = 0; i < 5; ++i) {
+        oid.bytes[i * 4] = static_cast<uint8_t>(state_[i] >> 24);
+        oid.bytes[i * 4 + 1] = static_cast<uint8_t>(state_[i] >> 16);
+        oid.bytes[i * 4 + 2] = static_cast<uint8_t>(state_[i] >> 8);
+        oid.bytes[i * 4 + 3] = static_cast<uint8_t>(state_[i]);
+    }
+    return oid;
+}
+
+static const char* objectTypeName(GitObjectType type) {
+    switch (type) {
+        case GitObjectType::COMMIT:
+            return "commit";
+        case GitObjectType::TREE:
+            return "tree";
+        case GitObjectType::BLOB:
+            return "blob";
+        case GitObjectType::TAG:
+            return "tag";
+        default:
+            return "";
+    }
+}
+
+GitOid GitSha1::hashObject(GitObjectType type, const char* data, size_t len) {
+    GitSha1 sha;
+    std::string header = std::string(objectTypeName(type)) + " " + std::to_string(len);
+    sha.update(header.data(), header.size() + 1); // 包含结尾 '\0'
+    sha.update(data, len);
+    return sha.finish();
+}
+
+// ---------------------------------------------------------------------------
+// 内部辅助
+// ---------------------------------------------------------------------------
+
+struct GitObjectStore::MappedFile {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    bool open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped =
+            mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+            return false;
+        data = static_cast<const uint8_t*>(mapped);
+        size = static_cast<size_t>(st.st_size);
+        return true;
+    }
+
+    ~MappedFile() {
+        if (data) {
+            munmap(const_cast<uint8_t*>(data), size);
+        }
+    }
+};
+
+struct GitObjectStore::PackFile {
+    MappedFile idx;
+    MappedFile pack;
+    uint32_t count = 0;
+    const uint8_t* fanout = nullptr;
+    const uint8_t* oids = nullptr;
+    const uint8_t* offsets32 = nullptr;
+    const uint8_t* offsets64 = nullptr;
+};
+
+static inline uint32_t readBE32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+static inline uint64_t readBE64(const uint8_t* p) {
+    return (static_cast<uint64_t>(readBE32(p)) << 32) | readBE32(p + 4);
+}
+
+#ifdef BUILD_NATIVE_GIT_SUPPORT
+// 解压一段 zlib 流；expected_size 为已知解压后大小（未知时传 0）
+static bool inflateBuffer(const uint8_t* in, size_t in_len, size_t expected_size,
+                          std::string& out) {
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    if (inflateInit(&zs) != Z_OK)
+        return false;
+
+    out.clear();
+    out.resize(expected_size > 0 ? expected_size : 4096);
+    if (out.empty())
+        out.resize(64); // 空对象也需要非零输出缓冲以驱动 inflate
+    zs.next_in = const_cast<Bytef*>(in);
+    zs.avail_in = static_cast<uInt>(std::min<size_t>(in_len, UINT32_MAX));
+    size_t produced = 0;
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END) {
+        if (produced == out.size()) {
+            out.resize(out.size() * 2);
+        }
+        zs.next_out = reinterpret_cast<Bytef*>(&out[produced]);
+        zs.avail_out = static_cast<uInt>(out.size() - produced);
+        ret = inflate(&zs, Z_NO_FLUSH);
+        produced = out.size() - zs.avail_out;
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            // expected_size 精确时，输出缓冲满会返回 Z_BUF_ERROR，需要扩容后继续
+            if (ret == Z_BUF_ERROR && zs.avail_out == 0) {
+                continue;
+            }
+            inflateEnd(&zs);
+            return false;
+        }
+    }
+    inflateEnd(&zs);
+    out.resize(produced);
+    return expected_size == 0 || produced == expected_size;
+}
+#endif
+
+static bool readDeltaSize(const uint8_t*& p, const uint8_t* end, size_t& out) {
+    out = 0;
+    int shift = 0;
+    while (p < end) {
+        uint8_t c = *p++;
+        out |= static_cast<size_t>(c & 0x7f) << shift;
+        shift += 7;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static bool applyDelta(const std::string& base, const std::string& delta, std::string& out) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(delta.data());
+    const uint8_t* end = p + delta.size();
+    size_t src_size = 0;
+    size_t dst_size = 0;
+    if (!readDeltaSize(p, end, src_size) || !readDeltaSize(p, end, dst_size))
+        return false;
+    if (src_size != base.size())
+        return false;
+
+    out.clear();
+    out.reserve(dst_size);
+    while (p < end) {
+        uint8_t op = *p++;
+        if (op & 0x80) {
+            size_t copy_off = 0;
+            size_t copy_len = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (op & (1 << i)) {
+                    if (p >= end)
+                        return false;
+                    copy_off |= static_cast<size_t>(*p++) << (i * 8);
+                }
+            }
+            for (int i = 0; i < 3; ++i) {
+                if (op & (0x10 << i)) {
+                    if (p >= end)
+                        return false;
+                    copy_len |= static_cast<size_t>(*p++) << (i * 8);
+                }
+            }
+            if (copy_len == 0)
+                copy_len = 0x10000;
+            if (copy_off + copy_len > base.size())
+                return false;
+            out.append(base, copy_off, copy_len);
+        } else if (op != 0) {
+            if (p + op > end)
+                return false;
+            out.append(reinterpret_cast<const char*>(p), op);
+            p += op;
+        } else {
+            return false;
+        }
+    }
+    return out.size() == dst_size;
+}
+
+static std::string readSmallFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+        return "";
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static std::string trimRight(std::string s) {
+    while (!s.empty() && (s.back() == '\n' || s.back() == '\r' || s.back() == ' '))
+        s.pop_back();
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// GitObjectStore
+// ---------------------------------------------------------------------------
+
+GitObjectStore::GitObjectStore(const std::string& git_dir) : git_dir_(git_dir) {}
+
+GitObjectStore::~GitObjectStore() = default;
+
+bool GitObjectStore::isSupported() {
+#ifdef BUILD_NATIVE_GIT_SUPPORT
+    return true;
+#else
+    return false;
+#endif
+}
+
+void GitObjectStore::reloadPacks() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    packs_.clear();
+    base_cache_.clear();
+    base_cache_lru_.clear();
+    packs_loaded_ = false;
+}
+
+void GitObjectStore::loadPacksLocked() {
+    if (packs_loaded_)
+        return;
+    packs_loaded_ = true;
+
+    std::string pack_dir = git_dir_ + "/objects/pack";
+    DIR* dir = opendir(pack_dir.c_str());
+    if (!dir)
+        return;
+    while (struct dirent* ent = readdir(dir)) {
+        std::string name = ent->d_name;
+        if (name.size() < 5 || name.compare(name.size() - 4, 4, ".idx") != 0)
+            continue;
+        auto pack = std::make_unique<PackFile>();
+        std::string base = pack_dir + "/" + name.substr(0, name.size() - 4);
+        if (!pack->idx.open(base + ".idx") || !pack->pack.open(base + ".pack"))
+            continue;
+
+        // 仅支持 idx v2：magic \377tOc + version 2
+        const uint8_t* d = pack->idx.data;
+        if (pack->idx.size < 8 + 256 * 4 || d[0] != 0xff || d[1] != 't' || d[2] != 'O' ||
+            d[3] != 'c' || readBE32(d + 4) != 2) {
+            LOG_WARNING("GitObjectStore: unsupported pack index " + base + ".idx");
+            continue;
+        }
+        pack->fanout = d + 8;
+        pack->count = readBE32(pack->fanout + 255 * 4);
+        pack->oids = pack->fanout + 256 * 4;
+        const uint8_t* crcs = pack->oids + static_cast<size_t>(pack->count) * 20;
+        pack->offsets32 = crcs + static_cast<size_t>(pack->count) * 4;
+        pack->offsets64 = pack->offsets32 + static_cast<size_t>(pack->count) * 4;
+        if (pack->offsets64 > d + pack->idx.size)
+            continue;
+        packs_.push_back(std::move(pack));
+    }
+    closedir(dir);
+}
+
+bool GitObjectStore::findInPack(const PackFile& pack, const GitOid& oid, uint64_t& offset) const {
+    uint8_t first = oid.bytes[0];
+    uint32_t lo = first == 0 ? 0 : readBE32(pack.fanout + (first - 1) * 4);
+    uint32_t hi = readBE32(pack.fanout + first * 4);
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp = std::memcmp(pack.oids + static_cast<size_t>(mid) * 20, oid.bytes.data(), 20);
+        if (cmp == 0) {
+            uint32_t off32 = readBE32(pack.offsets32 + static_cast<size_t>(mid) * 4);
+            if (off32 & 0x80000000u) {
+                offset = readBE64(pack.offsets64 + static_cast<size_t>(off32 & 0x7fffffffu) * 8);
+            } else {
+                offset = off32;
+            }
+            return true;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return false;
+}
+
+void GitObjectStore::cacheBaseLocked(const BaseCacheKey& key, const GitObject& obj) {
+    if (base_cache_.count(key))
+        return;
+    // 只缓存较小的对象，避免大 blob 长期驻留内存
+    if (obj.data.size() > 4 * 1024 * 1024)
+        return;
+    while (base_cache_.size() >= BASE_CACHE_MAX && !base_cache_lru_.empty()) {
+        base_cache_.erase(base_cache_lru_.back());
+        base_cache_lru_.pop_back();
+    }
+    base_cache_[key] = obj;
+    base_cache_lru_.push_front(key);
+}
+
+bool GitObjectStore::readPackEntryLocked(PackFile& pack, uint64_t offset, GitObject& out,
+                                         int depth) {
+#ifdef BUILD_NATIVE_GIT_SUPPORT
+    if (depth > 64 || offset >= pack.pack.size)
+        return false;
+
+    BaseCacheKey key{&pack, offset};
+    auto cached = base_cache_.find(key);
+    if (cached != base_cache_.end()) {
+        out = cached->second;
+        return true;
+    }
+
+    const uint8_t* p = pack.pack.data + offset;
+    const uint8_t* end = pack.pack.data + pack.pack.size;
+    uint8_t c = *p++;
+    int type = (c >> 4) & 0x07;
+    size_t size = c & 0x0f;
+    int shift = 4;
+    while ((c & 0x80) && p < end) {
+        c = *p++;
+        size |= static_cast<size_t>(c & 0x7f) << shift;
+        shift += 7;
+    }
+
+    if (type >= 1 && type <= 4) {
+        out.type = static_cast<GitObjectType>(type);
+        return inflateBuffer(p, static_cast<size_t>(end - p), size, out.data);
+    }
+
+    GitObject base;
+    if (type == 6) { // OFS_DELTA
+        if (p >= end)
+            return false;
+        c = *p++;
+        uint64_t rel = c & 0x7f;
+        while ((c & 0x80) && p < end) {
+            c = *p++;
+            rel = ((rel + 1) << 7) | (c & 0x7f);
+        }
+        if (rel > offset)
+            return false;
+        if (!readPackEntryLocked(pack, offset - rel, base, depth + 1))
+            return false;
+        cacheBaseLocked(BaseCacheKey{&pack, offset - rel}, base);
+    } else if (type == 7) { // REF_DELTA
+        if (p + 20 > end)
+            return false;
+        GitOid base_oid;
+        std::memcpy(base_oid.bytes.data(), p, 20);
+        p += 20;
+        // 嵌套查找不能重新扫描 pack：调用链上层仍在遍历 packs_ 并持有当前 pack 的引用
+        if (!readStoredLocked(base_oid, base))
+            return false;
+    } else {
+        return false;
+    }
+
+    std::string delta;
+    if (!inflateBuffer(p, static_cast<size_t>(end - p), size, delta))
+        return false;
+    out.type = base.type;
+    return applyDelta(base.data, delta, out.data);
+#else
+    (void)pack;
+    (void)offset;
+    (void)out;
+    (void)depth;
+    return false;
+#endif
+}
+
+bool GitObjectStore::readLooseLocked(const GitOid& oid, GitObject& out) {
+#ifdef BUILD_NATIVE_GIT_SUPPORT
+    std::string hex = oid.toHex();
+    MappedFile file;
+    if (!file.open(git_dir_ + "/objects/" + hex.substr(0, 2) + "/" + hex.substr(2)))
+        return false;
+
+    std::string raw;
+    if (!inflateBuffer(file.data, file.size, 0, raw))
+        return false;
+
+    size_t nul = raw.find('\0');
+    if (nul == std::string::npos)
+        return false;
+    std::string header = raw.substr(0, nul);
+    if (header.compare(0, 5, "blob ") == 0) {
+        out.type = GitObjectType::BLOB;
+    } else if (header.compare(0, 5, "tree ") == 0) {
+        out.type = GitObjectType::TREE;
+    } else if (header.compare(0, 7, "commit ") == 0) {
+        out.type = GitObjectType::COMMIT;
+    } else if (header.compare(0, 4, "tag ") == 0) {
+        out.type = GitObjectType::TAG;
+    } else {
+        return false;
+    }
+    out.data = raw.substr(nul + 1);
+    return true;
+#else
+    (void)oid;
+    (void)out;
+    return false;
+#endif
+}
+
+bool GitObjectStore::readPackedLocked(const GitOid& oid, GitObject& out) {
+    loadPacksLocked();
+    for (auto& pack : packs_) {
+        uint64_t offset = 0;
+        if (findInPack(*pack, oid, offset)) {
+            return readPackEntryLocked(*pack, offset, out, 0);
+        }
+    }
+    return false;
+}
+
+bool GitObjectStore::readStoredLocked(const GitOid& oid, GitObject& out) {
+    return readLooseLocked(oid, out) || readPackedLocked(oid, out);
+}
+
+bool GitObjectStore::readObjectLocked(const GitOid& oid, GitObject& out) {
+    if (readStoredLocked(oid, out))
+        return true;
+    // 新 pack 可能在上次扫描后才出现（fetch / gc），重新扫描一次。
+    // 只在顶层调用（readObject / findInTree / flattenTree），此时没有 pack 正在被读取
+    packs_.clear();
+    base_cache_.clear();
+    base_cache_lru_.clear();
+    packs_loaded_ = false;
+    return readPackedLocked(oid, out);
+}
+
+bool GitObjectStore::readObject(const GitOid& oid, GitObject& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return readObjectLocked(oid, out);
+}
+
+std::string GitObjectStore::readSymbolicHead() const {
+    std::string head = trimRight(readSmallFile(git_dir_ + "/HEAD"));
+    if (head.compare(0, 5, "ref: ") == 0) {
+        return head.substr(5);
+    }
+    return "";
+}
+
+bool GitObjectStore::resolveRef(const std::string& ref, GitOid& out) {
+    std::string current = ref;
+    for (int depth = 0; depth < 8; ++depth) {
+        std::string content = trimRight(readSmallFile(git_dir_ + "/" + current));
+        if (!content.empty()) {
+            if (content.compare(0, 5, "ref: ") == 0) {
+                current = content.substr(5);
+                continue;
+            }
+            return GitOid::fromHex(content, out);
+        }
+
+        // 回退到 packed-refs
+        std::istringstream packed(readSmallFile(git_dir_ + "/packed-refs"));
+        std::string line;
+        while (std::getline(packed, line)) {
+            if (line.empty() || line[0] == '#' || line[0] == '^')
+                continue;
+            if (line.size() > 41 && trimRight(line.substr(41)) == current) {
+                return GitOid::fromHex(line.substr(0, 40), out);
+            }
+        }
+        return false;
+    }
+    return false;
+}
+
+bool GitObjectStore::readHeadTree(GitOid& tree_out) {
+    GitOid commit_oid;
+    if (!resolveRef("HEAD", commit_oid))
+        return false;
+    GitObject commit;
+    if (!readObject(commit_oid, commit) || commit.type != GitObjectType::COMMIT)
+        return false;
+    if (commit.data.compare(0, 5, "tree ") != 0)
+        return false;
+    return GitOid::fromHex(commit.data.substr(5, 40), tree_out);
+}
+
+// 遍历 tree 对象条目：<mode> <name>\0<20 字节 oid>
+template <typename Fn>
+static void forEachTreeEntry(const std::string& data, Fn&& fn) {
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t space = data.find(' ', pos);
+        if (space == std::string::npos)
+            break;
+        size_t nul = data.find('\0', space + 1);
+        if (nul == std::string::npos || nul + 21 > data.size())
+            break;
+        uint32_t mode = static_cast<uint32_t>(std::strtoul(data.c_str() + pos, nullptr, 8));
+        std::string name = data.substr(space + 1, nul - space - 1);
+        GitOid oid;
+        std::memcpy(oid.bytes.data(), data.data() + nul + 1, 20);
+        if (!fn(mode, name, oid))
+            break;
+        pos = nul + 21;
+    }
+}
+
+bool GitObjectStore::findInTree(const GitOid& tree, const std::string& path, GitOid& out,
+                                uint32_t* mode_out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    GitOid current = tree;
+    size_t start = 0;
+    while (true) {
+        size_t slash = path.find('/', start);
+        std::string component = path.substr(start, slash == std::string::npos ? std::string::npos
+                                                                               : slash - start);
+        GitObject obj;
+        if (!readObjectLocked(current, obj) || obj.type != GitObjectType::TREE)
+            return false;
+
+        bool found = false;
+        uint32_t found_mode = 0;
+        forEachTreeEntry(obj.data, [&](uint32_t mode, const std::string& name, const GitOid& oid) {
+            if (name == component) {
+                current = oid;
+                found_mode = mode;
+                found = true;
+                return false;
+            }
+            return true;
+        });
+        if (!found)
+            return false;
+        if (slash == std::string::npos) {
+            out = current;
+            if (mode_out)
+                *mode_out = found_mode;
+            return true;
+        }
+        start = slash + 1;
+    }
+}
+
+void GitObjectStore::flattenTreeLocked(const GitOid& tree, const std::string& prefix,
+                                       std::map<std::string, GitOid>& out, int depth) {
+    if (depth > 256)
+        return;
+    GitObject obj;
+    if (!readObjectLocked(tree, obj) || obj.type != GitObjectType::TREE)
+        return;
+    forEachTreeEntry(obj.data, [&](uint32_t mode, const std::string& name, const GitOid& oid) {
+        std::string path = prefix.empty() ? name : prefix + "/" + name;
+        if ((mode & 0170000) == 0040000) {
+            flattenTreeLocked(oid, path, out, depth + 1);
+        } else if ((mode & 0170000) != 0160000) { // 跳过子模块（gitlink）
+            out[path] = oid;
+        }
+        return true;
+    });
+}
+
+const std::map<std::string, GitOid>& GitObjectStore::flattenTree(const GitOid& tree) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tree != flattened_tree_oid_ || flattened_tree_.empty()) {
+        flattened_tree_.clear();
+        flattenTreeLocked(tree, "", flattened_tree_, 0);
+        flattened_tree_oid_ = tree;
+    }
+    return flattened_tree_;
+}
+
+} // namespace vgit
+} // namespace pnana
@@ -0,0 +1,166 @@
+#include "features/vgit/git_process.h"
+#include "utils/logger.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace pnana {
+namespace vgit {
+
+GitPipeProcess::~GitPipeProcess() {
+    terminate();
+}
+
+bool GitPipeProcess::start(const std::vector<std::string>& argv, bool with_stdin) {
+    terminate();
+    if (argv.empty())
+        return false;
+
+    int out_pipe[2] = {-1, -1};
+    int in_pipe[2] = {-1, -1};
+    if (pipe2(out_pipe, O_CLOEXEC) != 0)
+        return false;
+    if (with_stdin && pipe2(in_pipe, O_CLOEXEC) != 0) {
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, out_pipe[1], STDOUT_FILENO);
+    if (with_stdin) {
+        posix_spawn_file_actions_adddup2(&actions, in_pipe[0], STDIN_FILENO);
+    } else {
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    }
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    std::vector<char*> args;
+    args.reserve(argv.size() + 1);
+    for (const auto& arg : argv) {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    pid_t pid = -1;
+    int rc = posix_spawnp(&pid, args[0], &actions, nullptr, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    close(out_pipe[1]);
+    if (with_stdin)
+        close(in_pipe[0]);
+    if (rc != 0) {
+        close(out_pipe[0]);
+        if (with_stdin)
+            close(in_pipe[1]);
+        LOG_WARNING("GitPipeProcess: failed to spawn " + argv[0] + ": " + std::strerror(rc));
+        return false;
+    }
+
+    pid_ = pid;
+    stdout_fd_ = out_pipe[0];
+    stdin_fd_ = with_stdin ? in_pipe[1] : -1;
+    buffer_.clear();
+    buffer_pos_ = 0;
+    eof_ = false;
+    return true;
+}
+
+bool GitPipeProcess::fill() {
+    if (eof_ || stdout_fd_ < 0)
+        return false;
+    if (buffer_pos_ > 0) {
+        buffer_.erase(0, buffer_pos_);
+        buffer_pos_ = 0;
+    }
+    char chunk[65536];
+    while (true) {
+        ssize_t n = read(stdout_fd_, chunk, sizeof(chunk));
+        if (n > 0) {
+            buffer_.append(chunk, static_cast<size_t>(n));
+            return true;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        eof_ = true;
+        return false;
+    }
+}
+
+bool GitPipeProcess::readLine(std::string& line) {
+    while (true) {
+        size_t nl = buffer_.find('\n', buffer_pos_);
+        if (nl != std::string::npos) {
+            line.assign(buffer_, buffer_pos_, nl - buffer_pos_);
+            buffer_pos_ = nl + 1;
+            return true;
+        }
+        if (!fill()) {
+            if (buffer_pos_ < buffer_.size()) {
+                line.assign(buffer_, buffer_pos_, std::string::npos);
+                buffer_pos_ = buffer_.size();
+                return true;
+            }
+            return false;
+        }
+    }
+}
+
+bool GitPipeProcess::readExact(size_t n, std::string& out) {
+    while (buffer_.size() - buffer_pos_ < n) {
+        if (!fill())
+            return false;
+    }
+    out.assign(buffer_, buffer_pos_, n);
+    buffer_pos_ += n;
+    return true;
+}
+
+bool GitPipeProcess::writeAll(const std::string& data) {
+    if (stdin_fd_ < 0)
+        return false;
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = write(stdin_fd_, data.data() + written, data.size() - written);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void GitPipeProcess::terminate() {
+    if (stdin_fd_ >= 0) {
+        close(stdin_fd_);
+        stdin_fd_ = -1;
+    }
+    if (stdout_fd_ >= 0) {
+        close(stdout_fd_);
+        stdout_fd_ = -1;
+    }
+    if (pid_ > 0) {
+        // 先看是否已自然退出，避免对已结束的进程发信号
+        int status = 0;
+        if (waitpid(pid_, &status, WNOHANG) == 0) {
+            kill(pid_, SIGTERM);
+            waitpid(pid_, &status, 0);
+        }
+        pid_ = -1;
+    }
+    buffer_.clear();
+    buffer_pos_ = 0;
+    eof_ = true;
+}
+
+} // namespace vgit
+} // namespace pnana
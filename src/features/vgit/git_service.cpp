@@ -0,0 +1,251 @@
+#include "features/vgit/git_service.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <csignal>
+#include <pthread.h>
+
+namespace pnana {
+namespace vgit {
+
+GitService::GitService(GitManager& manager) : manager_(manager) {
+    manager_.setBlobFallback([this](const std::string& spec, std::string& data) {
+        return readBlobBatch(spec, data);
+    });
+    worker_ = std::thread([this]() {
+        workerLoop();
+    });
+}
+
+GitService::~GitService() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    queue_cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    manager_.setBlobFallback(nullptr);
+    log_stream_.terminate();
+    cat_file_.terminate();
+}
+
+void GitService::post(const std::string& coalesce_key, Task task) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (stopping_)
+            return;
+        if (!coalesce_key.empty()) {
+            auto it = std::find_if(queue_.begin(), queue_.end(), [&](const Request& r) {
+                return r.key == coalesce_key;
+            });
+            if (it != queue_.end()) {
+                it->task = std::move(task);
+                return;
+            }
+        }
+        queue_.push_back({coalesce_key, std::move(task)});
+    }
+    queue_cv_.notify_one();
+}
+
+size_t GitService::pendingCount() {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return queue_.size();
+}
+
+void GitService::runExclusive(const std::function<void(GitManager&)>& fn) {
+    std::lock_guard<std::mutex> lock(exec_mutex_);
+    fn(manager_);
+}
+
+void GitService::workerLoop() {
+    // 长驻子进程退出后写管道会产生 SIGPIPE；只在本线程屏蔽，write 返回 EPIPE 即可
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this]() {
+                return stopping_ || !queue_.empty();
+            });
+            if (stopping_)
+                return;
+            request = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        busy_ = true;
+        try {
+            std::lock_guard<std::mutex> lock(exec_mutex_);
+            request.task(manager_);
+        } catch (const std::exception& e) {
+            LOG_ERROR("GitService: request '" + request.key + "' failed: " + e.what());
+        } catch (...) {
+            LOG_ERROR("GitService: request '" + request.key + "' failed");
+        }
+        busy_ = false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 图视图：长驻 git log 流
+// ---------------------------------------------------------------------------
+
+void GitService::resetGraph() {
+    ++graph_generation_;
+    // 尽早结束旧的 git log 进程；若新一页请求已先执行（合并后位置靠前），这里是 no-op
+    post("graph_reset", [this](GitManager&) {
+        syncGraphGeneration();
+    });
+}
+
+void GitService::syncGraphGeneration() {
+    uint64_t generation = graph_generation_.load();
+    if (log_stream_generation_ == generation)
+        return;
+    log_stream_.terminate();
+    log_stream_started_ = false;
+    log_stream_eof_ = false;
+    log_commits_read_ = 0;
+    log_stream_generation_ = generation;
+}
+
+void GitService::resetRepository() {
+    resetGraph();
+    post("blob_reset", [this](GitManager&) {
+        std::lock_guard<std::mutex> lock(cat_file_mutex_);
+        cat_file_.terminate();
+    });
+}
+
+void GitService::requestGraphPage(size_t count, GraphPageCallback callback) {
+    uint64_t generation = graph_generation_.load();
+    post("graph_page", [this, count, generation, callback](GitManager&) {
+        // 请求之后又发生了 reset：结果属于旧的列表，直接丢弃
+        if (generation != graph_generation_.load())
+            return;
+        std::vector<GitCommit> commits;
+        bool eof = !readGraphPage(count, commits);
+        if (callback)
+            callback(std::move(commits), eof);
+    });
+}
+
+bool GitService::readGraphPage(size_t count, std::vector<GitCommit>& commits) {
+    syncGraphGeneration();
+    if (log_stream_eof_)
+        return false;
+
+    if (!manager_.isGitRepository()) {
+        log_stream_eof_ = true;
+        return false;
+    }
+
+    // 远程仓库无法保持长连接流，退回按页 --skip
+    if (manager_.isRemote()) {
+        commits = manager_.getGraphCommits(static_cast<int>(count),
+                                           static_cast<int>(log_commits_read_));
+        log_commits_read_ += commits.size();
+        log_stream_eof_ = commits.size() < count;
+        return !log_stream_eof_;
+    }
+
+    if (!log_stream_started_) {
+        log_stream_started_ = true;
+        std::vector<std::string> argv = {"git",
+                                         "-C",
+                                         manager_.getRepositoryRoot(),
+                                         "log",
+                                         "--graph",
+                                         "--all",
+                                         "--no-color",
+                                         "--pretty=format:%x1f%H|%P|%s|%an|%ad",
+                                         "--date=short"};
+        if (!log_stream_.start(argv, false)) {
+            log_stream_eof_ = true;
+            return false;
+        }
+    }
+
+    std::string line;
+    while (commits.size() < count) {
+        if (!log_stream_.readLine(line)) {
+            log_stream_eof_ = true;
+            log_stream_.terminate();
+            break;
+        }
+        GitCommit commit;
+        if (GitManager::parseGraphLine(line, commit)) {
+            commits.push_back(std::move(commit));
+        }
+    }
+    log_commits_read_ += commits.size();
+    return !log_stream_eof_;
+}
+
+// ---------------------------------------------------------------------------
+// blob：长驻 git cat-file --batch
+// ---------------------------------------------------------------------------
+
+void GitService::readBlob(const std::string& spec, BlobCallback callback) {
+    post("", [this, spec, callback](GitManager& manager) {
+        std::string data;
+        bool ok = manager.isRemote() ? manager.readBlob(spec, data) : readBlobBatch(spec, data);
+        if (callback)
+            callback(ok, std::move(data));
+    });
+}
+
+bool GitService::readBlobBatch(const std::string& spec, std::string& data) {
+    if (spec.find('\n') != std::string::npos)
+        return false;
+
+    std::lock_guard<std::mutex> lock(cat_file_mutex_);
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!cat_file_.running()) {
+            std::string root = manager_.getRepositoryRoot();
+            if (root.empty() ||
+                !cat_file_.start({"git", "-C", root, "cat-file", "--batch"}, true)) {
+                return false;
+            }
+        }
+
+        // 协议：写入 "<spec>\n"，返回 "<oid> <type> <size>\n<content>\n" 或 "<spec> missing\n"
+        std::string header;
+        if (!cat_file_.writeAll(spec + "\n") || !cat_file_.readLine(header)) {
+            cat_file_.terminate(); // 进程已退出，重启后再试一次
+            continue;
+        }
+
+        size_t last_space = header.rfind(' ');
+        size_t type_space =
+            last_space == std::string::npos ? std::string::npos : header.rfind(' ', last_space - 1);
+        if (type_space == std::string::npos)
+            return false; // missing / ambiguous
+        std::string type = header.substr(type_space + 1, last_space - type_space - 1);
+        size_t size = 0;
+        try {
+            size = static_cast<size_t>(std::stoull(header.substr(last_space + 1)));
+        } catch (...) {
+            cat_file_.terminate();
+            return false;
+        }
+
+        std::string trailing;
+        if (!cat_file_.readExact(size, data) || !cat_file_.readExact(1, trailing)) {
+            cat_file_.terminate();
+            return false;
+        }
+        return type == "blob";
+    }
+    return false;
+}
+
+} // namespace vgit
+} // namespace pnana
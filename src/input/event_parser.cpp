@@ -1,10 +1,54 @@
 #include "input/event_parser.h"
 #include <algorithm>
 #include <cctype>
+#include <unordered_map>
 
 namespace pnana {
 namespace input {
 
+namespace {
+
+struct ParsedKey {
+    std::string key;
+    KeyChord chord = chord::NONE;
+};
+
+// 解析结果只取决于事件类型与输入字节，按输入缓存。EventParser 在各处按需临时构造，
+// 缓存放在实例里几乎总是冷的，所以按线程共享
+struct KeyCache {
+    std::unordered_map<std::string, ParsedKey> characters;
+    std::unordered_map<std::string, ParsedKey> specials;
+};
+
+constexpr size_t KEY_CACHE_LIMIT = 512;    // 超过后清空重建（多为不同的输入字符）
+constexpr size_t KEY_CACHE_MAX_INPUT = 16; // 更长的输入（鼠标报告、粘贴片段）不缓存
+
+thread_local KeyCache key_cache;
+
+const ParsedKey& lookupKey(const EventParser& parser, const ftxui::Event& event,
+                           ParsedKey& scratch) {
+    const std::string& input = event.input();
+    if (event.is_mouse() || input.size() > KEY_CACHE_MAX_INPUT) {
+        scratch.key = parser.parseKey(event);
+        scratch.chord = keyToChord(scratch.key);
+        return scratch;
+    }
+    auto& cache = event.is_character() ? key_cache.characters : key_cache.specials;
+    auto it = cache.find(input);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    if (cache.size() >= KEY_CACHE_LIMIT) {
+        cache.clear();
+    }
+    ParsedKey parsed;
+    parsed.key = parser.parseKey(event);
+    parsed.chord = keyToChord(parsed.key);
+    return cache.emplace(input, std::move(parsed)).first->second;
+}
+
+} // namespace
+
 Modifiers EventParser::parseModifiers(const ftxui::Event& event) const {
     Modifiers mods;
     std::string input = event.input();
@@ -405,6 +449,16 @@ std::string EventParser::parseSpaceKey(const ftxui::Event& event) const {
 }
 
 std::string EventParser::eventToKey(const ftxui::Event& event) const {
+    ParsedKey scratch;
+    return lookupKey(*this, event, scratch).key;
+}
+
+KeyChord EventParser::eventToChord(const ftxui::Event& event) const {
+    ParsedKey scratch;
+    return lookupKey(*this, event, scratch).chord;
+}
+
+std::string EventParser::parseKey(const ftxui::Event& event) const {
     // 按优先级顺序解析
 
     // 0. 特殊键（Tab、Shift+Tab等）优先处理，避免被 Ctrl 组合键误识别
@@ -0,0 +1,213 @@
+#include "input/event_recorder.h"
+#include <sstream>
+
+namespace pnana {
+namespace input {
+
+namespace {
+
+std::string toHex(const std::string& bytes) {
+    static const char* digits = "0123456789abcdef";
+    std::string out;
+    out.reserve(bytes.size() * 2);
+    for (unsigned char c : bytes) {
+        out.push_back(digits[c >> 4]);
+        out.push_back(digits[c & 0x0f]);
+    }
+    return out;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+bool fromHex(const std::string& hex, std::string& out) {
+    if (hex == "-") {
+        out.clear();
+        return true;
+    }
+    if (hex.size() % 2 != 0)
+        return false;
+    out.clear();
+    out.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int hi = hexValue(hex[i]);
+        int lo = hexValue(hex[i + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        out.push_back(static_cast<char>((hi << 4) | lo));
+    }
+    return true;
+}
+
+// 空字段写成 "-"，保证按制表符切分后列数固定
+std::string hexField(const std::string& bytes) {
+    return bytes.empty() ? "-" : toHex(bytes);
+}
+
+} // namespace
+
+EventRecorder::~EventRecorder() {
+    stop();
+}
+
+bool EventRecorder::start(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_.is_open()) {
+        out_.close();
+    }
+    out_.open(path, std::ios::out | std::ios::trunc);
+    if (!out_) {
+        recording_.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    start_ = std::chrono::steady_clock::now();
+    out_ << "# pnana event log v1\n";
+    recording_.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void EventRecorder::stop() {
+    recording_.store(false, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_.is_open()) {
+        out_.flush();
+        out_.close();
+    }
+}
+
+int64_t EventRecorder::elapsedMicros() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                 start_)
+        .count();
+}
+
+void EventRecorder::recordOpen(const std::string& filepath) {
+    if (!isRecording()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    out_ << elapsedMicros() << "\to\t" << hexField(filepath) << "\n";
+}
+
+void EventRecorder::record(const ftxui::Event& event) {
+    if (!isRecording() || event == ftxui::Event::Custom) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 逐行刷新：编辑器崩溃时日志仍然完整，便于复现
+    out_ << formatEvent(event, elapsedMicros()) << std::endl;
+}
+
+std::string EventRecorder::formatEvent(const ftxui::Event& event, int64_t elapsed_us) {
+    std::ostringstream line;
+    line << elapsed_us << '\t';
+    if (event.is_mouse()) {
+        ftxui::Event copy = event;
+        const ftxui::Mouse& mouse = copy.mouse();
+        int mods = (mouse.shift ? 1 : 0) | (mouse.meta ? 2 : 0) | (mouse.control ? 4 : 0);
+        line << "m\t" << hexField(event.input()) << '\t' << static_cast<int>(mouse.button) << '\t'
+             << static_cast<int>(mouse.motion) << '\t' << mods << '\t' << mouse.x << '\t'
+             << mouse.y;
+    } else if (event.is_character()) {
+        line << "c\t" << hexField(event.character());
+    } else {
+        line << "s\t" << hexField(event.input());
+    }
+    return line.str();
+}
+
+bool EventRecorder::parseLine(const std::string& line, RecordedEvent& out) {
+    if (line.empty() || line[0] == '#') {
+        return false;
+    }
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, '\t')) {
+        fields.push_back(field);
+    }
+    if (fields.size() < 3 || fields[1].size() != 1) {
+        return false;
+    }
+
+    try {
+        out.elapsed_us = std::stoll(fields[0]);
+    } catch (...) {
+        return false;
+    }
+
+    std::string bytes;
+    if (!fromHex(fields[2], bytes)) {
+        return false;
+    }
+
+    switch (fields[1][0]) {
+        case 'o':
+            out.kind = RecordedEvent::Kind::OPEN;
+            out.path = bytes;
+            return true;
+        case 'c':
+            out.kind = RecordedEvent::Kind::EVENT;
+            out.event = ftxui::Event::Character(bytes);
+            return true;
+        case 's':
+            out.kind = RecordedEvent::Kind::EVENT;
+            out.event = ftxui::Event::Special(bytes);
+            return true;
+        case 'm': {
+            if (fields.size() < 8) {
+                return false;
+            }
+            ftxui::Mouse mouse;
+            try {
+                mouse.button = static_cast<ftxui::Mouse::Button>(std::stoi(fields[3]));
+                mouse.motion = static_cast<ftxui::Mouse::Motion>(std::stoi(fields[4]));
+                int mods = std::stoi(fields[5]);
+                mouse.shift = (mods & 1) != 0;
+                mouse.meta = (mods & 2) != 0;
+                mouse.control = (mods & 4) != 0;
+                mouse.x = std::stoi(fields[6]);
+                mouse.y = std::stoi(fields[7]);
+            } catch (...) {
+                return false;
+            }
+            out.kind = RecordedEvent::Kind::EVENT;
+            out.event = ftxui::Event::Mouse(bytes, mouse);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool EventRecorder::load(const std::string& path, std::vector<RecordedEvent>& out,
+                         std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        RecordedEvent record;
+        if (parseLine(line, record)) {
+            out.push_back(std::move(record));
+        } else if (!line.empty() && line[0] != '#') {
+            error = path + ":" + std::to_string(line_no) + ": malformed record";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace input
+} // namespace pnana
@@ -114,22 +114,34 @@ void KeyBindingManager::initializeTabOperationBindings() {
 }
 
 KeyAction KeyBindingManager::getAction(const ftxui::Event& event) const {
-    std::string key = parser_.eventToKey(event);
+    return getAction(parser_.eventToChord(event));
+}
 
-    if (key.empty()) {
-        return KeyAction::UNKNOWN;
+KeyAction KeyBindingManager::getAction(KeyChord chord) const {
+    const KeyAction* action = action_table_.find(chord);
+    if (action) {
+        return *action;
     }
+    return KeyAction::UNKNOWN;
+}
 
-    auto it = key_to_action_.find(key);
-    if (it != key_to_action_.end()) {
-        return it->second;
+void KeyBindingManager::compileKey(const std::string& key, KeyAction action) {
+    KeyChord chord = keyToChord(key);
+    if (chord != chord::NONE && chordToKey(chord) == key) {
+        action_table_.assign(chord, action);
     }
+}
 
-    return KeyAction::UNKNOWN;
+void KeyBindingManager::compileActionTable() {
+    action_table_.clear();
+    for (const auto& binding : key_to_action_) {
+        compileKey(binding.first, binding.second);
+    }
 }
 
 void KeyBindingManager::bindKey(const std::string& key, KeyAction action) {
     key_to_action_[key] = action;
+    compileKey(key, action);
 
     // ??????
     auto& keys = action_to_keys_[action];
@@ -149,6 +161,7 @@ void KeyBindingManager::unbindKey(const std::string& key) {
     if (it != key_to_action_.end()) {
         KeyAction action = it->second;
         key_to_action_.erase(it);
+        compileActionTable();
 
         // ????????
         auto& keys = action_to_keys_[action];
@@ -180,8 +193,51 @@ bool KeyBindingManager::isGlobalKey(const ftxui::Event& event) const {
 void KeyBindingManager::resetToDefaults() {
     key_to_action_.clear();
     action_to_keys_.clear();
+    action_table_.clear();
     initializeDefaultBindings();
 }
 
+bool KeyBindingManager::bindPluginKeymap(const std::string& mode, const std::string& lhs) {
+    KeyChord chord = vimKeyToChord(lhs);
+    if (chord == chord::NONE) {
+        return false;
+    }
+    plugin_keymaps_[mode][lhs] = chord;
+    compilePluginTable(mode);
+    return true;
+}
+
+void KeyBindingManager::unbindPluginKeymap(const std::string& mode, const std::string& lhs) {
+    auto mode_it = plugin_keymaps_.find(mode);
+    if (mode_it == plugin_keymaps_.end() || mode_it->second.erase(lhs) == 0) {
+        return;
+    }
+    compilePluginTable(mode);
+}
+
+const std::string* KeyBindingManager::findPluginKeymap(const std::string& mode,
+                                                       KeyChord chord) const {
+    auto it = plugin_tables_.find(mode);
+    if (it == plugin_tables_.end()) {
+        return nullptr;
+    }
+    return it->second.find(chord);
+}
+
+void KeyBindingManager::compilePluginTable(const std::string& mode) {
+    auto mode_it = plugin_keymaps_.find(mode);
+    if (mode_it == plugin_keymaps_.end() || mode_it->second.empty()) {
+        plugin_keymaps_.erase(mode);
+        plugin_tables_.erase(mode);
+        return;
+    }
+    // 同一组合有多个写法（"<M-g>" 与 "<A-g>"）时，按 lhs 顺序后者覆盖前者
+    ChordTable<std::string>& table = plugin_tables_[mode];
+    table.clear();
+    for (const auto& keymap : mode_it->second) {
+        table.assign(keymap.second, keymap.first);
+    }
+}
+
 } // namespace input
 } // namespace pnana
@@ -0,0 +1,247 @@
+#include "input/key_chord.h"
+#include <cctype>
+
+namespace pnana {
+namespace input {
+
+namespace {
+
+struct NamedKey {
+    const char* name;
+    KeyChord key;
+};
+
+// 键字符串中的键名；同一个键的多个名字里，第一个是 chordToKey 输出的规范名
+const NamedKey NAMED_KEYS[] = {
+    {"home", chord::KEY_HOME},
+    {"end", chord::KEY_END},
+    {"pageup", chord::KEY_PAGE_UP},
+    {"pagedown", chord::KEY_PAGE_DOWN},
+    {"arrow_up", chord::KEY_UP},
+    {"arrow_down", chord::KEY_DOWN},
+    {"arrow_left", chord::KEY_LEFT},
+    {"arrow_right", chord::KEY_RIGHT},
+    {"up", chord::KEY_UP},
+    {"down", chord::KEY_DOWN},
+    {"left", chord::KEY_LEFT},
+    {"right", chord::KEY_RIGHT},
+    {"escape", chord::KEY_ESCAPE},
+    {"return", chord::KEY_RETURN},
+    {"backspace", chord::KEY_BACKSPACE},
+    {"delete", chord::KEY_DELETE},
+    {"tab", chord::KEY_TAB},
+    {"space", ' '},
+    {"slash", '/'},
+    {"backslash", '\\'},
+    {"minus", '-'},
+    {"plus", '+'},
+    {"quote", '\''},
+};
+
+// Vim 记法的键名（不区分大小写）
+const NamedKey VIM_KEYS[] = {
+    {"home", chord::KEY_HOME},
+    {"end", chord::KEY_END},
+    {"pageup", chord::KEY_PAGE_UP},
+    {"pagedown", chord::KEY_PAGE_DOWN},
+    {"up", chord::KEY_UP},
+    {"down", chord::KEY_DOWN},
+    {"left", chord::KEY_LEFT},
+    {"right", chord::KEY_RIGHT},
+    {"esc", chord::KEY_ESCAPE},
+    {"cr", chord::KEY_RETURN},
+    {"enter", chord::KEY_RETURN},
+    {"return", chord::KEY_RETURN},
+    {"bs", chord::KEY_BACKSPACE},
+    {"del", chord::KEY_DELETE},
+    {"tab", chord::KEY_TAB},
+    {"space", ' '},
+    {"lt", '<'},
+    {"bslash", '\\'},
+};
+
+// "f1".."f12"（不区分大小写）
+KeyChord functionKey(const std::string& name) {
+    if (name.size() < 2 || name.size() > 3 || std::tolower(name[0]) != 'f') {
+        return chord::NONE;
+    }
+    int number = 0;
+    for (size_t i = 1; i < name.size(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(name[i]))) {
+            return chord::NONE;
+        }
+        number = number * 10 + (name[i] - '0');
+    }
+    if (number < 1 || number > 12) {
+        return chord::NONE;
+    }
+    return chord::KEY_F1 + static_cast<KeyChord>(number - 1);
+}
+
+std::string toLower(std::string text) {
+    for (char& c : text) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return text;
+}
+
+// 单个可打印 ASCII 字符；字母统一为小写（终端里 Ctrl/Alt 组合不区分大小写）
+KeyChord printableKey(const std::string& name) {
+    if (name.size() != 1) {
+        return chord::NONE;
+    }
+    unsigned char c = static_cast<unsigned char>(name[0]);
+    if (c < 32 || c >= 127) {
+        return chord::NONE;
+    }
+    return static_cast<KeyChord>(std::tolower(c));
+}
+
+} // namespace
+
+KeyChord keyToChord(const std::string& key) {
+    static const struct {
+        const char* prefix;
+        size_t length;
+        KeyChord bit;
+    } MODIFIER_PREFIXES[] = {
+        {"space_", 6, chord::SPACE}, {"ctrl_", 5, chord::CTRL},  {"alt_", 4, chord::ALT},
+        {"shift_", 6, chord::SHIFT}, {"meta_", 5, chord::META},
+    };
+
+    KeyChord modifiers = 0;
+    size_t pos = 0;
+    bool stripped = true;
+    while (stripped) {
+        stripped = false;
+        for (const auto& modifier : MODIFIER_PREFIXES) {
+            // 前缀之后必须还有键名："space"、"alt__" 中的 "space"/"_" 是键本身
+            if (key.size() > pos + modifier.length &&
+                key.compare(pos, modifier.length, modifier.prefix) == 0) {
+                modifiers |= modifier.bit;
+                pos += modifier.length;
+                stripped = true;
+                break;
+            }
+        }
+    }
+
+    std::string name = key.substr(pos);
+    KeyChord code = functionKey(name);
+    if (code == chord::NONE) {
+        for (const auto& named : NAMED_KEYS) {
+            if (name == named.name) {
+                code = named.key;
+                break;
+            }
+        }
+    }
+    if (code == chord::NONE) {
+        code = printableKey(name);
+    }
+    if (code == chord::NONE) {
+        return chord::NONE;
+    }
+    return modifiers | code;
+}
+
+std::string chordToKey(KeyChord value) {
+    if (value == chord::NONE) {
+        return "";
+    }
+    KeyChord modifiers = value & ~chord::KEY_MASK;
+    KeyChord code = value & chord::KEY_MASK;
+
+    std::string key;
+    if (modifiers & chord::SPACE) {
+        key += "space_";
+    }
+    if (modifiers & chord::CTRL) {
+        key += "ctrl_";
+    }
+    if (modifiers & chord::ALT) {
+        key += "alt_";
+    }
+    if (modifiers & chord::SHIFT) {
+        key += "shift_";
+    }
+    if (modifiers & chord::META) {
+        key += "meta_";
+    }
+
+    if (code >= chord::KEY_F1 && code <= chord::KEY_F12) {
+        return key + "f" + std::to_string(code - chord::KEY_F1 + 1);
+    }
+    if (code >= chord::KEY_UP && code <= chord::KEY_RIGHT && modifiers == chord::CTRL) {
+        // 单独的 Ctrl+方向键沿用 "ctrl_up" 的写法
+        static const char* const SHORT_ARROWS[] = {"up", "down", "left", "right"};
+        return key + SHORT_ARROWS[code - chord::KEY_UP];
+    }
+    bool ctrl_only_name = (code == '/' || code == '\\' || code == '-' || code == '+' ||
+                           code == '\'');
+    // 标点只在 Ctrl 组合里用名字（"ctrl_slash"），Alt 组合保留字符本身（"alt_-"）
+    if (code == ' ' || code > 0x7F || (ctrl_only_name && (modifiers & chord::CTRL))) {
+        for (const auto& named : NAMED_KEYS) {
+            if (named.key == code) {
+                return key + named.name;
+            }
+        }
+        return "";
+    }
+    return key + static_cast<char>(code);
+}
+
+KeyChord vimKeyToChord(const std::string& lhs) {
+    if (lhs.size() < 3 || lhs.front() != '<' || lhs.back() != '>') {
+        return chord::NONE;
+    }
+    std::string inner = lhs.substr(1, lhs.size() - 2);
+    if (inner.find('<') != std::string::npos) {
+        return chord::NONE; // 多键序列，如 "<leader>f"、"<C-w><C-v>"
+    }
+
+    KeyChord modifiers = 0;
+    size_t pos = 0;
+    // "X-" 形式的修饰键；"<C-->" 中最后的 "-" 是键本身
+    while (inner.size() > pos + 2 && inner[pos + 1] == '-') {
+        char c = static_cast<char>(std::toupper(static_cast<unsigned char>(inner[pos])));
+        if (c == 'C') {
+            modifiers |= chord::CTRL;
+        } else if (c == 'A' || c == 'M') {
+            modifiers |= chord::ALT; // 终端里 Meta 即 Alt
+        } else if (c == 'S') {
+            modifiers |= chord::SHIFT;
+        } else if (c == 'D') {
+            modifiers |= chord::META;
+        } else {
+            return chord::NONE;
+        }
+        pos += 2;
+    }
+
+    std::string name = inner.substr(pos);
+    KeyChord code = functionKey(name);
+    if (code == chord::NONE) {
+        std::string lower = toLower(name);
+        for (const auto& named : VIM_KEYS) {
+            if (lower == named.name) {
+                code = named.key;
+                break;
+            }
+        }
+    }
+    if (code == chord::NONE) {
+        code = printableKey(name);
+        // 不带修饰键的普通字符会吞掉正常输入，不进入分发表
+        if (code == chord::NONE || modifiers == 0) {
+            return chord::NONE;
+        }
+    }
+    if (code == ' ' && modifiers == 0) {
+        return chord::NONE;
+    }
+    return modifiers | code;
+}
+
+} // namespace input
+} // namespace pnana
@@ -1,8 +1,10 @@
 #include "core/config_manager.h"
 #include "core/editor.h"
 #include "features/logo_manager.h"
+#include "input/event_recorder.h"
 #include "ui/theme.h"
 #include "utils/logger.h"
+#include "utils/perf_trace.h"
 #include <csignal>
 #include <cstdlib>
 #include <cstring>
@@ -21,6 +23,8 @@ void printHelp() {
     std::cout << "  -c, --config PATH       Specify custom configuration file path\n";
     std::cout << "  -r, --readonly          Open file in read-only mode\n";
     std::cout << "  -l, --log [FILE]        Enable logging (default: pnana.log)\n";
+    std::cout << "      --trace FILE        Record binary perf events (decode with pnana-trace)\n";
+    std::cout << "      --record-events FILE  Record input events for editor_replay_benchmark\n";
     std::cout << "\nExamples:\n";
     std::cout << "  pnana                        Start with empty file\n";
     std::cout << "  pnana file.txt               Open file.txt\n";
@@ -136,6 +140,8 @@ int main(int argc, char* argv[]) {
         std::string config_path = "";
         std::string log_file = "pnana.log";
         bool enable_logging = false;
+        std::string trace_file;
+        std::string record_file;
 
         for (int i = 1; i < argc; ++i) {
             std::string arg = argv[i];
@@ -171,6 +177,20 @@ int main(int argc, char* argv[]) {
                 if (i + 1 < argc && argv[i + 1][0] != '-') {
                     log_file = argv[++i];
                 }
+            } else if (arg == "--trace") {
+                if (i + 1 < argc) {
+                    trace_file = argv[++i];
+                } else {
+                    std::cerr << "Error: --trace requires an argument\n";
+                    return 1;
+                }
+            } else if (arg == "--record-events") {
+                if (i + 1 < argc) {
+                    record_file = argv[++i];
+                } else {
+                    std::cerr << "Error: --record-events requires an argument\n";
+                    return 1;
+                }
             } else if (arg[0] == '-') {
                 std::cerr << "Error: Unknown option: " << arg << "\n";
                 std::cerr << "Try 'pnana --help' for more information.\n";
@@ -185,6 +205,15 @@ int main(int argc, char* argv[]) {
             pnana::utils::Logger::getInstance().log("Logger initialized: " + log_file);
         }
 
+        if (!trace_file.empty() && !pnana::utils::PerfTrace::getInstance().start(trace_file)) {
+            std::cerr << "Warning: cannot open trace file: " << trace_file << "\n";
+        }
+
+        auto& recorder = pnana::input::EventRecorder::getInstance();
+        if (!record_file.empty() && !recorder.start(record_file)) {
+            std::cerr << "Warning: cannot open event log: " << record_file << "\n";
+        }
+
         pnana::core::Editor editor;
 
         if (!config_path.empty()) {
@@ -196,11 +225,14 @@ int main(int argc, char* argv[]) {
         }
 
         if (!files.empty()) {
+            recorder.recordOpen(files[0]);
             editor.openFile(files[0]);
         }
 
         editor.run();
 
+        recorder.stop();
+        pnana::utils::PerfTrace::getInstance().stop();
         if (enable_logging) {
             pnana::utils::Logger::getInstance().close();
         }
@@ -0,0 +1,110 @@
+#ifdef BUILD_LUA_SUPPORT
+
+#include "plugins/autocmd_index.h"
+#include <algorithm>
+#include <fnmatch.h>
+
+namespace pnana {
+namespace plugins {
+
+namespace {
+
+bool hasWildcard(const std::string& pattern) {
+    return pattern.find_first_of("*?[") != std::string::npos;
+}
+
+// 文件名部分的扩展名（含点）；没有扩展名时为空
+std::string extensionOf(const std::string& filepath) {
+    size_t slash = filepath.find_last_of('/');
+    size_t name_start = slash == std::string::npos ? 0 : slash + 1;
+    size_t dot = filepath.find_last_of('.');
+    if (dot == std::string::npos || dot < name_start) {
+        return "";
+    }
+    return filepath.substr(dot);
+}
+
+} // namespace
+
+AutocmdPatternIndex::AutocmdPatternIndex(const std::vector<std::string>& patterns)
+    : count_(patterns.size()) {
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        if (patterns[i].empty()) {
+            always_.push_back(i);
+            continue;
+        }
+        size_t start = 0;
+        while (start <= patterns[i].size()) {
+            size_t comma = patterns[i].find(',', start);
+            if (comma == std::string::npos) {
+                comma = patterns[i].size();
+            }
+            if (comma > start) {
+                add(i, patterns[i].substr(start, comma - start));
+            }
+            start = comma + 1;
+        }
+    }
+}
+
+void AutocmdPatternIndex::add(size_t index, const std::string& pattern) {
+    if (pattern == "*") {
+        always_.push_back(index);
+    } else if (pattern.size() > 2 && pattern[0] == '*' && pattern[1] == '.' &&
+               !hasWildcard(pattern.substr(1)) && pattern.find('/') == std::string::npos) {
+        by_extension_[pattern.substr(1)].push_back(index);
+    } else if (hasWildcard(pattern)) {
+        globs_.emplace_back(index, pattern);
+        // 相对路径模式（"src/*.c"）也匹配绝对路径的结尾部分
+        if (pattern.find('/') != std::string::npos && pattern[0] != '/' && pattern[0] != '*') {
+            globs_.emplace_back(index, "*/" + pattern);
+        }
+    } else {
+        substrings_.emplace_back(index, pattern);
+    }
+}
+
+std::vector<size_t> AutocmdPatternIndex::match(const std::string& filepath) const {
+    std::vector<size_t> matched;
+    if (filepath.empty()) {
+        matched.reserve(count_);
+        for (size_t i = 0; i < count_; ++i) {
+            matched.push_back(i);
+        }
+        return matched;
+    }
+
+    matched = always_;
+    if (!by_extension_.empty()) {
+        auto it = by_extension_.find(extensionOf(filepath));
+        if (it != by_extension_.end()) {
+            matched.insert(matched.end(), it->second.begin(), it->second.end());
+        }
+    }
+    for (const auto& entry : substrings_) {
+        if (filepath.find(entry.second) != std::string::npos) {
+            matched.push_back(entry.first);
+        }
+    }
+    if (!globs_.empty()) {
+        size_t slash = filepath.find_last_of('/');
+        std::string name = slash == std::string::npos ? filepath : filepath.substr(slash + 1);
+        for (const auto& entry : globs_) {
+            const std::string& subject =
+                entry.second.find('/') != std::string::npos ? filepath : name;
+            if (fnmatch(entry.second.c_str(), subject.c_str(), 0) == 0) {
+                matched.push_back(entry.first);
+            }
+        }
+    }
+
+    // 多个模式可能命中同一个 autocmd；恢复注册顺序
+    std::sort(matched.begin(), matched.end());
+    matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+    return matched;
+}
+
+} // namespace plugins
+} // namespace pnana
+
+#endif // BUILD_LUA_SUPPORT
@@ -2,14 +2,51 @@
 
 #include "plugins/editor_api.h"
 #include "core/document.h"
+#include "core/document_snapshot.h"
 #include "core/editor.h"
+#include "plugins/lua_api.h"
 #include <lua.hpp>
+#include <memory>
+#include <new>
+#include <string>
 
 namespace pnana {
 namespace plugins {
 
 // 在 Lua 注册表中存储编辑器指针的键
 static const char* kEditorRegistryKey = "pnana_editor";
+// LuaAPI 实例（修改订阅由它统一投递）
+static const char* kLuaAPIRegistryKey = "pnana_lua_api";
+static const char* kBufferMetatable = "pnana.Buffer";
+static const char* kLineIteratorMetatable = "pnana.LineIterator";
+
+// buffer 句柄只记录文档实例 id，每次调用时查找文档：句柄可以长期保存，文档关闭后方法返回空结果
+struct LuaBufferHandle {
+    uint64_t doc_id;
+};
+
+// buf:lines() 的迭代状态。普通文档持有当前版本的快照，行数据与文档共享（不复制），
+// 迭代期间的编辑不影响结果；懒加载的大文件不取快照（会读入整文件），逐行经行缓存读取
+struct LuaLineIterator {
+    std::shared_ptr<const core::DocumentSnapshot> snapshot;
+    uint64_t doc_id;
+    size_t row;
+    size_t end;
+};
+
+// 行号为 0-based、右端不含；负数从末尾计（-1 表示最后一行之后），越界截到 [0, count]
+static size_t normalizeRow(lua_Integer row, size_t count) {
+    if (row < 0) {
+        row += static_cast<lua_Integer>(count) + 1;
+    }
+    if (row < 0) {
+        return 0;
+    }
+    if (static_cast<size_t>(row) > count) {
+        return count;
+    }
+    return static_cast<size_t>(row);
+}
 
 EditorAPI::EditorAPI(core::Editor* editor) : editor_(editor) {}
 
@@ -48,7 +85,64 @@ void EditorAPI::registerFunctions(lua_State* L) {
     lua_pushcfunction(L, lua_fn_delete_line);
     lua_setfield(L, -2, "delete_line");
 
+    lua_pushcfunction(L, lua_fn_get_buf);
+    lua_setfield(L, -2, "get_buf");
+
+    lua_pushcfunction(L, lua_fn_get_lines);
+    lua_setfield(L, -2, "get_lines");
+
+    lua_pushcfunction(L, lua_fn_set_lines);
+    lua_setfield(L, -2, "set_lines");
+
     lua_pop(L, 2); // 弹出 vim 和 api 表
+
+    registerBufferMetatables(L);
+}
+
+void EditorAPI::registerBufferMetatables(lua_State* L) {
+    static const luaL_Reg buffer_methods[] = {
+        {"id", lua_buf_id},
+        {"is_valid", lua_buf_is_valid},
+        {"line_count", lua_buf_line_count},
+        {"get_lines", lua_buf_get_lines},
+        {"set_lines", lua_buf_set_lines},
+        {"lines", lua_buf_lines},
+        {"on_change", lua_buf_on_change},
+        {"detach", lua_buf_detach},
+        {nullptr, nullptr},
+    };
+
+    luaL_newmetatable(L, kBufferMetatable);
+    luaL_newlib(L, buffer_methods);
+    lua_setfield(L, -2, "__index");
+    lua_pushcfunction(L, lua_buf_tostring);
+    lua_setfield(L, -2, "__tostring");
+    lua_pop(L, 1);
+
+    luaL_newmetatable(L, kLineIteratorMetatable);
+    lua_pushcfunction(L, lua_line_iter_gc);
+    lua_setfield(L, -2, "__gc");
+    lua_pop(L, 1);
+}
+
+void EditorAPI::pushBuffer(lua_State* L, uint64_t doc_id) {
+    LuaBufferHandle* handle =
+        static_cast<LuaBufferHandle*>(lua_newuserdata(L, sizeof(LuaBufferHandle)));
+    handle->doc_id = doc_id;
+    luaL_setmetatable(L, kBufferMetatable);
+}
+
+core::Document* EditorAPI::checkBuffer(lua_State* L, int index, uint64_t* doc_id) {
+    LuaBufferHandle* handle =
+        static_cast<LuaBufferHandle*>(luaL_checkudata(L, index, kBufferMetatable));
+    if (doc_id) {
+        *doc_id = handle->doc_id;
+    }
+    core::Editor* editor = getEditorFromLua(L);
+    if (!editor) {
+        return nullptr;
+    }
+    return editor->getDocumentByIdForLua(handle->doc_id);
 }
 
 core::Editor* EditorAPI::getEditorFromLua(lua_State* L) {
@@ -228,6 +322,264 @@ int EditorAPI::lua_fn_delete_line(lua_State* L) {
     return 0;
 }
 
+// vim.api.get_buf() -> buffer（当前文档的句柄，没有文档时为 nil）
+int EditorAPI::lua_fn_get_buf(lua_State* L) {
+    core::Editor* editor = getEditorFromLua(L);
+    core::Document* doc = editor ? editor->getCurrentDocumentForLua() : nullptr;
+    if (!doc) {
+        lua_pushnil(L);
+        return 1;
+    }
+    pushBuffer(L, doc->getInstanceId());
+    return 1;
+}
+
+// vim.api.get_lines(start?, end?) -> {string...}（当前文档，等同 vim.api.get_buf():get_lines）
+int EditorAPI::lua_fn_get_lines(lua_State* L) {
+    core::Editor* editor = getEditorFromLua(L);
+    return getLinesImpl(L, editor ? editor->getCurrentDocumentForLua() : nullptr, 1);
+}
+
+// vim.api.set_lines(start, end, lines) -> boolean（当前文档）
+int EditorAPI::lua_fn_set_lines(lua_State* L) {
+    core::Editor* editor = getEditorFromLua(L);
+    return setLinesImpl(L, editor ? editor->getCurrentDocumentForLua() : nullptr, 1);
+}
+
+int EditorAPI::getLinesImpl(lua_State* L, core::Document* doc, int first_arg) {
+    lua_Integer first = luaL_optinteger(L, first_arg, 0);
+    lua_Integer last = luaL_optinteger(L, first_arg + 1, -1);
+    if (!doc) {
+        lua_newtable(L);
+        return 1;
+    }
+
+    size_t count = doc->lineCount();
+    size_t start = normalizeRow(first, count);
+    size_t end = normalizeRow(last, count);
+    if (start >= end) {
+        lua_newtable(L);
+        return 1;
+    }
+
+    // 一次调用填满整张表，行内容直接从文档的行存储压栈，不经过中间副本
+    lua_createtable(L, static_cast<int>(end - start), 0);
+    for (size_t row = start; row < end; ++row) {
+        const std::string& line = doc->getLine(row);
+        lua_pushlstring(L, line.data(), line.size());
+        lua_rawseti(L, -2, static_cast<lua_Integer>(row - start + 1));
+    }
+    return 1;
+}
+
+int EditorAPI::setLinesImpl(lua_State* L, core::Document* doc, int first_arg) {
+    lua_Integer first = luaL_checkinteger(L, first_arg);
+    lua_Integer last = luaL_checkinteger(L, first_arg + 1);
+    const int lines_arg = first_arg + 2;
+    luaL_checktype(L, lines_arg, LUA_TTABLE);
+
+    // 先校验参数再分配 C++ 对象：Lua 报错会 longjmp 跳过析构
+    const size_t n = static_cast<size_t>(lua_rawlen(L, lines_arg));
+    size_t total = 0;
+    for (size_t i = 1; i <= n; ++i) {
+        lua_rawgeti(L, lines_arg, static_cast<lua_Integer>(i));
+        if (lua_type(L, -1) != LUA_TSTRING) {
+            return luaL_argerror(L, lines_arg, "lines must be a list of strings");
+        }
+        total += lua_rawlen(L, -1) + 1;
+        lua_pop(L, 1);
+    }
+
+    if (!doc || doc->isReadOnly()) {
+        lua_pushboolean(L, false);
+        return 1;
+    }
+
+    size_t count = doc->lineCount();
+    size_t start = normalizeRow(first, count);
+    size_t end = normalizeRow(last, count);
+    if (end < start) {
+        end = start;
+    }
+    if (start == end && n == 0) {
+        lua_pushboolean(L, true);
+        return 1;
+    }
+
+    std::string joined;
+    joined.reserve(total + 1);
+    for (size_t i = 1; i <= n; ++i) {
+        lua_rawgeti(L, lines_arg, static_cast<lua_Integer>(i));
+        size_t len = 0;
+        const char* text = lua_tolstring(L, -1, &len);
+        if (i > 1) {
+            joined.push_back('\n');
+        }
+        joined.append(text, len);
+        lua_pop(L, 1);
+    }
+
+    // [start, end) 整行替换为 lines，作为一次 applyEdits（一个撤销组、一次后端 replace）
+    core::TextEdit edit;
+    if (count == 0) {
+        edit.text = std::move(joined);
+    } else if (end < count) {
+        edit.start_row = start;
+        edit.end_row = end;
+        if (n > 0) {
+            joined.push_back('\n');
+        }
+        edit.text = std::move(joined);
+    } else if (start > 0) {
+        // 替换到文末：从上一行行尾开始，文档末尾不会多出或少掉空行
+        edit.start_row = start - 1;
+        edit.start_col = doc->getLineLength(start - 1);
+        edit.end_row = count - 1;
+        edit.end_col = doc->getLineLength(count - 1);
+        edit.text = n > 0 ? "\n" + joined : std::string();
+    } else {
+        edit.end_row = count - 1;
+        edit.end_col = doc->getLineLength(count - 1);
+        edit.text = std::move(joined);
+    }
+
+    bool ok = doc->applyEdits({edit});
+    lua_pushboolean(L, ok);
+    return 1;
+}
+
+// buf:id() -> integer
+int EditorAPI::lua_buf_id(lua_State* L) {
+    uint64_t doc_id = 0;
+    checkBuffer(L, 1, &doc_id);
+    lua_pushinteger(L, static_cast<lua_Integer>(doc_id));
+    return 1;
+}
+
+// buf:is_valid() -> boolean（文档是否仍然打开）
+int EditorAPI::lua_buf_is_valid(lua_State* L) {
+    lua_pushboolean(L, checkBuffer(L, 1) != nullptr);
+    return 1;
+}
+
+// buf:line_count() -> integer
+int EditorAPI::lua_buf_line_count(lua_State* L) {
+    core::Document* doc = checkBuffer(L, 1);
+    lua_pushinteger(L, doc ? static_cast<lua_Integer>(doc->lineCount()) : 0);
+    return 1;
+}
+
+// buf:get_lines(start?, end?) -> {string...}
+int EditorAPI::lua_buf_get_lines(lua_State* L) {
+    return getLinesImpl(L, checkBuffer(L, 1), 2);
+}
+
+// buf:set_lines(start, end, lines) -> boolean
+int EditorAPI::lua_buf_set_lines(lua_State* L) {
+    return setLinesImpl(L, checkBuffer(L, 1), 2);
+}
+
+// buf:lines(start?, end?) -> iterator，for row, line in buf:lines() do ... end
+int EditorAPI::lua_buf_lines(lua_State* L) {
+    uint64_t doc_id = 0;
+    core::Document* doc = checkBuffer(L, 1, &doc_id);
+    lua_Integer first = luaL_optinteger(L, 2, 0);
+    lua_Integer last = luaL_optinteger(L, 3, -1);
+    size_t count = doc ? doc->lineCount() : 0;
+
+    void* memory = lua_newuserdata(L, sizeof(LuaLineIterator));
+    LuaLineIterator* iter = new (memory) LuaLineIterator();
+    luaL_setmetatable(L, kLineIteratorMetatable);
+    iter->doc_id = doc_id;
+    iter->row = normalizeRow(first, count);
+    iter->end = normalizeRow(last, count);
+    if (doc && !doc->isLazyLoaded() && iter->row < iter->end) {
+        iter->snapshot = doc->snapshot();
+    }
+
+    lua_pushcclosure(L, lua_line_iter_next, 1);
+    return 1;
+}
+
+int EditorAPI::lua_line_iter_next(lua_State* L) {
+    LuaLineIterator* iter = static_cast<LuaLineIterator*>(lua_touserdata(L, lua_upvalueindex(1)));
+    if (!iter || iter->row >= iter->end) {
+        return 0;
+    }
+
+    const std::string* line = nullptr;
+    if (iter->snapshot) {
+        if (iter->row < iter->snapshot->lineCount()) {
+            line = &iter->snapshot->line(iter->row);
+        }
+    } else {
+        core::Editor* editor = getEditorFromLua(L);
+        core::Document* doc = editor ? editor->getDocumentByIdForLua(iter->doc_id) : nullptr;
+        if (doc && iter->row < doc->lineCount()) {
+            line = &doc->getLine(iter->row);
+        }
+    }
+    if (!line) {
+        iter->row = iter->end;
+        return 0;
+    }
+
+    lua_pushinteger(L, static_cast<lua_Integer>(iter->row));
+    lua_pushlstring(L, line->data(), line->size());
+    ++iter->row;
+    if (iter->row >= iter->end) {
+        iter->snapshot.reset(); // 迭代结束即释放快照，不等 GC
+    }
+    return 2;
+}
+
+int EditorAPI::lua_line_iter_gc(lua_State* L) {
+    LuaLineIterator* iter =
+        static_cast<LuaLineIterator*>(luaL_checkudata(L, 1, kLineIteratorMetatable));
+    iter->~LuaLineIterator();
+    return 0;
+}
+
+// buf:on_change(function(buf, changes, version) ... end) -> subscription id
+int EditorAPI::lua_buf_on_change(lua_State* L) {
+    uint64_t doc_id = 0;
+    core::Document* doc = checkBuffer(L, 1, &doc_id);
+    luaL_checktype(L, 2, LUA_TFUNCTION);
+
+    lua_getfield(L, LUA_REGISTRYINDEX, kLuaAPIRegistryKey);
+    LuaAPI* api = static_cast<LuaAPI*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    if (!api || !doc) {
+        lua_pushnil(L);
+        return 1;
+    }
+
+    lua_pushvalue(L, 2);
+    int ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    int id = api->attachBuffer(doc_id, doc->getVersion(), ref);
+    lua_pushinteger(L, id);
+    return 1;
+}
+
+// buf:detach(subscription_id) -> boolean
+int EditorAPI::lua_buf_detach(lua_State* L) {
+    checkBuffer(L, 1);
+    int id = static_cast<int>(luaL_checkinteger(L, 2));
+
+    lua_getfield(L, LUA_REGISTRYINDEX, kLuaAPIRegistryKey);
+    LuaAPI* api = static_cast<LuaAPI*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    lua_pushboolean(L, api && api->detachBuffer(id));
+    return 1;
+}
+
+int EditorAPI::lua_buf_tostring(lua_State* L) {
+    uint64_t doc_id = 0;
+    checkBuffer(L, 1, &doc_id);
+    lua_pushfstring(L, "pnana.Buffer(%I)", static_cast<lua_Integer>(doc_id));
+    return 1;
+}
+
 } // namespace plugins
 } // namespace pnana
 
@@ -7,6 +7,7 @@
 #include "plugins/event_parser_api.h"
 #include "plugins/icon_api.h"
 #include "utils/logger.h"
+#include <algorithm>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
@@ -57,6 +58,16 @@ void LuaAPI::initialize(LuaEngine* engine) {
     lua_pushlightuserdata(L, editor_);
     lua_setfield(L, LUA_REGISTRYINDEX, EDITOR_REGISTRY_KEY);
 
+    // 插件回调调度器；worker 线程发来消息时用 Custom 事件唤醒主循环（PostEvent 线程安全）
+    scheduler_ = std::make_unique<PluginScheduler>(L);
+    scheduler_->setTaskTimeout(engine_->getExecutionTimeout());
+    if (editor_) {
+        core::Editor* editor = editor_;
+        scheduler_->setWakeCallback([editor]() {
+            editor->screen_.PostEvent(ftxui::Event::Custom);
+        });
+    }
+
     // 创建 vim 全局表
     engine_->createTable("vim");
 
@@ -95,136 +106,119 @@ LuaAPI* LuaAPI::getAPIFromLua(lua_State* L) {
 }
 
 void LuaAPI::triggerEvent(const std::string& event, const std::vector<std::string>& args) {
-    if (!engine_) {
+    if (!engine_ || !scheduler_) {
         return;
     }
 
-    lua_State* L = engine_->getState();
-
     // 提取文件路径（如果有）
     std::string filepath = args.empty() ? "" : args[0];
 
-    // 处理新API的autocmd
+    // *Pre 事件（BufWritePre 等）的回调要在操作继续之前跑完：不按时间片让出，只受执行时限约束
+    const bool synchronous = event.size() > 3 && event.compare(event.size() - 3, 3, "Pre") == 0;
+    auto run = [this, synchronous](const std::string& label, const std::string& owner,
+                                   const PluginScheduler::PushCall& push) {
+        return synchronous ? scheduler_->runNow(label, owner, push)
+                           : scheduler_->spawn(label, owner, push);
+    };
+
+    // 处理新API的autocmd：先按 pattern 索引选出要运行的回调，再交给调度器。
+    // 回调可能注册/清除 autocmd，所以运行前复制出来，并先移除 once 条目
+    std::vector<AutocmdInfo> fired;
     auto autocmd_it = autocmds_.find(event);
     if (autocmd_it != autocmds_.end()) {
-        std::vector<int> to_remove; // 标记需要删除的once事件
-
-        for (size_t i = 0; i < autocmd_it->second.size(); ++i) {
-            const auto& info = autocmd_it->second[i];
-
-            // 检查pattern匹配（简化实现，支持通配符*）
-            bool pattern_match = true;
-            if (!info.pattern.empty() && !filepath.empty()) {
-                // 简单的通配符匹配
-                std::string pattern = info.pattern;
-                if (pattern.find("*") != std::string::npos) {
-                    // 提取扩展名
-                    size_t dot_pos = filepath.find_last_of(".");
-                    if (dot_pos != std::string::npos) {
-                        std::string ext = filepath.substr(dot_pos);
-                        pattern_match = (pattern == "*" + ext || pattern == ext);
-                    } else {
-                        pattern_match = false;
-                    }
-                } else {
-                    pattern_match = (filepath.find(pattern) != std::string::npos);
-                }
+        auto& infos = autocmd_it->second;
+        auto index_it = autocmd_indexes_.find(event);
+        if (index_it == autocmd_indexes_.end()) {
+            std::vector<std::string> patterns;
+            patterns.reserve(infos.size());
+            for (const auto& info : infos) {
+                patterns.push_back(info.pattern);
             }
+            index_it = autocmd_indexes_.emplace(event, AutocmdPatternIndex(patterns)).first;
+        }
 
-            if (!pattern_match) {
-                continue;
+        std::vector<size_t> matched = index_it->second.match(filepath);
+        bool removed_once = false;
+        for (size_t index : matched) {
+            fired.push_back(infos[index]);
+        }
+        // 从后往前删除 once 事件，避免索引问题
+        for (auto it = matched.rbegin(); it != matched.rend(); ++it) {
+            if (infos[*it].once) {
+                infos.erase(infos.begin() + static_cast<std::ptrdiff_t>(*it));
+                removed_once = true;
             }
-
-            // 调用回调函数
-            lua_rawgeti(L, LUA_REGISTRYINDEX, info.callback_ref);
-            if (lua_isfunction(L, -1)) {
-                // 创建event表（新API格式）
-                lua_newtable(L);
-                lua_pushstring(L, event.c_str());
-                lua_setfield(L, -2, "event");
-                if (!filepath.empty()) {
-                    lua_pushstring(L, filepath.c_str());
-                    lua_setfield(L, -2, "file");
-                }
-
-                // 调用函数
-                int result = lua_pcall(L, 1, 0, 0);
-                if (result != LUA_OK) {
-                    const char* error = lua_tostring(L, -1);
-                    LOG_ERROR("Autocmd callback error: " + std::string(error));
-                    lua_pop(L, 1);
-                }
-
-                // 如果是once事件，标记删除
-                if (info.once) {
-                    to_remove.push_back(static_cast<int>(i));
-                }
-            } else {
-                lua_pop(L, 1);
+        }
+        if (removed_once) {
+            autocmd_indexes_.erase(event);
+            if (infos.empty()) {
+                autocmds_.erase(autocmd_it);
             }
         }
+    }
 
-        // 删除once事件（从后往前删除，避免索引问题）
-        for (auto it = to_remove.rbegin(); it != to_remove.rend(); ++it) {
-            int index = *it;
-            if (index < static_cast<int>(autocmd_it->second.size())) {
-                if (engine_ && engine_->getState()) {
-                    luaL_unref(engine_->getState(), LUA_REGISTRYINDEX,
-                               autocmd_it->second[index].callback_ref);
-                }
-                autocmd_it->second.erase(autocmd_it->second.begin() + index);
+    lua_State* L = engine_->getState();
+    for (const auto& info : fired) {
+        int ref = info.callback_ref;
+        run("autocmd " + event, info.plugin_owner, [ref, &event, &filepath](lua_State* thread) {
+            lua_rawgeti(thread, LUA_REGISTRYINDEX, ref);
+            if (!lua_isfunction(thread, -1)) {
+                lua_pop(thread, 1);
+                return -1;
             }
+            // 创建event表（新API格式）
+            lua_newtable(thread);
+            lua_pushstring(thread, event.c_str());
+            lua_setfield(thread, -2, "event");
+            if (!filepath.empty()) {
+                lua_pushstring(thread, filepath.c_str());
+                lua_setfield(thread, -2, "file");
+            }
+            return 1;
+        });
+        // once 回调已压入协程，可以释放引用
+        if (info.once) {
+            luaL_unref(L, LUA_REGISTRYINDEX, ref);
         }
+    }
 
-        // 如果列表为空，删除事件
-        if (autocmd_it->second.empty()) {
-            autocmds_.erase(autocmd_it);
+    // 旧API回调的参数格式：直接传字符串
+    auto push_args = [&args](lua_State* thread) -> int {
+        for (const auto& arg : args) {
+            lua_pushstring(thread, arg.c_str());
         }
-    }
+        return static_cast<int>(args.size());
+    };
 
     // 处理旧API的字符串回调（兼容性）
     auto it = event_listeners_.find(event);
     if (it != event_listeners_.end()) {
-        for (const auto& callback : it->second) {
-            lua_getglobal(L, callback.c_str());
-            if (lua_isfunction(L, -1)) {
-                // 推送参数（旧格式：直接传字符串）
-                for (const auto& arg : args) {
-                    lua_pushstring(L, arg.c_str());
+        std::vector<std::string> callbacks = it->second;
+        for (const auto& callback : callbacks) {
+            run("event " + event, "", [&callback, &push_args](lua_State* thread) {
+                lua_getglobal(thread, callback.c_str());
+                if (!lua_isfunction(thread, -1)) {
+                    lua_pop(thread, 1);
+                    return -1;
                 }
-
-                int result = lua_pcall(L, static_cast<int>(args.size()), 0, 0);
-                if (result != LUA_OK) {
-                    const char* error = lua_tostring(L, -1);
-                    LOG_ERROR("Event callback error: " + std::string(error));
-                    lua_pop(L, 1);
-                }
-            } else {
-                lua_pop(L, 1);
-            }
+                return push_args(thread);
+            });
         }
     }
 
     // 处理旧API的函数引用回调（兼容性）
     auto func_it = event_function_listeners_.find(event);
     if (func_it != event_function_listeners_.end()) {
-        for (int ref : func_it->second) {
-            lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
-            if (lua_isfunction(L, -1)) {
-                // 推送参数（旧格式：直接传字符串）
-                for (const auto& arg : args) {
-                    lua_pushstring(L, arg.c_str());
-                }
-
-                int result = lua_pcall(L, static_cast<int>(args.size()), 0, 0);
-                if (result != LUA_OK) {
-                    const char* error = lua_tostring(L, -1);
-                    LOG_ERROR("Event function callback error: " + std::string(error));
-                    lua_pop(L, 1);
+        std::vector<int> refs = func_it->second;
+        for (int ref : refs) {
+            run("event " + event, "", [ref, &push_args](lua_State* thread) {
+                lua_rawgeti(thread, LUA_REGISTRYINDEX, ref);
+                if (!lua_isfunction(thread, -1)) {
+                    lua_pop(thread, 1);
+                    return -1;
                 }
-            } else {
-                lua_pop(L, 1);
-            }
+                return push_args(thread);
+            });
         }
     }
 }
@@ -253,6 +247,9 @@ void LuaAPI::registerCommand(const std::string& name, const std::string& callbac
 void LuaAPI::registerKeymap(const std::string& mode, const std::string& keys,
                             const std::string& callback) {
     keymaps_[mode][keys] = callback;
+    if (editor_) {
+        editor_->getKeyBindingManager().bindPluginKeymap(mode, keys);
+    }
 }
 
 // 新API实现
@@ -331,7 +328,7 @@ bool LuaAPI::executeCommand(const std::string& name, const std::string& args) {
         lua_setfield(L, -2, "fargs");
 
         // 调用函数
-        int result = lua_pcall(L, 1, 0, 0);
+        int result = engine_->protectedCall(1, 0);
         if (result != LUA_OK) {
             const char* error = lua_tostring(L, -1);
             LOG_ERROR("Command execution error: " + std::string(error));
@@ -346,7 +343,7 @@ bool LuaAPI::executeCommand(const std::string& name, const std::string& args) {
     if (old_it != commands_.end()) {
         lua_getglobal(L, old_it->second.c_str());
         if (lua_isfunction(L, -1)) {
-            int result = lua_pcall(L, 0, 0, 0);
+            int result = engine_->protectedCall(0, 0);
             if (result != LUA_OK) {
                 const char* error = lua_tostring(L, -1);
                 LOG_ERROR("Command execution error: " + std::string(error));
@@ -375,6 +372,9 @@ void LuaAPI::registerKeymap(const std::string& mode, const std::string& lhs, int
     info.desc = desc;
     info.plugin_owner = current_plugin_context_;
     keymaps_info_[mode][lhs] = info;
+    if (editor_) {
+        editor_->getKeyBindingManager().bindPluginKeymap(mode, lhs);
+    }
 }
 
 void LuaAPI::registerKeymap(const std::string& mode, const std::string& lhs,
@@ -390,6 +390,9 @@ void LuaAPI::registerKeymap(const std::string& mode, const std::string& lhs,
     info.desc = desc;
     info.plugin_owner = current_plugin_context_;
     keymaps_info_[mode][lhs] = info;
+    if (editor_) {
+        editor_->getKeyBindingManager().bindPluginKeymap(mode, lhs);
+    }
 }
 
 bool LuaAPI::delKeymap(const std::string& mode, const std::string& lhs) {
@@ -402,6 +405,9 @@ bool LuaAPI::delKeymap(const std::string& mode, const std::string& lhs) {
                 luaL_unref(engine_->getState(), LUA_REGISTRYINDEX, lhs_it->second.rhs_ref);
             }
             mode_it->second.erase(lhs_it);
+            if (editor_) {
+                editor_->getKeyBindingManager().unbindPluginKeymap(mode, lhs);
+            }
             return true;
         }
     }
@@ -412,6 +418,9 @@ bool LuaAPI::delKeymap(const std::string& mode, const std::string& lhs) {
         auto old_lhs_it = old_mode_it->second.find(lhs);
         if (old_lhs_it != old_mode_it->second.end()) {
             old_mode_it->second.erase(old_lhs_it);
+            if (editor_) {
+                editor_->getKeyBindingManager().unbindPluginKeymap(mode, lhs);
+            }
             return true;
         }
     }
@@ -437,7 +446,7 @@ bool LuaAPI::executeKeymap(const std::string& mode, const std::string& lhs) {
                 // 函数引用
                 lua_rawgeti(L, LUA_REGISTRYINDEX, info.rhs_ref);
                 if (lua_isfunction(L, -1)) {
-                    int result = lua_pcall(L, 0, 0, 0);
+                    int result = engine_->protectedCall(0, 0);
                     if (result != LUA_OK) {
                         const char* error = lua_tostring(L, -1);
                         LOG_ERROR("Keymap execution error: " + std::string(error));
@@ -478,7 +487,7 @@ bool LuaAPI::executeKeymap(const std::string& mode, const std::string& lhs) {
         if (old_lhs_it != old_mode_it->second.end()) {
             lua_getglobal(L, old_lhs_it->second.c_str());
             if (lua_isfunction(L, -1)) {
-                int result = lua_pcall(L, 0, 0, 0);
+                int result = engine_->protectedCall(0, 0);
                 if (result != LUA_OK) {
                     const char* error = lua_tostring(L, -1);
                     LOG_ERROR("Keymap execution error: " + std::string(error));
@@ -508,6 +517,7 @@ void LuaAPI::registerAutocmd(const std::string& event, int callback_ref, const s
     // desc is stored for future use (e.g., debugging, documentation)
     (void)desc; // Suppress unused parameter warning
     autocmds_[event].push_back(info);
+    autocmd_indexes_.erase(event);
 }
 
 void LuaAPI::clearAutocmds(const std::string& event, const std::string& pattern,
@@ -522,9 +532,12 @@ void LuaAPI::clearAutocmds(const std::string& event, const std::string& pattern,
             }
         }
         autocmds_.clear();
+        autocmd_indexes_.clear();
         return;
     }
 
+    autocmd_indexes_.erase(event);
+
     auto it = autocmds_.find(event);
     if (it != autocmds_.end()) {
         auto& infos = it->second;
@@ -658,7 +671,7 @@ bool LuaAPI::executePaletteCommand(const std::string& id) {
     }
 
     LOG_DEBUG("[LuaAPI::executePaletteCommand] Executing callback");
-    if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
+    if (engine_->protectedCall(0, 0) != LUA_OK) {
         const char* error = lua_tostring(L, -1);
         LOG_ERROR("[LuaAPI] Palette command execution error: " +
                   std::string(error ? error : "unknown"));
@@ -671,14 +684,16 @@ bool LuaAPI::executePaletteCommand(const std::string& id) {
 }
 
 int LuaAPI::deferFunction(int callback_ref, int delay_ms) {
-    if (delay_ms < 1) {
-        delay_ms = 1;
+    // 0 表示下一帧运行（vim.schedule）
+    if (delay_ms < 0) {
+        delay_ms = 0;
     }
     DeferredCall call;
     call.timer_id = next_timer_id_++;
     call.callback_ref = callback_ref;
     call.due = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
     call.cancelled = false;
+    call.plugin_owner = current_plugin_context_;
     deferred_calls_.push_back(call);
     return call.timer_id;
 }
@@ -692,38 +707,182 @@ void LuaAPI::cancelDeferred(int timer_id) {
 }
 
 void LuaAPI::processDeferred() {
-    if (!engine_ || !engine_->getState()) {
+    if (!engine_ || !engine_->getState() || !scheduler_) {
         return;
     }
 
     lua_State* L = engine_->getState();
     auto now = std::chrono::steady_clock::now();
 
+    // 先取出到期的定时器：回调运行时可能再 defer，向 deferred_calls_ 追加元素
+    std::vector<DeferredCall> due;
     for (auto& call : deferred_calls_) {
-        if (call.cancelled || call.due > now) {
+        if (!call.cancelled && call.due <= now) {
+            due.push_back(call);
+            call.cancelled = true;
+        }
+    }
+    deferred_calls_.erase(std::remove_if(deferred_calls_.begin(), deferred_calls_.end(),
+                                         [](const DeferredCall& c) {
+                                             return c.cancelled;
+                                         }),
+                          deferred_calls_.end());
+
+    for (const auto& call : due) {
+        int ref = call.callback_ref;
+        scheduler_->spawn("defer_fn", call.plugin_owner, [ref](lua_State* thread) -> int {
+            lua_rawgeti(thread, LUA_REGISTRYINDEX, ref);
+            if (!lua_isfunction(thread, -1)) {
+                lua_pop(thread, 1);
+                return -1;
+            }
+            return 0;
+        });
+        luaL_unref(L, LUA_REGISTRYINDEX, ref);
+    }
+
+    processBufferChanges();
+    scheduler_->tick();
+}
+
+int LuaAPI::attachBuffer(uint64_t doc_id, uint64_t version, int callback_ref) {
+    BufferSubscription sub;
+    sub.id = next_subscription_id_++;
+    sub.doc_id = doc_id;
+    sub.version = version;
+    sub.callback_ref = callback_ref;
+    sub.plugin_owner = current_plugin_context_;
+    buffer_subscriptions_.push_back(sub);
+    return sub.id;
+}
+
+bool LuaAPI::detachBuffer(int subscription_id) {
+    for (auto it = buffer_subscriptions_.begin(); it != buffer_subscriptions_.end(); ++it) {
+        if (it->id == subscription_id) {
+            if (engine_ && engine_->getState()) {
+                luaL_unref(engine_->getState(), LUA_REGISTRYINDEX, it->callback_ref);
+            }
+            buffer_subscriptions_.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void LuaAPI::processBufferChanges() {
+    if (buffer_subscriptions_.empty() || !editor_) {
+        return;
+    }
+
+    lua_State* L = engine_->getState();
+
+    // 先确定本帧要投递的订阅：回调里可能再订阅、取消订阅或修改文档
+    std::vector<int> due;
+    for (auto it = buffer_subscriptions_.begin(); it != buffer_subscriptions_.end();) {
+        core::Document* doc = editor_->getDocumentByIdForLua(it->doc_id);
+        if (!doc) {
+            luaL_unref(L, LUA_REGISTRYINDEX, it->callback_ref);
+            it = buffer_subscriptions_.erase(it);
             continue;
         }
+        if (doc->getVersion() != it->version) {
+            due.push_back(it->id);
+        }
+        ++it;
+    }
 
-        lua_rawgeti(L, LUA_REGISTRYINDEX, call.callback_ref);
-        if (lua_isfunction(L, -1)) {
-            if (lua_pcall(L, 0, 0, 0) != LUA_OK) {
-                const char* error = lua_tostring(L, -1);
-                LOG_ERROR("defer_fn callback error: " + std::string(error ? error : "unknown"));
-                lua_pop(L, 1);
+    std::vector<core::ContentEdit> edits;
+    for (int id : due) {
+        auto it = std::find_if(buffer_subscriptions_.begin(), buffer_subscriptions_.end(),
+                               [id](const BufferSubscription& sub) {
+                                   return sub.id == id;
+                               });
+        if (it == buffer_subscriptions_.end()) {
+            continue;
+        }
+        core::Document* doc = editor_->getDocumentByIdForLua(it->doc_id);
+        if (!doc || doc->getVersion() == it->version) {
+            continue;
+        }
+
+        // 版本在投递时推进：前一个回调对同一文档的修改不会重复投递。
+        // 日志无法覆盖（截断、整体替换）时传 nil，由插件重新读取整个 buffer
+        const bool incremental = doc->getEditsSince(it->version, edits);
+        const uint64_t version = doc->getVersion();
+        const int ref = it->callback_ref;
+        const uint64_t doc_id = it->doc_id;
+        const std::string owner = it->plugin_owner;
+        it->version = version;
+        scheduler_->spawn("on_change", owner, [&](lua_State* thread) -> int {
+            lua_rawgeti(thread, LUA_REGISTRYINDEX, ref);
+            if (!lua_isfunction(thread, -1)) {
+                lua_pop(thread, 1);
+                return -1;
             }
-        } else {
-            lua_pop(L, 1);
+            EditorAPI::pushBuffer(thread, doc_id);
+            if (incremental) {
+                lua_createtable(thread, static_cast<int>(edits.size()), 0);
+                lua_Integer i = 1;
+                for (const auto& entry : edits) {
+                    const core::TextEdit& edit = entry.edit;
+                    lua_createtable(thread, 0, 5);
+                    lua_pushinteger(thread, static_cast<lua_Integer>(edit.start_row));
+                    lua_setfield(thread, -2, "start_row");
+                    lua_pushinteger(thread, static_cast<lua_Integer>(edit.start_col));
+                    lua_setfield(thread, -2, "start_col");
+                    lua_pushinteger(thread, static_cast<lua_Integer>(edit.end_row));
+                    lua_setfield(thread, -2, "end_row");
+                    lua_pushinteger(thread, static_cast<lua_Integer>(edit.end_col));
+                    lua_setfield(thread, -2, "end_col");
+                    lua_pushlstring(thread, edit.text.data(), edit.text.size());
+                    lua_setfield(thread, -2, "text");
+                    lua_rawseti(thread, -2, i++);
+                }
+            } else {
+                lua_pushnil(thread);
+            }
+            lua_pushinteger(thread, static_cast<lua_Integer>(version));
+            return 3;
+        });
+    }
+}
+
+bool LuaAPI::hasPendingTasks() const {
+    if (scheduler_ && scheduler_->hasPending()) {
+        return true;
+    }
+    // 已到期的 defer（vim.schedule）在下一帧运行，不等下一次按键
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& call : deferred_calls_) {
+        if (!call.cancelled && call.due <= now) {
+            return true;
         }
+    }
+    // 已订阅的 buffer 被修改：下一帧投递，订阅方不必等到下一次按键才看到本次编辑
+    if (editor_) {
+        for (const auto& sub : buffer_subscriptions_) {
+            core::Document* doc = editor_->getDocumentByIdForLua(sub.doc_id);
+            if (!doc || doc->getVersion() != sub.version) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
 
-        luaL_unref(L, LUA_REGISTRYINDEX, call.callback_ref);
-        call.cancelled = true;
+int LuaAPI::startWorker(const std::string& source, int on_message_ref) {
+    if (!scheduler_) {
+        return -1;
     }
+    return scheduler_->startWorker(current_plugin_context_, source, on_message_ref);
+}
 
-    deferred_calls_.erase(std::remove_if(deferred_calls_.begin(), deferred_calls_.end(),
-                                         [](const DeferredCall& c) {
-                                             return c.cancelled;
-                                         }),
-                          deferred_calls_.end());
+bool LuaAPI::sendToWorker(int worker_id, const std::string& message) {
+    return scheduler_ && scheduler_->sendToWorker(worker_id, message);
+}
+
+bool LuaAPI::stopWorker(int worker_id) {
+    return scheduler_ && scheduler_->stopWorker(worker_id);
 }
 
 void LuaAPI::setCurrentPluginContext(const std::string& plugin_name) {
@@ -741,6 +900,31 @@ void LuaAPI::unregisterPluginArtifacts(const std::string& plugin_name) {
 
     lua_State* L = (engine_ ? engine_->getState() : nullptr);
 
+    // 丢弃挂起的任务，停止 worker
+    if (scheduler_) {
+        scheduler_->cancelOwner(plugin_name);
+    }
+    for (auto& call : deferred_calls_) {
+        if (!call.cancelled && call.plugin_owner == plugin_name) {
+            if (L) {
+                luaL_unref(L, LUA_REGISTRYINDEX, call.callback_ref);
+            }
+            call.cancelled = true;
+        }
+    }
+
+    // 取消 buffer 修改订阅
+    for (auto it = buffer_subscriptions_.begin(); it != buffer_subscriptions_.end();) {
+        if (it->plugin_owner == plugin_name) {
+            if (L) {
+                luaL_unref(L, LUA_REGISTRYINDEX, it->callback_ref);
+            }
+            it = buffer_subscriptions_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
     // 删除用户命令
     for (auto it = user_commands_.begin(); it != user_commands_.end();) {
         if (it->second.plugin_owner == plugin_name) {
@@ -760,6 +944,10 @@ void LuaAPI::unregisterPluginArtifacts(const std::string& plugin_name) {
                 if (L && km_it->second.rhs_ref != -1) {
                     luaL_unref(L, LUA_REGISTRYINDEX, km_it->second.rhs_ref);
                 }
+                if (editor_) {
+                    editor_->getKeyBindingManager().unbindPluginKeymap(mode_it->first,
+                                                                       km_it->first);
+                }
                 km_it = mode_it->second.erase(km_it);
             } else {
                 ++km_it;
@@ -768,6 +956,7 @@ void LuaAPI::unregisterPluginArtifacts(const std::string& plugin_name) {
     }
 
     // 删除 autocmd
+    autocmd_indexes_.clear();
     for (auto ac_it = autocmds_.begin(); ac_it != autocmds_.end();) {
         auto& infos = ac_it->second;
         infos.erase(std::remove_if(infos.begin(), infos.end(),
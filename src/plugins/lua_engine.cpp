@@ -3,6 +3,7 @@
 #include "plugins/lua_engine.h"
 #include "utils/logger.h"
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -10,6 +11,28 @@
 namespace pnana {
 namespace plugins {
 
+namespace {
+
+// 钩子每执行这么多条 VM 指令检查一次时间
+constexpr int WATCHDOG_INSTRUCTIONS = 1000;
+
+struct CallDeadline {
+    std::chrono::steady_clock::time_point deadline;
+    int timeout_ms;
+};
+
+// 当前最外层 protectedCall 的时限（主线程使用）
+CallDeadline* active_deadline = nullptr;
+
+void watchdogHook(lua_State* L, lua_Debug* ar) {
+    (void)ar;
+    if (active_deadline && std::chrono::steady_clock::now() >= active_deadline->deadline) {
+        luaL_error(L, "execution time limit exceeded (%d ms)", active_deadline->timeout_ms);
+    }
+}
+
+} // namespace
+
 LuaEngine::LuaEngine() : L_(nullptr) {
     L_ = luaL_newstate();
     if (!L_) {
@@ -196,7 +219,7 @@ bool LuaEngine::executeString(const std::string& code) {
         return false;
     }
 
-    result = lua_pcall(L_, 0, LUA_MULTRET, 0);
+    result = protectedCall(0, LUA_MULTRET);
     return checkError(result);
 }
 
@@ -213,7 +236,7 @@ bool LuaEngine::executeFile(const std::string& filepath) {
         return false;
     }
 
-    result = lua_pcall(L_, 0, LUA_MULTRET, 0);
+    result = protectedCall(0, LUA_MULTRET);
     bool success = checkError(result);
 
     if (success) {
@@ -423,10 +446,26 @@ bool LuaEngine::callFunction(const std::string& funcName, int nargs, int nresult
     }
 
     // 函数已经在栈上，参数应该在函数下面
-    int result = lua_pcall(L_, nargs, nresults, 0);
+    int result = protectedCall(nargs, nresults);
     return checkError(result);
 }
 
+int LuaEngine::protectedCall(int nargs, int nresults) {
+    if (execution_timeout_ms_ <= 0 || active_deadline) {
+        return lua_pcall(L_, nargs, nresults, 0);
+    }
+
+    CallDeadline deadline{std::chrono::steady_clock::now() +
+                              std::chrono::milliseconds(execution_timeout_ms_),
+                          execution_timeout_ms_};
+    active_deadline = &deadline;
+    lua_sethook(L_, watchdogHook, LUA_MASKCOUNT, WATCHDOG_INSTRUCTIONS);
+    int result = lua_pcall(L_, nargs, nresults, 0);
+    lua_sethook(L_, nullptr, 0, 0);
+    active_deadline = nullptr;
+    return result;
+}
+
 bool LuaEngine::checkError(int result) {
     if (result != LUA_OK) {
         handleError("pcall");
@@ -39,6 +39,8 @@ bool PluginManager::initialize() {
         LOG_ERROR("Failed to create Lua engine");
         return false;
     }
+    // 同步执行与调度器任务共用沙盒的执行时限
+    lua_engine_->setExecutionTimeout(sandbox_config_.max_execution_time_ms);
 
     // 创建 Lua API
     lua_api_ = std::make_unique<LuaAPI>(editor_);
@@ -526,6 +528,10 @@ void PluginManager::processDeferred() {
     }
 }
 
+bool PluginManager::hasPendingTasks() const {
+    return lua_api_ && lua_api_->hasPendingTasks();
+}
+
 void PluginManager::initializeSandbox() {
     // 创建路径验证器
     path_validator_ = std::make_unique<PathValidator>();
@@ -0,0 +1,456 @@
+#ifdef BUILD_LUA_SUPPORT
+
+#include "plugins/plugin_scheduler.h"
+#include "utils/logger.h"
+#include <algorithm>
+
+namespace pnana {
+namespace plugins {
+
+namespace {
+
+// 钩子每执行这么多条 VM 指令检查一次时间
+constexpr int HOOK_INSTRUCTIONS = 1000;
+// 新任务立即运行的时间片；没跑完的由 tick() 在帧预算内继续
+constexpr auto SPAWN_SLICE = std::chrono::milliseconds(2);
+constexpr auto FRAME_BUDGET = std::chrono::milliseconds(8);
+constexpr size_t MAX_WORKERS = 8;
+
+struct RunState {
+    std::chrono::steady_clock::time_point slice_end;
+    std::chrono::steady_clock::time_point hard_end;
+    bool has_hard_limit;
+    bool preemptible; // false：同步运行，时间片用完也不让出
+    int timeout_ms;
+};
+
+// 正在运行的任务（只在主线程使用；嵌套 resume 时由 resume() 保存并恢复）
+RunState* current_run = nullptr;
+
+void taskHook(lua_State* L, lua_Debug* ar) {
+    (void)ar;
+    if (!current_run) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (current_run->has_hard_limit && now >= current_run->hard_end) {
+        luaL_error(L, "execution time limit exceeded (%d ms)", current_run->timeout_ms);
+        return;
+    }
+    // C 函数边界（如 table.sort 的比较函数）内不能让出，继续运行到下次检查
+    if (current_run->preemptible && now >= current_run->slice_end && lua_isyieldable(L)) {
+        lua_yield(L, 0);
+    }
+}
+
+} // namespace
+
+PluginScheduler::PluginScheduler(lua_State* L) : L_(L) {}
+
+PluginScheduler::~PluginScheduler() {
+    // 先通知所有 worker 停止，再逐个等待线程退出。
+    // 任务的协程随 lua_State 一起回收，这里不再访问 L_
+    for (auto& handle : workers_) {
+        handle.worker->stop();
+    }
+    workers_.clear();
+}
+
+bool PluginScheduler::spawn(const std::string& label, const std::string& owner,
+                            const PushCall& push) {
+    return startTask(label, owner, push, true);
+}
+
+bool PluginScheduler::runNow(const std::string& label, const std::string& owner,
+                             const PushCall& push) {
+    return startTask(label, owner, push, false);
+}
+
+bool PluginScheduler::startTask(const std::string& label, const std::string& owner,
+                                const PushCall& push, bool preemptible) {
+    if (!L_) {
+        return false;
+    }
+
+    lua_State* thread = lua_newthread(L_);
+    int thread_ref = luaL_ref(L_, LUA_REGISTRYINDEX);
+    int nargs = push(thread);
+    if (nargs < 0) {
+        luaL_unref(L_, LUA_REGISTRYINDEX, thread_ref);
+        return false;
+    }
+    lua_sethook(thread, taskHook, LUA_MASKCOUNT, HOOK_INSTRUCTIONS);
+
+    Task task{thread_ref, thread, label, owner, {}, nargs};
+    if (resume(task, SPAWN_SLICE, preemptible)) {
+        finish(task);
+    } else {
+        tasks_.push_back(std::move(task));
+    }
+    return true;
+}
+
+bool PluginScheduler::resume(Task& task, std::chrono::steady_clock::duration slice,
+                             bool preemptible) {
+    auto start = std::chrono::steady_clock::now();
+    RunState run;
+    run.slice_end = start + slice;
+    run.has_hard_limit = task_timeout_ms_ > 0;
+    run.preemptible = preemptible;
+    run.hard_end = start + std::chrono::milliseconds(task_timeout_ms_) - task.elapsed;
+    run.timeout_ms = task_timeout_ms_;
+
+    RunState* outer = current_run;
+    current_run = &run;
+    int nargs = task.nargs;
+    task.nargs = 0;
+#if LUA_VERSION_NUM >= 504
+    int nresults = 0;
+    int status = lua_resume(task.thread, L_, nargs, &nresults);
+#else
+    int status = lua_resume(task.thread, L_, nargs);
+    int nresults = 0; // 钩子让出时不带值
+#endif
+    current_run = outer;
+    task.elapsed += std::chrono::steady_clock::now() - start;
+
+    if (status == LUA_YIELD) {
+        lua_pop(task.thread, nresults);
+        return false;
+    }
+    if (status != LUA_OK) {
+        const char* error = lua_tostring(task.thread, -1);
+        LOG_ERROR("Plugin task '" + task.label + "'" +
+                  (task.owner.empty() ? "" : " (" + task.owner + ")") +
+                  " error: " + std::string(error ? error : "unknown"));
+    }
+    return true;
+}
+
+void PluginScheduler::finish(Task& task) {
+    luaL_unref(L_, LUA_REGISTRYINDEX, task.thread_ref);
+}
+
+void PluginScheduler::tick() {
+    drainWorkers();
+    if (tasks_.empty()) {
+        return;
+    }
+
+    // 轮转：本帧开始时挂起的任务各运行一次，直到帧预算用完；
+    // 运行期间新建的任务已经跑过第一个时间片，留到下一帧
+    auto frame_end = std::chrono::steady_clock::now() + FRAME_BUDGET;
+    size_t count = tasks_.size();
+    for (size_t i = 0; i < count && !tasks_.empty(); ++i) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= frame_end) {
+            break;
+        }
+        Task task = std::move(tasks_.front());
+        tasks_.pop_front();
+        if (resume(task, frame_end - now)) {
+            finish(task);
+        } else {
+            tasks_.push_back(std::move(task));
+        }
+    }
+}
+
+bool PluginScheduler::hasPending() const {
+    return !tasks_.empty();
+}
+
+void PluginScheduler::cancelOwner(const std::string& owner) {
+    if (owner.empty()) {
+        return;
+    }
+    for (auto it = tasks_.begin(); it != tasks_.end();) {
+        if (it->owner == owner) {
+            finish(*it);
+            it = tasks_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (size_t i = workers_.size(); i > 0; --i) {
+        if (workers_[i - 1].owner == owner) {
+            workers_[i - 1].worker->stop();
+            releaseWorker(workers_.begin() + static_cast<std::ptrdiff_t>(i - 1));
+        }
+    }
+}
+
+int PluginScheduler::startWorker(const std::string& owner, const std::string& source,
+                                 int on_message_ref) {
+    if (workers_.size() >= MAX_WORKERS) {
+        LOG_WARNING("Plugin worker limit reached (" + std::to_string(MAX_WORKERS) + ")");
+        luaL_unref(L_, LUA_REGISTRYINDEX, on_message_ref);
+        return -1;
+    }
+
+    WorkerHandle handle;
+    handle.id = next_worker_id_++;
+    handle.owner = owner;
+    handle.on_message_ref = on_message_ref;
+    handle.worker = std::make_unique<PluginWorker>(source, wake_);
+    workers_.push_back(std::move(handle));
+    return workers_.back().id;
+}
+
+bool PluginScheduler::sendToWorker(int worker_id, const std::string& message) {
+    auto it = findWorker(worker_id);
+    if (it == workers_.end() || it->worker->finished()) {
+        return false;
+    }
+    it->worker->send(message);
+    return true;
+}
+
+bool PluginScheduler::stopWorker(int worker_id) {
+    auto it = findWorker(worker_id);
+    if (it == workers_.end()) {
+        return false;
+    }
+    it->worker->stop();
+    releaseWorker(it);
+    return true;
+}
+
+std::vector<PluginScheduler::WorkerHandle>::iterator PluginScheduler::findWorker(int worker_id) {
+    return std::find_if(workers_.begin(), workers_.end(), [worker_id](const WorkerHandle& handle) {
+        return handle.id == worker_id;
+    });
+}
+
+void PluginScheduler::releaseWorker(std::vector<WorkerHandle>::iterator it) {
+    if (L_ && it->on_message_ref != LUA_NOREF) {
+        luaL_unref(L_, LUA_REGISTRYINDEX, it->on_message_ref);
+    }
+    // 析构时等待线程退出（调用方已请求停止或线程已结束）
+    workers_.erase(it);
+}
+
+void PluginScheduler::drainWorkers() {
+    std::vector<int> ids;
+    ids.reserve(workers_.size());
+    for (const auto& handle : workers_) {
+        ids.push_back(handle.id);
+    }
+
+    for (int id : ids) {
+        auto it = findWorker(id);
+        if (it == workers_.end()) {
+            continue;
+        }
+        // 先读结束标志再取消息，保证 worker 退出前发出的最后几条消息不会丢
+        bool finished = it->worker->finished();
+        std::vector<std::string> messages = it->worker->takeOutbox();
+
+        for (const auto& message : messages) {
+            // on_message 回调可能停止 worker（甚至启动新的），每条消息前重新查找
+            it = findWorker(id);
+            if (it == workers_.end()) {
+                break;
+            }
+            int ref = it->on_message_ref;
+            std::string owner = it->owner;
+            spawn("worker " + std::to_string(id) + " message", owner,
+                  [ref, id, &message](lua_State* thread) -> int {
+                      lua_rawgeti(thread, LUA_REGISTRYINDEX, ref);
+                      if (!lua_isfunction(thread, -1)) {
+                          lua_pop(thread, 1);
+                          return -1;
+                      }
+                      lua_pushlstring(thread, message.data(), message.size());
+                      lua_pushinteger(thread, id);
+                      return 2;
+                  });
+        }
+
+        if (finished) {
+            it = findWorker(id);
+            if (it != workers_.end()) {
+                std::string error = it->worker->error();
+                if (!error.empty()) {
+                    LOG_ERROR("Plugin worker " + std::to_string(id) + " error: " + error);
+                }
+                releaseWorker(it);
+            }
+        }
+    }
+}
+
+PluginWorker::PluginWorker(std::string source, std::function<void()> notify)
+    : source_(std::move(source)), notify_(std::move(notify)) {
+    thread_ = std::thread(&PluginWorker::run, this);
+}
+
+PluginWorker::~PluginWorker() {
+    stop();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void PluginWorker::send(const std::string& message) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inbox_.push_back(message);
+    }
+    inbox_cv_.notify_one();
+}
+
+void PluginWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_.store(true);
+    }
+    inbox_cv_.notify_all();
+}
+
+std::vector<std::string> PluginWorker::takeOutbox() {
+    std::vector<std::string> messages;
+    std::lock_guard<std::mutex> lock(mutex_);
+    messages.swap(outbox_);
+    return messages;
+}
+
+std::string PluginWorker::error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+bool PluginWorker::waitForInbox(long long timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto ready = [this]() {
+        return !inbox_.empty() || stop_requested_.load();
+    };
+    if (timeout_ms < 0) {
+        inbox_cv_.wait(lock, ready);
+    } else {
+        inbox_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+    }
+    return !stop_requested_.load();
+}
+
+bool PluginWorker::popInbox(std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (inbox_.empty()) {
+        return false;
+    }
+    message = std::move(inbox_.front());
+    inbox_.pop_front();
+    return true;
+}
+
+void PluginWorker::run() {
+    lua_State* L = luaL_newstate();
+    if (!L) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = "failed to create Lua state";
+        }
+        finished_.store(true);
+        if (notify_) {
+            notify_();
+        }
+        return;
+    }
+    *static_cast<PluginWorker**>(lua_getextraspace(L)) = this;
+
+    // 与主状态相同的安全库子集；没有 io/os/package/debug，也没有编辑器 API
+    luaL_requiref(L, "_G", luaopen_base, 1);
+    lua_pop(L, 1);
+    luaL_requiref(L, LUA_MATHLIBNAME, luaopen_math, 1);
+    lua_pop(L, 1);
+    luaL_requiref(L, LUA_STRLIBNAME, luaopen_string, 1);
+    lua_pop(L, 1);
+    luaL_requiref(L, LUA_TABLIBNAME, luaopen_table, 1);
+    lua_pop(L, 1);
+    lua_register(L, "post", lua_post);
+    lua_register(L, "receive", lua_receive);
+    lua_register(L, "print", lua_print);
+    lua_sethook(L, stopHook, LUA_MASKCOUNT, HOOK_INSTRUCTIONS);
+
+    // 只接受文本代码，不加载预编译字节码
+    int status = luaL_loadbufferx(L, source_.data(), source_.size(), "=worker", "t");
+    if (status == LUA_OK) {
+        status = lua_pcall(L, 0, 0, 0);
+    }
+    if (status != LUA_OK && !stop_requested_.load()) {
+        const char* error = lua_tostring(L, -1);
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = error ? error : "unknown";
+    }
+    lua_close(L);
+
+    finished_.store(true);
+    if (notify_) {
+        notify_();
+    }
+}
+
+PluginWorker* PluginWorker::fromLua(lua_State* L) {
+    return *static_cast<PluginWorker**>(lua_getextraspace(L));
+}
+
+int PluginWorker::lua_post(lua_State* L) {
+    PluginWorker* worker = fromLua(L);
+    size_t length = 0;
+    const char* message = luaL_checklstring(L, 1, &length);
+    bool was_empty = false;
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex_);
+        was_empty = worker->outbox_.empty();
+        worker->outbox_.emplace_back(message, length);
+    }
+    // 主线程取走之前的消息会一起处理，只在发件箱由空变非空时唤醒一次
+    if (was_empty && worker->notify_) {
+        worker->notify_();
+    }
+    return 0;
+}
+
+int PluginWorker::lua_receive(lua_State* L) {
+    PluginWorker* worker = fromLua(L);
+    lua_Integer timeout_ms = luaL_optinteger(L, 1, -1);
+    if (!worker->waitForInbox(static_cast<long long>(timeout_ms))) {
+        return luaL_error(L, "worker stopped");
+    }
+    std::string message;
+    if (!worker->popInbox(message)) {
+        lua_pushnil(L);
+        return 1;
+    }
+    lua_pushlstring(L, message.data(), message.size());
+    return 1;
+}
+
+int PluginWorker::lua_print(lua_State* L) {
+    // 默认 print 写 stdout 会弄乱终端界面，与主状态一样转到日志
+    int n = lua_gettop(L);
+    std::string message;
+    for (int i = 1; i <= n; ++i) {
+        if (i > 1) {
+            message += " ";
+        }
+        size_t length = 0;
+        const char* text = luaL_tolstring(L, i, &length);
+        message.append(text, length);
+        lua_pop(L, 1);
+    }
+    LOG("[Lua worker] " + message);
+    return 0;
+}
+
+void PluginWorker::stopHook(lua_State* L, lua_Debug* ar) {
+    (void)ar;
+    if (fromLua(L)->stop_requested_.load()) {
+        luaL_error(L, "worker stopped");
+    }
+}
+
+} // namespace plugins
+} // namespace pnana
+
+#endif // BUILD_LUA_SUPPORT
@@ -4,12 +4,11 @@
 #include "core/editor.h"
 #include "plugins/lua_api.h"
 #include "utils/logger.h"
+#include "utils/process_executor.h"
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
-#include <fstream>
-#include <future>
 #include <lua.hpp>
 #include <memory>
 #include <sstream>
@@ -41,6 +40,8 @@ void SystemAPI::registerFunctions(lua_State* L) {
     lua_setfield(L, -2, "systemlist");
     lua_pushcfunction(L, lua_fn_systemlist_async);
     lua_setfield(L, -2, "systemlist_async");
+    lua_pushcfunction(L, lua_fn_systemlist_cancel);
+    lua_setfield(L, -2, "systemlist_cancel");
     lua_pushcfunction(L, lua_fn_hrtime);
     lua_setfield(L, -2, "hrtime");
 
@@ -88,6 +89,18 @@ void SystemAPI::registerFunctions(lua_State* L) {
     lua_setfield(L, -2, "defer_fn");
     lua_pushcfunction(L, lua_fn_defer_cancel);
     lua_setfield(L, -2, "defer_cancel");
+    lua_pushcfunction(L, lua_fn_schedule);
+    lua_setfield(L, -2, "schedule");
+
+    // 注册 vim.worker 表
+    lua_newtable(L);
+    lua_pushcfunction(L, lua_fn_worker_start);
+    lua_setfield(L, -2, "start");
+    lua_pushcfunction(L, lua_fn_worker_send);
+    lua_setfield(L, -2, "send");
+    lua_pushcfunction(L, lua_fn_worker_stop);
+    lua_setfield(L, -2, "stop");
+    lua_setfield(L, -2, "worker");
 
     lua_pop(L, 1); // 弹出 vim 表
 
@@ -247,67 +260,31 @@ int SystemAPI::lua_fn_systemlist(lua_State* L) {
         return 2;
     }
 
-    // 将参数安全拼接为 shell 命令（单引号转义）
-    auto shell_escape = [](const std::string& s) {
-        std::string out;
-        out.reserve(s.size() + 8);
-        out.push_back('\'');
-        for (char c : s) {
-            if (c == '\'') {
-                out += "'\\''";
-            } else {
-                out.push_back(c);
-            }
-        }
-        out.push_back('\'');
-        return out;
-    };
-
-    std::string full_cmd = "cd " + shell_escape(effective_cwd) + " && ";
-    for (size_t i = 0; i < argv.size(); ++i) {
-        if (i > 0)
-            full_cmd += " ";
-        full_cmd += shell_escape(argv[i]);
-    }
-
-    // 限制输出大小：重定向到临时文件再读取限定字节
-    std::string tmp_file =
-        "/tmp/pnana_rg_" + std::to_string(std::rand()) + "_" +
-        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".out";
-    std::string cmd_with_redirect = full_cmd + " > " + shell_escape(tmp_file) + " 2>&1";
-
-    auto runner = [cmd_with_redirect]() {
-        return std::system(cmd_with_redirect.c_str());
-    };
-
-    auto fut = std::async(std::launch::async, runner);
-    if (fut.wait_for(std::chrono::milliseconds(timeout_ms)) != std::future_status::ready) {
-        std::remove(tmp_file.c_str());
+    // 经子进程执行服务运行：超时即终止 rg，超过上限的输出在读取时丢弃
+    utils::ProcessRequest request;
+    request.argv = argv;
+    request.cwd = effective_cwd;
+    request.timeout_ms = timeout_ms;
+    request.max_output_bytes = max_output_bytes;
+    utils::ProcessResult result = utils::ProcessExecutor::getInstance().run(std::move(request));
+    if (result.timed_out) {
         LOG_DEBUG("[vim.fn.systemlist] TIMEOUT after " + std::to_string(timeout_ms) + "ms");
         lua_pushnil(L);
         lua_pushstring(L, "systemlist timeout");
         return 2;
     }
+    if (!result.spawned) {
+        lua_pushnil(L);
+        lua_pushstring(L, result.error.c_str());
+        return 2;
+    }
 
     auto exec_end = std::chrono::high_resolution_clock::now();
     auto exec_ms =
         std::chrono::duration_cast<std::chrono::milliseconds>(exec_end - exec_start).count();
     LOG_DEBUG("[vim.fn.systemlist] EXEC COMPLETED in " + std::to_string(exec_ms) + "ms");
 
-    std::ifstream in(tmp_file, std::ios::binary);
-    if (!in.is_open()) {
-        lua_pushnil(L);
-        lua_pushstring(L, "failed to read command output");
-        return 2;
-    }
-
-    std::string output;
-    output.resize(max_output_bytes);
-    in.read(&output[0], static_cast<std::streamsize>(max_output_bytes));
-    std::streamsize got = in.gcount();
-    output.resize(static_cast<size_t>(got));
-    in.close();
-    std::remove(tmp_file.c_str());
+    std::string output = std::move(result.output);
 
     // 计算行数
     int line_count = 0;
@@ -338,7 +315,7 @@ int SystemAPI::lua_fn_systemlist(lua_State* L) {
 }
 
 // vim.fn.systemlist_async(argv, opts, callback) -> request_id
-// 异步非阻塞执行，回调接收 (lines, error)
+// 异步非阻塞执行，回调接收 (lines, error)；request_id 可传给 vim.fn.systemlist_cancel
 int SystemAPI::lua_fn_systemlist_async(lua_State* L) {
     if (!lua_istable(L, 1) || !lua_isfunction(L, 3)) {
         lua_pushnil(L);
@@ -407,102 +384,80 @@ int SystemAPI::lua_fn_systemlist_async(lua_State* L) {
         lua_pop(L, 1);
     }
 
+    if (timeout_ms < 50)
+        timeout_ms = 50;
+    if (timeout_ms > 10000)
+        timeout_ms = 10000;
+    if (max_output_bytes > 4 * 1024 * 1024)
+        max_output_bytes = 4 * 1024 * 1024;
+
     // 创建 callback 引用
     lua_pushvalue(L, 3);
     int callback_ref = luaL_ref(L, LUA_REGISTRYINDEX);
 
-    // 生成 request_id
-    static int s_request_counter = 0;
-    int request_id = ++s_request_counter;
-
-    // 在后台线程执行
-    std::thread([argv, cwd, timeout_ms, max_output_bytes, callback_ref, request_id, lua_api]() {
-        // 构建命令
-        auto shell_escape = [](const std::string& s) {
-            std::string out;
-            out.reserve(s.size() + 8);
-            out.push_back('\'');
-            for (char c : s) {
-                if (c == '\'') {
-                    out += "'\\''";
-                } else {
-                    out.push_back(c);
-                }
-            }
-            out.push_back('\'');
-            return out;
-        };
-
-        std::string full_cmd;
-        for (size_t i = 0; i < argv.size(); ++i) {
-            if (i > 0)
-                full_cmd += " ";
-            full_cmd += shell_escape(argv[i]);
-        }
-
-        std::string tmp_file =
-            "/tmp/pnana_rg_async_" + std::to_string(request_id) + "_" +
-            std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".out";
-        std::string cmd_with_redirect = "cd " + shell_escape(cwd) + " && " + full_cmd + " > " +
-                                        shell_escape(tmp_file) + " 2>&1";
-
-        [[maybe_unused]] int ret = std::system(cmd_with_redirect.c_str());
-
-        // 读取结果
-        std::ifstream in(tmp_file, std::ios::binary);
-        std::string output;
-        if (in.is_open()) {
-            output.resize(max_output_bytes);
-            in.read(&output[0], static_cast<std::streamsize>(max_output_bytes));
-            std::streamsize got = in.gcount();
-            output.resize(static_cast<size_t>(got));
-            in.close();
-        }
-        std::remove(tmp_file.c_str());
-
-        // 使用 Editor::postToMainThread 在主线程调用 Lua 回调
-        auto* editor = lua_api->getEditor();
-        if (!editor)
+    // 由子进程执行服务运行，不为每次调用创建线程；结果经 UI 分发回到主线程，
+    // 回调 callback(lines, err) 在插件调度器的协程中运行
+    utils::ProcessRequest request;
+    request.argv = argv;
+    if (cwd != ".") {
+        request.cwd = cwd;
+    }
+    request.timeout_ms = timeout_ms;
+    request.max_output_bytes = max_output_bytes;
+    request.post_to_ui = true;
+    auto on_done = [callback_ref, lua_api](const utils::ProcessResult& result) {
+        lua_State* L = lua_api->getEngine()->getState();
+        PluginScheduler* scheduler = lua_api->getScheduler();
+        if (!L || !scheduler)
             return;
 
-        editor->postToMainThread([callback_ref, output, request_id, lua_api]() {
-            lua_State* L = lua_api->getEngine()->getState();
-            if (!L)
-                return;
-
-            lua_rawgeti(L, LUA_REGISTRYINDEX, callback_ref);
-            if (!lua_isfunction(L, -1)) {
-                lua_pop(L, 1);
-                luaL_unref(L, LUA_REGISTRYINDEX, callback_ref);
-                return;
+        scheduler->spawn("systemlist_async", "", [callback_ref, &result](lua_State* thread) {
+            lua_rawgeti(thread, LUA_REGISTRYINDEX, callback_ref);
+            if (!lua_isfunction(thread, -1)) {
+                lua_pop(thread, 1);
+                return -1;
             }
 
-            // 构建 lines table
-            lua_newtable(L);
-            std::stringstream ss(output);
+            lua_newtable(thread);
+            std::stringstream ss(result.output);
             std::string line;
             int idx = 1;
             while (std::getline(ss, line)) {
-                lua_pushstring(L, line.c_str());
-                lua_rawseti(L, -2, idx++);
+                lua_pushstring(thread, line.c_str());
+                lua_rawseti(thread, -2, idx++);
             }
 
-            // 调用回调：callback(lines, nil)
-            if (lua_pcall(L, 1, 0, 0) != LUA_OK) {
-                const char* error = lua_tostring(L, -1);
-                LOG_ERROR("[vim.fn.systemlist_async] Callback error: " +
-                          std::string(error ? error : "unknown"));
-                lua_pop(L, 1);
+            if (result.timed_out) {
+                lua_pushstring(thread, "systemlist timeout");
+            } else if (result.cancelled) {
+                lua_pushstring(thread, "cancelled");
+            } else if (!result.spawned) {
+                lua_pushstring(thread, result.error.c_str());
+            } else {
+                lua_pushnil(thread);
             }
-
-            luaL_unref(L, LUA_REGISTRYINDEX, callback_ref);
+            return 2;
         });
-    }).detach();
+
+        luaL_unref(L, LUA_REGISTRYINDEX, callback_ref);
+    };
+    utils::ProcessExecutor::JobId request_id =
+        utils::ProcessExecutor::getInstance().submit(std::move(request), on_done);
 
     lua_pushinteger(L, static_cast<lua_Integer>(request_id));
     return 1;
 }
 
+// vim.fn.systemlist_cancel(request_id) -> boolean
+// 取消尚未完成的 systemlist_async，回调随后收到 (lines, "cancelled")
+int SystemAPI::lua_fn_systemlist_cancel(lua_State* L) {
+    lua_Integer id = luaL_checkinteger(L, 1);
+    bool cancelled = id > 0 && utils::ProcessExecutor::getInstance().cancel(
+                                   static_cast<utils::ProcessExecutor::JobId>(id));
+    lua_pushboolean(L, cancelled);
+    return 1;
+}
+
 // pnana_notify(message, level)
 int SystemAPI::lua_fn_notify(lua_State* L) {
     const char* message = lua_tostring(L, 1);
@@ -862,6 +817,75 @@ int SystemAPI::lua_fn_defer_cancel(lua_State* L) {
     return 1;
 }
 
+// vim.schedule(fn)：在下一帧由调度器运行 fn
+int SystemAPI::lua_fn_schedule(lua_State* L) {
+    LuaAPI* lua_api = getLuaAPIFromLua(L);
+    if (!lua_api || !lua_isfunction(L, 1)) {
+        lua_pushnil(L);
+        lua_pushstring(L, "invalid arguments");
+        return 2;
+    }
+
+    lua_pushvalue(L, 1);
+    int callback_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_api->deferFunction(callback_ref, 0);
+    return 0;
+}
+
+// vim.worker.start(source, on_message) -> worker_id
+// source 在独立线程、独立 lua_State 中运行，只有安全标准库和 post(msg)/receive([timeout_ms])；
+// worker 每 post 一条消息，主状态中调用一次 on_message(msg, worker_id)
+int SystemAPI::lua_fn_worker_start(lua_State* L) {
+    LuaAPI* lua_api = getLuaAPIFromLua(L);
+    if (!lua_api || !lua_isstring(L, 1) || !lua_isfunction(L, 2)) {
+        lua_pushnil(L);
+        lua_pushstring(L, "invalid arguments");
+        return 2;
+    }
+
+    size_t length = 0;
+    const char* source = lua_tolstring(L, 1, &length);
+    lua_pushvalue(L, 2);
+    int callback_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+
+    int worker_id = lua_api->startWorker(std::string(source, length), callback_ref);
+    if (worker_id < 0) {
+        lua_pushnil(L);
+        lua_pushstring(L, "worker limit reached");
+        return 2;
+    }
+    lua_pushinteger(L, static_cast<lua_Integer>(worker_id));
+    return 1;
+}
+
+// vim.worker.send(worker_id, msg) -> boolean
+int SystemAPI::lua_fn_worker_send(lua_State* L) {
+    LuaAPI* lua_api = getLuaAPIFromLua(L);
+    if (!lua_api || !lua_isnumber(L, 1) || !lua_isstring(L, 2)) {
+        lua_pushboolean(L, false);
+        return 1;
+    }
+
+    size_t length = 0;
+    const char* message = lua_tolstring(L, 2, &length);
+    bool sent = lua_api->sendToWorker(static_cast<int>(lua_tointeger(L, 1)),
+                                      std::string(message, length));
+    lua_pushboolean(L, sent);
+    return 1;
+}
+
+// vim.worker.stop(worker_id) -> boolean
+int SystemAPI::lua_fn_worker_stop(lua_State* L) {
+    LuaAPI* lua_api = getLuaAPIFromLua(L);
+    if (!lua_api || !lua_isnumber(L, 1)) {
+        lua_pushboolean(L, false);
+        return 1;
+    }
+
+    lua_pushboolean(L, lua_api->stopWorker(static_cast<int>(lua_tointeger(L, 1))));
+    return 1;
+}
+
 // vim.fn.hrtime() -> nanoseconds (number)
 // 返回高精度时间（纳秒），用于性能分析
 int SystemAPI::lua_fn_hrtime(lua_State* L) {
@@ -3,6 +3,7 @@
 #include "features/ai_client/ai_client.h"
 #endif
 #include "ui/icons.h"
+#include "utils/text_utils.h"
 #include <algorithm>
 #include <cstdio>
 #include <filesystem>
@@ -41,7 +42,7 @@ namespace ui {
 
 AIAssistantPanel::AIAssistantPanel(Theme& theme)
     : theme_(theme), visible_(false), cursor_pos_(0), selected_message_index_(0), scroll_offset_(0),
-      estimated_total_lines_(0), is_streaming_(false), current_focus_(FocusArea::INPUT),
+      total_lines_(0), is_streaming_(false), current_focus_(FocusArea::INPUT),
       selected_button_index_(0), panel_width_(40) {
     // 初始化组件
     input_component_ = Input(&current_input_, "Ask me anything about your code...");
@@ -117,8 +118,10 @@ void AIAssistantPanel::hide() {
 
 void AIAssistantPanel::addMessage(const ChatMessage& message) {
     messages_.push_back(message);
+    layouts_.emplace_back();
     if (messages_.size() > MAX_VISIBLE_MESSAGES) {
         messages_.erase(messages_.begin());
+        layouts_.erase(layouts_.begin());
     }
     // 自动滚动到底部（按行滚动时在下次 render 中会 clamp 到 max_scroll）
     scroll_offset_ = 999999;
@@ -142,6 +145,7 @@ void AIAssistantPanel::addErrorMessage(const std::string& content) {
 
 void AIAssistantPanel::clearMessages() {
     messages_.clear();
+    layouts_.clear();
     scroll_offset_ = 0;
 }
 
@@ -153,6 +157,10 @@ void AIAssistantPanel::startStreamingResponse(const std::string& model) {
 
 void AIAssistantPanel::appendStreamingContent(const std::string& content) {
     if (is_streaming_ && !messages_.empty()) {
+        // 停在底部时跟随新内容；用户向上翻看时保持位置
+        if (scroll_offset_ >= maxScrollOffset()) {
+            scroll_offset_ = 999999;
+        }
         messages_.back().content += content;
         messages_.back().is_streaming = true;
     }
@@ -286,7 +294,7 @@ Element AIAssistantPanel::renderMessages() {
     Elements message_elements;
 
     if (messages_.empty()) {
-        estimated_total_lines_ = 0;
+        total_lines_ = 0;
         message_elements.push_back(
             vbox({hbox({text("Welcome to AI Assistant! ") | color(colors.success) | bold,
                         text(icons::CODE) | color(colors.success)}) |
@@ -304,40 +312,82 @@ Element AIAssistantPanel::renderMessages() {
                   text("Or just type natural language requests!") | color(colors.comment) | dim}) |
             center);
     } else {
-        // 按行滚动：估算总行数（每条消息：1 行头部 + 内容按 panel 宽度折行）
-        int total_lines = 0;
         int content_width = std::max(1, panel_width_ - 2);
-        for (const auto& msg : messages_) {
-            total_lines += 1; // 头部
-            total_lines += std::max(
-                1, static_cast<int>((msg.content.size() + content_width - 1) / content_width));
-            total_lines += 1; // 与下一条之间的分隔
+        std::vector<int> row_counts(messages_.size());
+        int total_lines = 0;
+        for (size_t i = 0; i < messages_.size(); ++i) {
+            row_counts[i] = messageRowCount(i, content_width);
+            total_lines += row_counts[i] + 1; // 与下一条之间的分隔
         }
-        if (!messages_.empty())
-            total_lines -= 1; // 最后一条后无分隔
-        estimated_total_lines_ = std::max(0, total_lines);
+        total_lines_ = std::max(0, total_lines - 1); // 最后一条后无分隔
 
         // 限制滚动范围，避免超出底部
-        int max_scroll = std::max(0, estimated_total_lines_ - MESSAGE_VIEWPORT_LINES);
-        scroll_offset_ = std::clamp(scroll_offset_, 0, max_scroll);
-
-        // 顶部空白占位：相当于“跳过” scroll_offset_ 行，实现按行滚动
-        if (scroll_offset_ > 0) {
-            message_elements.push_back(text("") | size(HEIGHT, EQUAL, scroll_offset_));
+        scroll_offset_ = std::clamp(scroll_offset_, 0, maxScrollOffset());
+
+        // 只生成与可见区域相交的行
+        int first = scroll_offset_;
+        int last = scroll_offset_ + viewportLines();
+        int row = 0;
+        for (size_t i = 0; i < messages_.size() && row < last; ++i) {
+            int end_row = row + row_counts[i];
+            if (end_row > first) {
+                renderMessageRows(i, content_width, first - row, last - row, message_elements);
+            }
+            if (i + 1 < messages_.size() && end_row >= first && end_row < last) {
+                message_elements.push_back(separatorLight());
+            }
+            row = end_row + 1;
         }
+    }
 
-        for (size_t i = 0; i < messages_.size(); ++i) {
-            message_elements.push_back(renderMessage(messages_[i]));
-            if (i < messages_.size() - 1) {
-                message_elements.push_back(separatorLight());
+    return vbox(std::move(message_elements)) | flex | reflect(messages_box_);
+}
+
+const AIAssistantPanel::MessageLayout& AIAssistantPanel::layoutMessage(size_t index, int width) {
+    const ChatMessage& message = messages_[index];
+    MessageLayout& layout = layouts_[index];
+    const std::string& content = message.content;
+
+    if (message.is_streaming) {
+        if (layout.width == width && !layout.lines.empty() &&
+            layout.content_size <= content.size()) {
+            if (layout.content_size < content.size()) {
+                // 只追加：前面的行不变，从最后一行的起始位置重新折行
+                size_t from = layout.line_starts.back();
+                layout.lines.pop_back();
+                layout.line_starts.pop_back();
+                utils::wrapByDisplayWidth(content, from, width, layout.lines, layout.line_starts);
+                layout.content_size = content.size();
             }
+            return layout;
+        }
+        layout.content_hash = 0;
+    } else {
+        size_t hash = std::hash<std::string>{}(content);
+        if (layout.width == width && layout.content_size == content.size() &&
+            layout.content_hash == hash) {
+            return layout;
         }
+        layout.content_hash = hash;
     }
 
-    return yframe(vbox(std::move(message_elements))) | flex;
+    layout.width = width;
+    layout.content_size = content.size();
+    layout.lines.clear();
+    layout.line_starts.clear();
+    utils::wrapByDisplayWidth(content, 0, width, layout.lines, layout.line_starts);
+    return layout;
 }
 
-Element AIAssistantPanel::renderMessage(const ChatMessage& message) {
+int AIAssistantPanel::messageRowCount(size_t index, int width) {
+    int rows = 1 + static_cast<int>(layoutMessage(index, width).lines.size());
+    if (messages_[index].is_streaming) {
+        rows += static_cast<int>(renderMessageStatus().size());
+    }
+    return rows;
+}
+
+Element AIAssistantPanel::renderMessageHeader(const ChatMessage& message) {
     auto& colors = theme_.getColors();
 
     // 消息头部（时间戳和发送者）
@@ -371,50 +421,74 @@ Element AIAssistantPanel::renderMessage(const ChatMessage& message) {
 
     header_elements.push_back(text(" " + sender_icon) | color(sender_color));
 
-    Element header = hbox(std::move(header_elements));
+    return hbox(std::move(header_elements));
+}
 
-    // 消息内容（使用 paragraph 使过长内容自动换行）
-    std::string content = message.content;
+// 流式输出时消息下方的状态行（每行一个元素）
+Elements AIAssistantPanel::renderMessageStatus() {
+    auto& colors = theme_.getColors();
+    Elements status_elements;
+    status_elements.push_back(hbox({text("🤖 AI is thinking") | color(colors.comment) | dim,
+                                    text("...") | color(colors.success) | bold}) |
+                              center);
 
-    // 处理流式输出
-    if (message.is_streaming) {
-        static int cursor_frame = 0;
-        cursor_frame = (cursor_frame + 1) % 4;
-        std::string cursors[] = {"|", "/", "-", "\\"};
-        content += " " + std::string(cursors[cursor_frame]);
+    // 如果有工具调用信息，显示工具使用状态
+#ifdef BUILD_AI_CLIENT_SUPPORT
+    if (!current_tool_calls_.empty()) {
+        status_elements.push_back(text("🔧 Using tools:") | color(colors.keyword) | center);
+        for (const auto& tool_call : current_tool_calls_) {
+            status_elements.push_back(
+                hbox(ftxui::Elements{
+                    ftxui::text("  • ") | color(colors.comment),
+                    ftxui::text(tool_call.function_name) | color(colors.function) | bold}) |
+                center);
+        }
     }
+#endif
 
-    Element content_el = paragraph(content) | color(colors.foreground);
-    // flex 占满可用宽度，paragraph 会按容器宽度自动换行
-    Element message_content = vbox({content_el}) | flex;
+    return status_elements;
+}
 
-    Elements message_parts = {std::move(header), std::move(message_content)};
+void AIAssistantPanel::renderMessageRows(size_t index, int width, int first_row, int last_row,
+                                         Elements& rows) {
+    auto& colors = theme_.getColors();
+    const ChatMessage& message = messages_[index];
+    const MessageLayout& layout = layoutMessage(index, width);
+    first_row = std::max(first_row, 0);
+
+    int row = 0;
+    if (first_row <= row && row < last_row) {
+        rows.push_back(renderMessageHeader(message));
+    }
+    row += 1;
+
+    // 消息内容：按缓存的折行结果逐行输出，只构造可见的行
+    int line_count = static_cast<int>(layout.lines.size());
+    int begin = std::clamp(first_row - row, 0, line_count);
+    int end = std::clamp(last_row - row, 0, line_count);
+    for (int i = begin; i < end; ++i) {
+        Element line = text(layout.lines[i]) | color(colors.foreground);
+        // 流式输出：在最后一行末尾显示旋转光标
+        if (message.is_streaming && i == line_count - 1) {
+            static int cursor_frame = 0;
+            cursor_frame = (cursor_frame + 1) % 4;
+            const char* cursors[] = {"|", "/", "-", "\\"};
+            line = hbox({line, text(std::string(" ") + cursors[cursor_frame])});
+        }
+        rows.push_back(line);
+    }
+    row += line_count;
 
     // 如果是流式输出，添加状态指示器
     if (message.is_streaming) {
-        Elements status_elements;
-        status_elements.push_back(hbox({text("🤖 AI is thinking") | color(colors.comment) | dim,
-                                        text("...") | color(colors.success) | bold}) |
-                                  center);
-
-        // 如果有工具调用信息，显示工具使用状态
-#ifdef BUILD_AI_CLIENT_SUPPORT
-        if (!current_tool_calls_.empty()) {
-            status_elements.push_back(text("🔧 Using tools:") | color(colors.keyword) | center);
-            for (const auto& tool_call : current_tool_calls_) {
-                status_elements.push_back(
-                    hbox(ftxui::Elements{
-                        ftxui::text("  • ") | color(colors.comment),
-                        ftxui::text(tool_call.function_name) | color(colors.function) | bold}) |
-                    center);
+        Elements status_elements = renderMessageStatus();
+        for (auto& element : status_elements) {
+            if (first_row <= row && row < last_row) {
+                rows.push_back(std::move(element));
             }
+            row += 1;
         }
-#endif
-
-        message_parts.push_back(vbox(std::move(status_elements)));
     }
-
-    return vbox(std::move(message_parts));
 }
 
 Element AIAssistantPanel::renderInput() {
@@ -1317,8 +1391,7 @@ bool AIAssistantPanel::handleInput(Event event) {
         }
     } else if (event == Event::ArrowDown) {
         if (current_focus_ == FocusArea::MESSAGES) {
-            int max_scroll = std::max(0, estimated_total_lines_ - MESSAGE_VIEWPORT_LINES);
-            if (scroll_offset_ >= max_scroll) {
+            if (scroll_offset_ >= maxScrollOffset()) {
                 current_focus_ = FocusArea::BUTTONS;
                 selected_button_index_ = 0;
             } else {
@@ -1343,8 +1416,7 @@ bool AIAssistantPanel::handleInput(Event event) {
         return true;
     } else if (event == Event::PageDown) {
         // PageDown：按可见高度一页向下滚动
-        int max_scroll = std::max(0, estimated_total_lines_ - MESSAGE_VIEWPORT_LINES);
-        scroll_offset_ = std::min(max_scroll, scroll_offset_ + SCROLL_PAGE_LINES);
+        scroll_offset_ = std::min(maxScrollOffset(), scroll_offset_ + SCROLL_PAGE_LINES);
         return true;
     } else if (event == Event::Character('-')) {
         // 缩小 AI 面板宽度
@@ -1737,8 +1809,19 @@ void AIAssistantPanel::scrollUp() {
 }
 
 void AIAssistantPanel::scrollDown() {
-    int max_scroll = std::max(0, estimated_total_lines_ - MESSAGE_VIEWPORT_LINES);
-    scroll_offset_ = std::min(max_scroll, scroll_offset_ + 1);
+    scroll_offset_ = std::min(maxScrollOffset(), scroll_offset_ + 1);
+}
+
+int AIAssistantPanel::viewportLines() const {
+    // 首帧布局之前 messages_box_ 还是默认值
+    if (messages_box_.y_max <= messages_box_.y_min) {
+        return MESSAGE_VIEWPORT_LINES;
+    }
+    return messages_box_.y_max - messages_box_.y_min + 1;
+}
+
+int AIAssistantPanel::maxScrollOffset() const {
+    return std::max(0, total_lines_ - viewportLines());
 }
 
 } // namespace ui
@@ -1,20 +1,603 @@
 #include "ui/binary_file_view.h"
 #include "ui/icons.h"
+#include "utils/file_info_utils.h"
+#include <algorithm>
+#include <cstdio>
 #include <filesystem>
+#include <ftxui/component/mouse.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <vector>
 
 using namespace ftxui;
 
 namespace pnana {
 namespace ui {
 
-BinaryFileView::BinaryFileView(Theme& theme) : theme_(theme) {}
+namespace {
+
+// 第一帧尚未测量字节区域时使用的行数
+constexpr int DEFAULT_VISIBLE_ROWS = 24;
+
+enum class ByteClass { ZERO, PRINTABLE, OTHER, MODIFIED, MATCH, CURSOR };
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+std::string toHex(uint64_t value, int width) {
+    char buffer[24];
+    std::snprintf(buffer, sizeof(buffer), "%0*llx", width, static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool isPrintable(uint8_t byte) {
+    return byte >= 0x20 && byte < 0x7f;
+}
+
+} // namespace
+
+BinaryFileView::BinaryFileView(Theme& theme)
+    : theme_(theme), search_shared_(std::make_shared<SearchShared>()) {}
+
+BinaryFileView::~BinaryFileView() {
+    // 先断开投递，会话析构时再等待搜索线程结束
+    std::lock_guard<std::mutex> lock(search_shared_->mutex);
+    search_shared_->dispatcher = nullptr;
+}
+
+void BinaryFileView::setUIDispatcher(UIDispatcher dispatcher) {
+    std::lock_guard<std::mutex> lock(search_shared_->mutex);
+    search_shared_->dispatcher = std::move(dispatcher);
+}
 
 void BinaryFileView::setFilePath(const std::string& filepath) {
+    if (active_ && filepath == filepath_) {
+        active_->last_used = ++use_counter_;
+        return;
+    }
     filepath_ = filepath;
+    auto it = sessions_.find(filepath);
+    if (it == sessions_.end()) {
+        auto session = std::make_unique<Session>();
+        session->buffer.open(filepath); // 失败时渲染提示界面并显示原因
+        it = sessions_.emplace(filepath, std::move(session)).first;
+    }
+    active_ = it->second.get();
+    active_->last_used = ++use_counter_;
+    dropIdleSessions();
+}
+
+void BinaryFileView::dropIdleSessions() {
+    // 只回收没有补丁、没有进行中搜索的会话（解除映射）
+    while (sessions_.size() > MAX_IDLE_SESSIONS + 1) {
+        auto victim = sessions_.end();
+        for (auto it = sessions_.begin(); it != sessions_.end(); ++it) {
+            Session* session = it->second.get();
+            if (session == active_ || session->buffer.hasPatches() || session->search.isRunning()) {
+                continue;
+            }
+            if (victim == sessions_.end() || session->last_used < victim->second->last_used) {
+                victim = it;
+            }
+        }
+        if (victim == sessions_.end()) {
+            break;
+        }
+        sessions_.erase(victim);
+    }
+}
+
+bool BinaryFileView::hasUnsavedPatches() const {
+    return active_ && active_->buffer.hasPatches();
+}
+
+bool BinaryFileView::save(std::string& message) {
+    if (!active_ || !active_->buffer.isOpen()) {
+        message = "Binary file is not open";
+        return false;
+    }
+    Session& session = *active_;
+    if (!session.buffer.hasPatches()) {
+        message = "No changes to save (press p to patch bytes)";
+        return true;
+    }
+    size_t pages = 0;
+    if (!session.buffer.save(&pages)) {
+        message = "Failed to save patches: " + session.buffer.getLastError();
+        return false;
+    }
+    session.low_nibble = false;
+    message = "Wrote " + std::to_string(pages) + " modified page(s) to " +
+              std::filesystem::path(filepath_).filename().string();
+    session.message = message;
+    return true;
+}
+
+int BinaryFileView::visibleRows(const Session& session) const {
+    const Box& box = session.rows_box;
+    if (box.y_max <= box.y_min) {
+        return DEFAULT_VISIBLE_ROWS;
+    }
+    return box.y_max - box.y_min + 1;
+}
+
+void BinaryFileView::scrollToCursor(Session& session) {
+    const uint64_t row = session.cursor / BYTES_PER_ROW;
+    const uint64_t rows = static_cast<uint64_t>(visibleRows(session));
+    if (row < session.top_row) {
+        session.top_row = row;
+    } else if (row >= session.top_row + rows) {
+        session.top_row = row - rows + 1;
+    }
+}
+
+void BinaryFileView::moveCursor(Session& session, int64_t delta) {
+    const uint64_t size = session.buffer.size();
+    if (size == 0) {
+        return;
+    }
+    if (delta < 0) {
+        uint64_t distance = static_cast<uint64_t>(-delta);
+        session.cursor = distance > session.cursor ? 0 : session.cursor - distance;
+    } else {
+        session.cursor = std::min(size - 1, session.cursor + static_cast<uint64_t>(delta));
+    }
+    session.low_nibble = false;
+    scrollToCursor(session);
+}
+
+void BinaryFileView::startSearch(Session& session, uint64_t from) {
+    const uint64_t generation = ++session.search_generation;
+    session.message.clear();
+    std::shared_ptr<SearchShared> shared = search_shared_;
+    std::string path = filepath_;
+    session.search.start(
+        session.buffer, session.pattern, from,
+        [this, shared, path, generation](int64_t offset, bool cancelled) {
+            if (cancelled) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            if (!shared->dispatcher) {
+                return;
+            }
+            shared->dispatcher([this, path, generation, offset]() {
+                auto it = sessions_.find(path);
+                if (it == sessions_.end() || it->second->search_generation != generation) {
+                    return;
+                }
+                Session& s = *it->second;
+                if (offset < 0) {
+                    s.match = -1;
+                    s.message = "Pattern not found";
+                    return;
+                }
+                s.match = offset;
+                s.cursor = static_cast<uint64_t>(offset);
+                s.low_nibble = false;
+                scrollToCursor(s);
+                s.message = "Found at 0x" + toHex(static_cast<uint64_t>(offset), 1);
+            });
+        });
+}
+
+bool BinaryFileView::parseOffset(const std::string& input, uint64_t cursor, uint64_t& offset) {
+    std::string text = trim(input);
+    int sign = 0;
+    if (!text.empty() && (text[0] == '+' || text[0] == '-')) {
+        sign = text[0] == '+' ? 1 : -1;
+        text = trim(text.substr(1));
+    }
+    int base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text = text.substr(2);
+    } else if (!text.empty() && (text.back() == 'h' || text.back() == 'H')) {
+        base = 16;
+        text.pop_back();
+    }
+    if (text.empty()) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (char c : text) {
+        int digit = hexDigit(c);
+        if (digit < 0 || digit >= base) {
+            return false;
+        }
+        if (value > (UINT64_MAX - static_cast<uint64_t>(digit)) / static_cast<uint64_t>(base)) {
+            return false;
+        }
+        value = value * static_cast<uint64_t>(base) + static_cast<uint64_t>(digit);
+    }
+
+    if (sign > 0) {
+        offset = cursor + value;
+    } else if (sign < 0) {
+        offset = value > cursor ? 0 : cursor - value;
+    } else {
+        offset = value;
+    }
+    return true;
+}
+
+bool BinaryFileView::parsePattern(const std::string& input, std::string& bytes) {
+    std::string text = trim(input);
+    bytes.clear();
+    if (!text.empty() && text[0] == '"') {
+        text = text.substr(1);
+        if (!text.empty() && text.back() == '"') {
+            text.pop_back();
+        }
+        bytes = text;
+        return !bytes.empty();
+    }
+
+    int high = -1;
+    for (char c : text) {
+        if (c == ' ' || c == '\t') {
+            continue;
+        }
+        int digit = hexDigit(c);
+        if (digit < 0) {
+            return false;
+        }
+        if (high < 0) {
+            high = digit;
+        } else {
+            bytes.push_back(static_cast<char>((high << 4) | digit));
+            high = -1;
+        }
+    }
+    return high < 0 && !bytes.empty();
+}
+
+void BinaryFileView::submitPrompt(Session& session) {
+    Prompt prompt = session.prompt;
+    std::string input = session.prompt_input;
+    session.prompt = Prompt::NONE;
+    session.prompt_input.clear();
+
+    if (prompt == Prompt::GOTO_OFFSET) {
+        uint64_t offset = 0;
+        if (!parseOffset(input, session.cursor, offset) || offset >= session.buffer.size()) {
+            session.message = "Invalid offset: " + input;
+            return;
+        }
+        session.cursor = offset;
+        session.low_nibble = false;
+        scrollToCursor(session);
+        session.message.clear();
+    } else if (prompt == Prompt::SEARCH) {
+        std::string bytes;
+        if (!parsePattern(input, bytes)) {
+            session.message = "Invalid pattern (use hex bytes like \"7f 45 4c 46\" or \"text\")";
+            return;
+        }
+        session.pattern = bytes;
+        session.match = -1;
+        startSearch(session, session.cursor);
+    }
+}
+
+bool BinaryFileView::handlePromptInput(Session& session, const Event& event) {
+    if (event == Event::Escape) {
+        session.prompt = Prompt::NONE;
+        session.prompt_input.clear();
+    } else if (event == Event::Return) {
+        submitPrompt(session);
+    } else if (event == Event::Backspace) {
+        if (!session.prompt_input.empty()) {
+            session.prompt_input.pop_back();
+        }
+    } else if (event.is_character()) {
+        session.prompt_input += event.character();
+    }
+    // 输入提示打开时吞掉其余按键
+    return true;
+}
+
+bool BinaryFileView::handlePatchInput(Session& session, const std::string& ch) {
+    if (ch == "u") {
+        session.buffer.revertByte(session.cursor);
+        session.low_nibble = false;
+        return true;
+    }
+    if (ch.size() != 1 || hexDigit(ch[0]) < 0) {
+        return false;
+    }
+    const uint8_t digit = static_cast<uint8_t>(hexDigit(ch[0]));
+    const uint8_t current = session.buffer.byteAt(session.cursor);
+    if (!session.low_nibble) {
+        session.buffer.setByte(session.cursor,
+                               static_cast<uint8_t>((digit << 4) | (current & 0x0f)));
+        session.low_nibble = true;
+    } else {
+        session.buffer.setByte(session.cursor, static_cast<uint8_t>((current & 0xf0) | digit));
+        moveCursor(session, 1); // 同时复位 low_nibble
+    }
+    session.message.clear();
+    return true;
+}
+
+bool BinaryFileView::handleInput(Event event) {
+    if (!active_ || !active_->buffer.isOpen()) {
+        return false;
+    }
+    Session& session = *active_;
+    if (session.prompt != Prompt::NONE) {
+        return handlePromptInput(session, event);
+    }
+
+    const int64_t row = static_cast<int64_t>(BYTES_PER_ROW);
+    const int64_t page = row * visibleRows(session);
+    if (event.is_mouse()) {
+        if (event.mouse().button == Mouse::WheelUp) {
+            moveCursor(session, -3 * row);
+            return true;
+        }
+        if (event.mouse().button == Mouse::WheelDown) {
+            moveCursor(session, 3 * row);
+            return true;
+        }
+        return false;
+    }
+
+    if (event == Event::ArrowLeft) {
+        moveCursor(session, -1);
+    } else if (event == Event::ArrowRight) {
+        moveCursor(session, 1);
+    } else if (event == Event::ArrowUp) {
+        moveCursor(session, -row);
+    } else if (event == Event::ArrowDown) {
+        moveCursor(session, row);
+    } else if (event == Event::PageUp) {
+        moveCursor(session, -page);
+    } else if (event == Event::PageDown) {
+        moveCursor(session, page);
+    } else if (event == Event::Home) {
+        moveCursor(session, -static_cast<int64_t>(session.cursor % BYTES_PER_ROW));
+    } else if (event == Event::End) {
+        moveCursor(session, row - 1 - static_cast<int64_t>(session.cursor % BYTES_PER_ROW));
+    } else if (event == Event::CtrlG || event == Event::Character("g")) {
+        session.prompt = Prompt::GOTO_OFFSET;
+        session.prompt_input.clear();
+    } else if (event == Event::CtrlF || event == Event::Character("/")) {
+        session.prompt = Prompt::SEARCH;
+        session.prompt_input.clear();
+    } else if (event == Event::Character("n")) {
+        if (session.pattern.empty()) {
+            session.prompt = Prompt::SEARCH;
+            session.prompt_input.clear();
+        } else {
+            startSearch(session, session.cursor + 1);
+        }
+    } else if (event == Event::Character("p")) {
+        session.patch_mode = !session.patch_mode;
+        session.low_nibble = false;
+        session.message = session.patch_mode ? "Patch mode: type hex digits, u to revert a byte"
+                                             : "View mode";
+    } else if (event == Event::Escape) {
+        if (session.search.isRunning()) {
+            ++session.search_generation;
+            session.search.cancel();
+            session.message = "Search cancelled";
+        } else if (session.patch_mode) {
+            session.patch_mode = false;
+            session.low_nibble = false;
+            session.message = "View mode";
+        } else {
+            return false;
+        }
+    } else if (session.patch_mode && event.is_character()) {
+        return handlePatchInput(session, event.character());
+    } else {
+        return false;
+    }
+    return true;
 }
 
 Element BinaryFileView::render() {
+    if (!active_ || !active_->buffer.isOpen()) {
+        return renderNotice(active_ ? active_->buffer.getLastError() : "");
+    }
+    auto& colors = theme_.getColors();
+    Session& session = *active_;
+    const int rows = visibleRows(session);
+    scrollToCursor(session);
+
+    return vbox({renderHeader(session), separator() | color(colors.comment),
+                 renderRows(session, rows) | flex | reflect(session.rows_box),
+                 separator() | color(colors.comment), renderFooter(session)}) |
+           flex | bgcolor(colors.background);
+}
+
+Element BinaryFileView::renderHeader(const Session& session) {
+    auto& colors = theme_.getColors();
+    std::string filename = std::filesystem::path(filepath_).filename().string();
+
+    Elements header = {text(" "), text(icons::FILE) | color(colors.comment),
+                       text(" " + filename) | color(colors.function) | bold,
+                       text("  " + utils::formatFileSize(session.buffer.size())) |
+                           color(colors.comment)};
+    if (session.buffer.hasPatches()) {
+        header.push_back(text("  " + std::to_string(session.buffer.dirtyPageCount()) +
+                              " modified page(s)") |
+                         color(colors.warning));
+    }
+    header.push_back(filler());
+    if (session.patch_mode) {
+        header.push_back(text(" PATCH ") | bold | color(colors.background) |
+                         bgcolor(colors.warning));
+    } else {
+        header.push_back(text(" HEX ") | bold | color(colors.background) |
+                         bgcolor(colors.function));
+    }
+    header.push_back(text(" "));
+    return hbox(header);
+}
+
+Element BinaryFileView::renderRows(Session& session, int rows) {
+    auto& colors = theme_.getColors();
+    const uint64_t size = session.buffer.size();
+    if (size == 0) {
+        return text("  (empty file)") | color(colors.comment);
+    }
+
+    // 偏移列宽度随文件大小增长，至少 8 位
+    int offset_width = 8;
+    while (offset_width < 16 && ((size - 1) >> (offset_width * 4)) != 0) {
+        offset_width += 2;
+    }
+
+    // 只读取可见行对应的字节：映射按页调入，未显示的部分不会被读盘
+    const uint64_t first = session.top_row * BYTES_PER_ROW;
+    std::vector<uint8_t> bytes(static_cast<size_t>(rows) * BYTES_PER_ROW);
+    bytes.resize(session.buffer.read(first, bytes.data(), bytes.size()));
+
+    const uint64_t match_begin = session.match >= 0 ? static_cast<uint64_t>(session.match) : 0;
+    const uint64_t match_end = session.match >= 0 ? match_begin + session.pattern.size() : 0;
+
+    auto styleOf = [&](ByteClass cls) -> Decorator {
+        switch (cls) {
+            case ByteClass::ZERO:
+                return color(colors.comment) | dim;
+            case ByteClass::PRINTABLE:
+                return color(colors.foreground);
+            case ByteClass::OTHER:
+                return color(colors.number);
+            case ByteClass::MODIFIED:
+                return color(colors.warning) | bold;
+            case ByteClass::MATCH:
+                return color(colors.foreground) | bgcolor(colors.selection);
+            case ByteClass::CURSOR:
+                return Decorator(inverted) | bold;
+        }
+        return nothing;
+    };
+
+    Elements lines;
+    for (size_t row_start = 0; row_start < bytes.size(); row_start += BYTES_PER_ROW) {
+        const uint64_t offset = first + row_start;
+        const size_t count = std::min<size_t>(BYTES_PER_ROW, bytes.size() - row_start);
+
+        ByteClass classes[BYTES_PER_ROW];
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t pos = offset + i;
+            const uint8_t byte = bytes[row_start + i];
+            if (pos == session.cursor) {
+                classes[i] = ByteClass::CURSOR;
+            } else if (session.buffer.hasPatches() && session.buffer.isModified(pos)) {
+                classes[i] = ByteClass::MODIFIED;
+            } else if (pos >= match_begin && pos < match_end) {
+                classes[i] = ByteClass::MATCH;
+            } else if (byte == 0) {
+                classes[i] = ByteClass::ZERO;
+            } else {
+                classes[i] = isPrintable(byte) ? ByteClass::PRINTABLE : ByteClass::OTHER;
+            }
+        }
+
+        Elements line = {text(toHex(offset, offset_width)) | color(colors.line_number),
+                         text("  ")};
+
+        // 相邻同类字节合并为一个 text，分隔空格不带样式
+        std::string run;
+        for (size_t i = 0; i < count; ++i) {
+            run += toHex(bytes[row_start + i], 2);
+            const bool group_end = i + 1 == count || i + 1 == BYTES_PER_ROW / 2;
+            if (!group_end && classes[i + 1] == classes[i]) {
+                run += ' ';
+                continue;
+            }
+            line.push_back(text(run) | styleOf(classes[i]));
+            run.clear();
+            line.push_back(text(i + 1 == BYTES_PER_ROW / 2 ? "  " : " "));
+        }
+        if (count < BYTES_PER_ROW) {
+            size_t missing = BYTES_PER_ROW - count;
+            line.push_back(text(std::string(missing * 3 + (count < BYTES_PER_ROW / 2 ? 1 : 0),
+                                            ' ')));
+        }
+
+        line.push_back(text(" │") | color(colors.comment));
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t byte = bytes[row_start + i];
+            run += isPrintable(byte) ? static_cast<char>(byte) : '.';
+            if (i + 1 == count || classes[i + 1] != classes[i]) {
+                line.push_back(text(run) | styleOf(classes[i]));
+                run.clear();
+            }
+        }
+        line.push_back(text(std::string(BYTES_PER_ROW - count, ' ') + "│") |
+                       color(colors.comment));
+        lines.push_back(hbox(line));
+    }
+    return vbox(lines);
+}
+
+Element BinaryFileView::renderFooter(const Session& session) {
+    auto& colors = theme_.getColors();
+    if (session.prompt != Prompt::NONE) {
+        std::string label = session.prompt == Prompt::GOTO_OFFSET
+                                ? " Go to offset (0x.. hex, +/- relative): "
+                                : " Search bytes (7f 45 4c 46 or \"text\"): ";
+        return hbox({text(label) | color(colors.keyword) | bold,
+                     text(session.prompt_input) | color(colors.foreground),
+                     text(" ") | inverted, filler()});
+    }
+
+    Elements footer;
+    if (session.search.isRunning()) {
+        const uint64_t size = std::max<uint64_t>(1, session.buffer.size());
+        const uint64_t percent =
+            std::min<uint64_t>(100, session.search.scannedBytes() * 100 / size);
+        footer.push_back(text(" " + std::string(icons::SEARCH) + " Searching... " +
+                              std::to_string(percent) + "%  (Esc to cancel)") |
+                         color(colors.info));
+    } else if (!session.message.empty()) {
+        footer.push_back(text(" " + session.message) | color(colors.info));
+    } else {
+        footer.push_back(text(" g") | color(colors.helpbar_key) | bold);
+        footer.push_back(text(" Goto  ") | color(colors.comment));
+        footer.push_back(text("/") | color(colors.helpbar_key) | bold);
+        footer.push_back(text(" Search  ") | color(colors.comment));
+        footer.push_back(text("n") | color(colors.helpbar_key) | bold);
+        footer.push_back(text(" Next  ") | color(colors.comment));
+        footer.push_back(text("p") | color(colors.helpbar_key) | bold);
+        footer.push_back(text(" Patch  ") | color(colors.comment));
+        footer.push_back(text("Ctrl+S") | color(colors.helpbar_key) | bold);
+        footer.push_back(text(" Save") | color(colors.comment));
+    }
+    footer.push_back(filler());
+
+    if (session.buffer.size() > 0) {
+        const uint8_t byte = session.buffer.byteAt(session.cursor);
+        footer.push_back(text("0x" + toHex(session.cursor, 1) + " (" +
+                              std::to_string(session.cursor) + ")  = 0x" + toHex(byte, 2) + " " +
+                              std::to_string(byte) + " ") |
+                         color(colors.foreground));
+    }
+    return hbox(footer);
+}
+
+Element BinaryFileView::renderNotice(const std::string& reason) {
     auto& colors = theme_.getColors();
 
     Elements content;
@@ -62,10 +645,14 @@ Element BinaryFileView::render() {
     content.push_back(text(""));
     content.push_back(text(""));
 
-    // 说明信息
-    content.push_back(text("This file appears to be a binary file and cannot") |
+    // 说明信息：十六进制视图无法映射该文件
+    content.push_back(text("This file appears to be a binary file and could not") |
                       color(colors.foreground) | center);
-    content.push_back(text("be opened in text editor mode.") | color(colors.foreground) | center);
+    content.push_back(text("be opened in the hex viewer.") | color(colors.foreground) | center);
+    if (!reason.empty()) {
+        content.push_back(text(""));
+        content.push_back(text(reason) | color(colors.error) | center);
+    }
 
     content.push_back(text(""));
     content.push_back(text(""));
@@ -83,7 +670,7 @@ Element BinaryFileView::render() {
     suggestions.push_back(hbox({text("  • "), text("Check if the file has a text-based format") |
                                                   color(colors.foreground)}));
     suggestions.push_back(
-        hbox({text("  • "), text("Open with a hex editor if you need to view raw bytes") |
+        hbox({text("  • "), text("Check that the file is a local, readable regular file") |
                                 color(colors.foreground)}));
 
     for (const auto& suggestion : suggestions) {
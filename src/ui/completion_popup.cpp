@@ -31,21 +31,25 @@ void CompletionPopup::show(const std::vector<features::CompletionItem>& items, i
         return;
     }
 
-    // 过滤掉 label 为空的项，避免出现“空条”的弹窗
+    // 过滤掉 label 为空的项，避免出现“空条”的弹窗；通常没有这种项，此时直接使用传入列表
+    auto is_blank = [](const features::CompletionItem& item) {
+        return item.label.empty() && item.filterText.empty();
+    };
     std::vector<features::CompletionItem> filtered;
-    filtered.reserve(items.size());
-    for (const auto& item : items) {
-        std::string display = item.label.empty() ? item.filterText : item.label;
-        if (!display.empty()) {
-            filtered.push_back(item);
+    if (std::any_of(items.begin(), items.end(), is_blank)) {
+        filtered.reserve(items.size());
+        for (const auto& item : items) {
+            if (!is_blank(item)) {
+                filtered.push_back(item);
+            }
+        }
+        if (filtered.empty()) {
+            hide();
+            return;
         }
-    }
-    if (filtered.empty()) {
-        hide();
-        return;
     }
 
-    const std::vector<features::CompletionItem>& use_items = filtered;
+    const std::vector<features::CompletionItem>& use_items = filtered.empty() ? items : filtered;
 
     // 参考 VSCode：优化响应速度，减少不必要的更新
     bool was_visible = visible_;
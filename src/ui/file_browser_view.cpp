@@ -16,6 +16,23 @@ using namespace ftxui;
 namespace pnana {
 namespace ui {
 
+namespace {
+// flat_items[index] 的祖先链（下标即深度）：向前找每个更浅的第一项
+std::vector<const features::FileItem*> findAncestors(
+    const std::vector<features::FileItem*>& flat_items, size_t index) {
+    std::vector<const features::FileItem*> ancestors;
+    int depth = flat_items[index]->depth;
+    for (size_t j = index; j-- > 0 && depth > 0;) {
+        if (flat_items[j]->depth < depth) {
+            depth = flat_items[j]->depth;
+            ancestors.push_back(flat_items[j]);
+        }
+    }
+    std::reverse(ancestors.begin(), ancestors.end());
+    return ancestors;
+}
+} // namespace
+
 FileBrowserView::FileBrowserView(Theme& theme)
     : theme_(theme), color_mapper_(theme), scroll_offset_(0), show_tree_style_(true) {}
 
@@ -113,14 +130,21 @@ Element FileBrowserView::render(const features::FileBrowser& browser, int height
     size_t visible_start = scroll_offset_;
     size_t visible_end = std::min(scroll_offset_ + available_height, total_items);
 
+    // 树形连接线需要每行的祖先：从第一个可见行向前找一次，之后逐行维护
+    std::vector<const features::FileItem*> ancestors =
+        visible_start < visible_end ? findAncestors(flat_items, visible_start)
+                                    : std::vector<const features::FileItem*>{};
+
     // 渲染文件列表 - 只渲染可见的项目
     Elements file_list_elements;
 
     for (size_t i = visible_start; i < visible_end; ++i) {
         const features::FileItem* item = flat_items[i];
         if (item) {
+            ancestors.resize(std::min(ancestors.size(), static_cast<size_t>(item->depth)));
             file_list_elements.push_back(
-                renderFileItem(item, i, selected_index, flat_items, browser));
+                renderFileItem(item, i, selected_index, ancestors, browser));
+            ancestors.push_back(item);
         }
     }
 
@@ -166,13 +190,16 @@ Element FileBrowserView::renderFileList(const features::FileBrowser& browser, si
     size_t selected_index = browser.getSelectedIndex();
 
     // 渲染可见的文件项
+    std::vector<const features::FileItem*> ancestors =
+        visible_start < flat_items.size() ? findAncestors(flat_items, visible_start)
+                                          : std::vector<const features::FileItem*>{};
     for (size_t i = visible_start; i < flat_items.size() && i < visible_start + visible_count;
          ++i) {
         const features::FileItem* item = flat_items[i];
         if (item) {
-            // 注意：这里需要 browser 参数，但 renderFileList 没有，需要修改方法签名
-            // 暂时使用简化版本
-            content.push_back(renderFileItem(item, i, selected_index, flat_items, browser));
+            ancestors.resize(std::min(ancestors.size(), static_cast<size_t>(item->depth)));
+            content.push_back(renderFileItem(item, i, selected_index, ancestors, browser));
+            ancestors.push_back(item);
         }
     }
 
@@ -255,16 +282,24 @@ Element FileBrowserView::renderFileInfoBar(const features::FileBrowser& browser)
 
 Element FileBrowserView::renderFileItem(const features::FileItem* item, size_t index,
                                         size_t selected_index,
-                                        const std::vector<features::FileItem*>& flat_items,
+                                        const std::vector<const features::FileItem*>& ancestors,
                                         const features::FileBrowser& browser) const {
     auto& colors = theme_.getColors();
 
-    // 根据文件夹展开状态选择图标
-    std::string icon = getFileIcon(*item);
-    if (item->is_directory && item->expanded && item->name != "..") {
-        icon = icons::FOLDER_OPEN; // 展开的文件夹使用打开的文件夹图标
+    // 根据文件夹展开状态选择图标；目录的颜色来自主题，不缓存
+    std::string icon;
+    Color item_color;
+    if (item->is_directory) {
+        icon = getFileIcon(*item);
+        if (item->expanded && item->name != "..") {
+            icon = icons::FOLDER_OPEN; // 展开的文件夹使用打开的文件夹图标
+        }
+        item_color = color_mapper_.getFileColor(item->name, true);
+    } else {
+        const FileStyle& style = getFileStyle(item->name);
+        icon = style.icon;
+        item_color = style.color;
     }
-    Color item_color = color_mapper_.getFileColor(item->name, item->is_directory);
 
     // 构建前缀（根据配置决定是否显示树形样式）
     std::string tree_prefix = "";
@@ -273,8 +308,8 @@ Element FileBrowserView::renderFileItem(const features::FileItem* item, size_t i
 
     if (show_tree_style_) {
         // 完整树形模式
-        tree_prefix = buildTreePrefix(item, index, flat_items);
-        expand_prefix = buildExpandPrefix(item, index, flat_items);
+        tree_prefix = buildTreePrefix(item, ancestors);
+        expand_prefix = buildExpandPrefix(item);
         if (item->is_directory) {
             expand_icon = item->expanded ? "▼" : "▶";
         } else {
@@ -317,6 +352,9 @@ Element FileBrowserView::renderFileItem(const features::FileItem* item, size_t i
     row_elements.insert(row_elements.end(), {text(selection_marker) | color(colors.keyword),
                                              text(icon) | color(item_color), text(" "),
                                              text(display_name) | color(item_color)});
+    if (item->loading) {
+        row_elements.push_back(text(" …") | color(colors.comment) | dim);
+    }
 
     auto item_text = hbox(row_elements);
 
@@ -335,49 +373,23 @@ Element FileBrowserView::renderFileItem(const features::FileItem* item, size_t i
 }
 
 std::string FileBrowserView::buildTreePrefix(
-    const features::FileItem* item, size_t index,
-    const std::vector<features::FileItem*>& flat_items) const {
+    const features::FileItem* item, const std::vector<const features::FileItem*>& ancestors) const {
     std::string prefix = "";
 
-    for (int d = 0; d < item->depth; ++d) {
-        // 检查这个深度层级是否有后续兄弟节点
-        bool has_sibling = false;
-        for (size_t j = index + 1; j < flat_items.size(); ++j) {
-            if (flat_items[j]->depth == d) {
-                has_sibling = true;
-                break;
-            }
-            if (flat_items[j]->depth < d) {
-                break;
-            }
-        }
-
-        if (has_sibling) {
-            prefix += "│ "; // 有后续兄弟，显示竖线
+    for (int d = 0; d < item->depth && d < static_cast<int>(ancestors.size()); ++d) {
+        // 该层祖先后面还有兄弟节点时显示竖线
+        if (!ancestors[d]->last_child) {
+            prefix += "│ ";
         } else {
-            prefix += "  "; // 没有后续兄弟，显示空格
+            prefix += "  ";
         }
     }
 
     return prefix;
 }
 
-std::string FileBrowserView::buildExpandPrefix(
-    const features::FileItem* item, size_t index,
-    const std::vector<features::FileItem*>& flat_items) const {
-    // 检查是否有后续兄弟节点（同深度）
-    bool has_sibling = false;
-    for (size_t j = index + 1; j < flat_items.size(); ++j) {
-        if (flat_items[j]->depth == item->depth) {
-            has_sibling = true;
-            break;
-        }
-        if (flat_items[j]->depth < item->depth) {
-            break;
-        }
-    }
-
-    return has_sibling ? "├─" : "└─";
+std::string FileBrowserView::buildExpandPrefix(const features::FileItem* item) const {
+    return item->last_child ? "└─" : "├─";
 }
 
 std::string FileBrowserView::buildSpacePrefix(const features::FileItem* item) const {
@@ -400,6 +412,21 @@ std::string FileBrowserView::getFileIcon(const features::FileItem& item) const {
     return utils::getIconForFile(item.name, ext, nullptr);
 }
 
+const FileBrowserView::FileStyle& FileBrowserView::getFileStyle(
+    const std::string& filename) const {
+    auto it = file_style_cache_.find(filename);
+    if (it != file_style_cache_.end()) {
+        return it->second;
+    }
+    // 只缓存渲染过的文件名，数量一般不大；超过上限时整体清空
+    if (file_style_cache_.size() >= 4096) {
+        file_style_cache_.clear();
+    }
+    FileStyle style{utils::getIconForFile(filename, getFileExtension(filename), nullptr),
+                    color_mapper_.getFileColor(filename, false)};
+    return file_style_cache_.emplace(filename, std::move(style)).first->second;
+}
+
 std::string FileBrowserView::getFileExtension(const std::string& filename) const {
     size_t pos = filename.find_last_of('.');
     if (pos != std::string::npos && pos > 0) {
@@ -4,6 +4,7 @@
 #include "utils/file_type_detector.h"
 #include "utils/logger.h"
 #include "utils/match_highlight.h"
+#include "utils/perf_monitor.h"
 #include <algorithm>
 #include <atomic>
 #include <cctype>
@@ -197,7 +198,7 @@ FzfPopup::FzfPopup(Theme& theme)
 // 使用多线程并行扫描加速
 static std::tuple<std::vector<std::string>, std::vector<std::string>, std::string>
 collectFilesToVector(const std::string& root_directory) {
-    LOG_TIMING_START("fzf_collectFiles");
+    PERF_ZONE(FZF_COLLECT);
 
     std::string canonical_root;
     FileResultCollector collector;
@@ -258,11 +259,12 @@ collectFilesToVector(const std::string& root_directory) {
         LOG_METRIC("fzf_collected_files", results.size(), "root=" + root_directory);
 
         // 排序阶段
-        LOG_TIMING_START("fzf_sort");
-        std::sort(results.begin(), results.end(), [](const auto& a, const auto& b) {
-            return a.first < b.first;
-        });
-        LOG_TIMING_END("fzf_sort", "count=" + std::to_string(results.size()));
+        {
+            PERF_ZONE(FZF_SORT);
+            std::sort(results.begin(), results.end(), [](const auto& a, const auto& b) {
+                return a.first < b.first;
+            });
+        }
 
         std::vector<std::string> files;
         std::vector<std::string> display_paths;
@@ -273,13 +275,12 @@ collectFilesToVector(const std::string& root_directory) {
             display_paths.push_back(std::move(p.second));
         }
 
-        LOG_TIMING_END("fzf_collectFiles",
-                       "root=" + root_directory + ", files=" + std::to_string(files.size()));
+        LOG_DEBUG("fzf_collectFiles - root=" + root_directory +
+                  ", files=" + std::to_string(files.size()));
 
         return {std::move(files), std::move(display_paths), std::move(canonical_root)};
     } catch (const std::exception& e) {
         LOG_ERROR("fzf_collectFiles - Exception: " + std::string(e.what()));
-        LOG_TIMING_END("fzf_collectFiles", "error");
         return {{}, {}, {}};
     }
 }
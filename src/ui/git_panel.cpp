@@ -6,7 +6,6 @@
 #include <filesystem>
 #include <ftxui/component/event.hpp>
 #include <ftxui/dom/elements.hpp>
-#include <future>
 #include <mutex>
 #include <sstream>
 
@@ -27,6 +26,7 @@ namespace vgit {
 
 GitPanel::GitPanel(ui::Theme& theme, const std::string& repo_path)
     : theme_(theme), git_manager_(std::make_unique<GitManager>(repo_path)), icon_mapper_() {
+    git_service_ = std::make_unique<GitService>(*git_manager_);
     last_repo_display_update_ = std::chrono::steady_clock::now() - repo_display_cache_timeout_;
     last_branch_update_ = std::chrono::steady_clock::now() - branch_cache_timeout_;
     last_branch_status_update_ = std::chrono::steady_clock::now() - branch_status_cache_timeout_;
@@ -34,13 +34,18 @@ GitPanel::GitPanel(ui::Theme& theme, const std::string& repo_path)
 
 void GitPanel::setRemoteExecutor(vgit::GitManager::RemoteExecutor executor,
                                  const std::string& label, const std::string& remote_path) {
-    git_manager_->setRemoteExecutor(std::move(executor), label, remote_path);
+    git_service_->runExclusive([&](GitManager& manager) {
+        manager.setRemoteExecutor(std::move(executor), label, remote_path);
+    });
+    git_service_->resetRepository();
     // 清除所有 UI 缓存，让面板重新拉取远程数据
     data_loaded_ = false;
     data_loading_ = false;
     files_.clear();
     branches_.clear();
     graph_commits_.clear();
+    graph_loading_ = false;
+    graph_eof_ = false;
     cached_current_branch_.clear();
     cached_repo_path_display_.clear();
     stats_cache_valid_ = false;
@@ -50,12 +55,17 @@ void GitPanel::setRemoteExecutor(vgit::GitManager::RemoteExecutor executor,
 }
 
 void GitPanel::clearRemoteContext(const std::string& local_path) {
-    git_manager_->clearRemoteContext(local_path);
+    git_service_->runExclusive([&](GitManager& manager) {
+        manager.clearRemoteContext(local_path);
+    });
+    git_service_->resetRepository();
     data_loaded_ = false;
     data_loading_ = false;
     files_.clear();
     branches_.clear();
     graph_commits_.clear();
+    graph_loading_ = false;
+    graph_eof_ = false;
     cached_current_branch_.clear();
     cached_repo_path_display_.clear();
     stats_cache_valid_ = false;
@@ -88,12 +98,9 @@ void GitPanel::onShow() {
     scroll_offset_ = 0;
     clearSelection();
 
-    // 如果还没加载过数据，开始异步加载（不阻塞UI）
+    // 如果还没加载过数据，交给 git 服务线程异步加载（不阻塞UI）
     if (!data_loaded_ && !data_loading_) {
-        // 异步加载数据，不阻塞UI
-        std::thread([this]() {
-            refreshData();
-        }).detach(); // 分离线程，让它在后台运行
+        refreshData();
     }
 }
 
@@ -146,21 +153,16 @@ bool GitPanel::onKeyPress(Event event) {
 }
 
 void GitPanel::refreshStatusOnly() {
-    if (data_loading_) {
-        return; // 如果正在加载，忽略请求
-    }
-
     data_loading_ = true;
 
-    // 异步只刷新状态数据，不刷新分支数据
-    auto future = std::async(std::launch::async, [this]() {
+    // 在 git 服务线程上只刷新状态数据，不刷新分支数据；重复请求会合并
+    git_service_->post("status", [this](GitManager& manager) {
         try {
-            git_manager_->refreshStatusForced();
-            auto files = git_manager_->getStatus();
-            auto error = git_manager_->getLastError();
-            git_manager_->clearError();
+            manager.refreshStatusForced();
+            auto files = manager.getStatus();
+            auto error = manager.getLastError();
+            manager.clearError();
 
-            // 在主线程中更新UI数据
             std::lock_guard<std::mutex> lock(data_mutex_);
             files_ = std::move(files);
             error_message_ = std::move(error);
@@ -175,31 +177,36 @@ void GitPanel::refreshStatusOnly() {
 }
 
 void GitPanel::refreshData() {
-    if (data_loading_) {
-        return; // 如果正在加载，忽略请求
-    }
-
     data_loading_ = true;
     last_refresh_time_ = std::chrono::steady_clock::now();
 
-    // 异步加载git数据，使用更高效的方式
-    auto future = std::async(std::launch::async, [this]() {
+    // 刷新可能由提交 / 切换分支 / pull 触发，图视图需要从头重新读取
+    if (!graph_commits_.empty() || graph_loading_) {
+        git_service_->resetGraph();
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        ++graph_generation_;
+        graph_commits_.clear();
+        graph_loading_ = false;
+        graph_eof_ = false;
+    }
+
+    // 在 git 服务线程上加载；队列中尚未执行的刷新会被合并为一次
+    git_service_->post("refresh", [this](GitManager& manager) {
         try {
             // 强制刷新状态，确保获取最新数据
-            git_manager_->refreshStatusForced();
+            manager.refreshStatusForced();
 
-            auto files = git_manager_->getStatus();
-            auto error = git_manager_->getLastError();
-            git_manager_->clearError();
+            auto files = manager.getStatus();
+            auto error = manager.getLastError();
+            manager.clearError();
 
             // 分支数据变化较少，只有在第一次加载或明确需要时才获取
             bool need_branches = branches_.empty() || branch_data_stale_;
             std::vector<GitBranch> branches;
             if (need_branches) {
-                branches = git_manager_->getBranches();
+                branches = manager.getBranches();
             }
 
-            // 在主线程中更新UI数据
             std::lock_guard<std::mutex> lock(data_mutex_);
             files_ = std::move(files);
             error_message_ = std::move(error);
@@ -223,6 +230,48 @@ void GitPanel::refreshData() {
     });
 }
 
+bool GitPanel::runGitOperation(const std::function<bool(GitManager&)>& op) {
+    bool ok = false;
+    std::string error;
+    git_service_->runExclusive([&](GitManager& manager) {
+        ok = op(manager);
+        if (!ok) {
+            error = manager.getLastError();
+        }
+    });
+    if (!ok) {
+        // 服务线程上的刷新任务同样会写 error_message_
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        error_message_ = std::move(error);
+    }
+    return ok;
+}
+
+void GitPanel::loadMoreGraphCommits() {
+    if (graph_loading_ || graph_eof_) {
+        return;
+    }
+    graph_loading_ = true;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        generation = graph_generation_;
+    }
+    // 从长驻 git log 流继续读取下一页（每页 100 个提交）
+    git_service_->requestGraphPage(
+        100, [this, generation](std::vector<GitCommit> commits, bool eof) {
+            std::lock_guard<std::mutex> lock(data_mutex_);
+            // 读取期间图视图已被重置：这一页属于旧的提交列表
+            if (generation != graph_generation_) {
+                return;
+            }
+            graph_commits_.insert(graph_commits_.end(), std::make_move_iterator(commits.begin()),
+                                  std::make_move_iterator(commits.end()));
+            graph_eof_ = eof;
+            graph_loading_ = false;
+        });
+}
+
 void GitPanel::switchMode(GitPanelMode mode) {
     current_mode_ = mode;
     selected_index_ = 0;
@@ -237,19 +286,18 @@ void GitPanel::switchMode(GitPanelMode mode) {
         branch_cursor_position_ = 0;
     } else if (mode == GitPanelMode::CLONE) {
         clone_url_.clear();
-        clone_path_ = git_manager_->getRepositoryRoot().empty() ? fs::current_path().string()
-                                                                : git_manager_->getRepositoryRoot();
+        std::string repo_root;
+        git_service_->runExclusive([&repo_root](GitManager& manager) {
+            repo_root = manager.getRepositoryRoot();
+        });
+        clone_path_ = repo_root.empty() ? fs::current_path().string() : repo_root;
         clone_focus_on_url_ = true;      // Default focus on URL
         clone_state_ = CloneState::IDLE; // Reset clone state when switching to clone mode
         clone_success_message_.clear();
     } else if (mode == GitPanelMode::GRAPH) {
         // Load graph commits when switching to graph mode
-        if (graph_commits_.empty() || !data_loaded_) {
-            std::thread([this]() {
-                auto commits = git_manager_->getGraphCommits(100);
-                std::lock_guard<std::mutex> lock(data_mutex_);
-                graph_commits_ = std::move(commits);
-            }).detach();
+        if (graph_commits_.empty()) {
+            loadMoreGraphCommits();
         }
     }
 
@@ -309,9 +357,11 @@ void GitPanel::performStageSelected() {
     bool success = true;
     for (size_t index : selected_files_) {
         if (index < files_.size()) {
-            if (!git_manager_->stageFile(files_[index].path)) {
+            const std::string path = files_[index].path;
+            if (!runGitOperation([&path](GitManager& manager) {
+                    return manager.stageFile(path);
+                })) {
                 success = false;
-                error_message_ = git_manager_->getLastError();
                 break;
             } else {
                 // Immediately reflect staged state in UI so color/indicator update without waiting
@@ -351,9 +401,11 @@ void GitPanel::performUnstageSelected() {
     bool success = true;
     for (size_t index : selected_files_) {
         if (index < files_.size()) {
-            if (!git_manager_->unstageFile(files_[index].path)) {
+            const std::string path = files_[index].path;
+            if (!runGitOperation([&path](GitManager& manager) {
+                    return manager.unstageFile(path);
+                })) {
                 success = false;
-                error_message_ = git_manager_->getLastError();
                 break;
             } else {
                 // Immediately reflect unstaged state in UI so color/indicator update without
@@ -383,28 +435,28 @@ void GitPanel::performUnstageSelected() {
 }
 
 void GitPanel::performStageAll() {
-    if (git_manager_->stageAll()) {
+    if (runGitOperation([](GitManager& manager) {
+            return manager.stageAll();
+        })) {
         // 延迟刷新状态，避免频繁的Git命令调用
         // refreshStatusOnly();
         clearSelection();
 
         // 标记数据已过期，下次需要时再刷新
         data_loaded_ = false;
-    } else {
-        error_message_ = git_manager_->getLastError();
     }
 }
 
 void GitPanel::performUnstageAll() {
-    if (git_manager_->unstageAll()) {
+    if (runGitOperation([](GitManager& manager) {
+            return manager.unstageAll();
+        })) {
         // 延迟刷新状态，避免频繁的Git命令调用
         // refreshStatusOnly();
         clearSelection();
 
         // 标记数据已过期，下次需要时再刷新
         data_loaded_ = false;
-    } else {
-        error_message_ = git_manager_->getLastError();
     }
 }
 
@@ -412,7 +464,10 @@ void GitPanel::performCommit() {
     if (commit_message_.empty())
         return;
 
-    if (git_manager_->commit(commit_message_)) {
+    const std::string message = commit_message_;
+    if (runGitOperation([&message](GitManager& manager) {
+            return manager.commit(message);
+        })) {
         commit_message_.clear();
         commit_cursor_position_ = 0;
         // Refresh data and ensure UI updates immediately
@@ -424,26 +479,26 @@ void GitPanel::performCommit() {
         component_needs_rebuild_ = true;
         needs_redraw_ = true;
         switchMode(GitPanelMode::STATUS);
-    } else {
-        error_message_ = git_manager_->getLastError();
     }
 }
 
 bool GitPanel::performPush() {
-    if (git_manager_->push()) {
+    if (runGitOperation([](GitManager& manager) {
+            return manager.push();
+        })) {
         refreshData(); // push后可能需要刷新分支和状态信息
         return true;
     }
-    error_message_ = git_manager_->getLastError();
     return false;
 }
 
 bool GitPanel::performPull() {
-    if (git_manager_->pull()) {
+    if (runGitOperation([](GitManager& manager) {
+            return manager.pull();
+        })) {
         refreshData(); // pull后需要刷新所有数据
         return true;
     }
-    error_message_ = git_manager_->getLastError();
     return false;
 }
 
@@ -451,7 +506,10 @@ void GitPanel::performCreateBranch() {
     if (branch_name_.empty())
         return;
 
-    if (git_manager_->createBranch(branch_name_)) {
+    const std::string name = branch_name_;
+    if (runGitOperation([&name](GitManager& manager) {
+            return manager.createBranch(name);
+        })) {
         branch_name_.clear();
         branch_cursor_position_ = 0;
         // Clear branch cache since current branch might have changed
@@ -459,8 +517,6 @@ void GitPanel::performCreateBranch() {
         last_branch_update_ = std::chrono::steady_clock::now() - branch_cache_timeout_;
         refreshData(); // 分支操作后需要刷新分支数据
         switchMode(GitPanelMode::STATUS);
-    } else {
-        error_message_ = git_manager_->getLastError();
     }
 }
 
@@ -468,14 +524,15 @@ void GitPanel::performSwitchBranch() {
     if (selected_index_ >= branches_.size())
         return;
 
-    if (git_manager_->switchBranch(branches_[selected_index_].name)) {
+    const std::string name = branches_[selected_index_].name;
+    if (runGitOperation([&name](GitManager& manager) {
+            return manager.switchBranch(name);
+        })) {
         // Clear branch cache since current branch has changed
         cached_current_branch_.clear();
         last_branch_update_ = std::chrono::steady_clock::now() - branch_cache_timeout_;
         refreshData(); // 分支切换后需要刷新所有数据
         switchMode(GitPanelMode::STATUS);
-    } else {
-        error_message_ = git_manager_->getLastError();
     }
 }
 
@@ -1374,9 +1431,8 @@ Element GitPanel::renderClonePanel() {
                 // Auto-reset after 5 seconds
                 clone_state_ = CloneState::IDLE;
                 clone_url_.clear();
-                clone_path_ = git_manager_->getRepositoryRoot().empty()
-                                  ? fs::current_path().string()
-                                  : git_manager_->getRepositoryRoot();
+                std::string repo_root = getCachedRepoPathDisplay();
+                clone_path_ = repo_root == "." ? fs::current_path().string() : repo_root;
                 clone_focus_on_url_ = true;
                 clone_success_message_.clear();
             }
@@ -2348,7 +2404,10 @@ bool GitPanel::handleBranchModeKey(Event event) {
     // Ctrl+D to delete selected branch
     if (event == Event::CtrlD) {
         if (selected_index_ < branches_.size() && !branches_[selected_index_].is_current) {
-            git_manager_->deleteBranch(branches_[selected_index_].name);
+            const std::string name = branches_[selected_index_].name;
+            runGitOperation([&name](GitManager& manager) {
+                return manager.deleteBranch(name);
+            });
             refreshData();
         }
         return true;
@@ -2428,25 +2487,21 @@ bool GitPanel::handleRemoteModeKey(Event event) {
     if (event == Event::Character('p') || event == Event::Character('P')) {
         if (performPush()) {
             error_message_.clear(); // Clear any previous errors
-        } else {
-            error_message_ = git_manager_->getLastError();
         }
         return true;
     }
     if (event == Event::Character('l') || event == Event::Character('L')) {
         if (performPull()) {
             error_message_.clear(); // Clear any previous errors
-        } else {
-            error_message_ = git_manager_->getLastError();
         }
         return true;
     }
     if (event == Event::Character('f') || event == Event::Character('F')) {
-        if (git_manager_->fetch()) {
+        if (runGitOperation([](GitManager& manager) {
+                return manager.fetch();
+            })) {
             refreshData();
             error_message_.clear(); // Clear any previous errors
-        } else {
-            error_message_ = git_manager_->getLastError();
         }
         return true;
     }
@@ -2572,30 +2627,9 @@ Element GitPanel::renderGraphPanel() {
         graph_elements.push_back(renderGraphCommitItem(graph_commits_[i], i, is_highlighted, pref));
     }
 
-    // If we've rendered to the end of currently loaded commits, try to load more asynchronously
-    if (end == graph_commits_.size() && !graph_loading_) {
-        // Prevent duplicate concurrent loads
-        graph_loading_ = true;
-        std::thread([this]() {
-            try {
-                // Fetch next page of commits using skip = current size
-                size_t skip = 0;
-                {
-                    std::lock_guard<std::mutex> lock(data_mutex_);
-                    skip = graph_commits_.size();
-                }
-                // Load 100 more commits per page
-                auto more = git_manager_->getGraphCommits(100, static_cast<int>(skip));
-                if (!more.empty()) {
-                    std::lock_guard<std::mutex> lock(data_mutex_);
-                    // Append new commits
-                    graph_commits_.insert(graph_commits_.end(), more.begin(), more.end());
-                }
-            } catch (...) {
-                // ignore errors; UI will remain with existing commits
-            }
-            graph_loading_ = false;
-        }).detach();
+    // If we've rendered to the end of currently loaded commits, read the next page from the stream
+    if (end == graph_commits_.size()) {
+        loadMoreGraphCommits();
     }
 
     if (graph_commits_.empty()) {
@@ -2948,12 +2982,15 @@ std::string GitPanel::getCachedRepoPathDisplay() {
         return cached_repo_path_display_;
     }
 
-    // Update cache
-    std::string repo_root = git_manager_->getRepositoryRoot();
-    cached_repo_path_display_ = repo_root.empty() ? "." : repo_root;
+    // 渲染路径上不执行 git 命令：返回旧值，由服务线程异步更新
     last_repo_display_update_ = now;
+    git_service_->post("repo_display", [this](GitManager& manager) {
+        std::string repo_root = manager.getRepositoryRoot();
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        cached_repo_path_display_ = repo_root.empty() ? "." : repo_root;
+    });
 
-    return cached_repo_path_display_;
+    return cached_repo_path_display_.empty() ? "." : cached_repo_path_display_;
 }
 
 std::string GitPanel::getCachedCurrentBranch() {
@@ -2966,9 +3003,13 @@ std::string GitPanel::getCachedCurrentBranch() {
         return cached_current_branch_;
     }
 
-    // Update cache
-    cached_current_branch_ = git_manager_->getCurrentBranch();
+    // 渲染路径上不执行 git 命令：返回旧值，由服务线程异步更新
     last_branch_update_ = now;
+    git_service_->post("current_branch", [this](GitManager& manager) {
+        std::string branch = manager.getCurrentBranch();
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        cached_current_branch_ = std::move(branch);
+    });
 
     return cached_current_branch_;
 }
@@ -2984,9 +3025,13 @@ GitBranchStatus GitPanel::getCachedBranchStatus() {
         return cached_branch_status_;
     }
 
-    // Update cache
-    cached_branch_status_ = git_manager_->getBranchStatus();
+    // 渲染路径上不执行 git 命令（rev-parse + rev-list 计数）：返回旧值，由服务线程异步更新
     last_branch_status_update_ = now;
+    git_service_->post("branch_status", [this](GitManager& manager) {
+        GitBranchStatus status = manager.getBranchStatus();
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        cached_branch_status_ = status;
+    });
 
     return cached_branch_status_;
 }
@@ -3039,12 +3084,19 @@ void GitPanel::ensureValidIndices() {
 
 void GitPanel::showDiffViewer(const std::string& file_path) {
     current_diff_file_ = file_path;
-    diff_content_ = git_manager_->getDiff(file_path);
+    std::string error;
+    git_service_->runExclusive([&](GitManager& manager) {
+        diff_content_ = manager.getDiff(file_path);
+        error = manager.getLastError();
+        manager.clearError();
+    });
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        error_message_ = std::move(error);
+    }
     diff_scroll_offset_ = 0;
     diff_h_offset_ = 0; // 重置水平滚动
     diff_viewer_visible_ = true;
-    error_message_ = git_manager_->getLastError();
-    git_manager_->clearError();
 }
 
 void GitPanel::hideDiffViewer() {
@@ -1,31 +1,25 @@
 #include "ui/statusbar.h"
 #include "ui/icons.h"
 #include "utils/file_type_icon_mapper.h"
-#include <array>
+#include "utils/process_executor.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <future>
 #include <iomanip>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <thread>
+#include <sys/utsname.h>
 #include <unordered_map>
 
 using namespace ftxui;
 // 不使用 using namespace icons，避免 FILE 名称冲突
 
-// 自定义删除器用于 FILE*，避免函数指针属性警告
-struct FileDeleter {
-    void operator()(FILE* file) const {
-        if (file) {
-            pclose(file);
-        }
-    }
-};
-
 namespace pnana {
 namespace ui {
 
@@ -537,21 +531,19 @@ std::string Statusbar::getPlatformIcon() {
 }
 
 std::string Statusbar::getOperatingSystem() {
-    std::array<char, 256> buffer;
-    std::string result;
+    // 首次渲染状态栏时调用：直接读取文件与 uname(2)，不启动子进程
 
     // 首先尝试读取 /etc/os-release (Linux)
-    std::unique_ptr<FILE, FileDeleter> pipe(popen(
-        "cat /etc/os-release 2>/dev/null | grep PRETTY_NAME | cut -d'=' -f2 | tr -d '\"'", "r"));
-    if (pipe) {
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            result += buffer.data();
+    std::ifstream os_release("/etc/os-release");
+    std::string line;
+    while (std::getline(os_release, line)) {
+        if (line.rfind("PRETTY_NAME=", 0) != 0) {
+            continue;
         }
-        if (!result.empty()) {
-            // 移除末尾换行符
-            if (result.back() == '\n')
-                result.pop_back();
-            return result;
+        std::string value = line.substr(std::strlen("PRETTY_NAME="));
+        value.erase(std::remove(value.begin(), value.end(), '"'), value.end());
+        if (!value.empty()) {
+            return value;
         }
     }
 
@@ -561,32 +553,10 @@ std::string Statusbar::getOperatingSystem() {
         return "Windows";
     }
 
-    // macOS检测
-    pipe.reset(popen("sw_vers -productName 2>/dev/null", "r"));
-    if (pipe) {
-        result.clear();
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            result += buffer.data();
-        }
-        if (!result.empty()) {
-            if (result.back() == '\n')
-                result.pop_back();
-            return result;
-        }
-    }
-
-    // FreeBSD/OpenBSD/NetBSD
-    pipe.reset(popen("uname -s 2>/dev/null", "r"));
-    if (pipe) {
-        result.clear();
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            result += buffer.data();
-        }
-        if (!result.empty()) {
-            if (result.back() == '\n')
-                result.pop_back();
-            return result;
-        }
+    // macOS（Darwin）/ FreeBSD / OpenBSD / NetBSD
+    struct utsname info;
+    if (uname(&info) == 0 && info.sysname[0] != '\0') {
+        return info.sysname;
     }
 
     // 如果都检测不到，返回Unknown
@@ -607,56 +577,47 @@ Element Statusbar::createIndicator(const std::string& icon, const std::string& l
 
 // Git相关方法实现
 std::tuple<std::string, int> Statusbar::getGitInfo() {
-    std::string branch = getGitBranch();
-    int uncommitted_count = getGitUncommittedCount();
-    return std::make_tuple(branch, uncommitted_count);
-}
-
-std::string Statusbar::getGitBranch() {
-    // 执行 git branch --show-current 命令获取当前分支
-    std::array<char, 128> buffer;
-    std::string result;
-
-    // 使用 popen 执行 git 命令
-    std::unique_ptr<FILE, FileDeleter> pipe(popen("git branch --show-current 2>/dev/null", "r"));
-    if (!pipe) {
-        return "";
+    utils::ProcessRequest request;
+    request.argv = {"git", "status", "--porcelain", "--branch"};
+    request.timeout_ms = GIT_STATUS_TIMEOUT_MS;
+    utils::ProcessResult result = utils::ProcessExecutor::getInstance().run(std::move(request));
+    if (!result.ok()) {
+        return std::make_tuple(std::string(), 0);
     }
-
-    // 读取命令输出
-    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-        result += buffer.data();
-    }
-
-    // 移除末尾的换行符
-    if (!result.empty() && result.back() == '\n') {
-        result.pop_back();
-    }
-
-    return result;
+    return parseGitStatus(result.output);
 }
 
-int Statusbar::getGitUncommittedCount() {
-    // 执行 git status --porcelain 命令获取未提交的文件数
-    std::array<char, 1024> buffer;
-    std::string result;
+std::tuple<std::string, int> Statusbar::parseGitStatus(const std::string& output) {
+    // 首行为 "## <分支>...<上游> [ahead N]"，其余每行代表一个未提交的文件
+    std::string branch;
     int count = 0;
-
-    // 使用 popen 执行 git 命令
-    std::unique_ptr<FILE, FileDeleter> pipe(popen("git status --porcelain 2>/dev/null", "r"));
-    if (!pipe) {
-        return 0;
-    }
-
-    // 读取命令输出并计数
-    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-        // 每行代表一个未提交的文件
-        if (strlen(buffer.data()) > 0) {
+    std::istringstream stream(output);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        if (line.rfind("## ", 0) != 0) {
             count++;
+            continue;
         }
-    }
 
-    return count;
+        branch = line.substr(3);
+        const std::string no_commits = "No commits yet on ";
+        if (branch.rfind(no_commits, 0) == 0) {
+            branch.erase(0, no_commits.size());
+        } else if (branch.rfind("HEAD (no branch)", 0) == 0) {
+            branch.clear(); // 分离 HEAD，与 git branch --show-current 一致
+        }
+        size_t end = branch.find("...");
+        if (end == std::string::npos) {
+            end = branch.find(' ');
+        }
+        if (end != std::string::npos) {
+            branch.resize(end);
+        }
+    }
+    return std::make_tuple(branch, count);
 }
 
 } // namespace ui
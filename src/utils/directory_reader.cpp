@@ -0,0 +1,126 @@
+#include "utils/directory_reader.h"
+#include <algorithm>
+#include <cctype>
+#include <dirent.h>
+#include <fcntl.h>
+#include <numeric>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace pnana {
+namespace utils {
+
+namespace {
+
+#ifdef __linux__
+// 内核返回的目录项（glibc 较老的版本不导出 getdents64 与该结构）
+struct LinuxDirent64 {
+    ino64_t d_ino;
+    off64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+constexpr size_t GETDENTS_BUFFER_SIZE = 64 * 1024;
+#endif
+
+bool isDotOrDotDot(const char* name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+// d_type 无法确定是否为目录时才 stat（跟随符号链接，与 fs::is_directory 一致）
+bool resolveIsDirectory(int dir_fd, const char* name, unsigned char d_type) {
+    if (d_type == DT_DIR) {
+        return true;
+    }
+    if (d_type != DT_UNKNOWN && d_type != DT_LNK) {
+        return false;
+    }
+    struct stat st;
+    return fstatat(dir_fd, name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+}
+
+} // namespace
+
+bool readDirectory(const std::string& path, bool include_hidden,
+                   std::vector<DirectoryEntry>& entries) {
+    entries.clear();
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+#ifdef __linux__
+    std::vector<char> buffer(GETDENTS_BUFFER_SIZE);
+    while (true) {
+        long bytes = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (bytes <= 0) {
+            break;
+        }
+        for (long offset = 0; offset < bytes;) {
+            auto* dirent = reinterpret_cast<LinuxDirent64*>(buffer.data() + offset);
+            offset += dirent->d_reclen;
+            const char* name = dirent->d_name;
+            if (isDotOrDotDot(name) || (!include_hidden && name[0] == '.')) {
+                continue;
+            }
+            entries.push_back(DirectoryEntry{name, resolveIsDirectory(fd, name, dirent->d_type)});
+        }
+    }
+    close(fd);
+#else
+    DIR* dir = fdopendir(fd);
+    if (!dir) {
+        close(fd);
+        return false;
+    }
+    while (struct dirent* dirent = readdir(dir)) {
+        const char* name = dirent->d_name;
+        if (isDotOrDotDot(name) || (!include_hidden && name[0] == '.')) {
+            continue;
+        }
+        entries.push_back(DirectoryEntry{name, resolveIsDirectory(fd, name, dirent->d_type)});
+    }
+    closedir(dir); // 同时关闭 fd
+#endif
+    return true;
+}
+
+void sortDirectoryEntries(std::vector<DirectoryEntry>& entries) {
+    std::vector<std::string> keys;
+    keys.reserve(entries.size());
+    for (const auto& entry : entries) {
+        std::string key = entry.name;
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        keys.push_back(std::move(key));
+    }
+
+    std::vector<size_t> order(entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (entries[a].is_directory != entries[b].is_directory) {
+            return entries[a].is_directory;
+        }
+        if (keys[a] != keys[b]) {
+            return keys[a] < keys[b];
+        }
+        return entries[a].name < entries[b].name;
+    });
+
+    std::vector<DirectoryEntry> sorted;
+    sorted.reserve(entries.size());
+    for (size_t index : order) {
+        sorted.push_back(std::move(entries[index]));
+    }
+    entries = std::move(sorted);
+}
+
+} // namespace utils
+} // namespace pnana
@@ -1,7 +1,8 @@
 #include "utils/logger.h"
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
-#include <iomanip>
 #include <iostream>
 #include <sstream>
 
@@ -20,9 +21,22 @@ void Logger::initialize(const std::string& log_file) {
         return;
     }
 
+    if (const char* level = std::getenv("PNANA_LOG_LEVEL")) {
+        if (std::strcmp(level, "debug") == 0) {
+            setMinLevel(LogLevel::DEBUG);
+        } else if (std::strcmp(level, "info") == 0) {
+            setMinLevel(LogLevel::INFO);
+        } else if (std::strcmp(level, "warn") == 0 || std::strcmp(level, "warning") == 0) {
+            setMinLevel(LogLevel::WARNING);
+        } else if (std::strcmp(level, "error") == 0) {
+            setMinLevel(LogLevel::ERROR);
+        }
+    }
+
     log_file_.open(log_file, std::ios::app);
     if (log_file_.is_open()) {
         initialized_ = true;
+        enabled_.store(true, std::memory_order_release);
     }
 }
 
@@ -33,28 +47,34 @@ Logger::~Logger() {
 void Logger::close() {
     std::lock_guard<std::mutex> lock(log_mutex_);
 
+    enabled_.store(false, std::memory_order_release);
     if (log_file_.is_open()) {
         log_file_.close();
     }
     initialized_ = false;
 }
 
-std::string Logger::getTimestamp() {
+void Logger::writeTimestamp() {
     using namespace std::chrono;
     const auto now = system_clock::now();
-    const auto tt = system_clock::to_time_t(now);
-    const auto tm = *std::localtime(&tt);
-    const auto ms = duration_cast<milliseconds>(now.time_since_epoch()) % 1000;
+    const auto since_epoch = duration_cast<milliseconds>(now.time_since_epoch()).count();
+    const long long second = since_epoch / 1000;
+    const int ms = static_cast<int>(since_epoch % 1000);
+
+    // localtime + put_time 较慢，同一秒内复用已格式化的前缀
+    if (second != cached_second_) {
+        const auto tt = system_clock::to_time_t(now);
+        const auto tm = *std::localtime(&tt);
+        char buf[32];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+        cached_second_text_ = buf;
+        cached_second_ = second;
+    }
 
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << "." << std::setw(3) << std::setfill('0')
-        << ms.count();
-    return oss.str();
-}
-
-bool Logger::isEnabled() const {
-    std::lock_guard<std::mutex> lock(log_mutex_);
-    return initialized_ && log_file_.is_open();
+    char ms_text[5] = {'.', static_cast<char>('0' + ms / 100),
+                       static_cast<char>('0' + ms / 10 % 10), static_cast<char>('0' + ms % 10),
+                       '\0'};
+    log_file_ << cached_second_text_ << ms_text;
 }
 
 void Logger::writeLog(const std::string& level, const std::string& message) {
@@ -65,8 +85,9 @@ void Logger::writeLog(const std::string& level, const std::string& message) {
         return;
     }
 
-    std::string timestamp = getTimestamp();
-    log_file_ << "[" << timestamp << "] [" << level << "] " << message << std::endl;
+    log_file_ << "[";
+    writeTimestamp();
+    log_file_ << "] [" << level << "] " << message << '\n';
     log_file_.flush();
 }
 
@@ -86,34 +107,6 @@ void Logger::logDebug(const std::string& message) {
     writeLog("DEBUG", message);
 }
 
-void Logger::startTiming(const std::string& label) {
-    std::lock_guard<std::mutex> lock(timing_mutex_);
-    timing_points_[label] = std::chrono::steady_clock::now();
-}
-
-void Logger::endTiming(const std::string& label, const std::string& context) {
-    std::lock_guard<std::mutex> lock(timing_mutex_);
-
-    auto it = timing_points_.find(label);
-    if (it == timing_points_.end()) {
-        return; // 没有找到对应的开始点
-    }
-
-    auto end_time = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - it->second);
-
-    std::ostringstream oss;
-    oss << "TIMING [" << label << "]: " << duration.count() << "ms";
-    if (!context.empty()) {
-        oss << " - " << context;
-    }
-
-    timing_points_.erase(it);
-
-    // 使用 INFO 级别记录性能数据
-    writeLog("INFO", oss.str());
-}
-
 void Logger::recordMetric(const std::string& metric_name, long long value,
                           const std::string& context) {
     std::ostringstream oss;
@@ -0,0 +1,123 @@
+#include "utils/perf_monitor.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace pnana {
+namespace utils {
+
+namespace {
+
+std::string formatMillis(int64_t us) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.1fms", static_cast<double>(us) / 1000.0);
+    return buf;
+}
+
+} // namespace
+
+void PerfZoneScope::end() {
+    if (!active_) {
+        return;
+    }
+    active_ = false;
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now() - start_)
+                     .count();
+    PerfMonitor::getInstance().addZoneTime(zone_, ns);
+    PERF_EVENT(PerfEventId::ZONE, static_cast<int64_t>(zone_), ns);
+    if (perfZoneLogged(zone_)) {
+        LOG("TIMING [" + std::string(perfZoneName(zone_)) + "]: " + std::to_string(ns / 1000000) +
+            "ms");
+    }
+}
+
+void PerfMonitor::setHudEnabled(bool enabled) {
+    hud_enabled_.store(enabled, std::memory_order_relaxed);
+    if (enabled && !PerfTrace::getInstance().isCapturing()) {
+        PerfTrace::getInstance().startCapture();
+    }
+}
+
+void PerfMonitor::endFrame(int64_t frame_ns) {
+    int64_t frame_us = frame_ns / 1000;
+    frame_us_[frame_count_ % FRAME_HISTORY] = frame_us;
+    ++frame_count_;
+
+    for (size_t i = 0; i < ZONE_COUNT; ++i) {
+        last_zone_ns_[i] = zone_ns_[i].exchange(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        last_counters_[i] = counters_[i].exchange(0, std::memory_order_relaxed);
+    }
+
+    PERF_EVENT(PerfEventId::ZONE, static_cast<int64_t>(PerfZoneId::RENDER_UI), frame_ns);
+    PERF_EVENT(PerfEventId::RENDER_FRAME, frame_us,
+               last_counters_[static_cast<size_t>(PerfCounter::LINES_HIGHLIGHTED)],
+               last_counters_[static_cast<size_t>(PerfCounter::PTY_BYTES_FED)],
+               last_counters_[static_cast<size_t>(PerfCounter::LSP_QUEUE_DEPTH)]);
+}
+
+PerfFrameStats PerfMonitor::frameStats() {
+    // 分位数每 15 帧重算一次，HUD 每帧读取也只是一次拷贝
+    if (cached_stats_.frames > 0 && frame_count_ - cached_stats_frame_ < 15) {
+        return cached_stats_;
+    }
+    size_t n = std::min(frame_count_, FRAME_HISTORY);
+    PerfFrameStats stats;
+    stats.frames = n;
+    if (n > 0) {
+        std::vector<int64_t> sorted(frame_us_.begin(), frame_us_.begin() + n);
+        std::sort(sorted.begin(), sorted.end());
+        auto at = [&](double q) {
+            return sorted[std::min(n - 1, static_cast<size_t>(q * static_cast<double>(n)))];
+        };
+        stats.p50_us = at(0.50);
+        stats.p95_us = at(0.95);
+        stats.p99_us = at(0.99);
+        stats.max_us = sorted.back();
+    }
+    cached_stats_ = stats;
+    cached_stats_frame_ = frame_count_;
+    return stats;
+}
+
+std::string PerfMonitor::hudText() {
+    PerfFrameStats stats = frameStats();
+    if (stats.frames == 0) {
+        return "frame --";
+    }
+    std::string text = "frame p50 " + formatMillis(stats.p50_us) + " p95 " +
+                       formatMillis(stats.p95_us) + " p99 " + formatMillis(stats.p99_us);
+
+    // 上一帧耗时最多的区域（RENDER_UI 是整帧，不参与比较）
+    size_t slowest = ZONE_COUNT;
+    for (size_t i = 0; i < ZONE_COUNT; ++i) {
+        if (i == static_cast<size_t>(PerfZoneId::RENDER_UI) || last_zone_ns_[i] <= 0)
+            continue;
+        if (slowest == ZONE_COUNT || last_zone_ns_[i] > last_zone_ns_[slowest])
+            slowest = i;
+    }
+    if (slowest != ZONE_COUNT) {
+        std::string name = perfZoneName(static_cast<PerfZoneId>(slowest));
+        size_t dot = name.find('.');
+        text += " | " + (dot == std::string::npos ? name : name.substr(dot + 1)) + " " +
+                formatMillis(last_zone_ns_[slowest] / 1000);
+    }
+
+    text += " | hl " +
+            std::to_string(last_counters_[static_cast<size_t>(PerfCounter::LINES_HIGHLIGHTED)]);
+    int64_t pty = last_counters_[static_cast<size_t>(PerfCounter::PTY_BYTES_FED)];
+    if (pty > 0) {
+        text += " | pty " + std::to_string(pty) + "B";
+    }
+    int64_t lsp = last_counters_[static_cast<size_t>(PerfCounter::LSP_QUEUE_DEPTH)];
+    if (lsp > 0) {
+        text += " | lsp " + std::to_string(lsp);
+    }
+    return text;
+}
+
+} // namespace utils
+} // namespace pnana
@@ -0,0 +1,369 @@
+#include "utils/perf_trace.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+
+namespace pnana {
+namespace utils {
+
+namespace {
+
+struct PerfEventInfo {
+    PerfEventId id;
+    const char* name;
+    const char* args;
+};
+
+const PerfEventInfo PERF_EVENT_TABLE[] = {
+#define PNANA_PERF_EVENT_INFO(id, name, args) {PerfEventId::id, name, args},
+    PNANA_PERF_EVENTS(PNANA_PERF_EVENT_INFO)
+#undef PNANA_PERF_EVENT_INFO
+};
+
+const char* const PERF_ZONE_NAMES[] = {
+#define PNANA_PERF_ZONE_NAME(id, name, log) name,
+    PNANA_PERF_ZONES(PNANA_PERF_ZONE_NAME)
+#undef PNANA_PERF_ZONE_NAME
+};
+
+uint64_t steadyNanos(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                             since)
+            .count());
+}
+
+// JSON 字符串转义（事件名 / 参数名都是内置常量，这里只需处理最基本的字符）
+void writeJsonString(FILE* out, const char* text) {
+    std::fputc('"', out);
+    for (const char* p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            std::fputc('\\', out);
+        }
+        std::fputc(*p, out);
+    }
+    std::fputc('"', out);
+}
+
+void writeJsonArgs(FILE* out, const char* arg_spec, const int64_t* args) {
+    std::fputs("{", out);
+    const char* p = arg_spec;
+    for (int i = 0; i < 4 && *p; ++i) {
+        const char* end = std::strchr(p, ',');
+        size_t len = end ? static_cast<size_t>(end - p) : std::strlen(p);
+        std::fprintf(out, "%s\"%.*s\":%" PRId64, i > 0 ? "," : "", static_cast<int>(len), p,
+                     args[i]);
+        p = end ? end + 1 : p + len;
+    }
+    std::fputs("}", out);
+}
+
+} // namespace
+
+const char* perfEventName(PerfEventId id) {
+    auto index = static_cast<size_t>(id);
+    return index < static_cast<size_t>(PerfEventId::COUNT) ? PERF_EVENT_TABLE[index].name
+                                                            : "unknown";
+}
+
+const char* perfZoneName(PerfZoneId id) {
+    auto index = static_cast<size_t>(id);
+    return index < static_cast<size_t>(PerfZoneId::COUNT) ? PERF_ZONE_NAMES[index] : "unknown";
+}
+
+PerfTrace::~PerfTrace() {
+    stop();
+}
+
+void PerfTrace::startDrainThreadLocked() {
+    if (drain_thread_.joinable()) {
+        return;
+    }
+    start_time_ = std::chrono::steady_clock::now();
+    start_unix_ns_ = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                               std::chrono::system_clock::now().time_since_epoch())
+                                               .count());
+    stopping_ = false;
+    drain_thread_ = std::thread([this]() {
+        drainLoop();
+    });
+}
+
+bool PerfTrace::start(const std::string& path) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    std::lock_guard<std::mutex> sink_lock(sink_mutex_);
+    if (file_) {
+        return true;
+    }
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        LOG_WARNING("PerfTrace: cannot open " + path);
+        return false;
+    }
+    startDrainThreadLocked();
+    if (!writeHeader()) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+
+    enabled_.store(true, std::memory_order_release);
+    LOG("PerfTrace: writing binary trace to " + path);
+    return true;
+}
+
+void PerfTrace::startCapture() {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    startDrainThreadLocked();
+    capturing_.store(true, std::memory_order_relaxed);
+    enabled_.store(true, std::memory_order_release);
+}
+
+void PerfTrace::stop() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (!drain_thread_.joinable()) {
+            return;
+        }
+        enabled_.store(false, std::memory_order_release);
+        stopping_ = true;
+    }
+    drain_cv_.notify_all();
+    drain_thread_.join();
+
+    std::lock_guard<std::mutex> sink_lock(sink_mutex_);
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    capturing_.store(false, std::memory_order_relaxed);
+}
+
+bool PerfTrace::writeHeader() {
+    auto put = [this](const void* data, size_t size) {
+        return std::fwrite(data, 1, size, file_) == size;
+    };
+
+    uint32_t version = PERF_TRACE_VERSION;
+    uint32_t record_size = sizeof(PerfRecord);
+    uint32_t event_count = static_cast<uint32_t>(PerfEventId::COUNT);
+    uint32_t zone_count = static_cast<uint32_t>(PerfZoneId::COUNT);
+
+    bool ok = put(PERF_TRACE_MAGIC, sizeof(PERF_TRACE_MAGIC)) && put(&version, sizeof(version)) &&
+              put(&record_size, sizeof(record_size)) &&
+              put(&start_unix_ns_, sizeof(start_unix_ns_)) &&
+              put(&event_count, sizeof(event_count));
+    for (const auto& info : PERF_EVENT_TABLE) {
+        uint32_t id = static_cast<uint32_t>(info.id);
+        uint16_t name_len = static_cast<uint16_t>(std::strlen(info.name));
+        uint16_t args_len = static_cast<uint16_t>(std::strlen(info.args));
+        ok = ok && put(&id, sizeof(id)) && put(&name_len, sizeof(name_len)) &&
+             put(info.name, name_len) && put(&args_len, sizeof(args_len)) &&
+             put(info.args, args_len);
+    }
+    ok = ok && put(&zone_count, sizeof(zone_count));
+    for (uint32_t id = 0; id < zone_count; ++id) {
+        uint16_t name_len = static_cast<uint16_t>(std::strlen(PERF_ZONE_NAMES[id]));
+        ok = ok && put(&id, sizeof(id)) && put(&name_len, sizeof(name_len)) &&
+             put(PERF_ZONE_NAMES[id], name_len);
+    }
+    return ok && std::fflush(file_) == 0;
+}
+
+PerfTrace::Ring* PerfTrace::threadRing() {
+    // 线程退出时只标记 retired，环由落盘线程读空后释放，不丢失最后一批事件
+    struct Holder {
+        std::shared_ptr<Ring> ring;
+        ~Holder() {
+            if (ring) {
+                ring->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+    thread_local Holder holder;
+
+    if (!holder.ring) {
+        auto ring = std::make_shared<Ring>();
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        ring->thread_id = next_thread_id_++;
+        rings_.push_back(ring);
+        holder.ring = std::move(ring);
+    }
+    return holder.ring.get();
+}
+
+void PerfTrace::emit(PerfEventId id, int64_t a0, int64_t a1, int64_t a2, int64_t a3) {
+    Ring* ring = threadRing();
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    if (head - tail >= Ring::CAPACITY) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    PerfRecord& record = ring->records[head & (Ring::CAPACITY - 1)];
+    record.timestamp_ns = steadyNanos(start_time_);
+    record.event_id = static_cast<uint32_t>(id);
+    record.thread_id = ring->thread_id;
+    record.args[0] = a0;
+    record.args[1] = a1;
+    record.args[2] = a2;
+    record.args[3] = a3;
+    ring->head.store(head + 1, std::memory_order_release);
+
+    // 突发写入时提前唤醒落盘线程（每次跨过半满只通知一次），减少丢弃
+    if (head - tail == Ring::CAPACITY / 2) {
+        drain_requested_.store(true, std::memory_order_relaxed);
+        drain_cv_.notify_one();
+    }
+}
+
+size_t PerfTrace::drainAll(std::vector<PerfRecord>& scratch) {
+    scratch.clear();
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    for (auto it = rings_.begin(); it != rings_.end();) {
+        Ring& ring = **it;
+        // 先读 retired 再读 head：retired 之后不会再有写入，本轮读空即可释放
+        bool retired = ring.retired.load(std::memory_order_acquire);
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            scratch.push_back(ring.records[tail & (Ring::CAPACITY - 1)]);
+        }
+        ring.tail.store(tail, std::memory_order_release);
+
+        uint64_t dropped = ring.dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            PerfRecord record{};
+            record.timestamp_ns = steadyNanos(start_time_);
+            record.event_id = static_cast<uint32_t>(PerfEventId::TRACE_DROPPED);
+            record.thread_id = ring.thread_id;
+            record.args[0] = static_cast<int64_t>(dropped);
+            scratch.push_back(record);
+        }
+
+        if (retired) {
+            it = rings_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return scratch.size();
+}
+
+void PerfTrace::flush() {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    if (drainAll(scratch_) == 0) {
+        return;
+    }
+    if (file_) {
+        std::fwrite(scratch_.data(), sizeof(PerfRecord), scratch_.size(), file_);
+        std::fflush(file_);
+    }
+    if (capturing_.load(std::memory_order_relaxed)) {
+        capture_.insert(capture_.end(), scratch_.begin(), scratch_.end());
+        if (capture_.size() > CAPTURE_LIMIT) {
+            capture_.erase(capture_.begin(),
+                           capture_.begin() +
+                               static_cast<std::ptrdiff_t>(capture_.size() - CAPTURE_LIMIT));
+        }
+    }
+}
+
+void PerfTrace::drainLoop() {
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(state_mutex_);
+            drain_cv_.wait_for(lock, std::chrono::milliseconds(100), [this]() {
+                return stopping_ || drain_requested_.exchange(false, std::memory_order_relaxed);
+            });
+            stopping = stopping_;
+        }
+
+        flush();
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+bool PerfTrace::exportChromeTrace(const std::string& path, std::string& error) {
+    if (!isCapturing()) {
+        error = "performance capture is not running";
+        return false;
+    }
+    flush();
+
+    std::vector<PerfRecord> records;
+    {
+        std::lock_guard<std::mutex> lock(sink_mutex_);
+        records.assign(capture_.begin(), capture_.end());
+    }
+    return writeChromeTrace(path, records, error);
+}
+
+bool PerfTrace::writeChromeTrace(const std::string& path, const std::vector<PerfRecord>& records,
+                                 std::string& error) {
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    // 各线程的记录是分批写出的，先按时间排序
+    std::vector<PerfRecord> sorted(records);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const PerfRecord& a, const PerfRecord& b) {
+        return a.timestamp_ns < b.timestamp_ns;
+    });
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", out);
+    bool first = true;
+    for (const auto& record : sorted) {
+        if (record.event_id >= static_cast<uint32_t>(PerfEventId::COUNT)) {
+            continue;
+        }
+        const PerfEventInfo& info = PERF_EVENT_TABLE[record.event_id];
+        double ts_us = static_cast<double>(record.timestamp_ns) / 1000.0;
+        std::fputs(first ? "" : ",\n", out);
+        first = false;
+
+        auto id = static_cast<PerfEventId>(record.event_id);
+        if (id == PerfEventId::ZONE) {
+            // 区间：时间戳是结束时刻，起点 = 结束 - 时长
+            double dur_us = static_cast<double>(record.args[1]) / 1000.0;
+            std::fputs("{\"ph\":\"X\",\"cat\":\"zone\",\"name\":", out);
+            writeJsonString(out, perfZoneName(static_cast<PerfZoneId>(record.args[0])));
+            std::fprintf(out, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", record.thread_id,
+                         std::max(0.0, ts_us - dur_us), dur_us);
+        } else if (id == PerfEventId::RENDER_FRAME) {
+            // 每帧计数器画成 counter 轨道
+            std::fprintf(out, "{\"ph\":\"C\",\"name\":\"frame\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,",
+                         record.thread_id, ts_us);
+            std::fputs("\"args\":", out);
+            writeJsonArgs(out, info.args, record.args);
+            std::fputs("}", out);
+        } else {
+            std::fputs("{\"ph\":\"i\",\"s\":\"t\",\"cat\":\"event\",\"name\":", out);
+            writeJsonString(out, info.name);
+            std::fprintf(out, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":", record.thread_id,
+                         ts_us);
+            writeJsonArgs(out, info.args, record.args);
+            std::fputs("}", out);
+        }
+    }
+    std::fputs("\n]}\n", out);
+
+    bool ok = std::ferror(out) == 0;
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok) {
+        error = "failed to write " + path;
+    }
+    return ok;
+}
+
+} // namespace utils
+} // namespace pnana
@@ -0,0 +1,507 @@
+#include "utils/process_executor.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace pnana {
+namespace utils {
+
+namespace {
+
+// 管道已关闭但子进程尚未回收（或孙进程仍占用管道）时轮询 waitpid 的间隔
+constexpr int REAP_POLL_MS = 20;
+constexpr int IDLE_POLL_MS = 100;
+constexpr size_t READ_CHUNK = 64 * 1024;
+// 单次处理一个管道最多读取的块数，避免持续输出的进程独占 IO 线程
+constexpr int MAX_READS_PER_WAKE = 16;
+
+// 读端非阻塞，两端 close-on-exec（dup2 到子进程标准流的副本不受影响）
+bool makePipe(int fds[2]) {
+#if defined(__linux__) || defined(__FreeBSD__)
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return false;
+    }
+#else
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void closeFd(int& fd) {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+} // namespace
+
+ProcessRequest ProcessRequest::shell(const std::string& command) {
+    ProcessRequest request;
+    request.argv = {"/bin/sh", "-c", command};
+    return request;
+}
+
+ProcessExecutor::ProcessExecutor() {
+    if (makePipe(wake_fds_)) {
+        fcntl(wake_fds_[1], F_SETFL, fcntl(wake_fds_[1], F_GETFL) | O_NONBLOCK);
+    } else {
+        LOG_ERROR("ProcessExecutor: failed to create wake pipe: " +
+                  std::string(std::strerror(errno)));
+    }
+    io_thread_ = std::thread(&ProcessExecutor::ioLoop, this);
+}
+
+ProcessExecutor::~ProcessExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake();
+    if (io_thread_.joinable()) {
+        io_thread_.join();
+    }
+    closeFd(wake_fds_[0]);
+    closeFd(wake_fds_[1]);
+}
+
+void ProcessExecutor::wake() {
+    if (wake_fds_[1] < 0) {
+        return;
+    }
+    char byte = 1;
+    ssize_t written = write(wake_fds_[1], &byte, 1);
+    (void)written; // 管道已满说明 IO 线程已有待处理的唤醒
+}
+
+ProcessExecutor::JobId ProcessExecutor::submit(ProcessRequest request, Callback on_done) {
+    auto job = std::make_unique<Job>();
+    job->request = std::move(request);
+    job->on_done = std::move(on_done);
+
+    JobId id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = next_id_++;
+        job->id = id;
+        active_ids_.insert(id);
+        queued_.push_back(std::move(job));
+    }
+    wake();
+    return id;
+}
+
+ProcessResult ProcessExecutor::run(ProcessRequest request) {
+    request.post_to_ui = false;
+    auto promise = std::make_shared<std::promise<ProcessResult>>();
+    std::future<ProcessResult> future = promise->get_future();
+    submit(std::move(request), [promise](const ProcessResult& result) {
+        promise->set_value(result);
+    });
+    try {
+        return future.get();
+    } catch (const std::future_error&) {
+        // 执行服务在任务完成前析构（进程退出中）
+        ProcessResult result;
+        result.cancelled = true;
+        return result;
+    }
+}
+
+bool ProcessExecutor::cancel(JobId id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (active_ids_.find(id) == active_ids_.end()) {
+            return false;
+        }
+        cancel_requests_.insert(id);
+    }
+    wake();
+    return true;
+}
+
+void ProcessExecutor::setMaxConcurrent(size_t max_concurrent) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_concurrent_ = std::max<size_t>(1, max_concurrent);
+    }
+    wake();
+}
+
+void ProcessExecutor::setUIDispatcher(UIDispatcher dispatcher) {
+    std::lock_guard<std::mutex> lock(dispatcher_mutex_);
+    dispatcher_ = std::move(dispatcher);
+}
+
+size_t ProcessExecutor::activeCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_ids_.size();
+}
+
+bool ProcessExecutor::findExecutable(const std::string& name) {
+    return !resolveExecutable(name).empty();
+}
+
+std::string ProcessExecutor::resolveExecutable(const std::string& name) {
+    if (name.empty()) {
+        return "";
+    }
+    auto executable = [](const std::string& path) {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) &&
+               access(path.c_str(), X_OK) == 0;
+    };
+    if (name.find('/') != std::string::npos) {
+        return executable(name) ? name : "";
+    }
+
+    const char* path_env = std::getenv("PATH");
+    std::string path = path_env ? path_env : "/usr/local/bin:/usr/bin:/bin";
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find(':', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        std::string dir = path.substr(start, end - start);
+        if (dir.empty()) {
+            dir = ".";
+        }
+        std::string candidate = dir + "/" + name;
+        if (executable(candidate)) {
+            return candidate;
+        }
+        start = end + 1;
+    }
+    return "";
+}
+
+void ProcessExecutor::ioLoop() {
+    std::vector<pollfd> poll_fds;
+    std::vector<std::pair<Job*, int*>> poll_targets;
+
+    while (true) {
+        std::vector<std::unique_ptr<Job>> to_start;
+        std::vector<std::unique_ptr<Job>> cancelled_queued;
+        std::unordered_set<JobId> cancels;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) {
+                break;
+            }
+            cancels.swap(cancel_requests_);
+            for (auto it = queued_.begin(); it != queued_.end();) {
+                if (cancels.count((*it)->id) > 0) {
+                    cancelled_queued.push_back(std::move(*it));
+                    it = queued_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            while (!queued_.empty() && running_.size() + to_start.size() < max_concurrent_) {
+                to_start.push_back(std::move(queued_.front()));
+                queued_.pop_front();
+            }
+        }
+
+        // 排队中的任务被取消时不再启动
+        for (auto& job : cancelled_queued) {
+            job->result.cancelled = true;
+            finish(std::move(job));
+        }
+        for (auto& job : running_) {
+            if (!job->killed && cancels.count(job->id) > 0) {
+                job->result.cancelled = true;
+                killJob(*job);
+            }
+        }
+        for (auto& job : to_start) {
+            startJob(std::move(job));
+        }
+
+        // 超时检查，同时算出 poll 的等待时间
+        auto now = std::chrono::steady_clock::now();
+        int timeout_ms = running_.empty() ? -1 : IDLE_POLL_MS;
+        for (auto& job : running_) {
+            if (job->out_fd < 0 && job->err_fd < 0) {
+                timeout_ms = std::min(timeout_ms, REAP_POLL_MS);
+            }
+            if (!job->has_deadline || job->killed) {
+                continue;
+            }
+            if (now >= job->deadline) {
+                job->result.timed_out = true;
+                killJob(*job);
+                continue;
+            }
+            auto remaining =
+                std::chrono::duration_cast<std::chrono::milliseconds>(job->deadline - now).count();
+            timeout_ms = std::min(timeout_ms, static_cast<int>(remaining) + 1);
+        }
+
+        poll_fds.clear();
+        poll_targets.clear();
+        if (wake_fds_[0] >= 0) {
+            poll_fds.push_back({wake_fds_[0], POLLIN, 0});
+            poll_targets.emplace_back(nullptr, nullptr);
+        } else if (timeout_ms < 0) {
+            timeout_ms = IDLE_POLL_MS; // 没有唤醒管道时只能轮询队列
+        }
+        for (auto& job : running_) {
+            if (job->out_fd >= 0) {
+                poll_fds.push_back({job->out_fd, POLLIN, 0});
+                poll_targets.emplace_back(job.get(), &job->out_fd);
+            }
+            if (job->err_fd >= 0) {
+                poll_fds.push_back({job->err_fd, POLLIN, 0});
+                poll_targets.emplace_back(job.get(), &job->err_fd);
+            }
+        }
+
+        int ready = poll(poll_fds.data(), poll_fds.size(), timeout_ms);
+        if (ready < 0 && errno != EINTR) {
+            LOG_ERROR("ProcessExecutor: poll failed: " + std::string(std::strerror(errno)));
+        }
+
+        for (size_t i = 0; ready > 0 && i < poll_fds.size(); ++i) {
+            if (poll_fds[i].revents == 0) {
+                continue;
+            }
+            Job* job = poll_targets[i].first;
+            if (!job) {
+                char drain[64];
+                while (read(wake_fds_[0], drain, sizeof(drain)) > 0) {
+                }
+                continue;
+            }
+            int* fd = poll_targets[i].second;
+            readOutput(*job, *fd, fd == &job->out_fd ? job->result.output
+                                                     : job->result.error_output);
+        }
+
+        // 回收已退出的子进程；仍被孙进程占用的管道读完已有数据后直接关闭，不再等待
+        for (auto it = running_.begin(); it != running_.end();) {
+            Job& job = **it;
+            if (!reap(job, false)) {
+                ++it;
+                continue;
+            }
+            readOutput(job, job.out_fd, job.result.output);
+            readOutput(job, job.err_fd, job.result.error_output);
+            closeFd(job.out_fd);
+            closeFd(job.err_fd);
+            std::unique_ptr<Job> done = std::move(*it);
+            it = running_.erase(it);
+            finish(std::move(done));
+        }
+    }
+
+    // 退出：终止仍在运行的子进程；回调不再调用（调用方可能已经析构）
+    for (auto& job : running_) {
+        killJob(*job);
+        reap(*job, true);
+        closeFd(job->out_fd);
+        closeFd(job->err_fd);
+    }
+    running_.clear();
+}
+
+void ProcessExecutor::startJob(std::unique_ptr<Job> job) {
+    const ProcessRequest& request = job->request;
+    if (request.argv.empty()) {
+        job->result.error = "empty argv";
+        finish(std::move(job));
+        return;
+    }
+
+    // posix_spawn 没有可移植的 chdir 动作：需要切换目录时经 sh 切换后 exec 目标程序
+    std::vector<std::string> argv;
+    if (!request.cwd.empty()) {
+        argv = {"/bin/sh", "-c", "cd -- \"$0\" && exec \"$@\"", request.cwd};
+    }
+    argv.insert(argv.end(), request.argv.begin(), request.argv.end());
+
+    const bool pipe_stdout = request.stdout_path.empty();
+    int out_pipe[2] = {-1, -1};
+    int err_pipe[2] = {-1, -1};
+    if ((pipe_stdout && !makePipe(out_pipe)) || !makePipe(err_pipe)) {
+        job->result.error = std::string("pipe: ") + std::strerror(errno);
+        closeFd(out_pipe[0]);
+        closeFd(out_pipe[1]);
+        finish(std::move(job));
+        return;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    if (pipe_stdout) {
+        posix_spawn_file_actions_adddup2(&actions, out_pipe[1], STDOUT_FILENO);
+    } else {
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, request.stdout_path.c_str(),
+                                         O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    posix_spawn_file_actions_adddup2(&actions, err_pipe[1], STDERR_FILENO);
+
+    // 子进程自成进程组，超时或取消时整组终止；恢复默认的 SIGPIPE 处理与空信号掩码
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setpgroup(&attr, 0);
+    sigset_t default_signals;
+    sigemptyset(&default_signals);
+    sigaddset(&default_signals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &default_signals);
+    sigset_t empty_mask;
+    sigemptyset(&empty_mask);
+    posix_spawnattr_setsigmask(&attr, &empty_mask);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF |
+                                        POSIX_SPAWN_SETSIGMASK);
+
+    std::vector<char*> args;
+    args.reserve(argv.size() + 1);
+    for (const auto& arg : argv) {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    pid_t pid = -1;
+    int rc = posix_spawnp(&pid, args[0], &actions, &attr, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    closeFd(out_pipe[1]);
+    closeFd(err_pipe[1]);
+    if (rc != 0) {
+        closeFd(out_pipe[0]);
+        closeFd(err_pipe[0]);
+        job->result.error = "failed to spawn " + argv[0] + ": " + std::strerror(rc);
+        LOG_WARNING("ProcessExecutor: " + job->result.error);
+        finish(std::move(job));
+        return;
+    }
+
+    job->pid = pid;
+    job->out_fd = out_pipe[0];
+    job->err_fd = err_pipe[0];
+    job->result.spawned = true;
+    if (request.timeout_ms > 0) {
+        job->has_deadline = true;
+        job->deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(request.timeout_ms);
+    }
+    running_.push_back(std::move(job));
+}
+
+void ProcessExecutor::readOutput(Job& job, int& fd, std::string& sink) {
+    if (fd < 0) {
+        return;
+    }
+    char buffer[READ_CHUNK];
+    for (int reads = 0; reads < MAX_READS_PER_WAKE; ++reads) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            // 超过上限的部分继续读出并丢弃，子进程不会因管道写满而阻塞
+            const size_t limit = job.request.max_output_bytes;
+            const size_t room = sink.size() < limit ? limit - sink.size() : 0;
+            const size_t take = std::min(room, static_cast<size_t>(n));
+            sink.append(buffer, take);
+            if (take < static_cast<size_t>(n)) {
+                job.result.truncated = true;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        closeFd(fd); // EOF 或读错误
+        return;
+    }
+}
+
+void ProcessExecutor::killJob(Job& job) {
+    job.killed = true;
+    if (job.pid <= 0 || job.exited) {
+        return;
+    }
+    if (kill(-job.pid, SIGKILL) != 0) {
+        kill(job.pid, SIGKILL);
+    }
+}
+
+bool ProcessExecutor::reap(Job& job, bool block) {
+    if (job.exited || job.pid <= 0) {
+        return job.exited;
+    }
+    int status = 0;
+    pid_t rc = -1;
+    do {
+        rc = waitpid(job.pid, &status, block ? 0 : WNOHANG);
+    } while (rc < 0 && errno == EINTR);
+    if (rc == 0) {
+        return false;
+    }
+
+    job.exited = true;
+    if (rc < 0) {
+        job.result.exit_code = -1; // 已被其他地方回收，退出码未知
+    } else if (WIFEXITED(status)) {
+        job.result.exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        job.result.exit_code = 128 + WTERMSIG(status);
+    }
+    return true;
+}
+
+void ProcessExecutor::finish(std::unique_ptr<Job> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ids_.erase(job->id);
+    }
+    if (!job->on_done) {
+        return;
+    }
+
+    if (job->request.post_to_ui) {
+        // UI 已关闭（分发函数被清除）时丢弃回调：它可能访问已析构的编辑器状态
+        std::lock_guard<std::mutex> lock(dispatcher_mutex_);
+        if (dispatcher_) {
+            auto callback = std::move(job->on_done);
+            auto result = std::make_shared<ProcessResult>(std::move(job->result));
+            dispatcher_([callback, result]() {
+                callback(*result);
+            });
+        }
+        return;
+    }
+
+    try {
+        job->on_done(job->result);
+    } catch (const std::exception& e) {
+        LOG_ERROR("ProcessExecutor: callback threw: " + std::string(e.what()));
+    } catch (...) {
+        LOG_ERROR("ProcessExecutor: callback threw an unknown exception");
+    }
+}
+
+} // namespace utils
+} // namespace pnana
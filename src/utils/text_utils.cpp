@@ -1,4 +1,5 @@
 #include "utils/text_utils.h"
+#include <algorithm>
 
 namespace pnana {
 namespace utils {
@@ -145,5 +146,144 @@ size_t getUtf8CharBytesAfter(const std::string& str, size_t pos) {
     return 1;
 }
 
+uint32_t decodeUtf8At(const std::string& str, size_t pos, size_t& bytes) {
+    bytes = 1;
+    if (pos >= str.length()) {
+        return 0;
+    }
+    unsigned char first_byte = static_cast<unsigned char>(str[pos]);
+    if ((first_byte & 0x80) == 0) {
+        return first_byte;
+    }
+
+    size_t needed = getUtf8CharBytesAfter(str, pos);
+    if (needed == 1 || pos + needed > str.length()) {
+        return first_byte;
+    }
+    uint32_t codepoint = first_byte & (0xFF >> (needed + 1));
+    for (size_t i = 1; i < needed; ++i) {
+        unsigned char b = static_cast<unsigned char>(str[pos + i]);
+        if ((b & 0xC0) != 0x80) {
+            // 截断的序列：只消耗首字节
+            return first_byte;
+        }
+        codepoint = (codepoint << 6) | (b & 0x3F);
+    }
+    bytes = needed;
+    return codepoint;
+}
+
+int getCodepointDisplayWidth(uint32_t cp) {
+    if (cp < 0x300) {
+        return 1;
+    }
+    // 组合字符、零宽字符、变体选择符
+    if ((cp >= 0x0300 && cp <= 0x036F) || (cp >= 0x1AB0 && cp <= 0x1AFF) ||
+        (cp >= 0x1DC0 && cp <= 0x1DFF) || (cp >= 0x200B && cp <= 0x200F) ||
+        (cp >= 0x20D0 && cp <= 0x20FF) || (cp >= 0xFE00 && cp <= 0xFE0F) ||
+        (cp >= 0xFE20 && cp <= 0xFE2F) || cp == 0xFEFF) {
+        return 0;
+    }
+    // 东亚宽字符（按 Unicode East Asian Width 的 W/F 主要区段）
+    if ((cp >= 0x1100 && cp <= 0x115F) ||   // 谚文字母
+        (cp >= 0x2E80 && cp <= 0x303E) ||   // CJK 部首、标点
+        (cp >= 0x3041 && cp <= 0x33FF) ||   // 假名、注音、CJK 兼容
+        (cp >= 0x3400 && cp <= 0x4DBF) ||   // CJK 扩展 A
+        (cp >= 0x4E00 && cp <= 0x9FFF) ||   // CJK 基本汉字
+        (cp >= 0xA000 && cp <= 0xA4CF) ||   // 彝文
+        (cp >= 0xAC00 && cp <= 0xD7A3) ||   // 谚文音节
+        (cp >= 0xF900 && cp <= 0xFAFF) ||   // CJK 兼容汉字
+        (cp >= 0xFE30 && cp <= 0xFE4F) ||   // CJK 兼容形式
+        (cp >= 0xFF00 && cp <= 0xFF60) ||   // 全角 ASCII
+        (cp >= 0xFFE0 && cp <= 0xFFE6) ||   // 全角符号
+        (cp >= 0x1F300 && cp <= 0x1F64F) || // emoji
+        (cp >= 0x1F900 && cp <= 0x1F9FF) || // 补充 emoji
+        (cp >= 0x20000 && cp <= 0x3FFFD)) { // CJK 扩展 B 及之后
+        return 2;
+    }
+    return 1;
+}
+
+void wrapByDisplayWidth(const std::string& text, size_t from, int width,
+                        std::vector<std::string>& lines, std::vector<size_t>& line_starts) {
+    width = std::max(1, width);
+    std::string line;
+    int line_width = 0;
+    size_t line_start = from;
+    // 最近的断点：text 中的字节位置，以及断点之前 line 的长度与列数
+    size_t break_pos = std::string::npos;
+    size_t break_len = 0;
+    int break_width = 0;
+
+    size_t pos = from;
+    while (pos < text.size()) {
+        if (text[pos] == '\n') {
+            lines.push_back(std::move(line));
+            line_starts.push_back(line_start);
+            line.clear();
+            line_width = 0;
+            line_start = ++pos;
+            break_pos = std::string::npos;
+            continue;
+        }
+
+        size_t bytes = 1;
+        uint32_t cp = decodeUtf8At(text, pos, bytes);
+        if (cp == '\r') {
+            pos += bytes;
+            continue;
+        }
+        int cp_width = cp == '\t' ? 4 : getCodepointDisplayWidth(cp);
+        if (cp_width == 2 && !line.empty()) {
+            // 宽字符之前可以断开
+            break_pos = pos;
+            break_len = line.size();
+            break_width = line_width;
+        }
+
+        if (line_width + cp_width > width && line_width > 0) {
+            if (break_pos != std::string::npos) {
+                // 断点之后的部分移到下一行
+                std::string rest = line.substr(break_len);
+                line.resize(break_len);
+                lines.push_back(std::move(line));
+                line_starts.push_back(line_start);
+                line = std::move(rest);
+                line_width -= break_width;
+                line_start = break_pos;
+            } else {
+                lines.push_back(std::move(line));
+                line_starts.push_back(line_start);
+                line.clear();
+                line_width = 0;
+                line_start = pos;
+            }
+            break_pos = std::string::npos;
+            // 折行处的空格不放到下一行行首
+            if (line.empty() && cp == ' ') {
+                pos += bytes;
+                line_start = pos;
+                continue;
+            }
+        }
+
+        if (cp == '\t') {
+            line.append(4, ' ');
+        } else {
+            line.append(text, pos, bytes);
+        }
+        line_width += cp_width;
+        pos += bytes;
+        if (cp == ' ' || cp == '\t' || cp_width == 2) {
+            // 空格与宽字符之后可以断开
+            break_pos = pos;
+            break_len = line.size();
+            break_width = line_width;
+        }
+    }
+    lines.push_back(std::move(line));
+    line_starts.push_back(line_start);
+}
+
 } // namespace utils
 } // namespace pnana
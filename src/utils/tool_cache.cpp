@@ -0,0 +1,140 @@
+#include "utils/tool_cache.h"
+#include "utils/logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace pnana {
+namespace utils {
+
+namespace {
+using json = nlohmann::json;
+
+// 文件格式变化时递增，旧文件直接丢弃
+constexpr int CACHE_FORMAT_VERSION = 1;
+} // namespace
+
+ToolCache::ToolCache() {
+    // 与 LSP 服务器的 XDG_CACHE_HOME 同目录
+    const char* home = std::getenv("HOME");
+    std::string cache_dir =
+        (home ? std::string(home) : "/tmp") + (home ? "/.config/pnana/.cache" : "/pnana");
+    path_ = cache_dir + "/tool_cache.json";
+}
+
+std::optional<ToolCache::Entry> ToolCache::get(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    loadLocked();
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void ToolCache::put(const std::string& key, const std::string& fingerprint,
+                    const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    loadLocked();
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.fingerprint == fingerprint &&
+        it->second.value == value) {
+        return;
+    }
+    entries_[key] = Entry{fingerprint, value};
+    saveLocked();
+}
+
+void ToolCache::erase(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    loadLocked();
+    if (entries_.erase(key) > 0) {
+        saveLocked();
+    }
+}
+
+std::string ToolCache::fingerprint(const std::string& executable_path) {
+    if (executable_path.empty()) {
+        return "";
+    }
+    // 跟随符号链接：/usr/bin/python3 -> python3.12 升级后 mtime 随目标变化
+    struct stat st;
+    if (stat(executable_path.c_str(), &st) != 0) {
+        return "";
+    }
+#ifdef __APPLE__
+    long long mtime_ns = static_cast<long long>(st.st_mtimespec.tv_sec) * 1000000000LL +
+                         st.st_mtimespec.tv_nsec;
+#else
+    long long mtime_ns = static_cast<long long>(st.st_mtim.tv_sec) * 1000000000LL +
+                         st.st_mtim.tv_nsec;
+#endif
+    return executable_path + ":" + std::to_string(mtime_ns) + ":" +
+           std::to_string(static_cast<long long>(st.st_size));
+}
+
+void ToolCache::loadLocked() {
+    if (loaded_) {
+        return;
+    }
+    loaded_ = true;
+
+    std::ifstream file(path_);
+    if (!file.is_open()) {
+        return;
+    }
+    try {
+        json root = json::parse(file);
+        if (!root.is_object() || root.value("version", 0) != CACHE_FORMAT_VERSION ||
+            !root.contains("entries") || !root["entries"].is_object()) {
+            return;
+        }
+        for (auto& [key, item] : root["entries"].items()) {
+            if (!item.is_object()) {
+                continue;
+            }
+            entries_[key] = Entry{item.value("fingerprint", ""), item.value("value", "")};
+        }
+    } catch (const std::exception& e) {
+        // 损坏的缓存文件当作空缓存，下次 put() 时覆盖
+        LOG_WARNING("ToolCache: ignoring unreadable " + path_ + ": " + e.what());
+        entries_.clear();
+    }
+}
+
+void ToolCache::saveLocked() {
+    json entries = json::object();
+    for (const auto& [key, entry] : entries_) {
+        entries[key] = {{"fingerprint", entry.fingerprint}, {"value", entry.value}};
+    }
+    json root = {{"version", CACHE_FORMAT_VERSION}, {"entries", std::move(entries)}};
+
+    std::error_code ec;
+    fs::create_directories(fs::path(path_).parent_path(), ec);
+    // 先写临时文件再 rename，多个 pnana 实例同时写入时不会留下半个文件
+    std::string tmp_path = path_ + ".tmp." + std::to_string(static_cast<long long>(getpid()));
+    {
+        std::ofstream file(tmp_path, std::ios::trunc);
+        if (!file.is_open()) {
+            return;
+        }
+        file << root.dump();
+        if (!file.good()) {
+            file.close();
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+    }
+}
+
+} // namespace utils
+} // namespace pnana
@@ -1,38 +1,28 @@
 #include "utils/version_detector.h"
+#include "utils/process_executor.h"
+#include "utils/tool_cache.h"
 #include <algorithm>
-#include <array>
-#include <cstdio>
 #include <cstring>
 #include <regex>
 #include <sstream>
-#include <thread>
 #include <vector>
 
-// 自定义删除器用于 FILE*，避免函数指针属性警告
-struct FileDeleter {
-    void operator()(FILE* file) const {
-        if (file) {
-            pclose(file);
-        }
-    }
-};
-
 namespace pnana {
 namespace utils {
 
 // 缓存有效期（5分钟）
 constexpr std::chrono::minutes VersionDetector::CACHE_DURATION;
 
-VersionDetector::VersionDetector() {}
+VersionDetector::VersionDetector() : cache_(std::make_shared<Cache>()) {}
 
 std::string VersionDetector::getVersionForFileType(const std::string& file_type) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+    std::lock_guard<std::mutex> lock(cache_->mutex);
 
     auto now = std::chrono::steady_clock::now();
-    auto it = version_cache_.find(file_type);
+    auto it = cache_->entries.find(file_type);
 
     // 检查缓存是否存在且未过期
-    if (it != version_cache_.end()) {
+    if (it != cache_->entries.end()) {
         auto& entry = it->second;
         if (now - entry.timestamp < CACHE_DURATION) {
             return entry.version;
@@ -43,36 +33,87 @@ std::string VersionDetector::getVersionForFileType(const std::string& file_type)
         }
     }
 
-    // 如果没有缓存或已过期，异步获取版本信息
-    auto& entry = version_cache_[file_type];
+    bool first_lookup = it == cache_->entries.end();
+    auto& entry = cache_->entries[file_type];
+    std::string command = versionCommandForFileType(file_type);
+    if (command.empty()) {
+        // 不支持的类型同样缓存，避免每帧重新判断
+        entry.version.clear();
+        entry.timestamp = now;
+        entry.is_fetching = false;
+        return "";
+    }
+
+    // 本次会话第一次查询：先用上次会话的结果（可执行文件指纹未变时），首帧不等子进程；
+    // 下面的探测照常进行，在后台刷新内存与磁盘缓存
+    std::string persist_key;
+    std::string fingerprint;
+    if (isPersistable(command)) {
+        persist_key = "version:" + file_type;
+        fingerprint = probeFingerprint(command);
+        if (first_lookup) {
+            auto cached = ToolCache::getInstance().get(persist_key);
+            if (cached && cached->fingerprint == fingerprint) {
+                entry.version = cached->value;
+            }
+        }
+    }
+
+    // 交给子进程执行服务异步探测，渲染线程不等待；回调在执行服务的 IO 线程上更新缓存
     entry.is_fetching = true;
+    std::weak_ptr<Cache> weak_cache = cache_;
+    ProcessRequest request = ProcessRequest::shell(command);
+    request.timeout_ms = PROBE_TIMEOUT_MS;
+    request.max_output_bytes = 64 * 1024;
+    ProcessExecutor::getInstance().submit(
+        std::move(request),
+        [weak_cache, file_type, persist_key, fingerprint](const ProcessResult& result) {
+            std::string version;
+            if (!result.output.empty()) {
+                version = parseVersionString(result.output, file_type);
+            }
+            // 超时的探测结果不可信，不写入磁盘
+            if (!persist_key.empty() && result.spawned && !result.timed_out) {
+                ToolCache::getInstance().put(persist_key, fingerprint, version);
+            }
 
-    // 在后台异步执行版本获取
-    std::thread([this, file_type]() {
-        std::string version = this->fetchVersionForFileType(file_type);
+            std::shared_ptr<Cache> cache = weak_cache.lock();
+            if (!cache) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            auto& entry = cache->entries[file_type];
+            entry.version = version;
+            entry.timestamp = std::chrono::steady_clock::now();
+            entry.is_fetching = false;
+        });
+
+    return entry.version;
+}
 
-        std::lock_guard<std::mutex> lock(this->cache_mutex_);
-        auto& entry = this->version_cache_[file_type];
-        entry.version = version;
-        entry.timestamp = std::chrono::steady_clock::now();
-        entry.is_fetching = false;
-    }).detach();
+bool VersionDetector::isPersistable(const std::string& command) {
+    // 结果取决于当前目录（项目内的 node_modules、./gradlew）的命令不跨会话保存
+    return command.find("npm list") == std::string::npos &&
+           command.find("./") == std::string::npos;
+}
 
-    // 返回缓存中的版本（如果有的话）或空字符串
-    return (it != version_cache_.end()) ? it->second.version : "";
+std::string VersionDetector::probeFingerprint(const std::string& command) {
+    // 以命令的第一个程序为准；"a || b" 形式的回退命令在 a 被安装或升级时同样失效
+    std::string program = command.substr(0, command.find(' '));
+    return ToolCache::fingerprint(ProcessExecutor::resolveExecutable(program));
 }
 
 void VersionDetector::clearCache() {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    version_cache_.clear();
+    std::lock_guard<std::mutex> lock(cache_->mutex);
+    cache_->entries.clear();
 }
 
 void VersionDetector::clearCacheForType(const std::string& file_type) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    version_cache_.erase(file_type);
+    std::lock_guard<std::mutex> lock(cache_->mutex);
+    cache_->entries.erase(file_type);
 }
 
-std::string VersionDetector::fetchVersionForFileType(const std::string& file_type) {
+std::string VersionDetector::versionCommandForFileType(const std::string& file_type) {
     std::string command;
     std::string version_prefix;
 
@@ -294,14 +335,7 @@ std::string VersionDetector::fetchVersionForFileType(const std::string& file_typ
         return "";
     }
 
-    // 执行命令获取版本信息
-    std::string raw_output = executeCommand(command);
-    if (raw_output.empty()) {
-        return "";
-    }
-
-    // 使用优化的解析方法提取版本号
-    return parseVersionString(raw_output, file_type);
+    return command;
 }
 
 std::string VersionDetector::parseVersionString(const std::string& raw_output,
@@ -569,22 +603,5 @@ std::string VersionDetector::extractVersionNumber(const std::string& text) {
     return version;
 }
 
-std::string VersionDetector::executeCommand(const std::string& command) {
-    std::array<char, 256> buffer;
-    std::string result;
-
-    std::unique_ptr<FILE, FileDeleter> pipe(popen(command.c_str(), "r"));
-    if (!pipe) {
-        return "";
-    }
-
-    // 读取命令输出
-    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-        result += buffer.data();
-    }
-
-    return result;
-}
-
 } // namespace utils
 } // namespace pnana
\ No newline at end of file
@@ -0,0 +1,383 @@
+#include "features/ai_client/http_engine.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <curl/curl.h>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <netinet/in.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace pnana::features::ai_client;
+
+// AI 提供商 HTTP 传输：每个请求新建 easy 句柄（旧实现）对比共享 curl_multi 引擎的连接复用，
+// 以及单个 IO 线程承载的并发 SSE 流与取消延迟。对端是本进程内的 HTTP/1.1 keep-alive 模拟服务器，
+// 普通请求返回 OpenAI 格式的 JSON，/stream?n=N&ms=M 以 chunked SSE 每 M 毫秒推送一个 delta。
+
+namespace {
+
+class BenchmarkTimer {
+  public:
+    void start() {
+        start_time_ = std::chrono::high_resolution_clock::now();
+    }
+
+    double stopMs() {
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start_time_).count();
+    }
+
+  private:
+    std::chrono::high_resolution_clock::time_point start_time_;
+};
+
+class MockServer {
+  public:
+    MockServer() {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(listen_fd_, 64);
+        socklen_t len = sizeof(addr);
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        accept_thread_ = std::thread([this]() {
+            acceptLoop();
+        });
+    }
+
+    ~MockServer() {
+        stopping_ = true;
+        shutdown(listen_fd_, SHUT_RDWR);
+        close(listen_fd_);
+        accept_thread_.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int fd : client_fds_) {
+                shutdown(fd, SHUT_RDWR);
+            }
+        }
+        for (auto& thread : connection_threads_) {
+            thread.join();
+        }
+    }
+
+    std::string url(const std::string& path) const {
+        return "http://127.0.0.1:" + std::to_string(port_) + path;
+    }
+
+    int acceptedConnections() const {
+        return accepted_.load();
+    }
+
+  private:
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> accepted_{0};
+    std::thread accept_thread_;
+    std::mutex mutex_;
+    std::vector<int> client_fds_;
+    std::vector<std::thread> connection_threads_;
+
+    void acceptLoop() {
+        while (!stopping_) {
+            int fd = accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) {
+                return;
+            }
+            ++accepted_;
+            std::lock_guard<std::mutex> lock(mutex_);
+            client_fds_.push_back(fd);
+            connection_threads_.emplace_back([this, fd]() {
+                serve(fd);
+            });
+        }
+    }
+
+    static bool sendAll(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    static int queryInt(const std::string& path, const std::string& name, int fallback) {
+        size_t pos = path.find(name + "=");
+        if (pos == std::string::npos) {
+            return fallback;
+        }
+        return std::atoi(path.c_str() + pos + name.size() + 1);
+    }
+
+    void serve(int fd) {
+        std::string buffer;
+        char chunk[4096];
+        while (true) {
+            size_t header_end;
+            while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    close(fd);
+                    return;
+                }
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+            std::string headers = buffer.substr(0, header_end);
+            size_t content_length = 0;
+            size_t cl = headers.find("Content-Length: ");
+            if (cl != std::string::npos) {
+                content_length = std::strtoul(headers.c_str() + cl + 16, nullptr, 10);
+            }
+            while (buffer.size() < header_end + 4 + content_length) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    close(fd);
+                    return;
+                }
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+            buffer.erase(0, header_end + 4 + content_length);
+
+            std::string path = headers.substr(headers.find(' ') + 1);
+            path = path.substr(0, path.find(' '));
+            bool ok = path.find("/stream") == 0 ? serveStream(fd, path) : serveJson(fd);
+            if (!ok) {
+                close(fd);
+                return;
+            }
+        }
+    }
+
+    static bool serveJson(int fd) {
+        std::string body = R"({"choices":[{"message":{"role":"assistant","content":"ok"}}],)"
+                           R"("usage":{"total_tokens":3}})";
+        return sendAll(fd, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                           "Content-Length: " +
+                               std::to_string(body.size()) + "\r\n\r\n" + body);
+    }
+
+    bool serveStream(int fd, const std::string& path) {
+        int events = queryInt(path, "n", 20);
+        int interval_ms = queryInt(path, "ms", 5);
+        if (!sendAll(fd, "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                         "Transfer-Encoding: chunked\r\n\r\n")) {
+            return false;
+        }
+        auto sendChunk = [fd](const std::string& data) {
+            std::ostringstream size;
+            size << std::hex << data.size();
+            return sendAll(fd, size.str() + "\r\n" + data + "\r\n");
+        };
+        for (int i = 0; i < events && !stopping_; ++i) {
+            std::string event = "data: {\"choices\":[{\"delta\":{\"content\":\"t" +
+                                std::to_string(i) + " \"}}]}\n\n";
+            if (!sendChunk(event)) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        }
+        return sendChunk("data: [DONE]\n\n") && sendAll(fd, "0\r\n\r\n");
+    }
+};
+
+size_t appendBody(char* data, size_t size, size_t nmemb, void* user_data) {
+    static_cast<std::string*>(user_data)->append(data, size * nmemb);
+    return size * nmemb;
+}
+
+// 旧实现：每个请求 curl_easy_init + curl_easy_perform，请求结束即关闭连接
+bool freshHandleRequest(const std::string& url, const std::string& body) {
+    CURL* curl = curl_easy_init();
+    std::string response;
+    curl_slist* headers = curl_slist_append(nullptr, "Content-Type: application/json");
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    CURLcode res = curl_easy_perform(curl);
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    return res == CURLE_OK && !response.empty();
+}
+
+HttpRequest jsonRequest(const std::string& url, const std::string& body) {
+    HttpRequest request;
+    request.url = url;
+    request.headers = {"Content-Type: application/json"};
+    request.body = body;
+    return request;
+}
+
+bool checkSseParser() {
+    std::string payload = "data: {\"a\":1}\n\n: heartbeat\n\nevent: ping\ndata: x\ndata: y\r\n\r\n"
+                          "data: [DONE]\n\n";
+    SseParser whole;
+    auto expected = whole.feed(payload.data(), payload.size());
+    SseParser bytewise;
+    std::vector<SseParser::Event> events;
+    for (char c : payload) {
+        for (auto& event : bytewise.feed(&c, 1)) {
+            events.push_back(event);
+        }
+    }
+    if (expected.size() != 3 || events.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events[i].event != expected[i].event || events[i].data != expected[i].data) {
+            return false;
+        }
+    }
+    return expected[1].event == "ping" && expected[1].data == "x\ny";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int requests = argc > 1 ? std::atoi(argv[1]) : 200;
+    const int streams = 16;
+    const int events_per_stream = 40;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "SSE parser (byte-by-byte == whole): " << (checkSseParser() ? "yes" : "NO")
+              << std::endl;
+
+    MockServer server;
+    HttpEngine& engine = HttpEngine::getInstance();
+    std::string body = R"({"model":"mock","messages":[{"role":"user","content":"hi"}]})";
+    BenchmarkTimer timer;
+
+    // 1. 顺序的非流式请求
+    std::cout << requests << " sequential requests" << std::endl;
+    std::cout << std::string(60, '-') << std::endl;
+    int before = server.acceptedConnections();
+    size_t ok_fresh = 0;
+    timer.start();
+    for (int i = 0; i < requests; ++i) {
+        ok_fresh += freshHandleRequest(server.url("/v1/chat/completions"), body) ? 1 : 0;
+    }
+    double fresh_ms = timer.stopMs();
+    int fresh_connections = server.acceptedConnections() - before;
+
+    before = server.acceptedConnections();
+    size_t ok_engine = 0;
+    timer.start();
+    for (int i = 0; i < requests; ++i) {
+        HttpResponse response =
+            engine.perform(jsonRequest(server.url("/v1/chat/completions"), body));
+        ok_engine += response.ok() && !response.body.empty() ? 1 : 0;
+    }
+    double engine_ms = timer.stopMs();
+    int engine_connections = server.acceptedConnections() - before;
+
+    std::cout << "fresh easy handle : " << std::setw(9) << fresh_ms << " ms, " << std::setw(4)
+              << fresh_connections << " connections, " << ok_fresh << " ok" << std::endl;
+    std::cout << "shared HttpEngine : " << std::setw(9) << engine_ms << " ms, " << std::setw(4)
+              << engine_connections << " connections, " << ok_engine << " ok" << std::endl;
+
+    // 2. 并发 SSE 流：全部由引擎的一个 IO 线程驱动
+    std::cout << std::endl
+              << streams << " concurrent SSE streams x " << events_per_stream << " events"
+              << std::endl;
+    std::cout << std::string(60, '-') << std::endl;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int finished = 0;
+    std::atomic<int> deltas{0};
+    std::atomic<int> failures{0};
+    timer.start();
+    for (int i = 0; i < streams; ++i) {
+        auto parser = std::make_shared<SseParser>();
+        HttpRequest request =
+            jsonRequest(server.url("/stream?n=" + std::to_string(events_per_stream) + "&ms=5"),
+                        body);
+        engine.submit(
+            std::move(request),
+            [parser, &deltas](const char* data, size_t size) {
+                for (const auto& event : parser->feed(data, size)) {
+                    if (event.data != "[DONE]") {
+                        ++deltas;
+                    }
+                }
+            },
+            [&](const HttpResponse& response) {
+                if (!response.ok()) {
+                    ++failures;
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                ++finished;
+                cv.notify_all();
+            });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() {
+            return finished == streams;
+        });
+    }
+    double streams_ms = timer.stopMs();
+    // 明文 HTTP/1.1 不能多路复用，每主机最多 4 条连接，流分批进行；HTTPS + HTTP/2 时共用一条连接
+    std::cout << "wall time         : " << std::setw(9) << streams_ms << " ms (one stream ~"
+              << events_per_stream * 5 << " ms, h1 capped at 4 connections/host)" << std::endl;
+    std::cout << "deltas received   : " << deltas.load() << " / " << streams * events_per_stream
+              << ", failures " << failures.load() << std::endl;
+
+    // 3. 取消：首个 delta 到达后取消一个长流，测量到 on_done 的延迟
+    std::cout << std::endl << "Cancellation" << std::endl;
+    std::cout << std::string(60, '-') << std::endl;
+    std::atomic<bool> got_first{false};
+    bool cancelled = false;
+    bool done = false;
+    std::chrono::high_resolution_clock::time_point done_at;
+    HttpEngine::RequestId id = engine.submit(
+        jsonRequest(server.url("/stream?n=1000&ms=50"), body),
+        [&got_first](const char*, size_t) {
+            got_first = true;
+        },
+        [&](const HttpResponse& response) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = response.cancelled;
+            done = true;
+            done_at = std::chrono::high_resolution_clock::now();
+            cv.notify_all();
+        });
+    while (!got_first) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto cancel_at = std::chrono::high_resolution_clock::now();
+    engine.cancel(id);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() {
+            return done;
+        });
+    }
+    std::cout << "cancel -> on_done : " << std::setw(9)
+              << std::chrono::duration<double, std::milli>(done_at - cancel_at).count()
+              << " ms, cancelled=" << (cancelled ? "yes" : "NO") << std::endl;
+
+    bool all_ok = ok_fresh == static_cast<size_t>(requests) &&
+                  ok_engine == static_cast<size_t>(requests) && failures == 0 &&
+                  deltas == streams * events_per_stream && cancelled;
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#include "utils/text_utils.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pnana::utils;
+
+// AI 助手面板的折行开销：流式回复每收到一个 chunk，
+// 整段重新折行（旧的每帧 paragraph 布局）对比只从最后一行起始位置增量折行。
+// 同时校验增量结果与整段折行完全一致（含中英文混排、代码块、超长单词）。
+
+class BenchmarkTimer {
+  public:
+    void start() {
+        start_time_ = std::chrono::high_resolution_clock::now();
+    }
+
+    double stop() {
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start_time_).count();
+    }
+
+  private:
+    std::chrono::high_resolution_clock::time_point start_time_;
+};
+
+std::string generateReply(size_t target_bytes, unsigned seed) {
+    std::mt19937 rng(seed);
+    const std::vector<std::string> words = {
+        "the",      "buffer",   "render",     "width",   "std::vector<std::string>", "函数",
+        "重新折行", "光标位置", "snake_case", "return",  "if (x > 0) {",             "}",
+        "\t",       "const",    "终端",       "→",       "0x1F600",                  "emoji😀",
+        "a_very_long_identifier_that_does_not_fit_on_a_single_line_of_the_panel_at_all"};
+    std::string text;
+    while (text.size() < target_bytes) {
+        text += words[rng() % words.size()];
+        unsigned r = rng() % 20;
+        if (r == 0) {
+            text += "\n\n";
+        } else if (r < 3) {
+            text += "\n";
+        } else {
+            text += " ";
+        }
+    }
+    return text;
+}
+
+struct Layout {
+    std::vector<std::string> lines;
+    std::vector<size_t> line_starts;
+};
+
+int main(int argc, char* argv[]) {
+    size_t reply_bytes = argc > 1 ? std::stoul(argv[1]) : 64 * 1024;
+    const size_t chunk_bytes = 24; // 典型 SSE delta 的大小
+    const int widths[] = {38, 78};
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Streaming reply of " << reply_bytes << " bytes in ~" << chunk_bytes
+              << "-byte chunks" << std::endl;
+    std::cout << std::string(72, '-') << std::endl;
+    std::cout << std::left << std::setw(8) << "width" << std::right << std::setw(8) << "lines"
+              << std::setw(16) << "full (ms)" << std::setw(16) << "incremental" << std::setw(12)
+              << "speedup" << std::setw(12) << "match" << std::endl;
+
+    bool all_match = true;
+    for (int width : widths) {
+        std::string reply = generateReply(reply_bytes, 42 + width);
+        BenchmarkTimer timer;
+
+        // 按字节切块，但不切开 UTF-8 字符
+        std::vector<size_t> cuts;
+        for (size_t pos = chunk_bytes; pos < reply.size(); pos += chunk_bytes) {
+            while (pos < reply.size() && (static_cast<unsigned char>(reply[pos]) & 0xC0) == 0x80) {
+                ++pos;
+            }
+            cuts.push_back(pos);
+        }
+        cuts.push_back(reply.size());
+
+        // 1. 每个 chunk 后整段重新折行
+        Layout full;
+        timer.start();
+        for (size_t cut : cuts) {
+            full.lines.clear();
+            full.line_starts.clear();
+            wrapByDisplayWidth(reply.substr(0, cut), 0, width, full.lines, full.line_starts);
+        }
+        double full_ms = timer.stop();
+
+        // 2. 增量：只重排最后一行
+        Layout incremental;
+        std::string content;
+        bool match = true;
+        size_t prev = 0;
+        double incremental_ms = 0.0;
+        for (size_t i = 0; i < cuts.size(); ++i) {
+            content.append(reply, prev, cuts[i] - prev);
+            prev = cuts[i];
+            timer.start();
+            size_t from = 0;
+            if (!incremental.lines.empty()) {
+                from = incremental.line_starts.back();
+                incremental.lines.pop_back();
+                incremental.line_starts.pop_back();
+            }
+            wrapByDisplayWidth(content, from, width, incremental.lines, incremental.line_starts);
+            incremental_ms += timer.stop();
+
+            // 抽查中间状态
+            if (i % 97 == 0) {
+                Layout check;
+                wrapByDisplayWidth(content, 0, width, check.lines, check.line_starts);
+                match = match && check.lines == incremental.lines &&
+                        check.line_starts == incremental.line_starts;
+            }
+        }
+        match = match && full.lines == incremental.lines &&
+                full.line_starts == incremental.line_starts;
+        all_match = all_match && match;
+
+        std::cout << std::left << std::setw(8) << width << std::right << std::setw(8)
+                  << incremental.lines.size() << std::setw(16) << full_ms << std::setw(16)
+                  << incremental_ms << std::setw(11) << (full_ms / incremental_ms) << "x"
+                  << std::setw(12) << (match ? "yes" : "NO") << std::endl;
+    }
+
+    return all_match ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+// 自适应缓冲区后端基准：同一份录制的编辑序列分别在「静态选择」（加载时选定后端，之后不变）
+// 与「自适应选择」（Document 按编辑画像在后台流式迁移后端）下回放，比较总耗时。
+// 每次编辑后调用一次 stepBufferBackendMigration()，模拟编辑器每帧推进一块迁移。
+// 回放结束后校验后端文本与行缓存一致。
+//
+// 用法:
+//   buffer_adaptive_benchmark [--lines N] [--ops N]
+// 选项:
+//   --lines N   初始文档行数（默认 1000）
+//   --ops N     每个负载的编辑次数（默认 1000）
+#include "core/document.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pnana::core;
+
+namespace {
+
+// 录制的一次编辑（坐标基于编辑前的文档）
+struct RecordedEdit {
+    enum class Kind { INSERT_CHAR, INSERT_TEXT, DELETE_CHAR, APPLY_EDITS };
+    Kind kind;
+    size_t row;
+    size_t col;
+    std::string text;
+    std::vector<TextEdit> edits; // APPLY_EDITS：一次多光标编辑
+};
+
+struct Workload {
+    std::string name;
+    std::vector<RecordedEdit> edits;
+};
+
+// 在文档中段连续输入：逐字符键入、偶尔退格、每 40 个字符换行
+Workload recordLocalTyping(size_t lines, size_t ops) {
+    Workload workload{"local typing", {}};
+    size_t row = lines / 2;
+    size_t col = 0;
+    std::mt19937 rng(7);
+    for (size_t i = 0; i < ops; ++i) {
+        if (col > 0 && rng() % 8 == 0) {
+            workload.edits.push_back({RecordedEdit::Kind::DELETE_CHAR, row, col - 1, "", {}});
+            --col;
+        } else if (col >= 40) {
+            workload.edits.push_back({RecordedEdit::Kind::INSERT_TEXT, row, col, "\n", {}});
+            ++row;
+            col = 0;
+        } else {
+            char ch = static_cast<char>('a' + rng() % 26);
+            workload.edits.push_back(
+                {RecordedEdit::Kind::INSERT_CHAR, row, col, std::string(1, ch), {}});
+            ++col;
+        }
+    }
+    return workload;
+}
+
+// 多光标 / 查找替换：每步在 8 个随机行的行首同时插入一个标识符
+Workload recordScatteredEdits(size_t lines, size_t ops) {
+    Workload workload{"scattered multi-cursor", {}};
+    std::mt19937 rng(11);
+    for (size_t i = 0; i < ops; i += 8) {
+        std::vector<size_t> rows;
+        while (rows.size() < 8) {
+            size_t row = rng() % lines;
+            if (std::find(rows.begin(), rows.end(), row) == rows.end()) {
+                rows.push_back(row);
+            }
+        }
+        RecordedEdit edit{RecordedEdit::Kind::APPLY_EDITS, 0, 0, "", {}};
+        for (size_t row : rows) {
+            edit.edits.push_back(TextEdit{row, 0, row, 0, "id_"});
+        }
+        workload.edits.push_back(std::move(edit));
+    }
+    return workload;
+}
+
+// 日志式增长：不断在文末追加新行
+Workload recordAppendGrowth(size_t lines, size_t ops) {
+    Workload workload{"append / log growth", {}};
+    for (size_t i = 0; i < ops; ++i) {
+        // 行号在回放时取当前末行，这里只记录内容
+        workload.edits.push_back({RecordedEdit::Kind::INSERT_TEXT, lines + i, 0,
+                                  "\n[info] request " + std::to_string(i) + " served in 3ms",
+                                  {}});
+    }
+    return workload;
+}
+
+void replay(Document& doc, const Workload& workload) {
+    for (const auto& edit : workload.edits) {
+        switch (edit.kind) {
+            case RecordedEdit::Kind::INSERT_CHAR:
+                doc.insertChar(edit.row, edit.col, edit.text[0]);
+                break;
+            case RecordedEdit::Kind::INSERT_TEXT: {
+                // 含换行的文本走 applyEdits（insertText 只处理单行文本）
+                size_t row = std::min(edit.row, doc.lineCount() - 1);
+                size_t col = edit.row < doc.lineCount() ? edit.col : doc.getLine(row).size();
+                doc.applyEdits({TextEdit{row, col, row, col, edit.text}});
+                break;
+            }
+            case RecordedEdit::Kind::DELETE_CHAR:
+                doc.deleteChar(edit.row, edit.col);
+                break;
+            case RecordedEdit::Kind::APPLY_EDITS:
+                doc.applyEdits(edit.edits);
+                break;
+        }
+        doc.stepBufferBackendMigration();
+    }
+    // 让未完成的迁移收尾（编辑器里由后续帧完成）
+    while (doc.stepBufferBackendMigration()) {
+    }
+}
+
+struct RunResult {
+    double ms;
+    std::string final_backend;
+    bool consistent;
+};
+
+RunResult run(const std::string& path, BufferBackendType initial, bool adaptive,
+              const Workload& workload) {
+    Document doc;
+    doc.load(path);
+    doc.setBufferBackend(initial);
+    doc.setAdaptiveBufferBackend(adaptive);
+
+    auto start = std::chrono::steady_clock::now();
+    replay(doc, workload);
+    double ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    RunResult result;
+    result.ms = ms;
+    result.final_backend = doc.getBufferBackendName();
+    result.consistent = doc.getBufferBackend()->getFullText() == doc.getContent();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t lines = 1000;
+    size_t ops = 1000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--lines") {
+            lines = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (arg == "--ops") {
+            ops = std::strtoul(argv[i + 1], nullptr, 10);
+        }
+    }
+
+    std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "pnana_buffer_adaptive_benchmark.txt";
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (size_t i = 0; i < lines; ++i) {
+            file << "    int value_" << i << " = compute(alpha, beta, gamma); // line " << i;
+            if (i + 1 < lines) {
+                file << '\n';
+            }
+        }
+    }
+
+    std::cout << "=== Adaptive Buffer Backend Benchmark ===" << std::endl;
+    std::cout << lines << " lines, " << ops << " edits per workload" << std::endl;
+
+    std::vector<Workload> workloads = {recordLocalTyping(lines, ops),
+                                       recordScatteredEdits(lines, ops),
+                                       recordAppendGrowth(lines, ops)};
+    std::vector<BufferBackendType> initial_backends = {
+        BufferBackendType::GAP_BUFFER, BufferBackendType::SQRT_DECOMPOSITION,
+        BufferBackendType::ROPE, BufferBackendType::PIECE_TABLE};
+
+    bool all_consistent = true;
+    for (const auto& workload : workloads) {
+        std::cout << "\n--- " << workload.name << " ---" << std::endl;
+        std::cout << std::left << std::setw(20) << "Initial backend" << std::right
+                  << std::setw(14) << "Static(ms)" << std::setw(14) << "Adaptive(ms)"
+                  << std::setw(10) << "Speedup"
+                  << "  Final backend" << std::endl;
+        std::cout << std::string(76, '-') << std::endl;
+
+        for (BufferBackendType initial : initial_backends) {
+            RunResult fixed = run(path.string(), initial, false, workload);
+            RunResult adaptive = run(path.string(), initial, true, workload);
+            all_consistent = all_consistent && fixed.consistent && adaptive.consistent;
+
+            std::cout << std::left << std::setw(20) << SmartBufferFactory::getBackendName(initial)
+                      << std::right << std::fixed << std::setprecision(2) << std::setw(14)
+                      << fixed.ms << std::setw(14) << adaptive.ms << std::setw(9)
+                      << (adaptive.ms > 0 ? fixed.ms / adaptive.ms : 0.0) << "x"
+                      << "  " << adaptive.final_backend
+                      << (fixed.consistent && adaptive.consistent ? "" : "  MISMATCH")
+                      << std::endl;
+        }
+    }
+
+    std::filesystem::remove(path);
+    std::cout << "\n=== Benchmark Complete ===" << std::endl;
+    return all_consistent ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include "utils/directory_reader.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace pnana::utils;
+
+// 文件浏览器展开大目录（如 node_modules）的读取开销：
+// 旧实现 fs::directory_iterator + 每项 file_size + 比较时逐次转小写的排序，
+// 对比 getdents64/d_type 读取（不 stat）+ 预计算排序键。两者的结果顺序必须一致。
+
+class BenchmarkTimer {
+  public:
+    void start() {
+        start_time_ = std::chrono::high_resolution_clock::now();
+    }
+
+    double stop() {
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start_time_).count();
+    }
+
+  private:
+    std::chrono::high_resolution_clock::time_point start_time_;
+};
+
+struct LegacyItem {
+    std::string name;
+    bool is_directory;
+    size_t size;
+};
+
+// 旧的 FileBrowser::loadDirectoryRecursive 本地分支
+std::vector<LegacyItem> legacyRead(const std::string& path) {
+    std::vector<LegacyItem> dirs;
+    std::vector<LegacyItem> files;
+    for (const auto& entry : fs::directory_iterator(path)) {
+        std::string name = entry.path().filename().string();
+        if (!name.empty() && name[0] == '.') {
+            continue;
+        }
+        LegacyItem item{name, entry.is_directory(), 0};
+        if (!entry.is_directory() && fs::is_regular_file(entry)) {
+            try {
+                item.size = fs::file_size(entry);
+            } catch (...) {
+                item.size = 0;
+            }
+        }
+        (item.is_directory ? dirs : files).push_back(item);
+    }
+    auto ciLess = [](const LegacyItem& a, const LegacyItem& b) {
+        std::string al = a.name, bl = b.name;
+        std::transform(al.begin(), al.end(), al.begin(), ::tolower);
+        std::transform(bl.begin(), bl.end(), bl.begin(), ::tolower);
+        if (al != bl)
+            return al < bl;
+        return a.name < b.name;
+    };
+    std::sort(dirs.begin(), dirs.end(), ciLess);
+    std::sort(files.begin(), files.end(), ciLess);
+    dirs.insert(dirs.end(), files.begin(), files.end());
+    return dirs;
+}
+
+int main(int argc, char* argv[]) {
+    size_t file_count = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const size_t dir_count = file_count / 50;
+    const int iterations = 3;
+
+    fs::path root = fs::temp_directory_path() /
+                    ("pnana_dir_bench_" + std::to_string(static_cast<long long>(getpid())));
+    fs::create_directories(root);
+    for (size_t i = 0; i < dir_count; ++i) {
+        fs::create_directory(root / ("Pkg_" + std::to_string(i * 7919 % dir_count)));
+    }
+    for (size_t i = 0; i < file_count; ++i) {
+        std::string name = (i % 3 == 0 ? "Index_" : "module-") +
+                           std::to_string(i * 104729 % file_count) + (i % 2 == 0 ? ".js" : ".d.ts");
+        std::ofstream(root / name) << "x";
+    }
+    fs::create_directory_symlink(root / "Pkg_0", root / "link_to_pkg");
+    std::ofstream(root / ".hidden") << "x";
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Reading a directory with " << file_count << " files and " << dir_count + 1
+              << " directories (best of " << iterations << ")" << std::endl;
+    std::cout << std::string(60, '-') << std::endl;
+
+    BenchmarkTimer timer;
+    double legacy_ms = 1e300;
+    std::vector<LegacyItem> legacy;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        legacy = legacyRead(root.string());
+        legacy_ms = std::min(legacy_ms, timer.stop());
+    }
+
+    double reader_ms = 1e300;
+    std::vector<DirectoryEntry> entries;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        readDirectory(root.string(), false, entries);
+        sortDirectoryEntries(entries);
+        reader_ms = std::min(reader_ms, timer.stop());
+    }
+
+    bool match = legacy.size() == entries.size();
+    for (size_t i = 0; match && i < entries.size(); ++i) {
+        match = legacy[i].name == entries[i].name &&
+                legacy[i].is_directory == entries[i].is_directory;
+    }
+
+    std::cout << "directory_iterator + stat : " << std::setw(9) << legacy_ms << " ms" << std::endl;
+    std::cout << "getdents64 + d_type       : " << std::setw(9) << reader_ms << " ms ("
+              << legacy_ms / reader_ms << "x)" << std::endl;
+    std::cout << "same entries and order    : " << (match ? "yes" : "NO") << std::endl;
+
+    fs::remove_all(root);
+    return match ? 0 : 1;
+}
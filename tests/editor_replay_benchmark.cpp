@@ -0,0 +1,301 @@
+// 无头回放基准：在离屏 ftxui::Screen 上构造编辑器，回放录制的事件序列，
+// 统计每类事件（事件处理 + 渲染一帧）的延迟分布与每帧内存分配次数。
+//
+// 用法:
+//   editor_replay_benchmark                 内置场景：打开大文件、滚动、输入、搜索、撤销、分屏
+//   editor_replay_benchmark --events LOG    回放 `pnana --record-events LOG` 录下的会话
+// 选项:
+//   --lines N       内置场景生成的文件行数（默认 200000）
+//   --repeat N      事件序列重复回放次数（默认 1）
+//   --size WxH      离屏屏幕尺寸（默认 160x48）
+#include "core/editor.h"
+#include "input/event_parser.h"
+#include "input/event_recorder.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+// 全局分配计数：替换 operator new，统计每帧的堆分配次数（含后台线程在该帧内的分配）
+namespace {
+std::atomic<size_t> g_allocations{0};
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+struct ReplayStep {
+    std::string type;
+    std::function<void(pnana::core::Editor&)> apply;
+};
+
+struct FrameSample {
+    double us;
+    size_t allocations;
+};
+
+class ReplayBenchmark {
+  public:
+    ReplayBenchmark(int width, int height)
+        : screen_(ftxui::Screen::Create(ftxui::Dimension::Fixed(width),
+                                        ftxui::Dimension::Fixed(height))) {
+        editor_.setHeadlessScreenSize(width, height);
+        // 初始帧（欢迎页等）不计入统计
+        renderFrame();
+    }
+
+    void run(const std::vector<ReplayStep>& steps) {
+        for (const auto& step : steps) {
+            size_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+            auto start = std::chrono::steady_clock::now();
+
+            step.apply(editor_);
+            renderFrame();
+
+            double us =
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+                    .count();
+            size_t allocations = g_allocations.load(std::memory_order_relaxed) - allocations_before;
+            samples_[step.type].push_back({us, allocations});
+            all_.push_back({us, allocations});
+        }
+    }
+
+    void printReport() const {
+        std::cout << "\n"
+                  << std::left << std::setw(18) << "Event" << std::right << std::setw(8) << "Count"
+                  << std::setw(11) << "p50(ms)" << std::setw(11) << "p95(ms)" << std::setw(11)
+                  << "p99(ms)" << std::setw(11) << "max(ms)" << std::setw(14) << "allocs/frame"
+                  << "\n";
+        std::cout << std::string(84, '-') << "\n";
+        for (const auto& entry : samples_) {
+            printRow(entry.first, entry.second);
+        }
+        std::cout << std::string(84, '-') << "\n";
+        printRow("(all frames)", all_);
+    }
+
+  private:
+    void renderFrame() {
+        ftxui::Element document = editor_.renderFrame();
+        screen_.Clear();
+        ftxui::Render(screen_, document);
+        // 与 ScreenInteractive 一样生成终端输出串，计入一帧的成本
+        frame_output_ = screen_.ToString();
+    }
+
+    static void printRow(const std::string& name, std::vector<FrameSample> samples) {
+        if (samples.empty()) {
+            return;
+        }
+        std::sort(samples.begin(), samples.end(),
+                  [](const FrameSample& a, const FrameSample& b) { return a.us < b.us; });
+        auto at = [&](double q) {
+            size_t index = static_cast<size_t>(q * static_cast<double>(samples.size()));
+            index = std::min(samples.size() - 1, index);
+            return samples[index].us / 1000.0;
+        };
+        double allocations = 0.0;
+        for (const auto& sample : samples) {
+            allocations += static_cast<double>(sample.allocations);
+        }
+        allocations /= static_cast<double>(samples.size());
+
+        std::cout << std::left << std::setw(18) << name << std::right << std::setw(8)
+                  << samples.size() << std::fixed << std::setprecision(3) << std::setw(11)
+                  << at(0.50) << std::setw(11) << at(0.95) << std::setw(11) << at(0.99)
+                  << std::setw(11) << samples.back().us / 1000.0 << std::setprecision(1)
+                  << std::setw(14) << allocations << "\n";
+    }
+
+    pnana::core::Editor editor_;
+    ftxui::Screen screen_;
+    std::string frame_output_;
+    std::map<std::string, std::vector<FrameSample>> samples_;
+    std::vector<FrameSample> all_;
+};
+
+ReplayStep eventStep(const std::string& type, const ftxui::Event& event) {
+    return {type, [event](pnana::core::Editor& editor) { editor.dispatchEvent(event); }};
+}
+
+// 录制事件按键名归类：字符输入统一为 "char"，其余用 EventParser 的标准键名
+std::string classifyEvent(const ftxui::Event& event) {
+    if (event.is_mouse()) {
+        return "mouse";
+    }
+    pnana::input::EventParser parser;
+    std::string key = parser.eventToKey(event);
+    if (!key.empty()) {
+        return key;
+    }
+    return event.is_character() ? "char" : "other";
+}
+
+std::string generateLargeFile(size_t lines) {
+    std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "pnana_replay_benchmark.cpp";
+    std::ofstream out(path);
+    for (size_t i = 0; i < lines; ++i) {
+        if (i % 1000 == 500) {
+            out << "    int needle_" << i << " = compute(" << i << "); // needle\n";
+        } else if (i % 20 == 0) {
+            out << "static int function_" << i << "(int value) {\n";
+        } else if (i % 20 == 19) {
+            out << "}\n";
+        } else {
+            out << "    value = (value * " << i << " + 17) % 1000003; /* line " << i << " */\n";
+        }
+    }
+    return path.string();
+}
+
+std::vector<ReplayStep> builtinScenario(const std::string& file) {
+    using ftxui::Event;
+    std::vector<ReplayStep> steps;
+    steps.push_back({"open", [file](pnana::core::Editor& editor) { editor.openFile(file); }});
+
+    for (int i = 0; i < 200; ++i) {
+        steps.push_back(eventStep("scroll", Event::PageDown));
+    }
+    for (int i = 0; i < 200; ++i) {
+        steps.push_back(eventStep("cursor", Event::ArrowDown));
+    }
+
+    const std::string typed = "int replay_benchmark_value = compute(42); ";
+    for (int round = 0; round < 10; ++round) {
+        for (char c : typed) {
+            steps.push_back(eventStep("type", Event::Character(c)));
+        }
+        steps.push_back(eventStep("type", Event::Return));
+    }
+
+    for (int round = 0; round < 5; ++round) {
+        steps.push_back(eventStep("search", Event::CtrlF));
+        for (char c : std::string("needle")) {
+            steps.push_back(eventStep("search", Event::Character(c)));
+        }
+        steps.push_back(eventStep("search", Event::Return));
+        steps.push_back(eventStep("search", Event::Escape));
+    }
+
+    for (int i = 0; i < 200; ++i) {
+        steps.push_back(eventStep("undo", Event::CtrlZ));
+    }
+
+    steps.push_back({"split", [](pnana::core::Editor& editor) {
+                         editor.splitView(pnana::features::SplitDirection::VERTICAL);
+                     }});
+    for (int i = 0; i < 100; ++i) {
+        steps.push_back(eventStep("scroll", Event::PageUp));
+    }
+    return steps;
+}
+
+bool recordedScenario(const std::string& path, int repeat, std::vector<ReplayStep>& steps) {
+    std::vector<pnana::input::RecordedEvent> records;
+    std::string error;
+    if (!pnana::input::EventRecorder::load(path, records, error)) {
+        std::cerr << "editor_replay_benchmark: " << error << "\n";
+        return false;
+    }
+    for (const auto& record : records) {
+        if (record.kind == pnana::input::RecordedEvent::Kind::OPEN) {
+            std::string file = record.path;
+            steps.push_back(
+                {"open", [file](pnana::core::Editor& editor) { editor.openFile(file); }});
+        }
+    }
+    for (int round = 0; round < repeat; ++round) {
+        for (const auto& record : records) {
+            if (record.kind == pnana::input::RecordedEvent::Kind::EVENT) {
+                steps.push_back(eventStep(classifyEvent(record.event), record.event));
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string events_path;
+    size_t lines = 200000;
+    int repeat = 1;
+    int width = 160;
+    int height = 48;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--events" && i + 1 < argc) {
+            events_path = argv[++i];
+        } else if (arg == "--lines" && i + 1 < argc) {
+            lines = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 ||
+                height <= 0) {
+                std::cerr << "editor_replay_benchmark: --size expects WxH\n";
+                return 2;
+            }
+        } else {
+            std::cerr << "Usage: editor_replay_benchmark [--events LOG] [--lines N] [--repeat N] "
+                         "[--size WxH]\n";
+            return 2;
+        }
+    }
+
+    std::vector<ReplayStep> steps;
+    std::string generated_file;
+    if (events_path.empty()) {
+        std::cout << "Generating " << lines << "-line file...\n";
+        generated_file = generateLargeFile(lines);
+        std::vector<ReplayStep> scenario = builtinScenario(generated_file);
+        for (int round = 0; round < repeat; ++round) {
+            steps.insert(steps.end(), round == 0 ? scenario.begin() : scenario.begin() + 1,
+                         scenario.end());
+        }
+    } else if (!recordedScenario(events_path, repeat, steps)) {
+        return 1;
+    }
+
+    std::cout << "Replaying " << steps.size() << " events on a " << width << "x" << height
+              << " off-screen screen...\n";
+    ReplayBenchmark benchmark(width, height);
+    benchmark.run(steps);
+    benchmark.printReport();
+
+    if (!generated_file.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(generated_file, ec);
+    }
+    return 0;
+}
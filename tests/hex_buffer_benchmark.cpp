@@ -0,0 +1,173 @@
+#include "features/hex_view/hex_buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace pnana::features;
+
+// 十六进制视图的字节序列搜索：逐字节比较（std::search）对比 SSE2 首尾字节过滤 + memchr，
+// 以及 HexBuffer::find 在映射文件上的分块搜索。同时校验：
+// - 随机小样本上 findBytes 与 std::search 结果一致
+// - 补丁层叠加后的搜索能找到只存在于补丁里的序列
+// - save() 只写回被修改的页，文件大小不变
+
+class BenchmarkTimer {
+  public:
+    void start() {
+        start_time_ = std::chrono::high_resolution_clock::now();
+    }
+
+    double stop() {
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start_time_).count();
+    }
+
+  private:
+    std::chrono::high_resolution_clock::time_point start_time_;
+};
+
+size_t naiveFind(const uint8_t* haystack, size_t size, const uint8_t* needle, size_t n) {
+    const uint8_t* found = std::search(haystack, haystack + size, needle, needle + n);
+    return static_cast<size_t>(found - haystack);
+}
+
+bool checkRandomCases() {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 20000; ++round) {
+        // 小字母表让部分匹配频繁出现
+        size_t size = rng() % 200;
+        size_t n = 1 + rng() % 6;
+        std::vector<uint8_t> haystack(size);
+        std::vector<uint8_t> needle(n);
+        for (auto& b : haystack) {
+            b = static_cast<uint8_t>(rng() % 3);
+        }
+        for (auto& b : needle) {
+            b = static_cast<uint8_t>(rng() % 3);
+        }
+        size_t expected = naiveFind(haystack.data(), size, needle.data(), n);
+        if (n > size) {
+            expected = size;
+        }
+        if (findBytes(haystack.data(), size, needle.data(), n) != expected) {
+            std::cout << "findBytes mismatch: size=" << size << " n=" << n << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    size_t file_mb = argc > 1 ? std::stoul(argv[1]) : 256;
+    const size_t file_size = file_mb * 1024 * 1024;
+    const int iterations = 3;
+
+    fs::path path = fs::temp_directory_path() /
+                    ("pnana_hex_bench_" + std::to_string(static_cast<long long>(getpid())));
+    const std::string pattern = "\x7f" "ELF\x02\x01\x01";
+    const uint64_t planted = file_size - 4096 - 3;
+    {
+        // 随机内容里频繁出现 0x7f，模拟首字节命中率较高的情况
+        std::mt19937 rng(42);
+        std::vector<uint8_t> block(1024 * 1024);
+        std::ofstream out(path, std::ios::binary);
+        for (size_t written = 0; written < file_size; written += block.size()) {
+            for (auto& b : block) {
+                uint32_t r = rng();
+                b = (r & 0x1f) == 0 ? 0x7f : static_cast<uint8_t>(r >> 8);
+            }
+            if (written + block.size() > planted) {
+                std::copy(pattern.begin(), pattern.end(), block.begin() + (planted - written));
+            }
+            out.write(reinterpret_cast<const char*>(block.data()),
+                      static_cast<std::streamsize>(block.size()));
+        }
+    }
+
+    HexBuffer buffer;
+    if (!buffer.open(path.string())) {
+        std::cout << "open failed: " << buffer.getLastError() << std::endl;
+        fs::remove(path);
+        return 1;
+    }
+
+    std::vector<uint8_t> contents(file_size);
+    buffer.read(0, contents.data(), contents.size());
+    const auto* needle = reinterpret_cast<const uint8_t*>(pattern.data());
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Searching a " << file_mb << " MiB file for a " << pattern.size()
+              << "-byte pattern (best of " << iterations << ")" << std::endl;
+    std::cout << std::string(60, '-') << std::endl;
+
+    BenchmarkTimer timer;
+    double naive_ms = 1e300;
+    size_t naive_hit = 0;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        naive_hit = naiveFind(contents.data(), contents.size(), needle, pattern.size());
+        naive_ms = std::min(naive_ms, timer.stop());
+    }
+
+    double simd_ms = 1e300;
+    size_t simd_hit = 0;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        simd_hit = findBytes(contents.data(), contents.size(), needle, pattern.size());
+        simd_ms = std::min(simd_ms, timer.stop());
+    }
+
+    double mapped_ms = 1e300;
+    int64_t mapped_hit = -1;
+    std::atomic<uint64_t> scanned{0};
+    for (int i = 0; i < iterations; ++i) {
+        scanned.store(0);
+        timer.start();
+        mapped_hit = buffer.find(pattern, 0, nullptr, &scanned);
+        mapped_ms = std::min(mapped_ms, timer.stop());
+    }
+
+    bool ok = naive_hit == planted && simd_hit == planted &&
+              mapped_hit == static_cast<int64_t>(planted) && checkRandomCases();
+
+    std::cout << "std::search                : " << std::setw(9) << naive_ms << " ms" << std::endl;
+    std::cout << "findBytes (in memory)      : " << std::setw(9) << simd_ms << " ms ("
+              << naive_ms / simd_ms << "x)" << std::endl;
+    std::cout << "HexBuffer::find (mmap)     : " << std::setw(9) << mapped_ms << " ms ("
+              << (file_mb * 1000.0 / 1024.0) / mapped_ms << " GiB/s)" << std::endl;
+
+    // 补丁层：序列只存在于补丁中，搜索必须看到它；回绕后从尾部找回开头
+    const std::string marker = "PNANA-PATCH";
+    const uint64_t patch_at = HexBuffer::PAGE_SIZE * 3 - 4; // 跨两页
+    for (size_t i = 0; i < marker.size(); ++i) {
+        buffer.setByte(patch_at + i, static_cast<uint8_t>(marker[i]));
+    }
+    buffer.setByte(file_size - 1, 0xAA);
+    buffer.setByte(file_size - 1, contents[file_size - 1]); // 改回原值，该页不应算作修改
+    ok = ok && buffer.dirtyPageCount() == 2;
+    ok = ok && buffer.find(marker, file_size / 2) == static_cast<int64_t>(patch_at);
+
+    size_t pages_written = 0;
+    ok = ok && buffer.save(&pages_written) && pages_written == 2 && !buffer.hasPatches();
+    ok = ok && fs::file_size(path) == file_size;
+    HexBuffer reopened;
+    ok = ok && reopened.open(path.string()) && reopened.find(marker, 0) == (int64_t)patch_at;
+    ok = ok && reopened.byteAt(patch_at - 1) == contents[patch_at - 1] &&
+         reopened.byteAt(patch_at + marker.size()) == contents[patch_at + marker.size()];
+
+    std::cout << "patch overlay + save       : " << pages_written << " pages written" << std::endl;
+    std::cout << "results match              : " << (ok ? "yes" : "NO") << std::endl;
+
+    fs::remove(path);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+#include "input/event_parser.h"
+#include "input/key_binding_manager.h"
+#include "input/key_chord.h"
+#include <chrono>
+#include <ftxui/component/event.hpp>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pnana::input;
+
+// 每次按键的分发代价：旧路径（完整解析出键字符串 + std::map 查找）对比
+// 新路径（按输入缓存的 KeyChord + 扁平哈希表查找），以及插件键映射查表
+
+namespace {
+
+class BenchmarkTimer {
+  public:
+    void start() {
+        start_time_ = std::chrono::high_resolution_clock::now();
+    }
+
+    double stopNs() {
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start_time_).count();
+    }
+
+  private:
+    std::chrono::high_resolution_clock::time_point start_time_;
+};
+
+// 所有能被解析成键的事件：预定义特殊键、Ctrl/Alt 组合、可打印字符
+std::vector<ftxui::Event> allEvents() {
+    std::vector<ftxui::Event> events = {
+        ftxui::Event::ArrowUp,       ftxui::Event::ArrowDown,      ftxui::Event::ArrowLeft,
+        ftxui::Event::ArrowRight,    ftxui::Event::ArrowUpCtrl,    ftxui::Event::ArrowDownCtrl,
+        ftxui::Event::ArrowLeftCtrl, ftxui::Event::ArrowRightCtrl, ftxui::Event::Backspace,
+        ftxui::Event::Delete,        ftxui::Event::Return,         ftxui::Event::Escape,
+        ftxui::Event::Tab,           ftxui::Event::TabReverse,     ftxui::Event::Home,
+        ftxui::Event::End,           ftxui::Event::PageUp,         ftxui::Event::PageDown,
+        ftxui::Event::F1,            ftxui::Event::F2,             ftxui::Event::F3,
+        ftxui::Event::F4,            ftxui::Event::F5,             ftxui::Event::F6,
+        ftxui::Event::F7,            ftxui::Event::F8,             ftxui::Event::F9,
+        ftxui::Event::F10,           ftxui::Event::F11,            ftxui::Event::F12,
+    };
+    for (char c = 1; c < 27; ++c) {
+        events.push_back(ftxui::Event::Special(std::string(1, c)));
+    }
+    for (char c = 32; c < 127; ++c) {
+        events.push_back(ftxui::Event::Character(std::string(1, c)));
+        events.push_back(ftxui::Event::Special(std::string("\x1b") + c));
+    }
+    events.push_back(ftxui::Event::Special("\x1b[1;3A"));
+    events.push_back(ftxui::Event::Special("\x1b[1;4B"));
+    events.push_back(ftxui::Event::Special(std::string(1, '\x1f')));
+    events.push_back(ftxui::Event::Character(" a"));
+    return events;
+}
+
+// 典型编辑会话：大部分是普通输入，夹杂导航键与快捷键
+std::vector<ftxui::Event> typingSession(size_t count, unsigned seed) {
+    std::vector<ftxui::Event> shortcuts = {
+        ftxui::Event::CtrlS,      ftxui::Event::CtrlZ,     ftxui::Event::CtrlF,
+        ftxui::Event::ArrowUp,    ftxui::Event::ArrowDown, ftxui::Event::ArrowLeft,
+        ftxui::Event::ArrowRight, ftxui::Event::Return,    ftxui::Event::Backspace,
+        ftxui::Event::Tab,        ftxui::Event::Home,      ftxui::Event::F3,
+        ftxui::Event::Special("\033a"), // Alt+A
+    };
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> kind(0, 9);
+    std::uniform_int_distribution<> letter('a', 'z');
+    std::uniform_int_distribution<> pick(0, static_cast<int>(shortcuts.size()) - 1);
+    std::vector<ftxui::Event> session;
+    session.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (kind(gen) < 7) {
+            session.push_back(ftxui::Event::Character(std::string(1, letter(gen))));
+        } else {
+            session.push_back(shortcuts[pick(gen)]);
+        }
+    }
+    return session;
+}
+
+// 编译后的分发表必须与旧的 字符串 + std::map 路径逐个事件一致
+bool verify(const KeyBindingManager& bindings, const EventParser& parser) {
+    size_t mismatches = 0;
+    for (const auto& event : allEvents()) {
+        std::string key = parser.parseKey(event);
+        KeyAction expected = key.empty() ? KeyAction::UNKNOWN : bindings.getActionForKey(key);
+        KeyAction actual = bindings.getAction(event);
+        if (expected != actual || parser.eventToKey(event) != key ||
+            (!key.empty() && chordToKey(parser.eventToChord(event)) != key)) {
+            std::cout << "  mismatch for key \"" << key << "\"" << std::endl;
+            ++mismatches;
+        }
+    }
+    return mismatches == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t keystrokes = 1000000;
+    if (argc > 1) {
+        keystrokes = static_cast<size_t>(std::stoul(argv[1]));
+    }
+
+    std::cout << "=== Key Binding Dispatch Benchmark ===" << std::endl;
+    KeyBindingManager bindings;
+    EventParser parser;
+
+    bool ok = verify(bindings, parser);
+    std::cout << "Chord table matches string dispatch: " << (ok ? "yes" : "NO") << std::endl;
+
+    std::vector<std::string> plugin_keys = {"<F2>", "<F9>", "<A-g>", "<C-S-p>", "<M-x>", "<S-Tab>"};
+    for (const auto& lhs : plugin_keys) {
+        bindings.bindPluginKeymap("n", lhs);
+    }
+
+    std::vector<ftxui::Event> session = typingSession(keystrokes, 42);
+    std::cout << keystrokes << " keystrokes (70% typing, 30% navigation/shortcuts)" << std::endl;
+    std::cout << std::string(60, '-') << std::endl;
+
+    BenchmarkTimer timer;
+    size_t hits = 0;
+
+    timer.start();
+    for (const auto& event : session) {
+        std::string key = parser.parseKey(event);
+        if (!key.empty() && bindings.getActionForKey(key) != KeyAction::UNKNOWN) {
+            ++hits;
+        }
+    }
+    double legacy_ns = timer.stopNs() / static_cast<double>(keystrokes);
+
+    size_t chord_hits = 0;
+    timer.start();
+    for (const auto& event : session) {
+        if (bindings.getAction(event) != KeyAction::UNKNOWN) {
+            ++chord_hits;
+        }
+    }
+    double chord_ns = timer.stopNs() / static_cast<double>(keystrokes);
+
+    size_t plugin_hits = 0;
+    timer.start();
+    for (const auto& event : session) {
+        KeyChord chord = bindings.getChord(event);
+        if (bindings.getAction(chord) != KeyAction::UNKNOWN ||
+            bindings.findPluginKeymap("n", chord)) {
+            ++plugin_hits;
+        }
+    }
+    double plugin_ns = timer.stopNs() / static_cast<double>(keystrokes);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::left << std::setw(36) << "string parse + std::map" << std::right
+              << std::setw(10) << legacy_ns << " ns/key  (" << hits << " bound)" << std::endl;
+    std::cout << std::left << std::setw(36) << "cached chord + flat table" << std::right
+              << std::setw(10) << chord_ns << " ns/key  (" << chord_hits << " bound)"
+              << std::endl;
+    std::cout << std::left << std::setw(36) << "chord + action + plugin tables" << std::right
+              << std::setw(10) << plugin_ns << " ns/key  (" << plugin_hits << " bound)"
+              << std::endl;
+    std::cout << "Speedup: " << std::setprecision(2) << legacy_ns / chord_ns << "x" << std::endl;
+
+    std::cout << "\n=== Benchmark Complete ===" << std::endl;
+    return ok && hits == chord_hits ? 0 : 1;
+}
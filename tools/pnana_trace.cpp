@@ -0,0 +1,240 @@
+// pnana-trace: 解码 `pnana --trace FILE` 写出的二进制性能事件
+//
+// 用法:
+//   pnana-trace FILE                   按时间顺序逐条输出事件
+//   pnana-trace --summary FILE         按事件汇总：次数与各参数的平均值 / 最大值
+//   pnana-trace --chrome OUT.json FILE 转成 Chrome trace_event JSON（chrome://tracing / Perfetto）
+#include "utils/perf_trace.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using pnana::utils::PERF_TRACE_MAGIC;
+using pnana::utils::PERF_TRACE_VERSION;
+using pnana::utils::PerfRecord;
+using pnana::utils::PerfTrace;
+
+namespace {
+
+struct EventDesc {
+    std::string name;
+    std::vector<std::string> args;
+};
+
+template <typename T>
+bool readValue(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+bool readString(std::istream& in, std::string& out) {
+    uint16_t len = 0;
+    if (!readValue(in, len))
+        return false;
+    out.resize(len);
+    return len == 0 || static_cast<bool>(in.read(&out[0], len));
+}
+
+std::vector<std::string> splitArgs(const std::string& spec) {
+    std::vector<std::string> names;
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        names.push_back(item);
+    }
+    return names;
+}
+
+struct TraceFile {
+    std::map<uint32_t, EventDesc> events;
+    std::map<uint32_t, std::string> zones;
+    std::vector<PerfRecord> records;
+    uint64_t start_unix_ns = 0;
+    uint32_t zone_event_id = UINT32_MAX;
+};
+
+bool readTrace(const char* path, TraceFile& trace) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "pnana-trace: cannot open " << path << "\n";
+        return false;
+    }
+
+    char magic[sizeof(PERF_TRACE_MAGIC)];
+    uint32_t version = 0;
+    uint32_t record_size = 0;
+    uint32_t event_count = 0;
+    if (!in.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, PERF_TRACE_MAGIC, sizeof(magic)) != 0 || !readValue(in, version) ||
+        !readValue(in, record_size) || !readValue(in, trace.start_unix_ns) ||
+        !readValue(in, event_count)) {
+        std::cerr << "pnana-trace: " << path << " is not a pnana trace file\n";
+        return false;
+    }
+    if (version != PERF_TRACE_VERSION || record_size != sizeof(PerfRecord)) {
+        std::cerr << "pnana-trace: unsupported trace version " << version << "\n";
+        return false;
+    }
+
+    for (uint32_t i = 0; i < event_count; ++i) {
+        uint32_t id = 0;
+        std::string name;
+        std::string args;
+        if (!readValue(in, id) || !readString(in, name) || !readString(in, args)) {
+            std::cerr << "pnana-trace: truncated event table\n";
+            return false;
+        }
+        if (name == "zone")
+            trace.zone_event_id = id;
+        trace.events[id] = {name, splitArgs(args)};
+    }
+
+    uint32_t zone_count = 0;
+    if (!readValue(in, zone_count)) {
+        std::cerr << "pnana-trace: truncated zone table\n";
+        return false;
+    }
+    for (uint32_t i = 0; i < zone_count; ++i) {
+        uint32_t id = 0;
+        std::string name;
+        if (!readValue(in, id) || !readString(in, name)) {
+            std::cerr << "pnana-trace: truncated zone table\n";
+            return false;
+        }
+        trace.zones[id] = name;
+    }
+
+    PerfRecord record;
+    while (readValue(in, record)) {
+        trace.records.push_back(record);
+    }
+    // 落盘线程按线程批量写出，跨线程的记录需要重新按时间排序
+    std::stable_sort(trace.records.begin(), trace.records.end(),
+                     [](const PerfRecord& a, const PerfRecord& b) {
+                         return a.timestamp_ns < b.timestamp_ns;
+                     });
+    return true;
+}
+
+void printRecords(const TraceFile& trace) {
+    for (const auto& record : trace.records) {
+        auto it = trace.events.find(record.event_id);
+        std::printf("%12.3f ms  T%-3u %-24s", static_cast<double>(record.timestamp_ns) / 1e6,
+                    record.thread_id,
+                    it != trace.events.end() ? it->second.name.c_str() : "(unknown)");
+        if (record.event_id == trace.zone_event_id) {
+            auto zone = trace.zones.find(static_cast<uint32_t>(record.args[0]));
+            std::printf(" %s %.3f ms\n",
+                        zone != trace.zones.end() ? zone->second.c_str() : "(unknown)",
+                        static_cast<double>(record.args[1]) / 1e6);
+            continue;
+        }
+        size_t argc = it != trace.events.end() ? it->second.args.size() : 4;
+        for (size_t i = 0; i < argc && i < 4; ++i) {
+            const char* name = it != trace.events.end() ? it->second.args[i].c_str() : "arg";
+            std::printf(" %s=%" PRId64, name, record.args[i]);
+        }
+        std::printf("\n");
+    }
+}
+
+void printSummary(const TraceFile& trace) {
+    struct Stats {
+        uint64_t count = 0;
+        int64_t sum[4] = {0, 0, 0, 0};
+        int64_t max[4] = {0, 0, 0, 0};
+    };
+    std::map<uint32_t, Stats> stats;
+    // 区间按区间名单独汇总时长
+    std::map<uint32_t, Stats> zone_stats;
+    for (const auto& record : trace.records) {
+        if (record.event_id == trace.zone_event_id) {
+            Stats& z = zone_stats[static_cast<uint32_t>(record.args[0])];
+            z.sum[0] += record.args[1];
+            z.max[0] = z.count == 0 ? record.args[1] : std::max(z.max[0], record.args[1]);
+            ++z.count;
+            continue;
+        }
+        Stats& s = stats[record.event_id];
+        for (int i = 0; i < 4; ++i) {
+            s.sum[i] += record.args[i];
+            s.max[i] = s.count == 0 ? record.args[i] : std::max(s.max[i], record.args[i]);
+        }
+        ++s.count;
+    }
+
+    for (const auto& entry : stats) {
+        auto it = trace.events.find(entry.first);
+        const Stats& s = entry.second;
+        std::printf("%-24s count=%" PRIu64 "\n",
+                    it != trace.events.end() ? it->second.name.c_str() : "(unknown)", s.count);
+        if (it == trace.events.end())
+            continue;
+        for (size_t i = 0; i < it->second.args.size() && i < 4; ++i) {
+            std::printf("    %-12s avg=%.1f max=%" PRId64 "\n", it->second.args[i].c_str(),
+                        static_cast<double>(s.sum[i]) / static_cast<double>(s.count), s.max[i]);
+        }
+    }
+
+    for (const auto& entry : zone_stats) {
+        auto zone = trace.zones.find(entry.first);
+        const Stats& z = entry.second;
+        std::printf("zone %-19s count=%" PRIu64 " avg=%.3fms max=%.3fms\n",
+                    zone != trace.zones.end() ? zone->second.c_str() : "(unknown)", z.count,
+                    static_cast<double>(z.sum[0]) / static_cast<double>(z.count) / 1e6,
+                    static_cast<double>(z.max[0]) / 1e6);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool summary = false;
+    const char* chrome_out = nullptr;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--summary") == 0 || std::strcmp(argv[i], "-s") == 0) {
+            summary = true;
+        } else if (std::strcmp(argv[i], "--chrome") == 0 && i + 1 < argc) {
+            chrome_out = argv[++i];
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            path = nullptr;
+            break;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        std::cerr << "Usage: pnana-trace [--summary | --chrome OUT.json] FILE\n";
+        return 2;
+    }
+
+    TraceFile trace;
+    if (!readTrace(path, trace)) {
+        return 1;
+    }
+
+    if (chrome_out) {
+        std::string error;
+        if (!PerfTrace::writeChromeTrace(chrome_out, trace.records, error)) {
+            std::cerr << "pnana-trace: " << error << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    std::printf("# %zu events, trace started at unix %.3f s\n", trace.records.size(),
+                static_cast<double>(trace.start_unix_ns) / 1e9);
+    if (summary) {
+        printSummary(trace);
+    } else {
+        printRecords(trace);
+    }
+    return 0;
+}